@@ -0,0 +1,103 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+namespace bench
+{
+    /// @brief 计时器
+    class Stopwatch
+    {
+    private:
+        std::chrono::steady_clock::time_point m_begin = std::chrono::steady_clock::now();
+
+    public:
+        void reset() { m_begin = std::chrono::steady_clock::now(); }
+
+        double seconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_begin).count();
+        }
+
+        double milliseconds() const { return seconds() * 1000.0; }
+    };
+
+    /// @brief 获取百分位数
+    /// @param values 数据
+    /// @param p 百分位，0~100
+    /// @return 结果
+    inline double percentile(std::vector<double> values, double p)
+    {
+        if (values.empty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        size_t index = static_cast<size_t>(p / 100.0 * (values.size() - 1) + 0.5);
+        return values[std::min(index, values.size() - 1)];
+    }
+
+    /// @brief 读取形如--name value的参数
+    /// @param argc 参数个数
+    /// @param argv 参数
+    /// @param name 参数名
+    /// @param fallback 默认值
+    /// @return 参数值
+    inline std::string get_option(int argc, char **argv, const char *name, const std::string &fallback)
+    {
+        for (int i = 0; i + 1 < argc; i++)
+            if (std::strcmp(argv[i], name) == 0)
+                return argv[i + 1];
+        return fallback;
+    }
+
+    inline long long get_option(int argc, char **argv, const char *name, long long fallback)
+    {
+        std::string value = get_option(argc, argv, name, std::string());
+        return value.empty() ? fallback : std::atoll(value.c_str());
+    }
+
+    /// @brief 读取形如--name 1,10,100的数量列表
+    inline std::vector<uint64_t> get_list_option(int argc, char **argv, const char *name, const std::string &fallback)
+    {
+        std::vector<uint64_t> values;
+        std::string text = get_option(argc, argv, name, fallback);
+        size_t begin = 0;
+        while (begin < text.size())
+        {
+            size_t end = text.find(',', begin);
+            if (end == std::string::npos)
+                end = text.size();
+            if (end > begin)
+                values.push_back(std::strtoull(text.substr(begin, end - begin).c_str(), nullptr, 10));
+            begin = end + 1;
+        }
+        return values;
+    }
+
+    /// @brief 是否有形如--name的开关
+    inline bool has_flag(int argc, char **argv, const char *name)
+    {
+        for (int i = 0; i < argc; i++)
+            if (std::strcmp(argv[i], name) == 0)
+                return true;
+        return false;
+    }
+
+    /// @brief 防止被优化掉
+    template <typename T>
+    inline void do_not_optimize(const T &value)
+    {
+        static const void *volatile sink = nullptr;
+        sink = &value;
+        (void)sink;
+    }
+} // namespace bench
+
+#endif
\ No newline at end of file
@@ -0,0 +1,311 @@
+#ifndef COMMANDLISTBENCH_CPP
+#define COMMANDLISTBENCH_CPP
+
+#include <sstream>
+#include "Bench.hpp"
+#include "../src/CommandList.hpp"
+#include "../src/CommandList.cpp"
+
+/// @brief 记录调用的模拟分发表，每次调用保存为一行文本
+struct RecordingDispatch
+{
+    mutable std::vector<std::string> m_calls;
+
+    template <typename T>
+    static uint64_t id(T handle) { return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle)); }
+
+    void vkCmdBindPipeline(VkCommandBuffer, VkPipelineBindPoint bind_point, VkPipeline pipeline) const
+    {
+        std::ostringstream stream;
+        stream << "bindPipeline " << bind_point << " " << id(pipeline);
+        m_calls.push_back(stream.str());
+    }
+
+    void vkCmdBindDescriptorSets(VkCommandBuffer, VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t first_set,
+                                 uint32_t set_count, const VkDescriptorSet *sets, uint32_t dynamic_offset_count, const uint32_t *dynamic_offsets) const
+    {
+        std::ostringstream stream;
+        stream << "bindDescriptorSets " << bind_point << " " << id(layout) << " " << first_set << " [";
+        for (uint32_t i = 0; i < set_count; i++)
+            stream << (i ? " " : "") << id(sets[i]);
+        stream << "] [";
+        for (uint32_t i = 0; i < dynamic_offset_count; i++)
+            stream << (i ? " " : "") << dynamic_offsets[i];
+        stream << "]";
+        m_calls.push_back(stream.str());
+    }
+
+    void vkCmdBindVertexBuffers(VkCommandBuffer, uint32_t first_binding, uint32_t binding_count, const VkBuffer *buffers, const VkDeviceSize *offsets) const
+    {
+        std::ostringstream stream;
+        stream << "bindVertexBuffers " << first_binding << " [";
+        for (uint32_t i = 0; i < binding_count; i++)
+            stream << (i ? " " : "") << id(buffers[i]) << "+" << offsets[i];
+        stream << "]";
+        m_calls.push_back(stream.str());
+    }
+
+    void vkCmdBindIndexBuffer(VkCommandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType index_type) const
+    {
+        std::ostringstream stream;
+        stream << "bindIndexBuffer " << id(buffer) << "+" << offset << " " << index_type;
+        m_calls.push_back(stream.str());
+    }
+
+    void vkCmdSetViewport(VkCommandBuffer, uint32_t first, uint32_t count, const VkViewport *viewports) const
+    {
+        std::ostringstream stream;
+        stream << "setViewport " << first << " [";
+        for (uint32_t i = 0; i < count; i++)
+            stream << (i ? " " : "") << viewports[i].width << "x" << viewports[i].height;
+        stream << "]";
+        m_calls.push_back(stream.str());
+    }
+
+    void vkCmdSetScissor(VkCommandBuffer, uint32_t first, uint32_t count, const VkRect2D *scissors) const
+    {
+        std::ostringstream stream;
+        stream << "setScissor " << first << " [";
+        for (uint32_t i = 0; i < count; i++)
+            stream << (i ? " " : "") << scissors[i].extent.width << "x" << scissors[i].extent.height;
+        stream << "]";
+        m_calls.push_back(stream.str());
+    }
+
+    void vkCmdPushConstants(VkCommandBuffer, VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset, uint32_t size, const void *values) const
+    {
+        std::ostringstream stream;
+        stream << "pushConstants " << id(layout) << " " << stages << " " << offset << " " << size;
+        const uint8_t *bytes = static_cast<const uint8_t *>(values);
+        for (uint32_t i = 0; i < size; i++)
+            stream << (i ? "," : " ") << static_cast<int>(bytes[i]);
+        m_calls.push_back(stream.str());
+    }
+
+    void vkCmdDraw(VkCommandBuffer, uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance) const
+    {
+        std::ostringstream stream;
+        stream << "draw " << vertex_count << " " << instance_count << " " << first_vertex << " " << first_instance;
+        m_calls.push_back(stream.str());
+    }
+
+    void vkCmdDrawIndexed(VkCommandBuffer, uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance) const
+    {
+        std::ostringstream stream;
+        stream << "drawIndexed " << index_count << " " << instance_count << " " << first_index << " " << vertex_offset << " " << first_instance;
+        m_calls.push_back(stream.str());
+    }
+
+    void vkCmdDrawIndirect(VkCommandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t draw_count, uint32_t stride) const
+    {
+        std::ostringstream stream;
+        stream << "drawIndirect " << id(buffer) << "+" << offset << " " << draw_count << " " << stride;
+        m_calls.push_back(stream.str());
+    }
+
+    void vkCmdDrawIndexedIndirect(VkCommandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t draw_count, uint32_t stride) const
+    {
+        std::ostringstream stream;
+        stream << "drawIndexedIndirect " << id(buffer) << "+" << offset << " " << draw_count << " " << stride;
+        m_calls.push_back(stream.str());
+    }
+};
+
+/// @brief 只计数的模拟分发表，用于测量包装本身的开销
+struct CountingDispatch
+{
+    mutable size_t m_count = 0;
+
+    void vkCmdBindPipeline(VkCommandBuffer, VkPipelineBindPoint, VkPipeline) const { m_count++; }
+    void vkCmdBindDescriptorSets(VkCommandBuffer, VkPipelineBindPoint, VkPipelineLayout, uint32_t, uint32_t, const VkDescriptorSet *, uint32_t, const uint32_t *) const { m_count++; }
+    void vkCmdBindVertexBuffers(VkCommandBuffer, uint32_t, uint32_t, const VkBuffer *, const VkDeviceSize *) const { m_count++; }
+    void vkCmdBindIndexBuffer(VkCommandBuffer, VkBuffer, VkDeviceSize, VkIndexType) const { m_count++; }
+    void vkCmdSetViewport(VkCommandBuffer, uint32_t, uint32_t, const VkViewport *) const { m_count++; }
+    void vkCmdSetScissor(VkCommandBuffer, uint32_t, uint32_t, const VkRect2D *) const { m_count++; }
+    void vkCmdPushConstants(VkCommandBuffer, VkPipelineLayout, VkShaderStageFlags, uint32_t, uint32_t, const void *) const { m_count++; }
+    void vkCmdDraw(VkCommandBuffer, uint32_t, uint32_t, uint32_t, uint32_t) const { m_count++; }
+    void vkCmdDrawIndexed(VkCommandBuffer, uint32_t, uint32_t, uint32_t, int32_t, uint32_t) const { m_count++; }
+    void vkCmdDrawIndirect(VkCommandBuffer, VkBuffer, VkDeviceSize, uint32_t, uint32_t) const { m_count++; }
+    void vkCmdDrawIndexedIndirect(VkCommandBuffer, VkBuffer, VkDeviceSize, uint32_t, uint32_t) const { m_count++; }
+};
+
+/// @brief 用整数构造假的句柄
+template <typename Handle>
+Handle make_fake_handle(uint64_t value)
+{
+    return Handle(reinterpret_cast<typename Handle::CType>(static_cast<uintptr_t>(value)));
+}
+
+/// @brief 比较录制的调用与期望
+bool check_calls(const char *name, const RecordingDispatch &dispatch, const std::vector<std::string> &expected)
+{
+    bool is_matching = dispatch.m_calls == expected;
+    std::cout << "  " << std::left << std::setw(28) << name << std::right << (is_matching ? "ok" : "FAILED") << std::endl;
+    if (!is_matching)
+    {
+        std::cout << "    expected:" << std::endl;
+        for (const std::string &call : expected)
+            std::cout << "      " << call << std::endl;
+        std::cout << "    emitted:" << std::endl;
+        for (const std::string &call : dispatch.m_calls)
+            std::cout << "      " << call << std::endl;
+    }
+    dispatch.m_calls.clear();
+    return is_matching;
+}
+
+/// @brief 命令录制包装基准：先在模拟分发表上检查发出的调用序列，再测量多物体录制时跳过的命令数和开销
+int run_command_list_bench(int argc, char **argv)
+{
+    size_t draw_count = static_cast<size_t>(bench::get_option(argc, argv, "--draws", 100000LL));
+    uint32_t pipeline_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--pipelines", 8LL));
+    uint32_t set_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--sets", 64LL));
+    int repeat = static_cast<int>(bench::get_option(argc, argv, "--repeat", 5LL));
+
+    const vk::PipelineBindPoint graphics = vk::PipelineBindPoint::eGraphics;
+    const vk::PipelineBindPoint compute = vk::PipelineBindPoint::eCompute;
+    vk::Pipeline pipeline_a = make_fake_handle<vk::Pipeline>(1), pipeline_b = make_fake_handle<vk::Pipeline>(2);
+    vk::PipelineLayout layout_a = make_fake_handle<vk::PipelineLayout>(10), layout_b = make_fake_handle<vk::PipelineLayout>(11);
+    vk::DescriptorSet set_a = make_fake_handle<vk::DescriptorSet>(20), set_b = make_fake_handle<vk::DescriptorSet>(21);
+    vk::Buffer buffer_a = make_fake_handle<vk::Buffer>(30), buffer_b = make_fake_handle<vk::Buffer>(31), buffer_c = make_fake_handle<vk::Buffer>(32);
+
+    std::cout << "command list: emitted call streams" << std::endl;
+    bool is_passed = true;
+    RecordingDispatch recorder;
+    vl::CommandList<RecordingDispatch> list(vk::CommandBuffer(), recorder);
+
+    list.bind_pipeline(graphics, pipeline_a);
+    list.bind_pipeline(graphics, pipeline_a);
+    list.bind_pipeline(compute, pipeline_a);
+    list.bind_pipeline(graphics, pipeline_b);
+    is_passed &= check_calls("pipeline", recorder, {"bindPipeline 0 1", "bindPipeline 1 1", "bindPipeline 0 2"});
+
+    list.bind_descriptor_set(graphics, layout_a, 0, set_a);
+    list.bind_descriptor_set(graphics, layout_a, 0, set_a);
+    list.bind_descriptor_set(graphics, layout_a, 1, set_b);
+    vk::DescriptorSet both[2] = {set_a, set_b};
+    list.bind_descriptor_sets(graphics, layout_a, 0, 2, both);
+    list.bind_descriptor_set(graphics, layout_b, 0, set_a);
+    list.bind_descriptor_set(compute, layout_a, 0, set_a);
+    is_passed &= check_calls("descriptor sets", recorder,
+                             {"bindDescriptorSets 0 10 0 [20] []", "bindDescriptorSets 0 10 1 [21] []",
+                              "bindDescriptorSets 0 11 0 [20] []", "bindDescriptorSets 1 10 0 [20] []"});
+
+    uint32_t offsets_a[2] = {0, 256}, offsets_b[2] = {0, 512};
+    list.bind_descriptor_sets(graphics, layout_a, 0, 2, both, 2, offsets_a);
+    list.bind_descriptor_sets(graphics, layout_a, 0, 2, both, 2, offsets_a);
+    list.bind_descriptor_sets(graphics, layout_a, 0, 2, both, 2, offsets_b);
+    is_passed &= check_calls("dynamic offsets", recorder,
+                             {"bindDescriptorSets 0 10 0 [20 21] [0 256]", "bindDescriptorSets 0 10 0 [20 21] [0 512]"});
+
+    vk::Buffer buffers_ab[2] = {buffer_a, buffer_b}, buffers_ac[2] = {buffer_a, buffer_c};
+    vk::DeviceSize vertex_offsets[2] = {0, 64};
+    list.bind_vertex_buffers(0, 2, buffers_ab, vertex_offsets);
+    list.bind_vertex_buffers(0, 2, buffers_ab, vertex_offsets);
+    list.bind_vertex_buffers(0, 2, buffers_ac, vertex_offsets);
+    list.bind_vertex_buffers(1, 1, &buffer_c, &vertex_offsets[1]);
+    is_passed &= check_calls("vertex buffers", recorder, {"bindVertexBuffers 0 [30+0 31+64]", "bindVertexBuffers 1 [32+64]"});
+
+    list.bind_index_buffer(buffer_a, 0, vk::IndexType::eUint16);
+    list.bind_index_buffer(buffer_a, 0, vk::IndexType::eUint16);
+    list.bind_index_buffer(buffer_a, 0, vk::IndexType::eUint32);
+    is_passed &= check_calls("index buffer", recorder, {"bindIndexBuffer 30+0 0", "bindIndexBuffer 30+0 1"});
+
+    vk::Viewport viewport(0.0f, 0.0f, 640.0f, 360.0f, 0.0f, 1.0f);
+    vk::Rect2D scissor(vk::Offset2D(0, 0), vk::Extent2D(640, 360));
+    list.set_viewport(0, 1, &viewport);
+    list.set_scissor(0, 1, &scissor);
+    list.set_viewport(0, 1, &viewport);
+    list.set_scissor(0, 1, &scissor);
+    list.bind_pipeline(graphics, pipeline_a);
+    list.set_viewport(0, 1, &viewport);
+    list.bind_pipeline(graphics, pipeline_b, false);
+    list.set_viewport(0, 1, &viewport);
+    list.set_scissor(0, 1, &scissor);
+    is_passed &= check_calls("viewport and scissor", recorder,
+                             {"setViewport 0 [640x360]", "setScissor 0 [640x360]", "bindPipeline 0 1",
+                              "bindPipeline 0 2", "setViewport 0 [640x360]", "setScissor 0 [640x360]"});
+
+    uint8_t constants[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    list.push_constants(layout_a, vk::ShaderStageFlagBits::eVertex, 0, 8, constants);
+    list.push_constants(layout_a, vk::ShaderStageFlagBits::eVertex, 0, 4, constants);
+    list.push_constants(layout_a, vk::ShaderStageFlagBits::eFragment, 0, 4, constants);
+    constants[5] = 9;
+    list.push_constants(layout_a, vk::ShaderStageFlagBits::eVertex, 4, 4, constants + 4);
+    list.push_constants(layout_b, vk::ShaderStageFlagBits::eVertex, 4, 4, constants + 4);
+    is_passed &= check_calls("push constants", recorder,
+                             {"pushConstants 10 1 0 8 1,2,3,4,5,6,7,8", "pushConstants 10 16 0 4 1,2,3,4",
+                              "pushConstants 10 1 4 4 5,9,7,8", "pushConstants 11 1 4 4 5,9,7,8"});
+
+    list.draw(36, 1, 0, 0);
+    list.draw(36, 1, 0, 0);
+    list.reset();
+    list.bind_pipeline(graphics, pipeline_b);
+    list.set_viewport(0, 1, &viewport);
+    is_passed &= check_calls("draws and reset", recorder,
+                             {"draw 36 1 0 0", "draw 36 1 0 0", "bindPipeline 0 2", "setViewport 0 [640x360]"});
+
+    // 每个物体都完整地绑定一遍，由包装去掉重复的部分；分发表只计数，时间是包装本身的开销
+    std::cout << "command list: " << draw_count << " draws, " << pipeline_count << " pipelines, " << set_count << " descriptor sets" << std::endl
+              << "  order         calls   emitted   skipped  wrapper ns/draw" << std::endl;
+
+    std::vector<uint32_t> pipeline_ids(draw_count), set_ids(draw_count);
+    for (size_t i = 0; i < draw_count; i++)
+    {
+        uint32_t hash = static_cast<uint32_t>(i) * 2654435761u;
+        pipeline_ids[i] = (hash >> 8) % pipeline_count;
+        set_ids[i] = (hash >> 16) % set_count;
+    }
+    std::vector<uint32_t> sorted_order(draw_count);
+    for (size_t i = 0; i < draw_count; i++)
+        sorted_order[i] = static_cast<uint32_t>(i);
+    std::stable_sort(sorted_order.begin(), sorted_order.end(), [&](uint32_t a, uint32_t b)
+                     { return pipeline_ids[a] != pipeline_ids[b] ? pipeline_ids[a] < pipeline_ids[b] : set_ids[a] < set_ids[b]; });
+    std::vector<uint32_t> submission_order(draw_count);
+    for (size_t i = 0; i < draw_count; i++)
+        submission_order[i] = static_cast<uint32_t>(i);
+
+    struct Order
+    {
+        const char *m_name;
+        const std::vector<uint32_t> *m_order;
+    };
+    for (const Order &order : {Order{"submission", &submission_order}, Order{"sorted", &sorted_order}})
+    {
+        std::vector<double> filtered_ms;
+        vl::CommandList<CountingDispatch>::Statistics statistics;
+        CountingDispatch counter;
+        for (int r = 0; r < repeat; r++)
+        {
+            bench::Stopwatch stopwatch;
+            vl::CommandList<CountingDispatch> filtered(vk::CommandBuffer(), counter);
+            vk::DeviceSize offset = 0;
+            for (uint32_t index : *order.m_order)
+            {
+                filtered.bind_pipeline(graphics, make_fake_handle<vk::Pipeline>(100 + pipeline_ids[index]));
+                filtered.bind_descriptor_set(graphics, layout_a, 0, make_fake_handle<vk::DescriptorSet>(1000 + set_ids[index]));
+                filtered.bind_vertex_buffers(0, 1, &buffer_a, &offset);
+                filtered.set_viewport(0, 1, &viewport);
+                filtered.set_scissor(0, 1, &scissor);
+                filtered.draw(36, 1, 0, index);
+            }
+            filtered_ms.push_back(stopwatch.milliseconds());
+            statistics = filtered.get_statistics();
+        }
+        bench::do_not_optimize(counter.m_count);
+
+        size_t emitted = statistics.get_emitted(), skipped = statistics.get_skipped();
+        std::cout << std::fixed << std::setprecision(1)
+                  << "  " << std::left << std::setw(11) << order.m_name << std::right
+                  << std::setw(8) << emitted + skipped
+                  << std::setw(10) << emitted
+                  << std::setw(10) << skipped
+                  << std::setw(16) << bench::percentile(filtered_ms, 50) * 1e6 / draw_count
+                  << std::defaultfloat << std::endl;
+    }
+
+    std::cout << (is_passed ? "  all call streams match" : "  MISMATCH") << std::endl;
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
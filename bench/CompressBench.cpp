@@ -0,0 +1,177 @@
+#ifndef COMPRESSBENCH_CPP
+#define COMPRESSBENCH_CPP
+
+#include <cmath>
+#include "Bench.hpp"
+#include "EncoderBench.cpp"
+#include "../src/ThreadPool.hpp"
+#include "../src/ThreadPool.cpp"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/PhysicalDeviceUtils.hpp"
+#include "../src/PhysicalDeviceUtils.cpp"
+#include "../src/DefaultQueueFamilyIndices.hpp"
+#include "../src/DefaultQueueFamilyIndices.cpp"
+#include "../src/HeadlessContext.hpp"
+#include "../src/HeadlessContext.cpp"
+#include "../src/TextureCompressor.hpp"
+#include "../src/TextureCompressor.cpp"
+
+/// @brief 生成对应内容的测试图像
+std::vector<uint8_t> make_compress_image(vl::TextureCompressor::Usage usage, uint32_t width, uint32_t height)
+{
+    std::vector<uint8_t> pixels = make_encoder_frame(width, height, 1);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint8_t *p = pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+            float u = (x + 0.5f) / width, v = (y + 0.5f) / height;
+            switch (usage)
+            {
+            case vl::TextureCompressor::Usage::eColor:
+                break;
+            case vl::TextureCompressor::Usage::eColorAlpha:
+                // 圆形渐变的透明度，边缘有硬边
+                p[3] = static_cast<uint8_t>(std::clamp(1.5f - 3.0f * std::hypot(u - 0.5f, v - 0.5f), 0.0f, 1.0f) * 255.0f);
+                break;
+            case vl::TextureCompressor::Usage::eGray:
+                p[0] = static_cast<uint8_t>((p[0] * 77 + p[1] * 150 + p[2] * 29) >> 8);
+                p[1] = p[2] = 0;
+                p[3] = 255;
+                break;
+            case vl::TextureCompressor::Usage::eNormal:
+            {
+                // 正弦起伏的高度场的法线
+                float dx = 0.6f * std::cos(u * 25.0f) * std::cos(v * 17.0f);
+                float dy = -0.6f * std::sin(u * 25.0f) * std::sin(v * 17.0f);
+                float length = std::sqrt(dx * dx + dy * dy + 1.0f);
+                p[0] = static_cast<uint8_t>((-dx / length * 0.5f + 0.5f) * 255.0f + 0.5f);
+                p[1] = static_cast<uint8_t>((-dy / length * 0.5f + 0.5f) * 255.0f + 0.5f);
+                p[2] = 0;
+                p[3] = 255;
+                break;
+            }
+            }
+        }
+    }
+    return pixels;
+}
+
+/// @brief 内容的名称
+const char *get_compress_usage_name(vl::TextureCompressor::Usage usage)
+{
+    switch (usage)
+    {
+    case vl::TextureCompressor::Usage::eColor:
+        return "color";
+    case vl::TextureCompressor::Usage::eColorAlpha:
+        return "alpha";
+    case vl::TextureCompressor::Usage::eGray:
+        return "gray";
+    case vl::TextureCompressor::Usage::eNormal:
+        return "normal";
+    }
+    return "unknown";
+}
+
+/// @brief 列出设备为每种内容选择的格式
+void report_compress_formats(int argc, char **argv)
+{
+    vl::HeadlessContext::Config config;
+    config.m_name = "texture compression";
+    config.m_device_name = bench::get_option(argc, argv, "--device", std::string());
+    if (bench::has_flag(argc, argv, "--validation"))
+        config.m_validation_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+    vl::HeadlessContext context;
+    if (context.create(config) != vk::Result::eSuccess)
+    {
+        std::cout << "compress gpu: skipped, unable to create headless vulkan context" << std::endl;
+        return;
+    }
+
+    vk::PhysicalDeviceFeatures features = context.m_physical_device.getFeatures();
+    std::cout << "compress gpu: " << context.get_device_name()
+              << ", textureCompressionBC " << (features.textureCompressionBC ? "yes" : "no")
+              << ", textureCompressionETC2 " << (features.textureCompressionETC2 ? "yes" : "no") << std::endl;
+    for (vl::TextureCompressor::Usage usage :
+         {vl::TextureCompressor::Usage::eColor,
+          vl::TextureCompressor::Usage::eColorAlpha,
+          vl::TextureCompressor::Usage::eGray,
+          vl::TextureCompressor::Usage::eNormal})
+    {
+        std::optional<vl::TextureCompressor::Format> format = vl::TextureCompressor::choose_format(context.m_physical_device, usage);
+        std::cout << std::setw(10) << get_compress_usage_name(usage) << "  "
+                  << (format ? vl::TextureCompressor::get_name(*format) : "none, upload RGBA8") << std::endl;
+    }
+    context.destroy();
+}
+
+/// @brief 纹理压缩基准：每种格式的单线程、多线程吞吐量和PSNR
+int run_compress_bench(int argc, char **argv)
+{
+    uint32_t width = static_cast<uint32_t>(bench::get_option(argc, argv, "--width", 1024LL));
+    uint32_t height = static_cast<uint32_t>(bench::get_option(argc, argv, "--height", 1024LL));
+    size_t threads = static_cast<size_t>(bench::get_option(argc, argv, "--threads", 0LL));
+    int repeat = std::max(static_cast<int>(bench::get_option(argc, argv, "--repeat", 3LL)), 1);
+
+    vl::ThreadPool pool(threads);
+    double megapixels = static_cast<double>(width) * height / 1e6;
+    std::cout << "compress: " << width << "x" << height << ", " << pool.get_thread_count()
+              << " threads, median of " << repeat << " runs" << std::endl
+              << "     usage    format  bpp  1t Mpix/s  " << std::setw(2) << pool.get_thread_count()
+              << "t Mpix/s  decode Mpix/s  psnr dB  deterministic" << std::endl;
+
+    bool is_passed = true;
+    for (vl::TextureCompressor::Usage usage :
+         {vl::TextureCompressor::Usage::eColor,
+          vl::TextureCompressor::Usage::eColorAlpha,
+          vl::TextureCompressor::Usage::eGray,
+          vl::TextureCompressor::Usage::eNormal})
+    {
+        std::vector<uint8_t> pixels = make_compress_image(usage, width, height);
+        for (vl::TextureCompressor::Format format : vl::TextureCompressor::get_candidates(usage))
+        {
+            size_t size = vl::TextureCompressor::get_compressed_size(format, width, height);
+            std::vector<uint8_t> single(size), multi(size), decoded(pixels.size());
+            std::vector<double> single_ms, multi_ms, decode_ms;
+            for (int r = 0; r < repeat; r++)
+            {
+                bench::Stopwatch stopwatch;
+                vl::TextureCompressor::compress(format, pixels.data(), width, height, single.data());
+                single_ms.push_back(stopwatch.milliseconds());
+
+                stopwatch.reset();
+                vl::TextureCompressor::compress(format, pixels.data(), width, height, multi.data(), &pool);
+                multi_ms.push_back(stopwatch.milliseconds());
+
+                stopwatch.reset();
+                vl::TextureCompressor::decompress(format, multi.data(), width, height, decoded.data(), &pool);
+                decode_ms.push_back(stopwatch.milliseconds());
+                bench::do_not_optimize(decoded);
+            }
+
+            // 分块的顺序不影响结果
+            bool is_deterministic = single == multi;
+            is_passed = is_passed && is_deterministic;
+            double psnr = vl::TextureCompressor::compute_psnr(format, pixels.data(), decoded.data(), width, height);
+            std::cout << std::fixed << std::setprecision(2)
+                      << std::setw(10) << get_compress_usage_name(usage)
+                      << std::setw(10) << vl::TextureCompressor::get_name(format)
+                      << std::setw(5) << vl::TextureCompressor::get_block_bytes(format) / 2
+                      << std::setw(11) << megapixels * 1000.0 / bench::percentile(single_ms, 50.0)
+                      << std::setw(11) << megapixels * 1000.0 / bench::percentile(multi_ms, 50.0)
+                      << std::setw(15) << megapixels * 1000.0 / bench::percentile(decode_ms, 50.0)
+                      << std::setw(9) << psnr
+                      << std::setw(15) << (is_deterministic ? "yes" : "NO")
+                      << std::defaultfloat << std::endl;
+        }
+    }
+
+    if (!bench::has_flag(argc, argv, "--cpu-only"))
+        report_compress_formats(argc, argv);
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
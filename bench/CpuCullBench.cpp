@@ -0,0 +1,146 @@
+#ifndef CPUCULLBENCH_CPP
+#define CPUCULLBENCH_CPP
+
+#include <cmath>
+#include "Bench.hpp"
+#include "../examples/demo/linmath.h"
+#include "../src/FrustumUtils.hpp"
+#include "../src/FrustumUtils.cpp"
+#include "../src/ThreadPool.hpp"
+#include "../src/ThreadPool.cpp"
+#include "../src/CpuCuller.hpp"
+#include "../src/CpuCuller.cpp"
+
+/// @brief 用双精度判断包围盒的可见性，距离平面很近的记为边界
+/// @return 1可见，0不可见，-1边界
+int classify_box_reference(const float planes[vl::FrustumUtils::PLANE_COUNT * 4], const float min[3], const float max[3])
+{
+    double smallest = INFINITY;
+    for (uint32_t i = 0; i < vl::FrustumUtils::PLANE_COUNT; i++)
+    {
+        const float *plane = planes + i * 4;
+        double distance = plane[3];
+        for (int k = 0; k < 3; k++)
+            distance += static_cast<double>(plane[k]) * (plane[k] > 0.0f ? max[k] : min[k]);
+        smallest = std::min(smallest, distance);
+    }
+    if (std::abs(smallest) < 1e-3)
+        return -1;
+    return smallest > 0.0 ? 1 : 0;
+}
+
+/// @brief CPU剔除基准：逐个标量测试、SIMD全部测试、BVH遍历，单线程和线程池
+int run_cpu_cull_bench(int argc, char **argv)
+{
+    std::vector<uint64_t> counts = bench::get_list_option(argc, argv, "--counts", "100000,1000000,10000000");
+    size_t threads = static_cast<size_t>(bench::get_option(argc, argv, "--threads", 0LL));
+    int repeat = static_cast<int>(bench::get_option(argc, argv, "--repeat", 5LL));
+
+    // 相机在场景中心看向-z
+    mat4x4 projection, view, view_projection;
+    vec3 eye = {0.0f, 0.0f, 0.0f}, center = {0.0f, 0.0f, -1.0f}, up = {0.0f, 1.0f, 0.0f};
+    mat4x4_perspective(projection, 1.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    mat4x4_look_at(view, eye, center, up);
+    mat4x4_mul(view_projection, projection, view);
+    float planes[vl::FrustumUtils::PLANE_COUNT * 4];
+    vl::FrustumUtils::extract_planes(&view_projection[0][0], planes, false);
+
+    vl::ThreadPool pool(threads);
+    std::cout << "cpu culling: " << pool.get_thread_count() << " worker threads" << std::endl
+              << "    objects   visible  build ms  scalar ms  flat ms  flat pool ms  bvh ms  bvh pool ms  mismatches" << std::endl;
+
+    bool is_matching = true;
+    for (uint64_t value : counts)
+    {
+        size_t count = static_cast<size_t>(value);
+        uint32_t state = static_cast<uint32_t>(count);
+        auto next = [&state]()
+        {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>(state >> 8) / 16777216.0f;
+        };
+
+        // 物体均匀分布在边长2000的立方体中
+        std::vector<float> mins(count * 3), maxs(count * 3);
+        vl::CpuCuller culler;
+        culler.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            float c[3] = {next() * 2000.0f - 1000.0f, next() * 2000.0f - 1000.0f, next() * 2000.0f - 1000.0f};
+            float h = 0.25f + next() * 1.5f;
+            for (int k = 0; k < 3; k++)
+            {
+                mins[i * 3 + k] = c[k] - h;
+                maxs[i * 3 + k] = c[k] + h;
+            }
+            culler.set(i, &mins[i * 3], &maxs[i * 3]);
+        }
+
+        bench::Stopwatch stopwatch;
+        culler.build();
+        double build_ms = stopwatch.milliseconds();
+
+        std::vector<double> scalar, flat, flat_pool, bvh, bvh_pool;
+        std::vector<uint32_t> reference, flat_result, bvh_result, bvh_pool_result, flat_pool_result;
+        for (int r = 0; r < repeat; r++)
+        {
+            stopwatch.reset();
+            reference.clear();
+            for (size_t i = 0; i < count; i++)
+                if (vl::FrustumUtils::is_box_visible(planes, &mins[i * 3], &maxs[i * 3]))
+                    reference.push_back(static_cast<uint32_t>(i));
+            scalar.push_back(stopwatch.milliseconds());
+
+            stopwatch.reset();
+            culler.cull_flat(planes, flat_result);
+            flat.push_back(stopwatch.milliseconds());
+
+            stopwatch.reset();
+            culler.cull_flat(planes, flat_pool_result, &pool);
+            flat_pool.push_back(stopwatch.milliseconds());
+
+            stopwatch.reset();
+            culler.cull(planes, bvh_result);
+            bvh.push_back(stopwatch.milliseconds());
+
+            stopwatch.reset();
+            culler.cull(planes, bvh_pool_result, &pool);
+            bvh_pool.push_back(stopwatch.milliseconds());
+        }
+
+        // 各结果按索引排序后与双精度的判断比较，边界上的物体不计
+        size_t mismatches = 0;
+        for (std::vector<uint32_t> *result : {&reference, &flat_result, &flat_pool_result, &bvh_result, &bvh_pool_result})
+        {
+            std::sort(result->begin(), result->end());
+            std::vector<bool> is_visible(count, false);
+            for (uint32_t index : *result)
+                is_visible[index] = true;
+            for (size_t i = 0; i < count; i++)
+            {
+                int expected = classify_box_reference(planes, &mins[i * 3], &maxs[i * 3]);
+                if (expected >= 0 && is_visible[i] != (expected == 1))
+                    mismatches++;
+            }
+        }
+        if (mismatches > 0)
+            is_matching = false;
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(11) << count
+                  << std::setw(10) << bvh_result.size()
+                  << std::setw(10) << build_ms
+                  << std::setw(11) << bench::percentile(scalar, 50)
+                  << std::setw(9) << bench::percentile(flat, 50)
+                  << std::setw(14) << bench::percentile(flat_pool, 50)
+                  << std::setw(8) << bench::percentile(bvh, 50)
+                  << std::setw(13) << bench::percentile(bvh_pool, 50)
+                  << std::setw(12) << mismatches
+                  << std::defaultfloat << std::endl;
+    }
+
+    std::cout << (is_matching ? "  all results match the reference" : "  MISMATCH") << std::endl;
+    return is_matching ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
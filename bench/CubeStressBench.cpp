@@ -0,0 +1,927 @@
+#ifndef CUBESTRESSBENCH_CPP
+#define CUBESTRESSBENCH_CPP
+
+#include <cmath>
+#include <cstring>
+#include "Bench.hpp"
+#include "../examples/demo/linmath.h"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/PhysicalDeviceUtils.hpp"
+#include "../src/PhysicalDeviceUtils.cpp"
+#include "../src/DefaultQueueFamilyIndices.hpp"
+#include "../src/DefaultQueueFamilyIndices.cpp"
+#include "../src/HeadlessContext.hpp"
+#include "../src/HeadlessContext.cpp"
+#include "../src/MappedBuffer.hpp"
+#include "../src/MappedBuffer.cpp"
+#include "../src/TransformStore.hpp"
+#include "../src/TransformStore.cpp"
+#include "../src/RenderQueue.hpp"
+#include "../src/RenderQueue.cpp"
+#include "../src/CommandList.hpp"
+#include "../src/CommandList.cpp"
+#include "../src/DrawBatcher.hpp"
+#include "../src/DrawBatcher.cpp"
+#include "../src/VertexLayout.hpp"
+#include "../src/VertexLayout.cpp"
+
+/// @brief 多立方体压力场景：离屏渲染N个立方体，比较几种提交方式
+class CubeStressScene
+{
+public:
+    /// @brief 提交方式
+    enum class Mode
+    {
+        /// @brief 每个物体一次vkCmdDraw
+        ePerObject,
+        /// @brief 一次实例化绘制
+        eInstanced,
+        /// @brief vkCmdDrawIndirect，多个绘制命令放在缓冲中
+        eIndirect,
+        /// @brief 每个物体有自己的管线和描述符集，按提交顺序逐个绘制
+        eUnsorted,
+        /// @brief 同上，但先用RenderQueue按排序键排序
+        eSorted,
+        /// @brief 排序后用DrawBatcher把相同状态的绘制合并为vkCmdDrawIndexedIndirect
+        eBatched,
+    };
+
+    /// @brief 一次运行的结果
+    struct Result
+    {
+        uint32_t m_draw_calls = 0;
+        std::vector<double> m_record_ms;
+        std::vector<double> m_submit_ms;
+        std::vector<double> m_frame_ms;
+        std::vector<double> m_gpu_ms;
+        std::vector<double> m_sort_ms;
+        vl::RenderQueue::Statistics m_statistics;
+        size_t m_skipped_commands = 0;
+    };
+
+    static constexpr uint32_t FRAME_COUNT = 2;
+    static constexpr uint32_t CUBE_VERTEX_COUNT = 36;
+
+    /// @brief 管线变体数，只有片段着色器的特化常量不同
+    static constexpr uint32_t PIPELINE_COUNT = 8;
+
+    /// @brief 描述符集数，都指向同一个实例缓冲
+    static constexpr uint32_t DESCRIPTOR_SET_COUNT = 64;
+
+protected:
+    vl::HeadlessContext &m_context;
+    vk::Device m_device;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+
+    vk::Format m_color_format = vk::Format::eR8G8B8A8Unorm;
+    vk::Format m_depth_format = vk::Format::eUndefined;
+    vk::Image m_color_image;
+    vk::DeviceMemory m_color_memory;
+    vk::ImageView m_color_view;
+    vk::Image m_depth_image;
+    vk::DeviceMemory m_depth_memory;
+    vk::ImageView m_depth_view;
+
+    vk::RenderPass m_render_pass;
+    vk::Framebuffer m_framebuffer;
+    vk::DescriptorSetLayout m_set_layout;
+    vk::DescriptorPool m_descriptor_pool;
+    vk::DescriptorSet m_descriptor_sets[DESCRIPTOR_SET_COUNT];
+    vk::PipelineLayout m_pipeline_layout;
+    vk::Pipeline m_pipelines[PIPELINE_COUNT];
+
+    vl::MappedBuffer m_vertex_buffer;
+    vl::MappedBuffer m_instance_buffer;
+    vl::MappedBuffer m_indirect_buffer;
+    vl::MappedBuffer m_index_buffer;
+    uint32_t m_count = 0;
+
+    /// @brief 每个物体的管线、描述符集和归一化深度
+    std::vector<uint32_t> m_pipeline_ids;
+    std::vector<uint32_t> m_set_ids;
+    std::vector<float> m_depths;
+    vl::RenderQueue m_queue;
+    vl::ThreadPool *m_pool = nullptr;
+
+    /// @brief 合并绘制的每个物体的命令和每帧的间接缓冲
+    std::vector<vl::DrawBatcher::Draw> m_draws;
+    vl::DrawBatcher m_batcher;
+    vl::MappedBuffer m_batch_buffers[FRAME_COUNT];
+
+    vk::CommandBuffer m_command_buffers[FRAME_COUNT];
+    vk::Fence m_fences[FRAME_COUNT];
+    vk::QueryPool m_query_pool;
+    bool m_has_timestamps = false;
+
+    /// @brief 时间戳的有效位，差值按它取模，计数器回绕时结果仍然正确
+    uint64_t m_timestamp_mask = 0;
+
+public:
+    CubeStressScene(vl::HeadlessContext &context) : m_context(context), m_device(context.m_device) {}
+    ~CubeStressScene() { destroy(); }
+
+public:
+    bool create(uint32_t width, uint32_t height)
+    {
+        m_width = width;
+        m_height = height;
+
+        // 深度格式
+        const vk::Format depth_formats[] = {vk::Format::eD32Sfloat, vk::Format::eD24UnormS8Uint, vk::Format::eD16Unorm};
+        for (vk::Format format : depth_formats)
+        {
+            vk::FormatProperties properties = m_context.m_physical_device.getFormatProperties(format);
+            if (properties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eDepthStencilAttachment)
+            {
+                m_depth_format = format;
+                break;
+            }
+        }
+        if (m_depth_format == vk::Format::eUndefined)
+            return false;
+
+        if (!create_image(m_color_format, vk::ImageUsageFlagBits::eColorAttachment, vk::ImageAspectFlagBits::eColor, m_color_image, m_color_memory, m_color_view) ||
+            !create_image(m_depth_format, vk::ImageUsageFlagBits::eDepthStencilAttachment, vk::ImageAspectFlagBits::eDepth, m_depth_image, m_depth_memory, m_depth_view) ||
+            !create_render_pass() ||
+            !create_pipeline())
+            return false;
+
+        // 立方体顶点，与cube.cpp的g_vertex_buffer_data相同的36个顶点
+        static const float cube[] = {
+            -1, -1, -1, -1, -1, 1, -1, 1, 1, -1, 1, 1, -1, 1, -1, -1, -1, -1,
+            -1, -1, -1, 1, 1, -1, 1, -1, -1, -1, -1, -1, -1, 1, -1, 1, 1, -1,
+            -1, -1, -1, 1, -1, -1, 1, -1, 1, -1, -1, -1, 1, -1, 1, -1, -1, 1,
+            -1, 1, -1, -1, 1, 1, 1, 1, 1, -1, 1, -1, 1, 1, 1, 1, 1, -1,
+            1, 1, -1, 1, 1, 1, 1, -1, 1, 1, -1, 1, 1, -1, -1, 1, 1, -1,
+            -1, 1, 1, -1, -1, 1, 1, 1, 1, -1, -1, 1, 1, -1, 1, 1, 1, 1};
+        if (m_vertex_buffer.create(m_device, m_context.m_physical_device, sizeof(cube), vk::BufferUsageFlagBits::eVertexBuffer) != vk::Result::eSuccess)
+            return false;
+        std::memcpy(m_vertex_buffer.m_mapped, cube, sizeof(cube));
+        if (m_vertex_buffer.flush(m_device) != vk::Result::eSuccess)
+            return false;
+
+        // 间接绘制需要索引，36个顶点依次排列
+        if (m_index_buffer.create(m_device, m_context.m_physical_device, sizeof(uint16_t) * CUBE_VERTEX_COUNT, vk::BufferUsageFlagBits::eIndexBuffer) != vk::Result::eSuccess)
+            return false;
+        for (uint32_t i = 0; i < CUBE_VERTEX_COUNT; i++)
+            m_index_buffer.data<uint16_t>()[i] = static_cast<uint16_t>(i);
+        if (m_index_buffer.flush(m_device) != vk::Result::eSuccess)
+            return false;
+
+        vk::CommandBufferAllocateInfo allocate_info;
+        allocate_info.setCommandPool(m_context.m_command_pool);
+        allocate_info.setLevel(vk::CommandBufferLevel::ePrimary);
+        allocate_info.setCommandBufferCount(FRAME_COUNT);
+        auto command_result = m_device.allocateCommandBuffers(allocate_info);
+        if (command_result.result != vk::Result::eSuccess)
+            return false;
+        for (uint32_t i = 0; i < FRAME_COUNT; i++)
+        {
+            m_command_buffers[i] = command_result.value.at(i);
+            auto fence_result = m_device.createFence(vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled));
+            if (fence_result.result != vk::Result::eSuccess)
+                return false;
+            m_fences[i] = fence_result.value;
+        }
+
+        // 时间戳查询，每帧两个
+        uint32_t family = *m_context.m_queue_family_indices.m_graphics_family;
+        auto families = vl::PhysicalDeviceUtils::get_physical_device_queue_family_properties(m_context.m_physical_device);
+        uint32_t valid_bits = families.at(family).timestampValidBits;
+        m_has_timestamps = valid_bits != 0 && m_context.m_properties.limits.timestampPeriod > 0.0f;
+        m_timestamp_mask = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+        if (m_has_timestamps)
+        {
+            vk::QueryPoolCreateInfo query_info;
+            query_info.setQueryType(vk::QueryType::eTimestamp);
+            query_info.setQueryCount(FRAME_COUNT * 2);
+            auto query_result = m_device.createQueryPool(query_info);
+            if (query_result.result != vk::Result::eSuccess)
+                return false;
+            m_query_pool = query_result.value;
+        }
+
+        return true;
+    }
+
+    void destroy()
+    {
+        if (!m_device)
+            return;
+        m_device.waitIdle();
+
+        for (uint32_t i = 0; i < FRAME_COUNT; i++)
+        {
+            if (m_fences[i])
+                m_device.destroyFence(m_fences[i]);
+            if (m_command_buffers[i])
+                m_device.freeCommandBuffers(m_context.m_command_pool, m_command_buffers[i]);
+            m_fences[i] = nullptr;
+            m_command_buffers[i] = nullptr;
+        }
+        if (m_query_pool)
+            m_device.destroyQueryPool(m_query_pool);
+        m_vertex_buffer.destroy(m_device);
+        m_index_buffer.destroy(m_device);
+        m_instance_buffer.destroy(m_device);
+        m_indirect_buffer.destroy(m_device);
+        for (vl::MappedBuffer &buffer : m_batch_buffers)
+            buffer.destroy(m_device);
+        for (vk::Pipeline &pipeline : m_pipelines)
+        {
+            if (pipeline)
+                m_device.destroyPipeline(pipeline);
+            pipeline = nullptr;
+        }
+        if (m_pipeline_layout)
+            m_device.destroyPipelineLayout(m_pipeline_layout);
+        if (m_descriptor_pool)
+            m_device.destroyDescriptorPool(m_descriptor_pool);
+        if (m_set_layout)
+            m_device.destroyDescriptorSetLayout(m_set_layout);
+        if (m_framebuffer)
+            m_device.destroyFramebuffer(m_framebuffer);
+        if (m_render_pass)
+            m_device.destroyRenderPass(m_render_pass);
+        if (m_color_view)
+            m_device.destroyImageView(m_color_view);
+        if (m_color_image)
+            m_device.destroyImage(m_color_image);
+        if (m_color_memory)
+            m_device.freeMemory(m_color_memory);
+        if (m_depth_view)
+            m_device.destroyImageView(m_depth_view);
+        if (m_depth_image)
+            m_device.destroyImage(m_depth_image);
+        if (m_depth_memory)
+            m_device.freeMemory(m_depth_memory);
+        m_device = nullptr;
+    }
+
+    /// @brief 准备N个物体的实例数据和间接绘制命令
+    bool prepare(uint32_t count, vl::ThreadPool &pool)
+    {
+        m_count = count;
+        m_pool = &pool;
+        m_instance_buffer.destroy(m_device);
+        m_indirect_buffer.destroy(m_device);
+
+        if (m_instance_buffer.create(m_device, m_context.m_physical_device, vl::TransformStore::MATRIX_SIZE * count, vk::BufferUsageFlagBits::eStorageBuffer) != vk::Result::eSuccess ||
+            m_indirect_buffer.create(m_device, m_context.m_physical_device, sizeof(VkDrawIndirectCommand) * count, vk::BufferUsageFlagBits::eIndirectBuffer) != vk::Result::eSuccess)
+            return false;
+
+        // 立方体排成网格，相机放在能看到整个网格的位置
+        uint32_t side = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+        float extent = side * 3.0f;
+        vl::TransformStore store;
+        store.resize(count);
+        std::vector<float> positions(count * 3);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            float rotation[4];
+            vl::TransformStore::make_rotation(1.0f, static_cast<float>(i % 7), 0.5f, i * 0.1f, rotation);
+            float *position = &positions[i * 3];
+            position[0] = (i % side) * 3.0f - extent * 0.5f;
+            position[1] = (i / side % side) * 3.0f - extent * 0.5f;
+            position[2] = -static_cast<float>(i / (side * side)) * 3.0f;
+            store.set_position(i, position[0], position[1], position[2]);
+            store.set_rotation(i, rotation[0], rotation[1], rotation[2], rotation[3]);
+        }
+
+        mat4x4 projection, view, view_projection;
+        vec3 eye = {0.0f, 0.0f, extent * 1.5f}, center = {0.0f, 0.0f, -extent * 0.5f}, up = {0.0f, 1.0f, 0.0f};
+        mat4x4_perspective(projection, 1.0f, static_cast<float>(m_width) / m_height, 0.1f, extent * 4.0f);
+        projection[1][1] *= -1.0f;
+        mat4x4_look_at(view, eye, center, up);
+        mat4x4_mul(view_projection, projection, view);
+        if (store.write(m_device, m_instance_buffer, 0, vl::TransformStore::MATRIX_SIZE, &view_projection[0][0], &pool) != vk::Result::eSuccess)
+            return false;
+
+        // 材质打乱分配，提交顺序下相邻物体的状态几乎总是不同
+        m_pipeline_ids.resize(count);
+        m_set_ids.resize(count);
+        m_depths.resize(count);
+        float far_plane = extent * 4.0f;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t hash = i * 2654435761u;
+            m_pipeline_ids[i] = (hash >> 8) % PIPELINE_COUNT;
+            m_set_ids[i] = (hash >> 16) % DESCRIPTOR_SET_COUNT;
+            const float *position = &positions[i * 3];
+            float dx = position[0] - eye[0], dy = position[1] - eye[1], dz = position[2] - eye[2];
+            m_depths[i] = std::sqrt(dx * dx + dy * dy + dz * dz) / far_plane;
+        }
+        m_queue.reserve(count);
+
+        m_draws.resize(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            m_draws[i].m_index_count = CUBE_VERTEX_COUNT;
+            m_draws[i].m_first_instance = i;
+        }
+        for (vl::MappedBuffer &buffer : m_batch_buffers)
+        {
+            buffer.destroy(m_device);
+            if (buffer.create(m_device, m_context.m_physical_device, sizeof(VkDrawIndexedIndirectCommand) * count, vk::BufferUsageFlagBits::eIndirectBuffer) != vk::Result::eSuccess)
+                return false;
+        }
+
+        VkDrawIndirectCommand *commands = m_indirect_buffer.data<VkDrawIndirectCommand>();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            commands[i].vertexCount = CUBE_VERTEX_COUNT;
+            commands[i].instanceCount = 1;
+            commands[i].firstVertex = 0;
+            commands[i].firstInstance = i;
+        }
+        if (m_indirect_buffer.flush(m_device) != vk::Result::eSuccess)
+            return false;
+
+        vk::DescriptorBufferInfo buffer_info(m_instance_buffer.m_buffer, 0, VK_WHOLE_SIZE);
+        std::vector<vk::WriteDescriptorSet> writes(DESCRIPTOR_SET_COUNT);
+        for (uint32_t i = 0; i < DESCRIPTOR_SET_COUNT; i++)
+        {
+            writes[i].setDstSet(m_descriptor_sets[i]);
+            writes[i].setDstBinding(0);
+            writes[i].setDescriptorCount(1);
+            writes[i].setDescriptorType(vk::DescriptorType::eStorageBuffer);
+            writes[i].setPBufferInfo(&buffer_info);
+        }
+        m_device.updateDescriptorSets(writes, nullptr);
+
+        return true;
+    }
+
+    /// @brief 间接模式是否可用
+    bool is_indirect_supported() const
+    {
+        return m_context.m_features.drawIndirectFirstInstance == VK_TRUE;
+    }
+
+    /// @brief 渲染若干帧并统计
+    bool run(Mode mode, uint32_t frames, uint32_t warmup, Result &result)
+    {
+        result = Result();
+        uint32_t max_draw_count = m_context.m_features.multiDrawIndirect ? m_context.m_properties.limits.maxDrawIndirectCount : 1;
+
+        bench::Stopwatch frame_stopwatch;
+        for (uint32_t frame = 0; frame < frames + warmup; frame++)
+        {
+            uint32_t slot = frame % FRAME_COUNT;
+            if (m_device.waitForFences(m_fences[slot], VK_TRUE, UINT64_MAX) != vk::Result::eSuccess)
+                return false;
+
+            // 槽位的上一次使用已完成，可以读取它的时间戳
+            if (m_has_timestamps && frame >= FRAME_COUNT && frame - FRAME_COUNT >= warmup)
+            {
+                uint64_t timestamps[2];
+                VkResult query_result = vkGetQueryPoolResults(
+                    static_cast<VkDevice>(m_device),
+                    static_cast<VkQueryPool>(m_query_pool),
+                    slot * 2,
+                    2,
+                    sizeof(timestamps),
+                    timestamps,
+                    sizeof(uint64_t),
+                    VK_QUERY_RESULT_64_BIT);
+                if (query_result == VK_SUCCESS)
+                    result.m_gpu_ms.push_back(((timestamps[1] - timestamps[0]) & m_timestamp_mask) * m_context.m_properties.limits.timestampPeriod * 1e-6);
+            }
+
+            if (frame > warmup)
+                result.m_frame_ms.push_back(frame_stopwatch.milliseconds());
+            frame_stopwatch.reset();
+
+            if (m_device.resetFences(m_fences[slot]) != vk::Result::eSuccess)
+                return false;
+
+            // 每帧重新生成排序键并排序，排序时间单独统计
+            bench::Stopwatch stopwatch;
+            if (is_material_mode(mode))
+            {
+                m_queue.clear();
+                for (uint32_t i = 0; i < m_count; i++)
+                    m_queue.push(vl::RenderQueue::make_key(0, m_pipeline_ids[i], m_set_ids[i], m_depths[i]), i);
+                stopwatch.reset();
+                if (mode != Mode::eUnsorted)
+                    m_queue.sort(m_pool);
+            }
+            double sort_ms = stopwatch.milliseconds();
+
+            stopwatch.reset();
+            vk::CommandBuffer cmd = m_command_buffers[slot];
+            uint32_t draw_calls = 0;
+            vl::RenderQueue::Statistics statistics;
+            size_t skipped_commands = 0;
+            if (!record(cmd, slot, mode, max_draw_count, draw_calls, statistics, skipped_commands))
+                return false;
+            double record_ms = stopwatch.milliseconds();
+
+            stopwatch.reset();
+            vk::SubmitInfo submit_info;
+            submit_info.setCommandBufferCount(1);
+            submit_info.setPCommandBuffers(&cmd);
+            if (m_context.m_graphics_queue.submit(submit_info, m_fences[slot]) != vk::Result::eSuccess)
+                return false;
+            double submit_ms = stopwatch.milliseconds();
+
+            if (frame >= warmup)
+            {
+                result.m_record_ms.push_back(record_ms);
+                result.m_submit_ms.push_back(submit_ms);
+                result.m_draw_calls = draw_calls;
+                result.m_statistics = statistics;
+                result.m_skipped_commands = skipped_commands;
+                if (mode == Mode::eSorted || mode == Mode::eBatched)
+                    result.m_sort_ms.push_back(sort_ms);
+            }
+        }
+
+        return m_device.waitIdle() == vk::Result::eSuccess;
+    }
+
+    /// @brief 是否为每个物体有自己管线和描述符集的模式
+    static bool is_material_mode(Mode mode)
+    {
+        return mode == Mode::eUnsorted || mode == Mode::eSorted || mode == Mode::eBatched;
+    }
+
+protected:
+    bool record(const vk::CommandBuffer &cmd, uint32_t slot, Mode mode, uint32_t max_draw_count, uint32_t &draw_calls, vl::RenderQueue::Statistics &statistics, size_t &skipped_commands)
+    {
+        vk::CommandBufferBeginInfo begin_info;
+        begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        if (cmd.begin(begin_info) != vk::Result::eSuccess)
+            return false;
+
+        if (m_has_timestamps)
+        {
+            cmd.resetQueryPool(m_query_pool, slot * 2, 2);
+            cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_query_pool, slot * 2);
+        }
+
+        vk::ClearValue clear_values[2];
+        clear_values[0].color = vk::ClearColorValue(std::array<float, 4>{0.1f, 0.1f, 0.1f, 1.0f});
+        clear_values[1].depthStencil = vk::ClearDepthStencilValue(1.0f, 0);
+
+        vk::RenderPassBeginInfo pass_info;
+        pass_info.setRenderPass(m_render_pass);
+        pass_info.setFramebuffer(m_framebuffer);
+        pass_info.setRenderArea(vk::Rect2D(vk::Offset2D(0, 0), vk::Extent2D(m_width, m_height)));
+        pass_info.setClearValueCount(2);
+        pass_info.setPClearValues(clear_values);
+        cmd.beginRenderPass(pass_info, vk::SubpassContents::eInline);
+
+        vl::CommandList<> list(cmd);
+        vk::DeviceSize offset = 0;
+        list.bind_vertex_buffers(0, 1, &m_vertex_buffer.m_buffer, &offset);
+        if (!is_material_mode(mode))
+        {
+            list.bind_pipeline(vk::PipelineBindPoint::eGraphics, m_pipelines[0], false);
+            list.bind_descriptor_set(vk::PipelineBindPoint::eGraphics, m_pipeline_layout, 0, m_descriptor_sets[0]);
+        }
+
+        // 按队列的顺序绘制，每个物体都绑定自己的状态，重复的绑定由CommandList去掉
+        auto emit = [&](uint64_t key, uint32_t index, uint32_t)
+        {
+            list.bind_pipeline(vk::PipelineBindPoint::eGraphics, m_pipelines[vl::RenderQueue::get_pipeline(key)], false);
+            list.bind_descriptor_set(vk::PipelineBindPoint::eGraphics, m_pipeline_layout, 0, m_descriptor_sets[vl::RenderQueue::get_descriptor_set(key)]);
+            list.bind_vertex_buffers(0, 1, &m_vertex_buffer.m_buffer, &offset);
+            list.draw(CUBE_VERTEX_COUNT, 1, 0, index);
+        };
+
+        switch (mode)
+        {
+        case Mode::ePerObject:
+            for (uint32_t i = 0; i < m_count; i++)
+                list.draw(CUBE_VERTEX_COUNT, 1, 0, i);
+            draw_calls = m_count;
+            break;
+
+        case Mode::eInstanced:
+            list.draw(CUBE_VERTEX_COUNT, m_count, 0, 0);
+            draw_calls = 1;
+            break;
+
+        case Mode::eIndirect:
+            // 不支持multiDrawIndirect时每次只能有一个命令
+            for (uint32_t first = 0; first < m_count; first += max_draw_count)
+            {
+                uint32_t count = std::min(max_draw_count, m_count - first);
+                list.draw_indirect(m_indirect_buffer.m_buffer, first * sizeof(VkDrawIndirectCommand), count, sizeof(VkDrawIndirectCommand));
+                draw_calls++;
+            }
+            break;
+
+        case Mode::eUnsorted:
+        case Mode::eSorted:
+            // 未排序时队列保持提交顺序
+            statistics = m_queue.emit(emit);
+            draw_calls = m_count;
+            break;
+
+        case Mode::eBatched:
+        {
+            // 生成这一帧的间接命令，槽位的上一次使用已经完成
+            vl::MappedBuffer &buffer = m_batch_buffers[slot];
+            m_batcher.build(m_queue, m_draws.data(), buffer.data<VkDrawIndexedIndirectCommand>(), m_count);
+            if (buffer.flush(m_device) != vk::Result::eSuccess)
+                return false;
+
+            list.bind_index_buffer(m_index_buffer.m_buffer, 0, vk::IndexType::eUint16);
+            m_batcher.record(
+                list,
+                buffer.m_buffer,
+                0,
+                max_draw_count,
+                [&](const vl::DrawBatcher::Batch &batch)
+                {
+                    list.bind_pipeline(vk::PipelineBindPoint::eGraphics, m_pipelines[batch.m_pipeline], false);
+                    list.bind_descriptor_set(vk::PipelineBindPoint::eGraphics, m_pipeline_layout, 0, m_descriptor_sets[batch.m_descriptor_set]);
+                });
+
+            const auto &list_statistics = list.get_statistics();
+            statistics.m_draw_count = m_batcher.get_command_count();
+            statistics.m_pipeline_changes = list_statistics.m_emitted[vl::CommandList<>::COMMAND_BIND_PIPELINE];
+            statistics.m_descriptor_set_changes = list_statistics.m_emitted[vl::CommandList<>::COMMAND_BIND_DESCRIPTOR_SETS];
+            draw_calls = static_cast<uint32_t>(list_statistics.m_emitted[vl::CommandList<>::COMMAND_DRAW]);
+            break;
+        }
+        }
+
+        skipped_commands = list.get_statistics().get_skipped();
+
+        cmd.endRenderPass();
+        if (m_has_timestamps)
+            cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_query_pool, slot * 2 + 1);
+
+        return cmd.end() == vk::Result::eSuccess;
+    }
+
+    bool create_image(vk::Format format, vk::ImageUsageFlags usage, vk::ImageAspectFlags aspect, vk::Image &image, vk::DeviceMemory &memory, vk::ImageView &view)
+    {
+        vk::ImageCreateInfo image_info;
+        image_info.setImageType(vk::ImageType::e2D);
+        image_info.setFormat(format);
+        image_info.setExtent(vk::Extent3D(m_width, m_height, 1));
+        image_info.setMipLevels(1);
+        image_info.setArrayLayers(1);
+        image_info.setSamples(vk::SampleCountFlagBits::e1);
+        image_info.setTiling(vk::ImageTiling::eOptimal);
+        image_info.setUsage(usage);
+        image_info.setSharingMode(vk::SharingMode::eExclusive);
+        image_info.setInitialLayout(vk::ImageLayout::eUndefined);
+        auto image_result = m_device.createImage(image_info);
+        if (image_result.result != vk::Result::eSuccess)
+            return false;
+        image = image_result.value;
+
+        auto memory_result = vl::DeviceUtils::allocate_image_memory(
+            m_device,
+            m_context.m_physical_device,
+            image,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::MemoryPropertyFlags());
+        if (memory_result.result != vk::Result::eSuccess)
+            return false;
+        memory = memory_result.value;
+
+        vk::ImageViewCreateInfo view_info;
+        view_info.setImage(image);
+        view_info.setViewType(vk::ImageViewType::e2D);
+        view_info.setFormat(format);
+        view_info.setSubresourceRange(vk::ImageSubresourceRange(aspect, 0, 1, 0, 1));
+        auto view_result = m_device.createImageView(view_info);
+        if (view_result.result != vk::Result::eSuccess)
+            return false;
+        view = view_result.value;
+        return true;
+    }
+
+    bool create_render_pass()
+    {
+        vk::AttachmentDescription attachments[2];
+        attachments[0].setFormat(m_color_format);
+        attachments[0].setSamples(vk::SampleCountFlagBits::e1);
+        attachments[0].setLoadOp(vk::AttachmentLoadOp::eClear);
+        attachments[0].setStoreOp(vk::AttachmentStoreOp::eStore);
+        attachments[0].setStencilLoadOp(vk::AttachmentLoadOp::eDontCare);
+        attachments[0].setStencilStoreOp(vk::AttachmentStoreOp::eDontCare);
+        attachments[0].setInitialLayout(vk::ImageLayout::eUndefined);
+        attachments[0].setFinalLayout(vk::ImageLayout::eColorAttachmentOptimal);
+        attachments[1].setFormat(m_depth_format);
+        attachments[1].setSamples(vk::SampleCountFlagBits::e1);
+        attachments[1].setLoadOp(vk::AttachmentLoadOp::eClear);
+        attachments[1].setStoreOp(vk::AttachmentStoreOp::eDontCare);
+        attachments[1].setStencilLoadOp(vk::AttachmentLoadOp::eDontCare);
+        attachments[1].setStencilStoreOp(vk::AttachmentStoreOp::eDontCare);
+        attachments[1].setInitialLayout(vk::ImageLayout::eUndefined);
+        attachments[1].setFinalLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
+
+        vk::AttachmentReference color_reference(0, vk::ImageLayout::eColorAttachmentOptimal);
+        vk::AttachmentReference depth_reference(1, vk::ImageLayout::eDepthStencilAttachmentOptimal);
+        vk::SubpassDescription subpass;
+        subpass.setPipelineBindPoint(vk::PipelineBindPoint::eGraphics);
+        subpass.setColorAttachmentCount(1);
+        subpass.setPColorAttachments(&color_reference);
+        subpass.setPDepthStencilAttachment(&depth_reference);
+
+        vk::RenderPassCreateInfo pass_info;
+        pass_info.setAttachmentCount(2);
+        pass_info.setPAttachments(attachments);
+        pass_info.setSubpassCount(1);
+        pass_info.setPSubpasses(&subpass);
+        auto pass_result = m_device.createRenderPass(pass_info);
+        if (pass_result.result != vk::Result::eSuccess)
+            return false;
+        m_render_pass = pass_result.value;
+
+        vk::ImageView views[2] = {m_color_view, m_depth_view};
+        vk::FramebufferCreateInfo framebuffer_info;
+        framebuffer_info.setRenderPass(m_render_pass);
+        framebuffer_info.setAttachmentCount(2);
+        framebuffer_info.setPAttachments(views);
+        framebuffer_info.setWidth(m_width);
+        framebuffer_info.setHeight(m_height);
+        framebuffer_info.setLayers(1);
+        auto framebuffer_result = m_device.createFramebuffer(framebuffer_info);
+        if (framebuffer_result.result != vk::Result::eSuccess)
+            return false;
+        m_framebuffer = framebuffer_result.value;
+        return true;
+    }
+
+    bool create_pipeline()
+    {
+        vk::DescriptorSetLayoutBinding binding(0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eVertex);
+        vk::DescriptorSetLayoutCreateInfo set_layout_info;
+        set_layout_info.setBindingCount(1);
+        set_layout_info.setPBindings(&binding);
+        auto set_layout_result = m_device.createDescriptorSetLayout(set_layout_info);
+        if (set_layout_result.result != vk::Result::eSuccess)
+            return false;
+        m_set_layout = set_layout_result.value;
+
+        vk::DescriptorPoolSize pool_size(vk::DescriptorType::eStorageBuffer, DESCRIPTOR_SET_COUNT);
+        vk::DescriptorPoolCreateInfo pool_info;
+        pool_info.setMaxSets(DESCRIPTOR_SET_COUNT);
+        pool_info.setPoolSizeCount(1);
+        pool_info.setPPoolSizes(&pool_size);
+        auto pool_result = m_device.createDescriptorPool(pool_info);
+        if (pool_result.result != vk::Result::eSuccess)
+            return false;
+        m_descriptor_pool = pool_result.value;
+
+        std::vector<vk::DescriptorSetLayout> set_layouts(DESCRIPTOR_SET_COUNT, m_set_layout);
+        vk::DescriptorSetAllocateInfo set_info;
+        set_info.setDescriptorPool(m_descriptor_pool);
+        set_info.setDescriptorSetCount(DESCRIPTOR_SET_COUNT);
+        set_info.setPSetLayouts(set_layouts.data());
+        auto set_result = m_device.allocateDescriptorSets(set_info);
+        if (set_result.result != vk::Result::eSuccess)
+            return false;
+        for (uint32_t i = 0; i < DESCRIPTOR_SET_COUNT; i++)
+            m_descriptor_sets[i] = set_result.value.at(i);
+
+        vk::PipelineLayoutCreateInfo layout_info;
+        layout_info.setSetLayoutCount(1);
+        layout_info.setPSetLayouts(&m_set_layout);
+        auto layout_result = m_device.createPipelineLayout(layout_info);
+        if (layout_result.result != vk::Result::eSuccess)
+            return false;
+        m_pipeline_layout = layout_result.value;
+
+        static const uint32_t vertex_code[] = {
+#include "shaders/stress.vert.inc"
+        };
+        static const uint32_t fragment_code[] = {
+#include "shaders/stress.frag.inc"
+        };
+        auto vertex_result = vl::DeviceUtils::create_shader_module(m_device, vertex_code, sizeof(vertex_code));
+        auto fragment_result = vl::DeviceUtils::create_shader_module(m_device, fragment_code, sizeof(fragment_code));
+        if (vertex_result.result != vk::Result::eSuccess || fragment_result.result != vk::Result::eSuccess)
+        {
+            if (vertex_result.value)
+                m_device.destroyShaderModule(vertex_result.value);
+            if (fragment_result.value)
+                m_device.destroyShaderModule(fragment_result.value);
+            return false;
+        }
+
+        vk::PipelineShaderStageCreateInfo stages[2];
+        stages[0].setStage(vk::ShaderStageFlagBits::eVertex);
+        stages[0].setModule(vertex_result.value);
+        stages[0].setPName("main");
+        stages[1].setStage(vk::ShaderStageFlagBits::eFragment);
+        stages[1].setModule(fragment_result.value);
+        stages[1].setPName("main");
+
+        vl::VertexLayout vertex_layout;
+        vertex_layout.add(vl::VertexLayout::ATTRIBUTE_POSITION, vl::VertexLayout::ENCODING_FLOAT, 0);
+        std::vector<vk::VertexInputBindingDescription> vertex_bindings = vertex_layout.get_binding_descriptions();
+        std::vector<vk::VertexInputAttributeDescription> vertex_attributes = vertex_layout.get_attribute_descriptions();
+        vk::PipelineVertexInputStateCreateInfo vertex_input;
+        vertex_input.setVertexBindingDescriptionCount(static_cast<uint32_t>(vertex_bindings.size()));
+        vertex_input.setPVertexBindingDescriptions(vertex_bindings.data());
+        vertex_input.setVertexAttributeDescriptionCount(static_cast<uint32_t>(vertex_attributes.size()));
+        vertex_input.setPVertexAttributeDescriptions(vertex_attributes.data());
+
+        vk::PipelineInputAssemblyStateCreateInfo input_assembly;
+        input_assembly.setTopology(vk::PrimitiveTopology::eTriangleList);
+
+        vk::Viewport viewport(0.0f, 0.0f, static_cast<float>(m_width), static_cast<float>(m_height), 0.0f, 1.0f);
+        vk::Rect2D scissor(vk::Offset2D(0, 0), vk::Extent2D(m_width, m_height));
+        vk::PipelineViewportStateCreateInfo viewport_state;
+        viewport_state.setViewportCount(1);
+        viewport_state.setPViewports(&viewport);
+        viewport_state.setScissorCount(1);
+        viewport_state.setPScissors(&scissor);
+
+        vk::PipelineRasterizationStateCreateInfo rasterization;
+        rasterization.setPolygonMode(vk::PolygonMode::eFill);
+        rasterization.setCullMode(vk::CullModeFlagBits::eNone);
+        rasterization.setFrontFace(vk::FrontFace::eCounterClockwise);
+        rasterization.setLineWidth(1.0f);
+
+        vk::PipelineMultisampleStateCreateInfo multisample;
+        multisample.setRasterizationSamples(vk::SampleCountFlagBits::e1);
+
+        vk::PipelineDepthStencilStateCreateInfo depth_stencil;
+        depth_stencil.setDepthTestEnable(VK_TRUE);
+        depth_stencil.setDepthWriteEnable(VK_TRUE);
+        depth_stencil.setDepthCompareOp(vk::CompareOp::eLessOrEqual);
+
+        vk::PipelineColorBlendAttachmentState blend_attachment;
+        blend_attachment.setColorWriteMask(
+            vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+            vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA);
+        vk::PipelineColorBlendStateCreateInfo color_blend;
+        color_blend.setAttachmentCount(1);
+        color_blend.setPAttachments(&blend_attachment);
+
+        vk::GraphicsPipelineCreateInfo pipeline_info;
+        pipeline_info.setStageCount(2);
+        pipeline_info.setPStages(stages);
+        pipeline_info.setPVertexInputState(&vertex_input);
+        pipeline_info.setPInputAssemblyState(&input_assembly);
+        pipeline_info.setPViewportState(&viewport_state);
+        pipeline_info.setPRasterizationState(&rasterization);
+        pipeline_info.setPMultisampleState(&multisample);
+        pipeline_info.setPDepthStencilState(&depth_stencil);
+        pipeline_info.setPColorBlendState(&color_blend);
+        pipeline_info.setLayout(m_pipeline_layout);
+        pipeline_info.setRenderPass(m_render_pass);
+        pipeline_info.setSubpass(0);
+
+        // 每个变体的特化常量brightness不同
+        vk::SpecializationMapEntry specialization_entry(0, 0, sizeof(float));
+        bool is_created = true;
+        for (uint32_t i = 0; i < PIPELINE_COUNT && is_created; i++)
+        {
+            float brightness = 1.0f - 0.05f * i;
+            vk::SpecializationInfo specialization_info(1, &specialization_entry, sizeof(brightness), &brightness);
+            stages[1].setPSpecializationInfo(&specialization_info);
+            auto pipeline_result = m_device.createGraphicsPipeline(nullptr, pipeline_info);
+            is_created = pipeline_result.result == vk::Result::eSuccess;
+            if (is_created)
+                m_pipelines[i] = pipeline_result.value;
+        }
+
+        m_device.destroyShaderModule(vertex_result.value);
+        m_device.destroyShaderModule(fragment_result.value);
+        return is_created;
+    }
+};
+
+/// @brief 多立方体压力基准：N个立方体，逐个绘制、实例化、间接绘制，以及按排序键排序前后的状态切换
+int run_cube_stress_bench(int argc, char **argv)
+{
+    std::vector<uint64_t> counts = bench::get_list_option(argc, argv, "--counts", "1,1000,10000,100000");
+    std::string mode_name = bench::get_option(argc, argv, "--mode", std::string("all"));
+    uint32_t frames = static_cast<uint32_t>(bench::get_option(argc, argv, "--frames", 60LL));
+    uint32_t width = static_cast<uint32_t>(bench::get_option(argc, argv, "--width", 640LL));
+    uint32_t height = static_cast<uint32_t>(bench::get_option(argc, argv, "--height", 360LL));
+
+    vl::HeadlessContext::Config config;
+    config.m_name = "cube stress";
+    config.m_device_name = bench::get_option(argc, argv, "--device", std::string());
+    config.m_features.setMultiDrawIndirect(VK_TRUE);
+    config.m_features.setDrawIndirectFirstInstance(VK_TRUE);
+    if (bench::has_flag(argc, argv, "--validation"))
+        config.m_validation_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+    vl::HeadlessContext context;
+    if (context.create(config) != vk::Result::eSuccess)
+    {
+        std::cout << "unable to create headless vulkan context" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    vl::ThreadPool pool;
+    int exit_code = EXIT_SUCCESS;
+    {
+        CubeStressScene scene(context);
+        if (!scene.create(width, height))
+        {
+            std::cout << "unable to create stress scene" << std::endl;
+            context.destroy();
+            return EXIT_FAILURE;
+        }
+
+        std::cout << "cube stress: " << context.get_device_name() << ", " << width << "x" << height
+                  << ", " << frames << " frames, multiDrawIndirect " << (context.m_features.multiDrawIndirect ? "on" : "off") << std::endl
+                  << "      cubes  mode         draws  record ms  submit ms   frame p50   frame p95   frame p99     gpu p50" << std::endl;
+
+        struct ModeInfo
+        {
+            CubeStressScene::Mode m_mode;
+            const char *m_name;
+        };
+        const ModeInfo modes[] = {
+            {CubeStressScene::Mode::ePerObject, "per-object"},
+            {CubeStressScene::Mode::eInstanced, "instanced"},
+            {CubeStressScene::Mode::eIndirect, "indirect"},
+            {CubeStressScene::Mode::eUnsorted, "unsorted"},
+            {CubeStressScene::Mode::eSorted, "sorted"},
+            {CubeStressScene::Mode::eBatched, "batched"},
+        };
+
+        for (uint64_t value : counts)
+        {
+            uint32_t count = static_cast<uint32_t>(value);
+            if (!scene.prepare(count, pool))
+            {
+                std::cout << "unable to prepare " << count << " cubes" << std::endl;
+                exit_code = EXIT_FAILURE;
+                break;
+            }
+
+            for (const ModeInfo &mode : modes)
+            {
+                if (mode_name != "all" && mode_name != mode.m_name)
+                    continue;
+                if ((mode.m_mode == CubeStressScene::Mode::eIndirect || mode.m_mode == CubeStressScene::Mode::eBatched) && !scene.is_indirect_supported())
+                {
+                    std::cout << std::setw(11) << count << "  " << std::left << std::setw(11) << mode.m_name << std::right
+                              << "  skipped, drawIndirectFirstInstance is not supported" << std::endl;
+                    continue;
+                }
+
+                CubeStressScene::Result result;
+                if (!scene.run(mode.m_mode, frames, 3, result))
+                {
+                    std::cout << "rendering failed" << std::endl;
+                    exit_code = EXIT_FAILURE;
+                    break;
+                }
+
+                auto mean = [](const std::vector<double> &values)
+                {
+                    double sum = 0.0;
+                    for (double value : values)
+                        sum += value;
+                    return values.empty() ? 0.0 : sum / values.size();
+                };
+
+                std::cout << std::fixed << std::setprecision(3)
+                          << std::setw(11) << count << "  " << std::left << std::setw(11) << mode.m_name << std::right
+                          << std::setw(7) << result.m_draw_calls
+                          << std::setw(11) << mean(result.m_record_ms)
+                          << std::setw(11) << mean(result.m_submit_ms)
+                          << std::setw(12) << bench::percentile(result.m_frame_ms, 50)
+                          << std::setw(12) << bench::percentile(result.m_frame_ms, 95)
+                          << std::setw(12) << bench::percentile(result.m_frame_ms, 99)
+                          << std::setw(12);
+                if (result.m_gpu_ms.empty())
+                    std::cout << "n/a";
+                else
+                    std::cout << bench::percentile(result.m_gpu_ms, 50);
+                std::cout << std::defaultfloat << std::endl;
+
+                // 有材质的模式额外输出状态切换次数和排序吞吐量
+                if (CubeStressScene::is_material_mode(mode.m_mode))
+                {
+                    std::cout << "             pipeline binds " << result.m_statistics.m_pipeline_changes
+                              << ", set binds " << result.m_statistics.m_descriptor_set_changes
+                              << ", skipped " << result.m_skipped_commands << " redundant commands";
+                    if (!result.m_sort_ms.empty())
+                    {
+                        double sort_ms = bench::percentile(result.m_sort_ms, 50);
+                        std::cout << std::fixed << std::setprecision(3)
+                                  << ", sort p50 " << sort_ms << " ms, "
+                                  << (sort_ms > 0.0 ? count / (sort_ms * 1000.0) : 0.0) << " Mkeys/s"
+                                  << std::defaultfloat;
+                    }
+                    std::cout << std::endl;
+                }
+            }
+        }
+    }
+
+    context.destroy();
+    return exit_code;
+}
+
+#endif
\ No newline at end of file
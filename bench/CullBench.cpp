@@ -0,0 +1,521 @@
+#ifndef CULLBENCH_CPP
+#define CULLBENCH_CPP
+
+#include <cmath>
+#include <cstring>
+#include <set>
+#include "Bench.hpp"
+#include "../examples/demo/linmath.h"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/PhysicalDeviceUtils.hpp"
+#include "../src/PhysicalDeviceUtils.cpp"
+#include "../src/DefaultQueueFamilyIndices.hpp"
+#include "../src/DefaultQueueFamilyIndices.cpp"
+#include "../src/HeadlessContext.hpp"
+#include "../src/HeadlessContext.cpp"
+#include "../src/MappedBuffer.hpp"
+#include "../src/MappedBuffer.cpp"
+#include "../src/FrustumUtils.hpp"
+#include "../src/FrustumUtils.cpp"
+#include "../src/GpuCuller.hpp"
+#include "../src/GpuCuller.cpp"
+
+/// @brief CPU参考实现，逻辑与cull.comp和hiz.comp相同
+class ReferenceCuller
+{
+public:
+    /// @brief 结果
+    enum class Visibility
+    {
+        eVisible,
+        eCulled,
+        /// @brief 处于边界上，浮点误差可能使GPU得到任一结果
+        eBorderline,
+    };
+
+    static constexpr float PLANE_EPSILON = 1e-3f;
+    static constexpr float DEPTH_EPSILON = 1e-5f;
+    static constexpr float TEXEL_EPSILON = 1e-3f;
+
+public:
+    float m_view_projection[16];
+    float m_planes[vl::FrustumUtils::PLANE_COUNT * 4];
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+
+    /// @brief 金字塔，第0层为深度图像
+    std::vector<std::vector<float>> m_levels;
+
+public:
+    ReferenceCuller(const float view_projection[16])
+    {
+        std::memcpy(m_view_projection, view_projection, sizeof(m_view_projection));
+        vl::FrustumUtils::extract_planes(view_projection, m_planes);
+    }
+
+    void build_pyramid(const std::vector<float> &depth, uint32_t width, uint32_t height)
+    {
+        m_width = width;
+        m_height = height;
+        m_levels.clear();
+        m_levels.push_back(depth);
+
+        int source_width = width, source_height = height;
+        for (uint32_t level = 1; std::max(width >> (level - 1), height >> (level - 1)) > 1; level++)
+        {
+            int destination_width = std::max(static_cast<int>(width >> level), 1);
+            int destination_height = std::max(static_cast<int>(height >> level), 1);
+            const std::vector<float> &source = m_levels.back();
+            std::vector<float> destination(destination_width * destination_height);
+            for (int y = 0; y < destination_height; y++)
+                for (int x = 0; x < destination_width; x++)
+                {
+                    int begin_x = x * source_width / destination_width;
+                    int begin_y = y * source_height / destination_height;
+                    int end_x = x == destination_width - 1 ? source_width : (x + 1) * source_width / destination_width;
+                    int end_y = y == destination_height - 1 ? source_height : (y + 1) * source_height / destination_height;
+                    float farthest = 0.0f;
+                    for (int sy = begin_y; sy < end_y; sy++)
+                        for (int sx = begin_x; sx < end_x; sx++)
+                            farthest = std::max(farthest, source[sy * source_width + sx]);
+                    destination[y * destination_width + x] = farthest;
+                }
+            m_levels.push_back(std::move(destination));
+            source_width = destination_width;
+            source_height = destination_height;
+        }
+    }
+
+    Visibility test(const vl::GpuCuller::Object &object, bool is_hiz_enabled) const
+    {
+        const float *sphere = object.m_sphere;
+        float min_distance = INFINITY;
+        for (uint32_t i = 0; i < vl::FrustumUtils::PLANE_COUNT; i++)
+        {
+            const float *plane = m_planes + i * 4;
+            min_distance = std::min(min_distance, plane[0] * sphere[0] + plane[1] * sphere[1] + plane[2] * sphere[2] + plane[3] + sphere[3]);
+        }
+        if (min_distance < -PLANE_EPSILON)
+            return Visibility::eCulled;
+        if (min_distance <= PLANE_EPSILON)
+            return Visibility::eBorderline;
+        if (!is_hiz_enabled)
+            return Visibility::eVisible;
+        return test_occlusion(sphere);
+    }
+
+protected:
+    Visibility test_occlusion(const float sphere[4]) const
+    {
+        float rect_min[2] = {1.0f, 1.0f}, rect_max[2] = {0.0f, 0.0f};
+        float nearest = 1.0f;
+        for (int i = 0; i < 8; i++)
+        {
+            float corner[4] = {
+                sphere[0] + ((i & 1) ? sphere[3] : -sphere[3]),
+                sphere[1] + ((i & 2) ? sphere[3] : -sphere[3]),
+                sphere[2] + ((i & 4) ? sphere[3] : -sphere[3]),
+                1.0f};
+            float clip[4];
+            for (int r = 0; r < 4; r++)
+                clip[r] = m_view_projection[r] * corner[0] + m_view_projection[4 + r] * corner[1] +
+                          m_view_projection[8 + r] * corner[2] + m_view_projection[12 + r];
+            if (clip[3] <= 1e-5f)
+                return std::abs(clip[3] - 1e-5f) < 1e-4f ? Visibility::eBorderline : Visibility::eVisible;
+            for (int k = 0; k < 2; k++)
+            {
+                float uv = clip[k] / clip[3] * 0.5f + 0.5f;
+                rect_min[k] = std::min(rect_min[k], uv);
+                rect_max[k] = std::max(rect_max[k], uv);
+            }
+            nearest = std::min(nearest, clip[2] / clip[3]);
+        }
+
+        bool is_borderline = false;
+        float size[2] = {static_cast<float>(m_width), static_cast<float>(m_height)};
+        float extent = 1.0f;
+        for (int k = 0; k < 2; k++)
+        {
+            rect_min[k] = std::clamp(rect_min[k], 0.0f, 1.0f);
+            rect_max[k] = std::clamp(rect_max[k], 0.0f, 1.0f);
+            extent = std::max(extent, (rect_max[k] - rect_min[k]) * size[k]);
+            // 纹素坐标接近整数时GPU可能落到相邻的纹素
+            for (float value : {rect_min[k] * size[k], rect_max[k] * size[k]})
+                if (std::abs(value - std::round(value)) < TEXEL_EPSILON * size[k])
+                    is_borderline = true;
+        }
+        float exact_level = std::log2(extent);
+        if (exact_level > 0.0f && std::abs(exact_level - std::round(exact_level)) < 1e-3f)
+            is_borderline = true;
+
+        int level = std::min(static_cast<int>(std::ceil(exact_level)), static_cast<int>(m_levels.size()) - 1);
+        int level_width = std::max(static_cast<int>(m_width) >> level, 1);
+        int level_height = std::max(static_cast<int>(m_height) >> level, 1);
+        int min_x = std::min(static_cast<int>(rect_min[0] * size[0]) >> level, level_width - 1);
+        int min_y = std::min(static_cast<int>(rect_min[1] * size[1]) >> level, level_height - 1);
+        int max_x = std::min(static_cast<int>(rect_max[0] * size[0]) >> level, level_width - 1);
+        int max_y = std::min(static_cast<int>(rect_max[1] * size[1]) >> level, level_height - 1);
+
+        float farthest = 0.0f;
+        const std::vector<float> &texels = m_levels.at(level);
+        for (int y = min_y; y <= max_y; y++)
+            for (int x = min_x; x <= max_x; x++)
+                farthest = std::max(farthest, texels[y * level_width + x]);
+
+        if (is_borderline || std::abs(nearest - farthest) < DEPTH_EPSILON)
+            return Visibility::eBorderline;
+        return nearest > farthest ? Visibility::eCulled : Visibility::eVisible;
+    }
+};
+
+/// @brief 无窗口的剔除验证环境
+class CullValidator
+{
+public:
+    static constexpr uint32_t WIDTH = 320;
+    static constexpr uint32_t HEIGHT = 180;
+
+protected:
+    vl::HeadlessContext &m_context;
+    vk::Device m_device;
+    vl::GpuCuller m_culler;
+    vl::MappedBuffer m_readback;
+
+    vk::Image m_depth_image;
+    vk::DeviceMemory m_depth_memory;
+    vk::ImageView m_depth_view;
+
+public:
+    CullValidator(vl::HeadlessContext &context) : m_context(context), m_device(context.m_device) {}
+    ~CullValidator()
+    {
+        m_culler.destroy();
+        m_readback.destroy(m_device);
+        if (m_depth_view)
+            m_device.destroyImageView(m_depth_view);
+        if (m_depth_image)
+            m_device.destroyImage(m_depth_image);
+        if (m_depth_memory)
+            m_device.freeMemory(m_depth_memory);
+    }
+
+public:
+    bool create(uint32_t max_objects)
+    {
+        static const uint32_t cull_code[] = {
+#include "shaders/cull.comp.inc"
+        };
+        static const uint32_t hiz_code[] = {
+#include "shaders/hiz.comp.inc"
+        };
+
+        vl::GpuCuller::Config config;
+        config.m_max_objects = max_objects;
+        config.m_cull_code = cull_code;
+        config.m_cull_code_size = sizeof(cull_code);
+        config.m_hiz_code = hiz_code;
+        config.m_hiz_code_size = sizeof(hiz_code);
+        config.m_hiz_width = WIDTH;
+        config.m_hiz_height = HEIGHT;
+        config.m_is_draw_indirect_count_enabled = m_context.is_extension_enabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        config.m_is_multi_draw_indirect_enabled = m_context.m_features.multiDrawIndirect == VK_TRUE;
+        if (m_culler.create(m_device, m_context.m_physical_device, m_context.m_queue_family_indices, config) != vk::Result::eSuccess)
+            return false;
+
+        return m_readback.create(
+                   m_device,
+                   m_context.m_physical_device,
+                   sizeof(VkDrawIndexedIndirectCommand) * max_objects + sizeof(uint32_t),
+                   vk::BufferUsageFlagBits::eTransferDst,
+                   vk::MemoryPropertyFlagBits::eHostCached) == vk::Result::eSuccess;
+    }
+
+    /// @brief 上传深度图像并设置给剔除器，不支持时返回false
+    bool upload_depth(const std::vector<float> &depth)
+    {
+        vk::FormatProperties properties = m_context.m_physical_device.getFormatProperties(vk::Format::eD32Sfloat);
+        if (!(properties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImage))
+            return false;
+
+        // 深度复制只能在图形队列上进行，计算系列不同时并发共享
+        std::vector<uint32_t> families = {*m_context.m_queue_family_indices.m_graphics_family};
+        if (*m_context.m_queue_family_indices.m_compute_family != families.at(0))
+            families.push_back(*m_context.m_queue_family_indices.m_compute_family);
+
+        vk::ImageCreateInfo image_info;
+        image_info.setImageType(vk::ImageType::e2D);
+        image_info.setFormat(vk::Format::eD32Sfloat);
+        image_info.setExtent(vk::Extent3D(WIDTH, HEIGHT, 1));
+        image_info.setMipLevels(1);
+        image_info.setArrayLayers(1);
+        image_info.setSamples(vk::SampleCountFlagBits::e1);
+        image_info.setTiling(vk::ImageTiling::eOptimal);
+        image_info.setUsage(vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eDepthStencilAttachment);
+        image_info.setSharingMode(families.size() > 1 ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive);
+        image_info.setQueueFamilyIndexCount(static_cast<uint32_t>(families.size()));
+        image_info.setPQueueFamilyIndices(families.data());
+        image_info.setInitialLayout(vk::ImageLayout::eUndefined);
+        auto image_result = m_device.createImage(image_info);
+        if (image_result.result != vk::Result::eSuccess)
+            return false;
+        m_depth_image = image_result.value;
+
+        auto memory_result = vl::DeviceUtils::allocate_image_memory(
+            m_device,
+            m_context.m_physical_device,
+            m_depth_image,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::MemoryPropertyFlags());
+        if (memory_result.result != vk::Result::eSuccess)
+            return false;
+        m_depth_memory = memory_result.value;
+
+        vk::ImageViewCreateInfo view_info;
+        view_info.setImage(m_depth_image);
+        view_info.setViewType(vk::ImageViewType::e2D);
+        view_info.setFormat(vk::Format::eD32Sfloat);
+        view_info.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1));
+        auto view_result = m_device.createImageView(view_info);
+        if (view_result.result != vk::Result::eSuccess)
+            return false;
+        m_depth_view = view_result.value;
+
+        vl::MappedBuffer staging;
+        if (staging.create(m_device, m_context.m_physical_device, depth.size() * sizeof(float), vk::BufferUsageFlagBits::eTransferSrc) != vk::Result::eSuccess)
+            return false;
+        std::memcpy(staging.m_mapped, depth.data(), depth.size() * sizeof(float));
+        staging.flush(m_device);
+
+        auto command_result = m_context.begin_one_time();
+        if (command_result.result != vk::Result::eSuccess)
+        {
+            staging.destroy(m_device);
+            return false;
+        }
+        vk::CommandBuffer cmd = command_result.value;
+
+        vk::ImageMemoryBarrier barrier;
+        barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barrier.setOldLayout(vk::ImageLayout::eUndefined);
+        barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+        barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setImage(m_depth_image);
+        barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1));
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, nullptr, barrier);
+
+        vk::BufferImageCopy region;
+        region.setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eDepth, 0, 0, 1));
+        region.setImageExtent(vk::Extent3D(WIDTH, HEIGHT, 1));
+        cmd.copyBufferToImage(staging.m_buffer, m_depth_image, vk::ImageLayout::eTransferDstOptimal, region);
+
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+        barrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
+        barrier.setNewLayout(vk::ImageLayout::eDepthStencilReadOnlyOptimal);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags(), nullptr, nullptr, barrier);
+
+        vk::Result result = m_context.end_one_time(cmd);
+        staging.destroy(m_device);
+        if (result != vk::Result::eSuccess)
+            return false;
+
+        return m_culler.set_depth(m_depth_view, image_info.sharingMode, vk::ImageLayout::eDepthStencilReadOnlyOptimal);
+    }
+
+    vl::GpuCuller::Object *get_objects() const { return m_culler.get_objects(); }
+
+    /// @brief 在计算队列上剔除并读回结果
+    bool cull(const float view_projection[16], uint32_t object_count, bool is_hiz_enabled, double &milliseconds)
+    {
+        if (m_culler.m_object_buffer.flush(m_device) != vk::Result::eSuccess)
+            return false;
+
+        bench::Stopwatch stopwatch;
+        auto command_result = m_context.begin_one_time(true);
+        if (command_result.result != vk::Result::eSuccess)
+            return false;
+        vk::CommandBuffer cmd = command_result.value;
+
+        if (is_hiz_enabled)
+            m_culler.record_hiz(cmd);
+        m_culler.record_cull(cmd, view_projection, object_count, is_hiz_enabled);
+
+        vk::DeviceSize draw_size = sizeof(VkDrawIndexedIndirectCommand) * object_count;
+        if (draw_size > 0)
+            cmd.copyBuffer(m_culler.m_draw_buffer, m_readback.m_buffer, vk::BufferCopy(0, 0, draw_size));
+        cmd.copyBuffer(m_culler.m_count_buffer, m_readback.m_buffer, vk::BufferCopy(0, m_readback.m_size - sizeof(uint32_t), sizeof(uint32_t)));
+
+        vk::MemoryBarrier barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), barrier, nullptr, nullptr);
+
+        if (m_context.end_one_time(cmd, true) != vk::Result::eSuccess)
+            return false;
+        milliseconds = stopwatch.milliseconds();
+        return m_readback.invalidate(m_device) == vk::Result::eSuccess;
+    }
+
+    uint32_t get_draw_count() const
+    {
+        uint32_t count;
+        std::memcpy(&count, static_cast<const uint8_t *>(m_readback.m_mapped) + m_readback.m_size - sizeof(uint32_t), sizeof(count));
+        return count;
+    }
+
+    const VkDrawIndexedIndirectCommand *get_draws() const
+    {
+        return m_readback.data<VkDrawIndexedIndirectCommand>();
+    }
+};
+
+/// @brief 剔除验证：GPU剔除的输出与CPU参考实现比较
+int run_cull_bench(int argc, char **argv)
+{
+    std::vector<uint64_t> counts = bench::get_list_option(argc, argv, "--counts", "1000,100000,1000000");
+    uint64_t max_count = counts.empty() ? 0 : *std::max_element(counts.begin(), counts.end());
+
+    vl::HeadlessContext::Config config;
+    config.m_name = "gpu culling";
+    config.m_device_name = bench::get_option(argc, argv, "--device", std::string());
+    config.m_features.setMultiDrawIndirect(VK_TRUE);
+    config.m_device_extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    if (bench::has_flag(argc, argv, "--validation"))
+        config.m_validation_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+    vl::HeadlessContext context;
+    if (max_count == 0 || context.create(config) != vk::Result::eSuccess)
+    {
+        std::cout << "unable to create headless vulkan context" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // 深度范围为[0, 1]的投影，相机在原点看向-z
+    mat4x4 projection, view, view_projection;
+    vec3 eye = {0.0f, 0.0f, 0.0f}, center = {0.0f, 0.0f, -1.0f}, up = {0.0f, 1.0f, 0.0f};
+    mat4x4_perspective(projection, 1.0f, static_cast<float>(CullValidator::WIDTH) / CullValidator::HEIGHT, 1.0f, 200.0f);
+    for (int c = 0; c < 4; c++)
+        projection[c][2] = 0.5f * projection[c][2] + 0.5f * projection[c][3];
+    mat4x4_look_at(view, eye, center, up);
+    mat4x4_mul(view_projection, projection, view);
+    const float *vp = &view_projection[0][0];
+
+    // 合成的深度：左边60%是距离30的墙，其余为远平面
+    vec4 wall = {0.0f, 0.0f, -30.0f, 1.0f}, wall_clip;
+    mat4x4_mul_vec4(wall_clip, view_projection, wall);
+    std::vector<float> depth(CullValidator::WIDTH * CullValidator::HEIGHT, 1.0f);
+    for (uint32_t y = 0; y < CullValidator::HEIGHT; y++)
+        for (uint32_t x = 0; x < CullValidator::WIDTH * 3 / 5; x++)
+            depth[y * CullValidator::WIDTH + x] = wall_clip[2] / wall_clip[3];
+
+    ReferenceCuller reference(vp);
+    reference.build_pyramid(depth, CullValidator::WIDTH, CullValidator::HEIGHT);
+
+    int exit_code = EXIT_SUCCESS;
+    {
+        CullValidator validator(context);
+        if (!validator.create(static_cast<uint32_t>(max_count)))
+        {
+            std::cout << "unable to create culler" << std::endl;
+            context.destroy();
+            return EXIT_FAILURE;
+        }
+        bool has_hiz = validator.upload_depth(depth);
+
+        std::cout << "gpu culling: " << context.get_device_name()
+                  << ", draw indirect count " << (context.is_extension_enabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) ? "on" : "off")
+                  << ", hi-z " << (has_hiz ? "on" : "off (D32_SFLOAT cannot be sampled)") << std::endl
+                  << "    objects  hi-z   visible  borderline  mismatches  gpu ms  cpu ms" << std::endl;
+
+        for (uint64_t value : counts)
+        {
+            uint32_t count = static_cast<uint32_t>(value);
+            uint32_t state = count;
+            auto next = [&state]()
+            {
+                state = state * 1664525u + 1013904223u;
+                return static_cast<float>(state >> 8) / 16777216.0f;
+            };
+
+            vl::GpuCuller::Object *objects = validator.get_objects();
+            for (uint32_t i = 0; i < count; i++)
+            {
+                objects[i].m_sphere[0] = next() * 120.0f - 60.0f;
+                objects[i].m_sphere[1] = next() * 80.0f - 40.0f;
+                objects[i].m_sphere[2] = -2.0f - next() * 98.0f;
+                objects[i].m_sphere[3] = 0.2f + next() * 1.8f;
+                objects[i].m_index_count = 36 + i % 3 * 6;
+                objects[i].m_first_index = i % 5 * 36;
+                objects[i].m_vertex_offset = static_cast<int32_t>(i % 7);
+            }
+
+            for (bool is_hiz_enabled : {false, true})
+            {
+                if (is_hiz_enabled && !has_hiz)
+                    continue;
+
+                double gpu_ms = 0.0;
+                if (!validator.cull(vp, count, is_hiz_enabled, gpu_ms))
+                {
+                    std::cout << "culling failed" << std::endl;
+                    exit_code = EXIT_FAILURE;
+                    break;
+                }
+
+                bench::Stopwatch stopwatch;
+                std::vector<ReferenceCuller::Visibility> expected(count);
+                for (uint32_t i = 0; i < count; i++)
+                    expected[i] = reference.test(objects[i], is_hiz_enabled);
+                double cpu_ms = stopwatch.milliseconds();
+
+                // 输出顺序由原子操作决定，按firstInstance比较集合
+                uint32_t draw_count = validator.get_draw_count();
+                const VkDrawIndexedIndirectCommand *draws = validator.get_draws();
+                std::vector<bool> is_drawn(count, false);
+                uint32_t mismatches = 0, borderline = 0;
+                for (uint32_t i = 0; i < std::min(draw_count, count); i++)
+                {
+                    const VkDrawIndexedIndirectCommand &draw = draws[i];
+                    if (draw.firstInstance >= count || is_drawn[draw.firstInstance])
+                    {
+                        mismatches++;
+                        continue;
+                    }
+                    const vl::GpuCuller::Object &object = objects[draw.firstInstance];
+                    if (draw.indexCount != object.m_index_count || draw.instanceCount != 1 ||
+                        draw.firstIndex != object.m_first_index || draw.vertexOffset != object.m_vertex_offset)
+                        mismatches++;
+                    is_drawn[draw.firstInstance] = true;
+                }
+                if (draw_count > count)
+                    mismatches += draw_count - count;
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    if (expected[i] == ReferenceCuller::Visibility::eBorderline)
+                        borderline++;
+                    else if (is_drawn[i] != (expected[i] == ReferenceCuller::Visibility::eVisible))
+                        mismatches++;
+                }
+                if (mismatches > 0)
+                    exit_code = EXIT_FAILURE;
+
+                std::cout << std::fixed << std::setprecision(3)
+                          << std::setw(11) << count
+                          << std::setw(6) << (is_hiz_enabled ? "on" : "off")
+                          << std::setw(10) << draw_count
+                          << std::setw(12) << borderline
+                          << std::setw(12) << mismatches
+                          << std::setw(8) << gpu_ms
+                          << std::setw(8) << cpu_ms
+                          << std::defaultfloat << std::endl;
+            }
+        }
+
+        std::cout << (exit_code == EXIT_SUCCESS ? "  gpu results match the cpu reference" : "  MISMATCH") << std::endl;
+    }
+
+    context.destroy();
+    return exit_code;
+}
+
+#endif
\ No newline at end of file
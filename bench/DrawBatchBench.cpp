@@ -0,0 +1,219 @@
+#ifndef DRAWBATCHBENCH_CPP
+#define DRAWBATCHBENCH_CPP
+
+#include <set>
+#include <tuple>
+#include "Bench.hpp"
+#include "CommandListBench.cpp"
+#include "../src/ThreadPool.hpp"
+#include "../src/ThreadPool.cpp"
+#include "../src/RenderQueue.hpp"
+#include "../src/RenderQueue.cpp"
+#include "../src/DrawBatcher.hpp"
+#include "../src/DrawBatcher.cpp"
+
+/// @brief 检查间接命令与批：每个命令对应队列中的一次绘制，每批的状态相同且批连续
+bool check_batches(const vl::RenderQueue &queue, const std::vector<vl::DrawBatcher::Draw> &draws,
+                   const std::vector<VkDrawIndexedIndirectCommand> &commands, const vl::DrawBatcher &batcher)
+{
+    if (batcher.get_command_count() != queue.size())
+        return false;
+
+    std::set<std::tuple<uint32_t, uint32_t, uint32_t>> states;
+    uint32_t next_command = 0;
+    for (const vl::DrawBatcher::Batch &batch : batcher.get_batches())
+    {
+        if (batch.m_first_command != next_command || batch.m_command_count == 0)
+            return false;
+        next_command += batch.m_command_count;
+        states.insert({batch.m_pass, batch.m_pipeline, batch.m_descriptor_set});
+
+        for (uint32_t i = batch.m_first_command; i < next_command; i++)
+        {
+            uint64_t key = queue.get_keys()[i];
+            const vl::DrawBatcher::Draw &draw = draws[queue.get_indices()[i]];
+            const VkDrawIndexedIndirectCommand &command = commands[i];
+            if (vl::RenderQueue::get_pass(key) != batch.m_pass ||
+                vl::RenderQueue::get_pipeline(key) != batch.m_pipeline ||
+                vl::RenderQueue::get_descriptor_set(key) != batch.m_descriptor_set ||
+                command.indexCount != draw.m_index_count ||
+                command.instanceCount != draw.m_instance_count ||
+                command.firstIndex != draw.m_first_index ||
+                command.vertexOffset != draw.m_vertex_offset ||
+                command.firstInstance != draw.m_first_instance)
+                return false;
+        }
+    }
+
+    // 排序后每种状态只有一批
+    return next_command == batcher.get_command_count() && states.size() == batcher.get_batches().size();
+}
+
+/// @brief 间接绘制合并基准：检查生成的间接命令和录制的调用，比较逐个绘制与合并后的调用数和录制时间
+int run_draw_batch_bench(int argc, char **argv)
+{
+    std::vector<uint64_t> counts = bench::get_list_option(argc, argv, "--counts", "1000,10000,100000,1000000");
+    uint32_t pipeline_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--pipelines", 8LL));
+    uint32_t set_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--sets", 64LL));
+    uint32_t max_draw_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--max-draw-count", 0LL));
+    int repeat = static_cast<int>(bench::get_option(argc, argv, "--repeat", 5LL));
+    if (max_draw_count == 0)
+        max_draw_count = UINT32_MAX;
+
+    const vk::PipelineBindPoint graphics = vk::PipelineBindPoint::eGraphics;
+    vk::PipelineLayout layout = make_fake_handle<vk::PipelineLayout>(10);
+    vk::Buffer indirect_buffer = make_fake_handle<vk::Buffer>(40);
+    auto bind_batch = [&](auto &list, const vl::DrawBatcher::Batch &batch)
+    {
+        list.bind_pipeline(graphics, make_fake_handle<vk::Pipeline>(100 + batch.m_pipeline));
+        list.bind_descriptor_set(graphics, layout, 0, make_fake_handle<vk::DescriptorSet>(1000 + batch.m_descriptor_set));
+    };
+
+    // 小例子：两种状态交错的四次绘制合并为两批
+    bool is_passed = true;
+    {
+        vl::RenderQueue queue;
+        std::vector<vl::DrawBatcher::Draw> draws(4);
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            draws[i].m_index_count = 36;
+            draws[i].m_first_index = i * 36;
+            draws[i].m_first_instance = i;
+            queue.push(vl::RenderQueue::make_key(0, i % 2, 0, 0.5f), i);
+        }
+        queue.sort();
+
+        std::vector<VkDrawIndexedIndirectCommand> commands(4);
+        vl::DrawBatcher batcher;
+        batcher.build(queue, draws.data(), commands.data(), 4);
+
+        RecordingDispatch recorder;
+        vl::CommandList<RecordingDispatch> list(vk::CommandBuffer(), recorder);
+        batcher.record(list, indirect_buffer, 256, UINT32_MAX, [&](const vl::DrawBatcher::Batch &batch)
+                       { bind_batch(list, batch); });
+        batcher.record(list, indirect_buffer, 256, 1, [&](const vl::DrawBatcher::Batch &batch)
+                       { bind_batch(list, batch); });
+
+        std::cout << "draw batching: emitted call streams" << std::endl;
+        is_passed &= check_batches(queue, draws, commands, batcher);
+        is_passed &= check_calls("batches", recorder,
+                                 {"bindPipeline 0 100", "bindDescriptorSets 0 10 0 [1000] []", "drawIndexedIndirect 40+256 2 20",
+                                  "bindPipeline 0 101", "drawIndexedIndirect 40+296 2 20",
+                                  "bindPipeline 0 100", "drawIndexedIndirect 40+256 1 20", "drawIndexedIndirect 40+276 1 20",
+                                  "bindPipeline 0 101", "drawIndexedIndirect 40+296 1 20", "drawIndexedIndirect 40+316 1 20"});
+    }
+
+    // 两个通道使用相同的管线和描述符集，批不能跨越通道
+    {
+        vl::RenderQueue queue;
+        std::vector<vl::DrawBatcher::Draw> draws(4);
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            draws[i].m_index_count = 36;
+            draws[i].m_first_instance = i;
+            queue.push(vl::RenderQueue::make_key(i / 2, 0, 0, 0.5f), i);
+        }
+        queue.sort();
+
+        std::vector<VkDrawIndexedIndirectCommand> commands(4);
+        vl::DrawBatcher batcher;
+        batcher.build(queue, draws.data(), commands.data(), 4);
+        bool is_split = batcher.get_batches().size() == 2 &&
+                        batcher.get_batches()[0].m_pass == 0 && batcher.get_batches()[1].m_pass == 1;
+        std::cout << "draw batching: pass boundary " << (is_split ? "split" : "MERGED") << std::endl;
+        is_passed &= is_split && check_batches(queue, draws, commands, batcher);
+    }
+
+    std::cout << "draw batching: " << pipeline_count << " pipelines, " << set_count << " descriptor sets" << std::endl
+              << "      draws  batches  direct calls  direct ms  batched calls  sort ms  build ms  batched ms  valid" << std::endl;
+
+    for (uint64_t value : counts)
+    {
+        uint32_t count = static_cast<uint32_t>(value);
+        uint32_t state = count;
+        auto next = [&state]()
+        {
+            state = state * 1664525u + 1013904223u;
+            return state >> 8;
+        };
+
+        // 每个物体使用若干网格之一和打乱的材质
+        std::vector<vl::DrawBatcher::Draw> draws(count);
+        std::vector<uint32_t> pipeline_ids(count), set_ids(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t mesh = next() % 16;
+            draws[i].m_index_count = 36 + mesh * 12;
+            draws[i].m_first_index = mesh * 4096;
+            draws[i].m_vertex_offset = static_cast<int32_t>(mesh * 1024);
+            draws[i].m_first_instance = i;
+            pipeline_ids[i] = next() % pipeline_count;
+            set_ids[i] = next() % set_count;
+        }
+
+        vl::RenderQueue queue;
+        vl::DrawBatcher batcher;
+        std::vector<VkDrawIndexedIndirectCommand> commands(count);
+        std::vector<double> direct_ms, sort_ms, build_ms, batched_ms;
+        size_t direct_calls = 0, batched_calls = 0;
+        CountingDispatch counter;
+        for (int r = 0; r < repeat; r++)
+        {
+            // 逐个绘制：每个物体绑定自己的状态，CommandList去掉重复的绑定
+            bench::Stopwatch stopwatch;
+            {
+                vl::CommandList<CountingDispatch> list(vk::CommandBuffer(), counter);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    list.bind_pipeline(graphics, make_fake_handle<vk::Pipeline>(100 + pipeline_ids[i]));
+                    list.bind_descriptor_set(graphics, layout, 0, make_fake_handle<vk::DescriptorSet>(1000 + set_ids[i]));
+                    const vl::DrawBatcher::Draw &draw = draws[i];
+                    list.draw_indexed(draw.m_index_count, draw.m_instance_count, draw.m_first_index, draw.m_vertex_offset, draw.m_first_instance);
+                }
+                direct_calls = list.get_statistics().get_emitted();
+            }
+            direct_ms.push_back(stopwatch.milliseconds());
+
+            stopwatch.reset();
+            queue.clear();
+            for (uint32_t i = 0; i < count; i++)
+                queue.push(vl::RenderQueue::make_key(0, pipeline_ids[i], set_ids[i], 0.0f), i);
+            queue.sort();
+            sort_ms.push_back(stopwatch.milliseconds());
+
+            stopwatch.reset();
+            batcher.build(queue, draws.data(), commands.data(), count);
+            build_ms.push_back(stopwatch.milliseconds());
+
+            stopwatch.reset();
+            {
+                vl::CommandList<CountingDispatch> list(vk::CommandBuffer(), counter);
+                batcher.record(list, indirect_buffer, 0, max_draw_count, [&](const vl::DrawBatcher::Batch &batch)
+                               { bind_batch(list, batch); });
+                batched_calls = list.get_statistics().get_emitted();
+            }
+            batched_ms.push_back(stopwatch.milliseconds());
+        }
+        bench::do_not_optimize(counter.m_count);
+
+        bool is_valid = check_batches(queue, draws, commands, batcher);
+        is_passed &= is_valid;
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(11) << count
+                  << std::setw(9) << batcher.get_batches().size()
+                  << std::setw(14) << direct_calls
+                  << std::setw(11) << bench::percentile(direct_ms, 50)
+                  << std::setw(15) << batched_calls
+                  << std::setw(9) << bench::percentile(sort_ms, 50)
+                  << std::setw(10) << bench::percentile(build_ms, 50)
+                  << std::setw(12) << bench::percentile(batched_ms, 50)
+                  << std::setw(7) << (is_valid ? "yes" : "NO")
+                  << std::defaultfloat << std::endl;
+    }
+
+    std::cout << (is_passed ? "  all batches are valid" : "  MISMATCH") << std::endl;
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#ifndef ENCODERBENCH_CPP
+#define ENCODERBENCH_CPP
+
+#include "Bench.hpp"
+#include "../src/ImageEncoder.hpp"
+#include "../src/ImageEncoder.cpp"
+#include "../src/Deflate.cpp"
+#include "../src/ThreadPool.cpp"
+#include "../src/EncodeQueue.hpp"
+#include "../src/EncodeQueue.cpp"
+
+/// @brief 生成类似渲染结果的测试帧：平滑渐变加少量噪声
+std::vector<uint8_t> make_encoder_frame(uint32_t width, uint32_t height, uint32_t seed)
+{
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    uint32_t state = seed * 2654435761u + 1;
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            state = state * 1664525u + 1013904223u;
+            uint8_t noise = static_cast<uint8_t>((state >> 24) & 3);
+            uint8_t *p = pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+            p[0] = static_cast<uint8_t>((x + seed) * 255 / width + noise);
+            p[1] = static_cast<uint8_t>(y * 255 / height);
+            p[2] = static_cast<uint8_t>(((x / 32 + y / 32) & 1) ? 200 : 60);
+            p[3] = 255;
+        }
+    }
+    return pixels;
+}
+
+/// @brief 编码器基准：单核吞吐量和编码队列的并行吞吐量
+int run_encoder_bench(int argc, char **argv)
+{
+    uint32_t width = static_cast<uint32_t>(bench::get_option(argc, argv, "--width", 1280LL));
+    uint32_t height = static_cast<uint32_t>(bench::get_option(argc, argv, "--height", 720LL));
+    uint32_t frames = static_cast<uint32_t>(bench::get_option(argc, argv, "--frames", 16LL));
+    size_t threads = static_cast<size_t>(bench::get_option(argc, argv, "--threads", 0LL));
+
+    std::vector<std::vector<uint8_t>> inputs;
+    for (uint32_t i = 0; i < 4; i++)
+        inputs.push_back(make_encoder_frame(width, height, i));
+    double frame_megabytes = static_cast<double>(inputs[0].size()) / (1024.0 * 1024.0);
+
+    std::cout << "encoder: " << width << "x" << height << ", " << frames << " frames" << std::endl;
+
+    const vl::ImageEncoder::Format formats[] = {
+        vl::ImageEncoder::Format::ePpm,
+        vl::ImageEncoder::Format::eQoi,
+        vl::ImageEncoder::Format::ePng,
+    };
+
+    for (auto format : formats)
+    {
+        // 单线程
+        std::vector<uint8_t> output;
+        size_t output_bytes = 0;
+        bench::Stopwatch stopwatch;
+        for (uint32_t i = 0; i < frames; i++)
+        {
+            vl::ImageEncoder::Image image;
+            image.m_pixels = inputs[i % inputs.size()].data();
+            image.m_width = width;
+            image.m_height = height;
+            image.m_row_pitch = width * 4;
+            image.m_layout = vl::ImageEncoder::PixelLayout::eBgra;
+
+            output.clear();
+            vl::ImageEncoder::encode(format, image, output);
+            output_bytes += output.size();
+        }
+        double single_seconds = stopwatch.seconds();
+
+        // 编码队列，输出直接丢弃
+        vl::EncodeQueue queue;
+        vl::EncodeQueue::Config config;
+        config.m_format = format;
+        config.m_thread_count = threads;
+        config.m_capacity = 8;
+        std::vector<uint64_t> order;
+        queue.create(config, [&order](uint64_t index, const std::vector<uint8_t> &)
+                     {
+                         order.push_back(index);
+                         return true; });
+
+        stopwatch.reset();
+        for (uint32_t i = 0; i < frames; i++)
+        {
+            vl::EncodeQueue::Input input;
+            input.m_pixels = inputs[i % inputs.size()];
+            input.m_width = width;
+            input.m_height = height;
+            input.m_row_pitch = width * 4;
+            input.m_layout = vl::ImageEncoder::PixelLayout::eBgra;
+            queue.push(std::move(input));
+        }
+        queue.flush();
+        double queue_seconds = stopwatch.seconds();
+        vl::EncodeQueue::Statistics statistics = queue.get_statistics();
+        queue.destroy();
+
+        bool is_ordered = std::is_sorted(order.begin(), order.end()) && order.size() == frames;
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "  " << vl::ImageEncoder::get_extension(format)
+                  << ": ratio " << static_cast<double>(output_bytes) / (frame_megabytes * 1024.0 * 1024.0 * frames) * 100.0 << "%"
+                  << ", 1 core " << frame_megabytes * frames / single_seconds << " MB/s"
+                  << ", queue(" << statistics.m_thread_count << " threads) "
+                  << frame_megabytes * frames / queue_seconds << " MB/s"
+                  << ", per core " << statistics.megabytes_per_second_per_core() << " MB/s"
+                  << (is_ordered ? "" : ", OUT OF ORDER") << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+#endif
\ No newline at end of file
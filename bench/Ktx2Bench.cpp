@@ -0,0 +1,353 @@
+#ifndef KTX2BENCH_CPP
+#define KTX2BENCH_CPP
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include "Bench.hpp"
+#include "EncoderBench.cpp"
+#include "../tools/TextureConverter.cpp"
+
+/// @brief 读取整个文件
+std::vector<uint8_t> read_ktx2_bench_file(const std::string &path)
+{
+    std::ifstream fin(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+}
+
+/// @brief KTX2基准：与PPM比较开始渲染前需要上传的时间，检查两种打开方式的内容，拒绝损坏的文件，并对读取器做变异测试
+int run_ktx2_bench(int argc, char **argv)
+{
+    uint32_t size = static_cast<uint32_t>(bench::get_option(argc, argv, "--size", 2048LL));
+    int repeat = static_cast<int>(bench::get_option(argc, argv, "--repeat", 5LL));
+    vk::DeviceSize budget = static_cast<vk::DeviceSize>(bench::get_option(argc, argv, "--budget", 256LL)) * 1024;
+    int fuzz_count = static_cast<int>(bench::get_option(argc, argv, "--fuzz", 2000LL));
+    uint32_t seed = static_cast<uint32_t>(bench::get_option(argc, argv, "--seed", 1LL));
+    std::string directory = bench::get_option(argc, argv, "--dir", std::string("."));
+    const std::string ppm_path = directory + "/ktx2_bench.ppm";
+
+    std::vector<uint8_t> pixels = make_encoder_frame(size, size, 1);
+    {
+        vl::ImageEncoder::Image image;
+        image.m_pixels = pixels.data();
+        image.m_width = size;
+        image.m_height = size;
+        image.m_row_pitch = size * 4;
+        std::vector<uint8_t> encoded;
+        std::ofstream fout(ppm_path, std::ios::binary);
+        if (!vl::ImageEncoder::encode_ppm(image, encoded) ||
+            !fout.write(reinterpret_cast<const char *>(encoded.data()), static_cast<std::streamsize>(encoded.size())))
+        {
+            std::cout << "failed to write " << ppm_path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    struct Case
+    {
+        const char *m_name;
+        std::string m_path;
+        bool m_is_uncompressed;
+        bool m_is_supercompressed;
+    };
+    std::vector<Case> cases = {
+        {"rgba8", directory + "/ktx2_bench_rgba8.ktx2", true, false},
+        {"rgba8 zlib", directory + "/ktx2_bench_rgba8_zlib.ktx2", true, true},
+        {"bc1", directory + "/ktx2_bench_bc1.ktx2", false, false},
+        {"bc1 zlib", directory + "/ktx2_bench_bc1_zlib.ktx2", false, true},
+    };
+
+    bool is_passed = true;
+    bench::Stopwatch stopwatch;
+    for (const Case &test : cases)
+    {
+        TextureConvertOptions options;
+        options.m_format = vl::TextureCompressor::Format::eBC1;
+        options.m_is_uncompressed = test.m_is_uncompressed;
+        options.m_is_supercompressed = test.m_is_supercompressed;
+        options.m_has_mips = true;
+        stopwatch.reset();
+        is_passed &= convert_texture(ppm_path, test.m_path, options);
+        std::cout << "  converted in " << stopwatch.milliseconds() << " ms" << std::endl;
+    }
+    if (!is_passed)
+        return EXIT_FAILURE;
+
+    // 两种打开方式读到相同的内容：RGBA8与CPU生成的mip链一致，超压缩后与未超压缩的相同，未超压缩的级别在映射中按块对齐
+    {
+        std::vector<std::vector<uint8_t>> expected;
+        uint32_t level_count = vl::MipGenerator::get_level_count(size, size);
+        vl::MipGenerator::generate(pixels.data(), size, size, level_count, expected);
+        expected.insert(expected.begin(), pixels);
+
+        std::vector<std::vector<uint8_t>> bc1;
+        for (const Case &test : cases)
+            for (vl::Ktx2File::Mode mode : {vl::Ktx2File::Mode::eMap, vl::Ktx2File::Mode::eRead})
+            {
+                vl::Ktx2File file;
+                bool is_valid = file.open(test.m_path, mode) && file.get_level_count() == level_count &&
+                                file.get_width() == size && file.get_height() == size;
+                for (uint32_t level = 0; is_valid && level < level_count; level++)
+                {
+                    std::vector<uint8_t> data(static_cast<size_t>(file.get_level(level).m_uncompressed_size));
+                    is_valid &= file.read_level(level, data.data());
+                    if (test.m_is_uncompressed)
+                        is_valid &= data == expected[level];
+                    else if (bc1.size() < level_count)
+                        bc1.push_back(std::move(data));
+                    else
+                        is_valid &= data == bc1[level];
+                    if (!test.m_is_supercompressed)
+                        is_valid &= reinterpret_cast<uintptr_t>(file.get_level_data(level)) % (test.m_is_uncompressed ? 4 : 8) == 0;
+                }
+                if (!is_valid)
+                    std::cout << "  " << test.m_path << " reads incorrectly" << std::endl;
+                is_passed &= is_valid;
+            }
+        std::cout << "ktx2: mmap and read() contents " << (is_passed ? "match" : "MISMATCH") << std::endl;
+    }
+
+    // 损坏的文件必须被拒绝
+    {
+        std::cout << "ktx2: corrupted inputs" << std::endl;
+        for (size_t index : {size_t(2), size_t(3)})
+        {
+            std::vector<uint8_t> original = read_ktx2_bench_file(cases[index].m_path);
+            std::vector<uint64_t> storage((original.size() + 7) / 8);
+            auto check = [&](const char *name, size_t length, auto corrupt)
+            {
+                std::memcpy(storage.data(), original.data(), original.size());
+                uint8_t *bytes = reinterpret_cast<uint8_t *>(storage.data());
+                corrupt(reinterpret_cast<vl::Ktx2File::Header *>(bytes), reinterpret_cast<vl::Ktx2File::Level *>(bytes + sizeof(vl::Ktx2File::Header)));
+                vl::Ktx2File file;
+                bool is_rejected = !file.open_memory(bytes, length);
+                std::cout << "  " << std::setw(10) << cases[index].m_name << std::setw(24) << name << (is_rejected ? "  rejected" : "  ACCEPTED") << std::endl;
+                is_passed &= is_rejected;
+            };
+            check("truncated header", 40, [](auto *, auto *) {});
+            check("truncated level 0", original.size() - 1, [](auto *, auto *) {});
+            check("bad identifier", original.size(), [](auto *header, auto *)
+                  { header->m_identifier[5] = '1'; });
+            check("unsupported format", original.size(), [](auto *header, auto *)
+                  { header->m_vk_format = 1000; });
+            check("zero width", original.size(), [](auto *header, auto *)
+                  { header->m_pixel_width = 0; });
+            check("array texture", original.size(), [](auto *header, auto *)
+                  { header->m_layer_count = 6; });
+            check("too many levels", original.size(), [](auto *header, auto *)
+                  { header->m_level_count = 40; });
+            check("unknown scheme", original.size(), [](auto *header, auto *)
+                  { header->m_supercompression = 2; });
+            check("dfd out of range", original.size(), [](auto *header, auto *)
+                  { header->m_dfd_size = UINT32_MAX; });
+            check("dfd size mismatch", original.size(), [](auto *header, auto *)
+                  { header->m_dfd_size += 4; });
+            check("global data", original.size(), [](auto *header, auto *)
+                  { header->m_sgd_size = 16; });
+            check("overflowing level", original.size(), [](auto *, auto *levels)
+                  { levels[0].m_size = UINT64_MAX - 16; });
+            check("level in header", original.size(), [](auto *, auto *levels)
+                  { levels[1].m_offset = 0; });
+            check("wrong level size", original.size(), [](auto *, auto *levels)
+                  { levels[1].m_uncompressed_size += 8; });
+            check("swapped levels", original.size(), [](auto *, auto *levels)
+                  { std::swap(levels[0], levels[1]); });
+            if (!cases[index].m_is_supercompressed)
+                check("misaligned level", original.size(), [](auto *, auto *levels)
+                      { levels[0].m_offset += 4; });
+        }
+
+        // 超压缩的数据在读取时才检查
+        std::vector<uint8_t> original = read_ktx2_bench_file(cases[3].m_path);
+        std::vector<uint64_t> storage((original.size() + 7) / 8);
+        std::memcpy(storage.data(), original.data(), original.size());
+        uint8_t *bytes = reinterpret_cast<uint8_t *>(storage.data());
+        vl::Ktx2File file;
+        bool is_opened = file.open_memory(bytes, original.size());
+        if (is_opened)
+            bytes[file.get_level(0).m_offset + file.get_level(0).m_size / 2] ^= 0x10;
+        std::vector<uint8_t> data(is_opened ? static_cast<size_t>(file.get_level(0).m_uncompressed_size) : 0);
+        bool is_rejected = is_opened && !file.read_level(0, data.data());
+        std::cout << "  " << std::setw(10) << cases[3].m_name << std::setw(24) << "corrupted stream" << (is_rejected ? "  rejected" : "  ACCEPTED") << std::endl;
+        is_passed &= is_rejected;
+    }
+
+    // 变异测试：随机改写小文件的字节，偏向文件头和索引，通过检查的文件必须能安全地读取每一级
+    if (fuzz_count > 0)
+    {
+        std::vector<std::vector<uint8_t>> sources;
+        for (const Case &test : {Case{"rgba8 zlib", directory + "/ktx2_bench_fuzz_a.ktx2", true, true},
+                                 Case{"bc1", directory + "/ktx2_bench_fuzz_b.ktx2", false, false}})
+        {
+            const uint32_t width = 100, height = 60;
+            std::vector<uint8_t> small = make_encoder_frame(width, height, 2);
+            std::vector<std::vector<uint8_t>> levels;
+            uint32_t level_count = vl::MipGenerator::get_level_count(width, height);
+            vl::MipGenerator::generate(small.data(), width, height, level_count, levels);
+            levels.insert(levels.begin(), std::move(small));
+            vk::Format format = vk::Format::eR8G8B8A8Unorm;
+            if (!test.m_is_uncompressed)
+            {
+                format = vl::TextureCompressor::get_vk_format(vl::TextureCompressor::Format::eBC1);
+                for (uint32_t level = 0; level < level_count; level++)
+                {
+                    uint32_t level_width = std::max(width >> level, 1u), level_height = std::max(height >> level, 1u);
+                    std::vector<uint8_t> blocks(vl::TextureCompressor::get_compressed_size(vl::TextureCompressor::Format::eBC1, level_width, level_height));
+                    vl::TextureCompressor::compress(vl::TextureCompressor::Format::eBC1, levels[level].data(), level_width, level_height, blocks.data());
+                    levels[level] = std::move(blocks);
+                }
+            }
+            is_passed &= vl::Ktx2File::write(
+                test.m_path,
+                format,
+                width,
+                height,
+                levels,
+                test.m_is_supercompressed ? vl::Ktx2File::SUPERCOMPRESSION_ZLIB : vl::Ktx2File::SUPERCOMPRESSION_NONE);
+            sources.push_back(read_ktx2_bench_file(test.m_path));
+            std::remove(test.m_path.c_str());
+        }
+
+        std::mt19937 random(seed);
+        int accepted = 0, failed_reads = 0;
+        std::vector<uint64_t> storage;
+        std::vector<uint8_t> data;
+        for (int i = 0; i < fuzz_count; i++)
+        {
+            const std::vector<uint8_t> &source = sources[random() % sources.size()];
+            storage.assign((source.size() + 7) / 8, 0);
+            uint8_t *bytes = reinterpret_cast<uint8_t *>(storage.data());
+            std::memcpy(bytes, source.data(), source.size());
+
+            size_t length = source.size();
+            uint32_t mutation_count = 1 + random() % 4;
+            for (uint32_t m = 0; m < mutation_count; m++)
+            {
+                size_t position = random() % 2 ? random() % std::min<size_t>(length, 256) : random() % length;
+                switch (random() % 3)
+                {
+                case 0:
+                    bytes[position] ^= static_cast<uint8_t>(1u << random() % 8);
+                    break;
+                case 1:
+                    bytes[position] = static_cast<uint8_t>(random());
+                    break;
+                default:
+                {
+                    // 写入一个对齐的32位数，容易命中大小和偏移
+                    uint32_t value = random() % 2 ? static_cast<uint32_t>(random()) : static_cast<uint32_t>(random() % 256);
+                    std::memcpy(bytes + position / 4 * 4, &value, std::min<size_t>(4, length - position / 4 * 4));
+                    break;
+                }
+                }
+            }
+            if (random() % 8 == 0)
+                length = random() % length;
+
+            vl::Ktx2File file;
+            if (!file.open_memory(bytes, length))
+                continue;
+            accepted++;
+            for (uint32_t level = 0; level < file.get_level_count(); level++)
+            {
+                data.resize(static_cast<size_t>(file.get_level(level).m_uncompressed_size));
+                failed_reads += file.read_level(level, data.data()) ? 0 : 1;
+            }
+        }
+        std::cout << "ktx2: fuzzed " << fuzz_count << " inputs with seed " << seed << ", " << accepted
+                  << " accepted, " << failed_reads << " corrupted levels rejected on read" << std::endl;
+    }
+
+    // 暂存环使用主机内存；开始渲染只需上传预算内的尾部级别，PPM必须完整解码第0级
+    std::cout << "ktx2: time to first frame, page cache warm, tail budget " << budget / 1024 << " KB" << std::endl
+              << "          file       MB  levels  first MB  first ms  all ms" << std::endl;
+    {
+        vl::Ktx2File probe;
+        if (!probe.open(cases[0].m_path))
+            return EXIT_FAILURE;
+        vk::DeviceSize bytes = 0;
+        for (uint32_t level = 0; level < probe.get_level_count(); level++)
+            bytes += probe.get_level(level).m_uncompressed_size + 16;
+        probe.close();
+
+        // 留出一倍的空间，暂存环绕回开头时第0级仍能连续分配
+        std::vector<uint8_t> memory(static_cast<size_t>(bytes) * 2);
+        vl::MappedBuffer host;
+        host.m_mapped = memory.data();
+        host.m_size = memory.size();
+        host.m_is_coherent = true;
+        vl::StagingRing ring;
+        ring.attach(host);
+
+        auto measure = [&](auto load)
+        {
+            std::vector<double> times;
+            for (int r = 0; r < repeat; r++)
+            {
+                stopwatch.reset();
+                is_passed &= load();
+                times.push_back(stopwatch.milliseconds());
+                ring.release(ring.submit());
+            }
+            return bench::percentile(times, 50);
+        };
+        auto print = [](const char *name, double megabytes, const std::string &levels, double first_megabytes, double first_ms, double all_ms)
+        {
+            std::cout << std::fixed << std::setprecision(2)
+                      << std::setw(14) << name
+                      << std::setw(9) << megabytes
+                      << std::setw(8) << levels
+                      << std::setw(10) << first_megabytes
+                      << std::setw(10) << first_ms
+                      << std::setw(8) << all_ms
+                      << std::defaultfloat << std::endl;
+        };
+
+        double ppm_ms = measure([&]()
+                                {
+                                    vl::TextureFile file;
+                                    return file.open(ppm_path) && file.stage(ring).has_value(); });
+        print("ppm", read_ktx2_bench_file(ppm_path).size() / 1048576.0, "1", pixels.size() / 1048576.0, ppm_ms, ppm_ms);
+
+        for (const Case &test : cases)
+        {
+            uint32_t tail = 0, level_count = 0;
+            vk::DeviceSize tail_bytes = 0;
+            auto load = [&](bool is_tail_only)
+            {
+                vl::Ktx2File file;
+                if (!file.open(test.m_path))
+                    return false;
+                level_count = file.get_level_count();
+                tail = file.get_tail_level(budget);
+                tail_bytes = 0;
+                // 从最小的一级开始，与文件中的顺序相同
+                for (uint32_t level = level_count; level-- > (is_tail_only ? tail : 0);)
+                {
+                    std::optional<vl::StagingRing::Allocation> allocation = file.stage_level(ring, level);
+                    if (!allocation.has_value())
+                        return false;
+                    tail_bytes += level >= tail ? file.get_level(level).m_uncompressed_size : 0;
+                }
+                return true;
+            };
+            double first_ms = measure([&]()
+                                      { return load(true); });
+            double all_ms = measure([&]()
+                                    { return load(false); });
+            print(test.m_name, read_ktx2_bench_file(test.m_path).size() / 1048576.0,
+                  std::to_string(level_count - tail) + "/" + std::to_string(level_count),
+                  tail_bytes / 1048576.0, first_ms, all_ms);
+        }
+    }
+
+    std::remove(ppm_path.c_str());
+    for (const Case &test : cases)
+        std::remove(test.m_path.c_str());
+
+    std::cout << (is_passed ? "  all ktx2 checks passed" : "  MISMATCH") << std::endl;
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
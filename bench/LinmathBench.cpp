@@ -0,0 +1,187 @@
+#ifndef LINMATHBENCH_CPP
+#define LINMATHBENCH_CPP
+
+#include <cmath>
+#include <functional>
+#include "Bench.hpp"
+#include "../examples/demo/linmath.h"
+
+/// @brief linmath的测试数据，每个实例一组输入和输出
+struct LinmathData
+{
+    std::vector<float> m_a;
+    std::vector<float> m_b;
+    std::vector<float> m_out;
+    std::vector<float> m_scalars;
+    size_t m_count = 0;
+
+    explicit LinmathData(size_t count) : m_a(count * 16), m_b(count * 16), m_out(count * 16), m_scalars(count * 4), m_count(count)
+    {
+        uint32_t state = 12345;
+        auto next = [&state]()
+        {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>(state >> 8) / 16777216.0f * 2.0f - 1.0f;
+        };
+        // 对角占优，保证矩阵可逆
+        for (size_t i = 0; i < count * 16; i++)
+        {
+            m_a[i] = next() + (i % 16 % 5 == 0 ? 4.0f : 0.0f);
+            m_b[i] = next() + (i % 16 % 5 == 0 ? 4.0f : 0.0f);
+        }
+        for (float &s : m_scalars)
+            s = next();
+    }
+
+    vec4 *a(size_t i) { return reinterpret_cast<vec4 *>(&m_a[i * 16]); }
+    vec4 *b(size_t i) { return reinterpret_cast<vec4 *>(&m_b[i * 16]); }
+    vec4 *out(size_t i) { return reinterpret_cast<vec4 *>(&m_out[i * 16]); }
+    float scalar(size_t i, size_t k) const { return m_scalars[i * 4 + k]; }
+};
+
+/// @brief 一个被测函数，对第i个实例执行一次
+using LinmathKernel = std::function<void(LinmathData &, size_t)>;
+
+double time_linmath_kernel(LinmathData &data, const LinmathKernel &kernel, int repeat)
+{
+    double best = 1e30;
+    for (int r = 0; r < repeat; r++)
+    {
+        bench::Stopwatch stopwatch;
+        for (size_t i = 0; i < data.m_count; i++)
+            kernel(data, i);
+        best = std::min(best, stopwatch.seconds());
+    }
+    bench::do_not_optimize(data.m_out[0]);
+    return best * 1e9 / static_cast<double>(data.m_count);
+}
+
+/// @brief linmath基准：逐个函数比较标量版本和SIMD版本
+int run_linmath_bench(int argc, char **argv)
+{
+    size_t count = static_cast<size_t>(bench::get_option(argc, argv, "--count", 10000LL));
+    int repeat = static_cast<int>(bench::get_option(argc, argv, "--repeat", 20LL));
+
+    struct Case
+    {
+        const char *m_name;
+        LinmathKernel m_scalar;
+        LinmathKernel m_simd;
+    };
+
+    const Case cases[] = {
+        {"vec4_add",
+         [](LinmathData &d, size_t i)
+         { vec4_add_scalar(d.out(i)[0], d.a(i)[0], d.b(i)[0]); },
+         [](LinmathData &d, size_t i)
+         { vec4_add(d.out(i)[0], d.a(i)[0], d.b(i)[0]); }},
+        {"vec4_sub",
+         [](LinmathData &d, size_t i)
+         { vec4_sub_scalar(d.out(i)[0], d.a(i)[0], d.b(i)[0]); },
+         [](LinmathData &d, size_t i)
+         { vec4_sub(d.out(i)[0], d.a(i)[0], d.b(i)[0]); }},
+        {"vec4_scale",
+         [](LinmathData &d, size_t i)
+         { vec4_scale_scalar(d.out(i)[0], d.a(i)[0], d.scalar(i, 0)); },
+         [](LinmathData &d, size_t i)
+         { vec4_scale(d.out(i)[0], d.a(i)[0], d.scalar(i, 0)); }},
+        {"vec4_mul_inner",
+         [](LinmathData &d, size_t i)
+         { d.out(i)[0][0] = vec4_mul_inner_scalar(d.a(i)[0], d.b(i)[0]); },
+         [](LinmathData &d, size_t i)
+         { d.out(i)[0][0] = vec4_mul_inner(d.a(i)[0], d.b(i)[0]); }},
+        {"mat4x4_transpose",
+         [](LinmathData &d, size_t i)
+         { mat4x4_transpose_scalar(d.out(i), d.a(i)); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_transpose(d.out(i), d.a(i)); }},
+        {"mat4x4_add",
+         [](LinmathData &d, size_t i)
+         { mat4x4_add_scalar(d.out(i), d.a(i), d.b(i)); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_add(d.out(i), d.a(i), d.b(i)); }},
+        {"mat4x4_sub",
+         [](LinmathData &d, size_t i)
+         { mat4x4_sub_scalar(d.out(i), d.a(i), d.b(i)); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_sub(d.out(i), d.a(i), d.b(i)); }},
+        {"mat4x4_scale",
+         [](LinmathData &d, size_t i)
+         { mat4x4_scale_scalar(d.out(i), d.a(i), d.scalar(i, 0)); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_scale(d.out(i), d.a(i), d.scalar(i, 0)); }},
+        {"mat4x4_mul",
+         [](LinmathData &d, size_t i)
+         { mat4x4_mul_scalar(d.out(i), d.a(i), d.b(i)); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_mul(d.out(i), d.a(i), d.b(i)); }},
+        {"mat4x4_mul_vec4",
+         [](LinmathData &d, size_t i)
+         { mat4x4_mul_vec4_scalar(d.out(i)[0], d.a(i), d.b(i)[0]); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_mul_vec4(d.out(i)[0], d.a(i), d.b(i)[0]); }},
+        {"mat4x4_translate_in_place",
+         [](LinmathData &d, size_t i)
+         { mat4x4_dup(d.out(i), d.a(i)); mat4x4_translate_in_place_scalar(d.out(i), d.scalar(i, 0), d.scalar(i, 1), d.scalar(i, 2)); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_dup(d.out(i), d.a(i)); mat4x4_translate_in_place(d.out(i), d.scalar(i, 0), d.scalar(i, 1), d.scalar(i, 2)); }},
+        {"mat4x4_rotate",
+         [](LinmathData &d, size_t i)
+         { mat4x4_rotate_scalar(d.out(i), d.a(i), d.scalar(i, 0), d.scalar(i, 1), d.scalar(i, 2), d.scalar(i, 3)); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_rotate(d.out(i), d.a(i), d.scalar(i, 0), d.scalar(i, 1), d.scalar(i, 2), d.scalar(i, 3)); }},
+        {"mat4x4_rotate_X",
+         [](LinmathData &d, size_t i)
+         { mat4x4_rotate_X_scalar(d.out(i), d.a(i), d.scalar(i, 0)); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_rotate_X(d.out(i), d.a(i), d.scalar(i, 0)); }},
+        {"mat4x4_rotate_Y",
+         [](LinmathData &d, size_t i)
+         { mat4x4_rotate_Y_scalar(d.out(i), d.a(i), d.scalar(i, 0)); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_rotate_Y(d.out(i), d.a(i), d.scalar(i, 0)); }},
+        {"mat4x4_rotate_Z",
+         [](LinmathData &d, size_t i)
+         { mat4x4_rotate_Z_scalar(d.out(i), d.a(i), d.scalar(i, 0)); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_rotate_Z(d.out(i), d.a(i), d.scalar(i, 0)); }},
+        {"mat4x4_invert",
+         [](LinmathData &d, size_t i)
+         { mat4x4_invert_scalar(d.out(i), d.a(i)); },
+         [](LinmathData &d, size_t i)
+         { mat4x4_invert(d.out(i), d.a(i)); }},
+    };
+
+    LinmathData data(count);
+    std::vector<float> reference;
+
+    std::cout << "linmath: backend " << LINMATH_SIMD_NAME << ", " << count << " instances" << std::endl
+              << "  function                    scalar ns    simd ns  speedup    max diff" << std::endl;
+
+    bool is_matching = true;
+    for (const Case &c : cases)
+    {
+        double scalar_ns = time_linmath_kernel(data, c.m_scalar, repeat);
+        reference = data.m_out;
+        double simd_ns = time_linmath_kernel(data, c.m_simd, repeat);
+
+        // 相对误差，矩阵元素的量级约为1~5
+        double max_diff = 0.0;
+        for (size_t i = 0; i < reference.size(); i++)
+            max_diff = std::max(max_diff, std::abs(static_cast<double>(data.m_out[i]) - reference[i]) / (1.0 + std::abs(reference[i])));
+        if (max_diff > 1e-5)
+            is_matching = false;
+
+        std::cout << "  " << std::left << std::setw(26) << c.m_name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(11) << scalar_ns
+                  << std::setw(11) << simd_ns
+                  << std::setw(8) << scalar_ns / simd_ns << "x"
+                  << std::scientific << std::setprecision(1) << std::setw(12) << max_diff
+                  << std::defaultfloat << std::endl;
+    }
+
+    std::cout << (is_matching ? "  all results within tolerance" : "  MISMATCH") << std::endl;
+    return is_matching ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
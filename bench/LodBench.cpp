@@ -0,0 +1,307 @@
+#ifndef LODBENCH_CPP
+#define LODBENCH_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Bench.hpp"
+#include "MeshletBench.cpp"
+#include "../src/ThreadPool.hpp"
+#include "../src/ThreadPool.cpp"
+#include "../src/CpuCuller.hpp"
+#include "../src/CpuCuller.cpp"
+#include "../src/LodUtils.hpp"
+#include "../src/LodUtils.cpp"
+
+/// @brief 实测一级LOD相对原网格的误差
+struct MeasuredLodError
+{
+    double m_max = 0.0;
+    double m_rms = 0.0;
+
+    /// @brief 朝向与原网格相反的三角形数
+    size_t m_flipped = 0;
+};
+
+/// @brief 球面：原网格的顶点都在单位球上，在LOD三角形上取样，到球面的径向距离即误差；
+/// orientation为1时法线应朝外，为-1时朝内
+MeasuredLodError measure_sphere_lod(const MeshletMesh &mesh, const uint32_t *indices, size_t index_count, float orientation)
+{
+    MeasuredLodError measured;
+    size_t samples = 0;
+    for (size_t t = 0; t < index_count / 3; t++)
+    {
+        const float *p[3] = {&mesh.m_positions[indices[t * 3] * 3], &mesh.m_positions[indices[t * 3 + 1] * 3], &mesh.m_positions[indices[t * 3 + 2] * 3]};
+        float normal[3];
+        const float *corner = nullptr;
+        get_meshlet_triangle(mesh, indices + t * 3, normal, corner);
+        // 极点附近几乎退化的三角形法线只剩舍入误差，不判断朝向
+        float longest = 0.0f;
+        for (size_t k = 0; k < 3; k++)
+        {
+            const float *a = p[k], *b = p[(k + 1) % 3];
+            longest = std::max(longest, (b[0] - a[0]) * (b[0] - a[0]) + (b[1] - a[1]) * (b[1] - a[1]) + (b[2] - a[2]) * (b[2] - a[2]));
+        }
+        if (normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] <= 1e-8f * longest * longest)
+            continue;
+        if (orientation * (normal[0] * (p[0][0] + p[1][0] + p[2][0]) + normal[1] * (p[0][1] + p[1][1] + p[2][1]) + normal[2] * (p[0][2] + p[1][2] + p[2][2])) <= 0.0f)
+            measured.m_flipped++;
+
+        // 重心和三条边的中点
+        const float weights[4][3] = {{1.0f / 3, 1.0f / 3, 1.0f / 3}, {0.5f, 0.5f, 0.0f}, {0.0f, 0.5f, 0.5f}, {0.5f, 0.0f, 0.5f}};
+        for (const float *w : weights)
+        {
+            double x = w[0] * p[0][0] + w[1] * p[1][0] + w[2] * p[2][0];
+            double y = w[0] * p[0][1] + w[1] * p[1][1] + w[2] * p[2][1];
+            double z = w[0] * p[0][2] + w[1] * p[1][2] + w[2] * p[2][2];
+            double error = 1.0 - std::sqrt(x * x + y * y + z * z);
+            measured.m_max = std::max(measured.m_max, error);
+            measured.m_rms += error * error;
+            samples++;
+        }
+    }
+    measured.m_rms = samples > 0 ? std::sqrt(measured.m_rms / samples) : 0.0;
+    return measured;
+}
+
+/// @brief 高度场：LOD三角形覆盖原网格的每个格点，在格点处插值高度与原高度比较，法线不应朝下
+MeasuredLodError measure_terrain_lod(const MeshletMesh &mesh, uint32_t size, const uint32_t *indices, size_t index_count)
+{
+    MeasuredLodError measured;
+    size_t samples = 0;
+    auto grid = [size](float coordinate)
+    {
+        return (coordinate + 1.0f) * 0.5f * size;
+    };
+    for (size_t t = 0; t < index_count / 3; t++)
+    {
+        const float *p[3] = {&mesh.m_positions[indices[t * 3] * 3], &mesh.m_positions[indices[t * 3 + 1] * 3], &mesh.m_positions[indices[t * 3 + 2] * 3]};
+        float normal[3];
+        const float *corner = nullptr;
+        get_meshlet_triangle(mesh, indices + t * 3, normal, corner);
+        // 竖直的细长三角形在水平面上的投影面积为0，不覆盖任何格点
+        if (normal[1] <= 0.0f)
+        {
+            measured.m_flipped += normal[1] < 0.0f;
+            continue;
+        }
+
+        // 只取严格在三角形内或在左、上边上的格点，相邻三角形的公共边不重复取样
+        float gx[3], gz[3];
+        for (size_t k = 0; k < 3; k++)
+            gx[k] = grid(p[k][0]), gz[k] = grid(p[k][2]);
+        int x0 = static_cast<int>(std::floor(std::min({gx[0], gx[1], gx[2]}))), x1 = static_cast<int>(std::ceil(std::max({gx[0], gx[1], gx[2]})));
+        int z0 = static_cast<int>(std::floor(std::min({gz[0], gz[1], gz[2]}))), z1 = static_cast<int>(std::ceil(std::max({gz[0], gz[1], gz[2]})));
+        double area = (gx[1] - gx[0]) * (gz[2] - gz[0]) - (gx[2] - gx[0]) * (gz[1] - gz[0]);
+        for (int z = z0; z <= z1; z++)
+            for (int x = x0; x <= x1; x++)
+            {
+                double w[3];
+                for (size_t k = 0; k < 3; k++)
+                {
+                    size_t a = (k + 1) % 3, b = (k + 2) % 3;
+                    w[k] = ((gx[b] - gx[a]) * (z - gz[a]) - (x - gx[a]) * (gz[b] - gz[a])) / area;
+                }
+                if (w[0] < 0.0 || w[1] < 0.0 || w[2] < 0.0)
+                    continue;
+                double height = w[0] * p[0][1] + w[1] * p[1][1] + w[2] * p[2][1];
+                double error = std::abs(height - mesh.m_positions[(static_cast<size_t>(z) * (size + 1) + x) * 3 + 1]);
+                measured.m_max = std::max(measured.m_max, error);
+                measured.m_rms += error * error;
+                samples++;
+            }
+    }
+    measured.m_rms = samples > 0 ? std::sqrt(measured.m_rms / samples) : 0.0;
+    return measured;
+}
+
+/// @brief LOD基准：生成LOD链并实测误差，再在大量实例上按屏幕空间误差选择级别，统计三角形数和级别切换
+int run_lod_bench(int argc, char **argv)
+{
+    uint32_t rings = static_cast<uint32_t>(bench::get_option(argc, argv, "--rings", 256LL));
+    uint32_t segments = static_cast<uint32_t>(bench::get_option(argc, argv, "--segments", 512LL));
+    uint32_t terrain_size = static_cast<uint32_t>(bench::get_option(argc, argv, "--terrain", 512LL));
+    size_t instance_count = static_cast<size_t>(bench::get_option(argc, argv, "--instances", 16384LL));
+    int frame_count = static_cast<int>(bench::get_option(argc, argv, "--frames", 256LL));
+    float threshold = static_cast<float>(std::atof(bench::get_option(argc, argv, "--threshold", std::string("1")).c_str()));
+    float hysteresis = static_cast<float>(std::atof(bench::get_option(argc, argv, "--hysteresis", std::string("0.25")).c_str()));
+    float viewport_height = static_cast<float>(bench::get_option(argc, argv, "--height", 1080LL));
+
+    std::vector<MeshletMesh> meshes;
+    meshes.push_back(make_meshlet_sphere(rings, segments));
+    meshes.push_back(make_meshlet_terrain(terrain_size));
+
+    std::cout << "lod chain: error is the QEM estimate, measured error is sampled against the exact surface" << std::endl
+              << "      mesh  lod  triangles   ratio      error  measured max  measured rms  flipped  build ms" << std::endl;
+
+    bool is_passed = true;
+    std::vector<std::vector<uint32_t>> chains(meshes.size());
+    std::vector<std::vector<vl::LodUtils::Lod>> lod_lists(meshes.size());
+    for (size_t m = 0; m < meshes.size(); m++)
+    {
+        const MeshletMesh &mesh = meshes[m];
+        const size_t vertex_count = mesh.m_positions.size() / 3;
+        std::vector<uint32_t> &indices = chains[m];
+        std::vector<vl::LodUtils::Lod> &lods = lod_lists[m];
+        indices = mesh.m_indices;
+
+        bench::Stopwatch stopwatch;
+        vl::LodUtils::build_chain(indices, mesh.m_positions.data(), sizeof(float) * 3, vertex_count, lods);
+        double build_ms = stopwatch.milliseconds();
+
+        // 每级都更少、误差不减、索引有效且没有与第0级朝向相反的三角形
+        bool is_valid = lods.size() > 1;
+        float orientation = 1.0f;
+        if (m == 0 && measure_sphere_lod(mesh, indices.data(), lods[0].m_index_count, 1.0f).m_flipped > lods[0].m_index_count / 6)
+            orientation = -1.0f;
+        for (size_t l = 0; l < lods.size(); l++)
+        {
+            const vl::LodUtils::Lod &lod = lods[l];
+            const uint32_t *range = indices.data() + lod.m_first_index;
+            is_valid &= static_cast<uint64_t>(lod.m_first_index) + lod.m_index_count <= indices.size() && lod.m_index_count % 3 == 0;
+            if (l > 0)
+                is_valid &= lod.m_index_count < lods[l - 1].m_index_count && lod.m_error >= lods[l - 1].m_error;
+            for (uint32_t i = 0; i < lod.m_index_count && is_valid; i++)
+                is_valid &= range[i] < vertex_count;
+            if (!is_valid)
+                break;
+
+            MeasuredLodError measured = m == 0 ? measure_sphere_lod(mesh, range, lod.m_index_count, orientation)
+                                               : measure_terrain_lod(mesh, terrain_size, range, lod.m_index_count);
+            is_valid &= measured.m_flipped == 0;
+            std::cout << std::fixed << std::setprecision(5)
+                      << std::setw(10) << mesh.m_name
+                      << std::setw(5) << l
+                      << std::setw(11) << lod.m_index_count / 3
+                      << std::setw(8) << std::setprecision(3) << static_cast<double>(lod.m_index_count) / lods[0].m_index_count
+                      << std::setw(11) << std::setprecision(5) << lod.m_error
+                      << std::setw(14) << measured.m_max
+                      << std::setw(14) << measured.m_rms
+                      << std::setw(9) << measured.m_flipped
+                      << std::setw(10) << std::setprecision(1) << (l == 0 ? build_ms : 0.0)
+                      << std::defaultfloat << std::endl;
+        }
+        if (!is_valid)
+        {
+            std::cout << std::setw(10) << mesh.m_name << "  invalid lod chain" << std::endl;
+            is_passed = false;
+        }
+    }
+
+    // 实例为半径1~4的球，分布在边长200的方形区域内，相机在区域上方缓慢向前飞行，带前后摆动，使部分实例在阈值附近来回
+    const std::vector<vl::LodUtils::Lod> &lods = lod_lists[0];
+    const uint32_t lod_count = static_cast<uint32_t>(lods.size());
+    uint32_t state = 12345u;
+    auto next = [&state]()
+    {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.0f;
+    };
+    std::vector<float> spheres(instance_count * 4);
+    vl::CpuCuller culler;
+    culler.resize(instance_count);
+    for (size_t i = 0; i < instance_count; i++)
+    {
+        float *sphere = &spheres[i * 4];
+        sphere[0] = next() * 200.0f - 100.0f;
+        sphere[1] = next() * 4.0f;
+        sphere[2] = next() * 200.0f - 100.0f;
+        sphere[3] = 1.0f + next() * 3.0f;
+        float min[3], max[3];
+        for (int k = 0; k < 3; k++)
+            min[k] = sphere[k] - sphere[3], max[k] = sphere[k] + sphere[3];
+        culler.set(i, min, max);
+    }
+    culler.build();
+
+    const float fovy = 1.0f;
+    const float projection_scale = vl::LodUtils::get_projection_scale(fovy, viewport_height);
+    auto make_frame = [&](int frame, float eye[3], float planes[vl::FrustumUtils::PLANE_COUNT * 4])
+    {
+        float t = static_cast<float>(frame) / frame_count;
+        vec3 position = {0.0f, 6.0f, 100.0f - 100.0f * t + 1.5f * std::sin(frame * 1.7f)};
+        vec3 target = {0.0f, 2.0f, position[2] - 50.0f};
+        vec3 up = {0.0f, 1.0f, 0.0f};
+        mat4x4 projection, view, view_projection;
+        mat4x4_perspective(projection, fovy, 16.0f / 9.0f, 0.1f, 1000.0f);
+        mat4x4_look_at(view, position, target, up);
+        mat4x4_mul(view_projection, projection, view);
+        vl::FrustumUtils::extract_planes(&view_projection[0][0], planes, false);
+        std::copy(position, position + 3, eye);
+    };
+
+    std::cout << "lod selection: " << instance_count << " sphere instances, " << frame_count << " frames, "
+              << static_cast<uint32_t>(viewport_height) << "p, " << lod_count << " lods, hysteresis " << std::setprecision(2) << hysteresis << std::endl
+              << "  threshold px  visible  full Mtri  lod Mtri  reduction  max error px  switches/frame  no hysteresis  select ns  lod histogram" << std::endl;
+
+    const float thresholds[] = {threshold * 0.5f, threshold, threshold * 2.0f, threshold * 4.0f};
+    std::vector<uint32_t> visible;
+    for (float pixels : thresholds)
+    {
+        std::vector<uint32_t> current(instance_count, UINT32_MAX), plain(instance_count, UINT32_MAX);
+        std::vector<size_t> histogram(lod_count, 0);
+        double full_triangles = 0.0, lod_triangles = 0.0, max_error = 0.0, select_ns = 0.0;
+        size_t visible_sum = 0, switches = 0, plain_switches = 0;
+        for (int frame = 0; frame < frame_count; frame++)
+        {
+            float eye[3], planes[vl::FrustumUtils::PLANE_COUNT * 4];
+            make_frame(frame, eye, planes);
+            culler.cull(planes, visible);
+            visible_sum += visible.size();
+
+            bench::Stopwatch stopwatch;
+            for (uint32_t index : visible)
+            {
+                const float *sphere = &spheres[index * 4];
+                float dx = sphere[0] - eye[0], dy = sphere[1] - eye[1], dz = sphere[2] - eye[2];
+                float distance = std::sqrt(dx * dx + dy * dy + dz * dz) - sphere[3];
+                uint32_t lod = vl::LodUtils::select(lods.data(), lod_count, distance, projection_scale * sphere[3], pixels, current[index], hysteresis);
+                switches += current[index] != UINT32_MAX && lod != current[index];
+                current[index] = lod;
+            }
+            select_ns += stopwatch.seconds() * 1e9;
+
+            // 统计和无滞后的对照不计时
+            for (uint32_t index : visible)
+            {
+                const float *sphere = &spheres[index * 4];
+                float dx = sphere[0] - eye[0], dy = sphere[1] - eye[1], dz = sphere[2] - eye[2];
+                float distance = std::sqrt(dx * dx + dy * dy + dz * dz) - sphere[3];
+                uint32_t lod = current[index];
+                uint32_t plain_lod = vl::LodUtils::select(lods.data(), lod_count, distance, projection_scale * sphere[3], pixels);
+                plain_switches += plain[index] != UINT32_MAX && plain_lod != plain[index];
+                plain[index] = plain_lod;
+
+                histogram[lod]++;
+                full_triangles += lods[0].m_index_count / 3;
+                lod_triangles += lods[lod].m_index_count / 3;
+                if (distance > 0.0f)
+                    max_error = std::max(max_error, static_cast<double>(lods[lod].m_error) * sphere[3] * projection_scale / distance);
+            }
+        }
+
+        // 选择的级别投影后不能超过阈值
+        if (max_error > pixels * 1.0001)
+            is_passed = false;
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(14) << pixels
+                  << std::setw(9) << visible_sum / frame_count
+                  << std::setw(11) << full_triangles / frame_count / 1e6
+                  << std::setw(10) << std::setprecision(3) << lod_triangles / frame_count / 1e6
+                  << std::setw(10) << std::setprecision(1) << (full_triangles > 0.0 ? full_triangles / lod_triangles : 0.0) << "x"
+                  << std::setw(14) << std::setprecision(3) << max_error
+                  << std::setw(16) << std::setprecision(1) << static_cast<double>(switches) / frame_count
+                  << std::setw(15) << static_cast<double>(plain_switches) / frame_count
+                  << std::setw(11) << (visible_sum > 0 ? select_ns / visible_sum : 0.0)
+                  << "  ";
+        for (size_t l = 0; l < histogram.size(); l++)
+            std::cout << (l > 0 ? "/" : "") << histogram[l] / frame_count;
+        std::cout << std::defaultfloat << std::endl;
+    }
+
+    std::cout << (is_passed ? "lod: all checks passed" : "lod: check failed") << std::endl;
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
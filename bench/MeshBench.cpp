@@ -0,0 +1,172 @@
+#ifndef MESHBENCH_CPP
+#define MESHBENCH_CPP
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include "Bench.hpp"
+#include "../src/MeshUtils.hpp"
+#include "../src/MeshUtils.cpp"
+
+/// @brief 用顶点内容描述三角形，重排前后的集合应当相同
+std::vector<std::array<uint64_t, 3>> describe_triangles(const uint8_t *vertices, size_t vertex_size, const uint32_t *indices, size_t index_count)
+{
+    std::vector<std::array<uint64_t, 3>> triangles(index_count / 3);
+    for (size_t i = 0; i < index_count; i++)
+    {
+        const uint8_t *vertex = vertices + static_cast<size_t>(indices ? indices[i] : i) * vertex_size;
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t k = 0; k < vertex_size; k++)
+            hash = (hash ^ vertex[k]) * 1099511628211ull;
+        triangles[i / 3][i % 3] = hash;
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+/// @brief 生成打乱三角形顺序的球面三角形列表，每个顶点为位置和法线
+std::vector<float> make_sphere_soup(uint32_t rings, uint32_t segments)
+{
+    const float pi = 3.14159265358979f;
+    auto vertex = [&](uint32_t ring, uint32_t segment, std::vector<float> &out)
+    {
+        float theta = pi * ring / rings;
+        float phi = 2.0f * pi * (segment % segments) / segments;
+        float x = std::sin(theta) * std::cos(phi), y = std::cos(theta), z = std::sin(theta) * std::sin(phi);
+        out.insert(out.end(), {x, y, z, x, y, z});
+    };
+
+    std::vector<std::vector<float>> triangles;
+    for (uint32_t r = 0; r < rings; r++)
+        for (uint32_t s = 0; s < segments; s++)
+        {
+            std::vector<float> a, b;
+            vertex(r, s, a), vertex(r + 1, s, a), vertex(r + 1, s + 1, a);
+            vertex(r, s, b), vertex(r + 1, s + 1, b), vertex(r, s + 1, b);
+            triangles.push_back(std::move(a));
+            triangles.push_back(std::move(b));
+        }
+
+    uint32_t state = rings * 7919u + segments;
+    for (size_t i = triangles.size(); i > 1; i--)
+    {
+        state = state * 1664525u + 1013904223u;
+        std::swap(triangles[i - 1], triangles[(state >> 8) % i]);
+    }
+
+    std::vector<float> soup;
+    soup.reserve(triangles.size() * 18);
+    for (const std::vector<float> &triangle : triangles)
+        soup.insert(soup.end(), triangle.begin(), triangle.end());
+    return soup;
+}
+
+/// @brief 网格优化基准：合并顶点、Tipsify重排、按遮挡排序簇、按取顶点重排，报告每一步的ACMR/ATVR并检查三角形不变
+int run_mesh_bench(int argc, char **argv)
+{
+    uint32_t cache_size = static_cast<uint32_t>(bench::get_option(argc, argv, "--cache", 16LL));
+    uint32_t rings = static_cast<uint32_t>(bench::get_option(argc, argv, "--rings", 256LL));
+    uint32_t segments = static_cast<uint32_t>(bench::get_option(argc, argv, "--segments", 512LL));
+
+    // cube.cpp的g_vertex_buffer_data与g_uv_buffer_data交错为位置和纹理坐标
+    static const float cube_positions[] = {
+        -1, -1, -1, -1, -1, 1, -1, 1, 1, -1, 1, 1, -1, 1, -1, -1, -1, -1,
+        -1, -1, -1, 1, 1, -1, 1, -1, -1, -1, -1, -1, -1, 1, -1, 1, 1, -1,
+        -1, -1, -1, 1, -1, -1, 1, -1, 1, -1, -1, -1, 1, -1, 1, -1, -1, 1,
+        -1, 1, -1, -1, 1, 1, 1, 1, 1, -1, 1, -1, 1, 1, 1, 1, 1, -1,
+        1, 1, -1, 1, 1, 1, 1, -1, 1, 1, -1, 1, 1, -1, -1, 1, 1, -1,
+        -1, 1, 1, -1, -1, 1, 1, 1, 1, -1, -1, 1, 1, -1, 1, 1, 1, 1};
+    static const float cube_uvs[] = {
+        0, 1, 1, 1, 1, 0, 1, 0, 0, 0, 0, 1,
+        1, 1, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0,
+        1, 0, 1, 1, 0, 1, 1, 0, 0, 1, 0, 0,
+        1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1,
+        1, 0, 0, 0, 0, 1, 0, 1, 1, 1, 1, 0,
+        0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 0};
+    std::vector<float> cube_textured;
+    for (size_t i = 0; i < 36; i++)
+        cube_textured.insert(cube_textured.end(), {cube_positions[i * 3], cube_positions[i * 3 + 1], cube_positions[i * 3 + 2],
+                                                   cube_uvs[i * 2], cube_uvs[i * 2 + 1]});
+
+    struct Mesh
+    {
+        const char *m_name;
+        std::vector<float> m_soup;
+        size_t m_floats_per_vertex;
+    };
+    std::vector<Mesh> meshes = {
+        {"cube position", std::vector<float>(std::begin(cube_positions), std::end(cube_positions)), 3},
+        {"cube position+uv", cube_textured, 5},
+        {"sphere shuffled", make_sphere_soup(rings, segments), 6},
+    };
+
+    std::cout << "mesh optimization: FIFO cache " << cache_size << ", ACMR/ATVR after each step" << std::endl
+              << "              mesh  triangles  soup verts  welded  welded ACMR/ATVR  tipsify ACMR/ATVR  clusters  overdraw ACMR/ATVR  weld ms  tipsify ms  overdraw ms  fetch ms  valid" << std::endl;
+
+    bool is_passed = true;
+    for (const Mesh &mesh : meshes)
+    {
+        const size_t vertex_size = mesh.m_floats_per_vertex * sizeof(float);
+        const size_t soup_count = mesh.m_soup.size() / mesh.m_floats_per_vertex;
+        const uint8_t *soup = reinterpret_cast<const uint8_t *>(mesh.m_soup.data());
+        std::vector<std::array<uint64_t, 3>> expected = describe_triangles(soup, vertex_size, nullptr, soup_count);
+
+        bench::Stopwatch stopwatch;
+        std::vector<uint8_t> vertices;
+        std::vector<uint32_t> indices;
+        size_t vertex_count = vl::MeshUtils::weld(soup, soup_count, vertex_size, vertices, indices);
+        double weld_ms = stopwatch.milliseconds();
+        vl::MeshUtils::CacheStatistics welded = vl::MeshUtils::analyze_vertex_cache(indices.data(), indices.size(), vertex_count, cache_size);
+
+        stopwatch.reset();
+        std::vector<uint32_t> clusters;
+        vl::MeshUtils::optimize_vertex_cache(indices, vertex_count, cache_size, &clusters);
+        double tipsify_ms = stopwatch.milliseconds();
+        vl::MeshUtils::CacheStatistics tipsify = vl::MeshUtils::analyze_vertex_cache(indices.data(), indices.size(), vertex_count, cache_size);
+
+        stopwatch.reset();
+        vl::MeshUtils::optimize_overdraw(indices, reinterpret_cast<const float *>(vertices.data()), vertex_size, vertex_count, clusters);
+        double overdraw_ms = stopwatch.milliseconds();
+        vl::MeshUtils::CacheStatistics overdraw = vl::MeshUtils::analyze_vertex_cache(indices.data(), indices.size(), vertex_count, cache_size);
+
+        stopwatch.reset();
+        size_t fetched_count = vl::MeshUtils::optimize_vertex_fetch(indices, vertices.data(), vertex_count, vertex_size);
+        double fetch_ms = stopwatch.milliseconds();
+        vl::MeshUtils::CacheStatistics fetched = vl::MeshUtils::analyze_vertex_cache(indices.data(), indices.size(), fetched_count, cache_size);
+
+        // 三角形集合不变，取顶点重排不改变缓存命中，重排后第一次引用的顶点序号递增
+        bool is_valid = describe_triangles(vertices.data(), vertex_size, indices.data(), indices.size()) == expected &&
+                        fetched.m_transformed_count == overdraw.m_transformed_count &&
+                        fetched_count == vertex_count;
+        uint32_t next = 0;
+        for (uint32_t index : indices)
+        {
+            if (index > next)
+                is_valid = false;
+            else if (index == next)
+                next++;
+        }
+        is_passed &= is_valid;
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(18) << mesh.m_name
+                  << std::setw(11) << indices.size() / 3
+                  << std::setw(12) << soup_count
+                  << std::setw(8) << vertex_count
+                  << std::setw(10) << welded.m_acmr << "/" << std::setw(7) << welded.m_atvr
+                  << std::setw(11) << tipsify.m_acmr << "/" << std::setw(7) << tipsify.m_atvr
+                  << std::setw(10) << clusters.size()
+                  << std::setw(12) << overdraw.m_acmr << "/" << std::setw(7) << overdraw.m_atvr
+                  << std::setw(9) << weld_ms
+                  << std::setw(12) << tipsify_ms
+                  << std::setw(13) << overdraw_ms
+                  << std::setw(10) << fetch_ms
+                  << std::setw(7) << (is_valid ? "yes" : "NO")
+                  << std::defaultfloat << std::endl;
+    }
+
+    std::cout << (is_passed ? "  all meshes keep their triangles" : "  MISMATCH") << std::endl;
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
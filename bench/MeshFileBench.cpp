@@ -0,0 +1,210 @@
+#ifndef MESHFILEBENCH_CPP
+#define MESHFILEBENCH_CPP
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include "Bench.hpp"
+#include "../tools/MeshConverter.cpp"
+
+/// @brief 写一个球面网格的OBJ文件
+bool write_sphere_obj(const std::string &path, uint32_t rings, uint32_t segments)
+{
+    std::ofstream fout(path);
+    if (!fout)
+        return false;
+
+    fout << std::fixed << std::setprecision(6);
+    for (uint32_t r = 0; r <= rings; r++)
+        for (uint32_t s = 0; s <= segments; s++)
+        {
+            float theta = 3.14159265f * r / rings, phi = 6.2831853f * s / segments;
+            float x = std::sin(theta) * std::cos(phi), y = std::cos(theta), z = std::sin(theta) * std::sin(phi);
+            fout << "v " << x << " " << y << " " << z << "\n"
+                 << "vn " << x << " " << y << " " << z << "\n"
+                 << "vt " << static_cast<float>(s) / segments << " " << static_cast<float>(r) / rings << "\n";
+        }
+
+    // 四边形面，由转换器拆成三角形
+    for (uint32_t r = 0; r < rings; r++)
+        for (uint32_t s = 0; s < segments; s++)
+        {
+            uint32_t a = r * (segments + 1) + s + 1, b = a + segments + 1;
+            fout << "f " << a << "/" << a << "/" << a << " " << b << "/" << b << "/" << b << " "
+                 << b + 1 << "/" << b + 1 << "/" << b + 1 << " " << a + 1 << "/" << a + 1 << "/" << a + 1 << "\n";
+        }
+    return static_cast<bool>(fout);
+}
+
+/// @brief 网格文件基准：OBJ转换、文件检查、mmap与read()加载到暂存环的吞吐量
+int run_mesh_file_bench(int argc, char **argv)
+{
+    uint32_t rings = static_cast<uint32_t>(bench::get_option(argc, argv, "--rings", 512LL));
+    uint32_t segments = static_cast<uint32_t>(bench::get_option(argc, argv, "--segments", 1024LL));
+    int repeat = static_cast<int>(bench::get_option(argc, argv, "--repeat", 10LL));
+    std::string directory = bench::get_option(argc, argv, "--dir", std::string("."));
+    const std::string obj_path = directory + "/mesh_bench.obj";
+
+    bench::Stopwatch stopwatch;
+    if (!write_sphere_obj(obj_path, rings, segments))
+    {
+        std::cout << "failed to write " << obj_path << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "mesh file: wrote " << obj_path << " in " << stopwatch.milliseconds() << " ms" << std::endl;
+
+    struct Case
+    {
+        const char *m_name;
+        std::string m_path;
+        bool m_is_quantized;
+    };
+    std::vector<Case> cases = {
+        {"quantized", directory + "/mesh_bench.vlm", true},
+        {"float", directory + "/mesh_bench_float.vlm", false},
+    };
+
+    bool is_passed = true;
+    for (const Case &test : cases)
+    {
+        MeshConvertOptions options;
+        options.m_is_quantized = test.m_is_quantized;
+        stopwatch.reset();
+        is_passed &= convert_mesh(obj_path, test.m_path, options);
+        std::cout << "  converted in " << stopwatch.milliseconds() << " ms" << std::endl;
+    }
+    if (!is_passed)
+        return EXIT_FAILURE;
+
+    // 两种打开方式读到相同的内容，布局可以还原
+    {
+        vl::MeshFile mapped, read;
+        bool is_valid = mapped.open(cases[0].m_path, vl::MeshFile::Mode::eMap) &&
+                        read.open(cases[0].m_path, vl::MeshFile::Mode::eRead) &&
+                        std::memcmp(&mapped.get_header(), &read.get_header(), sizeof(vl::MeshFile::Header)) == 0;
+        if (is_valid)
+        {
+            for (uint32_t type : {vl::MeshFile::CHUNK_VERTICES, vl::MeshFile::CHUNK_INDICES})
+            {
+                const vl::MeshFile::Chunk *a = mapped.find_chunk(type), *b = read.find_chunk(type);
+                is_valid &= a && b && a->m_size == b->m_size &&
+                            reinterpret_cast<uintptr_t>(mapped.get_chunk_data(*a)) % vl::MeshFile::ALIGNMENT == 0 &&
+                            std::memcmp(mapped.get_chunk_data(*a), read.get_chunk_data(*b), static_cast<size_t>(a->m_size)) == 0;
+            }
+            vl::VertexLayout layout;
+            mapped.get_layout(layout);
+            is_valid &= layout.get_stride(0) == mapped.get_header().m_vertex_stride && layout.get_elements().size() == 3;
+            const vl::MeshFile::Header &header = mapped.get_header();
+            const vl::MeshFile::Chunk *lods = mapped.find_chunk(vl::MeshFile::CHUNK_LODS);
+            is_valid &= header.m_sphere[3] > 0.99f && header.m_sphere[3] < 1.01f &&
+                        mapped.find_chunk(vl::MeshFile::CHUNK_MESHLETS) != nullptr && lods != nullptr && lods->m_count > 1 &&
+                        static_cast<const vl::LodUtils::Lod *>(mapped.get_chunk_data(*lods))->m_index_count == rings * segments * 6;
+        }
+        std::cout << "mesh file: mmap and read() contents " << (is_valid ? "match" : "MISMATCH") << std::endl;
+        is_passed &= is_valid;
+    }
+
+    // 损坏的文件必须被拒绝
+    {
+        std::ifstream fin(cases[0].m_path, std::ios::binary);
+        std::vector<uint8_t> original((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        std::vector<uint64_t> storage((original.size() + 7) / 8);
+        auto check = [&](const char *name, size_t size, auto corrupt)
+        {
+            std::memcpy(storage.data(), original.data(), original.size());
+            uint8_t *bytes = reinterpret_cast<uint8_t *>(storage.data());
+            corrupt(reinterpret_cast<vl::MeshFile::Header *>(bytes), reinterpret_cast<vl::MeshFile::Chunk *>(bytes + sizeof(vl::MeshFile::Header)));
+            vl::MeshFile file;
+            bool is_rejected = !file.open_memory(bytes, size);
+            std::cout << "  " << std::setw(24) << name << (is_rejected ? "  rejected" : "  ACCEPTED") << std::endl;
+            is_passed &= is_rejected;
+        };
+        std::cout << "mesh file: corrupted inputs" << std::endl;
+        check("truncated header", 100, [](auto *, auto *) {});
+        check("truncated chunk", original.size() - 1, [](auto *, auto *) {});
+        check("bad magic", original.size(), [](auto *header, auto *)
+              { header->m_magic = 0; });
+        check("bad version", original.size(), [](auto *header, auto *)
+              { header->m_version = 99; });
+        check("too many chunks", original.size(), [](auto *header, auto *)
+              { header->m_chunk_count = 1000; });
+        check("bad stride", original.size(), [](auto *header, auto *)
+              { header->m_vertex_stride += 4; });
+        check("bad element", original.size(), [](auto *header, auto *)
+              { header->m_elements[0].m_attribute = 200; });
+        check("misaligned chunk", original.size(), [](auto *, auto *chunks)
+              { chunks[0].m_offset += 4; });
+        check("overflowing chunk", original.size(), [](auto *, auto *chunks)
+              { chunks[1].m_size = UINT64_MAX - 16; });
+        check("wrong index count", original.size(), [](auto *header, auto *)
+              { header->m_index_count++; });
+        check("meshlet out of range", original.size(), [](auto *header, auto *chunks)
+              { reinterpret_cast<vl::MeshletUtils::Meshlet *>(reinterpret_cast<uint8_t *>(header) + chunks[2].m_offset)->m_vertex_offset = UINT32_MAX; });
+        check("missing meshlet chunk", original.size(), [](auto *, auto *chunks)
+              { chunks[3].m_type = 100; });
+        check("lod out of range", original.size(), [](auto *header, auto *chunks)
+              {
+                  for (uint32_t i = 0; i < header->m_chunk_count; i++)
+                      if (chunks[i].m_type == vl::MeshFile::CHUNK_LODS)
+                          reinterpret_cast<vl::LodUtils::Lod *>(reinterpret_cast<uint8_t *>(header) + chunks[i].m_offset)[1].m_first_index = header->m_index_count; });
+    }
+
+    // 暂存环使用主机内存，只测量从文件到暂存环的复制
+    std::cout << "mesh file: load into staging ring, page cache warm" << std::endl
+              << "         file         MB  mmap ms  mmap MB/s  read ms  read MB/s" << std::endl;
+    for (const Case &test : cases)
+    {
+        vl::MeshFile probe;
+        if (!probe.open(test.m_path))
+            return EXIT_FAILURE;
+        uint64_t bytes = probe.find_chunk(vl::MeshFile::CHUNK_VERTICES)->m_size + probe.find_chunk(vl::MeshFile::CHUNK_INDICES)->m_size;
+        probe.close();
+
+        std::vector<uint8_t> memory(bytes + 1024);
+        vl::MappedBuffer host;
+        host.m_mapped = memory.data();
+        host.m_size = memory.size();
+        host.m_is_coherent = true;
+        vl::StagingRing ring;
+        ring.attach(host);
+
+        auto load = [&](vl::MeshFile::Mode mode)
+        {
+            std::vector<double> times;
+            for (int r = 0; r < repeat; r++)
+            {
+                stopwatch.reset();
+                vl::MeshFile file;
+                bool is_loaded = file.open(test.m_path, mode) &&
+                                 file.stage_chunk(ring, vl::MeshFile::CHUNK_VERTICES).has_value() &&
+                                 file.stage_chunk(ring, vl::MeshFile::CHUNK_INDICES).has_value();
+                file.close();
+                times.push_back(stopwatch.milliseconds());
+                ring.release(ring.submit());
+                is_passed &= is_loaded;
+            }
+            return bench::percentile(times, 50);
+        };
+        double map_ms = load(vl::MeshFile::Mode::eMap);
+        double read_ms = load(vl::MeshFile::Mode::eRead);
+
+        double megabytes = bytes / 1048576.0;
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(13) << test.m_name
+                  << std::setw(11) << megabytes
+                  << std::setw(9) << map_ms
+                  << std::setw(11) << megabytes / (map_ms / 1000.0)
+                  << std::setw(9) << read_ms
+                  << std::setw(11) << megabytes / (read_ms / 1000.0)
+                  << std::defaultfloat << std::endl;
+    }
+
+    std::remove(obj_path.c_str());
+    for (const Case &test : cases)
+        std::remove(test.m_path.c_str());
+
+    std::cout << (is_passed ? "  all mesh file checks passed" : "  MISMATCH") << std::endl;
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
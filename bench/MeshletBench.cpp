@@ -0,0 +1,620 @@
+#ifndef MESHLETBENCH_CPP
+#define MESHLETBENCH_CPP
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Bench.hpp"
+#include "MeshBench.cpp"
+#include "../examples/demo/linmath.h"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/PhysicalDeviceUtils.hpp"
+#include "../src/PhysicalDeviceUtils.cpp"
+#include "../src/DefaultQueueFamilyIndices.hpp"
+#include "../src/DefaultQueueFamilyIndices.cpp"
+#include "../src/HeadlessContext.hpp"
+#include "../src/HeadlessContext.cpp"
+#include "../src/MappedBuffer.hpp"
+#include "../src/MappedBuffer.cpp"
+#include "../src/FrustumUtils.hpp"
+#include "../src/FrustumUtils.cpp"
+#include "../src/MeshletUtils.hpp"
+#include "../src/MeshletUtils.cpp"
+#include "../src/ClusterCuller.hpp"
+#include "../src/ClusterCuller.cpp"
+
+/// @brief 生成簇用的网格，位置为每个顶点3个float
+struct MeshletMesh
+{
+    const char *m_name;
+    std::vector<float> m_positions;
+    std::vector<uint32_t> m_indices;
+};
+
+/// @brief 球面：合并MeshBench的三角形列表后做顶点缓存和取顶点重排，与转换器的顺序相同
+MeshletMesh make_meshlet_sphere(uint32_t rings, uint32_t segments)
+{
+    std::vector<float> soup = make_sphere_soup(rings, segments);
+    std::vector<uint8_t> vertices;
+    MeshletMesh mesh = {"sphere", {}, {}};
+    size_t vertex_count = vl::MeshUtils::weld(soup.data(), soup.size() / 6, sizeof(float) * 6, vertices, mesh.m_indices);
+    vl::MeshUtils::optimize_vertex_cache(mesh.m_indices, vertex_count);
+    vertex_count = vl::MeshUtils::optimize_vertex_fetch(mesh.m_indices, vertices.data(), vertex_count, sizeof(float) * 6);
+
+    const float *floats = reinterpret_cast<const float *>(vertices.data());
+    for (size_t v = 0; v < vertex_count; v++)
+        mesh.m_positions.insert(mesh.m_positions.end(), floats + v * 6, floats + v * 6 + 3);
+    return mesh;
+}
+
+/// @brief 起伏的地形，大部分三角形朝上，法线锥剔除的效果比球面好
+MeshletMesh make_meshlet_terrain(uint32_t size)
+{
+    MeshletMesh mesh = {"terrain", {}, {}};
+    for (uint32_t z = 0; z <= size; z++)
+        for (uint32_t x = 0; x <= size; x++)
+        {
+            float u = static_cast<float>(x) / size * 2.0f - 1.0f, v = static_cast<float>(z) / size * 2.0f - 1.0f;
+            float height = 0.08f * std::sin(u * 9.0f) * std::cos(v * 7.0f) + 0.03f * std::sin((u + v) * 23.0f);
+            mesh.m_positions.insert(mesh.m_positions.end(), {u, height, v});
+        }
+    for (uint32_t z = 0; z < size; z++)
+        for (uint32_t x = 0; x < size; x++)
+        {
+            uint32_t a = z * (size + 1) + x, b = a + size + 1;
+            mesh.m_indices.insert(mesh.m_indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    vl::MeshUtils::optimize_vertex_cache(mesh.m_indices, mesh.m_positions.size() / 3);
+    return mesh;
+}
+
+/// @brief 三角形的未归一化法线和第一个顶点
+inline void get_meshlet_triangle(const MeshletMesh &mesh, const uint32_t *triangle, float normal[3], const float *&corner)
+{
+    const float *a = &mesh.m_positions[triangle[0] * 3], *b = &mesh.m_positions[triangle[1] * 3], *c = &mesh.m_positions[triangle[2] * 3];
+    float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    corner = a;
+}
+
+/// @brief 围绕网格的随机视角，深度范围为[0, 1]
+void make_meshlet_view(uint32_t &state, const float center[3], float radius, float eye[3], float view_projection[16])
+{
+    auto next = [&state]()
+    {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.0f;
+    };
+
+    float z = next() * 2.0f - 1.0f, phi = next() * 6.2831853f;
+    float distance = radius * (1.5f + next() * 2.5f);
+    float ring = std::sqrt(1.0f - z * z);
+    vec3 position = {center[0] + ring * std::cos(phi) * distance, center[1] + z * distance, center[2] + ring * std::sin(phi) * distance};
+    vec3 target = {center[0] + (next() - 0.5f) * radius, center[1] + (next() - 0.5f) * radius, center[2] + (next() - 0.5f) * radius};
+    vec3 up = {0.0f, 1.0f, 0.0f};
+    if (std::abs(z) > 0.99f)
+        up[1] = 0.0f, up[0] = 1.0f;
+
+    mat4x4 projection, view, result;
+    mat4x4_perspective(projection, 1.0f, 16.0f / 9.0f, radius * 0.01f, radius * 10.0f);
+    for (int c = 0; c < 4; c++)
+        projection[c][2] = 0.5f * projection[c][2] + 0.5f * projection[c][3];
+    mat4x4_look_at(view, position, target, up);
+    mat4x4_mul(result, projection, view);
+    std::memcpy(view_projection, &result[0][0], sizeof(float) * 16);
+    std::copy(position, position + 3, eye);
+}
+
+/// @brief CPU参考实现，逻辑与cluster.comp相同
+class ReferenceClusterCuller
+{
+public:
+    enum class Visibility
+    {
+        eVisible,
+        eCulled,
+        /// @brief 处于边界上，浮点误差可能使GPU得到任一结果
+        eBorderline,
+    };
+
+    static constexpr float PLANE_EPSILON = 1e-4f;
+    static constexpr float CONE_EPSILON = 1e-4f;
+
+public:
+    static Visibility test(
+        const vl::ClusterCuller::Cluster &cluster,
+        const float model[16],
+        const float planes[vl::FrustumUtils::PLANE_COUNT * 4],
+        const float camera[3])
+    {
+        const vl::MeshletUtils::Bounds &bounds = cluster.m_bounds;
+        auto transform = [&](const float *point, float w, float out[3])
+        {
+            for (int r = 0; r < 3; r++)
+                out[r] = model[r] * point[0] + model[4 + r] * point[1] + model[8 + r] * point[2] + model[12 + r] * w;
+        };
+
+        float center[3];
+        transform(bounds.m_center, 1.0f, center);
+        float scale = 0.0f;
+        for (int c = 0; c < 3; c++)
+            scale = std::max(scale, std::sqrt(model[c * 4] * model[c * 4] + model[c * 4 + 1] * model[c * 4 + 1] + model[c * 4 + 2] * model[c * 4 + 2]));
+        float radius = bounds.m_radius * scale;
+
+        bool is_borderline = false;
+        for (uint32_t i = 0; i < vl::FrustumUtils::PLANE_COUNT; i++)
+        {
+            const float *plane = planes + i * 4;
+            float distance = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3] + radius;
+            if (distance < -PLANE_EPSILON * scale)
+                return Visibility::eCulled;
+            if (distance <= PLANE_EPSILON * scale)
+                is_borderline = true;
+        }
+
+        if (bounds.m_cone_cutoff < 1.0f)
+        {
+            float apex[3], axis[3];
+            transform(bounds.m_cone_apex, 1.0f, apex);
+            transform(bounds.m_cone_axis, 0.0f, axis);
+            float axis_length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+            float direction[3] = {apex[0] - camera[0], apex[1] - camera[1], apex[2] - camera[2]};
+            float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+            float margin = (direction[0] * axis[0] + direction[1] * axis[1] + direction[2] * axis[2]) / axis_length -
+                           bounds.m_cone_cutoff * length;
+            if (std::abs(margin) <= CONE_EPSILON * length)
+                is_borderline = true;
+            else if (margin > 0.0f)
+                return Visibility::eCulled;
+        }
+
+        return is_borderline ? Visibility::eBorderline : Visibility::eVisible;
+    }
+};
+
+/// @brief 无窗口的簇剔除验证环境
+class ClusterValidator
+{
+protected:
+    vl::HeadlessContext &m_context;
+    vk::Device m_device;
+    vl::ClusterCuller m_culler;
+    vl::MappedBuffer m_readback;
+
+public:
+    ClusterValidator(vl::HeadlessContext &context) : m_context(context), m_device(context.m_device) {}
+    ~ClusterValidator()
+    {
+        m_culler.destroy();
+        m_readback.destroy(m_device);
+    }
+
+public:
+    bool create(uint32_t max_clusters, uint32_t max_instances)
+    {
+        static const uint32_t code[] = {
+#include "shaders/cluster.comp.inc"
+        };
+
+        vl::ClusterCuller::Config config;
+        config.m_max_clusters = max_clusters;
+        config.m_max_instances = max_instances;
+        config.m_code = code;
+        config.m_code_size = sizeof(code);
+        config.m_is_draw_indirect_count_enabled = m_context.is_extension_enabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        config.m_is_multi_draw_indirect_enabled = m_context.m_features.multiDrawIndirect == VK_TRUE;
+        if (m_culler.create(m_device, m_context.m_physical_device, m_context.m_queue_family_indices, config) != vk::Result::eSuccess)
+            return false;
+
+        return m_readback.create(
+                   m_device,
+                   m_context.m_physical_device,
+                   sizeof(VkDrawIndexedIndirectCommand) * m_culler.get_max_draw_count() + sizeof(uint32_t),
+                   vk::BufferUsageFlagBits::eTransferDst,
+                   vk::MemoryPropertyFlagBits::eHostCached) == vk::Result::eSuccess;
+    }
+
+    vl::ClusterCuller &get_culler() { return m_culler; }
+
+    /// @brief 在计算队列上剔除并读回结果
+    bool cull(const float view_projection[16], const float camera[3], uint32_t cluster_count, uint32_t instance_count, double &milliseconds)
+    {
+        if (m_culler.m_cluster_buffer.flush(m_device) != vk::Result::eSuccess ||
+            m_culler.m_instance_buffer.flush(m_device) != vk::Result::eSuccess)
+            return false;
+
+        bench::Stopwatch stopwatch;
+        auto command_result = m_context.begin_one_time(true);
+        if (command_result.result != vk::Result::eSuccess)
+            return false;
+        vk::CommandBuffer cmd = command_result.value;
+
+        m_culler.record_cull(cmd, view_projection, camera, cluster_count, instance_count, true);
+
+        vk::DeviceSize draw_size = sizeof(VkDrawIndexedIndirectCommand) * static_cast<vk::DeviceSize>(cluster_count) * instance_count;
+        if (draw_size > 0)
+            cmd.copyBuffer(m_culler.m_draw_buffer, m_readback.m_buffer, vk::BufferCopy(0, 0, draw_size));
+        cmd.copyBuffer(m_culler.m_count_buffer, m_readback.m_buffer, vk::BufferCopy(0, m_readback.m_size - sizeof(uint32_t), sizeof(uint32_t)));
+
+        vk::MemoryBarrier barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), barrier, nullptr, nullptr);
+
+        if (m_context.end_one_time(cmd, true) != vk::Result::eSuccess)
+            return false;
+        milliseconds = stopwatch.milliseconds();
+        return m_readback.invalidate(m_device) == vk::Result::eSuccess;
+    }
+
+    uint32_t get_draw_count() const
+    {
+        uint32_t count;
+        std::memcpy(&count, static_cast<const uint8_t *>(m_readback.m_mapped) + m_readback.m_size - sizeof(uint32_t), sizeof(count));
+        return count;
+    }
+
+    const VkDrawIndexedIndirectCommand *get_draws() const
+    {
+        return m_readback.data<VkDrawIndexedIndirectCommand>();
+    }
+};
+
+/// @brief 在GPU上剔除多个实例的簇，与CPU参考实现比较；无法创建Vulkan环境时跳过
+bool validate_cluster_culler(
+    int argc,
+    char **argv,
+    const std::vector<vl::MeshletUtils::Meshlet> &meshlets,
+    const std::vector<vl::MeshletUtils::Bounds> &bounds,
+    uint32_t view_count)
+{
+    vl::HeadlessContext::Config config;
+    config.m_name = "cluster culling";
+    config.m_device_name = bench::get_option(argc, argv, "--device", std::string());
+    config.m_features.setMultiDrawIndirect(VK_TRUE);
+    config.m_device_extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    if (bench::has_flag(argc, argv, "--validation"))
+        config.m_validation_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+    vl::HeadlessContext context;
+    if (context.create(config) != vk::Result::eSuccess)
+    {
+        std::cout << "meshlet gpu: skipped, unable to create headless vulkan context" << std::endl;
+        return true;
+    }
+
+    // 四个实例：平移、绕y轴旋转、缩小一半、放大并平移
+    const uint32_t instance_count = 4;
+    mat4x4 models[instance_count];
+    mat4x4 identity;
+    mat4x4_identity(identity);
+    mat4x4_translate(models[0], -1.5f, 0.0f, 0.0f);
+    mat4x4_rotate_Y(models[1], identity, 1.1f);
+    models[1][3][0] = 1.5f;
+    mat4x4_identity(models[2]);
+    mat4x4_scale_aniso(models[2], models[2], 0.5f, 0.5f, 0.5f);
+    models[2][3][2] = -1.5f;
+    mat4x4_identity(models[3]);
+    mat4x4_scale_aniso(models[3], models[3], 1.25f, 1.25f, 1.25f);
+    models[3][3][1] = 2.0f;
+
+    uint32_t cluster_count = static_cast<uint32_t>(meshlets.size());
+    bool is_passed = true;
+    {
+        ClusterValidator validator(context);
+        if (!validator.create(cluster_count, instance_count))
+        {
+            std::cout << "unable to create cluster culler" << std::endl;
+            context.destroy();
+            return false;
+        }
+
+        vl::ClusterCuller &culler = validator.get_culler();
+        culler.set_clusters(meshlets, bounds);
+        for (uint32_t i = 0; i < instance_count; i++)
+            std::memcpy(culler.get_instances()[i].m_model, &models[i][0][0], sizeof(float) * 16);
+
+        // 由firstIndex找回簇
+        std::vector<uint32_t> cluster_of_index(meshlets.empty() ? 0 : (meshlets.back().m_triangle_offset + meshlets.back().m_triangle_count) * 3, UINT32_MAX);
+        for (uint32_t i = 0; i < cluster_count; i++)
+            cluster_of_index[meshlets[i].m_triangle_offset * 3] = i;
+
+        std::cout << "meshlet gpu: " << context.get_device_name() << ", " << cluster_count << " clusters x " << instance_count << " instances" << std::endl
+                  << "   view   visible  borderline  mismatches  gpu ms" << std::endl;
+
+        const float center[3] = {0.0f, 0.5f, -0.5f};
+        uint32_t state = 12345;
+        uint32_t total_mismatches = 0;
+        for (uint32_t view = 0; view < view_count; view++)
+        {
+            float eye[3], view_projection[16], planes[vl::FrustumUtils::PLANE_COUNT * 4];
+            make_meshlet_view(state, center, 2.5f, eye, view_projection);
+            vl::FrustumUtils::extract_planes(view_projection, planes);
+
+            double gpu_ms = 0.0;
+            if (!validator.cull(view_projection, eye, cluster_count, instance_count, gpu_ms))
+            {
+                std::cout << "culling failed" << std::endl;
+                is_passed = false;
+                break;
+            }
+
+            // 输出顺序由原子操作决定，按(实例, 簇)比较集合
+            uint32_t draw_count = validator.get_draw_count();
+            const VkDrawIndexedIndirectCommand *draws = validator.get_draws();
+            std::vector<bool> is_drawn(static_cast<size_t>(cluster_count) * instance_count, false);
+            uint32_t mismatches = 0, borderline = 0;
+            for (uint32_t i = 0; i < std::min(draw_count, cluster_count * instance_count); i++)
+            {
+                const VkDrawIndexedIndirectCommand &draw = draws[i];
+                uint32_t cluster = draw.firstIndex < cluster_of_index.size() ? cluster_of_index[draw.firstIndex] : UINT32_MAX;
+                if (cluster == UINT32_MAX || draw.firstInstance >= instance_count ||
+                    is_drawn[draw.firstInstance * cluster_count + cluster] ||
+                    draw.indexCount != meshlets[cluster].m_triangle_count * 3 || draw.instanceCount != 1 || draw.vertexOffset != 0)
+                {
+                    mismatches++;
+                    continue;
+                }
+                is_drawn[draw.firstInstance * cluster_count + cluster] = true;
+            }
+            if (draw_count > cluster_count * instance_count)
+                mismatches += draw_count - cluster_count * instance_count;
+
+            for (uint32_t instance = 0; instance < instance_count; instance++)
+                for (uint32_t cluster = 0; cluster < cluster_count; cluster++)
+                {
+                    ReferenceClusterCuller::Visibility expected = ReferenceClusterCuller::test(
+                        culler.get_clusters()[cluster], &models[instance][0][0], planes, eye);
+                    if (expected == ReferenceClusterCuller::Visibility::eBorderline)
+                        borderline++;
+                    else if (is_drawn[instance * cluster_count + cluster] != (expected == ReferenceClusterCuller::Visibility::eVisible))
+                        mismatches++;
+                }
+            total_mismatches += mismatches;
+
+            std::cout << std::fixed << std::setprecision(3)
+                      << std::setw(7) << view
+                      << std::setw(10) << draw_count
+                      << std::setw(12) << borderline
+                      << std::setw(12) << mismatches
+                      << std::setw(8) << gpu_ms
+                      << std::defaultfloat << std::endl;
+        }
+        is_passed &= total_mismatches == 0;
+        std::cout << (is_passed ? "  gpu results match the cpu reference" : "  MISMATCH") << std::endl;
+    }
+
+    context.destroy();
+    return is_passed;
+}
+
+/// @brief 簇基准：生成时间、簇的填充率和有效性、视锥体和法线锥剔除的效率，以及GPU剔除与CPU参考实现的比较
+int run_meshlet_bench(int argc, char **argv)
+{
+    uint32_t rings = static_cast<uint32_t>(bench::get_option(argc, argv, "--rings", 256LL));
+    uint32_t segments = static_cast<uint32_t>(bench::get_option(argc, argv, "--segments", 512LL));
+    uint32_t terrain_size = static_cast<uint32_t>(bench::get_option(argc, argv, "--terrain", 512LL));
+    uint32_t view_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--views", 64LL));
+
+    std::vector<MeshletMesh> meshes;
+    meshes.push_back(make_meshlet_sphere(rings, segments));
+    meshes.push_back(make_meshlet_terrain(terrain_size));
+
+    struct Limits
+    {
+        uint32_t m_max_vertices;
+        uint32_t m_max_triangles;
+        float m_cone_weight;
+    };
+    const Limits limits[] = {{64, 124, 0.0f}, {64, 124, 0.5f}, {128, 256, 0.25f}};
+
+    std::cout << "meshlet build: fill is the average triangle count over the limit" << std::endl
+              << "      mesh   limits  cone w  triangles  meshlets  build ms  Mtri/s  avg verts  avg tris   fill  cones  valid" << std::endl;
+
+    bool is_passed = true;
+    struct Built
+    {
+        std::vector<vl::MeshletUtils::Meshlet> m_meshlets;
+        std::vector<uint32_t> m_vertices;
+        std::vector<uint8_t> m_triangles;
+        std::vector<vl::MeshletUtils::Bounds> m_bounds;
+    };
+    std::vector<Built> defaults(meshes.size());
+
+    for (size_t m = 0; m < meshes.size(); m++)
+    {
+        const MeshletMesh &mesh = meshes[m];
+        const size_t vertex_count = mesh.m_positions.size() / 3;
+        std::vector<std::array<uint32_t, 3>> expected(mesh.m_indices.size() / 3);
+        for (size_t t = 0; t < expected.size(); t++)
+            expected[t] = {mesh.m_indices[t * 3], mesh.m_indices[t * 3 + 1], mesh.m_indices[t * 3 + 2]};
+        std::sort(expected.begin(), expected.end());
+
+        for (const Limits &limit : limits)
+        {
+            Built built;
+            bench::Stopwatch stopwatch;
+            vl::MeshletUtils::build(
+                mesh.m_indices.data(),
+                mesh.m_indices.size(),
+                mesh.m_positions.data(),
+                sizeof(float) * 3,
+                vertex_count,
+                built.m_meshlets,
+                built.m_vertices,
+                built.m_triangles,
+                limit.m_max_vertices,
+                limit.m_max_triangles,
+                limit.m_cone_weight);
+            for (const vl::MeshletUtils::Meshlet &meshlet : built.m_meshlets)
+                built.m_bounds.push_back(vl::MeshletUtils::compute_bounds(
+                    meshlet, built.m_vertices.data(), built.m_triangles.data(), mesh.m_positions.data(), sizeof(float) * 3));
+            double build_ms = stopwatch.milliseconds();
+
+            // 三角形集合不变，簇不超过上限，局部索引有效，包围球包含所有顶点，三角形法线在法线锥内
+            std::vector<uint32_t> unpacked;
+            vl::MeshletUtils::unpack_indices(built.m_meshlets, built.m_vertices, built.m_triangles, unpacked);
+            std::vector<std::array<uint32_t, 3>> actual(unpacked.size() / 3);
+            for (size_t t = 0; t < actual.size(); t++)
+                actual[t] = {unpacked[t * 3], unpacked[t * 3 + 1], unpacked[t * 3 + 2]};
+            std::sort(actual.begin(), actual.end());
+            bool is_valid = actual == expected && !built.m_meshlets.empty();
+
+            size_t cone_count = 0;
+            double vertex_sum = 0.0, triangle_sum = 0.0;
+            for (size_t i = 0; i < built.m_meshlets.size() && is_valid; i++)
+            {
+                const vl::MeshletUtils::Meshlet &meshlet = built.m_meshlets[i];
+                const vl::MeshletUtils::Bounds &bound = built.m_bounds[i];
+                vertex_sum += meshlet.m_vertex_count;
+                triangle_sum += meshlet.m_triangle_count;
+                is_valid &= meshlet.m_vertex_count <= limit.m_max_vertices && meshlet.m_triangle_count <= limit.m_max_triangles;
+                for (uint32_t k = 0; k < meshlet.m_triangle_count * 3; k++)
+                    is_valid &= built.m_triangles[meshlet.m_triangle_offset * 3 + k] < meshlet.m_vertex_count;
+                for (uint32_t k = 0; k < meshlet.m_vertex_count; k++)
+                {
+                    const float *p = &mesh.m_positions[built.m_vertices[meshlet.m_vertex_offset + k] * 3];
+                    float dx = p[0] - bound.m_center[0], dy = p[1] - bound.m_center[1], dz = p[2] - bound.m_center[2];
+                    is_valid &= std::sqrt(dx * dx + dy * dy + dz * dz) <= bound.m_radius * 1.0001f + 1e-6f;
+                }
+                if (bound.m_cone_cutoff < 1.0f)
+                {
+                    cone_count++;
+                    float min_dot = std::sqrt(1.0f - bound.m_cone_cutoff * bound.m_cone_cutoff);
+                    for (uint32_t t = 0; t < meshlet.m_triangle_count; t++)
+                    {
+                        float normal[3];
+                        const float *corner;
+                        get_meshlet_triangle(mesh, &unpacked[(meshlet.m_triangle_offset + t) * 3], normal, corner);
+                        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                        if (length > 0.0f)
+                            is_valid &= (normal[0] * bound.m_cone_axis[0] + normal[1] * bound.m_cone_axis[1] + normal[2] * bound.m_cone_axis[2]) / length >= min_dot - 1e-4f;
+                    }
+                }
+            }
+            is_passed &= is_valid;
+
+            size_t meshlet_count = std::max<size_t>(built.m_meshlets.size(), 1);
+            std::cout << std::fixed << std::setprecision(2)
+                      << std::setw(10) << mesh.m_name
+                      << std::setw(5) << limit.m_max_vertices << "/" << std::setw(3) << limit.m_max_triangles
+                      << std::setw(8) << limit.m_cone_weight
+                      << std::setw(11) << expected.size()
+                      << std::setw(10) << built.m_meshlets.size()
+                      << std::setw(10) << build_ms
+                      << std::setw(8) << expected.size() / build_ms / 1000.0
+                      << std::setw(11) << vertex_sum / meshlet_count
+                      << std::setw(10) << triangle_sum / meshlet_count
+                      << std::setw(6) << std::setprecision(0) << triangle_sum / meshlet_count / limit.m_max_triangles * 100.0 << "%"
+                      << std::setw(6) << cone_count * 100.0 / meshlet_count << "%"
+                      << std::setw(7) << (is_valid ? "yes" : "NO")
+                      << std::defaultfloat << std::endl;
+
+            if (&limit == &limits[1])
+                defaults[m] = std::move(built);
+        }
+    }
+
+    // 剔除效率：随机视角下被视锥体和法线锥剔除的簇，以及剔除掉的背面三角形占全部背面三角形的比例
+    std::cout << "meshlet culling: " << view_count << " random views, 64/124 meshlets with cone weight 0.5" << std::endl
+              << "      mesh  frustum culled  cone culled  triangles drawn  back-facing  back-facing removed  cone errors  cpu us/view" << std::endl;
+    for (size_t m = 0; m < meshes.size(); m++)
+    {
+        const MeshletMesh &mesh = meshes[m];
+        const Built &built = defaults[m];
+        std::vector<uint32_t> unpacked;
+        vl::MeshletUtils::unpack_indices(built.m_meshlets, built.m_vertices, built.m_triangles, unpacked);
+
+        std::vector<vl::ClusterCuller::Cluster> clusters(built.m_meshlets.size());
+        for (size_t i = 0; i < clusters.size(); i++)
+            clusters[i].m_bounds = built.m_bounds[i];
+
+        float lower[3] = {INFINITY, INFINITY, INFINITY}, upper[3] = {-INFINITY, -INFINITY, -INFINITY};
+        for (size_t v = 0; v < mesh.m_positions.size(); v++)
+        {
+            lower[v % 3] = std::min(lower[v % 3], mesh.m_positions[v]);
+            upper[v % 3] = std::max(upper[v % 3], mesh.m_positions[v]);
+        }
+        float center[3], radius = 0.0f;
+        for (int k = 0; k < 3; k++)
+        {
+            center[k] = (lower[k] + upper[k]) * 0.5f;
+            radius += (upper[k] - lower[k]) * (upper[k] - lower[k]) * 0.25f;
+        }
+        radius = std::sqrt(radius);
+
+        uint32_t state = 777;
+        double frustum_culled = 0.0, cone_culled = 0.0, drawn = 0.0, back_facing = 0.0, removed = 0.0, cpu_us = 0.0;
+        size_t cone_errors = 0;
+        const double triangle_count = static_cast<double>(unpacked.size() / 3);
+        for (uint32_t view = 0; view < view_count; view++)
+        {
+            float eye[3], view_projection[16], planes[vl::FrustumUtils::PLANE_COUNT * 4];
+            make_meshlet_view(state, center, radius, eye, view_projection);
+            vl::FrustumUtils::extract_planes(view_projection, planes);
+
+            bench::Stopwatch stopwatch;
+            std::vector<uint8_t> state_of(clusters.size());
+            for (size_t i = 0; i < clusters.size(); i++)
+            {
+                const vl::MeshletUtils::Bounds &bound = clusters[i].m_bounds;
+                if (!vl::FrustumUtils::is_sphere_visible(planes, bound.m_center, bound.m_radius))
+                    state_of[i] = 1;
+                else if (vl::MeshletUtils::is_cone_culled(bound, eye))
+                    state_of[i] = 2;
+            }
+            cpu_us += stopwatch.milliseconds() * 1000.0;
+
+            for (size_t i = 0; i < clusters.size(); i++)
+            {
+                const vl::MeshletUtils::Meshlet &meshlet = built.m_meshlets[i];
+                frustum_culled += state_of[i] == 1;
+                cone_culled += state_of[i] == 2;
+                if (state_of[i] == 0)
+                    drawn += meshlet.m_triangle_count;
+
+                for (uint32_t t = 0; t < meshlet.m_triangle_count; t++)
+                {
+                    float normal[3];
+                    const float *corner;
+                    get_meshlet_triangle(mesh, &unpacked[(meshlet.m_triangle_offset + t) * 3], normal, corner);
+                    float facing = (corner[0] - eye[0]) * normal[0] + (corner[1] - eye[1]) * normal[1] + (corner[2] - eye[2]) * normal[2];
+                    float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                    if (facing >= 0.0f)
+                        back_facing++;
+                    if (state_of[i] == 2)
+                    {
+                        // 被法线锥剔除的簇中不能有朝向相机的三角形
+                        if (facing >= 0.0f)
+                            removed++;
+                        else if (facing < -1e-5f * length * radius)
+                            cone_errors++;
+                    }
+                }
+            }
+        }
+        is_passed &= cone_errors == 0;
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(10) << mesh.m_name
+                  << std::setw(15) << frustum_culled * 100.0 / (clusters.size() * view_count) << "%"
+                  << std::setw(12) << cone_culled * 100.0 / (clusters.size() * view_count) << "%"
+                  << std::setw(16) << drawn * 100.0 / (triangle_count * view_count) << "%"
+                  << std::setw(12) << back_facing * 100.0 / (triangle_count * view_count) << "%"
+                  << std::setw(20) << (back_facing > 0.0 ? removed * 100.0 / back_facing : 0.0) << "%"
+                  << std::setw(13) << cone_errors
+                  << std::setw(13) << cpu_us / view_count
+                  << std::defaultfloat << std::endl;
+    }
+
+    if (!bench::has_flag(argc, argv, "--cpu-only"))
+        is_passed &= validate_cluster_culler(argc, argv, defaults[0].m_meshlets, defaults[0].m_bounds, std::min<uint32_t>(view_count, 16));
+
+    std::cout << (is_passed ? "  all meshlet checks passed" : "  MISMATCH") << std::endl;
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,432 @@
+#ifndef MIPBENCH_CPP
+#define MIPBENCH_CPP
+
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+#include "Bench.hpp"
+#include "EncoderBench.cpp"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/PhysicalDeviceUtils.hpp"
+#include "../src/PhysicalDeviceUtils.cpp"
+#include "../src/DefaultQueueFamilyIndices.hpp"
+#include "../src/DefaultQueueFamilyIndices.cpp"
+#include "../src/HeadlessContext.hpp"
+#include "../src/HeadlessContext.cpp"
+#include "../src/MappedBuffer.hpp"
+#include "../src/MappedBuffer.cpp"
+#include "../src/MipGenerator.hpp"
+#include "../src/MipGenerator.cpp"
+
+/// @brief 一个测试尺寸
+struct MipCase
+{
+    uint32_t m_width;
+    uint32_t m_height;
+};
+
+/// @brief 逐级与参考结果比较，返回最大的通道误差
+uint32_t compare_mip_levels(
+    const std::vector<std::vector<uint8_t>> &expected,
+    const uint8_t *actual)
+{
+    uint32_t max_error = 0;
+    for (const std::vector<uint8_t> &level : expected)
+    {
+        for (size_t i = 0; i < level.size(); i++)
+            max_error = std::max<uint32_t>(max_error, static_cast<uint32_t>(std::abs(level[i] - actual[i])));
+        actual += level.size();
+    }
+    return max_error;
+}
+
+/// @brief 无窗口的mip生成验证环境
+class MipValidator
+{
+public:
+    /// @brief 一次生成的结果
+    struct Result
+    {
+        std::vector<double> m_gpu_ms;
+        uint32_t m_max_error = 0;
+    };
+
+protected:
+    vl::HeadlessContext &m_context;
+    vk::Device m_device;
+    vl::MipGenerator m_generator;
+    bool m_has_compute = false;
+
+    vk::Image m_image;
+    vk::DeviceMemory m_memory;
+    vl::MappedBuffer m_staging;
+    vl::MappedBuffer m_readback;
+    vk::QueryPool m_query_pool;
+    bool m_has_timestamps = false;
+
+    /// @brief 时间戳的有效位
+    uint64_t m_timestamp_mask = 0;
+
+public:
+    MipValidator(vl::HeadlessContext &context) : m_context(context), m_device(context.m_device) {}
+    ~MipValidator()
+    {
+        m_generator.destroy();
+        destroy_image();
+        if (m_query_pool)
+            m_device.destroyQueryPool(m_query_pool);
+    }
+
+public:
+    bool create()
+    {
+        static const uint32_t code[] = {
+#include "shaders/mip.comp.inc"
+        };
+
+        // 不支持存储图像时只验证blit
+        if (vl::MipGenerator::is_compute_supported(m_context.m_physical_device, 1, 1))
+        {
+            vl::MipGenerator::Config config;
+            config.m_code = code;
+            config.m_code_size = sizeof(code);
+            config.m_max_images = 1;
+            if (m_generator.create(m_device, m_context.m_physical_device, config) != vk::Result::eSuccess)
+                return false;
+            m_has_compute = true;
+        }
+
+        uint32_t family = *m_context.m_queue_family_indices.m_graphics_family;
+        auto families = vl::PhysicalDeviceUtils::get_physical_device_queue_family_properties(m_context.m_physical_device);
+        uint32_t valid_bits = families.at(family).timestampValidBits;
+        m_has_timestamps = valid_bits != 0 && m_context.m_properties.limits.timestampPeriod > 0.0f;
+        m_timestamp_mask = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+        if (m_has_timestamps)
+        {
+            vk::QueryPoolCreateInfo query_info;
+            query_info.setQueryType(vk::QueryType::eTimestamp);
+            query_info.setQueryCount(2);
+            auto query_result = m_device.createQueryPool(query_info);
+            if (query_result.result != vk::Result::eSuccess)
+                return false;
+            m_query_pool = query_result.value;
+        }
+        return true;
+    }
+
+    bool has_compute() const { return m_has_compute; }
+    bool has_timestamps() const { return m_has_timestamps; }
+
+    /// @brief 上传第0级，用计算或blit生成其余各级并读回，重复多次
+    bool generate(
+        const std::vector<uint8_t> &pixels,
+        uint32_t width,
+        uint32_t height,
+        const std::vector<std::vector<uint8_t>> &expected,
+        bool is_compute,
+        int repeat,
+        Result &result)
+    {
+        uint32_t level_count = vl::MipGenerator::get_level_count(width, height);
+        if (!create_image(width, height, level_count))
+            return false;
+        std::memcpy(m_staging.m_mapped, pixels.data(), pixels.size());
+        if (m_staging.flush(m_device) != vk::Result::eSuccess)
+            return false;
+
+        m_generator.clear_images();
+        uint32_t index = 0;
+        if (is_compute && m_generator.add_image(m_image, width, height, level_count, index) != vk::Result::eSuccess)
+            return false;
+
+        for (int r = 0; r < repeat; r++)
+        {
+            auto command_result = m_context.begin_one_time(false);
+            if (command_result.result != vk::Result::eSuccess)
+                return false;
+            vk::CommandBuffer cmd = command_result.value;
+
+            vk::ImageMemoryBarrier barrier;
+            barrier.setSrcAccessMask(vk::AccessFlags());
+            barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+            barrier.setOldLayout(vk::ImageLayout::eUndefined);
+            barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+            barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+            barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+            barrier.setImage(m_image);
+            barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, nullptr, barrier);
+            vk::BufferImageCopy copy;
+            copy.setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1));
+            copy.setImageExtent(vk::Extent3D(width, height, 1));
+            cmd.copyBufferToImage(m_staging.m_buffer, m_image, vk::ImageLayout::eTransferDstOptimal, copy);
+
+            // 两个时间戳之间只有mip生成
+            if (m_has_timestamps)
+            {
+                cmd.resetQueryPool(m_query_pool, 0, 2);
+                cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_query_pool, 0);
+            }
+            if (is_compute)
+                m_generator.record(cmd, index);
+            else
+                vl::MipGenerator::record_blit(cmd, m_image, width, height, level_count);
+            if (m_has_timestamps)
+                cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_query_pool, 1);
+
+            // 读回第1级开始的各级，紧密排列
+            barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderRead);
+            barrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+            barrier.setOldLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+            barrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
+            barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, level_count, 0, 1));
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, nullptr, barrier);
+            std::vector<vk::BufferImageCopy> copies;
+            vk::DeviceSize offset = 0;
+            for (uint32_t level = 1; level < level_count; level++)
+            {
+                copy.setBufferOffset(offset);
+                copy.setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level, 0, 1));
+                copy.setImageExtent(vk::Extent3D(std::max(width >> level, 1u), std::max(height >> level, 1u), 1));
+                copies.push_back(copy);
+                offset += expected.at(level - 1).size();
+            }
+            if (!copies.empty())
+                cmd.copyImageToBuffer(m_image, vk::ImageLayout::eTransferSrcOptimal, m_readback.m_buffer, copies);
+            vk::MemoryBarrier host_barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), host_barrier, nullptr, nullptr);
+
+            if (m_context.end_one_time(cmd, false) != vk::Result::eSuccess ||
+                m_readback.invalidate(m_device) != vk::Result::eSuccess)
+                return false;
+
+            if (m_has_timestamps)
+            {
+                uint64_t timestamps[2];
+                VkResult query_result = vkGetQueryPoolResults(
+                    static_cast<VkDevice>(m_device),
+                    static_cast<VkQueryPool>(m_query_pool),
+                    0,
+                    2,
+                    sizeof(timestamps),
+                    timestamps,
+                    sizeof(uint64_t),
+                    VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+                if (query_result == VK_SUCCESS)
+                    result.m_gpu_ms.push_back(((timestamps[1] - timestamps[0]) & m_timestamp_mask) * m_context.m_properties.limits.timestampPeriod * 1e-6);
+            }
+
+            // 每次都检查，计数器没有正确清零时第二次起会出错
+            result.m_max_error = std::max(result.m_max_error, compare_mip_levels(expected, m_readback.data<uint8_t>()));
+        }
+        return true;
+    }
+
+protected:
+    bool create_image(uint32_t width, uint32_t height, uint32_t level_count)
+    {
+        m_generator.clear_images();
+        destroy_image();
+
+        vk::ImageCreateInfo image_info;
+        image_info.setImageType(vk::ImageType::e2D);
+        image_info.setFormat(vl::MipGenerator::FORMAT);
+        image_info.setExtent(vk::Extent3D(width, height, 1));
+        image_info.setMipLevels(level_count);
+        image_info.setArrayLayers(1);
+        image_info.setSamples(vk::SampleCountFlagBits::e1);
+        image_info.setTiling(vk::ImageTiling::eOptimal);
+        vk::ImageUsageFlags usage =
+            vk::ImageUsageFlagBits::eSampled |
+            vk::ImageUsageFlagBits::eTransferSrc |
+            vk::ImageUsageFlagBits::eTransferDst;
+        if (m_has_compute)
+            usage |= vk::ImageUsageFlagBits::eStorage;
+        image_info.setUsage(usage);
+        image_info.setSharingMode(vk::SharingMode::eExclusive);
+        image_info.setInitialLayout(vk::ImageLayout::eUndefined);
+        auto image_result = m_device.createImage(image_info);
+        if (image_result.result != vk::Result::eSuccess)
+            return false;
+        m_image = image_result.value;
+
+        auto memory_result = vl::DeviceUtils::allocate_image_memory(
+            m_device,
+            m_context.m_physical_device,
+            m_image,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::MemoryPropertyFlags());
+        if (memory_result.result != vk::Result::eSuccess)
+            return false;
+        m_memory = memory_result.value;
+
+        vk::DeviceSize size = static_cast<vk::DeviceSize>(width) * height * 4;
+        return m_staging.create(m_device, m_context.m_physical_device, size, vk::BufferUsageFlagBits::eTransferSrc) == vk::Result::eSuccess &&
+               m_readback.create(m_device, m_context.m_physical_device, size, vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eHostCached) == vk::Result::eSuccess;
+    }
+
+    void destroy_image()
+    {
+        if (m_image)
+            m_device.destroyImage(m_image);
+        if (m_memory)
+            m_device.freeMemory(m_memory);
+        m_image = nullptr;
+        m_memory = nullptr;
+        m_staging.destroy(m_device);
+        m_readback.destroy(m_device);
+    }
+};
+
+/// @brief 在GPU上用计算和blit生成mip链，与CPU参考实现比较；无法创建Vulkan环境时跳过
+bool validate_mip_generator(int argc, char **argv, const std::vector<MipCase> &cases, int repeat)
+{
+    vl::HeadlessContext::Config config;
+    config.m_name = "mip generation";
+    config.m_device_name = bench::get_option(argc, argv, "--device", std::string());
+    if (bench::has_flag(argc, argv, "--validation"))
+        config.m_validation_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+    vl::HeadlessContext context;
+    if (context.create(config) != vk::Result::eSuccess)
+    {
+        std::cout << "mip gpu: skipped, unable to create headless vulkan context" << std::endl;
+        return true;
+    }
+
+    bool is_passed = true;
+    {
+        MipValidator validator(context);
+        if (!validator.create())
+        {
+            std::cout << "unable to create mip generator" << std::endl;
+            context.destroy();
+            return false;
+        }
+        bool is_blit_supported = vl::MipGenerator::is_blit_supported(context.m_physical_device, vl::MipGenerator::FORMAT);
+
+        // 计算路径要求逐位一致；blit由硬件线性过滤，2的幂尺寸允许舍入误差，非2的幂时采样位置不同，只作参考
+        std::cout << "mip gpu: " << context.get_device_name() << ", median of " << repeat << " runs"
+                  << (validator.has_timestamps() ? "" : ", no timestamps") << std::endl
+                  << "        size  levels    path   gpu ms  ms/level  max error  result" << std::endl;
+        for (const MipCase &item : cases)
+        {
+            std::vector<uint8_t> pixels = make_encoder_frame(item.m_width, item.m_height, item.m_width ^ item.m_height);
+            uint32_t level_count = vl::MipGenerator::get_level_count(item.m_width, item.m_height);
+            std::vector<std::vector<uint8_t>> expected;
+            vl::MipGenerator::generate(pixels.data(), item.m_width, item.m_height, level_count, expected);
+            bool is_pot = (item.m_width & (item.m_width - 1)) == 0 && (item.m_height & (item.m_height - 1)) == 0;
+
+            for (int path = 0; path < 2; path++)
+            {
+                bool is_compute = path == 0;
+                const char *status = nullptr;
+                MipValidator::Result result;
+                if (is_compute && (!validator.has_compute() ||
+                                   !vl::MipGenerator::is_compute_supported(context.m_physical_device, item.m_width, item.m_height)))
+                    status = "unsupported";
+                else if (!is_compute && !is_blit_supported)
+                    status = "unsupported";
+                else if (!validator.generate(pixels, item.m_width, item.m_height, expected, is_compute, repeat, result))
+                {
+                    status = "FAILED";
+                    is_passed = false;
+                }
+                else if (is_compute)
+                {
+                    status = result.m_max_error == 0 ? "exact" : "MISMATCH";
+                    is_passed &= result.m_max_error == 0;
+                }
+                else if (is_pot)
+                {
+                    status = result.m_max_error <= 1 ? "match" : "MISMATCH";
+                    is_passed &= result.m_max_error <= 1;
+                }
+                else
+                    status = "approx";
+
+                double gpu_ms = bench::percentile(result.m_gpu_ms, 50.0);
+                std::cout << std::fixed << std::setprecision(3)
+                          << std::setw(12) << (std::to_string(item.m_width) + "x" + std::to_string(item.m_height))
+                          << std::setw(8) << level_count
+                          << std::setw(8) << (is_compute ? "compute" : "blit")
+                          << std::setw(9) << gpu_ms
+                          << std::setw(10) << (level_count > 1 ? gpu_ms / (level_count - 1) : 0.0)
+                          << std::setw(11) << result.m_max_error
+                          << "  " << status
+                          << std::defaultfloat << std::endl;
+            }
+        }
+        std::cout << (is_passed ? "  gpu results match the cpu reference" : "  MISMATCH") << std::endl;
+    }
+
+    context.destroy();
+    return is_passed;
+}
+
+/// @brief mip生成基准：CPU参考实现每一级的耗时，以及GPU计算和blit两条路径与参考实现的比较
+int run_mip_bench(int argc, char **argv)
+{
+    std::vector<uint64_t> sizes = bench::get_list_option(argc, argv, "--sizes", "256,1024,4096");
+    int repeat = std::max(static_cast<int>(bench::get_option(argc, argv, "--repeat", 10LL)), 1);
+
+    // 正方形尺寸之外再加两个非2的幂、宽高不同的尺寸
+    std::vector<MipCase> cases;
+    for (uint64_t size : sizes)
+        cases.push_back({static_cast<uint32_t>(size), static_cast<uint32_t>(size)});
+    cases.push_back({1920, 1080});
+    cases.push_back({333, 77});
+
+    std::cout << "mip cpu: box filter reference, median of " << repeat << " runs" << std::endl
+              << "        size  levels  total ms  level ms (1, 2, 3, ...)" << std::endl;
+    for (const MipCase &item : cases)
+    {
+        std::vector<uint8_t> pixels = make_encoder_frame(item.m_width, item.m_height, item.m_width ^ item.m_height);
+        uint32_t level_count = vl::MipGenerator::get_level_count(item.m_width, item.m_height);
+        std::vector<std::vector<double>> level_ms(level_count);
+        std::vector<std::vector<uint8_t>> levels(level_count);
+        levels.at(0) = pixels;
+        for (int r = 0; r < repeat; r++)
+        {
+            uint32_t width = item.m_width, height = item.m_height;
+            for (uint32_t level = 1; level < level_count; level++)
+            {
+                levels.at(level).resize(static_cast<size_t>(std::max(width >> 1, 1u)) * std::max(height >> 1, 1u) * 4);
+                bench::Stopwatch stopwatch;
+                vl::MipGenerator::downsample(levels.at(level - 1).data(), width, height, levels.at(level).data());
+                level_ms.at(level).push_back(stopwatch.milliseconds());
+                bench::do_not_optimize(levels.at(level));
+                width = std::max(width >> 1, 1u);
+                height = std::max(height >> 1, 1u);
+            }
+        }
+
+        // 只列出前6级，之后的级别很小
+        double total_ms = 0.0;
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(4);
+        for (uint32_t level = 1; level < level_count; level++)
+        {
+            double ms = bench::percentile(level_ms.at(level), 50.0);
+            total_ms += ms;
+            if (level <= 6)
+                text << (level > 1 ? ", " : "") << ms;
+        }
+        if (level_count > 7)
+            text << ", ...";
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(12) << (std::to_string(item.m_width) + "x" + std::to_string(item.m_height))
+                  << std::setw(8) << level_count
+                  << std::setw(10) << total_ms
+                  << "  " << text.str()
+                  << std::defaultfloat << std::endl;
+    }
+
+    if (bench::has_flag(argc, argv, "--cpu-only"))
+        return EXIT_SUCCESS;
+    return validate_mip_generator(argc, argv, cases, repeat) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
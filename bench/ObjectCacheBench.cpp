@@ -0,0 +1,369 @@
+#ifndef OBJECTCACHEBENCH_CPP
+#define OBJECTCACHEBENCH_CPP
+
+#include <deque>
+#include <random>
+#include <unordered_set>
+#include "Bench.hpp"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/PhysicalDeviceUtils.hpp"
+#include "../src/PhysicalDeviceUtils.cpp"
+#include "../src/DefaultQueueFamilyIndices.hpp"
+#include "../src/DefaultQueueFamilyIndices.cpp"
+#include "../src/HeadlessContext.hpp"
+#include "../src/HeadlessContext.cpp"
+#include "../src/SamplerCache.hpp"
+#include "../src/SamplerCache.cpp"
+#include "../src/ImageViewCache.hpp"
+#include "../src/ImageViewCache.cpp"
+
+/// @brief 一个场景中每个材质的采样器和视图的创建信息
+struct CacheWorkload
+{
+    std::vector<vk::SamplerCreateInfo> m_samplers;
+    std::vector<vk::ImageViewCreateInfo> m_views;
+
+    /// @brief pNext链中的结构，每个材质各自一份，地址不同
+    std::deque<vk::SamplerReductionModeCreateInfo> m_reductions;
+    std::deque<vk::ImageViewUsageCreateInfo> m_usages;
+
+    /// @brief 用到的不同采样器配置数和不同视图数
+    uint32_t m_sampler_count = 0;
+    uint32_t m_view_count = 0;
+};
+
+/// @brief 生成材质：采样器配置按Zipf分布从过滤、寻址、各向异性和归约模式的组合中抽取，
+/// 每个材质引用一个图像，一半使用带调换（swizzle）和用途链的视图
+CacheWorkload make_cache_workload(
+    uint32_t material_count,
+    const std::vector<vk::Image> &images,
+    bool use_anisotropy,
+    bool use_reduction,
+    uint32_t seed)
+{
+    CacheWorkload workload;
+    const vk::Filter filters[] = {vk::Filter::eLinear, vk::Filter::eNearest};
+    const vk::SamplerAddressMode modes[] = {vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eClampToEdge, vk::SamplerAddressMode::eMirroredRepeat};
+    const float anisotropies[] = {0.0f, 4.0f, 16.0f};
+    uint32_t config_count = 2 * 3 * (use_anisotropy ? 3 : 1) * (use_reduction ? 2 : 1);
+
+    std::mt19937 random(seed);
+    std::vector<double> zipf(config_count);
+    double sum = 0.0;
+    for (uint32_t i = 0; i < config_count; i++)
+        zipf[i] = sum += 1.0 / (i + 1);
+    std::unordered_set<uint32_t> configs;
+    std::unordered_set<uint64_t> views;
+    for (uint32_t i = 0; i < material_count; i++)
+    {
+        double sample = std::uniform_real_distribution<double>(0.0, sum)(random);
+        uint32_t config = static_cast<uint32_t>(std::min<size_t>(std::lower_bound(zipf.begin(), zipf.end(), sample) - zipf.begin(), config_count - 1));
+        configs.insert(config);
+
+        vk::SamplerCreateInfo sampler_info;
+        sampler_info.setMagFilter(filters[config % 2]);
+        sampler_info.setMinFilter(filters[config % 2]);
+        sampler_info.setMipmapMode(vk::SamplerMipmapMode::eLinear);
+        vk::SamplerAddressMode mode = modes[config / 2 % 3];
+        sampler_info.setAddressModeU(mode);
+        sampler_info.setAddressModeV(mode);
+        sampler_info.setAddressModeW(mode);
+        float anisotropy = use_anisotropy ? anisotropies[config / 6 % 3] : 0.0f;
+        sampler_info.setAnisotropyEnable(anisotropy > 0.0f);
+        sampler_info.setMaxAnisotropy(std::max(anisotropy, 1.0f));
+        sampler_info.setMaxLod(VK_LOD_CLAMP_NONE);
+        if (use_reduction && config >= config_count / 2)
+        {
+            workload.m_reductions.emplace_back(vk::SamplerReductionMode::eMin);
+            sampler_info.setPNext(&workload.m_reductions.back());
+        }
+        workload.m_samplers.push_back(sampler_info);
+
+        uint32_t image = std::uniform_int_distribution<uint32_t>(0, static_cast<uint32_t>(images.size()) - 1)(random);
+        bool is_swizzled = (random() & 1) != 0;
+        views.insert(static_cast<uint64_t>(image) * 2 + (is_swizzled ? 1 : 0));
+        vk::ImageViewCreateInfo view_info;
+        view_info.setImage(images[image]);
+        view_info.setViewType(vk::ImageViewType::e2D);
+        view_info.setFormat(vk::Format::eR8G8B8A8Unorm);
+        view_info.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+        if (is_swizzled)
+        {
+            view_info.setComponents(vk::ComponentMapping(vk::ComponentSwizzle::eR, vk::ComponentSwizzle::eR, vk::ComponentSwizzle::eR, vk::ComponentSwizzle::eOne));
+            workload.m_usages.emplace_back(vk::ImageUsageFlagBits::eSampled);
+            view_info.setPNext(&workload.m_usages.back());
+        }
+        workload.m_views.push_back(view_info);
+    }
+    workload.m_sampler_count = static_cast<uint32_t>(configs.size());
+    workload.m_view_count = static_cast<uint32_t>(views.size());
+    return workload;
+}
+
+/// @brief 检查键对pNext链的处理：相同内容不同地址的链相同，内容不同的链不同，未知结构不缓存
+bool check_cache_keys()
+{
+    vk::SamplerCreateInfo sampler_info;
+    sampler_info.setMagFilter(vk::Filter::eLinear);
+    vk::SamplerReductionModeCreateInfo reduction_a(vk::SamplerReductionMode::eMin);
+    vk::SamplerReductionModeCreateInfo reduction_b(vk::SamplerReductionMode::eMin);
+    vk::SamplerReductionModeCreateInfo reduction_c(vk::SamplerReductionMode::eMax);
+    vk::SamplerCreateInfo info_a = sampler_info, info_b = sampler_info, info_c = sampler_info, info_d = sampler_info;
+    info_a.setPNext(&reduction_a);
+    info_b.setPNext(&reduction_b);
+    info_c.setPNext(&reduction_c);
+
+    vk::SamplerCustomBorderColorCreateInfoEXT border_a(vk::ClearColorValue(std::array<float, 4>{1.0f, 0.0f, 0.0f, 1.0f}), vk::Format::eR8G8B8A8Unorm);
+    vk::SamplerCustomBorderColorCreateInfoEXT border_b(vk::ClearColorValue(std::array<float, 4>{0.0f, 1.0f, 0.0f, 1.0f}), vk::Format::eR8G8B8A8Unorm);
+    vk::SamplerReductionModeCreateInfo reduction_e(vk::SamplerReductionMode::eMin, &border_a);
+    vk::SamplerCreateInfo info_e = sampler_info, info_f = sampler_info;
+    info_e.setPNext(&reduction_e);
+    info_f.setPNext(&border_b);
+
+    // 采样器的链中出现视图的结构，无法判断
+    vk::ImageViewUsageCreateInfo usage(vk::ImageUsageFlagBits::eSampled);
+    info_d.setPNext(&usage);
+
+    std::optional<vl::SamplerCache::Key> key_a = vl::SamplerCache::make_key(info_a);
+    std::optional<vl::SamplerCache::Key> key_e = vl::SamplerCache::make_key(info_e);
+    bool is_sampler_valid = key_a.has_value() && key_a == vl::SamplerCache::make_key(info_b) &&
+                            key_a != vl::SamplerCache::make_key(info_c) &&
+                            key_a != vl::SamplerCache::make_key(sampler_info) &&
+                            key_e.has_value() && key_e != key_a && key_e != vl::SamplerCache::make_key(info_f) &&
+                            !vl::SamplerCache::make_key(info_d).has_value();
+
+    vk::ImageViewCreateInfo view_info;
+    view_info.setViewType(vk::ImageViewType::e2D);
+    view_info.setFormat(vk::Format::eR8G8B8A8Unorm);
+    vk::ImageViewCreateInfo view_usage = view_info, view_unknown = view_info;
+    view_usage.setPNext(&usage);
+    view_unknown.setPNext(&reduction_b);
+    vk::ImageViewCreateInfo view_format = view_info;
+    view_format.setFormat(vk::Format::eR8G8B8A8Srgb);
+    std::optional<vl::ImageViewCache::Key> view_key = vl::ImageViewCache::make_key(view_info);
+    bool is_view_valid = view_key.has_value() && view_key == vl::ImageViewCache::make_key(view_info) &&
+                         view_key != vl::ImageViewCache::make_key(view_usage) &&
+                         view_key != vl::ImageViewCache::make_key(view_format) &&
+                         !vl::ImageViewCache::make_key(view_unknown).has_value();
+
+    std::cout << "cache keys: sampler pNext " << (is_sampler_valid ? "ok" : "FAILED")
+              << ", image view pNext " << (is_view_valid ? "ok" : "FAILED") << std::endl;
+    return is_sampler_valid && is_view_valid;
+}
+
+/// @brief 在CPU上对工作负载生成键并查找，检查去重后的数量，计算每次查找的耗时
+bool measure_cache_keys(const CacheWorkload &workload, uint32_t repeat_count)
+{
+    std::vector<double> sampler_ns, view_ns;
+    size_t sampler_count = 0, view_count = 0;
+    bench::Stopwatch stopwatch;
+    for (uint32_t repeat = 0; repeat < repeat_count; repeat++)
+    {
+        std::unordered_map<vl::SamplerCache::Key, uint32_t, vl::SamplerCache::KeyHash> samplers;
+        stopwatch.reset();
+        for (const vk::SamplerCreateInfo &info : workload.m_samplers)
+            samplers[*vl::SamplerCache::make_key(info)]++;
+        sampler_ns.push_back(stopwatch.seconds() * 1e9 / workload.m_samplers.size());
+        sampler_count = samplers.size();
+
+        std::unordered_map<vl::ImageViewCache::Key, uint32_t, vl::ImageViewCache::KeyHash> views;
+        stopwatch.reset();
+        for (const vk::ImageViewCreateInfo &info : workload.m_views)
+            views[*vl::ImageViewCache::make_key(info)]++;
+        view_ns.push_back(stopwatch.seconds() * 1e9 / workload.m_views.size());
+        view_count = views.size();
+    }
+
+    bool is_valid = sampler_count == workload.m_sampler_count && view_count == workload.m_view_count;
+    std::cout << "cache cpu: " << workload.m_samplers.size() << " materials -> " << sampler_count << " samplers (expected "
+              << workload.m_sampler_count << "), " << view_count << " image views (expected " << workload.m_view_count << "); "
+              << std::fixed << std::setprecision(1) << "key + lookup " << bench::percentile(sampler_ns, 50) << " ns/sampler, "
+              << bench::percentile(view_ns, 50) << " ns/view" << std::defaultfloat
+              << (is_valid ? "" : " FAILED") << std::endl;
+    return is_valid;
+}
+
+/// @brief 在GPU上比较每个材质各自创建采样器和视图与经过缓存获取的耗时和对象数，
+/// 并检查引用计数、trim以及采样器数量上限；无法创建Vulkan环境时跳过
+bool validate_object_caches(int argc, char **argv, uint32_t material_count, uint32_t image_count, uint32_t seed)
+{
+    vl::HeadlessContext::Config config;
+    config.m_name = "object caches";
+    config.m_device_name = bench::get_option(argc, argv, "--device", std::string());
+    config.m_features.samplerAnisotropy = true;
+    if (bench::has_flag(argc, argv, "--validation"))
+        config.m_validation_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+    vl::HeadlessContext context;
+    if (context.create(config) != vk::Result::eSuccess)
+    {
+        std::cout << "cache gpu: skipped, unable to create headless vulkan context" << std::endl;
+        return true;
+    }
+    const vk::Device &device = context.m_device;
+    uint32_t max_samplers = context.m_properties.limits.maxSamplerAllocationCount;
+
+    // 小图像，每个绑定独立的内存
+    std::vector<vk::Image> images;
+    std::vector<vk::DeviceMemory> memories;
+    bool is_passed = true;
+    for (uint32_t i = 0; i < image_count && is_passed; i++)
+    {
+        vk::ImageCreateInfo image_info;
+        image_info.setImageType(vk::ImageType::e2D);
+        image_info.setFormat(vk::Format::eR8G8B8A8Unorm);
+        image_info.setExtent(vk::Extent3D(4, 4, 1));
+        image_info.setMipLevels(1);
+        image_info.setArrayLayers(1);
+        image_info.setSamples(vk::SampleCountFlagBits::e1);
+        image_info.setTiling(vk::ImageTiling::eOptimal);
+        image_info.setUsage(vk::ImageUsageFlagBits::eSampled);
+        image_info.setSharingMode(vk::SharingMode::eExclusive);
+        image_info.setInitialLayout(vk::ImageLayout::eUndefined);
+        auto image_result = device.createImage(image_info);
+        is_passed &= image_result.result == vk::Result::eSuccess;
+        if (!is_passed)
+            break;
+        images.push_back(image_result.value);
+        auto memory_result = vl::DeviceUtils::allocate_image_memory(device, context.m_physical_device, images.back(), vk::MemoryPropertyFlagBits::eDeviceLocal, vk::MemoryPropertyFlags());
+        is_passed &= memory_result.result == vk::Result::eSuccess;
+        memories.push_back(memory_result.value);
+    }
+
+    CacheWorkload workload = make_cache_workload(material_count, images, context.m_features.samplerAnisotropy, false, seed);
+    bench::Stopwatch stopwatch;
+
+    // 每个材质各自创建，超出采样器上限的部分不创建
+    std::vector<vk::Sampler> samplers;
+    std::vector<vk::ImageView> views;
+    uint32_t rejected = 0;
+    stopwatch.reset();
+    for (uint32_t i = 0; i < material_count && is_passed; i++)
+    {
+        if (samplers.size() < max_samplers)
+        {
+            auto sampler_result = device.createSampler(workload.m_samplers[i]);
+            is_passed &= sampler_result.result == vk::Result::eSuccess;
+            samplers.push_back(sampler_result.value);
+        }
+        else
+            rejected++;
+        auto view_result = device.createImageView(workload.m_views[i]);
+        is_passed &= view_result.result == vk::Result::eSuccess;
+        views.push_back(view_result.value);
+    }
+    double direct_ms = stopwatch.milliseconds();
+    for (const vk::Sampler &sampler : samplers)
+        device.destroySampler(sampler);
+    for (const vk::ImageView &view : views)
+        device.destroyImageView(view);
+    size_t direct_samplers = samplers.size(), direct_views = views.size();
+
+    // 经过缓存获取
+    vl::SamplerCache sampler_cache;
+    vl::ImageViewCache view_cache;
+    sampler_cache.create(max_samplers);
+    samplers.clear();
+    views.clear();
+    stopwatch.reset();
+    for (uint32_t i = 0; i < material_count && is_passed; i++)
+    {
+        auto sampler_result = sampler_cache.acquire(device, workload.m_samplers[i]);
+        auto view_result = view_cache.acquire(device, workload.m_views[i]);
+        is_passed &= sampler_result.result == vk::Result::eSuccess && view_result.result == vk::Result::eSuccess;
+        samplers.push_back(sampler_result.value);
+        views.push_back(view_result.value);
+    }
+    double cached_ms = stopwatch.milliseconds();
+    bool is_deduplicated = is_passed &&
+                           sampler_cache.get_size() == workload.m_sampler_count &&
+                           view_cache.get_size() == workload.m_view_count;
+
+    // 全部释放后引用计数为0，对象仍在缓存中，trim后全部销毁
+    for (uint32_t i = 0; i < samplers.size(); i++)
+    {
+        sampler_cache.release(device, samplers[i]);
+        view_cache.release(device, views[i]);
+    }
+    bool is_released = true;
+    for (uint32_t i = 0; i < samplers.size(); i++)
+        is_released &= sampler_cache.get_ref_count(samplers[i]) == 0 && view_cache.get_ref_count(views[i]) == 0;
+    is_released &= sampler_cache.trim(device) == workload.m_sampler_count &&
+                   view_cache.trim(device) == workload.m_view_count &&
+                   sampler_cache.get_statistics().m_live == 0 && view_cache.get_statistics().m_live == 0;
+
+    // 上限为4：持有4个不同的采样器时第5个失败，释放一个后仍然失败，trim之后才成功
+    vl::SamplerCache limited_cache;
+    limited_cache.create(4);
+    std::vector<vk::Sampler> held;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        vk::SamplerCreateInfo info;
+        info.setMaxLod(static_cast<float>(i));
+        auto sampler_result = limited_cache.acquire(device, info);
+        held.push_back(sampler_result.value);
+    }
+    vk::SamplerCreateInfo extra_info;
+    extra_info.setMaxLod(8.0f);
+    bool is_limited = limited_cache.acquire(device, extra_info).result == vk::Result::eErrorTooManyObjects;
+    limited_cache.release(device, held[0]);
+    is_limited &= limited_cache.acquire(device, extra_info).result == vk::Result::eErrorTooManyObjects &&
+                  limited_cache.get_statistics().m_live == 4;
+    vkDeviceWaitIdle(static_cast<VkDevice>(device));
+    is_limited &= limited_cache.trim(device) == 1 &&
+                  limited_cache.acquire(device, extra_info).result == vk::Result::eSuccess &&
+                  limited_cache.get_statistics().m_live == 4 && limited_cache.get_statistics().m_failures == 2;
+    limited_cache.destroy(device);
+
+    std::cout << "cache gpu: " << context.get_device_name() << ", " << material_count << " materials, " << images.size()
+              << " images, sampler limit " << max_samplers << std::endl
+              << std::fixed << std::setprecision(2)
+              << "  direct: " << direct_samplers << " samplers (" << rejected << " over limit), " << direct_views
+              << " views, " << direct_ms << " ms" << std::endl
+              << "  cached: " << sampler_cache.get_statistics().m_peak_live << " samplers (hit rate " << sampler_cache.get_hit_rate() * 100.0
+              << "%), " << view_cache.get_statistics().m_peak_live << " views (hit rate " << view_cache.get_hit_rate() * 100.0
+              << "%), " << cached_ms << " ms" << std::defaultfloat << std::endl
+              << "  deduplicated " << (is_deduplicated ? "ok" : "FAILED") << ", released and trimmed " << (is_released ? "ok" : "FAILED")
+              << ", sampler limit " << (is_limited ? "ok" : "FAILED") << std::endl
+              << "cache gpu sampler statistics:" << sampler_cache.format()
+              << "cache gpu image view statistics:" << view_cache.format();
+
+    vkDeviceWaitIdle(static_cast<VkDevice>(device));
+    sampler_cache.destroy(device);
+    for (const vk::Image &image : images)
+        view_cache.release_image(device, image);
+    view_cache.destroy(device);
+    for (const vk::Image &image : images)
+        device.destroyImage(image);
+    for (const vk::DeviceMemory &memory : memories)
+        if (memory)
+            device.freeMemory(memory);
+    context.destroy();
+    return is_passed && is_deduplicated && is_released && is_limited;
+}
+
+/// @brief 对象缓存基准：在CPU上检查键的去重和pNext处理，可选地在GPU上比较直接创建与经过缓存的对象数和耗时
+int run_object_cache_bench(int argc, char **argv)
+{
+    uint32_t material_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--materials", 10000LL));
+    uint32_t image_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--images", 2500LL));
+    uint32_t repeat_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--repeat", 10LL));
+    uint32_t seed = static_cast<uint32_t>(bench::get_option(argc, argv, "--seed", 1LL));
+
+    bool is_passed = check_cache_keys();
+
+    // CPU上用不同的值代替图像句柄
+    std::vector<vk::Image> images;
+    for (uint32_t i = 0; i < image_count; i++)
+        images.push_back(vk::Image((VkImage)(uintptr_t)(i + 1)));
+    CacheWorkload workload = make_cache_workload(material_count, images, true, true, seed);
+    is_passed &= measure_cache_keys(workload, repeat_count);
+
+    if (!bench::has_flag(argc, argv, "--cpu-only"))
+        is_passed &= validate_object_caches(argc, argv, material_count, image_count, seed);
+
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
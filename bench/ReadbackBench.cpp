@@ -0,0 +1,620 @@
+#ifndef READBACKBENCH_CPP
+#define READBACKBENCH_CPP
+
+#include <array>
+#include <deque>
+#include <future>
+#include <numeric>
+#include "Bench.hpp"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/PhysicalDeviceUtils.hpp"
+#include "../src/PhysicalDeviceUtils.cpp"
+#include "../src/DefaultQueueFamilyIndices.hpp"
+#include "../src/DefaultQueueFamilyIndices.cpp"
+#include "../src/HeadlessContext.hpp"
+#include "../src/HeadlessContext.cpp"
+#include "../src/MappedBuffer.hpp"
+#include "../src/MappedBuffer.cpp"
+#include "../src/ReadbackQueue.hpp"
+#include "../src/ReadbackQueue.cpp"
+
+/// @brief 回读场景：离屏渲染一帧，左右两半的颜色由帧号决定，便于检查回读的像素和顺序
+class ReadbackScene
+{
+public:
+    static constexpr vk::Format COLOR_FORMAT = vk::Format::eR8G8B8A8Unorm;
+
+protected:
+    vl::HeadlessContext &m_context;
+    vk::Device m_device;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+
+    vk::Image m_image;
+    vk::DeviceMemory m_memory;
+    vk::ImageView m_view;
+    vk::RenderPass m_render_pass;
+    vk::Framebuffer m_framebuffer;
+
+public:
+    ReadbackScene(vl::HeadlessContext &context) : m_context(context), m_device(context.m_device) {}
+    ~ReadbackScene() { destroy(); }
+
+public:
+    bool create(uint32_t width, uint32_t height)
+    {
+        m_width = width;
+        m_height = height;
+
+        vk::ImageCreateInfo image_info;
+        image_info.setImageType(vk::ImageType::e2D);
+        image_info.setFormat(COLOR_FORMAT);
+        image_info.setExtent(vk::Extent3D(m_width, m_height, 1));
+        image_info.setMipLevels(1);
+        image_info.setArrayLayers(1);
+        image_info.setSamples(vk::SampleCountFlagBits::e1);
+        image_info.setTiling(vk::ImageTiling::eOptimal);
+        image_info.setUsage(vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc);
+        image_info.setSharingMode(vk::SharingMode::eExclusive);
+        image_info.setInitialLayout(vk::ImageLayout::eUndefined);
+        auto image_result = m_device.createImage(image_info);
+        if (image_result.result != vk::Result::eSuccess)
+            return false;
+        m_image = image_result.value;
+
+        auto memory_result = vl::DeviceUtils::allocate_image_memory(
+            m_device,
+            m_context.m_physical_device,
+            m_image,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::MemoryPropertyFlags());
+        if (memory_result.result != vk::Result::eSuccess)
+            return false;
+        m_memory = memory_result.value;
+
+        vk::ImageViewCreateInfo view_info;
+        view_info.setImage(m_image);
+        view_info.setViewType(vk::ImageViewType::e2D);
+        view_info.setFormat(COLOR_FORMAT);
+        view_info.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+        auto view_result = m_device.createImageView(view_info);
+        if (view_result.result != vk::Result::eSuccess)
+            return false;
+        m_view = view_result.value;
+
+        vk::AttachmentDescription attachment;
+        attachment.setFormat(COLOR_FORMAT);
+        attachment.setSamples(vk::SampleCountFlagBits::e1);
+        attachment.setLoadOp(vk::AttachmentLoadOp::eClear);
+        attachment.setStoreOp(vk::AttachmentStoreOp::eStore);
+        attachment.setStencilLoadOp(vk::AttachmentLoadOp::eDontCare);
+        attachment.setStencilStoreOp(vk::AttachmentStoreOp::eDontCare);
+        attachment.setInitialLayout(vk::ImageLayout::eUndefined);
+        attachment.setFinalLayout(vk::ImageLayout::eColorAttachmentOptimal);
+
+        vk::AttachmentReference color_reference(0, vk::ImageLayout::eColorAttachmentOptimal);
+        vk::SubpassDescription subpass;
+        subpass.setPipelineBindPoint(vk::PipelineBindPoint::eGraphics);
+        subpass.setColorAttachmentCount(1);
+        subpass.setPColorAttachments(&color_reference);
+
+        // 上一帧的回读复制和它之后的布局转换完成后才能再次写入
+        vk::SubpassDependency dependency;
+        dependency.setSrcSubpass(VK_SUBPASS_EXTERNAL);
+        dependency.setDstSubpass(0);
+        dependency.setSrcStageMask(vk::PipelineStageFlagBits::eAllCommands);
+        dependency.setDstStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+        dependency.setSrcAccessMask(vk::AccessFlags());
+        dependency.setDstAccessMask(vk::AccessFlagBits::eColorAttachmentWrite);
+
+        vk::RenderPassCreateInfo pass_info;
+        pass_info.setAttachmentCount(1);
+        pass_info.setPAttachments(&attachment);
+        pass_info.setSubpassCount(1);
+        pass_info.setPSubpasses(&subpass);
+        pass_info.setDependencyCount(1);
+        pass_info.setPDependencies(&dependency);
+        auto pass_result = m_device.createRenderPass(pass_info);
+        if (pass_result.result != vk::Result::eSuccess)
+            return false;
+        m_render_pass = pass_result.value;
+
+        vk::FramebufferCreateInfo framebuffer_info;
+        framebuffer_info.setRenderPass(m_render_pass);
+        framebuffer_info.setAttachmentCount(1);
+        framebuffer_info.setPAttachments(&m_view);
+        framebuffer_info.setWidth(m_width);
+        framebuffer_info.setHeight(m_height);
+        framebuffer_info.setLayers(1);
+        auto framebuffer_result = m_device.createFramebuffer(framebuffer_info);
+        if (framebuffer_result.result != vk::Result::eSuccess)
+            return false;
+        m_framebuffer = framebuffer_result.value;
+        return true;
+    }
+
+    void destroy()
+    {
+        if (!m_device)
+            return;
+        m_device.waitIdle();
+
+        if (m_framebuffer)
+            m_device.destroyFramebuffer(m_framebuffer);
+        if (m_render_pass)
+            m_device.destroyRenderPass(m_render_pass);
+        if (m_view)
+            m_device.destroyImageView(m_view);
+        if (m_image)
+            m_device.destroyImage(m_image);
+        if (m_memory)
+            m_device.freeMemory(m_memory);
+        m_device = nullptr;
+    }
+
+    /// @brief 渲染第frame帧：整个目标清除为左边的颜色，再把右半边清除为右边的颜色
+    void render(const vk::CommandBuffer &command_buffer, uint32_t frame) const
+    {
+        uint8_t left[4], right[4];
+        get_colors(frame, left, right);
+
+        vk::ClearValue clear_value;
+        clear_value.setColor(vk::ClearColorValue(std::array<float, 4>{left[0] / 255.0f, left[1] / 255.0f, left[2] / 255.0f, left[3] / 255.0f}));
+        vk::RenderPassBeginInfo begin_info;
+        begin_info.setRenderPass(m_render_pass);
+        begin_info.setFramebuffer(m_framebuffer);
+        begin_info.setRenderArea(vk::Rect2D(vk::Offset2D(0, 0), vk::Extent2D(m_width, m_height)));
+        begin_info.setClearValueCount(1);
+        begin_info.setPClearValues(&clear_value);
+        command_buffer.beginRenderPass(begin_info, vk::SubpassContents::eInline);
+
+        vk::ClearAttachment attachment;
+        attachment.setAspectMask(vk::ImageAspectFlagBits::eColor);
+        attachment.setColorAttachment(0);
+        attachment.setClearValue(vk::ClearColorValue(std::array<float, 4>{right[0] / 255.0f, right[1] / 255.0f, right[2] / 255.0f, right[3] / 255.0f}));
+        vk::ClearRect rect(vk::Rect2D(vk::Offset2D(static_cast<int32_t>(m_width / 2), 0), vk::Extent2D(m_width - m_width / 2, m_height)), 0, 1);
+        command_buffer.clearAttachments(attachment, rect);
+
+        command_buffer.endRenderPass();
+    }
+
+    /// @brief 回读的来源
+    vl::ReadbackQueue::Source get_source() const
+    {
+        vl::ReadbackQueue::Source source;
+        source.m_image = m_image;
+        source.m_extent = vk::Extent2D(m_width, m_height);
+        source.m_format = COLOR_FORMAT;
+        source.m_layout = vk::ImageLayout::eColorAttachmentOptimal;
+        return source;
+    }
+
+    /// @brief 检查回读的一帧是否为第index帧的画面
+    bool check(const vl::ReadbackQueue::Frame &frame, uint32_t index) const
+    {
+        if (frame.m_result != vk::Result::eSuccess || frame.m_extent.width != m_width || frame.m_extent.height != m_height ||
+            frame.m_row_pitch != m_width * 4 || frame.m_pixels.size() != static_cast<size_t>(m_width) * m_height * 4)
+            return false;
+
+        uint8_t left[4], right[4];
+        get_colors(index, left, right);
+        for (uint32_t y = 0; y < m_height; y++)
+        {
+            const uint8_t *row = frame.m_pixels.data() + static_cast<size_t>(y) * frame.m_row_pitch;
+            for (uint32_t x = 0; x < m_width; x++)
+            {
+                const uint8_t *expected = x < m_width / 2 ? left : right;
+                for (uint32_t c = 0; c < 4; c++)
+                    if (std::abs(static_cast<int>(row[x * 4 + c]) - expected[c]) > 1)
+                        return false;
+            }
+        }
+        return true;
+    }
+
+    static void get_colors(uint32_t frame, uint8_t left[4], uint8_t right[4])
+    {
+        left[0] = static_cast<uint8_t>(frame & 0xFF);
+        left[1] = static_cast<uint8_t>((frame >> 8) & 0xFF);
+        left[2] = 0x40;
+        left[3] = 0xFF;
+        right[0] = static_cast<uint8_t>(0xFF - (frame & 0xFF));
+        right[1] = 0x80;
+        right[2] = static_cast<uint8_t>(frame * 7);
+        right[3] = 0xFF;
+    }
+};
+
+/// @brief 连续渲染并回读，使用调用者的命令缓冲和栅栏，环满时等待，报告吞吐量和渲染线程的记录耗时
+bool measure_readback_stream(vl::HeadlessContext &context, ReadbackScene &scene, uint32_t width, uint32_t height, uint32_t frames, uint32_t ring_size)
+{
+    const vk::Device &device = context.m_device;
+    vl::ReadbackQueue::Config config;
+    config.m_ring_size = ring_size;
+    config.m_slot_size = static_cast<vk::DeviceSize>(width) * height * 4;
+    config.m_back_pressure = vl::ReadbackQueue::BackPressure::eWait;
+
+    vl::ReadbackQueue queue;
+    if (queue.create(device, context.m_physical_device, context.m_graphics_queue, *context.m_queue_family_indices.m_graphics_family, config) != vk::Result::eSuccess)
+        return false;
+
+    // 比环多一组命令缓冲和栅栏：第j帧记录时等待的是第j-1-ring帧的回读，
+    // 因此第j帧重置的栅栏（第j-ring-1帧的）已经被后台线程等待过
+    uint32_t frame_count = ring_size + 1;
+    vk::CommandBufferAllocateInfo allocate_info;
+    allocate_info.setCommandPool(context.m_command_pool);
+    allocate_info.setLevel(vk::CommandBufferLevel::ePrimary);
+    allocate_info.setCommandBufferCount(frame_count);
+    auto command_result = device.allocateCommandBuffers(allocate_info);
+    if (command_result.result != vk::Result::eSuccess)
+        return false;
+    std::vector<vk::CommandBuffer> command_buffers = command_result.value;
+    std::vector<vk::Fence> fences;
+    for (uint32_t i = 0; i < frame_count; i++)
+    {
+        auto fence_result = device.createFence(vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled));
+        if (fence_result.result == vk::Result::eSuccess)
+            fences.push_back(fence_result.value);
+    }
+
+    bool is_passed = fences.size() == frame_count;
+    uint32_t checked = 0;
+    std::deque<std::pair<uint32_t, std::future<vl::ReadbackQueue::Frame>>> pending;
+    auto check_front = [&]()
+    {
+        vl::ReadbackQueue::Frame frame = pending.front().second.get();
+        is_passed &= scene.check(frame, pending.front().first);
+        pending.pop_front();
+        checked++;
+    };
+
+    std::vector<double> record_ms;
+    bench::Stopwatch total_stopwatch;
+    for (uint32_t frame = 0; frame < frames && is_passed; frame++)
+    {
+        uint32_t slot = frame % frame_count;
+        const vk::CommandBuffer &command_buffer = command_buffers[slot];
+        if (device.waitForFences(fences[slot], VK_TRUE, UINT64_MAX) != vk::Result::eSuccess ||
+            device.resetFences(fences[slot]) != vk::Result::eSuccess ||
+            command_buffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit)) != vk::Result::eSuccess)
+        {
+            is_passed = false;
+            break;
+        }
+        scene.render(command_buffer, frame);
+
+        bench::Stopwatch stopwatch;
+        auto future = queue.record(command_buffer, scene.get_source());
+        record_ms.push_back(stopwatch.milliseconds());
+        is_passed &= future.has_value() && command_buffer.end() == vk::Result::eSuccess;
+        if (!is_passed)
+            break;
+
+        vk::SubmitInfo submit_info;
+        submit_info.setCommandBuffers(command_buffer);
+        is_passed &= context.m_graphics_queue.submit(submit_info, fences[slot]) == vk::Result::eSuccess;
+        if (!is_passed)
+            break;
+        vl::ReadbackQueue::Signal signal;
+        signal.m_fence = fences[slot];
+        queue.submitted(signal);
+        pending.emplace_back(frame, std::move(*future));
+
+        // 只检查已经完成的帧，渲染线程不等待
+        while (!pending.empty() && pending.front().second.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            check_front();
+    }
+    while (!pending.empty())
+        check_front();
+    double total_seconds = total_stopwatch.seconds();
+
+    vl::ReadbackQueue::Statistics statistics = queue.get_statistics();
+    is_passed &= checked == frames && statistics.m_frames == frames && statistics.m_dropped == 0 && statistics.m_failed == 0;
+    std::cout << "readback stream: " << width << "x" << height << ", " << frames << " frames, ring " << ring_size << std::endl
+              << std::fixed << std::setprecision(3)
+              << "  record ms mean " << std::accumulate(record_ms.begin(), record_ms.end(), 0.0) / std::max<size_t>(record_ms.size(), 1)
+              << ", p99 " << bench::percentile(record_ms, 99) << std::endl
+              << std::setprecision(1)
+              << "  " << frames / total_seconds << " frames/s, " << statistics.megabytes_per_second() << " MB/s" << std::defaultfloat << std::endl
+              << "  pixels " << (is_passed ? "ok" : "FAILED") << std::endl
+              << "readback stream statistics:" << queue.format();
+
+    device.waitIdle();
+    queue.destroy();
+    for (const vk::Fence &fence : fences)
+        device.destroyFence(fence);
+    device.freeCommandBuffers(context.m_command_pool, command_buffers);
+    return is_passed;
+}
+
+/// @brief 环满时的处理：把ring个复制记录到同一个命令缓冲中，再记录一个；
+/// eDrop时最后一个被丢弃，eWait时第一个命令缓冲提交后最后一个在另一个命令缓冲中等到空闲的格
+bool check_back_pressure(vl::HeadlessContext &context, ReadbackScene &scene, uint32_t width, uint32_t height, uint32_t ring_size, vl::ReadbackQueue::BackPressure back_pressure)
+{
+    const vk::Device &device = context.m_device;
+    bool is_wait = back_pressure == vl::ReadbackQueue::BackPressure::eWait;
+    vl::ReadbackQueue::Config config;
+    config.m_ring_size = ring_size;
+    config.m_slot_size = static_cast<vk::DeviceSize>(width) * height * 4;
+    config.m_back_pressure = back_pressure;
+
+    vl::ReadbackQueue queue;
+    if (queue.create(device, context.m_physical_device, context.m_graphics_queue, *context.m_queue_family_indices.m_graphics_family, config) != vk::Result::eSuccess)
+        return false;
+
+    vk::CommandBufferAllocateInfo allocate_info;
+    allocate_info.setCommandPool(context.m_command_pool);
+    allocate_info.setLevel(vk::CommandBufferLevel::ePrimary);
+    allocate_info.setCommandBufferCount(2);
+    auto command_result = device.allocateCommandBuffers(allocate_info);
+    if (command_result.result != vk::Result::eSuccess)
+        return false;
+    std::vector<vk::CommandBuffer> command_buffers = command_result.value;
+    vk::Fence fences[2];
+    bool is_passed = true;
+    for (vk::Fence &fence : fences)
+    {
+        auto fence_result = device.createFence(vk::FenceCreateInfo());
+        is_passed &= fence_result.result == vk::Result::eSuccess;
+        fence = fence_result.value;
+    }
+
+    const uint32_t index = 1000;
+    std::vector<std::future<vl::ReadbackQueue::Frame>> futures;
+    auto submit = [&](uint32_t i)
+    {
+        vk::SubmitInfo submit_info;
+        submit_info.setCommandBuffers(command_buffers[i]);
+        is_passed &= command_buffers[i].end() == vk::Result::eSuccess &&
+                     context.m_graphics_queue.submit(submit_info, fences[i]) == vk::Result::eSuccess;
+        vl::ReadbackQueue::Signal signal;
+        signal.m_fence = fences[i];
+        queue.submitted(signal);
+    };
+
+    is_passed &= command_buffers[0].begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit)) == vk::Result::eSuccess;
+    scene.render(command_buffers[0], index);
+    for (uint32_t i = 0; i < ring_size && is_passed; i++)
+    {
+        auto future = queue.record(command_buffers[0], scene.get_source());
+        is_passed &= future.has_value();
+        if (future.has_value())
+            futures.push_back(std::move(*future));
+    }
+
+    bool is_handled = false;
+    double wait_ms = 0.0;
+    if (is_wait)
+    {
+        // 环已满，提交后才会有空闲的格
+        submit(0);
+        if (is_passed && command_buffers[1].begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit)) == vk::Result::eSuccess)
+        {
+            bench::Stopwatch stopwatch;
+            auto future = queue.record(command_buffers[1], scene.get_source());
+            wait_ms = stopwatch.milliseconds();
+            is_handled = future.has_value();
+            if (future.has_value())
+                futures.push_back(std::move(*future));
+            submit(1);
+        }
+    }
+    else
+    {
+        is_handled = is_passed && !queue.record(command_buffers[0], scene.get_source()).has_value();
+        submit(0);
+    }
+
+    // 提交失败时future要到destroy才会完成
+    for (auto &future : futures)
+        is_passed = is_passed && scene.check(future.get(), index);
+
+    vl::ReadbackQueue::Statistics statistics = queue.get_statistics();
+    is_handled &= statistics.m_dropped == (is_wait ? 0u : 1u) && statistics.m_frames == (is_wait ? ring_size + 1 : ring_size);
+    std::cout << "readback " << (is_wait ? "wait" : "drop") << ": " << futures.size() << " frames read back, "
+              << statistics.m_dropped << " dropped";
+    if (is_wait)
+        std::cout << ", blocked " << std::fixed << std::setprecision(3) << wait_ms << " ms" << std::defaultfloat;
+    std::cout << std::endl
+              << "  back-pressure " << (is_handled ? "ok" : "FAILED") << ", pixels " << (is_passed ? "ok" : "FAILED") << std::endl;
+
+    device.waitIdle();
+    queue.destroy();
+    for (const vk::Fence &fence : fences)
+        if (fence)
+            device.destroyFence(fence);
+    device.freeCommandBuffers(context.m_command_pool, command_buffers);
+    return is_passed && is_handled;
+}
+
+/// @brief 内部命令缓冲的capture、深度图像的回读和未启用时间线信号量时的拒绝
+bool check_readback_paths(vl::HeadlessContext &context, ReadbackScene &scene, uint32_t width, uint32_t height)
+{
+    const vk::Device &device = context.m_device;
+    vl::ReadbackQueue::Config config;
+    config.m_slot_size = static_cast<vk::DeviceSize>(width) * height * 4;
+
+    vl::ReadbackQueue queue;
+    if (queue.create(device, context.m_physical_device, context.m_graphics_queue, *context.m_queue_family_indices.m_graphics_family, config) != vk::Result::eSuccess)
+        return false;
+
+    // capture使用内部的命令缓冲和栅栏
+    const uint32_t index = 2000;
+    auto command_result = context.begin_one_time();
+    bool is_captured = command_result.result == vk::Result::eSuccess;
+    if (is_captured)
+    {
+        scene.render(command_result.value, index);
+        is_captured = context.end_one_time(command_result.value) == vk::Result::eSuccess;
+    }
+    if (is_captured)
+    {
+        auto future = queue.capture(scene.get_source());
+        is_captured = future.has_value() && scene.check(future->get(), index);
+    }
+
+    // 深度图像清除为0.5后回读，屏障和复制需要使用深度方面
+    vk::ImageCreateInfo image_info;
+    image_info.setImageType(vk::ImageType::e2D);
+    image_info.setFormat(vk::Format::eD16Unorm);
+    image_info.setExtent(vk::Extent3D(width, height, 1));
+    image_info.setMipLevels(1);
+    image_info.setArrayLayers(1);
+    image_info.setSamples(vk::SampleCountFlagBits::e1);
+    image_info.setTiling(vk::ImageTiling::eOptimal);
+    image_info.setUsage(vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst);
+    image_info.setSharingMode(vk::SharingMode::eExclusive);
+    image_info.setInitialLayout(vk::ImageLayout::eUndefined);
+    vk::Image depth_image;
+    vk::DeviceMemory depth_memory;
+    auto image_result = device.createImage(image_info);
+    bool is_depth_read = image_result.result == vk::Result::eSuccess;
+    if (is_depth_read)
+    {
+        depth_image = image_result.value;
+        auto memory_result = vl::DeviceUtils::allocate_image_memory(
+            device,
+            context.m_physical_device,
+            depth_image,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::MemoryPropertyFlags());
+        depth_memory = memory_result.value;
+        is_depth_read = memory_result.result == vk::Result::eSuccess;
+    }
+    if (is_depth_read)
+    {
+        command_result = context.begin_one_time();
+        is_depth_read = command_result.result == vk::Result::eSuccess;
+    }
+    if (is_depth_read)
+    {
+        vk::ImageSubresourceRange range(vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1);
+        vk::ImageMemoryBarrier barrier;
+        barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barrier.setOldLayout(vk::ImageLayout::eUndefined);
+        barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+        barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setImage(depth_image);
+        barrier.setSubresourceRange(range);
+        command_result.value.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTopOfPipe,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            nullptr,
+            nullptr,
+            barrier);
+        command_result.value.clearDepthStencilImage(
+            depth_image,
+            vk::ImageLayout::eTransferDstOptimal,
+            vk::ClearDepthStencilValue(0.5f, 0),
+            range);
+        is_depth_read = context.end_one_time(command_result.value) == vk::Result::eSuccess;
+    }
+    if (is_depth_read)
+    {
+        vl::ReadbackQueue::Source source;
+        source.m_image = depth_image;
+        source.m_extent = vk::Extent2D(width, height);
+        source.m_format = vk::Format::eD16Unorm;
+        source.m_layout = vk::ImageLayout::eTransferDstOptimal;
+        source.m_src_stage = vk::PipelineStageFlagBits::eTransfer;
+        source.m_src_access = vk::AccessFlagBits::eTransferWrite;
+        auto future = queue.capture(source);
+        is_depth_read = future.has_value();
+        if (is_depth_read)
+        {
+            vl::ReadbackQueue::Frame frame = future->get();
+            is_depth_read = frame.m_result == vk::Result::eSuccess && frame.m_pixels.size() == static_cast<size_t>(width) * height * 2;
+            const uint16_t *depths = reinterpret_cast<const uint16_t *>(frame.m_pixels.data());
+            for (size_t i = 0; is_depth_read && i < frame.m_pixels.size() / 2; i++)
+                is_depth_read = depths[i] >= 32767 && depths[i] <= 32768;
+        }
+    }
+
+    // 未启用时间线信号量时，带时间线信号量的提交以空帧失败，而不是调用1.0设备上不存在的vkWaitSemaphores
+    bool is_rejected = false;
+    vk::CommandBufferAllocateInfo allocate_info;
+    allocate_info.setCommandPool(context.m_command_pool);
+    allocate_info.setLevel(vk::CommandBufferLevel::ePrimary);
+    allocate_info.setCommandBufferCount(1);
+    auto allocate_result = device.allocateCommandBuffers(allocate_info);
+    auto semaphore_result = device.createSemaphore(vk::SemaphoreCreateInfo());
+    if (allocate_result.result == vk::Result::eSuccess && semaphore_result.result == vk::Result::eSuccess &&
+        allocate_result.value[0].begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit)) == vk::Result::eSuccess)
+    {
+        auto future = queue.record(allocate_result.value[0], scene.get_source());
+        if (future.has_value())
+        {
+            // 命令缓冲不提交，信号量只作为句柄
+            vl::ReadbackQueue::Signal signal;
+            signal.m_timeline = semaphore_result.value;
+            signal.m_value = 1;
+            queue.submitted(signal);
+            vl::ReadbackQueue::Frame frame = future->get();
+            is_rejected = frame.m_result == vk::Result::eErrorFeatureNotPresent && frame.m_pixels.empty();
+        }
+        allocate_result.value[0].end();
+    }
+    vl::ReadbackQueue::Statistics statistics = queue.get_statistics();
+    is_rejected &= statistics.m_failed == 1;
+
+    std::cout << "readback capture " << (is_captured ? "ok" : "FAILED")
+              << ", depth " << (is_depth_read ? "ok" : "FAILED")
+              << ", timeline without feature " << (is_rejected ? "rejected" : "ACCEPTED") << std::endl;
+
+    device.waitIdle();
+    queue.destroy();
+    if (allocate_result.result == vk::Result::eSuccess)
+        device.freeCommandBuffers(context.m_command_pool, allocate_result.value);
+    if (semaphore_result.result == vk::Result::eSuccess)
+        device.destroySemaphore(semaphore_result.value);
+    if (depth_image)
+        device.destroyImage(depth_image);
+    if (depth_memory)
+        device.freeMemory(depth_memory);
+    return is_captured && is_depth_read && is_rejected;
+}
+
+/// @brief 回读基准：离屏渲染并通过ReadbackQueue回读，检查像素，报告吞吐量，并检查环满时的丢弃和等待
+int run_readback_bench(int argc, char **argv)
+{
+    uint32_t width = static_cast<uint32_t>(bench::get_option(argc, argv, "--width", 1280LL));
+    uint32_t height = static_cast<uint32_t>(bench::get_option(argc, argv, "--height", 720LL));
+    uint32_t frames = static_cast<uint32_t>(bench::get_option(argc, argv, "--frames", 120LL));
+    uint32_t ring_size = std::max(static_cast<uint32_t>(bench::get_option(argc, argv, "--ring", 3LL)), 1u);
+
+    vl::HeadlessContext::Config config;
+    config.m_name = "readback";
+    config.m_device_name = bench::get_option(argc, argv, "--device", std::string());
+    if (bench::has_flag(argc, argv, "--validation"))
+        config.m_validation_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+    vl::HeadlessContext context;
+    if (context.create(config) != vk::Result::eSuccess)
+    {
+        std::cout << "readback: skipped, unable to create headless vulkan context" << std::endl;
+        return EXIT_SUCCESS;
+    }
+    std::cout << "readback: " << context.get_device_name() << std::endl;
+
+    bool is_passed = false;
+    {
+        ReadbackScene scene(context);
+        if (scene.create(width, height))
+        {
+            is_passed = measure_readback_stream(context, scene, width, height, frames, ring_size);
+            is_passed &= check_back_pressure(context, scene, width, height, ring_size, vl::ReadbackQueue::BackPressure::eDrop);
+            is_passed &= check_back_pressure(context, scene, width, height, ring_size, vl::ReadbackQueue::BackPressure::eWait);
+            is_passed &= check_readback_paths(context, scene, width, height);
+        }
+        else
+            std::cout << "readback: failed to create offscreen target" << std::endl;
+    }
+
+    context.destroy();
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,406 @@
+#ifndef REFLECTIONBENCH_CPP
+#define REFLECTIONBENCH_CPP
+
+#include <cstring>
+#include "Bench.hpp"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/PhysicalDeviceUtils.hpp"
+#include "../src/PhysicalDeviceUtils.cpp"
+#include "../src/DefaultQueueFamilyIndices.hpp"
+#include "../src/DefaultQueueFamilyIndices.cpp"
+#include "../src/HeadlessContext.hpp"
+#include "../src/HeadlessContext.cpp"
+#include "../src/SpirvReflection.hpp"
+#include "../src/SpirvReflection.cpp"
+#include "../src/PipelineLayoutCache.hpp"
+#include "../src/PipelineLayoutCache.cpp"
+
+/// @brief 一个着色器和手写布局中与它对应的部分
+struct ReflectionCase
+{
+    struct Binding
+    {
+        uint32_t m_binding = 0;
+        vk::DescriptorType m_type = vk::DescriptorType::eSampler;
+        uint32_t m_count = 1;
+        uint32_t m_block_size = 0;
+    };
+
+    const char *m_name = "";
+    const uint32_t *m_code = nullptr;
+    size_t m_size = 0;
+    vk::ShaderStageFlagBits m_stage = vk::ShaderStageFlagBits::eVertex;
+
+    /// @brief 都在第0个集
+    std::vector<Binding> m_bindings;
+
+    uint32_t m_push_constant_size = 0;
+
+    /// @brief 第i个元素为location i的格式
+    std::vector<vk::Format> m_vertex_inputs;
+
+    std::vector<uint32_t> m_spec_constant_ids;
+};
+
+/// @brief 示例和基准中的着色器，期望的布局取自cube.cpp的prepare_descriptor_layout、CubeStressBench、
+/// GpuCuller、ClusterCuller和MipGenerator中手写的绑定，块大小按std140/std430计算
+std::vector<ReflectionCase> get_reflection_cases()
+{
+    static const uint32_t cube_vertex_code[] = {
+#include "../examples/demo/cube.vert.inc"
+    };
+    static const uint32_t cube_fragment_code[] = {
+#include "../examples/demo/cube.frag.inc"
+    };
+    static const uint32_t stress_vertex_code[] = {
+#include "shaders/stress.vert.inc"
+    };
+    static const uint32_t stress_fragment_code[] = {
+#include "shaders/stress.frag.inc"
+    };
+    static const uint32_t cull_code[] = {
+#include "shaders/cull.comp.inc"
+    };
+    static const uint32_t hiz_code[] = {
+#include "shaders/hiz.comp.inc"
+    };
+    static const uint32_t cluster_code[] = {
+#include "shaders/cluster.comp.inc"
+    };
+    static const uint32_t mip_code[] = {
+#include "shaders/mip.comp.inc"
+    };
+
+    using Type = vk::DescriptorType;
+    std::vector<ReflectionCase> cases(8);
+    // mat4 MVP; vec4 position[36]; vec4 attr[36]
+    cases[0].m_name = "cube.vert";
+    cases[0].m_code = cube_vertex_code;
+    cases[0].m_size = sizeof(cube_vertex_code);
+    cases[0].m_stage = vk::ShaderStageFlagBits::eVertex;
+    cases[0].m_bindings = {{0, Type::eUniformBuffer, 1, 64 + 36 * 16 * 2}};
+
+    cases[1].m_name = "cube.frag";
+    cases[1].m_code = cube_fragment_code;
+    cases[1].m_size = sizeof(cube_fragment_code);
+    cases[1].m_stage = vk::ShaderStageFlagBits::eFragment;
+    cases[1].m_bindings = {{1, Type::eCombinedImageSampler, 1, 0}};
+
+    cases[2].m_name = "stress.vert";
+    cases[2].m_code = stress_vertex_code;
+    cases[2].m_size = sizeof(stress_vertex_code);
+    cases[2].m_stage = vk::ShaderStageFlagBits::eVertex;
+    cases[2].m_bindings = {{0, Type::eStorageBuffer, 1, 0}};
+    cases[2].m_vertex_inputs = {vk::Format::eR32G32B32Sfloat};
+
+    cases[3].m_name = "stress.frag";
+    cases[3].m_code = stress_fragment_code;
+    cases[3].m_size = sizeof(stress_fragment_code);
+    cases[3].m_stage = vk::ShaderStageFlagBits::eFragment;
+    cases[3].m_spec_constant_ids = {0};
+
+    // mat4; vec4[6]; uint; uint; vec2
+    cases[4].m_name = "cull.comp";
+    cases[4].m_code = cull_code;
+    cases[4].m_size = sizeof(cull_code);
+    cases[4].m_stage = vk::ShaderStageFlagBits::eCompute;
+    cases[4].m_bindings = {
+        {0, Type::eUniformBuffer, 1, 176},
+        {1, Type::eStorageBuffer, 1, 0},
+        {2, Type::eStorageBuffer, 1, 0},
+        {3, Type::eStorageBuffer, 1, 4},
+        {4, Type::eCombinedImageSampler, 1, 0},
+    };
+
+    cases[5].m_name = "hiz.comp";
+    cases[5].m_code = hiz_code;
+    cases[5].m_size = sizeof(hiz_code);
+    cases[5].m_stage = vk::ShaderStageFlagBits::eCompute;
+    cases[5].m_bindings = {
+        {0, Type::eCombinedImageSampler, 1, 0},
+        {1, Type::eStorageImage, 1, 0},
+    };
+    cases[5].m_push_constant_size = sizeof(int32_t) * 4;
+
+    // mat4; vec4[6]; vec4; uint x4
+    cases[6].m_name = "cluster.comp";
+    cases[6].m_code = cluster_code;
+    cases[6].m_size = sizeof(cluster_code);
+    cases[6].m_stage = vk::ShaderStageFlagBits::eCompute;
+    cases[6].m_bindings = {
+        {0, Type::eUniformBuffer, 1, 192},
+        {1, Type::eStorageBuffer, 1, 0},
+        {2, Type::eStorageBuffer, 1, 0},
+        {3, Type::eStorageBuffer, 1, 0},
+        {4, Type::eStorageBuffer, 1, 4},
+    };
+
+    cases[7].m_name = "mip.comp";
+    cases[7].m_code = mip_code;
+    cases[7].m_size = sizeof(mip_code);
+    cases[7].m_stage = vk::ShaderStageFlagBits::eCompute;
+    cases[7].m_bindings = {
+        {0, Type::eStorageImage, 1, 0},
+        {1, Type::eStorageImage, 12, 0},
+        {2, Type::eStorageBuffer, 1, 4},
+    };
+    cases[7].m_push_constant_size = sizeof(int32_t) * 4;
+    return cases;
+}
+
+/// @brief 检查每个着色器的反射结果与手写的布局一致
+bool check_reflection_cases(const std::vector<ReflectionCase> &cases)
+{
+    bool is_passed = true;
+    for (const ReflectionCase &item : cases)
+    {
+        vl::SpirvReflection reflection;
+        bool is_matched = reflection.parse(item.m_code, item.m_size) && reflection.get_stage() == item.m_stage;
+
+        const auto &bindings = reflection.get_bindings();
+        is_matched &= bindings.size() == item.m_bindings.size();
+        for (size_t i = 0; is_matched && i < bindings.size(); i++)
+        {
+            const ReflectionCase::Binding &expected = item.m_bindings[i];
+            is_matched &= bindings[i].m_set == 0 &&
+                          bindings[i].m_binding == expected.m_binding &&
+                          bindings[i].m_type == expected.m_type &&
+                          bindings[i].m_count == expected.m_count &&
+                          bindings[i].m_block_size == expected.m_block_size &&
+                          bindings[i].m_stages == vk::ShaderStageFlags(item.m_stage);
+        }
+
+        const vl::SpirvReflection::PushConstant &push_constant = reflection.get_push_constant();
+        is_matched &= push_constant.m_size == item.m_push_constant_size &&
+                      (item.m_push_constant_size == 0 || (push_constant.m_offset == 0 && push_constant.m_stages == vk::ShaderStageFlags(item.m_stage)));
+
+        const auto &inputs = reflection.get_vertex_inputs();
+        is_matched &= inputs.size() == item.m_vertex_inputs.size();
+        for (size_t i = 0; is_matched && i < inputs.size(); i++)
+            is_matched &= inputs[i].m_location == i && inputs[i].m_format == item.m_vertex_inputs[i];
+
+        const auto &spec_constants = reflection.get_spec_constants();
+        is_matched &= spec_constants.size() == item.m_spec_constant_ids.size();
+        for (size_t i = 0; is_matched && i < spec_constants.size(); i++)
+            is_matched &= spec_constants[i].m_id == item.m_spec_constant_ids[i];
+
+        std::cout << "reflect " << item.m_name << ": " << bindings.size() << " bindings, push constant "
+                  << push_constant.m_size << " bytes, " << inputs.size() << " vertex inputs, "
+                  << spec_constants.size() << " spec constants, " << (is_matched ? "ok" : "FAILED") << std::endl;
+        if (!is_matched)
+            std::cout << "reflect " << item.m_name << " statistics:" << reflection.format();
+        is_passed &= is_matched;
+    }
+    return is_passed;
+}
+
+/// @brief 检查合并后的布局、顶点属性、特化数据和错误处理
+bool check_reflection_merge(const std::vector<ReflectionCase> &cases)
+{
+    vl::SpirvReflection cube_vertex, cube_fragment, stress_vertex, stress_fragment, hiz;
+    bool is_parsed = cube_vertex.parse(cases[0].m_code, cases[0].m_size) &&
+                     cube_fragment.parse(cases[1].m_code, cases[1].m_size) &&
+                     stress_vertex.parse(cases[2].m_code, cases[2].m_size) &&
+                     stress_fragment.parse(cases[3].m_code, cases[3].m_size) &&
+                     hiz.parse(cases[5].m_code, cases[5].m_size);
+    if (!is_parsed)
+    {
+        std::cout << "reflect merge: FAILED, unable to parse" << std::endl;
+        return false;
+    }
+
+    // 与Demo::prepare_descriptor_layout相同：一个集，没有推送常量
+    vl::PipelineLayoutCache::Layout layout;
+    bool is_cube_matched = vl::PipelineLayoutCache::merge({&cube_vertex, &cube_fragment}, layout) &&
+                           layout.m_sets.size() == 1 && layout.m_sets[0].size() == 2 &&
+                           layout.m_push_constant_ranges.empty();
+    if (is_cube_matched)
+    {
+        const vk::DescriptorSetLayoutBinding &uniform = layout.m_sets[0][0];
+        const vk::DescriptorSetLayoutBinding &texture = layout.m_sets[0][1];
+        is_cube_matched = uniform.binding == 0 && uniform.descriptorType == vk::DescriptorType::eUniformBuffer &&
+                          uniform.descriptorCount == 1 && uniform.stageFlags == vk::ShaderStageFlagBits::eVertex &&
+                          texture.binding == 1 && texture.descriptorType == vk::DescriptorType::eCombinedImageSampler &&
+                          texture.descriptorCount == 1 && texture.stageFlags == vk::ShaderStageFlagBits::eFragment;
+    }
+
+    // 同一个模块用于两个阶段时阶段取并集
+    bool is_union_matched = vl::PipelineLayoutCache::merge({&cube_vertex, &cube_vertex}, layout) &&
+                            layout.m_sets.size() == 1 && layout.m_sets[0].size() == 1 &&
+                            layout.m_sets[0][0].stageFlags == vk::ShaderStageFlagBits::eVertex;
+
+    // 顶点属性与CubeStressBench的VertexLayout相同，特化数据为默认亮度1.0
+    uint32_t stride = 0;
+    std::vector<vk::VertexInputAttributeDescription> attributes = stress_vertex.make_vertex_attributes(0, stride);
+    std::vector<uint8_t> data;
+    std::vector<vk::SpecializationMapEntry> entries = stress_fragment.make_specialization_entries(data);
+    float brightness = 0.0f;
+    if (data.size() == sizeof(float))
+        std::memcpy(&brightness, data.data(), sizeof(float));
+    bool is_stress_matched = attributes.size() == 1 && attributes[0].location == 0 && attributes[0].offset == 0 &&
+                             attributes[0].format == vk::Format::eR32G32B32Sfloat && stride == 12 &&
+                             entries.size() == 1 && entries[0].constantID == 0 && entries[0].offset == 0 &&
+                             entries[0].size == sizeof(float) && brightness == 1.0f &&
+                             stress_fragment.get_spec_constants()[0].m_type == vl::SpirvReflection::SCALAR_FLOAT;
+
+    // binding 0在立方体中是uniform缓冲，在Hi-Z中是组合图像采样器，不能合并；
+    // 错误的输入返回false并保留之前的结果
+    bool is_rejected = !vl::PipelineLayoutCache::merge({&cube_vertex, &hiz}, layout);
+    std::vector<uint32_t> broken(cases[0].m_code, cases[0].m_code + cases[0].m_size / sizeof(uint32_t));
+    broken[0] = 0;
+    is_rejected &= !cube_vertex.parse(broken.data(), broken.size() * sizeof(uint32_t));
+    broken[0] = cases[0].m_code[0];
+    broken.back() = 0xFFFF0000u | (broken.back() & 0xFFFF);
+    is_rejected &= !cube_vertex.parse(broken.data(), broken.size() * sizeof(uint32_t));
+    is_rejected &= !cube_vertex.parse(cases[0].m_code, cases[0].m_size, "other");
+    is_rejected &= !cube_vertex.parse(cases[0].m_code, cases[0].m_size - 2);
+    is_rejected &= cube_vertex.get_bindings().size() == 1 && cube_vertex.get_entry_point() == "main";
+
+    std::cout << "reflect merge: cube layout " << (is_cube_matched ? "ok" : "FAILED")
+              << ", stage union " << (is_union_matched ? "ok" : "FAILED")
+              << ", stress attributes and specialization " << (is_stress_matched ? "ok" : "FAILED")
+              << ", invalid input rejected " << (is_rejected ? "ok" : "FAILED") << std::endl;
+    return is_cube_matched && is_union_matched && is_stress_matched && is_rejected;
+}
+
+/// @brief 测量解析速度
+bool measure_reflection(const std::vector<ReflectionCase> &cases, uint32_t repeat_count)
+{
+    size_t total_size = 0;
+    for (const ReflectionCase &item : cases)
+        total_size += item.m_size;
+
+    std::vector<double> times;
+    for (uint32_t repeat = 0; repeat < repeat_count; repeat++)
+    {
+        bench::Stopwatch stopwatch;
+        for (const ReflectionCase &item : cases)
+        {
+            vl::SpirvReflection reflection;
+            reflection.parse(item.m_code, item.m_size);
+            bench::do_not_optimize(reflection.get_bindings().size());
+        }
+        times.push_back(stopwatch.seconds());
+    }
+    double median = bench::percentile(times, 0.5);
+    std::cout << "reflect parse: " << cases.size() << " modules, " << total_size << " bytes" << std::endl
+              << std::fixed << std::setprecision(2)
+              << "  " << median * 1e6 / cases.size() << " us per module, "
+              << total_size / median / (1024.0 * 1024.0) << " MiB/s" << std::defaultfloat << std::endl;
+    return true;
+}
+
+/// @brief 用反射得到的布局创建管线布局，重复获取时命中缓存，计算着色器可以用它们创建管线
+bool validate_layout_cache(int argc, char **argv, const std::vector<ReflectionCase> &cases)
+{
+    vl::HeadlessContext::Config config;
+    config.m_name = "layout cache";
+    config.m_device_name = bench::get_option(argc, argv, "--device", std::string());
+    if (bench::has_flag(argc, argv, "--validation"))
+        config.m_validation_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+    vl::HeadlessContext context;
+    if (context.create(config) != vk::Result::eSuccess)
+    {
+        std::cout << "reflect gpu: skipped, unable to create headless vulkan context" << std::endl;
+        return true;
+    }
+    const vk::Device &device = context.m_device;
+
+    std::vector<vl::SpirvReflection> reflections(cases.size());
+    bool is_passed = true;
+    for (size_t i = 0; i < cases.size(); i++)
+        is_passed &= reflections[i].parse(cases[i].m_code, cases[i].m_size);
+
+    // 立方体和压力测试各为一对顶点、片段着色器，其余为计算着色器
+    std::vector<std::vector<const vl::SpirvReflection *>> programs = {
+        {&reflections[0], &reflections[1]},
+        {&reflections[2], &reflections[3]},
+    };
+    for (size_t i = 4; i < cases.size(); i++)
+        programs.push_back({&reflections[i]});
+
+    vl::PipelineLayoutCache cache;
+    std::vector<vk::PipelineLayout> layouts;
+    bool is_cached = is_passed;
+    for (uint32_t round = 0; round < 2 && is_passed; round++)
+        for (size_t i = 0; i < programs.size(); i++)
+        {
+            auto layout_result = cache.acquire(device, programs[i]);
+            is_passed &= layout_result.result == vk::Result::eSuccess;
+            if (round == 0)
+                layouts.push_back(layout_result.value);
+            else
+                is_cached &= layouts[i] == layout_result.value;
+        }
+    is_cached &= cache.get_pipeline_layout_count() == programs.size() &&
+                 cache.get_statistics().m_pipeline_layout_hits == programs.size();
+
+    // 顺序不同的相同绑定共享集布局
+    if (is_passed)
+    {
+        const std::vector<vk::DescriptorSetLayout> &set_layouts = cache.get_set_layouts(layouts[0]);
+        std::vector<vk::DescriptorSetLayoutBinding> bindings = {
+            vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment),
+            vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eVertex),
+        };
+        auto set_layout_result = cache.acquire_set_layout(device, bindings);
+        is_cached &= set_layouts.size() == 1 && set_layout_result.result == vk::Result::eSuccess &&
+                     set_layout_result.value == set_layouts[0];
+    }
+
+    // 计算管线的布局必须与着色器相符，启用验证层时不匹配会报错
+    uint32_t pipeline_count = 0;
+    for (size_t i = 4; i < cases.size() && is_passed; i++)
+    {
+        auto module_result = vl::DeviceUtils::create_shader_module(device, cases[i].m_code, cases[i].m_size);
+        is_passed &= module_result.result == vk::Result::eSuccess;
+        if (!is_passed)
+            break;
+        vk::PipelineShaderStageCreateInfo stage_info;
+        stage_info.setStage(vk::ShaderStageFlagBits::eCompute);
+        stage_info.setModule(module_result.value);
+        stage_info.setPName(reflections[i].get_entry_point().c_str());
+        vk::ComputePipelineCreateInfo pipeline_info;
+        pipeline_info.setStage(stage_info);
+        pipeline_info.setLayout(layouts[i - 2]);
+        auto pipeline_result = device.createComputePipeline(nullptr, pipeline_info);
+        device.destroyShaderModule(module_result.value);
+        is_passed &= pipeline_result.result == vk::Result::eSuccess;
+        if (pipeline_result.result == vk::Result::eSuccess)
+        {
+            device.destroyPipeline(pipeline_result.value);
+            pipeline_count++;
+        }
+    }
+
+    std::cout << "reflect gpu: " << context.get_device_name() << ", " << programs.size() << " programs, "
+              << cache.get_pipeline_layout_count() << " pipeline layouts, " << cache.get_set_layout_count() << " set layouts, "
+              << pipeline_count << " compute pipelines" << std::endl
+              << "  created " << (is_passed ? "ok" : "FAILED") << ", cached " << (is_cached ? "ok" : "FAILED") << std::endl
+              << "reflect gpu cache statistics:" << cache.format();
+
+    cache.destroy(device);
+    context.destroy();
+    return is_passed && is_cached;
+}
+
+/// @brief SPIR-V反射基准：检查示例和基准着色器的反射结果与手写的布局一致，测量解析速度，
+/// 可选地在GPU上创建缓存的布局和计算管线
+int run_reflection_bench(int argc, char **argv)
+{
+    uint32_t repeat_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--repeat", 100LL));
+
+    std::vector<ReflectionCase> cases = get_reflection_cases();
+    bool is_passed = check_reflection_cases(cases);
+    is_passed &= check_reflection_merge(cases);
+    is_passed &= measure_reflection(cases, repeat_count);
+
+    if (!bench::has_flag(argc, argv, "--cpu-only"))
+        is_passed &= validate_layout_cache(argc, argv, cases);
+
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
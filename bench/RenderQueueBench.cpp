@@ -0,0 +1,113 @@
+#ifndef RENDERQUEUEBENCH_CPP
+#define RENDERQUEUEBENCH_CPP
+
+#include <cmath>
+#include <utility>
+#include "Bench.hpp"
+#include "../src/ThreadPool.hpp"
+#include "../src/ThreadPool.cpp"
+#include "../src/RenderQueue.hpp"
+#include "../src/RenderQueue.cpp"
+
+/// @brief 绘制队列基准：基数排序与std::sort的吞吐量，以及排序前后的状态切换次数
+int run_render_queue_bench(int argc, char **argv)
+{
+    std::vector<uint64_t> counts = bench::get_list_option(argc, argv, "--counts", "10000,100000,1000000,10000000");
+    size_t threads = static_cast<size_t>(bench::get_option(argc, argv, "--threads", 0LL));
+    int repeat = static_cast<int>(bench::get_option(argc, argv, "--repeat", 5LL));
+    uint32_t pipelines = static_cast<uint32_t>(bench::get_option(argc, argv, "--pipelines", 32LL));
+    uint32_t sets = static_cast<uint32_t>(bench::get_option(argc, argv, "--sets", 256LL));
+
+    vl::ThreadPool pool(threads);
+    std::cout << "render queue: " << pool.get_thread_count() << " worker threads, "
+              << pipelines << " pipelines, " << sets << " descriptor sets" << std::endl
+              << "       keys  std::sort ms  radix ms  radix pool ms  Mkeys/s  pipeline binds    set binds  sorted" << std::endl;
+
+    bool is_sorted = true;
+    for (uint64_t value : counts)
+    {
+        size_t count = static_cast<size_t>(value);
+        uint32_t state = static_cast<uint32_t>(count);
+        auto next = [&state]()
+        {
+            state = state * 1664525u + 1013904223u;
+            return state >> 8;
+        };
+
+        vl::RenderQueue unsorted;
+        unsorted.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t pass = next() % 4 == 0 ? 1 : 0;
+            float depth = static_cast<float>(next()) / 16777216.0f;
+            unsorted.push(vl::RenderQueue::make_key(pass, next() % pipelines, next() % sets, depth, pass == 1), static_cast<uint32_t>(i));
+        }
+
+        std::vector<double> std_ms, radix_ms, pool_ms;
+        vl::RenderQueue queue, pool_queue;
+        std::vector<std::pair<uint64_t, uint32_t>> pairs(count);
+        for (int r = 0; r < repeat; r++)
+        {
+            for (size_t i = 0; i < count; i++)
+                pairs[i] = {unsorted.get_keys()[i], unsorted.get_indices()[i]};
+            bench::Stopwatch stopwatch;
+            std::stable_sort(pairs.begin(), pairs.end(), [](const auto &a, const auto &b)
+                             { return a.first < b.first; });
+            std_ms.push_back(stopwatch.milliseconds());
+
+            // 重复使用同一个队列，和每帧重新填充一样保留临时缓冲
+            auto refill = [&unsorted, count](vl::RenderQueue &target)
+            {
+                target.clear();
+                for (size_t i = 0; i < count; i++)
+                    target.push(unsorted.get_keys()[i], unsorted.get_indices()[i]);
+            };
+            refill(queue);
+            stopwatch.reset();
+            queue.sort();
+            radix_ms.push_back(stopwatch.milliseconds());
+
+            refill(pool_queue);
+            stopwatch.reset();
+            pool_queue.sort(&pool);
+            pool_ms.push_back(stopwatch.milliseconds());
+        }
+
+        // 结果应与稳定排序完全一致
+        bool is_matching = true;
+        for (size_t i = 0; i < count && is_matching; i++)
+            is_matching = queue.get_keys()[i] == pairs[i].first && queue.get_indices()[i] == pairs[i].second &&
+                          pool_queue.get_keys()[i] == pairs[i].first && pool_queue.get_indices()[i] == pairs[i].second;
+        if (!is_matching)
+            is_sorted = false;
+
+        auto ignore = [](uint64_t, uint32_t, uint32_t) {};
+        vl::RenderQueue::Statistics before = unsorted.emit(ignore);
+        vl::RenderQueue::Statistics after = queue.emit(ignore);
+
+        double best_ms = std::min(bench::percentile(radix_ms, 50), bench::percentile(pool_ms, 50));
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(11) << count
+                  << std::setw(14) << bench::percentile(std_ms, 50)
+                  << std::setw(10) << bench::percentile(radix_ms, 50)
+                  << std::setw(15) << bench::percentile(pool_ms, 50)
+                  << std::setprecision(1)
+                  << std::setw(9) << (best_ms > 0.0 ? count / (best_ms * 1000.0) : 0.0)
+                  << std::setw(9) << before.m_pipeline_changes << " ->" << std::setw(4) << after.m_pipeline_changes
+                  << std::setw(9) << before.m_descriptor_set_changes << " ->" << std::setw(6) << after.m_descriptor_set_changes
+                  << std::setw(8) << (is_matching ? "yes" : "NO")
+                  << std::defaultfloat << std::endl;
+    }
+
+    // 超出范围的深度被截断，NaN与最远处相同
+    bool is_clamped = vl::RenderQueue::make_key(0, 0, 0, -1.0f) == vl::RenderQueue::make_key(0, 0, 0, 0.0f) &&
+                      vl::RenderQueue::make_key(0, 0, 0, INFINITY) == vl::RenderQueue::make_key(0, 0, 0, 1.0f) &&
+                      vl::RenderQueue::make_key(0, 0, 0, NAN) == vl::RenderQueue::make_key(0, 0, 0, 1.0f) &&
+                      vl::RenderQueue::make_key(0, 0, 0, NAN, true) == vl::RenderQueue::make_key(0, 0, 0, 1.0f, true);
+
+    std::cout << (is_sorted ? "  all results match std::stable_sort" : "  MISMATCH")
+              << (is_clamped ? ", out of range depths clamped" : ", out of range depths NOT CLAMPED") << std::endl;
+    return is_sorted && is_clamped ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,416 @@
+#ifndef SHADERLIBRARYBENCH_CPP
+#define SHADERLIBRARYBENCH_CPP
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "Bench.hpp"
+#include "ReflectionBench.cpp"
+#include "../src/MappedFile.hpp"
+#include "../src/MappedFile.cpp"
+#include "../src/ShaderArchive.hpp"
+#include "../src/ShaderArchive.cpp"
+#include "../src/ShaderLibrary.hpp"
+#include "../src/ShaderLibrary.cpp"
+
+/// @brief 统计调试指令的数量，与ShaderArchive::strip去掉的指令相同
+uint32_t count_debug_instructions(const std::vector<uint32_t> &code)
+{
+    uint32_t count = 0;
+    for (size_t i = 5; i < code.size() && (code[i] >> 16) != 0; i += code[i] >> 16)
+    {
+        uint32_t opcode = code[i] & 0xFFFF;
+        if ((opcode >= 2 && opcode <= 8) || opcode == 317 || opcode == 330 || opcode == 4433)
+            count++;
+    }
+    return count;
+}
+
+/// @brief 比较反射结果，名称除外
+bool is_reflection_equal(const vl::SpirvReflection &a, const vl::SpirvReflection &b)
+{
+    bool is_equal = a.get_stage() == b.get_stage() && a.get_entry_point() == b.get_entry_point() &&
+                    a.get_bindings().size() == b.get_bindings().size() &&
+                    a.get_push_constant().m_size == b.get_push_constant().m_size &&
+                    a.get_vertex_inputs().size() == b.get_vertex_inputs().size() &&
+                    a.get_spec_constants().size() == b.get_spec_constants().size();
+    for (size_t i = 0; is_equal && i < a.get_bindings().size(); i++)
+    {
+        const vl::SpirvReflection::Binding &x = a.get_bindings()[i];
+        const vl::SpirvReflection::Binding &y = b.get_bindings()[i];
+        is_equal &= x.m_set == y.m_set && x.m_binding == y.m_binding && x.m_type == y.m_type &&
+                    x.m_count == y.m_count && x.m_block_size == y.m_block_size && x.m_stages == y.m_stages;
+    }
+    for (size_t i = 0; is_equal && i < a.get_vertex_inputs().size(); i++)
+        is_equal &= a.get_vertex_inputs()[i].m_location == b.get_vertex_inputs()[i].m_location &&
+                    a.get_vertex_inputs()[i].m_format == b.get_vertex_inputs()[i].m_format;
+    for (size_t i = 0; is_equal && i < a.get_spec_constants().size(); i++)
+        is_equal &= a.get_spec_constants()[i].m_id == b.get_spec_constants()[i].m_id &&
+                    a.get_spec_constants()[i].m_type == b.get_spec_constants()[i].m_type;
+    return is_equal;
+}
+
+/// @brief 去掉调试信息后变小、不含调试指令、再次去掉不变，反射结果除名称外与原来相同
+bool check_shader_strip(const std::vector<ReflectionCase> &cases)
+{
+    bool is_passed = true;
+    size_t total_size = 0, total_stripped_size = 0;
+    for (const ReflectionCase &item : cases)
+    {
+        std::vector<uint32_t> stripped = vl::ShaderArchive::strip(item.m_code, item.m_size);
+        size_t stripped_size = stripped.size() * sizeof(uint32_t);
+        bool is_matched = !stripped.empty() && stripped_size < item.m_size && count_debug_instructions(stripped) == 0 &&
+                          vl::ShaderArchive::strip(stripped.data(), stripped_size) == stripped;
+
+        vl::SpirvReflection original, reflection;
+        is_matched &= original.parse(item.m_code, item.m_size) && reflection.parse(stripped.data(), stripped_size) &&
+                      is_reflection_equal(original, reflection);
+
+        std::cout << "shaderlib strip " << item.m_name << ": " << item.m_size << " -> " << stripped_size
+                  << " bytes, " << (is_matched ? "ok" : "FAILED") << std::endl;
+        total_size += item.m_size;
+        total_stripped_size += stripped_size;
+        is_passed &= is_matched;
+    }
+
+    // NonSemantic调试信息的前向引用使用OpExtInstWithForwardRefsKHR，与它需要的拓展一起去掉
+    std::vector<uint32_t> forward(cases[0].m_code, cases[0].m_code + 5);
+    auto append_string = [&](uint32_t opcode, uint32_t operand, const std::string &text)
+    {
+        size_t word_count = text.size() / sizeof(uint32_t) + 1;
+        forward.push_back(static_cast<uint32_t>(1 + (operand != 0) + word_count) << 16 | opcode);
+        if (operand != 0)
+            forward.push_back(operand);
+        forward.resize(forward.size() + word_count, 0);
+        std::memcpy(forward.data() + forward.size() - word_count, text.data(), text.size());
+    };
+    append_string(10, 0, "SPV_KHR_relaxed_extended_instruction");
+    append_string(11, 0x7FFFFF, "NonSemantic.Shader.DebugInfo.100");
+    forward.insert(forward.end(), {5u << 16 | 4433, 1, 0x7FFFFE, 0x7FFFFF, 1});
+    forward.insert(forward.end(), cases[0].m_code + 5, cases[0].m_code + cases[0].m_size / sizeof(uint32_t));
+    bool is_forward_stripped = vl::ShaderArchive::strip(forward.data(), forward.size() * sizeof(uint32_t)) ==
+                               vl::ShaderArchive::strip(cases[0].m_code, cases[0].m_size);
+    std::cout << "shaderlib strip forward references: " << (is_forward_stripped ? "ok" : "FAILED") << std::endl;
+    is_passed &= is_forward_stripped;
+
+    // 无效的输入返回空
+    std::vector<uint32_t> broken(cases[0].m_code, cases[0].m_code + cases[0].m_size / sizeof(uint32_t));
+    bool is_rejected = vl::ShaderArchive::strip(broken.data(), broken.size() * sizeof(uint32_t) - 2).empty();
+    broken.back() = 0xFFFF0000u | (broken.back() & 0xFFFF);
+    is_rejected &= vl::ShaderArchive::strip(broken.data(), broken.size() * sizeof(uint32_t)).empty();
+    broken[0] = 0;
+    is_rejected &= vl::ShaderArchive::strip(broken.data(), broken.size() * sizeof(uint32_t)).empty();
+
+    std::cout << "shaderlib strip: " << total_size << " -> " << total_stripped_size << " bytes ("
+              << std::fixed << std::setprecision(1) << (1.0 - static_cast<double>(total_stripped_size) / total_size) * 100.0
+              << "% removed)" << std::defaultfloat << ", invalid inputs " << (is_rejected ? "rejected" : "ACCEPTED") << std::endl;
+    return is_passed && is_rejected;
+}
+
+/// @brief 写入打包的着色器文件，多写一个与cube.vert内容相同的条目
+bool write_shader_archive(const std::string &path, const std::vector<ReflectionCase> &cases, bool is_stripped)
+{
+    std::vector<vl::ShaderArchive::Source> sources;
+    for (const ReflectionCase &item : cases)
+        sources.push_back({item.m_name, item.m_code, item.m_size});
+    sources.push_back({"cube_copy.vert", cases[0].m_code, cases[0].m_size});
+    return vl::ShaderArchive::write(path, sources, is_stripped);
+}
+
+/// @brief 检查打包的着色器文件的内容、重复内容的共享和错误处理
+bool check_shader_archive(const std::string &path, const std::vector<ReflectionCase> &cases)
+{
+    bool is_passed = true;
+    vl::ShaderArchive mapped, read;
+    bool is_valid = mapped.open(path, vl::ShaderArchive::Mode::eMap) &&
+                    read.open(path, vl::ShaderArchive::Mode::eRead) &&
+                    mapped.get_header().m_entry_count == cases.size() + 1 &&
+                    (mapped.get_header().m_flags & vl::ShaderArchive::FLAG_STRIPPED) != 0;
+    for (size_t i = 0; is_valid && i < cases.size(); i++)
+    {
+        std::vector<uint32_t> stripped = vl::ShaderArchive::strip(cases[i].m_code, cases[i].m_size);
+        const vl::ShaderArchive::Entry *entry = mapped.find(cases[i].m_name);
+        const vl::ShaderArchive::Entry *other = read.find(cases[i].m_name);
+        is_valid = entry != nullptr && other != nullptr &&
+                   entry->m_size == stripped.size() * sizeof(uint32_t) &&
+                   entry->m_hash == vl::ShaderArchive::hash(stripped.data(), entry->m_size) &&
+                   entry->m_source_size == cases[i].m_size &&
+                   entry->m_source_hash == vl::ShaderArchive::hash(cases[i].m_code, cases[i].m_size) &&
+                   std::memcmp(mapped.get_code(*entry), stripped.data(), entry->m_size) == 0 &&
+                   std::memcmp(read.get_code(*other), stripped.data(), entry->m_size) == 0;
+    }
+    const vl::ShaderArchive::Entry *copy = is_valid ? mapped.find("cube_copy.vert") : nullptr;
+    const vl::ShaderArchive::Entry *original = is_valid ? mapped.find("cube.vert") : nullptr;
+    bool is_shared = copy != nullptr && original != nullptr &&
+                     copy->m_offset == original->m_offset && copy->m_hash == original->m_hash;
+    is_valid &= mapped.find("missing.vert") == nullptr && mapped.find("") == nullptr;
+    std::cout << "shaderlib archive: " << (is_valid ? mapped.get_header().m_entry_count : 0) << " entries, mmap and read() "
+              << (is_valid ? "match" : "MISMATCH") << ", duplicate content " << (is_shared ? "shared" : "NOT SHARED") << std::endl;
+    is_passed &= is_valid && is_shared;
+
+    // 损坏的文件必须被拒绝
+    std::ifstream fin(path, std::ios::binary);
+    std::vector<uint8_t> original_data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+    std::vector<uint64_t> storage((original_data.size() + 7) / 8);
+    auto check = [&](const char *name, size_t size, auto corrupt)
+    {
+        std::memcpy(storage.data(), original_data.data(), original_data.size());
+        uint8_t *bytes = reinterpret_cast<uint8_t *>(storage.data());
+        corrupt(reinterpret_cast<vl::ShaderArchive::Header *>(bytes), reinterpret_cast<vl::ShaderArchive::Entry *>(bytes + sizeof(vl::ShaderArchive::Header)));
+        vl::ShaderArchive archive;
+        bool is_rejected = !archive.open_memory(bytes, size);
+        std::cout << "  " << std::setw(24) << name << (is_rejected ? "  rejected" : "  ACCEPTED") << std::endl;
+        is_passed &= is_rejected;
+    };
+    std::cout << "shaderlib archive: corrupted inputs" << std::endl;
+    check("truncated header", 8, [](auto *, auto *) {});
+    check("truncated code", original_data.size() - 4, [](auto *, auto *) {});
+    check("bad magic", original_data.size(), [](auto *header, auto *)
+          { header->m_magic = 0; });
+    check("bad version", original_data.size(), [](auto *header, auto *)
+          { header->m_version = vl::ShaderArchive::VERSION + 1; });
+    check("too many entries", original_data.size(), [](auto *header, auto *)
+          { header->m_entry_count = 1000; });
+    check("unsorted names", original_data.size(), [](auto *, auto *entries)
+          { std::swap(entries[0].m_name, entries[1].m_name); });
+    check("unterminated name", original_data.size(), [](auto *, auto *entries)
+          { std::memset(entries[0].m_name, 'a', vl::ShaderArchive::MAX_NAME_LENGTH); });
+    check("misaligned offset", original_data.size(), [](auto *, auto *entries)
+          { entries[0].m_offset += 4; });
+    check("not spir-v", original_data.size(), [&](auto *, auto *entries)
+          { reinterpret_cast<uint8_t *>(storage.data())[entries[0].m_offset] ^= 0xFF; });
+    return is_passed;
+}
+
+/// @brief 测量每次读取.spv文件到std::vector<uint32_t>（SFML示例的做法）与从映射的打包文件查找的耗时，以及哈希的速度
+bool measure_shader_loads(const std::string &directory, const std::string &archive_path, const std::vector<ReflectionCase> &cases, uint32_t load_count)
+{
+    std::vector<std::string> paths;
+    for (const ReflectionCase &item : cases)
+    {
+        paths.push_back(directory + "/" + item.m_name + ".spv");
+        std::ofstream fout(paths.back(), std::ios::binary);
+        fout.write(reinterpret_cast<const char *>(item.m_code), static_cast<std::streamsize>(item.m_size));
+    }
+
+    bench::Stopwatch stopwatch;
+    size_t read_size = 0;
+    for (uint32_t i = 0; i < load_count; i++)
+    {
+        std::ifstream fin(paths[i % paths.size()], std::ios::binary | std::ios::ate);
+        std::vector<uint32_t> buffer(static_cast<size_t>(fin.tellg()) / sizeof(uint32_t));
+        fin.seekg(0);
+        fin.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(uint32_t)));
+        read_size += buffer.size() * sizeof(uint32_t);
+        bench::do_not_optimize(buffer.data());
+    }
+    double read_time = stopwatch.seconds();
+
+    stopwatch.reset();
+    vl::ShaderArchive archive;
+    bool is_passed = archive.open(archive_path);
+    double open_time = stopwatch.seconds();
+    stopwatch.reset();
+    size_t mapped_size = 0;
+    for (uint32_t i = 0; i < load_count && is_passed; i++)
+    {
+        const vl::ShaderArchive::Entry *entry = archive.find(cases[i % cases.size()].m_name);
+        is_passed &= entry != nullptr;
+        if (entry == nullptr)
+            break;
+        mapped_size += static_cast<size_t>(entry->m_size);
+        bench::do_not_optimize(archive.get_code(*entry));
+    }
+    double find_time = stopwatch.seconds();
+
+    // 命中时只需要哈希
+    stopwatch.reset();
+    size_t hash_size = 0;
+    for (uint32_t i = 0; i < load_count; i++)
+    {
+        const ReflectionCase &item = cases[i % cases.size()];
+        bench::do_not_optimize(vl::ShaderArchive::hash(item.m_code, item.m_size));
+        hash_size += item.m_size;
+    }
+    double hash_time = stopwatch.seconds();
+
+    std::cout << "shaderlib loads: " << load_count << " loads" << std::endl
+              << std::fixed << std::setprecision(2)
+              << "  .spv read    " << read_time * 1e6 / load_count << " us per load, " << read_size << " bytes copied" << std::endl
+              << "  archive find " << find_time * 1e6 / load_count << " us per load after " << open_time * 1e3
+              << " ms open, " << mapped_size << " bytes mapped, 0 copied" << std::endl
+              << "  hash         " << hash_size / std::max(hash_time, 1e-9) / (1024.0 * 1024.0) << " MiB/s" << std::defaultfloat << std::endl;
+
+    archive.close();
+    for (const std::string &path : paths)
+        std::remove(path.c_str());
+    return is_passed;
+}
+
+/// @brief 每个材质的管线需要一对顶点、片段着色器；直接创建时每个管线各创建两个模块，
+/// 使用着色器库时相同内容只创建一次
+bool validate_shader_library(int argc, char **argv, const std::string &archive_path, const std::vector<ReflectionCase> &cases)
+{
+    uint32_t pipeline_count = std::max(static_cast<uint32_t>(bench::get_option(argc, argv, "--pipelines", 64LL)), 1u);
+    uint32_t repeat_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--repeat", 100LL));
+
+    vl::HeadlessContext::Config config;
+    config.m_name = "shader library";
+    config.m_device_name = bench::get_option(argc, argv, "--device", std::string());
+    if (bench::has_flag(argc, argv, "--validation"))
+        config.m_validation_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+    vl::HeadlessContext context;
+    if (context.create(config) != vk::Result::eSuccess)
+    {
+        std::cout << "shaderlib gpu: skipped, unable to create headless vulkan context" << std::endl;
+        return true;
+    }
+    const vk::Device &device = context.m_device;
+
+    // 材质交替使用立方体和压力测试的着色器
+    auto get_program = [&](uint32_t material, uint32_t stage) -> const ReflectionCase &
+    { return cases[(material % 2) * 2 + stage]; };
+
+    // 直接创建，每个材质各创建一对模块
+    bool is_passed = true;
+    uint32_t direct_count = 0;
+    size_t direct_size = 0;
+    bench::Stopwatch stopwatch;
+    for (uint32_t material = 0; material < pipeline_count && is_passed; material++)
+        for (uint32_t stage = 0; stage < 2; stage++)
+        {
+            const ReflectionCase &item = get_program(material, stage);
+            auto module_result = vl::DeviceUtils::create_shader_module(device, item.m_code, item.m_size);
+            is_passed &= module_result.result == vk::Result::eSuccess;
+            if (module_result.result != vk::Result::eSuccess)
+                break;
+            device.destroyShaderModule(module_result.value);
+            direct_count++;
+            direct_size += item.m_size;
+        }
+    double direct_time = stopwatch.seconds();
+
+    // 按内容获取，去掉调试信息
+    vl::ShaderLibrary library;
+    library.create(true);
+    std::vector<vk::ShaderModule> modules;
+    stopwatch.reset();
+    for (uint32_t material = 0; material < pipeline_count && is_passed; material++)
+        for (uint32_t stage = 0; stage < 2; stage++)
+        {
+            const ReflectionCase &item = get_program(material, stage);
+            auto module_result = library.acquire(device, item.m_code, item.m_size);
+            is_passed &= module_result.result == vk::Result::eSuccess;
+            modules.push_back(module_result.value);
+        }
+    double library_time = stopwatch.seconds();
+    uint32_t expected_count = std::min(pipeline_count, 2u) * 2;
+    bool is_cached = is_passed && library.get_size() == expected_count &&
+                     library.get_statistics().m_modules_created == expected_count &&
+                     library.get_ref_count(modules[0]) == (pipeline_count + 1) / 2 &&
+                     library.get_ref_count(vk::ShaderModule()) == 0;
+    std::cout << "shaderlib gpu startup (by content):" << library.format();
+
+    // 释放后保留在缓存中，trim时销毁
+    for (const vk::ShaderModule &module : modules)
+        library.release(module);
+    is_cached &= library.get_size() == expected_count && library.trim(device) == expected_count && library.get_size() == 0;
+
+    // 从映射的打包文件获取，内容已去掉调试信息，相同内容的条目以及按内容获取的相同代码共享模块
+    vl::ShaderLibrary archive_library;
+    archive_library.create(true);
+    is_passed &= archive_library.open_archive(archive_path);
+    modules.clear();
+    stopwatch.reset();
+    for (uint32_t material = 0; material < pipeline_count && is_passed; material++)
+        for (uint32_t stage = 0; stage < 2; stage++)
+        {
+            auto module_result = archive_library.acquire(device, std::string(get_program(material, stage).m_name));
+            is_passed &= module_result.result == vk::Result::eSuccess;
+            modules.push_back(module_result.value);
+        }
+    double archive_time = stopwatch.seconds();
+    if (is_passed)
+    {
+        auto copy_result = archive_library.acquire(device, std::string("cube_copy.vert"));
+        is_cached &= copy_result.result == vk::Result::eSuccess && copy_result.value == modules[0] &&
+                     archive_library.get_size() == expected_count &&
+                     archive_library.get_statistics().m_bytes_stripped == 0 &&
+                     archive_library.get_statistics().m_bytes_parsed == library.get_statistics().m_bytes_parsed;
+        // 按名称和按内容获取的键都是原始内容的哈希，共享同一个模块
+        auto content_result = archive_library.acquire(device, cases[0].m_code, cases[0].m_size);
+        is_cached &= content_result.result == vk::Result::eSuccess && content_result.value == modules[0] &&
+                     archive_library.get_size() == expected_count && archive_library.get_statistics().m_bytes_stripped == 0;
+        is_cached &= archive_library.acquire(device, std::string("missing.vert")).result == vk::Result::eErrorUnknown;
+    }
+    std::cout << "shaderlib gpu startup (by name):" << archive_library.format();
+
+    // 驱动解析原始代码和去掉调试信息后代码的耗时
+    double original_time = 0.0, stripped_time = 0.0;
+    size_t original_size = 0, stripped_size = 0;
+    for (const ReflectionCase &item : cases)
+    {
+        std::vector<uint32_t> stripped = vl::ShaderArchive::strip(item.m_code, item.m_size);
+        std::vector<double> original_times, stripped_times;
+        for (uint32_t repeat = 0; repeat < repeat_count && is_passed; repeat++)
+        {
+            stopwatch.reset();
+            auto original_result = vl::DeviceUtils::create_shader_module(device, item.m_code, item.m_size);
+            original_times.push_back(stopwatch.seconds());
+            stopwatch.reset();
+            auto stripped_result = vl::DeviceUtils::create_shader_module(device, stripped.data(), stripped.size() * sizeof(uint32_t));
+            stripped_times.push_back(stopwatch.seconds());
+            is_passed &= original_result.result == vk::Result::eSuccess && stripped_result.result == vk::Result::eSuccess;
+            device.destroyShaderModule(original_result.value);
+            device.destroyShaderModule(stripped_result.value);
+        }
+        original_time += bench::percentile(original_times, 50.0);
+        stripped_time += bench::percentile(stripped_times, 50.0);
+        original_size += item.m_size;
+        stripped_size += stripped.size() * sizeof(uint32_t);
+    }
+
+    std::cout << "shaderlib gpu: " << context.get_device_name() << ", " << pipeline_count << " pipelines" << std::endl
+              << std::fixed << std::setprecision(2)
+              << "  direct     " << direct_count << " modules, " << direct_size << " bytes parsed, " << direct_time * 1e3 << " ms" << std::endl
+              << "  by content " << library.get_statistics().m_modules_created << " modules, " << library.get_statistics().m_bytes_parsed
+              << " bytes parsed, " << library_time * 1e3 << " ms" << std::endl
+              << "  by name    " << archive_library.get_statistics().m_modules_created << " modules, " << archive_library.get_statistics().m_bytes_parsed
+              << " bytes parsed, " << archive_time * 1e3 << " ms" << std::endl
+              << "  create module (median, all shaders): original " << original_size << " bytes " << original_time * 1e6
+              << " us, stripped " << stripped_size << " bytes " << stripped_time * 1e6 << " us" << std::defaultfloat << std::endl
+              << "  created " << (is_passed ? "ok" : "FAILED") << ", cached " << (is_cached ? "ok" : "FAILED") << std::endl;
+
+    library.destroy(device);
+    archive_library.destroy(device);
+    context.destroy();
+    return is_passed && is_cached;
+}
+
+/// @brief 着色器库基准：检查去掉调试信息和打包的着色器文件，比较读取.spv文件和映射打包文件的耗时，
+/// 可选地在GPU上比较直接创建和通过着色器库创建的模块数和解析的字节数
+int run_shader_library_bench(int argc, char **argv)
+{
+    std::string directory = bench::get_option(argc, argv, "--dir", std::string("."));
+    uint32_t load_count = std::max(static_cast<uint32_t>(bench::get_option(argc, argv, "--pipelines", 64LL)), 1u) * 2;
+    const std::string archive_path = directory + "/shader_bench.vlsa";
+
+    std::vector<ReflectionCase> cases = get_reflection_cases();
+    bool is_passed = check_shader_strip(cases);
+    if (!write_shader_archive(archive_path, cases, true))
+    {
+        std::cout << "failed to write " << archive_path << std::endl;
+        return EXIT_FAILURE;
+    }
+    is_passed &= check_shader_archive(archive_path, cases);
+    is_passed &= measure_shader_loads(directory, archive_path, cases, load_count);
+
+    if (!bench::has_flag(argc, argv, "--cpu-only"))
+        is_passed &= validate_shader_library(argc, argv, archive_path, cases);
+
+    std::remove(archive_path.c_str());
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
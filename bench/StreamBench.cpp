@@ -0,0 +1,456 @@
+#ifndef STREAMBENCH_CPP
+#define STREAMBENCH_CPP
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include "Bench.hpp"
+#include "EncoderBench.cpp"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/PhysicalDeviceUtils.hpp"
+#include "../src/PhysicalDeviceUtils.cpp"
+#include "../src/DefaultQueueFamilyIndices.hpp"
+#include "../src/DefaultQueueFamilyIndices.cpp"
+#include "../src/HeadlessContext.hpp"
+#include "../src/HeadlessContext.cpp"
+#include "../src/MappedBuffer.hpp"
+#include "../src/MappedBuffer.cpp"
+#include "../src/StagingRing.hpp"
+#include "../src/StagingRing.cpp"
+#include "../src/MappedFile.hpp"
+#include "../src/MappedFile.cpp"
+#include "../src/Deflate.hpp"
+#include "../src/Deflate.cpp"
+#include "../src/Ktx2File.hpp"
+#include "../src/Ktx2File.cpp"
+#include "../src/MipGenerator.hpp"
+#include "../src/MipGenerator.cpp"
+#include "../src/TextureStreamer.hpp"
+#include "../src/TextureStreamer.cpp"
+
+/// @brief 合成的访问序列
+enum class StreamTrace
+{
+    /// @brief 沿走廊前进，两侧的纹理由远及近，需求级别随距离变化
+    eCorridor,
+    /// @brief 每帧按Zipf分布抽取纹理，少数纹理被频繁使用
+    eZipf,
+    /// @brief 与走廊相同，中途其他用途占用一半预算，之后恢复
+    ePressure,
+};
+
+/// @brief 一次模拟的结果
+struct StreamSimulation
+{
+    vl::TextureStreamer::Statistics m_statistics;
+
+    /// @brief 每帧update的耗时，微秒
+    std::vector<double> m_update_us;
+
+    /// @brief 使用中的纹理平均缺少的级数
+    double m_average_deficit = 0.0;
+
+    /// @brief 使用中的纹理全部达到需求级别的帧的比例
+    double m_hit_rate = 0.0;
+
+    /// @brief 本帧使用的纹理被淘汰到需求级别以下的次数
+    uint32_t m_eviction_violations = 0;
+
+    /// @brief 需求放得进预算时，超出预算持续超过延迟的帧数
+    uint32_t m_budget_violations = 0;
+
+    /// @brief 需求放得进预算时，最后是否全部达到需求级别
+    bool m_is_converged = true;
+    bool m_fits = true;
+};
+
+/// @brief 生成一帧的需求级别，未使用的纹理为NO_LEVEL
+void make_stream_requests(
+    StreamTrace trace,
+    uint64_t frame,
+    uint64_t frame_count,
+    const std::vector<vl::TextureStreamer::Description> &descriptions,
+    const std::vector<uint32_t> &ranks,
+    const std::vector<double> &zipf,
+    std::mt19937 &random,
+    std::vector<uint32_t> &levels)
+{
+    std::fill(levels.begin(), levels.end(), vl::TextureStreamer::NO_LEVEL);
+    uint32_t count = static_cast<uint32_t>(descriptions.size());
+    if (trace == StreamTrace::eZipf)
+    {
+        // 每个纹理的屏幕尺寸固定，需求不随抽样抖动
+        for (int i = 0; i < 48; i++)
+        {
+            double sample = std::uniform_real_distribution<double>(0.0, 1.0)(random);
+            size_t rank = std::lower_bound(zipf.begin(), zipf.end(), sample) - zipf.begin();
+            uint32_t index = ranks[std::min(rank, ranks.size() - 1)];
+            const vl::TextureStreamer::Description &description = descriptions[index];
+            uint32_t hash = index * 2654435761u;
+            float extent = static_cast<float>(32u << ((hash >> 29) % 6));
+            uint32_t level = vl::TextureStreamer::compute_level(description.m_width, description.m_height, extent);
+            levels[index] = std::min(level, static_cast<uint32_t>(description.m_level_sizes.size() - 1));
+        }
+        return;
+    }
+
+    // 纹理每隔一个单位贴在走廊两侧，视距32个单位，屏幕高1080像素
+    double camera = static_cast<double>(frame) / static_cast<double>(frame_count) * count / 2.0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        double distance = i / 2 - camera + 1.0;
+        if (distance <= 0.0 || distance > 32.0)
+            continue;
+        const vl::TextureStreamer::Description &description = descriptions[i];
+        uint32_t level = vl::TextureStreamer::compute_level(description.m_width, description.m_height, static_cast<float>(1080.0 / distance));
+        levels[i] = std::min(level, static_cast<uint32_t>(description.m_level_sizes.size() - 1));
+    }
+}
+
+/// @brief 在CPU上模拟流式加载，提交在latency帧后完成
+StreamSimulation simulate_texture_streaming(
+    StreamTrace trace,
+    const std::vector<vl::TextureStreamer::Description> &descriptions,
+    uint64_t frame_count,
+    uint64_t settle_count,
+    vk::DeviceSize budget,
+    vk::DeviceSize upload_budget,
+    uint64_t latency,
+    uint32_t seed)
+{
+    StreamSimulation simulation;
+    uint32_t count = static_cast<uint32_t>(descriptions.size());
+
+    vl::TextureStreamer streamer;
+    vl::TextureStreamer::Config config;
+    config.m_texture_count = count;
+    config.m_upload_budget = upload_budget;
+    streamer.create(config);
+    for (const vl::TextureStreamer::Description &description : descriptions)
+        streamer.add(description);
+
+    std::vector<std::vector<vk::DeviceSize>> suffix_sizes;
+    for (const vl::TextureStreamer::Description &description : descriptions)
+    {
+        std::vector<vk::DeviceSize> sizes(description.m_level_sizes.size() + 1, 0);
+        for (size_t level = description.m_level_sizes.size(); level > 0; level--)
+            sizes[level - 1] = sizes[level] + description.m_level_sizes[level - 1];
+        suffix_sizes.push_back(std::move(sizes));
+    }
+
+    std::mt19937 random(seed);
+    std::vector<uint32_t> ranks(count);
+    for (uint32_t i = 0; i < count; i++)
+        ranks[i] = i;
+    std::shuffle(ranks.begin(), ranks.end(), random);
+    std::vector<double> zipf(count);
+    double sum = 0.0;
+    for (uint32_t i = 0; i < count; i++)
+        zipf[i] = sum += 1.0 / (i + 1);
+    for (double &value : zipf)
+        value /= sum;
+
+    std::vector<uint32_t> levels(count, vl::TextureStreamer::NO_LEVEL);
+    double deficit = 0.0;
+    uint64_t used_count = 0, hit_frames = 0, over_budget_frames = 0;
+    bench::Stopwatch stopwatch;
+    for (uint64_t frame = 1; frame <= frame_count + settle_count; frame++)
+    {
+        // 结束后保持最后一帧的视角，检查是否收敛
+        if (frame <= frame_count)
+            make_stream_requests(trace, frame, frame_count, descriptions, ranks, zipf, random, levels);
+        vk::DeviceSize frame_budget = budget;
+        if (trace == StreamTrace::ePressure && frame > frame_count / 2 && frame <= frame_count * 3 / 4)
+            frame_budget = budget / 2;
+
+        streamer.submit_feedback(levels.data(), count, frame);
+        stopwatch.reset();
+        std::vector<vl::TextureStreamer::Change> changes = streamer.update(frame, frame_budget);
+        simulation.m_update_us.push_back(stopwatch.seconds() * 1e6);
+
+        for (const vl::TextureStreamer::Change &change : changes)
+            if (change.m_old_level != vl::TextureStreamer::NO_LEVEL && change.m_new_level > change.m_old_level &&
+                levels[change.m_texture] != vl::TextureStreamer::NO_LEVEL &&
+                change.m_new_level > streamer.get_requested_level(change.m_texture))
+                simulation.m_eviction_violations++;
+
+        // 本帧最少需要的字节数：使用的纹理到需求级别，其余只有尾部
+        vk::DeviceSize floor = 0;
+        for (uint32_t i = 0; i < count; i++)
+            floor += suffix_sizes[i][levels[i] != vl::TextureStreamer::NO_LEVEL ? streamer.get_requested_level(i) : streamer.get_tail_level(i)];
+        bool fits = floor <= frame_budget;
+        over_budget_frames = fits && streamer.get_statistics().m_usage > frame_budget ? over_budget_frames + 1 : 0;
+        if (over_budget_frames > latency + 1)
+            simulation.m_budget_violations++;
+
+        streamer.submitted(frame);
+        if (frame > latency)
+            streamer.retire(frame - latency, vk::Device());
+        streamer.take_published();
+
+        bool is_hit = true;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (levels[i] == vl::TextureStreamer::NO_LEVEL)
+                continue;
+            uint32_t resident = streamer.get_resident_level(i);
+            uint32_t requested = streamer.get_requested_level(i);
+            if (resident == vl::TextureStreamer::NO_LEVEL)
+                resident = streamer.get_level_count(i);
+            if (resident > requested)
+            {
+                deficit += resident - requested;
+                is_hit = false;
+            }
+            used_count++;
+        }
+        hit_frames += is_hit ? 1 : 0;
+
+        if (frame == frame_count + settle_count)
+        {
+            simulation.m_fits = fits;
+            simulation.m_is_converged = is_hit;
+        }
+    }
+
+    simulation.m_statistics = streamer.get_statistics();
+    simulation.m_average_deficit = used_count > 0 ? deficit / used_count : 0.0;
+    simulation.m_hit_rate = static_cast<double>(hit_frames) / static_cast<double>(frame_count + settle_count);
+    streamer.destroy(vk::Device());
+    return simulation;
+}
+
+/// @brief 读回图像的第0级并与期望比较，图像处于ShaderReadOnlyOptimal
+bool check_streamed_image(
+    vl::HeadlessContext &context,
+    vl::MappedBuffer &readback,
+    const vk::Image &image,
+    uint32_t width,
+    uint32_t height,
+    const std::vector<uint8_t> &expected)
+{
+    auto command_result = context.begin_one_time(false);
+    if (command_result.result != vk::Result::eSuccess)
+        return false;
+    vk::CommandBuffer cmd = command_result.value;
+
+    vk::ImageMemoryBarrier barrier;
+    barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderRead);
+    barrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+    barrier.setOldLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+    barrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
+    barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+    barrier.setImage(image);
+    barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, nullptr, barrier);
+    vk::BufferImageCopy copy;
+    copy.setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1));
+    copy.setImageExtent(vk::Extent3D(width, height, 1));
+    cmd.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, readback.m_buffer, copy);
+    barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferRead);
+    barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+    barrier.setOldLayout(vk::ImageLayout::eTransferSrcOptimal);
+    barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, vk::DependencyFlags(), nullptr, nullptr, barrier);
+    vk::MemoryBarrier host_barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), host_barrier, nullptr, nullptr);
+
+    if (context.end_one_time(cmd, false) != vk::Result::eSuccess ||
+        readback.invalidate(context.m_device) != vk::Result::eSuccess)
+        return false;
+    return std::memcmp(readback.data<uint8_t>(), expected.data(), expected.size()) == 0;
+}
+
+/// @brief 在GPU上流式加载几个KTX2文件：逐步加载到第0级后读回比较，再降低预算淘汰到第2级并检查复制保留的级别；无法创建Vulkan环境时跳过
+bool validate_texture_streamer(int argc, char **argv, const std::string &directory)
+{
+    vl::HeadlessContext::Config config;
+    config.m_name = "texture streaming";
+    config.m_device_name = bench::get_option(argc, argv, "--device", std::string());
+    config.m_device_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (bench::has_flag(argc, argv, "--validation"))
+        config.m_validation_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+    vl::HeadlessContext context;
+    if (context.create(config) != vk::Result::eSuccess)
+    {
+        std::cout << "stream gpu: skipped, unable to create headless vulkan context" << std::endl;
+        return true;
+    }
+
+    bool has_memory_budget = context.is_extension_enabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    vl::TextureStreamer::MemoryBudget memory = vl::TextureStreamer::query_memory_budget(context.m_physical_device, has_memory_budget);
+    std::cout << "stream gpu: " << context.get_device_name() << ", device local budget " << memory.m_budget / 1048576
+              << " MB, usage " << memory.m_usage / 1048576 << " MB"
+              << (memory.m_is_reported ? "" : " (VK_EXT_memory_budget unavailable, heap size)") << std::endl;
+
+    const uint32_t size = 256, texture_count = 3;
+    std::vector<std::string> paths;
+    std::vector<std::vector<std::vector<uint8_t>>> sources;
+    bool is_passed = true;
+    for (uint32_t i = 0; i < texture_count; i++)
+    {
+        std::vector<std::vector<uint8_t>> levels;
+        std::vector<uint8_t> pixels = make_encoder_frame(size, size, i + 1);
+        uint32_t level_count = vl::MipGenerator::get_level_count(size, size);
+        vl::MipGenerator::generate(pixels.data(), size, size, level_count, levels);
+        levels.insert(levels.begin(), std::move(pixels));
+        paths.push_back(directory + "/stream_bench_" + std::to_string(i) + ".ktx2");
+        is_passed &= vl::Ktx2File::write(paths.back(), vk::Format::eR8G8B8A8Unorm, size, size, levels);
+        sources.push_back(std::move(levels));
+    }
+
+    vl::StagingRing ring;
+    vl::MappedBuffer readback;
+    vl::TextureStreamer streamer;
+    vl::TextureStreamer::Config streamer_config;
+    streamer_config.m_upload_budget = 64 * 1024;
+    streamer_config.m_tail_budget = 4 * 1024;
+    is_passed &= ring.create(context.m_device, context.m_physical_device, 4 * 1024 * 1024) == vk::Result::eSuccess &&
+                 readback.create(context.m_device, context.m_physical_device, size * size * 4, vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eHostCached) == vk::Result::eSuccess &&
+                 streamer.create(streamer_config, &ring);
+    for (const std::string &path : paths)
+        is_passed &= is_passed && streamer.add(path).has_value();
+
+    // 每帧一次提交并等待完成，上传预算小于第0级，需要多帧逐级加载
+    uint64_t frame = 0;
+    auto run_frame = [&](uint32_t level, vk::DeviceSize budget)
+    {
+        frame++;
+        for (uint32_t i = 0; i < texture_count; i++)
+            streamer.request(i, level, frame);
+        std::vector<vl::TextureStreamer::Change> changes = streamer.update(frame, budget);
+        auto command_result = context.begin_one_time(false);
+        if (command_result.result != vk::Result::eSuccess ||
+            streamer.record(context.m_device, context.m_physical_device, command_result.value, changes) != vk::Result::eSuccess ||
+            context.end_one_time(command_result.value, false) != vk::Result::eSuccess)
+            return false;
+        streamer.submitted(frame);
+        streamer.retire(frame, context.m_device);
+        streamer.take_published();
+        return true;
+    };
+    auto is_resident = [&](uint32_t level)
+    {
+        for (uint32_t i = 0; i < texture_count; i++)
+            if (streamer.get_resident_level(i) != level)
+                return false;
+        return true;
+    };
+    auto check_level = [&](uint32_t level)
+    {
+        bool is_matched = true;
+        for (uint32_t i = 0; i < texture_count; i++)
+            is_matched &= check_streamed_image(context, readback, streamer.get_image(i), size >> level, size >> level, sources[i][level]);
+        return is_matched;
+    };
+
+    const vk::DeviceSize unlimited = ~vk::DeviceSize(0);
+    while (is_passed && frame < 64 && !is_resident(0))
+        is_passed &= run_frame(0, unlimited);
+    uint64_t load_frames = frame;
+    bool is_loaded = is_passed && is_resident(0) && check_level(0);
+
+    // 预算只够第2级，本帧请求第2级，更精细的级别被淘汰，保留的级别由GPU复制
+    vk::DeviceSize level2_budget = 0;
+    for (const std::vector<std::vector<uint8_t>> &levels : sources)
+        for (size_t level = 2; level < levels.size(); level++)
+            level2_budget += levels[level].size();
+    is_passed &= is_loaded && run_frame(2, level2_budget);
+    bool is_evicted = is_passed && is_resident(2) && check_level(2);
+
+    std::cout << "stream gpu: " << texture_count << " textures " << size << "x" << size << " rgba8, loaded to level 0 in "
+              << load_frames << " frames, readback " << (is_loaded ? "matches" : "MISMATCH")
+              << "; evicted to level 2, readback " << (is_evicted ? "matches" : "MISMATCH") << std::endl
+              << "stream gpu statistics:" << streamer.format();
+
+    vkDeviceWaitIdle(static_cast<VkDevice>(context.m_device));
+    streamer.destroy(context.m_device);
+    readback.destroy(context.m_device);
+    ring.destroy(context.m_device);
+    context.destroy();
+    for (const std::string &path : paths)
+        std::remove(path.c_str());
+    return is_loaded && is_evicted;
+}
+
+/// @brief 纹理流式加载基准：在CPU上用合成的访问序列模拟加载和淘汰策略，可选地在GPU上验证上传、复制和显存预算查询
+int run_stream_bench(int argc, char **argv)
+{
+    uint32_t texture_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--textures", 256LL));
+    uint64_t frame_count = static_cast<uint64_t>(bench::get_option(argc, argv, "--frames", 600LL));
+    vk::DeviceSize budget = static_cast<vk::DeviceSize>(bench::get_option(argc, argv, "--budget", 64LL)) * 1048576;
+    vk::DeviceSize upload_budget = static_cast<vk::DeviceSize>(bench::get_option(argc, argv, "--upload", 4LL)) * 1048576;
+    uint64_t latency = static_cast<uint64_t>(bench::get_option(argc, argv, "--latency", 2LL));
+    uint32_t seed = static_cast<uint32_t>(bench::get_option(argc, argv, "--seed", 1LL));
+    std::string directory = bench::get_option(argc, argv, "--dir", std::string("."));
+    const uint64_t settle_count = 64;
+
+    // BC1纹理，边长依次为2048、1024、512
+    std::vector<vl::TextureStreamer::Description> descriptions(texture_count);
+    vl::Ktx2File::FormatInfo info = *vl::Ktx2File::get_format_info(vk::Format::eBc1RgbUnormBlock);
+    vk::DeviceSize total = 0;
+    for (uint32_t i = 0; i < texture_count; i++)
+    {
+        vl::TextureStreamer::Description &description = descriptions[i];
+        description.m_format = vk::Format::eBc1RgbUnormBlock;
+        description.m_width = description.m_height = 2048u >> (i % 3);
+        for (uint32_t level = 0; level < vl::MipGenerator::get_level_count(description.m_width, description.m_height); level++)
+        {
+            description.m_level_sizes.push_back(vl::Ktx2File::get_level_size(info, description.m_width, description.m_height, level));
+            total += description.m_level_sizes.back();
+        }
+    }
+
+    std::cout << "stream: " << texture_count << " bc1 textures, " << total / 1048576 << " MB with all levels, budget "
+              << budget / 1048576 << " MB, upload " << upload_budget / 1048576 << " MB/frame, latency " << latency
+              << " frames, " << frame_count << " frames + " << settle_count << " to settle" << std::endl
+              << "       trace  loads  evicts  deferred  up MB  evict MB  peak MB  over  deficit  hit %  update us  result" << std::endl;
+
+    bool is_passed = true;
+    struct TraceCase
+    {
+        const char *m_name;
+        StreamTrace m_trace;
+    };
+    for (const TraceCase &item : {TraceCase{"corridor", StreamTrace::eCorridor},
+                                  TraceCase{"zipf", StreamTrace::eZipf},
+                                  TraceCase{"pressure", StreamTrace::ePressure}})
+    {
+        StreamSimulation simulation = simulate_texture_streaming(
+            item.m_trace, descriptions, frame_count, settle_count, budget, upload_budget, latency, seed);
+        const vl::TextureStreamer::Statistics &statistics = simulation.m_statistics;
+
+        // 需求放不进预算时不要求收敛
+        bool is_valid = simulation.m_eviction_violations == 0 && simulation.m_budget_violations == 0 &&
+                        (simulation.m_is_converged || !simulation.m_fits);
+        is_passed &= is_valid;
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(12) << item.m_name
+                  << std::setw(7) << statistics.m_loads
+                  << std::setw(8) << statistics.m_evictions
+                  << std::setw(10) << statistics.m_deferred
+                  << std::setw(7) << statistics.m_uploaded_bytes / 1048576.0
+                  << std::setw(10) << statistics.m_evicted_bytes / 1048576.0
+                  << std::setw(9) << statistics.m_peak_usage / 1048576.0
+                  << std::setw(6) << statistics.m_over_budget_updates
+                  << std::setw(9) << simulation.m_average_deficit
+                  << std::setw(7) << simulation.m_hit_rate * 100.0
+                  << std::setw(11) << bench::percentile(simulation.m_update_us, 50)
+                  << "  " << (is_valid ? (simulation.m_fits ? "ok" : "ok, does not fit") : "FAILED")
+                  << std::defaultfloat << std::endl;
+        if (!is_valid)
+            std::cout << "  " << simulation.m_eviction_violations << " used textures evicted below request, "
+                      << simulation.m_budget_violations << " frames over budget, "
+                      << (simulation.m_is_converged ? "converged" : "not converged") << std::endl;
+    }
+
+    if (!bench::has_flag(argc, argv, "--cpu-only"))
+        is_passed &= validate_texture_streamer(argc, argv, directory);
+
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
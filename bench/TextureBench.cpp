@@ -0,0 +1,225 @@
+#ifndef TEXTUREBENCH_CPP
+#define TEXTUREBENCH_CPP
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "Bench.hpp"
+#include "EncoderBench.cpp"
+#include "../src/MappedBuffer.hpp"
+#include "../src/MappedBuffer.cpp"
+#include "../src/MappedFile.hpp"
+#include "../src/MappedFile.cpp"
+#include "../src/StagingRing.hpp"
+#include "../src/StagingRing.cpp"
+#include "../src/TextureFile.hpp"
+#include "../src/TextureFile.cpp"
+
+/// @brief 原来cube示例的做法：第一次只解析文件头取得尺寸，第二次重新解析并逐像素复制
+bool load_ppm_twice(const std::vector<uint8_t> &file, std::vector<uint8_t> &rgba, uint32_t &width, uint32_t &height)
+{
+    auto parse = [&](uint8_t *destination)
+    {
+        const char *cursor = reinterpret_cast<const char *>(file.data());
+        const char *end = cursor + file.size();
+        if (file.size() < 3 || std::strncmp(cursor, "P6\n", 3) != 0)
+            return false;
+        while (cursor < end && *cursor++ != '\n')
+            ;
+        if (std::sscanf(cursor, "%u %u", &width, &height) != 2)
+            return false;
+        if (destination == nullptr)
+            return true;
+        while (cursor < end && *cursor++ != '\n')
+            ;
+        if (end - cursor < 4 || std::strncmp(cursor, "255\n", 4) != 0)
+            return false;
+        cursor += 4;
+        if (static_cast<size_t>(end - cursor) < static_cast<size_t>(width) * height * 3)
+            return false;
+        for (size_t i = 0; i < static_cast<size_t>(width) * height; i++)
+        {
+            std::memcpy(destination + i * 4, cursor + i * 3, 3);
+            destination[i * 4 + 3] = 255;
+        }
+        return true;
+    };
+    if (!parse(nullptr))
+        return false;
+    rgba.resize(static_cast<size_t>(width) * height * 4);
+    return parse(rgba.data());
+}
+
+/// @brief 纹理加载基准：PPM文件头只解析一次，映射文件后直接扩展为RGBA写入暂存环，与原来的两遍解析比较
+int run_texture_bench(int argc, char **argv)
+{
+    std::vector<uint64_t> sizes = bench::get_list_option(argc, argv, "--sizes", "256,1024,4096");
+    int repeat = static_cast<int>(bench::get_option(argc, argv, "--repeat", 10LL));
+    std::string directory = bench::get_option(argc, argv, "--dir", std::string("."));
+
+    bool is_passed = true;
+
+    // 扩展函数与标量结果一致，覆盖SIMD主循环之后的尾部
+    {
+        std::vector<uint8_t> rgb(3 * 67), rgba(4 * 67), expected(4 * 67);
+        for (size_t i = 0; i < rgb.size(); i++)
+            rgb[i] = static_cast<uint8_t>(i * 7 + 3);
+        for (size_t count : {0, 1, 15, 16, 17, 33, 67})
+        {
+            std::fill(rgba.begin(), rgba.end(), 0);
+            vl::TextureFile::expand_rgb_to_rgba(rgb.data(), rgba.data(), count);
+            for (size_t i = 0; i < count; i++)
+            {
+                std::memcpy(&expected[i * 4], &rgb[i * 3], 3);
+                expected[i * 4 + 3] = 255;
+            }
+            is_passed &= std::memcmp(rgba.data(), expected.data(), count * 4) == 0 && (count == 67 || rgba[count * 4] == 0);
+        }
+        std::cout << "texture: rgb to rgba expansion " << (is_passed ? "matches" : "MISMATCH") << std::endl;
+    }
+
+    // 损坏的文件头必须被拒绝，注释和多余的空白可以接受
+    {
+        struct Case
+        {
+            const char *m_name;
+            std::string m_header;
+            size_t m_pixel_bytes;
+            bool m_is_valid;
+        };
+        const Case cases[] = {
+            {"valid", "P6\n4 2\n255\n", 24, true},
+            {"comments", "P6 # comment\n4\t2 # size\n255\n", 24, true},
+            {"bad magic", "P3\n4 2\n255\n", 24, false},
+            {"truncated pixels", "P6\n4 2\n255\n", 23, false},
+            {"16-bit", "P6\n4 2\n65535\n", 48, false},
+            {"zero width", "P6\n0 2\n255\n", 0, false},
+            {"huge size", "P6\n4294967295 4294967295\n255\n", 24, false},
+            {"overflow", "P6\n99999999999 2\n255\n", 24, false},
+            {"missing max", "P6\n4 2", 0, false},
+        };
+        std::cout << "texture: headers" << std::endl;
+        for (const Case &test : cases)
+        {
+            std::vector<uint8_t> bytes(test.m_header.begin(), test.m_header.end());
+            bytes.resize(bytes.size() + test.m_pixel_bytes, 128);
+            vl::TextureFile file;
+            bool is_accepted = file.open_memory(bytes.data(), bytes.size());
+            is_accepted &= !is_accepted || (file.get_width() == 4 && file.get_height() == 2);
+            std::cout << "  " << std::setw(18) << test.m_name << (is_accepted ? "  accepted" : "  rejected") << std::endl;
+            is_passed &= is_accepted == test.m_is_valid;
+        }
+    }
+
+    // 暂存环使用主机内存，只测量从文件到暂存环的解码
+    std::cout << "texture: load into staging ring, page cache warm, time per megapixel" << std::endl
+              << "       size       MB  two-pass ms  read ms  mmap ms  two-pass ms/MP  mmap ms/MP  expand GB/s" << std::endl;
+    for (uint64_t size : sizes)
+    {
+        const uint32_t extent = static_cast<uint32_t>(size);
+        std::vector<uint8_t> pixels = make_encoder_frame(extent, extent, 1);
+        vl::ImageEncoder::Image image;
+        image.m_pixels = pixels.data();
+        image.m_width = extent;
+        image.m_height = extent;
+        image.m_row_pitch = extent * 4;
+        std::vector<uint8_t> encoded;
+        const std::string path = directory + "/texture_bench_" + std::to_string(extent) + ".ppm";
+        {
+            std::ofstream fout(path, std::ios::binary);
+            if (!vl::ImageEncoder::encode_ppm(image, encoded) ||
+                !fout.write(reinterpret_cast<const char *>(encoded.data()), static_cast<std::streamsize>(encoded.size())))
+            {
+                std::cout << "failed to write " << path << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        std::vector<uint8_t> memory(pixels.size() + 1024);
+        vl::MappedBuffer host;
+        host.m_mapped = memory.data();
+        host.m_size = memory.size();
+        host.m_is_coherent = true;
+        vl::StagingRing ring;
+        ring.attach(host);
+
+        // 两种打开方式解码的结果与原图一致
+        for (vl::TextureFile::Mode mode : {vl::TextureFile::Mode::eMap, vl::TextureFile::Mode::eRead})
+        {
+            vl::TextureFile file;
+            std::optional<vl::StagingRing::Allocation> allocation;
+            bool is_valid = file.open(path, mode) &&
+                            file.get_width() == extent && file.get_height() == extent &&
+                            (allocation = file.stage(ring)).has_value() &&
+                            std::memcmp(allocation->m_pointer, pixels.data(), pixels.size()) == 0;
+            ring.release(ring.submit());
+            if (!is_valid)
+                std::cout << "  " << path << " decodes incorrectly" << std::endl;
+            is_passed &= is_valid;
+        }
+
+        bench::Stopwatch stopwatch;
+        std::vector<double> times;
+        std::vector<uint8_t> rgba;
+        for (int r = 0; r < repeat; r++)
+        {
+            stopwatch.reset();
+            std::ifstream fin(path, std::ios::binary);
+            std::vector<uint8_t> file((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+            uint32_t width = 0, height = 0;
+            is_passed &= load_ppm_twice(file, rgba, width, height);
+            std::optional<vl::StagingRing::Allocation> allocation = ring.allocate(rgba.size(), 4);
+            if (allocation.has_value())
+                std::memcpy(allocation->m_pointer, rgba.data(), rgba.size());
+            times.push_back(stopwatch.milliseconds());
+            ring.release(ring.submit());
+        }
+        double two_pass_ms = bench::percentile(times, 50);
+
+        auto load = [&](vl::TextureFile::Mode mode)
+        {
+            times.clear();
+            for (int r = 0; r < repeat; r++)
+            {
+                stopwatch.reset();
+                vl::TextureFile file;
+                is_passed &= file.open(path, mode) && file.stage(ring).has_value();
+                file.close();
+                times.push_back(stopwatch.milliseconds());
+                ring.release(ring.submit());
+            }
+            return bench::percentile(times, 50);
+        };
+        double read_ms = load(vl::TextureFile::Mode::eRead);
+        double map_ms = load(vl::TextureFile::Mode::eMap);
+
+        // 只测扩展本身，源和目标都已在缓存或内存中
+        times.clear();
+        for (int r = 0; r < repeat; r++)
+        {
+            stopwatch.reset();
+            vl::TextureFile::expand_rgb_to_rgba(encoded.data() + encoded.size() - pixels.size() / 4 * 3, memory.data(), pixels.size() / 4);
+            times.push_back(stopwatch.seconds());
+            bench::do_not_optimize(memory[0]);
+        }
+        double expand_seconds = bench::percentile(times, 50);
+
+        double megapixels = static_cast<double>(extent) * extent / 1e6;
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(11) << (std::to_string(extent) + "^2")
+                  << std::setw(9) << encoded.size() / 1048576.0
+                  << std::setw(13) << two_pass_ms
+                  << std::setw(9) << read_ms
+                  << std::setw(9) << map_ms
+                  << std::setw(16) << std::setprecision(3) << two_pass_ms / megapixels
+                  << std::setw(12) << map_ms / megapixels
+                  << std::setw(13) << std::setprecision(2) << (pixels.size() + pixels.size() / 4 * 3) / expand_seconds / 1e9
+                  << std::defaultfloat << std::endl;
+        std::remove(path.c_str());
+    }
+
+    std::cout << (is_passed ? "  all texture checks passed" : "  MISMATCH") << std::endl;
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,196 @@
+#ifndef TEXTURELOADERBENCH_CPP
+#define TEXTURELOADERBENCH_CPP
+
+#include <cstdio>
+#include <thread>
+#include <fstream>
+#include "Bench.hpp"
+#include "TextureBench.cpp"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/ThreadPool.hpp"
+#include "../src/ThreadPool.cpp"
+#include "../src/TextureLoader.hpp"
+#include "../src/TextureLoader.cpp"
+
+/// @brief FNV-1a，代替上传后的图像内容做比较
+uint64_t hash_texture_bytes(const uint8_t *data, size_t size)
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    return hash;
+}
+
+/// @brief 异步纹理加载基准：CPU上模拟逐帧渲染，GPU复制用对暂存数据求哈希代替，
+/// 提交在若干帧后才算完成；与在第一帧之前逐个加载所有纹理比较
+int run_texture_loader_bench(int argc, char **argv)
+{
+    uint32_t count = static_cast<uint32_t>(bench::get_option(argc, argv, "--count", 200LL));
+    uint32_t max_size = static_cast<uint32_t>(bench::get_option(argc, argv, "--max-size", 512LL));
+    size_t thread_count = static_cast<size_t>(bench::get_option(argc, argv, "--threads", 0LL));
+    uint64_t latency = static_cast<uint64_t>(bench::get_option(argc, argv, "--latency", 2LL));
+    double frame_ms = static_cast<double>(bench::get_option(argc, argv, "--frame-ms", 4LL));
+    vk::DeviceSize ring_size = static_cast<vk::DeviceSize>(bench::get_option(argc, argv, "--ring", 16LL)) * 1024 * 1024;
+    std::string directory = bench::get_option(argc, argv, "--dir", std::string("."));
+
+    // 边长在64到max_size之间取2的幂，文件内容各不相同
+    std::vector<std::string> paths;
+    std::vector<uint64_t> expected;
+    uint64_t total_bytes = 0;
+    uint32_t size_count = 1;
+    while ((64u << size_count) <= max_size)
+        size_count++;
+    uint32_t state = 12345;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        uint32_t width = 64u << (state >> 8) % size_count;
+        uint32_t height = 64u << (state >> 16) % size_count;
+
+        std::vector<uint8_t> pixels = make_encoder_frame(width, height, i);
+        vl::ImageEncoder::Image image;
+        image.m_pixels = pixels.data();
+        image.m_width = width;
+        image.m_height = height;
+        image.m_row_pitch = width * 4;
+        std::vector<uint8_t> encoded;
+        std::string path = directory + "/texture_loader_bench_" + std::to_string(i) + ".ppm";
+        std::ofstream fout(path, std::ios::binary);
+        if (!vl::ImageEncoder::encode_ppm(image, encoded) ||
+            !fout.write(reinterpret_cast<const char *>(encoded.data()), static_cast<std::streamsize>(encoded.size())))
+        {
+            std::cout << "failed to write " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+        paths.push_back(path);
+        expected.push_back(hash_texture_bytes(pixels.data(), pixels.size()));
+        total_bytes += pixels.size();
+    }
+
+    const std::string missing_path = directory + "/texture_loader_bench_missing.ppm";
+    const std::string corrupt_path = directory + "/texture_loader_bench_corrupt.ppm";
+    {
+        std::ofstream fout(corrupt_path, std::ios::binary);
+        fout << "P6\n64 64\n255\n"
+             << "truncated";
+    }
+
+    std::vector<uint8_t> memory(ring_size);
+    vl::MappedBuffer host;
+    host.m_mapped = memory.data();
+    host.m_size = memory.size();
+    host.m_is_coherent = true;
+    vl::StagingRing ring;
+    ring.attach(host);
+
+    bool is_passed = true;
+    std::cout << "texload: " << count << " textures, " << total_bytes / 1048576.0 << " MB decoded, "
+              << ring_size / 1048576 << " MB staging ring, " << frame_ms << " ms frames, "
+              << latency << " frames GPU latency" << std::endl;
+
+    // 原来的做法：第一帧之前在渲染线程逐个加载
+    bench::Stopwatch stopwatch;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        vl::TextureFile file;
+        std::optional<vl::StagingRing::Allocation> allocation;
+        if (!file.open(paths[i]) || !(allocation = file.stage(ring)).has_value())
+        {
+            is_passed = false;
+            continue;
+        }
+        is_passed &= hash_texture_bytes(static_cast<const uint8_t *>(allocation->m_pointer), allocation->m_size) == expected[i];
+        ring.release(ring.submit());
+    }
+    double serial_ms = stopwatch.milliseconds();
+
+    // 流水线：请求全部纹理后立即开始渲染
+    vl::TextureLoader loader;
+    vl::TextureLoader::Config config;
+    config.m_thread_count = thread_count;
+    config.m_slot_count = count + 2;
+    if (!loader.create(ring, config))
+        return EXIT_FAILURE;
+
+    stopwatch.reset();
+    std::vector<uint32_t> slots;
+    for (const std::string &path : paths)
+        slots.push_back(loader.request(path).value_or(UINT32_MAX));
+    uint32_t missing_slot = loader.request(missing_path).value_or(UINT32_MAX);
+    uint32_t corrupt_slot = loader.request(corrupt_path).value_or(UINT32_MAX);
+
+    std::vector<uint64_t> uploaded(count + 2, 0);
+    std::vector<uint32_t> publish_counts(count + 2, 0);
+    double first_frame_ms = 0.0;
+    uint64_t frame = 0, fallback_frames = 0, max_uploads = 0;
+    bool is_fallback_uploaded = false;
+    while (!loader.is_idle() || frame <= latency)
+    {
+        frame++;
+        std::vector<vl::TextureLoader::Upload> uploads = loader.update();
+        max_uploads = std::max<uint64_t>(max_uploads, uploads.size());
+        for (const vl::TextureLoader::Upload &upload : uploads)
+        {
+            const uint8_t *pixels = static_cast<const uint8_t *>(upload.m_allocation.m_pointer);
+            if (upload.m_slot == vl::TextureLoader::FALLBACK_SLOT)
+            {
+                std::vector<uint8_t> fallback(vl::TextureLoader::FALLBACK_SIZE * vl::TextureLoader::FALLBACK_SIZE * 4);
+                vl::TextureLoader::fill_fallback(fallback.data());
+                is_fallback_uploaded = frame == 1 && std::memcmp(pixels, fallback.data(), fallback.size()) == 0;
+                continue;
+            }
+            uploaded[upload.m_slot] = hash_texture_bytes(pixels, upload.m_allocation.m_size);
+        }
+        loader.submitted(frame);
+        if (frame > latency)
+            loader.retire(frame - latency);
+        for (uint32_t slot : loader.take_published())
+            publish_counts[slot]++;
+
+        if (frame == 1)
+            first_frame_ms = stopwatch.milliseconds();
+        if (!loader.is_idle())
+            fallback_frames++;
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(frame_ms));
+    }
+    double resident_ms = stopwatch.milliseconds();
+    loader.retire(frame);
+
+    // 所有纹理内容正确并且只发布一次，失败的纹理保持后备纹理
+    size_t mismatches = 0;
+    for (uint32_t i = 0; i < count; i++)
+        if (slots[i] == UINT32_MAX || uploaded[slots[i]] != expected[i] || publish_counts[slots[i]] != 1 ||
+            loader.get_state(slots[i]) != vl::TextureLoader::State::eResident)
+            mismatches++;
+    bool is_failure_handled = missing_slot != UINT32_MAX && corrupt_slot != UINT32_MAX &&
+                              loader.get_state(missing_slot) == vl::TextureLoader::State::eFailed &&
+                              loader.get_state(corrupt_slot) == vl::TextureLoader::State::eFailed &&
+                              publish_counts[missing_slot] == 0 && publish_counts[corrupt_slot] == 0;
+    vl::TextureLoader::Statistics statistics = loader.get_statistics();
+    is_passed &= mismatches == 0 && is_failure_handled && is_fallback_uploaded && ring.get_used() == 0;
+
+    std::cout << "  serial load before first frame  " << std::fixed << std::setprecision(1) << serial_ms << " ms" << std::endl
+              << "  pipeline first frame            " << first_frame_ms << " ms" << std::endl
+              << "  pipeline all resident           " << resident_ms << " ms, " << frame << " frames, "
+              << fallback_frames << " with fallbacks, at most " << max_uploads << " uploads per frame" << std::endl
+              << "  decode threads                  " << statistics.m_thread_count << ", "
+              << statistics.m_decode_seconds * 1000.0 << " ms decode time" << std::endl
+              << "  request to resident latency     " << statistics.average_latency_seconds() * 1000.0 << " ms average, "
+              << statistics.m_max_latency_seconds * 1000.0 << " ms max" << std::endl
+              << "  contents " << (mismatches == 0 ? "match" : "MISMATCH")
+              << ", failures " << (is_failure_handled ? "use fallback" : "NOT HANDLED")
+              << ", fallback " << (is_fallback_uploaded ? "staged in first frame" : "MISSING")
+              << ", staging ring " << (ring.get_used() == 0 ? "released" : "LEAKED")
+              << std::defaultfloat << std::endl;
+
+    loader.destroy(vk::Device());
+    for (const std::string &path : paths)
+        std::remove(path.c_str());
+    std::remove(corrupt_path.c_str());
+
+    std::cout << (is_passed ? "  all texture loader checks passed" : "  MISMATCH") << std::endl;
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef TRANSFORMBENCH_CPP
+#define TRANSFORMBENCH_CPP
+
+#include <cmath>
+#include "Bench.hpp"
+#include "../examples/demo/linmath.h"
+#include "../src/TransformStore.hpp"
+#include "../src/TransformStore.cpp"
+
+/// @brief 逐个物体计算MVP，作为对照
+void compute_transforms_one_by_one(const vl::TransformStore &store, mat4x4 view_projection, float *destination)
+{
+    for (size_t i = 0; i < store.size(); i++)
+    {
+        vl::TransformStore::Transform transform = store.get(i);
+        mat4x4 model;
+        mat4x4_from_quat(model, transform.m_rotation);
+        mat4x4_scale_aniso(model, model, transform.m_scale[0], transform.m_scale[1], transform.m_scale[2]);
+        model[3][0] = transform.m_position[0];
+        model[3][1] = transform.m_position[1];
+        model[3][2] = transform.m_position[2];
+        mat4x4_mul_scalar(reinterpret_cast<vec4 *>(destination + i * 16), view_projection, model);
+    }
+}
+
+/// @brief 变换基准：10k~1M个物体，逐个计算、SoA单线程、SoA多线程
+int run_transform_bench(int argc, char **argv)
+{
+    size_t threads = static_cast<size_t>(bench::get_option(argc, argv, "--threads", 0LL));
+    int repeat = static_cast<int>(bench::get_option(argc, argv, "--repeat", 5LL));
+
+    mat4x4 projection, view, view_projection;
+    vec3 eye = {0.0f, 50.0f, 200.0f}, center = {0.0f, 0.0f, 0.0f}, up = {0.0f, 1.0f, 0.0f};
+    mat4x4_perspective(projection, 0.785f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    mat4x4_look_at(view, eye, center, up);
+    mat4x4_mul(view_projection, projection, view);
+
+    vl::ThreadPool pool(threads);
+    std::cout << "transform: " << pool.get_thread_count() << " worker threads" << std::endl
+              << "   objects   one-by-one ms   soa 1 thread ms   soa pool ms   max diff" << std::endl;
+
+    bool is_matching = true;
+    const size_t counts[] = {10000, 100000, 1000000};
+    for (size_t count : counts)
+    {
+        vl::TransformStore store;
+        store.resize(count);
+        uint32_t state = static_cast<uint32_t>(count);
+        auto next = [&state]()
+        {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>(state >> 8) / 16777216.0f * 2.0f - 1.0f;
+        };
+        for (size_t i = 0; i < count; i++)
+        {
+            float rotation[4];
+            vl::TransformStore::make_rotation(next(), next(), next(), next() * 3.14159f, rotation);
+            store.set_position(i, next() * 100.0f, next() * 100.0f, next() * 100.0f);
+            store.set_rotation(i, rotation[0], rotation[1], rotation[2], rotation[3]);
+            store.set_scale(i, 1.0f + next() * 0.5f, 1.0f + next() * 0.5f, 1.0f + next() * 0.5f);
+        }
+
+        // 代替持久映射的缓冲
+        std::vector<float> reference(count * 16);
+        std::vector<float> output(count * 16);
+        const float *vp = &view_projection[0][0];
+
+        std::vector<double> one_by_one, single, pooled;
+        for (int r = 0; r < repeat; r++)
+        {
+            bench::Stopwatch stopwatch;
+            compute_transforms_one_by_one(store, view_projection, reference.data());
+            one_by_one.push_back(stopwatch.milliseconds());
+
+            stopwatch.reset();
+            store.compute(vp, output.data());
+            single.push_back(stopwatch.milliseconds());
+
+            stopwatch.reset();
+            store.compute(vp, output.data(), vl::TransformStore::MATRIX_SIZE, &pool);
+            pooled.push_back(stopwatch.milliseconds());
+        }
+
+        double max_diff = 0.0;
+        for (size_t i = 0; i < output.size(); i++)
+            max_diff = std::max(max_diff, std::abs(static_cast<double>(output[i]) - reference[i]) / (1.0 + std::abs(reference[i])));
+        if (max_diff > 1e-5)
+            is_matching = false;
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(10) << count
+                  << std::setw(16) << bench::percentile(one_by_one, 50)
+                  << std::setw(18) << bench::percentile(single, 50)
+                  << std::setw(14) << bench::percentile(pooled, 50)
+                  << std::scientific << std::setprecision(1) << std::setw(11) << max_diff
+                  << std::defaultfloat << std::endl;
+    }
+
+    std::cout << (is_matching ? "  all results within tolerance" : "  MISMATCH") << std::endl;
+    return is_matching ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,192 @@
+#ifndef VERTEXLAYOUTBENCH_CPP
+#define VERTEXLAYOUTBENCH_CPP
+
+#include <cfloat>
+#include <cmath>
+#include "Bench.hpp"
+#include "../src/VertexLayout.hpp"
+#include "../src/VertexLayout.cpp"
+
+/// @brief 两个方向之间的夹角，用atan2避免acos在夹角很小时的误差
+double angle_between(const float *a, const float *b)
+{
+    double cross[3] = {static_cast<double>(a[1]) * b[2] - static_cast<double>(a[2]) * b[1],
+                       static_cast<double>(a[2]) * b[0] - static_cast<double>(a[0]) * b[2],
+                       static_cast<double>(a[0]) * b[1] - static_cast<double>(a[1]) * b[0]};
+    double dot = static_cast<double>(a[0]) * b[0] + static_cast<double>(a[1]) * b[1] + static_cast<double>(a[2]) * b[2];
+    return std::atan2(std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]), dot);
+}
+
+/// @brief 顶点布局基准：比较浮点与量化布局的大小和打包速度，检查往返误差不超过量化步长决定的上界
+int run_vertex_layout_bench(int argc, char **argv)
+{
+    uint32_t rings = static_cast<uint32_t>(bench::get_option(argc, argv, "--rings", 512LL));
+    uint32_t segments = static_cast<uint32_t>(bench::get_option(argc, argv, "--segments", 1024LL));
+    size_t normal_count = static_cast<size_t>(bench::get_option(argc, argv, "--normals", 1000000LL));
+    int repeat = static_cast<int>(bench::get_option(argc, argv, "--repeat", 5LL));
+
+    using Layout = vl::VertexLayout;
+    bool is_passed = true;
+
+    // 八面体法线的误差上界（弧度）：八面体上每个分量的误差不超过半步，
+    // 展开到三维最多放大sqrt(3)倍，归一化再放大最多sqrt(3)倍
+    const double angle_bound = 3.0 * std::sqrt(2.0) * 0.5 / 32767.0 + 1e-6;
+
+    // 生成的描述
+    {
+        Layout layout;
+        layout.add(Layout::ATTRIBUTE_POSITION, Layout::ENCODING_QUANTIZED, 0)
+            .add(Layout::ATTRIBUTE_NORMAL, Layout::ENCODING_QUANTIZED, 1)
+            .add(Layout::ATTRIBUTE_UV, Layout::ENCODING_QUANTIZED, 2);
+        std::vector<vk::VertexInputBindingDescription> bindings = layout.get_binding_descriptions();
+        std::vector<vk::VertexInputAttributeDescription> attributes = layout.get_attribute_descriptions();
+        bool is_valid = bindings.size() == 1 && bindings[0].binding == 0 && bindings[0].stride == 16 &&
+                        attributes.size() == 3 &&
+                        attributes[0].location == 0 && attributes[0].format == vk::Format::eR16G16B16A16Unorm && attributes[0].offset == 0 &&
+                        attributes[1].location == 1 && attributes[1].format == vk::Format::eR16G16Snorm && attributes[1].offset == 8 &&
+                        attributes[2].location == 2 && attributes[2].format == vk::Format::eR16G16Unorm && attributes[2].offset == 12;
+        std::cout << "vertex layout: quantized interleaved descriptions " << (is_valid ? "ok" : "MISMATCH") << std::endl;
+        is_passed &= is_valid;
+    }
+
+    // 八面体法线：随机方向和坐标轴、对角线等边界情况
+    {
+        std::vector<float> normals;
+        const float special[][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}, {0.57735f, 0.57735f, -0.57735f}, {-0.70710678f, 0, -0.70710678f}};
+        for (const auto &normal : special)
+            normals.insert(normals.end(), normal, normal + 3);
+        uint32_t state = 12345u;
+        auto next = [&state]()
+        {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>(state >> 8) / 16777216.0f;
+        };
+        while (normals.size() < normal_count * 3)
+        {
+            float z = next() * 2.0f - 1.0f, phi = next() * 6.2831853f, r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            normals.insert(normals.end(), {r * std::cos(phi), r * std::sin(phi), z});
+        }
+
+        double max_angle = 0.0;
+        for (size_t i = 0; i < normals.size(); i += 3)
+        {
+            int16_t encoded[2];
+            float decoded[3];
+            Layout::encode_octahedral(&normals[i], encoded);
+            Layout::decode_octahedral(encoded, decoded);
+            max_angle = std::max(max_angle, angle_between(&normals[i], decoded));
+        }
+
+        bool is_valid = max_angle <= angle_bound;
+        std::cout << "octahedral normals: " << normals.size() / 3 << " directions, max error "
+                  << max_angle * 180.0 / 3.14159265358979 << " deg, bound "
+                  << angle_bound * 180.0 / 3.14159265358979 << " deg " << (is_valid ? "ok" : "EXCEEDED") << std::endl;
+        is_passed &= is_valid;
+    }
+
+    // 球面网格，纹理坐标重复4次，位置偏离原点
+    std::vector<float> positions, normals, uvs;
+    for (uint32_t r = 0; r <= rings; r++)
+        for (uint32_t s = 0; s <= segments; s++)
+        {
+            float theta = 3.14159265f * r / rings, phi = 6.2831853f * s / segments;
+            float x = std::sin(theta) * std::cos(phi), y = std::cos(theta), z = std::sin(theta) * std::sin(phi);
+            positions.insert(positions.end(), {x * 3.0f + 10.0f, y * 3.0f - 2.0f, z * 3.0f + 5.0f});
+            normals.insert(normals.end(), {x, y, z});
+            uvs.insert(uvs.end(), {4.0f * s / segments, 2.0f * r / rings});
+        }
+
+    Layout::Source source;
+    source.m_positions = positions.data();
+    source.m_normals = normals.data();
+    source.m_uvs = uvs.data();
+    source.m_vertex_count = positions.size() / 3;
+    Layout::Quantization quantization = Layout::compute_quantization(source);
+
+    struct Case
+    {
+        const char *m_name;
+        Layout m_layout;
+    };
+    std::vector<Case> cases(4);
+    cases[0].m_name = "float separate";
+    cases[0].m_layout.add(Layout::ATTRIBUTE_POSITION, Layout::ENCODING_FLOAT, 0, 0).add(Layout::ATTRIBUTE_NORMAL, Layout::ENCODING_FLOAT, 1, 1).add(Layout::ATTRIBUTE_UV, Layout::ENCODING_FLOAT, 2, 2);
+    cases[1].m_name = "float interleaved";
+    cases[1].m_layout.add(Layout::ATTRIBUTE_POSITION, Layout::ENCODING_FLOAT, 0).add(Layout::ATTRIBUTE_NORMAL, Layout::ENCODING_FLOAT, 1).add(Layout::ATTRIBUTE_UV, Layout::ENCODING_FLOAT, 2);
+    cases[2].m_name = "quantized";
+    cases[2].m_layout.add(Layout::ATTRIBUTE_POSITION, Layout::ENCODING_QUANTIZED, 0).add(Layout::ATTRIBUTE_NORMAL, Layout::ENCODING_QUANTIZED, 1).add(Layout::ATTRIBUTE_UV, Layout::ENCODING_QUANTIZED, 2);
+    cases[3].m_name = "quantized split";
+    cases[3].m_layout.add(Layout::ATTRIBUTE_POSITION, Layout::ENCODING_QUANTIZED, 0, 0).add(Layout::ATTRIBUTE_NORMAL, Layout::ENCODING_QUANTIZED, 1, 1).add(Layout::ATTRIBUTE_UV, Layout::ENCODING_QUANTIZED, 2, 1);
+
+    // 误差上界：半个量化步长，加上浮点运算的舍入
+    float position_bound = 0.0f, uv_bound = 0.0f;
+    for (size_t k = 0; k < 3; k++)
+        position_bound = std::max(position_bound, quantization.m_position_scale[k] * 0.5f / 65535.0f + 4.0f * FLT_EPSILON * (std::abs(quantization.m_position_offset[k]) + quantization.m_position_scale[k]));
+    for (size_t k = 0; k < 2; k++)
+        uv_bound = std::max(uv_bound, quantization.m_uv_scale[k] * 0.5f / 65535.0f + 4.0f * FLT_EPSILON * (std::abs(quantization.m_uv_offset[k]) + quantization.m_uv_scale[k]));
+
+    std::cout << "vertex layouts: " << source.m_vertex_count << " vertices, position bound " << position_bound << ", uv bound " << uv_bound << std::endl
+              << "               layout  bytes/vertex     MB  pack ms  position err  normal err deg    uv err  valid" << std::endl;
+
+    for (Case &test : cases)
+    {
+        const Layout &layout = test.m_layout;
+        std::vector<std::vector<uint8_t>> streams;
+        uint32_t vertex_size = 0;
+        for (const vk::VertexInputBindingDescription &binding : layout.get_binding_descriptions())
+        {
+            streams.resize(std::max<size_t>(streams.size(), binding.binding + 1));
+            streams[binding.binding].resize(source.m_vertex_count * binding.stride);
+            vertex_size += binding.stride;
+        }
+
+        std::vector<double> pack_ms;
+        for (int r = 0; r < repeat; r++)
+        {
+            bench::Stopwatch stopwatch;
+            for (uint32_t binding = 0; binding < streams.size(); binding++)
+                layout.pack(source, quantization, binding, streams[binding].data());
+            pack_ms.push_back(stopwatch.milliseconds());
+        }
+
+        std::vector<float> decoded_positions(positions.size()), decoded_normals(normals.size()), decoded_uvs(uvs.size());
+        for (uint32_t binding = 0; binding < streams.size(); binding++)
+            layout.unpack(streams[binding].data(), source.m_vertex_count, quantization, binding,
+                          decoded_positions.data(), decoded_normals.data(), decoded_uvs.data());
+
+        float position_error = 0.0f, uv_error = 0.0f;
+        double normal_error = 0.0;
+        for (size_t i = 0; i < positions.size(); i++)
+            position_error = std::max(position_error, std::abs(decoded_positions[i] - positions[i]));
+        for (size_t i = 0; i < uvs.size(); i++)
+            uv_error = std::max(uv_error, std::abs(decoded_uvs[i] - uvs[i]));
+        for (size_t i = 0; i < normals.size(); i += 3)
+        {
+            normal_error = std::max(normal_error, angle_between(&normals[i], &decoded_normals[i]) * 180.0 / 3.14159265358979);
+        }
+
+        // 浮点布局必须无损
+        bool is_float = layout.get_elements()[0].m_encoding == Layout::ENCODING_FLOAT;
+        bool is_valid = is_float
+                            ? position_error == 0.0f && uv_error == 0.0f && normal_error < 1e-3
+                            : position_error <= position_bound && uv_error <= uv_bound && normal_error <= angle_bound * 180.0 / 3.14159265358979;
+        is_passed &= is_valid;
+
+        std::cout << std::setw(21) << test.m_name
+                  << std::setw(14) << vertex_size
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(7) << source.m_vertex_count * vertex_size / 1048576.0
+                  << std::setw(9) << bench::percentile(pack_ms, 50)
+                  << std::defaultfloat << std::setprecision(3)
+                  << std::setw(14) << position_error
+                  << std::setw(16) << normal_error
+                  << std::setw(10) << uv_error
+                  << std::setw(7) << (is_valid ? "yes" : "NO")
+                  << std::setprecision(6) << std::endl;
+    }
+
+    std::cout << (is_passed ? "  all round trips are within bounds" : "  MISMATCH") << std::endl;
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
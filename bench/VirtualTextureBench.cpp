@@ -0,0 +1,474 @@
+#ifndef VIRTUALTEXTUREBENCH_CPP
+#define VIRTUALTEXTUREBENCH_CPP
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include "Bench.hpp"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/PhysicalDeviceUtils.hpp"
+#include "../src/PhysicalDeviceUtils.cpp"
+#include "../src/DefaultQueueFamilyIndices.hpp"
+#include "../src/DefaultQueueFamilyIndices.cpp"
+#include "../src/HeadlessContext.hpp"
+#include "../src/HeadlessContext.cpp"
+#include "../src/MappedBuffer.hpp"
+#include "../src/MappedBuffer.cpp"
+#include "../src/StagingRing.hpp"
+#include "../src/StagingRing.cpp"
+#include "../src/MappedFile.hpp"
+#include "../src/MappedFile.cpp"
+#include "../src/Deflate.hpp"
+#include "../src/Deflate.cpp"
+#include "../src/Ktx2File.hpp"
+#include "../src/Ktx2File.cpp"
+#include "../src/VirtualTexture.hpp"
+#include "../src/VirtualTexture.cpp"
+
+/// @brief 合成的相机路径
+enum class VirtualTrace
+{
+    /// @brief 相机斜视地面，沿对角线匀速飞过
+    eFlyover,
+    /// @brief 相机不动，检查是否收敛
+    eStatic,
+    /// @brief 每隔一段时间瞬移到随机位置
+    eTeleport,
+};
+
+/// @brief 反馈中的一个采样
+struct VirtualSample
+{
+    /// @brief 需求的级别，已限制在尾部级别以内
+    uint32_t m_level = 0;
+
+    /// @brief 所在的第0级页
+    uint32_t m_x = 0;
+    uint32_t m_y = 0;
+};
+
+/// @brief 一次模拟的结果
+struct VirtualSimulation
+{
+    vl::VirtualTexture::Statistics m_statistics;
+
+    /// @brief 每帧update的耗时，微秒
+    std::vector<double> m_update_us;
+
+    /// @brief 采样的页已驻留的比例
+    double m_hit_rate = 0.0;
+
+    /// @brief 可用的最小级别比需求粗的平均级数
+    double m_level_error = 0.0;
+
+    /// @brief 页表不变量被破坏的次数
+    uint32_t m_violations = 0;
+
+    /// @brief 最后一帧的采样是否全部驻留
+    bool m_is_converged = true;
+
+    /// @brief 最后一帧需要的页及其父页是否放得进物理页
+    bool m_fits = true;
+};
+
+/// @brief 模拟着色器写入的反馈：屏幕按32像素分块，每块采样一次，上方的块更远、纹素更密
+void make_virtual_feedback(
+    VirtualTrace trace,
+    uint64_t frame,
+    uint64_t frame_count,
+    const vl::VirtualTexture &texture,
+    uint32_t width,
+    std::mt19937 &random,
+    double &camera_u,
+    double &camera_v,
+    std::vector<VirtualSample> &samples,
+    std::vector<uint32_t> &feedback)
+{
+    if (trace == VirtualTrace::eFlyover)
+    {
+        double t = static_cast<double>(std::min(frame, frame_count)) / static_cast<double>(frame_count);
+        camera_u = 0.1 + 0.8 * t;
+        camera_v = 0.5 + 0.3 * std::sin(t * 6.2831853);
+    }
+    else if (trace == VirtualTrace::eStatic)
+    {
+        camera_u = 0.5;
+        camera_v = 0.5;
+    }
+    else if (frame <= frame_count && (frame - 1) % 120 == 0)
+    {
+        camera_u = std::uniform_real_distribution<double>(0.15, 0.85)(random);
+        camera_v = std::uniform_real_distribution<double>(0.15, 0.85)(random);
+    }
+
+    const uint32_t columns = 60, rows = 34;
+    const double span = 0.08;
+    uint32_t tail_level = texture.get_tail_level();
+    samples.clear();
+    feedback.clear();
+    for (uint32_t j = 0; j < rows; j++)
+        for (uint32_t i = 0; i < columns; i++)
+        {
+            double sx = (i + 0.5) / columns * 2.0 - 1.0;
+            double sy = (j + 0.5) / rows;
+            double distance = 1.0 / (0.25 + 0.75 * sy);
+            double u = camera_u + sx * span * distance * 0.5;
+            double v = camera_v - (distance - 1.0) * span * 0.5;
+            if (u < 0.0 || u >= 1.0 || v < 0.0 || v >= 1.0)
+                continue;
+
+            double texels = span * distance * width / 1920.0;
+            uint32_t level = texels > 1.0 ? static_cast<uint32_t>(std::floor(std::log2(texels))) : 0;
+            VirtualSample sample;
+            sample.m_level = std::min(level, tail_level);
+            sample.m_x = static_cast<uint32_t>(u * width) / texture.get_page_width();
+            sample.m_y = static_cast<uint32_t>(v * width) / texture.get_page_height();
+            samples.push_back(sample);
+            if (sample.m_level < tail_level)
+                feedback.push_back(vl::VirtualTexture::pack_page(sample.m_level, sample.m_x >> sample.m_level, sample.m_y >> sample.m_level));
+        }
+}
+
+/// @brief 检查页表不变量：驻留页的父页也驻留，最小级别图中的级别及更粗的级别都已驻留
+uint32_t check_virtual_invariants(const vl::VirtualTexture &texture)
+{
+    uint32_t violations = 0;
+    uint32_t tail_level = texture.get_tail_level();
+    for (uint32_t level = 0; level + 1 < tail_level; level++)
+    {
+        vk::Extent2D count = texture.get_page_count(level);
+        for (uint32_t y = 0; y < count.height; y++)
+            for (uint32_t x = 0; x < count.width; x++)
+                if (texture.is_resident(level, x, y) && !texture.is_resident(level + 1, x >> 1, y >> 1))
+                    violations++;
+    }
+
+    const std::vector<uint8_t> &map = texture.get_min_level_map();
+    vk::Extent2D count = texture.get_page_count(0);
+    for (uint32_t y = 0; y < count.height; y++)
+        for (uint32_t x = 0; x < count.width; x++)
+        {
+            uint32_t min_level = map[static_cast<size_t>(y) * count.width + x];
+            for (uint32_t level = min_level; level < tail_level; level++)
+                if (!texture.is_resident(level, x >> level, y >> level))
+                {
+                    violations++;
+                    break;
+                }
+        }
+    return violations;
+}
+
+/// @brief 在CPU上模拟虚拟纹理的页表和调度，提交在latency帧后完成
+VirtualSimulation simulate_virtual_texture(
+    VirtualTrace trace,
+    const vl::VirtualTexture::Config &config,
+    uint64_t frame_count,
+    uint64_t settle_count,
+    uint64_t latency,
+    uint32_t seed)
+{
+    VirtualSimulation simulation;
+    vl::VirtualTexture texture;
+    if (!texture.create(config))
+    {
+        simulation.m_violations++;
+        return simulation;
+    }
+
+    std::mt19937 random(seed);
+    std::vector<VirtualSample> samples;
+    std::vector<uint32_t> feedback;
+    double camera_u = 0.5, camera_v = 0.5;
+    uint64_t sample_count = 0, hit_count = 0;
+    double level_error = 0.0;
+    bench::Stopwatch stopwatch;
+    uint64_t last_frame = frame_count + settle_count;
+    for (uint64_t frame = 1; frame <= last_frame; frame++)
+    {
+        make_virtual_feedback(trace, frame, frame_count, texture, config.m_width, random, camera_u, camera_v, samples, feedback);
+
+        stopwatch.reset();
+        texture.submit_feedback(feedback.data(), static_cast<uint32_t>(feedback.size()), frame);
+        texture.update(frame);
+        simulation.m_update_us.push_back(stopwatch.seconds() * 1e6);
+
+        texture.submitted(frame);
+        if (frame > latency)
+            texture.retire(frame - latency);
+        if (frame == last_frame)
+            texture.retire(frame);
+
+        // 着色器按最小级别图限制LOD，实际采样的级别不比它更细
+        const std::vector<uint8_t> &map = texture.get_min_level_map();
+        uint32_t map_width = texture.get_page_count(0).width;
+        bool is_hit = true;
+        for (const VirtualSample &sample : samples)
+        {
+            uint32_t min_level = map[static_cast<size_t>(sample.m_y) * map_width + sample.m_x];
+            if (min_level > sample.m_level)
+            {
+                level_error += min_level - sample.m_level;
+                is_hit = false;
+            }
+            else
+                hit_count++;
+            sample_count++;
+        }
+
+        const vl::VirtualTexture::Statistics &statistics = texture.get_statistics();
+        if (texture.get_free_page_count() + statistics.m_resident_pages > config.m_physical_page_count)
+            simulation.m_violations++;
+        if (frame % 8 == 0 || frame == last_frame)
+            simulation.m_violations += check_virtual_invariants(texture);
+        if (frame == last_frame)
+        {
+            // 需要的页连同父页链的数量
+            std::vector<uint32_t> pages;
+            for (const VirtualSample &sample : samples)
+                for (uint32_t level = sample.m_level; level < texture.get_tail_level(); level++)
+                    pages.push_back(vl::VirtualTexture::pack_page(level, sample.m_x >> level, sample.m_y >> level));
+            std::sort(pages.begin(), pages.end());
+            simulation.m_fits = std::unique(pages.begin(), pages.end()) - pages.begin() <= static_cast<std::ptrdiff_t>(config.m_physical_page_count);
+            simulation.m_is_converged = is_hit;
+            if (texture.get_free_page_count() + statistics.m_resident_pages != config.m_physical_page_count)
+                simulation.m_violations++;
+        }
+    }
+
+    simulation.m_statistics = texture.get_statistics();
+    simulation.m_hit_rate = sample_count > 0 ? static_cast<double>(hit_count) / sample_count : 1.0;
+    simulation.m_level_error = sample_count > 0 ? level_error / sample_count : 0.0;
+    texture.destroy(vk::Device());
+    return simulation;
+}
+
+/// @brief 程序生成的纹理内容，每个纹素由级别和坐标决定
+bool fill_virtual_page(
+    uint32_t level,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height,
+    uint8_t *data)
+{
+    for (uint32_t row = 0; row < height; row++)
+        for (uint32_t column = 0; column < width; column++)
+        {
+            uint8_t *texel = data + (static_cast<size_t>(row) * width + column) * 4;
+            texel[0] = static_cast<uint8_t>(x + column);
+            texel[1] = static_cast<uint8_t>(y + row);
+            texel[2] = static_cast<uint8_t>((x + column) >> 8 ^ (y + row) >> 4);
+            texel[3] = static_cast<uint8_t>(level * 16 + 15);
+        }
+    return true;
+}
+
+/// @brief 读回图像一页的内容并与程序生成的内容比较，图像处于General
+bool check_virtual_page(
+    vl::HeadlessContext &context,
+    vl::MappedBuffer &readback,
+    const vl::VirtualTexture &texture,
+    uint32_t level,
+    uint32_t x,
+    uint32_t y)
+{
+    uint32_t width = texture.get_page_width(), height = texture.get_page_height();
+    auto command_result = context.begin_one_time(false);
+    if (command_result.result != vk::Result::eSuccess)
+        return false;
+    vk::CommandBuffer cmd = command_result.value;
+
+    vk::BufferImageCopy copy;
+    copy.setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level, 0, 1));
+    copy.setImageOffset(vk::Offset3D(x * width, y * height, 0));
+    copy.setImageExtent(vk::Extent3D(width, height, 1));
+    cmd.copyImageToBuffer(texture.get_image(), vk::ImageLayout::eGeneral, readback.m_buffer, copy);
+    vk::MemoryBarrier host_barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), host_barrier, nullptr, nullptr);
+
+    if (context.end_one_time(cmd, false) != vk::Result::eSuccess ||
+        readback.invalidate(context.m_device) != vk::Result::eSuccess)
+        return false;
+    std::vector<uint8_t> expected(static_cast<size_t>(width) * height * 4);
+    fill_virtual_page(level, x * width, y * height, width, height, expected.data());
+    return std::memcmp(readback.data<uint8_t>(), expected.data(), expected.size()) == 0;
+}
+
+/// @brief 在GPU上创建稀疏图像：请求一块区域后逐帧在稀疏队列上绑定并上传，读回比较；
+/// 再请求另一块区域使原区域被淘汰、内存被回收，最后重新请求原区域检查重新绑定的内容；不支持稀疏驻留时跳过
+bool validate_virtual_texture(int argc, char **argv)
+{
+    vl::HeadlessContext::Config config;
+    config.m_name = "virtual texture";
+    config.m_device_name = bench::get_option(argc, argv, "--device", std::string());
+    config.m_features.sparseBinding = true;
+    config.m_features.sparseResidencyImage2D = true;
+    config.m_need_sparse_binding = true;
+    if (bench::has_flag(argc, argv, "--validation"))
+        config.m_validation_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+    vl::HeadlessContext context;
+    if (context.create(config) != vk::Result::eSuccess)
+    {
+        std::cout << "vtex gpu: skipped, unable to create headless vulkan context with a sparse binding queue" << std::endl;
+        return true;
+    }
+    if (!context.m_features.sparseBinding || !context.m_features.sparseResidencyImage2D ||
+        !vl::VirtualTexture::query_page_extent(context.m_physical_device, vk::Format::eR8G8B8A8Unorm).has_value())
+    {
+        std::cout << "vtex gpu: skipped, " << context.get_device_name() << " does not support sparse residency for rgba8" << std::endl;
+        context.destroy();
+        return true;
+    }
+
+    vl::VirtualTexture::Config texture_config;
+    texture_config.m_width = texture_config.m_height = 4096;
+    texture_config.m_physical_page_count = 40;
+    texture_config.m_max_loads = 16;
+    texture_config.m_feedback_count = 1024;
+
+    vl::StagingRing ring;
+    vl::MappedBuffer readback;
+    vl::VirtualTexture texture;
+    vk::Fence fence;
+    bool is_passed = ring.create(context.m_device, context.m_physical_device, 8 * 1024 * 1024) == vk::Result::eSuccess &&
+                     texture.create(context.m_device, context.m_physical_device, texture_config, ring) == vk::Result::eSuccess;
+    if (is_passed)
+    {
+        vk::DeviceSize page_bytes = static_cast<vk::DeviceSize>(texture.get_page_width()) * texture.get_page_height() * 4;
+        is_passed = readback.create(context.m_device, context.m_physical_device, page_bytes, vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eHostCached) == vk::Result::eSuccess;
+        auto fence_result = context.m_device.createFence(vk::FenceCreateInfo());
+        is_passed &= fence_result.result == vk::Result::eSuccess;
+        fence = fence_result.value;
+    }
+
+    // 每帧先在稀疏队列上绑定并等待，再提交复制；这里直接请求页，代替着色器写入的反馈
+    uint64_t frame = 0;
+    auto run_frame = [&](uint32_t origin_x, uint32_t origin_y)
+    {
+        frame++;
+        for (uint32_t y = 0; y < 4; y++)
+            for (uint32_t x = 0; x < 4; x++)
+                texture.request(0, origin_x + x, origin_y + y, frame);
+        texture.update(frame);
+        auto command_result = context.begin_one_time(false);
+        if (command_result.result != vk::Result::eSuccess ||
+            texture.record(context.m_device, command_result.value, fill_virtual_page) != vk::Result::eSuccess ||
+            texture.bind(context.m_sparse_binding_queue, vk::Semaphore(), fence) != vk::Result::eSuccess ||
+            context.m_device.waitForFences(fence, VK_TRUE, UINT64_MAX) != vk::Result::eSuccess ||
+            context.m_device.resetFences(fence) != vk::Result::eSuccess ||
+            context.end_one_time(command_result.value, false) != vk::Result::eSuccess)
+            return false;
+        texture.submitted(frame);
+        texture.retire(frame);
+        return true;
+    };
+    auto is_region_resident = [&](uint32_t origin_x, uint32_t origin_y)
+    {
+        for (uint32_t y = 0; y < 4; y++)
+            for (uint32_t x = 0; x < 4; x++)
+                if (!texture.is_resident(0, origin_x + x, origin_y + y))
+                    return false;
+        return true;
+    };
+    auto load_region = [&](uint32_t origin_x, uint32_t origin_y)
+    {
+        uint64_t first = frame;
+        while (is_passed && frame - first < 32 && !is_region_resident(origin_x, origin_y))
+            is_passed &= run_frame(origin_x, origin_y);
+        return is_passed && is_region_resident(origin_x, origin_y);
+    };
+
+    // 区域(4,4)，之后请求右下角，父页链只在最粗的几级重合
+    vk::Extent2D count = is_passed ? texture.get_page_count(0) : vk::Extent2D(8, 8);
+    uint32_t far_x = count.width - 4, far_y = count.height - 4;
+    bool is_loaded = load_region(4, 4) &&
+                     check_virtual_page(context, readback, texture, 0, 5, 6) &&
+                     check_virtual_page(context, readback, texture, texture.get_tail_level() - 1, 0, 0);
+    uint64_t load_frames = frame;
+    bool is_moved = is_loaded && load_region(far_x, far_y) &&
+                    !texture.is_resident(0, 4, 4) &&
+                    check_virtual_page(context, readback, texture, 0, far_x + 3, far_y + 3);
+    bool is_reloaded = is_moved && load_region(4, 4) && check_virtual_page(context, readback, texture, 0, 6, 5);
+
+    std::cout << "vtex gpu: " << context.get_device_name() << ", " << texture_config.m_width << "x" << texture_config.m_height
+              << " rgba8, page " << texture.get_page_width() << "x" << texture.get_page_height()
+              << ", tail from level " << texture.get_tail_level() << ", loaded in " << load_frames << " frames, readback "
+              << (is_loaded ? "matches" : "MISMATCH") << "; moved, readback " << (is_moved ? "matches" : "MISMATCH")
+              << "; reloaded into recycled pages, readback " << (is_reloaded ? "matches" : "MISMATCH") << std::endl
+              << "vtex gpu statistics:" << texture.format();
+
+    vkDeviceWaitIdle(static_cast<VkDevice>(context.m_device));
+    if (fence)
+        context.m_device.destroyFence(fence);
+    texture.destroy(context.m_device);
+    readback.destroy(context.m_device);
+    ring.destroy(context.m_device);
+    context.destroy();
+    return is_reloaded;
+}
+
+/// @brief 虚拟纹理基准：在CPU上用合成的相机路径模拟页表和调度，可选地在GPU上验证稀疏绑定、上传和回收
+int run_virtual_texture_bench(int argc, char **argv)
+{
+    uint32_t size = static_cast<uint32_t>(bench::get_option(argc, argv, "--size", 16384LL));
+    uint32_t page_count = static_cast<uint32_t>(bench::get_option(argc, argv, "--pages", 512LL));
+    uint32_t max_loads = static_cast<uint32_t>(bench::get_option(argc, argv, "--loads", 16LL));
+    uint64_t frame_count = static_cast<uint64_t>(bench::get_option(argc, argv, "--frames", 600LL));
+    uint64_t latency = static_cast<uint64_t>(bench::get_option(argc, argv, "--latency", 2LL));
+    uint32_t seed = static_cast<uint32_t>(bench::get_option(argc, argv, "--seed", 1LL));
+    const uint64_t settle_count = 64;
+
+    vl::VirtualTexture::Config config;
+    config.m_width = config.m_height = size;
+    config.m_physical_page_count = page_count;
+    config.m_max_loads = max_loads;
+    double page_mb = config.m_page_width * config.m_page_height * 4 / 1048576.0;
+
+    std::cout << "vtex: " << size << "x" << size << " rgba8, page " << config.m_page_width << "x" << config.m_page_height
+              << ", " << page_count << " physical pages (" << page_count * page_mb << " MB), " << max_loads
+              << " loads/frame, latency " << latency << " frames, " << frame_count << " frames + " << settle_count << " to settle" << std::endl
+              << "       trace  loads  evicts  deferred  up MB  peak pages  hit %  level err  update us  result" << std::endl;
+
+    bool is_passed = true;
+    struct TraceCase
+    {
+        const char *m_name;
+        VirtualTrace m_trace;
+    };
+    for (const TraceCase &item : {TraceCase{"flyover", VirtualTrace::eFlyover},
+                                  TraceCase{"static", VirtualTrace::eStatic},
+                                  TraceCase{"teleport", VirtualTrace::eTeleport}})
+    {
+        VirtualSimulation simulation = simulate_virtual_texture(item.m_trace, config, frame_count, settle_count, latency, seed);
+        const vl::VirtualTexture::Statistics &statistics = simulation.m_statistics;
+
+        // 需要的页放不进物理页时不要求收敛
+        bool is_valid = simulation.m_violations == 0 && (simulation.m_is_converged || !simulation.m_fits);
+        is_passed &= is_valid;
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(12) << item.m_name
+                  << std::setw(7) << statistics.m_loads
+                  << std::setw(8) << statistics.m_evictions
+                  << std::setw(10) << statistics.m_deferred
+                  << std::setw(7) << statistics.m_loads * page_mb
+                  << std::setw(12) << statistics.m_peak_resident_pages
+                  << std::setw(7) << simulation.m_hit_rate * 100.0
+                  << std::setw(11) << simulation.m_level_error
+                  << std::setw(11) << bench::percentile(simulation.m_update_us, 50)
+                  << "  " << (is_valid ? (simulation.m_fits ? "ok" : "ok, does not fit") : "FAILED")
+                  << std::defaultfloat << std::endl;
+        if (!is_valid)
+            std::cout << "  " << simulation.m_violations << " page table violations, "
+                      << (simulation.m_is_converged ? "converged" : "not converged") << std::endl;
+    }
+
+    if (!bench::has_flag(argc, argv, "--cpu-only"))
+        is_passed &= validate_virtual_texture(argc, argv);
+
+    return is_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
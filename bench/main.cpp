@@ -0,0 +1,119 @@
+#include <iostream>
+#include <string>
+#include <ntl/NTL.cpp>
+#include "Bench.hpp"
+#include "EncoderBench.cpp"
+#include "LinmathBench.cpp"
+#include "TransformBench.cpp"
+#include "CubeStressBench.cpp"
+#include "CullBench.cpp"
+#include "CpuCullBench.cpp"
+#include "RenderQueueBench.cpp"
+#include "CommandListBench.cpp"
+#include "DrawBatchBench.cpp"
+#include "MeshBench.cpp"
+#include "VertexLayoutBench.cpp"
+#include "MeshFileBench.cpp"
+#include "MeshletBench.cpp"
+#include "LodBench.cpp"
+#include "TextureBench.cpp"
+#include "TextureLoaderBench.cpp"
+#include "MipBench.cpp"
+#include "CompressBench.cpp"
+#include "Ktx2Bench.cpp"
+#include "StreamBench.cpp"
+#include "VirtualTextureBench.cpp"
+#include "ObjectCacheBench.cpp"
+#include "ReflectionBench.cpp"
+#include "ShaderLibraryBench.cpp"
+#include "ReadbackBench.cpp"
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: main <benchmark> [options]" << std::endl
+                  << "  encoder   [--width w] [--height h] [--frames n] [--threads t]" << std::endl
+                  << "  linmath   [--count n] [--repeat r]" << std::endl
+                  << "  transform [--threads t] [--repeat r]" << std::endl
+                  << "  stress    [--counts 1,1000,10000,100000] [--mode all|per-object|instanced|indirect|unsorted|sorted|batched]" << std::endl
+                  << "            [--frames n] [--width w] [--height h] [--device llvmpipe] [--validation]" << std::endl
+                  << "  cull      [--counts 1000,100000,1000000] [--device llvmpipe] [--validation]" << std::endl
+                  << "  cpucull   [--counts 100000,1000000,10000000] [--threads t] [--repeat r]" << std::endl
+                  << "  queue     [--counts 10000,100000,1000000,10000000] [--pipelines p] [--sets s] [--threads t] [--repeat r]" << std::endl
+                  << "  cmdlist   [--draws n] [--pipelines p] [--sets s] [--repeat r]" << std::endl
+                  << "  batch     [--counts 1000,10000,100000,1000000] [--pipelines p] [--sets s] [--max-draw-count n] [--repeat r]" << std::endl
+                  << "  mesh      [--cache c] [--rings r] [--segments s]" << std::endl
+                  << "  vertex    [--rings r] [--segments s] [--normals n] [--repeat r]" << std::endl
+                  << "  meshfile  [--rings r] [--segments s] [--dir path] [--repeat r]" << std::endl
+                  << "  meshlet   [--rings r] [--segments s] [--terrain n] [--views v] [--cpu-only] [--device llvmpipe] [--validation]" << std::endl
+                  << "  lod       [--rings r] [--segments s] [--terrain n] [--instances n] [--frames f] [--threshold px] [--hysteresis h] [--height h]" << std::endl
+                  << "  texture   [--sizes 256,1024,4096] [--dir path] [--repeat r]" << std::endl
+                  << "  texload   [--count n] [--max-size s] [--threads t] [--ring mb] [--frame-ms ms] [--latency frames] [--dir path]" << std::endl
+                  << "  mip       [--sizes 256,1024,4096] [--repeat r] [--cpu-only] [--device llvmpipe] [--validation]" << std::endl
+                  << "  compress  [--width w] [--height h] [--threads t] [--repeat r] [--cpu-only] [--device llvmpipe] [--validation]" << std::endl
+                  << "  ktx2      [--size s] [--budget kb] [--fuzz n] [--seed s] [--dir path] [--repeat r]" << std::endl
+                  << "  stream    [--textures n] [--frames f] [--budget mb] [--upload mb] [--latency frames] [--seed s] [--dir path] [--cpu-only] [--device llvmpipe] [--validation]" << std::endl
+                  << "  vtex      [--size s] [--pages n] [--loads n] [--frames f] [--latency frames] [--seed s] [--cpu-only] [--device llvmpipe] [--validation]" << std::endl
+                  << "  cache     [--materials n] [--images n] [--repeat r] [--seed s] [--cpu-only] [--device llvmpipe] [--validation]" << std::endl
+                  << "  reflect   [--repeat r] [--cpu-only] [--device llvmpipe] [--validation]" << std::endl
+                  << "  shaderlib [--pipelines n] [--repeat r] [--dir path] [--cpu-only] [--device llvmpipe] [--validation]" << std::endl
+                  << "  readback  [--width w] [--height h] [--frames n] [--ring r] [--device llvmpipe] [--validation]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string name = argv[1];
+    if (name == "encoder")
+        return run_encoder_bench(argc - 2, argv + 2);
+    if (name == "linmath")
+        return run_linmath_bench(argc - 2, argv + 2);
+    if (name == "transform")
+        return run_transform_bench(argc - 2, argv + 2);
+    if (name == "stress")
+        return run_cube_stress_bench(argc - 2, argv + 2);
+    if (name == "cull")
+        return run_cull_bench(argc - 2, argv + 2);
+    if (name == "cpucull")
+        return run_cpu_cull_bench(argc - 2, argv + 2);
+    if (name == "queue")
+        return run_render_queue_bench(argc - 2, argv + 2);
+    if (name == "cmdlist")
+        return run_command_list_bench(argc - 2, argv + 2);
+    if (name == "batch")
+        return run_draw_batch_bench(argc - 2, argv + 2);
+    if (name == "mesh")
+        return run_mesh_bench(argc - 2, argv + 2);
+    if (name == "vertex")
+        return run_vertex_layout_bench(argc - 2, argv + 2);
+    if (name == "meshfile")
+        return run_mesh_file_bench(argc - 2, argv + 2);
+    if (name == "meshlet")
+        return run_meshlet_bench(argc - 2, argv + 2);
+    if (name == "lod")
+        return run_lod_bench(argc - 2, argv + 2);
+    if (name == "texture")
+        return run_texture_bench(argc - 2, argv + 2);
+    if (name == "texload")
+        return run_texture_loader_bench(argc - 2, argv + 2);
+    if (name == "mip")
+        return run_mip_bench(argc - 2, argv + 2);
+    if (name == "compress")
+        return run_compress_bench(argc - 2, argv + 2);
+    if (name == "ktx2")
+        return run_ktx2_bench(argc - 2, argv + 2);
+    if (name == "stream")
+        return run_stream_bench(argc - 2, argv + 2);
+    if (name == "vtex")
+        return run_virtual_texture_bench(argc - 2, argv + 2);
+    if (name == "cache")
+        return run_object_cache_bench(argc - 2, argv + 2);
+    if (name == "reflect")
+        return run_reflection_bench(argc - 2, argv + 2);
+    if (name == "shaderlib")
+        return run_shader_library_bench(argc - 2, argv + 2);
+    if (name == "readback")
+        return run_readback_bench(argc - 2, argv + 2);
+
+    std::cout << "unknown benchmark: " << name << std::endl;
+    return EXIT_FAILURE;
+}
\ No newline at end of file
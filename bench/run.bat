@@ -0,0 +1,36 @@
+set filename=main
+glslangValidator -V -x -o shaders/stress.vert.inc shaders/stress.vert
+glslangValidator -V -x -o shaders/stress.frag.inc shaders/stress.frag
+glslangValidator -V -x -o shaders/cull.comp.inc ../src/shaders/cull.comp
+glslangValidator -V -x -o shaders/hiz.comp.inc ../src/shaders/hiz.comp
+glslangValidator -V -x -o shaders/cluster.comp.inc ../src/shaders/cluster.comp
+glslangValidator -V -x -o shaders/mip.comp.inc ../src/shaders/mip.comp
+g++ -std=c++17 -O2 -march=native -finput-charset=UTF-8 -fexec-charset=gbk ^
+    "%filename%.cpp" -o "%filename%.exe" ^
+    -lvulkan-1 ^
+    -I E:/C++/Project_Neutron/.release/
+"%filename%.exe" encoder
+"%filename%.exe" linmath
+"%filename%.exe" transform
+"%filename%.exe" stress
+"%filename%.exe" cull
+"%filename%.exe" cpucull
+"%filename%.exe" queue
+"%filename%.exe" cmdlist
+"%filename%.exe" batch
+"%filename%.exe" mesh
+"%filename%.exe" vertex
+"%filename%.exe" meshfile
+"%filename%.exe" meshlet
+"%filename%.exe" lod
+"%filename%.exe" texture
+"%filename%.exe" texload
+"%filename%.exe" mip
+"%filename%.exe" compress
+"%filename%.exe" ktx2
+"%filename%.exe" stream
+"%filename%.exe" vtex
+"%filename%.exe" cache
+"%filename%.exe" reflect
+"%filename%.exe" shaderlib
+"%filename%.exe" readback
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 450
+
+// 管线变体的亮度，用来模拟不同的材质
+layout(constant_id = 0) const float brightness = 1.0;
+
+layout(location = 0) in vec3 in_color;
+
+layout(location = 0) out vec4 out_color;
+
+void main()
+{
+    out_color = vec4(in_color * brightness, 1.0);
+}
\ No newline at end of file
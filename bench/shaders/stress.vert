@@ -0,0 +1,21 @@
+#version 450
+
+// 每个实例的MVP，由TransformStore写入
+layout(std430, set = 0, binding = 0) readonly buffer Instances
+{
+    mat4 mvp[];
+} instances;
+
+layout(location = 0) in vec3 in_position;
+
+layout(location = 0) out vec3 out_color;
+
+void main()
+{
+    // gl_InstanceIndex包含firstInstance，逐个绘制和间接绘制也能取到自己的矩阵
+    gl_Position = instances.mvp[gl_InstanceIndex] * vec4(in_position, 1.0);
+
+    uint id = uint(gl_InstanceIndex) * 2654435761u;
+    vec3 tint = vec3(float(id & 255u), float((id >> 8) & 255u), float((id >> 16) & 255u)) / 255.0;
+    out_color = tint * 0.6 + (in_position * 0.2 + 0.2);
+}
\ No newline at end of file
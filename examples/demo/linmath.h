@@ -23,6 +23,33 @@
 
 #include <math.h>
 
+/* SIMD backend, selected at compile time. Define LINMATH_NO_SIMD to force the
+ * scalar code. Every accelerated function keeps its scalar version under the
+ * *_scalar name so both can be compared; results agree within float rounding. */
+#if !defined(LINMATH_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LINMATH_SSE2
+#include <emmintrin.h>
+#if defined(__AVX__)
+#define LINMATH_AVX
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define LINMATH_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(LINMATH_AVX)
+#define LINMATH_SIMD_NAME "avx"
+#elif defined(LINMATH_SSE2)
+#define LINMATH_SIMD_NAME "sse2"
+#elif defined(LINMATH_NEON)
+#define LINMATH_SIMD_NAME "neon"
+#else
+#define LINMATH_SIMD_NAME "scalar"
+#endif
+
 // Converts degrees to radians.
 #define degreesToRadians(angleDegrees) (angleDegrees * M_PI / 180.0)
 
@@ -65,24 +92,65 @@ static inline void vec3_reflect(vec3 r, vec3 const v, vec3 const n) {
 }
 
 typedef float vec4[4];
-static inline void vec4_add(vec4 r, vec4 const a, vec4 const b) {
+static inline void vec4_add_scalar(vec4 r, vec4 const a, vec4 const b) {
     int i;
     for (i = 0; i < 4; ++i) r[i] = a[i] + b[i];
 }
-static inline void vec4_sub(vec4 r, vec4 const a, vec4 const b) {
+static inline void vec4_add(vec4 r, vec4 const a, vec4 const b) {
+#if defined(LINMATH_SSE2)
+    _mm_storeu_ps(r, _mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+#elif defined(LINMATH_NEON)
+    vst1q_f32(r, vaddq_f32(vld1q_f32(a), vld1q_f32(b)));
+#else
+    vec4_add_scalar(r, a, b);
+#endif
+}
+static inline void vec4_sub_scalar(vec4 r, vec4 const a, vec4 const b) {
     int i;
     for (i = 0; i < 4; ++i) r[i] = a[i] - b[i];
 }
-static inline void vec4_scale(vec4 r, vec4 v, float s) {
+static inline void vec4_sub(vec4 r, vec4 const a, vec4 const b) {
+#if defined(LINMATH_SSE2)
+    _mm_storeu_ps(r, _mm_sub_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+#elif defined(LINMATH_NEON)
+    vst1q_f32(r, vsubq_f32(vld1q_f32(a), vld1q_f32(b)));
+#else
+    vec4_sub_scalar(r, a, b);
+#endif
+}
+static inline void vec4_scale_scalar(vec4 r, vec4 v, float s) {
     int i;
     for (i = 0; i < 4; ++i) r[i] = v[i] * s;
 }
-static inline float vec4_mul_inner(vec4 a, vec4 b) {
+static inline void vec4_scale(vec4 r, vec4 v, float s) {
+#if defined(LINMATH_SSE2)
+    _mm_storeu_ps(r, _mm_mul_ps(_mm_loadu_ps(v), _mm_set1_ps(s)));
+#elif defined(LINMATH_NEON)
+    vst1q_f32(r, vmulq_n_f32(vld1q_f32(v), s));
+#else
+    vec4_scale_scalar(r, v, s);
+#endif
+}
+static inline float vec4_mul_inner_scalar(vec4 a, vec4 b) {
     float p = 0.f;
     int i;
     for (i = 0; i < 4; ++i) p += b[i] * a[i];
     return p;
 }
+static inline float vec4_mul_inner(vec4 a, vec4 b) {
+#if defined(LINMATH_SSE2)
+    __m128 p = _mm_mul_ps(_mm_loadu_ps(a), _mm_loadu_ps(b));
+    p = _mm_add_ps(p, _mm_movehl_ps(p, p));
+    p = _mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(p);
+#elif defined(LINMATH_NEON)
+    float32x4_t p = vmulq_f32(vld1q_f32(a), vld1q_f32(b));
+    float32x2_t s = vadd_f32(vget_low_f32(p), vget_high_f32(p));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+#else
+    return vec4_mul_inner_scalar(a, b);
+#endif
+}
 static inline void vec4_mul_cross(vec4 r, vec4 a, vec4 b) {
     r[0] = a[1] * b[2] - a[2] * b[1];
     r[1] = a[2] * b[0] - a[0] * b[2];
@@ -119,22 +187,71 @@ static inline void mat4x4_col(vec4 r, mat4x4 M, int i) {
     int k;
     for (k = 0; k < 4; ++k) r[k] = M[i][k];
 }
-static inline void mat4x4_transpose(mat4x4 M, mat4x4 N) {
+static inline void mat4x4_transpose_scalar(mat4x4 M, mat4x4 N) {
     int i, j;
     for (j = 0; j < 4; ++j)
         for (i = 0; i < 4; ++i) M[i][j] = N[j][i];
 }
+static inline void mat4x4_transpose(mat4x4 M, mat4x4 N) {
+#if defined(LINMATH_SSE2)
+    __m128 c0 = _mm_loadu_ps(N[0]);
+    __m128 c1 = _mm_loadu_ps(N[1]);
+    __m128 c2 = _mm_loadu_ps(N[2]);
+    __m128 c3 = _mm_loadu_ps(N[3]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(M[0], c0);
+    _mm_storeu_ps(M[1], c1);
+    _mm_storeu_ps(M[2], c2);
+    _mm_storeu_ps(M[3], c3);
+#elif defined(LINMATH_NEON)
+    float32x4x4_t c = vld4q_f32(N[0]);
+    vst1q_f32(M[0], c.val[0]);
+    vst1q_f32(M[1], c.val[1]);
+    vst1q_f32(M[2], c.val[2]);
+    vst1q_f32(M[3], c.val[3]);
+#else
+    mat4x4_transpose_scalar(M, N);
+#endif
+}
+static inline void mat4x4_add_scalar(mat4x4 M, mat4x4 a, mat4x4 b) {
+    int i;
+    for (i = 0; i < 4; ++i) vec4_add_scalar(M[i], a[i], b[i]);
+}
 static inline void mat4x4_add(mat4x4 M, mat4x4 a, mat4x4 b) {
+#if defined(LINMATH_AVX)
+    _mm256_storeu_ps(M[0], _mm256_add_ps(_mm256_loadu_ps(a[0]), _mm256_loadu_ps(b[0])));
+    _mm256_storeu_ps(M[2], _mm256_add_ps(_mm256_loadu_ps(a[2]), _mm256_loadu_ps(b[2])));
+#else
     int i;
     for (i = 0; i < 4; ++i) vec4_add(M[i], a[i], b[i]);
+#endif
+}
+static inline void mat4x4_sub_scalar(mat4x4 M, mat4x4 a, mat4x4 b) {
+    int i;
+    for (i = 0; i < 4; ++i) vec4_sub_scalar(M[i], a[i], b[i]);
 }
 static inline void mat4x4_sub(mat4x4 M, mat4x4 a, mat4x4 b) {
+#if defined(LINMATH_AVX)
+    _mm256_storeu_ps(M[0], _mm256_sub_ps(_mm256_loadu_ps(a[0]), _mm256_loadu_ps(b[0])));
+    _mm256_storeu_ps(M[2], _mm256_sub_ps(_mm256_loadu_ps(a[2]), _mm256_loadu_ps(b[2])));
+#else
     int i;
     for (i = 0; i < 4; ++i) vec4_sub(M[i], a[i], b[i]);
+#endif
+}
+static inline void mat4x4_scale_scalar(mat4x4 M, mat4x4 a, float k) {
+    int i;
+    for (i = 0; i < 4; ++i) vec4_scale_scalar(M[i], a[i], k);
 }
 static inline void mat4x4_scale(mat4x4 M, mat4x4 a, float k) {
+#if defined(LINMATH_AVX)
+    __m256 s = _mm256_set1_ps(k);
+    _mm256_storeu_ps(M[0], _mm256_mul_ps(_mm256_loadu_ps(a[0]), s));
+    _mm256_storeu_ps(M[2], _mm256_mul_ps(_mm256_loadu_ps(a[2]), s));
+#else
     int i;
     for (i = 0; i < 4; ++i) vec4_scale(M[i], a[i], k);
+#endif
 }
 static inline void mat4x4_scale_aniso(mat4x4 M, mat4x4 a, float x, float y, float z) {
     int i;
@@ -145,7 +262,7 @@ static inline void mat4x4_scale_aniso(mat4x4 M, mat4x4 a, float x, float y, floa
         M[3][i] = a[3][i];
     }
 }
-static inline void mat4x4_mul(mat4x4 M, mat4x4 a, mat4x4 b) {
+static inline void mat4x4_mul_scalar(mat4x4 M, mat4x4 a, mat4x4 b) {
     int k, r, c;
     for (c = 0; c < 4; ++c)
         for (r = 0; r < 4; ++r) {
@@ -153,34 +270,123 @@ static inline void mat4x4_mul(mat4x4 M, mat4x4 a, mat4x4 b) {
             for (k = 0; k < 4; ++k) M[c][r] += a[k][r] * b[c][k];
         }
 }
-static inline void mat4x4_mul_vec4(vec4 r, mat4x4 M, vec4 v) {
+/* The SIMD versions load both operands before storing, so M may alias a or b. */
+static inline void mat4x4_mul(mat4x4 M, mat4x4 a, mat4x4 b) {
+#if defined(LINMATH_AVX)
+    /* Two result columns per register: each 128-bit lane holds one column of b. */
+    __m256 a0 = _mm256_broadcast_ps((__m128 const *)a[0]);
+    __m256 a1 = _mm256_broadcast_ps((__m128 const *)a[1]);
+    __m256 a2 = _mm256_broadcast_ps((__m128 const *)a[2]);
+    __m256 a3 = _mm256_broadcast_ps((__m128 const *)a[3]);
+    __m256 b01 = _mm256_loadu_ps(b[0]);
+    __m256 b23 = _mm256_loadu_ps(b[2]);
+    __m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, 0x00));
+    __m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, 0x00));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(a1, _mm256_permute_ps(b01, 0x55)));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(a1, _mm256_permute_ps(b23, 0x55)));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(a2, _mm256_permute_ps(b01, 0xAA)));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(a2, _mm256_permute_ps(b23, 0xAA)));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(a3, _mm256_permute_ps(b01, 0xFF)));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(a3, _mm256_permute_ps(b23, 0xFF)));
+    _mm256_storeu_ps(M[0], r01);
+    _mm256_storeu_ps(M[2], r23);
+#elif defined(LINMATH_SSE2)
+    __m128 a0 = _mm_loadu_ps(a[0]);
+    __m128 a1 = _mm_loadu_ps(a[1]);
+    __m128 a2 = _mm_loadu_ps(a[2]);
+    __m128 a3 = _mm_loadu_ps(a[3]);
+    __m128 r[4];
+    int c;
+    for (c = 0; c < 4; ++c) {
+        __m128 bc = _mm_loadu_ps(b[c]);
+        __m128 t = _mm_mul_ps(a0, _mm_shuffle_ps(bc, bc, 0x00));
+        t = _mm_add_ps(t, _mm_mul_ps(a1, _mm_shuffle_ps(bc, bc, 0x55)));
+        t = _mm_add_ps(t, _mm_mul_ps(a2, _mm_shuffle_ps(bc, bc, 0xAA)));
+        r[c] = _mm_add_ps(t, _mm_mul_ps(a3, _mm_shuffle_ps(bc, bc, 0xFF)));
+    }
+    for (c = 0; c < 4; ++c) _mm_storeu_ps(M[c], r[c]);
+#elif defined(LINMATH_NEON)
+    float32x4_t a0 = vld1q_f32(a[0]);
+    float32x4_t a1 = vld1q_f32(a[1]);
+    float32x4_t a2 = vld1q_f32(a[2]);
+    float32x4_t a3 = vld1q_f32(a[3]);
+    float32x4_t r[4];
+    int c;
+    for (c = 0; c < 4; ++c) {
+        float32x4_t bc = vld1q_f32(b[c]);
+        float32x4_t t = vmulq_lane_f32(a0, vget_low_f32(bc), 0);
+        t = vmlaq_lane_f32(t, a1, vget_low_f32(bc), 1);
+        t = vmlaq_lane_f32(t, a2, vget_high_f32(bc), 0);
+        r[c] = vmlaq_lane_f32(t, a3, vget_high_f32(bc), 1);
+    }
+    for (c = 0; c < 4; ++c) vst1q_f32(M[c], r[c]);
+#else
+    mat4x4_mul_scalar(M, a, b);
+#endif
+}
+static inline void mat4x4_mul_vec4_scalar(vec4 r, mat4x4 M, vec4 v) {
     int i, j;
     for (j = 0; j < 4; ++j) {
         r[j] = 0.f;
         for (i = 0; i < 4; ++i) r[j] += M[i][j] * v[i];
     }
 }
+static inline void mat4x4_mul_vec4(vec4 r, mat4x4 M, vec4 v) {
+#if defined(LINMATH_SSE2)
+    __m128 x = _mm_loadu_ps(v);
+    __m128 t = _mm_mul_ps(_mm_loadu_ps(M[0]), _mm_shuffle_ps(x, x, 0x00));
+    t = _mm_add_ps(t, _mm_mul_ps(_mm_loadu_ps(M[1]), _mm_shuffle_ps(x, x, 0x55)));
+    t = _mm_add_ps(t, _mm_mul_ps(_mm_loadu_ps(M[2]), _mm_shuffle_ps(x, x, 0xAA)));
+    t = _mm_add_ps(t, _mm_mul_ps(_mm_loadu_ps(M[3]), _mm_shuffle_ps(x, x, 0xFF)));
+    _mm_storeu_ps(r, t);
+#elif defined(LINMATH_NEON)
+    float32x4_t x = vld1q_f32(v);
+    float32x4_t t = vmulq_lane_f32(vld1q_f32(M[0]), vget_low_f32(x), 0);
+    t = vmlaq_lane_f32(t, vld1q_f32(M[1]), vget_low_f32(x), 1);
+    t = vmlaq_lane_f32(t, vld1q_f32(M[2]), vget_high_f32(x), 0);
+    t = vmlaq_lane_f32(t, vld1q_f32(M[3]), vget_high_f32(x), 1);
+    vst1q_f32(r, t);
+#else
+    mat4x4_mul_vec4_scalar(r, M, v);
+#endif
+}
 static inline void mat4x4_translate(mat4x4 T, float x, float y, float z) {
     mat4x4_identity(T);
     T[3][0] = x;
     T[3][1] = y;
     T[3][2] = z;
 }
-static inline void mat4x4_translate_in_place(mat4x4 M, float x, float y, float z) {
+static inline void mat4x4_translate_in_place_scalar(mat4x4 M, float x, float y, float z) {
     vec4 t = {x, y, z, 0};
     vec4 r;
     int i;
     for (i = 0; i < 4; ++i) {
         mat4x4_row(r, M, i);
-        M[3][i] += vec4_mul_inner(r, t);
+        M[3][i] += vec4_mul_inner_scalar(r, t);
     }
 }
+static inline void mat4x4_translate_in_place(mat4x4 M, float x, float y, float z) {
+#if defined(LINMATH_SSE2)
+    /* The row dot products are the same as a sum of scaled columns. */
+    __m128 t = _mm_mul_ps(_mm_loadu_ps(M[0]), _mm_set1_ps(x));
+    t = _mm_add_ps(t, _mm_mul_ps(_mm_loadu_ps(M[1]), _mm_set1_ps(y)));
+    t = _mm_add_ps(t, _mm_mul_ps(_mm_loadu_ps(M[2]), _mm_set1_ps(z)));
+    _mm_storeu_ps(M[3], _mm_add_ps(_mm_loadu_ps(M[3]), t));
+#elif defined(LINMATH_NEON)
+    float32x4_t t = vmulq_n_f32(vld1q_f32(M[0]), x);
+    t = vmlaq_n_f32(t, vld1q_f32(M[1]), y);
+    t = vmlaq_n_f32(t, vld1q_f32(M[2]), z);
+    vst1q_f32(M[3], vaddq_f32(vld1q_f32(M[3]), t));
+#else
+    mat4x4_translate_in_place_scalar(M, x, y, z);
+#endif
+}
 static inline void mat4x4_from_vec3_mul_outer(mat4x4 M, vec3 a, vec3 b) {
     int i, j;
     for (i = 0; i < 4; ++i)
         for (j = 0; j < 4; ++j) M[i][j] = i < 3 && j < 3 ? a[i] * b[j] : 0.f;
 }
-static inline void mat4x4_rotate(mat4x4 R, mat4x4 M, float x, float y, float z, float angle) {
+static inline void mat4x4_rotate_scalar(mat4x4 R, mat4x4 M, float x, float y, float z, float angle) {
     float s = sinf(angle);
     float c = cosf(angle);
     vec3 u = {x, y, z};
@@ -191,42 +397,78 @@ static inline void mat4x4_rotate(mat4x4 R, mat4x4 M, float x, float y, float z,
         mat4x4_from_vec3_mul_outer(T, u, u);
 
         mat4x4 S = {{0, u[2], -u[1], 0}, {-u[2], 0, u[0], 0}, {u[1], -u[0], 0, 0}, {0, 0, 0, 0}};
-        mat4x4_scale(S, S, s);
+        mat4x4_scale_scalar(S, S, s);
 
         mat4x4 C;
         mat4x4_identity(C);
-        mat4x4_sub(C, C, T);
+        mat4x4_sub_scalar(C, C, T);
 
-        mat4x4_scale(C, C, c);
+        mat4x4_scale_scalar(C, C, c);
 
-        mat4x4_add(T, T, C);
-        mat4x4_add(T, T, S);
+        mat4x4_add_scalar(T, T, C);
+        mat4x4_add_scalar(T, T, S);
 
         T[3][3] = 1.;
+        mat4x4_mul_scalar(R, M, T);
+    } else {
+        mat4x4_dup(R, M);
+    }
+}
+static inline void mat4x4_rotate(mat4x4 R, mat4x4 M, float x, float y, float z, float angle) {
+    float s = sinf(angle);
+    float c = cosf(angle);
+    vec3 u = {x, y, z};
+
+    if (vec3_len(u) > 1e-4) {
+        /* Same matrix as uu^T + (I - uu^T) * c + S * s, built directly. */
+        vec3_norm(u, u);
+        float k = 1.f - c;
+        mat4x4 T = {{u[0] * u[0] * k + c, u[1] * u[0] * k + u[2] * s, u[2] * u[0] * k - u[1] * s, 0.f},
+                    {u[0] * u[1] * k - u[2] * s, u[1] * u[1] * k + c, u[2] * u[1] * k + u[0] * s, 0.f},
+                    {u[0] * u[2] * k + u[1] * s, u[1] * u[2] * k - u[0] * s, u[2] * u[2] * k + c, 0.f},
+                    {0.f, 0.f, 0.f, 1.f}};
         mat4x4_mul(R, M, T);
     } else {
         mat4x4_dup(R, M);
     }
 }
+static inline void mat4x4_rotate_X_scalar(mat4x4 Q, mat4x4 M, float angle) {
+    float s = sinf(angle);
+    float c = cosf(angle);
+    mat4x4 R = {{1.f, 0.f, 0.f, 0.f}, {0.f, c, s, 0.f}, {0.f, -s, c, 0.f}, {0.f, 0.f, 0.f, 1.f}};
+    mat4x4_mul_scalar(Q, M, R);
+}
 static inline void mat4x4_rotate_X(mat4x4 Q, mat4x4 M, float angle) {
     float s = sinf(angle);
     float c = cosf(angle);
     mat4x4 R = {{1.f, 0.f, 0.f, 0.f}, {0.f, c, s, 0.f}, {0.f, -s, c, 0.f}, {0.f, 0.f, 0.f, 1.f}};
     mat4x4_mul(Q, M, R);
 }
+static inline void mat4x4_rotate_Y_scalar(mat4x4 Q, mat4x4 M, float angle) {
+    float s = sinf(angle);
+    float c = cosf(angle);
+    mat4x4 R = {{c, 0.f, s, 0.f}, {0.f, 1.f, 0.f, 0.f}, {-s, 0.f, c, 0.f}, {0.f, 0.f, 0.f, 1.f}};
+    mat4x4_mul_scalar(Q, M, R);
+}
 static inline void mat4x4_rotate_Y(mat4x4 Q, mat4x4 M, float angle) {
     float s = sinf(angle);
     float c = cosf(angle);
     mat4x4 R = {{c, 0.f, s, 0.f}, {0.f, 1.f, 0.f, 0.f}, {-s, 0.f, c, 0.f}, {0.f, 0.f, 0.f, 1.f}};
     mat4x4_mul(Q, M, R);
 }
+static inline void mat4x4_rotate_Z_scalar(mat4x4 Q, mat4x4 M, float angle) {
+    float s = sinf(angle);
+    float c = cosf(angle);
+    mat4x4 R = {{c, s, 0.f, 0.f}, {-s, c, 0.f, 0.f}, {0.f, 0.f, 1.f, 0.f}, {0.f, 0.f, 0.f, 1.f}};
+    mat4x4_mul_scalar(Q, M, R);
+}
 static inline void mat4x4_rotate_Z(mat4x4 Q, mat4x4 M, float angle) {
     float s = sinf(angle);
     float c = cosf(angle);
     mat4x4 R = {{c, s, 0.f, 0.f}, {-s, c, 0.f, 0.f}, {0.f, 0.f, 1.f, 0.f}, {0.f, 0.f, 0.f, 1.f}};
     mat4x4_mul(Q, M, R);
 }
-static inline void mat4x4_invert(mat4x4 T, mat4x4 M) {
+static inline void mat4x4_invert_scalar(mat4x4 T, mat4x4 M) {
     float s[6];
     float c[6];
     s[0] = M[0][0] * M[1][1] - M[1][0] * M[0][1];
@@ -266,6 +508,72 @@ static inline void mat4x4_invert(mat4x4 T, mat4x4 M) {
     T[3][2] = (-M[3][0] * s[3] + M[3][1] * s[1] - M[3][2] * s[0]) * idet;
     T[3][3] = (M[2][0] * s[3] - M[2][1] * s[1] + M[2][2] * s[0]) * idet;
 }
+static inline void mat4x4_invert(mat4x4 T, mat4x4 M) {
+#if defined(LINMATH_SSE2)
+    /* Block-wise inverse on 2x2 sub-matrices. It works the same on rows or
+     * columns, so the column-major storage needs no special handling.
+     * Assumes it is invertible. */
+    __m128 m0 = _mm_loadu_ps(M[0]);
+    __m128 m1 = _mm_loadu_ps(M[1]);
+    __m128 m2 = _mm_loadu_ps(M[2]);
+    __m128 m3 = _mm_loadu_ps(M[3]);
+
+    __m128 A = _mm_movelh_ps(m0, m1);
+    __m128 B = _mm_movehl_ps(m1, m0);
+    __m128 C = _mm_movelh_ps(m2, m3);
+    __m128 D = _mm_movehl_ps(m3, m2);
+
+    /* (|A| |B| |C| |D|) */
+    __m128 det = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(m0, m2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(m1, m3, _MM_SHUFFLE(3, 1, 3, 1))),
+                            _mm_mul_ps(_mm_shuffle_ps(m0, m2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(m1, m3, _MM_SHUFFLE(2, 0, 2, 0))));
+    __m128 det_a = _mm_shuffle_ps(det, det, 0x00);
+    __m128 det_b = _mm_shuffle_ps(det, det, 0x55);
+    __m128 det_c = _mm_shuffle_ps(det, det, 0xAA);
+    __m128 det_d = _mm_shuffle_ps(det, det, 0xFF);
+
+/* 2x2 helpers on (x y z w) = |x y; z w|: product, adjugate * B, A * adjugate */
+#define LINMATH_MAT2_MUL(a, b)                                                     \
+    _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))), \
+               _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))))
+#define LINMATH_MAT2_ADJ_MUL(a, b)                                                                  \
+    _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),                  \
+               _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))))
+#define LINMATH_MAT2_MUL_ADJ(a, b)                                                 \
+    _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))), \
+               _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))))
+
+    __m128 dc = LINMATH_MAT2_ADJ_MUL(D, C);
+    __m128 ab = LINMATH_MAT2_ADJ_MUL(A, B);
+    __m128 X = _mm_sub_ps(_mm_mul_ps(det_d, A), LINMATH_MAT2_MUL(B, dc));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(det_a, D), LINMATH_MAT2_MUL(C, ab));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(det_b, C), LINMATH_MAT2_MUL_ADJ(D, ab));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(det_c, B), LINMATH_MAT2_MUL_ADJ(A, dc));
+
+#undef LINMATH_MAT2_MUL
+#undef LINMATH_MAT2_ADJ_MUL
+#undef LINMATH_MAT2_MUL_ADJ
+
+    /* |M| = |A||D| + |B||C| - tr((A#B)(D#C)) */
+    __m128 tr = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+    tr = _mm_add_ps(tr, _mm_movehl_ps(tr, tr));
+    tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 1, 1, 1)));
+    tr = _mm_shuffle_ps(tr, tr, 0x00);
+    __m128 det_m = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), tr);
+
+    __m128 rdet = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), det_m);
+    X = _mm_mul_ps(X, rdet);
+    Y = _mm_mul_ps(Y, rdet);
+    Z = _mm_mul_ps(Z, rdet);
+    W = _mm_mul_ps(W, rdet);
+
+    _mm_storeu_ps(T[0], _mm_shuffle_ps(X, Y, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(T[1], _mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 2, 0, 2)));
+    _mm_storeu_ps(T[2], _mm_shuffle_ps(Z, W, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(T[3], _mm_shuffle_ps(Z, W, _MM_SHUFFLE(0, 2, 0, 2)));
+#else
+    mat4x4_invert_scalar(T, M);
+#endif
+}
 static inline void mat4x4_orthonormalize(mat4x4 R, mat4x4 M) {
     mat4x4_dup(R, M);
     float s = 1.;
@@ -0,0 +1,393 @@
+#ifndef __VL_CLUSTERCULLER_CPP__
+#define __VL_CLUSTERCULLER_CPP__
+
+#include <algorithm>
+#include <cstring>
+#include "ClusterCuller.hpp"
+#include "DeviceUtils.hpp"
+
+namespace vl
+{
+    static_assert(sizeof(ClusterCuller::Cluster) == 64, "ClusterCuller::Cluster must match the std430 layout");
+    static_assert(sizeof(ClusterCuller::Uniforms) == 192, "ClusterCuller::Uniforms must match the std140 layout");
+
+    vk::Result
+    ClusterCuller::create(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        const DefaultQueueFamilyIndices &indices,
+        const Config &config)
+    {
+        if (config.m_max_clusters == 0 || config.m_max_instances == 0 || config.m_code == nullptr ||
+            static_cast<uint64_t>(config.m_max_clusters) * config.m_max_instances > UINT32_MAX ||
+            !indices.m_graphics_family.has_value() || !indices.m_compute_family.has_value())
+        {
+            ntl::log.loge(
+                NTL_STRING("ClusterCuller::create"),
+                NTL_STRING("Invalid config"));
+            return vk::Result::eErrorInitializationFailed;
+        }
+
+        m_device = device;
+        m_config = config;
+
+        // 绘制命令和数量由计算系列写入，图形系列读取
+        std::vector<uint32_t> families = {*indices.m_compute_family, *indices.m_graphics_family};
+        vk::BufferUsageFlags output_usage =
+            vk::BufferUsageFlagBits::eStorageBuffer |
+            vk::BufferUsageFlagBits::eIndirectBuffer |
+            vk::BufferUsageFlagBits::eTransferSrc |
+            vk::BufferUsageFlagBits::eTransferDst;
+
+        vk::Result result = m_cluster_buffer.create(
+            m_device,
+            physical_device,
+            sizeof(Cluster) * config.m_max_clusters,
+            vk::BufferUsageFlagBits::eStorageBuffer);
+        if (result == vk::Result::eSuccess)
+            result = m_instance_buffer.create(
+                m_device,
+                physical_device,
+                sizeof(Instance) * config.m_max_instances,
+                vk::BufferUsageFlagBits::eStorageBuffer);
+        if (result == vk::Result::eSuccess)
+            result = create_buffer(
+                physical_device,
+                sizeof(VkDrawIndexedIndirectCommand) * static_cast<vk::DeviceSize>(get_max_draw_count()),
+                output_usage,
+                families,
+                m_draw_buffer,
+                m_draw_memory);
+        if (result == vk::Result::eSuccess)
+            result = create_buffer(
+                physical_device,
+                sizeof(uint32_t),
+                output_usage,
+                families,
+                m_count_buffer,
+                m_count_memory);
+        if (result == vk::Result::eSuccess)
+            result = create_buffer(
+                physical_device,
+                sizeof(Uniforms),
+                vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                {},
+                m_uniform_buffer,
+                m_uniform_memory);
+        if (result == vk::Result::eSuccess)
+            result = create_pipeline();
+        if (result != vk::Result::eSuccess)
+        {
+            ntl::log.loge(
+                NTL_STRING("ClusterCuller::create"),
+                ntl::StringUtils::to_string(
+                    NTL_STRING("Failed to create culler, error code:"),
+                    static_cast<long>(result)));
+            destroy();
+            return result;
+        }
+
+        if (config.m_is_draw_indirect_count_enabled)
+            m_draw_indexed_indirect_count = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                m_device.getProcAddr("vkCmdDrawIndexedIndirectCountKHR"));
+
+        return vk::Result::eSuccess;
+    }
+
+    void
+    ClusterCuller::destroy()
+    {
+        if (!m_device)
+            return;
+
+        if (m_pipeline)
+            m_device.destroyPipeline(m_pipeline);
+        if (m_pipeline_layout)
+            m_device.destroyPipelineLayout(m_pipeline_layout);
+        if (m_descriptor_pool)
+            m_device.destroyDescriptorPool(m_descriptor_pool);
+        if (m_set_layout)
+            m_device.destroyDescriptorSetLayout(m_set_layout);
+
+        const vk::Buffer buffers[] = {m_draw_buffer, m_count_buffer, m_uniform_buffer};
+        const vk::DeviceMemory memories[] = {m_draw_memory, m_count_memory, m_uniform_memory};
+        for (size_t i = 0; i < 3; i++)
+        {
+            if (buffers[i])
+                m_device.destroyBuffer(buffers[i]);
+            if (memories[i])
+                m_device.freeMemory(memories[i]);
+        }
+        m_cluster_buffer.destroy(m_device);
+        m_instance_buffer.destroy(m_device);
+
+        m_pipeline = nullptr;
+        m_pipeline_layout = nullptr;
+        m_descriptor_pool = nullptr;
+        m_set_layout = nullptr;
+        m_set = nullptr;
+        m_draw_buffer = nullptr;
+        m_draw_memory = nullptr;
+        m_count_buffer = nullptr;
+        m_count_memory = nullptr;
+        m_uniform_buffer = nullptr;
+        m_uniform_memory = nullptr;
+        m_draw_indexed_indirect_count = nullptr;
+        m_device = nullptr;
+    }
+
+    ClusterCuller::Cluster *
+    ClusterCuller::get_clusters() const noexcept
+    {
+        return m_cluster_buffer.data<Cluster>();
+    }
+
+    ClusterCuller::Instance *
+    ClusterCuller::get_instances() const noexcept
+    {
+        return m_instance_buffer.data<Instance>();
+    }
+
+    uint32_t
+    ClusterCuller::set_clusters(
+        const std::vector<MeshletUtils::Meshlet> &meshlets,
+        const std::vector<MeshletUtils::Bounds> &bounds,
+        uint32_t first_cluster,
+        uint32_t first_index,
+        int32_t vertex_offset) const noexcept
+    {
+        Cluster *clusters = get_clusters();
+        if (clusters == nullptr || first_cluster >= m_config.m_max_clusters)
+            return 0;
+
+        size_t count = std::min({meshlets.size(), bounds.size(), static_cast<size_t>(m_config.m_max_clusters - first_cluster)});
+        for (size_t i = 0; i < count; i++)
+        {
+            Cluster &cluster = clusters[first_cluster + i];
+            cluster.m_bounds = bounds[i];
+            cluster.m_index_count = meshlets[i].m_triangle_count * 3;
+            cluster.m_first_index = first_index + meshlets[i].m_triangle_offset * 3;
+            cluster.m_vertex_offset = vertex_offset;
+            cluster.m_reserved = 0;
+        }
+        return static_cast<uint32_t>(count);
+    }
+
+    void
+    ClusterCuller::record_cull(
+        const vk::CommandBuffer &command_buffer,
+        const float view_projection[16],
+        const float camera_position[3],
+        uint32_t cluster_count,
+        uint32_t instance_count,
+        bool is_cone_enabled)
+    {
+        cluster_count = std::min(cluster_count, m_config.m_max_clusters);
+        instance_count = std::min(instance_count, m_config.m_max_instances);
+
+        Uniforms uniforms;
+        std::memcpy(uniforms.m_view_projection, view_projection, sizeof(uniforms.m_view_projection));
+        FrustumUtils::extract_planes(view_projection, uniforms.m_planes);
+        std::memcpy(uniforms.m_camera_position, camera_position, sizeof(float) * 3);
+        uniforms.m_camera_position[3] = 1.0f;
+        uniforms.m_cluster_count = cluster_count;
+        uniforms.m_instance_count = instance_count;
+        uniforms.m_is_cone_enabled = is_cone_enabled ? 1 : 0;
+        uniforms.m_reserved = 0;
+
+        // 上一帧的间接绘制和剔除完成后才能覆盖输出
+        vk::MemoryBarrier barrier;
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            barrier,
+            nullptr,
+            nullptr);
+
+        command_buffer.fillBuffer(m_count_buffer, 0, VK_WHOLE_SIZE, 0);
+        // 没有绘制数量时按最大数量绘制，多余的命令需要实例数为0
+        if (!m_draw_indexed_indirect_count)
+            command_buffer.fillBuffer(m_draw_buffer, 0, VK_WHOLE_SIZE, 0);
+        command_buffer.updateBuffer(m_uniform_buffer, 0, sizeof(Uniforms), &uniforms);
+
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eUniformRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::DependencyFlags(),
+            barrier,
+            nullptr,
+            nullptr);
+
+        if (cluster_count > 0 && instance_count > 0)
+        {
+            command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_pipeline);
+            command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_pipeline_layout, 0, m_set, nullptr);
+            command_buffer.dispatch((cluster_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, instance_count, 1);
+        }
+
+        // 输出用于间接绘制，也可以复制回主机
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eTransferRead);
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            barrier,
+            nullptr,
+            nullptr);
+    }
+
+    void
+    ClusterCuller::record_draw(
+        const vk::CommandBuffer &command_buffer,
+        uint32_t max_draw_count)
+    {
+        max_draw_count = std::min(max_draw_count, get_max_draw_count());
+        const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+        if (m_draw_indexed_indirect_count)
+            m_draw_indexed_indirect_count(
+                static_cast<VkCommandBuffer>(command_buffer),
+                static_cast<VkBuffer>(m_draw_buffer),
+                0,
+                static_cast<VkBuffer>(m_count_buffer),
+                0,
+                max_draw_count,
+                stride);
+        else if (m_config.m_is_multi_draw_indirect_enabled)
+            command_buffer.drawIndexedIndirect(m_draw_buffer, 0, max_draw_count, stride);
+        else
+            for (uint32_t i = 0; i < max_draw_count; i++)
+                command_buffer.drawIndexedIndirect(m_draw_buffer, static_cast<vk::DeviceSize>(i) * stride, 1, stride);
+    }
+
+    uint32_t
+    ClusterCuller::get_max_draw_count() const noexcept
+    {
+        return m_config.m_max_clusters * m_config.m_max_instances;
+    }
+
+    vk::Result
+    ClusterCuller::create_buffer(
+        const vk::PhysicalDevice &physical_device,
+        vk::DeviceSize size,
+        vk::BufferUsageFlags usage,
+        const std::vector<uint32_t> &queue_families,
+        vk::Buffer &buffer,
+        vk::DeviceMemory &memory)
+    {
+        auto buffer_result = DeviceUtils::create_buffer(m_device, size, usage, queue_families);
+        if (buffer_result.result != vk::Result::eSuccess)
+            return buffer_result.result;
+        buffer = buffer_result.value;
+
+        auto memory_result = DeviceUtils::allocate_buffer_memory(
+            m_device,
+            physical_device,
+            buffer,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::MemoryPropertyFlags());
+        if (memory_result.result != vk::Result::eSuccess)
+            return memory_result.result;
+        memory = memory_result.value;
+
+        return vk::Result::eSuccess;
+    }
+
+    vk::Result
+    ClusterCuller::create_pipeline()
+    {
+        // uniform、簇、实例、绘制命令、数量
+        vk::DescriptorSetLayoutBinding bindings[] = {
+            vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eCompute),
+            vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute),
+            vk::DescriptorSetLayoutBinding(2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute),
+            vk::DescriptorSetLayoutBinding(3, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute),
+            vk::DescriptorSetLayoutBinding(4, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute),
+        };
+        vk::DescriptorSetLayoutCreateInfo set_layout_info;
+        set_layout_info.setBindingCount(5);
+        set_layout_info.setPBindings(bindings);
+        auto set_layout_result = m_device.createDescriptorSetLayout(set_layout_info);
+        if (set_layout_result.result != vk::Result::eSuccess)
+            return set_layout_result.result;
+        m_set_layout = set_layout_result.value;
+
+        vk::DescriptorPoolSize pool_sizes[] = {
+            vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, 1),
+            vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 4),
+        };
+        vk::DescriptorPoolCreateInfo pool_info;
+        pool_info.setMaxSets(1);
+        pool_info.setPoolSizeCount(2);
+        pool_info.setPPoolSizes(pool_sizes);
+        auto pool_result = m_device.createDescriptorPool(pool_info);
+        if (pool_result.result != vk::Result::eSuccess)
+            return pool_result.result;
+        m_descriptor_pool = pool_result.value;
+
+        vk::DescriptorSetAllocateInfo set_info;
+        set_info.setDescriptorPool(m_descriptor_pool);
+        set_info.setDescriptorSetCount(1);
+        set_info.setPSetLayouts(&m_set_layout);
+        auto set_result = m_device.allocateDescriptorSets(set_info);
+        if (set_result.result != vk::Result::eSuccess)
+            return set_result.result;
+        m_set = set_result.value.at(0);
+
+        vk::DescriptorBufferInfo buffer_infos[] = {
+            vk::DescriptorBufferInfo(m_uniform_buffer, 0, VK_WHOLE_SIZE),
+            vk::DescriptorBufferInfo(m_cluster_buffer.m_buffer, 0, VK_WHOLE_SIZE),
+            vk::DescriptorBufferInfo(m_instance_buffer.m_buffer, 0, VK_WHOLE_SIZE),
+            vk::DescriptorBufferInfo(m_draw_buffer, 0, VK_WHOLE_SIZE),
+            vk::DescriptorBufferInfo(m_count_buffer, 0, VK_WHOLE_SIZE),
+        };
+        std::vector<vk::WriteDescriptorSet> writes;
+        for (uint32_t binding = 0; binding < 5; binding++)
+        {
+            vk::WriteDescriptorSet write;
+            write.setDstSet(m_set);
+            write.setDstBinding(binding);
+            write.setDescriptorCount(1);
+            write.setDescriptorType(bindings[binding].descriptorType);
+            write.setPBufferInfo(&buffer_infos[binding]);
+            writes.push_back(write);
+        }
+        m_device.updateDescriptorSets(writes, nullptr);
+
+        vk::PipelineLayoutCreateInfo layout_info;
+        layout_info.setSetLayoutCount(1);
+        layout_info.setPSetLayouts(&m_set_layout);
+        auto layout_result = m_device.createPipelineLayout(layout_info);
+        if (layout_result.result != vk::Result::eSuccess)
+            return layout_result.result;
+        m_pipeline_layout = layout_result.value;
+
+        auto module_result = DeviceUtils::create_shader_module(m_device, m_config.m_code, m_config.m_code_size);
+        if (module_result.result != vk::Result::eSuccess)
+            return module_result.result;
+
+        vk::PipelineShaderStageCreateInfo stage_info;
+        stage_info.setStage(vk::ShaderStageFlagBits::eCompute);
+        stage_info.setModule(module_result.value);
+        stage_info.setPName("main");
+
+        vk::ComputePipelineCreateInfo pipeline_info;
+        pipeline_info.setStage(stage_info);
+        pipeline_info.setLayout(m_pipeline_layout);
+        auto pipeline_result = m_device.createComputePipeline(nullptr, pipeline_info);
+        m_device.destroyShaderModule(module_result.value);
+        if (pipeline_result.result != vk::Result::eSuccess)
+            return pipeline_result.result;
+        m_pipeline = pipeline_result.value;
+
+        return vk::Result::eSuccess;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
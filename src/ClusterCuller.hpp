@@ -0,0 +1,197 @@
+#ifndef __VL_CLUSTERCULLER_HPP__
+#define __VL_CLUSTERCULLER_HPP__
+
+#include <vector>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "DefaultQueueFamilyIndices.hpp"
+#include "FrustumUtils.hpp"
+#include "MappedBuffer.hpp"
+#include "MeshletUtils.hpp"
+
+namespace vl
+{
+    /// @brief 用计算着色器对网格的簇做视锥体和法线锥剔除，可见的簇压缩为间接绘制命令
+    /// @details 每个簇是索引缓冲中连续的一段，按MeshletUtils::unpack_indices的顺序存放，
+    /// 所以不需要网格着色器；簇对每个实例各测试一次，firstInstance为实例序号。
+    /// 队列系列的用法与GpuCuller相同
+    class ClusterCuller : public ntl::Object
+    {
+    public:
+        using SelfType = ClusterCuller;
+        using ParentType = ntl::Object;
+
+        /// @brief 每个簇的输入，与cluster.comp中的Cluster相同
+        struct Cluster
+        {
+            /// @brief 模型空间的包围球和法线锥
+            MeshletUtils::Bounds m_bounds;
+
+            /// @brief 索引数量
+            uint32_t m_index_count = 0;
+
+            /// @brief 第一个索引
+            uint32_t m_first_index = 0;
+
+            /// @brief 顶点偏移
+            int32_t m_vertex_offset = 0;
+
+            uint32_t m_reserved = 0;
+        };
+
+        /// @brief 每个实例的模型矩阵，列主序，只允许旋转、平移和均匀缩放
+        struct Instance
+        {
+            float m_model[16];
+        };
+
+        /// @brief 与cluster.comp中的ClusterUniforms相同，std140布局
+        struct Uniforms
+        {
+            float m_view_projection[16];
+            float m_planes[FrustumUtils::PLANE_COUNT * 4];
+            float m_camera_position[4];
+            uint32_t m_cluster_count;
+            uint32_t m_instance_count;
+            uint32_t m_is_cone_enabled;
+            uint32_t m_reserved;
+        };
+
+        /// @brief 创建参数
+        struct Config
+        {
+            /// @brief 最多簇数
+            uint32_t m_max_clusters = 0;
+
+            /// @brief 最多实例数
+            uint32_t m_max_instances = 1;
+
+            /// @brief cluster.comp的SPIR-V
+            const uint32_t *m_code = nullptr;
+            size_t m_code_size = 0;
+
+            /// @brief 是否启用了VK_KHR_draw_indirect_count
+            bool m_is_draw_indirect_count_enabled = false;
+
+            /// @brief 是否启用了multiDrawIndirect特性
+            bool m_is_multi_draw_indirect_enabled = false;
+        };
+
+        static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+    public:
+        /// @brief 簇缓冲，主机写入后需要刷新
+        MappedBuffer m_cluster_buffer;
+
+        /// @brief 实例缓冲，主机写入后需要刷新
+        MappedBuffer m_instance_buffer;
+
+        /// @brief VkDrawIndexedIndirectCommand数组，最多m_max_clusters * m_max_instances个
+        vk::Buffer m_draw_buffer;
+
+        /// @brief 可见的簇数
+        vk::Buffer m_count_buffer;
+
+    protected:
+        vk::Device m_device;
+        Config m_config;
+
+        vk::DeviceMemory m_draw_memory;
+        vk::DeviceMemory m_count_memory;
+        vk::Buffer m_uniform_buffer;
+        vk::DeviceMemory m_uniform_memory;
+
+        vk::DescriptorSetLayout m_set_layout;
+        vk::DescriptorPool m_descriptor_pool;
+        vk::DescriptorSet m_set;
+        vk::PipelineLayout m_pipeline_layout;
+        vk::Pipeline m_pipeline;
+
+        /// @brief 通过vkGetDeviceProcAddr取得，未启用拓展时为空
+        PFN_vkCmdDrawIndexedIndirectCountKHR m_draw_indexed_indirect_count = nullptr;
+
+    public:
+        ClusterCuller() = default;
+        ~ClusterCuller() override = default;
+
+        ClusterCuller(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 创建缓冲和计算管线
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param indices 队列系列索引，剔除在计算系列上，绘制在图形系列上
+        /// @param config 创建参数
+        /// @return 结果
+        vk::Result create(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            const DefaultQueueFamilyIndices &indices,
+            const Config &config);
+
+        /// @brief 销毁，调用前需要保证设备已空闲
+        void destroy();
+
+        /// @brief 获取映射的簇数组
+        /// @return 簇数组
+        Cluster *get_clusters() const noexcept;
+
+        /// @brief 获取映射的实例数组
+        /// @return 实例数组
+        Instance *get_instances() const noexcept;
+
+        /// @brief 由MeshletUtils的结果填写簇数组
+        /// @param meshlets 簇
+        /// @param bounds 每个簇的包围体
+        /// @param first_cluster 写入的起始位置
+        /// @param first_index 网格在索引缓冲中的第一个索引
+        /// @param vertex_offset 网格在顶点缓冲中的偏移
+        /// @return 写入的簇数，超出m_max_clusters的部分被忽略
+        uint32_t set_clusters(
+            const std::vector<MeshletUtils::Meshlet> &meshlets,
+            const std::vector<MeshletUtils::Bounds> &bounds,
+            uint32_t first_cluster = 0,
+            uint32_t first_index = 0,
+            int32_t vertex_offset = 0) const noexcept;
+
+        /// @brief 记录剔除
+        /// @param command_buffer 计算系列的命令缓冲
+        /// @param view_projection 列主序的投影乘观察矩阵
+        /// @param camera_position 世界空间的相机位置
+        /// @param cluster_count 簇数
+        /// @param instance_count 实例数
+        /// @param is_cone_enabled 是否做法线锥剔除，双面材质需要关闭
+        void record_cull(
+            const vk::CommandBuffer &command_buffer,
+            const float view_projection[16],
+            const float camera_position[3],
+            uint32_t cluster_count,
+            uint32_t instance_count,
+            bool is_cone_enabled);
+
+        /// @brief 记录间接绘制，没有VK_KHR_draw_indirect_count时绘制max_draw_count个命令，多余的实例数为0
+        /// @param command_buffer 图形系列的命令缓冲，已绑定管线、顶点和索引缓冲
+        /// @param max_draw_count 最多绘制的命令数
+        void record_draw(const vk::CommandBuffer &command_buffer, uint32_t max_draw_count);
+
+        /// @brief 获取绘制命令的最大数量
+        /// @return m_max_clusters * m_max_instances
+        uint32_t get_max_draw_count() const noexcept;
+
+    protected:
+        /// @brief 创建设备本地的缓冲
+        vk::Result create_buffer(
+            const vk::PhysicalDevice &physical_device,
+            vk::DeviceSize size,
+            vk::BufferUsageFlags usage,
+            const std::vector<uint32_t> &queue_families,
+            vk::Buffer &buffer,
+            vk::DeviceMemory &memory);
+
+        /// @brief 创建描述符和计算管线
+        vk::Result create_pipeline();
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,463 @@
+#ifndef __VL_COMMANDLIST_CPP__
+#define __VL_COMMANDLIST_CPP__
+
+#include <cstring>
+#include "CommandList.hpp"
+
+namespace vl
+{
+    template <typename Dispatch>
+    size_t
+    CommandList<Dispatch>::Statistics::get_emitted() const noexcept
+    {
+        size_t total = 0;
+        for (size_t value : m_emitted)
+            total += value;
+        return total;
+    }
+
+    template <typename Dispatch>
+    size_t
+    CommandList<Dispatch>::Statistics::get_skipped() const noexcept
+    {
+        size_t total = 0;
+        for (size_t value : m_skipped)
+            total += value;
+        return total;
+    }
+
+    template <typename Dispatch>
+    CommandList<Dispatch>::CommandList(
+        const vk::CommandBuffer &command_buffer,
+        const Dispatch &dispatch)
+        : m_command_buffer(command_buffer), m_dispatch(&dispatch) {}
+
+    template <typename Dispatch>
+    const vk::CommandBuffer &
+    CommandList<Dispatch>::get_command_buffer() const noexcept
+    {
+        return m_command_buffer;
+    }
+
+    template <typename Dispatch>
+    const typename CommandList<Dispatch>::Statistics &
+    CommandList<Dispatch>::get_statistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::reset() noexcept
+    {
+        for (BindPointState &state : m_bind_points)
+        {
+            state.m_pipeline = VK_NULL_HANDLE;
+            state.m_layout = VK_NULL_HANDLE;
+            state.m_set_mask = 0;
+            state.m_dynamic_set_count = 0;
+            state.m_dynamic_offsets.clear();
+        }
+        m_vertex_mask = 0;
+        m_is_index_valid = false;
+        m_viewport_mask = 0;
+        m_scissor_mask = 0;
+        m_push_constant_layout = VK_NULL_HANDLE;
+        std::memset(m_push_constant_stages, 0, sizeof(m_push_constant_stages));
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::set_command_buffer(
+        const vk::CommandBuffer &command_buffer) noexcept
+    {
+        m_command_buffer = command_buffer;
+        m_statistics = Statistics();
+        reset();
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::bind_pipeline(
+        vk::PipelineBindPoint bind_point,
+        const vk::Pipeline &pipeline,
+        bool is_dynamic_viewport)
+    {
+        BindPointState &state = get_bind_point(bind_point);
+        VkPipeline handle = static_cast<VkPipeline>(pipeline);
+        if (state.m_pipeline == handle)
+        {
+            count(COMMAND_BIND_PIPELINE, false);
+            return;
+        }
+
+        m_dispatch->vkCmdBindPipeline(
+            static_cast<VkCommandBuffer>(m_command_buffer),
+            static_cast<VkPipelineBindPoint>(bind_point),
+            handle);
+        state.m_pipeline = handle;
+        count(COMMAND_BIND_PIPELINE, true);
+
+        // 静态的视口和裁剪会覆盖之前设置的值
+        if (!is_dynamic_viewport && bind_point == vk::PipelineBindPoint::eGraphics)
+        {
+            m_viewport_mask = 0;
+            m_scissor_mask = 0;
+        }
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::bind_descriptor_sets(
+        vk::PipelineBindPoint bind_point,
+        const vk::PipelineLayout &layout,
+        uint32_t first_set,
+        uint32_t set_count,
+        const vk::DescriptorSet *sets,
+        uint32_t dynamic_offset_count,
+        const uint32_t *dynamic_offsets)
+    {
+        BindPointState &state = get_bind_point(bind_point);
+        VkPipelineLayout layout_handle = static_cast<VkPipelineLayout>(layout);
+
+        // 不知道新旧布局是否兼容，布局变化时保守地认为之前的集全部失效
+        if (state.m_layout != layout_handle)
+        {
+            state.m_layout = layout_handle;
+            state.m_set_mask = 0;
+            state.m_dynamic_set_count = 0;
+            state.m_dynamic_offsets.clear();
+        }
+
+        bool is_redundant = first_set + set_count <= MAX_DESCRIPTOR_SETS;
+        for (uint32_t i = 0; i < set_count && is_redundant; i++)
+        {
+            uint32_t index = first_set + i;
+            is_redundant = (state.m_set_mask & (1u << index)) &&
+                           state.m_sets[index] == static_cast<VkDescriptorSet>(sets[i]);
+        }
+        if (is_redundant && dynamic_offset_count > 0)
+            is_redundant = state.m_dynamic_first_set == first_set &&
+                           state.m_dynamic_set_count == set_count &&
+                           state.m_dynamic_offsets.size() == dynamic_offset_count &&
+                           std::memcmp(state.m_dynamic_offsets.data(), dynamic_offsets, dynamic_offset_count * sizeof(uint32_t)) == 0;
+        if (is_redundant)
+        {
+            count(COMMAND_BIND_DESCRIPTOR_SETS, false);
+            return;
+        }
+
+        m_dispatch->vkCmdBindDescriptorSets(
+            static_cast<VkCommandBuffer>(m_command_buffer),
+            static_cast<VkPipelineBindPoint>(bind_point),
+            layout_handle,
+            first_set,
+            set_count,
+            reinterpret_cast<const VkDescriptorSet *>(sets),
+            dynamic_offset_count,
+            dynamic_offsets);
+        count(COMMAND_BIND_DESCRIPTOR_SETS, true);
+
+        for (uint32_t i = 0; i < set_count; i++)
+        {
+            uint32_t index = first_set + i;
+            if (index >= MAX_DESCRIPTOR_SETS)
+                break;
+            state.m_sets[index] = static_cast<VkDescriptorSet>(sets[i]);
+            state.m_set_mask |= 1u << index;
+        }
+
+        if (dynamic_offset_count > 0)
+        {
+            state.m_dynamic_first_set = first_set;
+            state.m_dynamic_set_count = set_count;
+            state.m_dynamic_offsets.assign(dynamic_offsets, dynamic_offsets + dynamic_offset_count);
+        }
+        else if (first_set < state.m_dynamic_first_set + state.m_dynamic_set_count &&
+                 state.m_dynamic_first_set < first_set + set_count)
+        {
+            // 覆盖了带动态偏移的集
+            state.m_dynamic_set_count = 0;
+            state.m_dynamic_offsets.clear();
+        }
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::bind_descriptor_set(
+        vk::PipelineBindPoint bind_point,
+        const vk::PipelineLayout &layout,
+        uint32_t set,
+        const vk::DescriptorSet &descriptor_set)
+    {
+        bind_descriptor_sets(bind_point, layout, set, 1, &descriptor_set);
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::bind_vertex_buffers(
+        uint32_t first_binding,
+        uint32_t binding_count,
+        const vk::Buffer *buffers,
+        const vk::DeviceSize *offsets)
+    {
+        uint32_t begin = 0, end = 0;
+        bool is_changed = find_changed_range(
+            first_binding,
+            binding_count,
+            m_vertex_mask,
+            [&](uint32_t i)
+            { return m_vertex_buffers[first_binding + i] == static_cast<VkBuffer>(buffers[i]) &&
+                     m_vertex_offsets[first_binding + i] == offsets[i]; },
+            begin,
+            end);
+        if (!is_changed)
+        {
+            count(COMMAND_BIND_VERTEX_BUFFERS, false);
+            return;
+        }
+
+        m_dispatch->vkCmdBindVertexBuffers(
+            static_cast<VkCommandBuffer>(m_command_buffer),
+            first_binding + begin,
+            end - begin,
+            reinterpret_cast<const VkBuffer *>(buffers + begin),
+            offsets + begin);
+        count(COMMAND_BIND_VERTEX_BUFFERS, true);
+
+        for (uint32_t i = begin; i < end && first_binding + i < MAX_VERTEX_BINDINGS; i++)
+        {
+            m_vertex_buffers[first_binding + i] = static_cast<VkBuffer>(buffers[i]);
+            m_vertex_offsets[first_binding + i] = offsets[i];
+            m_vertex_mask |= 1u << (first_binding + i);
+        }
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::bind_index_buffer(
+        const vk::Buffer &buffer,
+        vk::DeviceSize offset,
+        vk::IndexType index_type)
+    {
+        VkBuffer handle = static_cast<VkBuffer>(buffer);
+        VkIndexType type = static_cast<VkIndexType>(index_type);
+        if (m_is_index_valid && m_index_buffer == handle && m_index_offset == offset && m_index_type == type)
+        {
+            count(COMMAND_BIND_INDEX_BUFFER, false);
+            return;
+        }
+
+        m_dispatch->vkCmdBindIndexBuffer(static_cast<VkCommandBuffer>(m_command_buffer), handle, offset, type);
+        count(COMMAND_BIND_INDEX_BUFFER, true);
+        m_index_buffer = handle;
+        m_index_offset = offset;
+        m_index_type = type;
+        m_is_index_valid = true;
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::set_viewport(
+        uint32_t first_viewport,
+        uint32_t viewport_count,
+        const vk::Viewport *viewports)
+    {
+        const VkViewport *values = reinterpret_cast<const VkViewport *>(viewports);
+        uint32_t begin = 0, end = 0;
+        bool is_changed = find_changed_range(
+            first_viewport,
+            viewport_count,
+            m_viewport_mask,
+            [&](uint32_t i)
+            { return std::memcmp(&m_viewports[first_viewport + i], &values[i], sizeof(VkViewport)) == 0; },
+            begin,
+            end);
+        if (!is_changed)
+        {
+            count(COMMAND_SET_VIEWPORT, false);
+            return;
+        }
+
+        m_dispatch->vkCmdSetViewport(static_cast<VkCommandBuffer>(m_command_buffer), first_viewport + begin, end - begin, values + begin);
+        count(COMMAND_SET_VIEWPORT, true);
+
+        for (uint32_t i = begin; i < end && first_viewport + i < MAX_VIEWPORTS; i++)
+        {
+            m_viewports[first_viewport + i] = values[i];
+            m_viewport_mask |= 1u << (first_viewport + i);
+        }
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::set_scissor(
+        uint32_t first_scissor,
+        uint32_t scissor_count,
+        const vk::Rect2D *scissors)
+    {
+        const VkRect2D *values = reinterpret_cast<const VkRect2D *>(scissors);
+        uint32_t begin = 0, end = 0;
+        bool is_changed = find_changed_range(
+            first_scissor,
+            scissor_count,
+            m_scissor_mask,
+            [&](uint32_t i)
+            { return std::memcmp(&m_scissors[first_scissor + i], &values[i], sizeof(VkRect2D)) == 0; },
+            begin,
+            end);
+        if (!is_changed)
+        {
+            count(COMMAND_SET_SCISSOR, false);
+            return;
+        }
+
+        m_dispatch->vkCmdSetScissor(static_cast<VkCommandBuffer>(m_command_buffer), first_scissor + begin, end - begin, values + begin);
+        count(COMMAND_SET_SCISSOR, true);
+
+        for (uint32_t i = begin; i < end && first_scissor + i < MAX_VIEWPORTS; i++)
+        {
+            m_scissors[first_scissor + i] = values[i];
+            m_scissor_mask |= 1u << (first_scissor + i);
+        }
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::push_constants(
+        const vk::PipelineLayout &layout,
+        vk::ShaderStageFlags stages,
+        uint32_t offset,
+        uint32_t size,
+        const void *values)
+    {
+        VkPipelineLayout layout_handle = static_cast<VkPipelineLayout>(layout);
+        VkShaderStageFlags stage_flags = static_cast<VkShaderStageFlags>(stages);
+        if (m_push_constant_layout != layout_handle)
+        {
+            m_push_constant_layout = layout_handle;
+            std::memset(m_push_constant_stages, 0, sizeof(m_push_constant_stages));
+        }
+
+        bool is_tracked = offset + size <= MAX_PUSH_CONSTANT_SIZE;
+        bool is_redundant = is_tracked && std::memcmp(m_push_constant_data + offset, values, size) == 0;
+        for (uint32_t i = 0; i < size && is_redundant; i++)
+            is_redundant = m_push_constant_stages[offset + i] == stage_flags;
+        if (is_redundant)
+        {
+            count(COMMAND_PUSH_CONSTANTS, false);
+            return;
+        }
+
+        m_dispatch->vkCmdPushConstants(static_cast<VkCommandBuffer>(m_command_buffer), layout_handle, stage_flags, offset, size, values);
+        count(COMMAND_PUSH_CONSTANTS, true);
+
+        if (is_tracked)
+        {
+            std::memcpy(m_push_constant_data + offset, values, size);
+            for (uint32_t i = 0; i < size; i++)
+                m_push_constant_stages[offset + i] = stage_flags;
+        }
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::draw(
+        uint32_t vertex_count,
+        uint32_t instance_count,
+        uint32_t first_vertex,
+        uint32_t first_instance)
+    {
+        m_dispatch->vkCmdDraw(static_cast<VkCommandBuffer>(m_command_buffer), vertex_count, instance_count, first_vertex, first_instance);
+        count(COMMAND_DRAW, true);
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::draw_indexed(
+        uint32_t index_count,
+        uint32_t instance_count,
+        uint32_t first_index,
+        int32_t vertex_offset,
+        uint32_t first_instance)
+    {
+        m_dispatch->vkCmdDrawIndexed(static_cast<VkCommandBuffer>(m_command_buffer), index_count, instance_count, first_index, vertex_offset, first_instance);
+        count(COMMAND_DRAW, true);
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::draw_indirect(
+        const vk::Buffer &buffer,
+        vk::DeviceSize offset,
+        uint32_t draw_count,
+        uint32_t stride)
+    {
+        m_dispatch->vkCmdDrawIndirect(static_cast<VkCommandBuffer>(m_command_buffer), static_cast<VkBuffer>(buffer), offset, draw_count, stride);
+        count(COMMAND_DRAW, true);
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::draw_indexed_indirect(
+        const vk::Buffer &buffer,
+        vk::DeviceSize offset,
+        uint32_t draw_count,
+        uint32_t stride)
+    {
+        m_dispatch->vkCmdDrawIndexedIndirect(static_cast<VkCommandBuffer>(m_command_buffer), static_cast<VkBuffer>(buffer), offset, draw_count, stride);
+        count(COMMAND_DRAW, true);
+    }
+
+    template <typename Dispatch>
+    typename CommandList<Dispatch>::BindPointState &
+    CommandList<Dispatch>::get_bind_point(
+        vk::PipelineBindPoint bind_point) noexcept
+    {
+        return m_bind_points[bind_point == vk::PipelineBindPoint::eCompute ? 1 : 0];
+    }
+
+    template <typename Dispatch>
+    void
+    CommandList<Dispatch>::count(
+        Command command,
+        bool is_emitted) noexcept
+    {
+        if (is_emitted)
+            m_statistics.m_emitted[command]++;
+        else
+            m_statistics.m_skipped[command]++;
+    }
+
+    template <typename Dispatch>
+    template <typename Func>
+    bool
+    CommandList<Dispatch>::find_changed_range(
+        uint32_t first,
+        uint32_t count,
+        uint32_t mask,
+        Func is_equal,
+        uint32_t &begin,
+        uint32_t &end) noexcept
+    {
+        // 超出记录范围的元素总是录制
+        auto is_known = [&](uint32_t i)
+        {
+            uint32_t index = first + i;
+            return index < 32 && (mask & (1u << index)) && is_equal(i);
+        };
+
+        begin = 0;
+        while (begin < count && is_known(begin))
+            begin++;
+        if (begin == count)
+            return false;
+
+        end = count;
+        while (end > begin + 1 && is_known(end - 1))
+            end--;
+        return true;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
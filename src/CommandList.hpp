@@ -0,0 +1,258 @@
+#ifndef __VL_COMMANDLIST_HPP__
+#define __VL_COMMANDLIST_HPP__
+
+#include <cstdint>
+#include <vector>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 命令缓冲的录制包装，记录已绑定的状态并丢弃重复的命令
+    /// @details 记录管线、描述符集、顶点和索引缓冲、视口、裁剪和推送常量，
+    /// 与当前状态相同的命令不会录制。命令通过Dispatch的vkCmd*函数发出，
+    /// 可以换成记录调用的模拟分发表来测试
+    /// @tparam Dispatch 分发表类型
+    template <typename Dispatch = VULKAN_HPP_DEFAULT_DISPATCHER_TYPE>
+    class CommandList : public ntl::Object
+    {
+    public:
+        using SelfType = CommandList<Dispatch>;
+        using ParentType = ntl::Object;
+
+        /// @brief 命令种类，用于统计
+        enum Command : uint32_t
+        {
+            COMMAND_BIND_PIPELINE,
+            COMMAND_BIND_DESCRIPTOR_SETS,
+            COMMAND_BIND_VERTEX_BUFFERS,
+            COMMAND_BIND_INDEX_BUFFER,
+            COMMAND_SET_VIEWPORT,
+            COMMAND_SET_SCISSOR,
+            COMMAND_PUSH_CONSTANTS,
+            COMMAND_DRAW,
+            COMMAND_COUNT,
+        };
+
+        /// @brief 每种命令录制和跳过的次数
+        struct Statistics
+        {
+            size_t m_emitted[COMMAND_COUNT] = {};
+            size_t m_skipped[COMMAND_COUNT] = {};
+
+            size_t get_emitted() const noexcept;
+            size_t get_skipped() const noexcept;
+        };
+
+        static constexpr uint32_t BIND_POINT_COUNT = 2;
+        static constexpr uint32_t MAX_DESCRIPTOR_SETS = 8;
+        static constexpr uint32_t MAX_VERTEX_BINDINGS = 16;
+        static constexpr uint32_t MAX_VIEWPORTS = 16;
+        static constexpr uint32_t MAX_PUSH_CONSTANT_SIZE = 256;
+
+    protected:
+        /// @brief 一个绑定点（图形或计算）的状态
+        struct BindPointState
+        {
+            VkPipeline m_pipeline = VK_NULL_HANDLE;
+            VkPipelineLayout m_layout = VK_NULL_HANDLE;
+            VkDescriptorSet m_sets[MAX_DESCRIPTOR_SETS] = {};
+            uint32_t m_set_mask = 0;
+
+            /// @brief 最后一次带动态偏移的绑定，动态偏移无法拆分到每个集，只与整次调用比较
+            uint32_t m_dynamic_first_set = 0;
+            uint32_t m_dynamic_set_count = 0;
+            std::vector<uint32_t> m_dynamic_offsets;
+        };
+
+        vk::CommandBuffer m_command_buffer;
+        const Dispatch *m_dispatch = nullptr;
+
+        BindPointState m_bind_points[BIND_POINT_COUNT];
+
+        VkBuffer m_vertex_buffers[MAX_VERTEX_BINDINGS] = {};
+        VkDeviceSize m_vertex_offsets[MAX_VERTEX_BINDINGS] = {};
+        uint32_t m_vertex_mask = 0;
+
+        VkBuffer m_index_buffer = VK_NULL_HANDLE;
+        VkDeviceSize m_index_offset = 0;
+        VkIndexType m_index_type = VK_INDEX_TYPE_UINT16;
+        bool m_is_index_valid = false;
+
+        VkViewport m_viewports[MAX_VIEWPORTS] = {};
+        uint32_t m_viewport_mask = 0;
+        VkRect2D m_scissors[MAX_VIEWPORTS] = {};
+        uint32_t m_scissor_mask = 0;
+
+        /// @brief 推送常量的内容，以及每个字节最后一次是为哪些阶段写入的，0表示未知
+        VkPipelineLayout m_push_constant_layout = VK_NULL_HANDLE;
+        uint8_t m_push_constant_data[MAX_PUSH_CONSTANT_SIZE] = {};
+        VkShaderStageFlags m_push_constant_stages[MAX_PUSH_CONSTANT_SIZE] = {};
+
+        Statistics m_statistics;
+
+    public:
+        /// @brief 包装命令缓冲
+        /// @param command_buffer 处于录制状态的命令缓冲
+        /// @param dispatch 分发表，需要在CommandList的生命周期内有效
+        explicit CommandList(
+            const vk::CommandBuffer &command_buffer,
+            const Dispatch &dispatch = VULKAN_HPP_DEFAULT_DISPATCHER);
+        explicit CommandList(const SelfType &from) = delete;
+        ~CommandList() override = default;
+
+    public:
+        SelfType &operator=(const SelfType &from) = delete;
+
+    public:
+        /// @brief 获取命令缓冲
+        /// @return 命令缓冲
+        const vk::CommandBuffer &get_command_buffer() const noexcept;
+
+        /// @brief 获取统计
+        /// @return 统计
+        const Statistics &get_statistics() const noexcept;
+
+        /// @brief 忘记记录的全部状态，例如开始录制新的命令缓冲或执行了次级命令缓冲之后
+        void reset() noexcept;
+
+        /// @brief 换成另一个命令缓冲，状态和统计都会清空
+        /// @param command_buffer 处于录制状态的命令缓冲
+        void set_command_buffer(const vk::CommandBuffer &command_buffer) noexcept;
+
+        /// @brief 绑定管线
+        /// @param bind_point 绑定点
+        /// @param pipeline 管线
+        /// @param is_dynamic_viewport 管线的视口和裁剪是否为动态状态，不是时绑定后记录的视口和裁剪失效
+        void bind_pipeline(
+            vk::PipelineBindPoint bind_point,
+            const vk::Pipeline &pipeline,
+            bool is_dynamic_viewport = true);
+
+        /// @brief 绑定描述符集，管线布局变化时之前记录的描述符集全部失效
+        /// @param bind_point 绑定点
+        /// @param layout 管线布局
+        /// @param first_set 第一个集
+        /// @param set_count 集的数量
+        /// @param sets 描述符集
+        /// @param dynamic_offset_count 动态偏移的数量
+        /// @param dynamic_offsets 动态偏移，按集的顺序
+        void bind_descriptor_sets(
+            vk::PipelineBindPoint bind_point,
+            const vk::PipelineLayout &layout,
+            uint32_t first_set,
+            uint32_t set_count,
+            const vk::DescriptorSet *sets,
+            uint32_t dynamic_offset_count = 0,
+            const uint32_t *dynamic_offsets = nullptr);
+
+        /// @brief 绑定一个没有动态偏移的描述符集
+        void bind_descriptor_set(
+            vk::PipelineBindPoint bind_point,
+            const vk::PipelineLayout &layout,
+            uint32_t set,
+            const vk::DescriptorSet &descriptor_set);
+
+        /// @brief 绑定顶点缓冲，只录制发生变化的那一段绑定
+        /// @param first_binding 第一个绑定
+        /// @param binding_count 绑定数量
+        /// @param buffers 缓冲
+        /// @param offsets 偏移
+        void bind_vertex_buffers(
+            uint32_t first_binding,
+            uint32_t binding_count,
+            const vk::Buffer *buffers,
+            const vk::DeviceSize *offsets);
+
+        /// @brief 绑定索引缓冲
+        /// @param buffer 缓冲
+        /// @param offset 偏移
+        /// @param index_type 索引类型
+        void bind_index_buffer(
+            const vk::Buffer &buffer,
+            vk::DeviceSize offset,
+            vk::IndexType index_type);
+
+        /// @brief 设置视口，只录制发生变化的那一段
+        /// @param first_viewport 第一个视口
+        /// @param viewport_count 数量
+        /// @param viewports 视口
+        void set_viewport(
+            uint32_t first_viewport,
+            uint32_t viewport_count,
+            const vk::Viewport *viewports);
+
+        /// @brief 设置裁剪，只录制发生变化的那一段
+        /// @param first_scissor 第一个裁剪
+        /// @param scissor_count 数量
+        /// @param scissors 裁剪
+        void set_scissor(
+            uint32_t first_scissor,
+            uint32_t scissor_count,
+            const vk::Rect2D *scissors);
+
+        /// @brief 推送常量，布局、阶段和内容都与记录相同时跳过
+        /// @param layout 管线布局
+        /// @param stages 着色器阶段
+        /// @param offset 偏移
+        /// @param size 大小
+        /// @param values 数据
+        void push_constants(
+            const vk::PipelineLayout &layout,
+            vk::ShaderStageFlags stages,
+            uint32_t offset,
+            uint32_t size,
+            const void *values);
+
+        void draw(
+            uint32_t vertex_count,
+            uint32_t instance_count,
+            uint32_t first_vertex,
+            uint32_t first_instance);
+
+        void draw_indexed(
+            uint32_t index_count,
+            uint32_t instance_count,
+            uint32_t first_index,
+            int32_t vertex_offset,
+            uint32_t first_instance);
+
+        void draw_indirect(
+            const vk::Buffer &buffer,
+            vk::DeviceSize offset,
+            uint32_t draw_count,
+            uint32_t stride);
+
+        void draw_indexed_indirect(
+            const vk::Buffer &buffer,
+            vk::DeviceSize offset,
+            uint32_t draw_count,
+            uint32_t stride);
+
+    protected:
+        /// @brief 获取绑定点的状态，只区分图形和计算
+        BindPointState &get_bind_point(vk::PipelineBindPoint bind_point) noexcept;
+
+        /// @brief 记录一次命令
+        void count(Command command, bool is_emitted) noexcept;
+
+        /// @brief 比较数组与记录，得到需要录制的范围
+        /// @param first 第一个元素
+        /// @param count 数量
+        /// @param mask 已知元素的位掩码
+        /// @param is_equal 第i个元素是否与记录相同
+        /// @param begin 输出需要录制的第一个元素
+        /// @param end 输出需要录制的范围的结尾
+        /// @return 是否有需要录制的元素
+        template <typename Func>
+        static bool find_changed_range(
+            uint32_t first,
+            uint32_t count,
+            uint32_t mask,
+            Func is_equal,
+            uint32_t &begin,
+            uint32_t &end) noexcept;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,448 @@
+#ifndef __VL_CPUCULLER_CPP__
+#define __VL_CPUCULLER_CPP__
+
+#include <cmath>
+#include <algorithm>
+#include "CpuCuller.hpp"
+#include "Simd.hpp"
+
+namespace vl
+{
+    // 每种Lanes提供同一组运算，V中的每个通道是一个包围盒
+    // negative_mask返回小于0的通道的位
+
+    struct CpuCuller::ScalarLanes
+    {
+        using V = float;
+        static constexpr size_t WIDTH = 1;
+
+        static V load(const float *p) { return *p; }
+        static V set1(float f) { return f; }
+        static V add(V a, V b) { return a + b; }
+        static V mul(V a, V b) { return a * b; }
+        static uint32_t negative_mask(V a) { return a < 0.0f ? 1u : 0u; }
+    };
+
+#if defined(VL_SIMD_SSE2)
+    struct CpuCuller::Sse2Lanes
+    {
+        using V = __m128;
+        static constexpr size_t WIDTH = 4;
+
+        static V load(const float *p) { return _mm_loadu_ps(p); }
+        static V set1(float f) { return _mm_set1_ps(f); }
+        static V add(V a, V b) { return _mm_add_ps(a, b); }
+        static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+        static uint32_t negative_mask(V a) { return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(a, _mm_setzero_ps()))); }
+    };
+#endif
+
+#if defined(VL_SIMD_AVX)
+    struct CpuCuller::AvxLanes
+    {
+        using V = __m256;
+        static constexpr size_t WIDTH = 8;
+
+        static V load(const float *p) { return _mm256_loadu_ps(p); }
+        static V set1(float f) { return _mm256_set1_ps(f); }
+        static V add(V a, V b) { return _mm256_add_ps(a, b); }
+        static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+        static uint32_t negative_mask(V a) { return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_LT_OQ))); }
+    };
+#endif
+
+#if defined(VL_SIMD_NEON)
+    struct CpuCuller::NeonLanes
+    {
+        using V = float32x4_t;
+        static constexpr size_t WIDTH = 4;
+
+        static V load(const float *p) { return vld1q_f32(p); }
+        static V set1(float f) { return vdupq_n_f32(f); }
+        static V add(V a, V b) { return vaddq_f32(a, b); }
+        static V mul(V a, V b) { return vmulq_f32(a, b); }
+        static uint32_t negative_mask(V a)
+        {
+            static const uint32_t bits[4] = {1, 2, 4, 8};
+            return vaddvq_u32(vandq_u32(vcltq_f32(a, vdupq_n_f32(0.0f)), vld1q_u32(bits)));
+        }
+    };
+#endif
+
+    void
+    CpuCuller::Bounds::resize(
+        size_t count)
+    {
+        // 补齐的部分不会被测试，值无关紧要
+        size_t padded = (count + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+        m_min_x.resize(padded, 0.0f);
+        m_min_y.resize(padded, 0.0f);
+        m_min_z.resize(padded, 0.0f);
+        m_max_x.resize(padded, 0.0f);
+        m_max_y.resize(padded, 0.0f);
+        m_max_z.resize(padded, 0.0f);
+        m_count = count;
+    }
+
+    void
+    CpuCuller::Bounds::set(
+        size_t index,
+        const float min[3],
+        const float max[3])
+    {
+        m_min_x[index] = min[0];
+        m_min_y[index] = min[1];
+        m_min_z[index] = min[2];
+        m_max_x[index] = max[0];
+        m_max_y[index] = max[1];
+        m_max_z[index] = max[2];
+    }
+
+    size_t
+    CpuCuller::size() const noexcept
+    {
+        return m_boxes.m_count;
+    }
+
+    void
+    CpuCuller::resize(
+        size_t count)
+    {
+        m_boxes.resize(count);
+        m_is_built = false;
+    }
+
+    void
+    CpuCuller::clear() noexcept
+    {
+        m_boxes = Bounds();
+        m_levels.clear();
+        m_order.clear();
+        m_is_built = false;
+    }
+
+    size_t
+    CpuCuller::add(
+        const float min[3],
+        const float max[3])
+    {
+        size_t index = m_boxes.m_count;
+        m_boxes.resize(index + 1);
+        m_boxes.set(index, min, max);
+        m_is_built = false;
+        return index;
+    }
+
+    void
+    CpuCuller::set(
+        size_t index,
+        const float min[3],
+        const float max[3])
+    {
+        m_boxes.set(index, min, max);
+        m_is_built = false;
+    }
+
+    void
+    CpuCuller::build()
+    {
+        size_t count = m_boxes.m_count;
+
+        // 场景范围，用于把质心量化为每轴10位
+        float lower[3] = {INFINITY, INFINITY, INFINITY};
+        float upper[3] = {-INFINITY, -INFINITY, -INFINITY};
+        const std::vector<float> *mins[3] = {&m_boxes.m_min_x, &m_boxes.m_min_y, &m_boxes.m_min_z};
+        const std::vector<float> *maxs[3] = {&m_boxes.m_max_x, &m_boxes.m_max_y, &m_boxes.m_max_z};
+        for (size_t i = 0; i < count; i++)
+            for (int k = 0; k < 3; k++)
+            {
+                float center = ((*mins[k])[i] + (*maxs[k])[i]) * 0.5f;
+                lower[k] = std::min(lower[k], center);
+                upper[k] = std::max(upper[k], center);
+            }
+
+        // 把10位的值展开为每隔两位一位
+        auto expand = [](uint32_t v) -> uint32_t
+        {
+            v = (v * 0x00010001u) & 0xFF0000FFu;
+            v = (v * 0x00000101u) & 0x0F00F00Fu;
+            v = (v * 0x00000011u) & 0xC30C30C3u;
+            v = (v * 0x00000005u) & 0x49249249u;
+            return v;
+        };
+
+        std::vector<uint64_t> keys(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t code = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                float extent = upper[k] - lower[k];
+                float center = ((*mins[k])[i] + (*maxs[k])[i]) * 0.5f;
+                float t = extent > 0.0f ? (center - lower[k]) / extent : 0.0f;
+                uint32_t q = static_cast<uint32_t>(std::min(std::max(t * 1024.0f, 0.0f), 1023.0f));
+                code |= expand(q) << (2 - k);
+            }
+            keys[i] = (static_cast<uint64_t>(code) << 32) | i;
+        }
+        std::sort(keys.begin(), keys.end());
+
+        m_order.resize(count);
+        for (size_t i = 0; i < count; i++)
+            m_order[i] = static_cast<uint32_t>(keys[i]);
+
+        m_is_built = true;
+        refit();
+    }
+
+    void
+    CpuCuller::refit()
+    {
+        if (m_order.size() != m_boxes.m_count)
+        {
+            build();
+            return;
+        }
+
+        m_levels.clear();
+        m_levels.emplace_back();
+        Bounds &leaves = m_levels.back();
+        leaves.resize(m_boxes.m_count);
+        for (size_t i = 0; i < m_boxes.m_count; i++)
+        {
+            uint32_t index = m_order[i];
+            leaves.m_min_x[i] = m_boxes.m_min_x[index];
+            leaves.m_min_y[i] = m_boxes.m_min_y[index];
+            leaves.m_min_z[i] = m_boxes.m_min_z[index];
+            leaves.m_max_x[i] = m_boxes.m_max_x[index];
+            leaves.m_max_y[i] = m_boxes.m_max_y[index];
+            leaves.m_max_z[i] = m_boxes.m_max_z[index];
+        }
+
+        // 每层的节点是下一层8个节点的并集，直到最上层不超过一组
+        while (m_levels.back().m_count > BLOCK_SIZE)
+        {
+            size_t child_count = m_levels.back().m_count;
+            Bounds parent;
+            parent.resize((child_count + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+            const Bounds &children = m_levels.back();
+            for (size_t j = 0; j < parent.m_count; j++)
+            {
+                size_t begin = j * BLOCK_SIZE;
+                size_t end = std::min(begin + BLOCK_SIZE, child_count);
+                float min[3] = {INFINITY, INFINITY, INFINITY};
+                float max[3] = {-INFINITY, -INFINITY, -INFINITY};
+                for (size_t c = begin; c < end; c++)
+                {
+                    min[0] = std::min(min[0], children.m_min_x[c]);
+                    min[1] = std::min(min[1], children.m_min_y[c]);
+                    min[2] = std::min(min[2], children.m_min_z[c]);
+                    max[0] = std::max(max[0], children.m_max_x[c]);
+                    max[1] = std::max(max[1], children.m_max_y[c]);
+                    max[2] = std::max(max[2], children.m_max_z[c]);
+                }
+                parent.set(j, min, max);
+            }
+            m_levels.push_back(std::move(parent));
+        }
+        m_is_built = true;
+    }
+
+    bool
+    CpuCuller::is_built() const noexcept
+    {
+        return m_is_built;
+    }
+
+    void
+    CpuCuller::cull_flat(
+        const float planes[FrustumUtils::PLANE_COUNT * 4],
+        std::vector<uint32_t> &visible,
+        ThreadPool *pool) const
+    {
+        visible.clear();
+        size_t block_count = (m_boxes.m_count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+        auto cull_blocks = [this, planes](size_t begin, size_t end, std::vector<uint32_t> &output)
+        {
+            for (size_t block = begin; block < end; block++)
+            {
+                uint32_t inside;
+                uint32_t mask = test_block(m_boxes, block * BLOCK_SIZE, planes, inside);
+                for (; mask != 0; mask &= mask - 1)
+                {
+                    uint32_t lane = 0;
+                    while (((mask >> lane) & 1u) == 0)
+                        lane++;
+                    output.push_back(static_cast<uint32_t>(block * BLOCK_SIZE + lane));
+                }
+            }
+        };
+
+        if (pool == nullptr || block_count <= PARALLEL_GRAIN)
+        {
+            cull_blocks(0, block_count, visible);
+            return;
+        }
+
+        // 每块写到自己的数组，最后按顺序拼接
+        std::vector<std::vector<uint32_t>> results((block_count + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN);
+        pool->parallel_for(
+            block_count,
+            PARALLEL_GRAIN,
+            [&](size_t begin, size_t end)
+            {
+                cull_blocks(begin, end, results[begin / PARALLEL_GRAIN]);
+            });
+        for (auto iter = results.cbegin(); iter != results.cend(); iter++)
+            visible.insert(visible.end(), iter->cbegin(), iter->cend());
+    }
+
+    void
+    CpuCuller::cull(
+        const float planes[FrustumUtils::PLANE_COUNT * 4],
+        std::vector<uint32_t> &visible,
+        ThreadPool *pool) const
+    {
+        visible.clear();
+        if (!m_is_built || m_levels.empty() || m_levels.front().m_count == 0)
+            return;
+
+        size_t top = m_levels.size() - 1;
+        if (pool == nullptr || pool->get_thread_count() == 0)
+        {
+            traverse(top, 0, planes, visible);
+            return;
+        }
+
+        // 从上往下找到节点组足够多的一层，各组并行遍历，这一层以上的节点不再测试
+        size_t task_count = pool->get_thread_count() * 8;
+        size_t level = top;
+        while (level > 0 && (m_levels[level].m_count + BLOCK_SIZE - 1) / BLOCK_SIZE < task_count)
+            level--;
+
+        size_t block_count = (m_levels[level].m_count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        size_t grain = std::max<size_t>(1, block_count / task_count);
+        std::vector<std::vector<uint32_t>> results((block_count + grain - 1) / grain);
+        pool->parallel_for(
+            block_count,
+            grain,
+            [&](size_t begin, size_t end)
+            {
+                std::vector<uint32_t> &output = results[begin / grain];
+                for (size_t block = begin; block < end; block++)
+                    traverse(level, block, planes, output);
+            });
+        for (auto iter = results.cbegin(); iter != results.cend(); iter++)
+            visible.insert(visible.end(), iter->cbegin(), iter->cend());
+    }
+
+    uint32_t
+    CpuCuller::test_block(
+        const Bounds &bounds,
+        size_t offset,
+        const float planes[FrustumUtils::PLANE_COUNT * 4],
+        uint32_t &inside_mask) noexcept
+    {
+#if defined(VL_SIMD_AVX)
+        return test_lanes<AvxLanes>(bounds, offset, planes, inside_mask);
+#elif defined(VL_SIMD_SSE2)
+        return test_lanes<Sse2Lanes>(bounds, offset, planes, inside_mask);
+#elif defined(VL_SIMD_NEON)
+        return test_lanes<NeonLanes>(bounds, offset, planes, inside_mask);
+#else
+        return test_lanes<ScalarLanes>(bounds, offset, planes, inside_mask);
+#endif
+    }
+
+    template <typename Lanes>
+    uint32_t
+    CpuCuller::test_lanes(
+        const Bounds &bounds,
+        size_t offset,
+        const float planes[FrustumUtils::PLANE_COUNT * 4],
+        uint32_t &inside_mask) noexcept
+    {
+        uint32_t outside = 0;
+        uint32_t crossing = 0;
+
+        for (size_t lane = 0; lane < BLOCK_SIZE; lane += Lanes::WIDTH)
+        {
+            size_t index = offset + lane;
+            uint32_t lane_outside = 0;
+            uint32_t lane_crossing = 0;
+            for (uint32_t i = 0; i < FrustumUtils::PLANE_COUNT; i++)
+            {
+                const float *plane = planes + i * 4;
+
+                // 平面对所有通道相同，沿法线最远和最近的顶点在标量上选择，不需要逐通道混合
+                const float *far_x = plane[0] > 0.0f ? bounds.m_max_x.data() : bounds.m_min_x.data();
+                const float *far_y = plane[1] > 0.0f ? bounds.m_max_y.data() : bounds.m_min_y.data();
+                const float *far_z = plane[2] > 0.0f ? bounds.m_max_z.data() : bounds.m_min_z.data();
+                const float *near_x = plane[0] > 0.0f ? bounds.m_min_x.data() : bounds.m_max_x.data();
+                const float *near_y = plane[1] > 0.0f ? bounds.m_min_y.data() : bounds.m_max_y.data();
+                const float *near_z = plane[2] > 0.0f ? bounds.m_min_z.data() : bounds.m_max_z.data();
+
+                typename Lanes::V a = Lanes::set1(plane[0]);
+                typename Lanes::V b = Lanes::set1(plane[1]);
+                typename Lanes::V c = Lanes::set1(plane[2]);
+                typename Lanes::V d = Lanes::set1(plane[3]);
+
+                typename Lanes::V far_distance = Lanes::add(
+                    Lanes::add(Lanes::mul(a, Lanes::load(far_x + index)), Lanes::mul(b, Lanes::load(far_y + index))),
+                    Lanes::add(Lanes::mul(c, Lanes::load(far_z + index)), d));
+                typename Lanes::V near_distance = Lanes::add(
+                    Lanes::add(Lanes::mul(a, Lanes::load(near_x + index)), Lanes::mul(b, Lanes::load(near_y + index))),
+                    Lanes::add(Lanes::mul(c, Lanes::load(near_z + index)), d));
+
+                lane_outside |= Lanes::negative_mask(far_distance);
+                lane_crossing |= Lanes::negative_mask(near_distance);
+            }
+            outside |= lane_outside << lane;
+            crossing |= lane_crossing << lane;
+        }
+
+        // 超出有效数量的通道不可见
+        size_t valid = bounds.m_count > offset ? std::min(bounds.m_count - offset, BLOCK_SIZE) : 0;
+        uint32_t valid_mask = (1u << valid) - 1u;
+        uint32_t visible = ~outside & valid_mask;
+        inside_mask = ~crossing & visible;
+        return visible;
+    }
+
+    void
+    CpuCuller::traverse(
+        size_t level,
+        size_t block,
+        const float planes[FrustumUtils::PLANE_COUNT * 4],
+        std::vector<uint32_t> &visible) const
+    {
+        const Bounds &bounds = m_levels[level];
+        uint32_t inside;
+        uint32_t mask = test_block(bounds, block * BLOCK_SIZE, planes, inside);
+
+        for (; mask != 0; mask &= mask - 1)
+        {
+            uint32_t lane = 0;
+            while (((mask >> lane) & 1u) == 0)
+                lane++;
+            size_t node = block * BLOCK_SIZE + lane;
+
+            if (level == 0)
+                visible.push_back(m_order[node]);
+            else if ((inside >> lane) & 1u)
+            {
+                // 完全在视锥体内，整棵子树可见，不再测试
+                size_t shift = 3 * level;
+                size_t begin = node << shift;
+                size_t end = std::min((node + 1) << shift, m_order.size());
+                visible.insert(visible.end(), m_order.begin() + begin, m_order.begin() + end);
+            }
+            else
+                traverse(level - 1, node, planes, visible);
+        }
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,156 @@
+#ifndef __VL_CPUCULLER_HPP__
+#define __VL_CPUCULLER_HPP__
+
+#include <vector>
+#include <ntl/NTL.hpp>
+#include "FrustumUtils.hpp"
+#include "ThreadPool.hpp"
+
+namespace vl
+{
+    /// @brief CPU视锥体剔除，包围盒以结构数组保存，每次测试8个
+    /// @details build按质心的Morton码排序后自底向上建立8叉BVH：第0层是排序后的物体，
+    /// 第k层的节点j包含第k-1层的节点[8j, 8j + 8)，一次测试就能检查一个节点的全部子节点
+    class CpuCuller : public ntl::Object
+    {
+    public:
+        using SelfType = CpuCuller;
+        using ParentType = ntl::Object;
+
+        /// @brief 以结构数组保存的包围盒，长度补齐到BLOCK_SIZE的倍数
+        struct Bounds
+        {
+            std::vector<float> m_min_x;
+            std::vector<float> m_min_y;
+            std::vector<float> m_min_z;
+            std::vector<float> m_max_x;
+            std::vector<float> m_max_y;
+            std::vector<float> m_max_z;
+
+            /// @brief 有效的包围盒数量
+            size_t m_count = 0;
+
+            void resize(size_t count);
+            void set(size_t index, const float min[3], const float max[3]);
+        };
+
+        /// @brief 每次测试的包围盒数
+        static constexpr size_t BLOCK_SIZE = 8;
+
+        /// @brief 不使用BVH时每个并行块的包围盒组数
+        static constexpr size_t PARALLEL_GRAIN = 1024;
+
+    protected:
+        /// @brief 按添加顺序的包围盒
+        Bounds m_boxes;
+
+        /// @brief BVH的每一层，第0层为按Morton码排序的包围盒
+        std::vector<Bounds> m_levels;
+
+        /// @brief 排序后的位置到物体索引
+        std::vector<uint32_t> m_order;
+
+        /// @brief 添加或修改物体后需要重新建立
+        bool m_is_built = false;
+
+    public:
+        CpuCuller() = default;
+        explicit CpuCuller(const SelfType &from) = default;
+        ~CpuCuller() override = default;
+
+    public:
+        SelfType &operator=(const SelfType &from) = default;
+
+    public:
+        /// @brief 获取物体数量
+        /// @return 数量
+        size_t size() const noexcept;
+
+        /// @brief 改变物体数量，新物体的包围盒为原点
+        /// @param count 数量
+        void resize(size_t count);
+
+        /// @brief 清空物体和BVH
+        void clear() noexcept;
+
+        /// @brief 添加一个物体
+        /// @param min 最小点
+        /// @param max 最大点
+        /// @return 物体的索引
+        size_t add(const float min[3], const float max[3]);
+
+        /// @brief 设置物体的包围盒，之后需要build或refit
+        /// @param index 索引
+        /// @param min 最小点
+        /// @param max 最大点
+        void set(size_t index, const float min[3], const float max[3]);
+
+        /// @brief 排序并建立BVH
+        void build();
+
+        /// @brief 保持排序不变，只重新计算BVH的包围盒，适合物体小幅移动后使用
+        void refit();
+
+        /// @brief BVH是否与物体一致
+        /// @return 是否已建立
+        bool is_built() const noexcept;
+
+        /// @brief 不使用BVH，测试全部物体
+        /// @param planes FrustumUtils::extract_planes得到的平面
+        /// @param visible 输出可见物体的索引，按索引递增
+        /// @param pool 线程池，为空时在调用线程计算
+        void cull_flat(
+            const float planes[FrustumUtils::PLANE_COUNT * 4],
+            std::vector<uint32_t> &visible,
+            ThreadPool *pool = nullptr) const;
+
+        /// @brief 遍历BVH，需要先调用build
+        /// @param planes FrustumUtils::extract_planes得到的平面
+        /// @param visible 输出可见物体的索引，按BVH的顺序
+        /// @param pool 线程池，为空时在调用线程计算
+        void cull(
+            const float planes[FrustumUtils::PLANE_COUNT * 4],
+            std::vector<uint32_t> &visible,
+            ThreadPool *pool = nullptr) const;
+
+    public:
+        /// @brief 测试一组8个包围盒
+        /// @param bounds 包围盒
+        /// @param offset 第一个包围盒，BLOCK_SIZE的倍数
+        /// @param planes 平面
+        /// @param inside_mask 输出完全在视锥体内的包围盒
+        /// @return 与视锥体相交的包围盒，超出m_count的位为0
+        static uint32_t test_block(
+            const Bounds &bounds,
+            size_t offset,
+            const float planes[FrustumUtils::PLANE_COUNT * 4],
+            uint32_t &inside_mask) noexcept;
+
+    protected:
+        struct ScalarLanes;
+        struct Sse2Lanes;
+        struct AvxLanes;
+        struct NeonLanes;
+
+        /// @brief 按Lanes的宽度分几次测试一组包围盒，返回与视锥体相交的位
+        template <typename Lanes>
+        static uint32_t test_lanes(
+            const Bounds &bounds,
+            size_t offset,
+            const float planes[FrustumUtils::PLANE_COUNT * 4],
+            uint32_t &inside_mask) noexcept;
+
+        /// @brief 测试节点组并递归到子节点
+        /// @param level 层
+        /// @param block 节点组，即上一层的节点
+        /// @param planes 平面
+        /// @param visible 输出
+        void traverse(
+            size_t level,
+            size_t block,
+            const float planes[FrustumUtils::PLANE_COUNT * 4],
+            std::vector<uint32_t> &visible) const;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
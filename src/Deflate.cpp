@@ -0,0 +1,879 @@
+#ifndef __VL_DEFLATE_CPP__
+#define __VL_DEFLATE_CPP__
+
+#include <cstring>
+#include <algorithm>
+#include <queue>
+#include "Deflate.hpp"
+#include "Simd.hpp"
+
+namespace vl
+{
+    void
+    Deflate::compress_zlib(
+        const uint8_t *data,
+        size_t size,
+        std::vector<uint8_t> &output)
+    {
+        // CMF: deflate，32K窗口；FLG: 最快压缩级别，满足FCHECK
+        output.push_back(0x78);
+        output.push_back(0x01);
+
+        compress(data, size, output);
+
+        uint32_t adler = adler32(1, data, size);
+        output.push_back(static_cast<uint8_t>(adler >> 24));
+        output.push_back(static_cast<uint8_t>(adler >> 16));
+        output.push_back(static_cast<uint8_t>(adler >> 8));
+        output.push_back(static_cast<uint8_t>(adler));
+    }
+
+    void
+    Deflate::compress(
+        const uint8_t *data,
+        size_t size,
+        std::vector<uint8_t> &output)
+    {
+        BitWriter writer(output);
+        std::vector<uint32_t> tokens;
+        tokens.reserve(BLOCK_TOKENS);
+
+        // 哈希表保存位置+1，0表示空
+        std::vector<uint32_t> head(size_t(1) << HASH_BITS, 0);
+        auto hash = [](const uint8_t *p) -> uint32_t
+        {
+            uint32_t value;
+            std::memcpy(&value, p, 4);
+            return (value * 2654435761u) >> (32 - HASH_BITS);
+        };
+
+        size_t block_start = 0;
+        size_t pos = 0;
+        while (pos < size)
+        {
+            uint32_t length = 0;
+            uint32_t distance = 0;
+
+            if (pos + MIN_MATCH <= size)
+            {
+                uint32_t h = hash(data + pos);
+                uint32_t candidate = head[h];
+                head[h] = static_cast<uint32_t>(pos + 1);
+
+                if (candidate != 0 && pos - (candidate - 1) <= WINDOW_SIZE)
+                {
+                    size_t match = candidate - 1;
+                    uint32_t limit = static_cast<uint32_t>(std::min<size_t>(MAX_MATCH, size - pos));
+                    length = get_match_length(data + match, data + pos, limit);
+                    distance = static_cast<uint32_t>(pos - match);
+                }
+            }
+
+            if (length >= MIN_MATCH)
+            {
+                tokens.push_back((1u << 31) | (length << 16) | (distance - 1));
+
+                // 匹配内部的位置也加入哈希表
+                size_t end = std::min(pos + length, size >= MIN_MATCH ? size - MIN_MATCH + 1 : 0);
+                for (size_t i = pos + 1; i < end; i++)
+                    head[hash(data + i)] = static_cast<uint32_t>(i + 1);
+                pos += length;
+            }
+            else
+            {
+                tokens.push_back(data[pos]);
+                pos++;
+            }
+
+            if (tokens.size() >= BLOCK_TOKENS)
+            {
+                write_block(writer, tokens, data + block_start, pos - block_start, pos == size);
+                tokens.clear();
+                block_start = pos;
+            }
+        }
+
+        if (!tokens.empty() || size == 0)
+            write_block(writer, tokens, data + block_start, pos - block_start, true);
+
+        writer.align();
+    }
+
+    bool
+    Deflate::decompress_zlib(
+        const uint8_t *data,
+        size_t size,
+        uint8_t *output,
+        size_t output_size) noexcept
+    {
+        // CMF为deflate且窗口不超过32K，FLG满足FCHECK且没有预设字典
+        if (size < 6 || (data[0] & 0x0f) != 8 || (data[0] >> 4) > 7 ||
+            ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20) != 0)
+            return false;
+        if (!decompress(data + 2, size - 6, output, output_size))
+            return false;
+
+        const uint8_t *tail = data + size - 4;
+        uint32_t expected = (static_cast<uint32_t>(tail[0]) << 24) | (tail[1] << 16) | (tail[2] << 8) | tail[3];
+        return adler32(1, output, output_size) == expected;
+    }
+
+    bool
+    Deflate::decompress(
+        const uint8_t *data,
+        size_t size,
+        uint8_t *output,
+        size_t output_size) noexcept
+    {
+        BitReader reader(data, size);
+        size_t position = 0;
+        Huffman literals, distances;
+        bool is_final = false;
+        while (!is_final)
+        {
+            is_final = reader.get(1) != 0;
+            uint32_t type = reader.get(2);
+            if (reader.m_is_overrun)
+                return false;
+
+            if (type == 0)
+            {
+                // 存储块：对齐后是LEN和它的反码
+                reader.align();
+                if (reader.m_position + 4 > size)
+                    return false;
+                uint32_t length = data[reader.m_position] | (data[reader.m_position + 1] << 8);
+                uint32_t complement = data[reader.m_position + 2] | (data[reader.m_position + 3] << 8);
+                reader.m_position += 4;
+                if ((length ^ 0xffffu) != complement ||
+                    length > size - reader.m_position || length > output_size - position)
+                    return false;
+                std::memcpy(output + position, data + reader.m_position, length);
+                reader.m_position += length;
+                position += length;
+            }
+            else if (type == 1)
+            {
+                // 固定哈夫曼码
+                uint8_t lengths[288 + 32];
+                std::memset(lengths, 8, 144);
+                std::memset(lengths + 144, 9, 112);
+                std::memset(lengths + 256, 7, 24);
+                std::memset(lengths + 280, 8, 8);
+                std::memset(lengths + 288, 5, 32);
+                build_decoder(lengths, 288, literals);
+                build_decoder(lengths + 288, 32, distances);
+                if (!inflate_block(reader, literals, distances, output, output_size, position))
+                    return false;
+            }
+            else if (type == 2)
+            {
+                uint32_t literal_count = reader.get(5) + 257;
+                uint32_t distance_count = reader.get(5) + 1;
+                uint32_t code_length_count = reader.get(4) + 4;
+                if (literal_count > 286 || distance_count > 30)
+                    return false;
+
+                uint8_t code_lengths[19] = {};
+                for (uint32_t i = 0; i < code_length_count; i++)
+                    code_lengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(reader.get(3));
+                Huffman code_length_decoder;
+                if (reader.m_is_overrun || !build_decoder(code_lengths, 19, code_length_decoder))
+                    return false;
+
+                // 字面量和距离的码长连续编码，重复可以跨越两者的边界
+                uint8_t lengths[286 + 30];
+                uint32_t count = 0;
+                while (count < literal_count + distance_count)
+                {
+                    int32_t symbol = decode_symbol(reader, code_length_decoder);
+                    if (symbol < 0)
+                        return false;
+                    if (symbol < 16)
+                    {
+                        lengths[count++] = static_cast<uint8_t>(symbol);
+                        continue;
+                    }
+
+                    uint8_t value = 0;
+                    uint32_t repeat = 0;
+                    if (symbol == 16)
+                    {
+                        if (count == 0)
+                            return false;
+                        value = lengths[count - 1];
+                        repeat = 3 + reader.get(2);
+                    }
+                    else if (symbol == 17)
+                        repeat = 3 + reader.get(3);
+                    else
+                        repeat = 11 + reader.get(7);
+                    if (reader.m_is_overrun || count + repeat > literal_count + distance_count)
+                        return false;
+                    std::memset(lengths + count, value, repeat);
+                    count += repeat;
+                }
+
+                // 块必须有结束符号
+                if (lengths[256] == 0 ||
+                    !build_decoder(lengths, literal_count, literals) ||
+                    !build_decoder(lengths + literal_count, distance_count, distances))
+                    return false;
+                if (!inflate_block(reader, literals, distances, output, output_size, position))
+                    return false;
+            }
+            else
+                return false;
+        }
+        return position == output_size;
+    }
+
+    uint32_t
+    Deflate::adler32(
+        uint32_t adler,
+        const uint8_t *data,
+        size_t size) noexcept
+    {
+        const uint32_t MOD = 65521;
+        // 保证32位累加不溢出的最大块长
+        const size_t NMAX = 5552;
+
+        uint32_t s1 = adler & 0xffff;
+        uint32_t s2 = adler >> 16;
+
+        while (size > 0)
+        {
+            size_t chunk = std::min(size, NMAX);
+            size -= chunk;
+
+#if defined(VL_SIMD_SSE2)
+            size_t blocks = chunk / 16;
+            if (blocks > 0)
+            {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i weight_low = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+                const __m128i weight_high = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+                __m128i v_s1 = _mm_setzero_si128();
+                __m128i v_prefix = _mm_setzero_si128();
+                __m128i v_s2 = _mm_setzero_si128();
+
+                for (size_t i = 0; i < blocks; i++)
+                {
+                    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+                    v_prefix = _mm_add_epi32(v_prefix, v_s1);
+                    v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes, zero));
+                    __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                    __m128i high = _mm_unpackhi_epi8(bytes, zero);
+                    v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(low, weight_low));
+                    v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(high, weight_high));
+                    data += 16;
+                }
+
+                auto horizontal_sum = [](__m128i v) -> uint32_t
+                {
+                    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+                    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+                    return static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+                };
+
+                s2 += static_cast<uint32_t>(s1 * 16 * blocks);
+                s2 += horizontal_sum(v_prefix) * 16 + horizontal_sum(v_s2);
+                s1 += horizontal_sum(v_s1);
+                chunk -= blocks * 16;
+            }
+#endif
+            while (chunk > 0)
+            {
+                s1 += *data++;
+                s2 += s1;
+                chunk--;
+            }
+
+            s1 %= MOD;
+            s2 %= MOD;
+        }
+
+        return (s2 << 16) | s1;
+    }
+
+    uint32_t
+    Deflate::crc32(
+        uint32_t crc,
+        const uint8_t *data,
+        size_t size) noexcept
+    {
+        // 切片8表，每次处理8字节
+        struct Tables
+        {
+            uint32_t m_table[8][256];
+
+            Tables()
+            {
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; k++)
+                        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                    m_table[0][i] = c;
+                }
+                for (uint32_t i = 0; i < 256; i++)
+                    for (int t = 1; t < 8; t++)
+                        m_table[t][i] = (m_table[t - 1][i] >> 8) ^ m_table[0][m_table[t - 1][i] & 0xff];
+            }
+        };
+        static const Tables tables;
+        const auto &t = tables.m_table;
+
+        crc = ~crc;
+        while (size >= 8)
+        {
+            uint32_t low;
+            uint32_t high;
+            std::memcpy(&low, data, 4);
+            std::memcpy(&high, data + 4, 4);
+            low ^= crc;
+            crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^ t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^
+                  t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+            data += 8;
+            size -= 8;
+        }
+        while (size > 0)
+        {
+            crc = t[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+            size--;
+        }
+        return ~crc;
+    }
+
+    uint32_t
+    Deflate::get_length_symbol(
+        uint32_t length) noexcept
+    {
+        struct Table
+        {
+            uint8_t m_symbol[MAX_MATCH + 1];
+
+            Table()
+            {
+                for (uint32_t symbol = 0; symbol < 29; symbol++)
+                {
+                    uint32_t end = symbol == 28 ? MAX_MATCH + 1 : LENGTH_BASE[symbol + 1];
+                    for (uint32_t l = LENGTH_BASE[symbol]; l < end; l++)
+                        m_symbol[l] = static_cast<uint8_t>(symbol);
+                }
+            }
+        };
+        static const Table table;
+        return table.m_symbol[length];
+    }
+
+    uint32_t
+    Deflate::get_distance_symbol(
+        uint32_t distance) noexcept
+    {
+        // 与zlib相同，小距离直接查表，大距离按128对齐查表
+        struct Table
+        {
+            uint8_t m_symbol[512];
+
+            Table()
+            {
+                for (uint32_t symbol = 0; symbol < 30; symbol++)
+                {
+                    uint32_t begin = DISTANCE_BASE[symbol] - 1;
+                    uint32_t end = begin + (1u << DISTANCE_EXTRA[symbol]);
+                    for (uint32_t d = begin; d < end; d++)
+                    {
+                        if (d < 256)
+                            m_symbol[d] = static_cast<uint8_t>(symbol);
+                        else
+                            m_symbol[256 + (d >> 7)] = static_cast<uint8_t>(symbol);
+                    }
+                }
+            }
+        };
+        static const Table table;
+
+        uint32_t d = distance - 1;
+        return d < 256 ? table.m_symbol[d] : table.m_symbol[256 + (d >> 7)];
+    }
+
+    uint32_t
+    Deflate::get_match_length(
+        const uint8_t *a,
+        const uint8_t *b,
+        uint32_t limit) noexcept
+    {
+        uint32_t length = 0;
+
+#if defined(VL_SIMD_SSE2)
+        while (length + 16 <= limit)
+        {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + length));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + length));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) ^ 0xffffu;
+            if (mask != 0)
+            {
+                uint32_t index = 0;
+                while (!(mask & 1u))
+                {
+                    mask >>= 1;
+                    index++;
+                }
+                return length + index;
+            }
+            length += 16;
+        }
+#elif defined(VL_SIMD_NEON)
+        while (length + 16 <= limit)
+        {
+            uint8x16_t equal = vceqq_u8(vld1q_u8(a + length), vld1q_u8(b + length));
+            if (vminvq_u8(equal) != 0xff)
+                break;
+            length += 16;
+        }
+#endif
+        while (length < limit && a[length] == b[length])
+            length++;
+
+        return length;
+    }
+
+    void
+    Deflate::write_block(
+        BitWriter &writer,
+        const std::vector<uint32_t> &tokens,
+        const uint8_t *data,
+        size_t size,
+        bool is_final)
+    {
+        std::vector<uint32_t> literal_frequencies(286, 0);
+        std::vector<uint32_t> distance_frequencies(30, 0);
+        for (auto iter = tokens.cbegin(); iter != tokens.cend(); iter++)
+        {
+            if (*iter & (1u << 31))
+            {
+                literal_frequencies[257 + get_length_symbol((*iter >> 16) & 0x1ff)]++;
+                distance_frequencies[get_distance_symbol((*iter & 0xffff) + 1)]++;
+            }
+            else
+                literal_frequencies[*iter]++;
+        }
+        literal_frequencies[256] = 1;
+
+        std::vector<uint8_t> literal_lengths;
+        std::vector<uint8_t> distance_lengths;
+        build_code_lengths(literal_frequencies, 15, literal_lengths);
+        build_code_lengths(distance_frequencies, 15, distance_lengths);
+
+        // 少于两个码时补足，保证解码器能建立完整的码表
+        auto complete = [](std::vector<uint8_t> &lengths)
+        {
+            auto used = std::find_if(lengths.cbegin(), lengths.cend(), [](uint8_t l)
+                                     { return l != 0; });
+            if (used == lengths.cend())
+            {
+                lengths[0] = 1;
+                lengths[1] = 1;
+            }
+            else if (std::count(lengths.cbegin(), lengths.cend(), uint8_t(0)) == static_cast<std::ptrdiff_t>(lengths.size() - 1))
+                lengths[used == lengths.cbegin() ? 1 : 0] = 1;
+        };
+        complete(literal_lengths);
+        complete(distance_lengths);
+
+        uint32_t literal_count = 286;
+        while (literal_count > 257 && literal_lengths[literal_count - 1] == 0)
+            literal_count--;
+        uint32_t distance_count = 30;
+        while (distance_count > 1 && distance_lengths[distance_count - 1] == 0)
+            distance_count--;
+
+        // 码长序列的游程编码，符号在低8位，额外位在高位
+        std::vector<uint8_t> all_lengths(literal_lengths.begin(), literal_lengths.begin() + literal_count);
+        all_lengths.insert(all_lengths.end(), distance_lengths.begin(), distance_lengths.begin() + distance_count);
+
+        std::vector<uint32_t> length_symbols;
+        std::vector<uint32_t> length_code_frequencies(19, 0);
+        for (size_t i = 0; i < all_lengths.size();)
+        {
+            uint8_t value = all_lengths[i];
+            size_t run = 1;
+            while (i + run < all_lengths.size() && all_lengths[i + run] == value)
+                run++;
+
+            if (value == 0 && run >= 3)
+            {
+                size_t count = std::min<size_t>(run, 138);
+                if (count >= 11)
+                    length_symbols.push_back(18 | static_cast<uint32_t>((count - 11) << 8));
+                else
+                    length_symbols.push_back(17 | static_cast<uint32_t>((count - 3) << 8));
+                length_code_frequencies[count >= 11 ? 18 : 17]++;
+                i += count;
+            }
+            else if (value != 0 && run >= 4)
+            {
+                length_symbols.push_back(value);
+                length_code_frequencies[value]++;
+                size_t count = std::min<size_t>(run - 1, 6);
+                length_symbols.push_back(16 | static_cast<uint32_t>((count - 3) << 8));
+                length_code_frequencies[16]++;
+                i += 1 + count;
+            }
+            else
+            {
+                length_symbols.push_back(value);
+                length_code_frequencies[value]++;
+                i++;
+            }
+        }
+
+        std::vector<uint8_t> length_code_lengths;
+        build_code_lengths(length_code_frequencies, 7, length_code_lengths);
+        uint32_t length_code_count = 19;
+        while (length_code_count > 4 && length_code_lengths[CODE_LENGTH_ORDER[length_code_count - 1]] == 0)
+            length_code_count--;
+
+        // 估算动态块的大小，不如存储块时直接存储
+        uint64_t dynamic_bits = 17 + 3 * length_code_count;
+        for (auto iter = length_symbols.cbegin(); iter != length_symbols.cend(); iter++)
+        {
+            uint32_t symbol = *iter & 0xff;
+            dynamic_bits += length_code_lengths[symbol] + (symbol == 16 ? 2 : symbol == 17 ? 3
+                                                                          : symbol == 18   ? 7
+                                                                                           : 0);
+        }
+        for (uint32_t i = 0; i < 286; i++)
+            dynamic_bits += static_cast<uint64_t>(literal_frequencies[i]) * literal_lengths[i];
+        for (uint32_t i = 0; i < 29; i++)
+            dynamic_bits += static_cast<uint64_t>(literal_frequencies[257 + i]) * LENGTH_EXTRA[i];
+        for (uint32_t i = 0; i < 30; i++)
+            dynamic_bits += static_cast<uint64_t>(distance_frequencies[i]) * (distance_lengths[i] + DISTANCE_EXTRA[i]);
+        uint64_t stored_bits = (static_cast<uint64_t>(size) + 5 * (size / 65535 + 1)) * 8 + 8;
+
+        if (stored_bits < dynamic_bits)
+        {
+            size_t offset = 0;
+            do
+            {
+                size_t count = std::min<size_t>(size - offset, 65535);
+                bool is_last = offset + count == size;
+                writer.put(is_final && is_last ? 1 : 0, 1);
+                writer.put(0, 2);
+                writer.align();
+                writer.put(static_cast<uint32_t>(count), 16);
+                writer.put(static_cast<uint32_t>(~count & 0xffff), 16);
+                writer.align();
+                writer.m_output.insert(writer.m_output.end(), data + offset, data + offset + count);
+                offset += count;
+            } while (offset < size);
+            return;
+        }
+
+        std::vector<uint16_t> literal_codes;
+        std::vector<uint16_t> distance_codes;
+        std::vector<uint16_t> length_codes;
+        build_codes(literal_lengths, literal_codes);
+        build_codes(distance_lengths, distance_codes);
+        build_codes(length_code_lengths, length_codes);
+
+        writer.put(is_final ? 1 : 0, 1);
+        writer.put(2, 2);
+        writer.put(literal_count - 257, 5);
+        writer.put(distance_count - 1, 5);
+        writer.put(length_code_count - 4, 4);
+        for (uint32_t i = 0; i < length_code_count; i++)
+            writer.put(length_code_lengths[CODE_LENGTH_ORDER[i]], 3);
+
+        for (auto iter = length_symbols.cbegin(); iter != length_symbols.cend(); iter++)
+        {
+            uint32_t symbol = *iter & 0xff;
+            writer.put(length_codes[symbol], length_code_lengths[symbol]);
+            if (symbol == 16)
+                writer.put(*iter >> 8, 2);
+            else if (symbol == 17)
+                writer.put(*iter >> 8, 3);
+            else if (symbol == 18)
+                writer.put(*iter >> 8, 7);
+        }
+
+        for (auto iter = tokens.cbegin(); iter != tokens.cend(); iter++)
+        {
+            if (*iter & (1u << 31))
+            {
+                uint32_t length = (*iter >> 16) & 0x1ff;
+                uint32_t distance = (*iter & 0xffff) + 1;
+
+                uint32_t length_symbol = get_length_symbol(length);
+                writer.put(literal_codes[257 + length_symbol], literal_lengths[257 + length_symbol]);
+                if (LENGTH_EXTRA[length_symbol] != 0)
+                    writer.put(length - LENGTH_BASE[length_symbol], LENGTH_EXTRA[length_symbol]);
+
+                uint32_t distance_symbol = get_distance_symbol(distance);
+                writer.put(distance_codes[distance_symbol], distance_lengths[distance_symbol]);
+                if (DISTANCE_EXTRA[distance_symbol] != 0)
+                    writer.put(distance - DISTANCE_BASE[distance_symbol], DISTANCE_EXTRA[distance_symbol]);
+            }
+            else
+                writer.put(literal_codes[*iter], literal_lengths[*iter]);
+        }
+
+        writer.put(literal_codes[256], literal_lengths[256]);
+    }
+
+    void
+    Deflate::build_code_lengths(
+        const std::vector<uint32_t> &frequencies,
+        uint32_t max_length,
+        std::vector<uint8_t> &lengths)
+    {
+        lengths.assign(frequencies.size(), 0);
+
+        std::vector<uint32_t> symbols;
+        for (uint32_t i = 0; i < frequencies.size(); i++)
+            if (frequencies[i] != 0)
+                symbols.push_back(i);
+
+        if (symbols.empty())
+            return;
+        if (symbols.size() == 1)
+        {
+            lengths[symbols[0]] = 1;
+            return;
+        }
+
+        // 普通的哈夫曼树，叶子在前，内部节点在后
+        size_t leaf_count = symbols.size();
+        std::vector<uint64_t> weights(leaf_count * 2 - 1);
+        std::vector<uint32_t> parents(leaf_count * 2 - 1, 0);
+        using NodeType = std::pair<uint64_t, uint32_t>;
+        std::priority_queue<NodeType, std::vector<NodeType>, std::greater<NodeType>> heap;
+        for (uint32_t i = 0; i < leaf_count; i++)
+        {
+            weights[i] = frequencies[symbols[i]];
+            heap.push(NodeType(weights[i], i));
+        }
+
+        uint32_t next = static_cast<uint32_t>(leaf_count);
+        while (heap.size() > 1)
+        {
+            NodeType a = heap.top();
+            heap.pop();
+            NodeType b = heap.top();
+            heap.pop();
+            weights[next] = a.first + b.first;
+            parents[a.second] = next;
+            parents[b.second] = next;
+            heap.push(NodeType(weights[next], next));
+            next++;
+        }
+
+        // 根是最后一个节点，父节点总在子节点之后，逆序即可求出深度
+        std::vector<uint32_t> depths(next, 0);
+        for (uint32_t i = next - 1; i-- > 0;)
+            depths[i] = depths[parents[i]] + 1;
+
+        // 超出最大码长时按Kraft不等式调整各码长的数量
+        std::vector<uint32_t> length_counts(std::max<uint32_t>(max_length, 64) + 1, 0);
+        for (uint32_t i = 0; i < leaf_count; i++)
+            length_counts[std::min<uint32_t>(depths[i], max_length)]++;
+
+        uint64_t total = 0;
+        for (uint32_t i = 1; i <= max_length; i++)
+            total += static_cast<uint64_t>(length_counts[i]) << (max_length - i);
+        while (total > (uint64_t(1) << max_length))
+        {
+            length_counts[max_length]--;
+            for (uint32_t i = max_length - 1; i > 0; i--)
+            {
+                if (length_counts[i] != 0)
+                {
+                    length_counts[i]--;
+                    length_counts[i + 1] += 2;
+                    break;
+                }
+            }
+            total--;
+        }
+
+        // 频率越低的符号分配越长的码
+        std::vector<uint32_t> order(leaf_count);
+        for (uint32_t i = 0; i < leaf_count; i++)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&weights](uint32_t a, uint32_t b)
+                         { return weights[a] < weights[b]; });
+
+        size_t index = 0;
+        for (uint32_t length = max_length; length > 0; length--)
+        {
+            for (uint32_t i = 0; i < length_counts[length]; i++)
+                lengths[symbols[order[index++]]] = static_cast<uint8_t>(length);
+        }
+    }
+
+    void
+    Deflate::build_codes(
+        const std::vector<uint8_t> &lengths,
+        std::vector<uint16_t> &codes)
+    {
+        uint32_t length_counts[16] = {};
+        for (auto iter = lengths.cbegin(); iter != lengths.cend(); iter++)
+            length_counts[*iter]++;
+        length_counts[0] = 0;
+
+        uint32_t next_code[16] = {};
+        uint32_t code = 0;
+        for (uint32_t bits = 1; bits < 16; bits++)
+        {
+            code = (code + length_counts[bits - 1]) << 1;
+            next_code[bits] = code;
+        }
+
+        codes.assign(lengths.size(), 0);
+        for (size_t i = 0; i < lengths.size(); i++)
+        {
+            uint32_t length = lengths[i];
+            if (length == 0)
+                continue;
+
+            // deflate按LSB优先写入，哈夫曼码需要按位反转
+            uint32_t value = next_code[length]++;
+            uint32_t reversed = 0;
+            for (uint32_t b = 0; b < length; b++)
+                reversed |= ((value >> b) & 1u) << (length - 1 - b);
+            codes[i] = static_cast<uint16_t>(reversed);
+        }
+    }
+
+    bool
+    Deflate::build_decoder(
+        const uint8_t *lengths,
+        uint32_t count,
+        Huffman &huffman) noexcept
+    {
+        std::memset(huffman.m_counts, 0, sizeof(huffman.m_counts));
+        std::memset(huffman.m_fast, 0, sizeof(huffman.m_fast));
+        for (uint32_t i = 0; i < count; i++)
+            huffman.m_counts[lengths[i]]++;
+        huffman.m_counts[0] = 0;
+
+        // 剩余的码空间为负表示超额分配
+        int32_t left = 1;
+        uint32_t used = 0;
+        for (uint32_t length = 1; length < 16; length++)
+        {
+            left = left * 2 - huffman.m_counts[length];
+            if (left < 0)
+                return false;
+            used += huffman.m_counts[length];
+        }
+        if (left > 0 && used > 1)
+            return false;
+
+        uint16_t offsets[16];
+        offsets[1] = 0;
+        for (uint32_t length = 1; length < 15; length++)
+            offsets[length + 1] = static_cast<uint16_t>(offsets[length] + huffman.m_counts[length]);
+        for (uint32_t i = 0; i < count; i++)
+            if (lengths[i] != 0)
+                huffman.m_symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+
+        // 不超过FAST_BITS的码按位反转后填入查找表
+        uint32_t code = 0, index = 0;
+        for (uint32_t length = 1; length <= FAST_BITS; length++)
+        {
+            for (uint32_t i = 0; i < huffman.m_counts[length]; i++, code++, index++)
+            {
+                uint32_t reversed = 0;
+                for (uint32_t b = 0; b < length; b++)
+                    reversed |= ((code >> b) & 1u) << (length - 1 - b);
+                uint16_t entry = static_cast<uint16_t>((huffman.m_symbols[index] << 4) | length);
+                for (uint32_t slot = reversed; slot < (1u << FAST_BITS); slot += 1u << length)
+                    huffman.m_fast[slot] = entry;
+            }
+            code <<= 1;
+        }
+        return true;
+    }
+
+    int32_t
+    Deflate::decode_symbol(
+        BitReader &reader,
+        const Huffman &huffman) noexcept
+    {
+        uint32_t bits = reader.peek(15);
+        uint16_t entry = huffman.m_fast[bits & ((1u << FAST_BITS) - 1)];
+        if (entry != 0)
+        {
+            reader.skip(entry & 15u);
+            return reader.m_is_overrun ? -1 : entry >> 4;
+        }
+
+        // 长码逐位比较范式码的范围
+        int32_t code = 0, first = 0, index = 0;
+        for (uint32_t length = 1; length < 16; length++)
+        {
+            code |= (bits >> (length - 1)) & 1;
+            int32_t count = huffman.m_counts[length];
+            if (code - first < count)
+            {
+                reader.skip(length);
+                return reader.m_is_overrun ? -1 : huffman.m_symbols[index + code - first];
+            }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    bool
+    Deflate::inflate_block(
+        BitReader &reader,
+        const Huffman &literals,
+        const Huffman &distances,
+        uint8_t *output,
+        size_t output_size,
+        size_t &position) noexcept
+    {
+        while (true)
+        {
+            int32_t symbol = decode_symbol(reader, literals);
+            if (symbol < 0)
+                return false;
+            if (symbol < 256)
+            {
+                if (position >= output_size)
+                    return false;
+                output[position++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+            if (symbol == 256)
+                return true;
+
+            symbol -= 257;
+            if (symbol >= 29)
+                return false;
+            uint32_t length = LENGTH_BASE[symbol] + reader.get(LENGTH_EXTRA[symbol]);
+            int32_t distance_symbol = decode_symbol(reader, distances);
+            if (distance_symbol < 0 || distance_symbol >= 30)
+                return false;
+            uint32_t distance = DISTANCE_BASE[distance_symbol] + reader.get(DISTANCE_EXTRA[distance_symbol]);
+            if (reader.m_is_overrun || distance > position || length > output_size - position)
+                return false;
+
+            // 距离小于长度时源和目标重叠，逐字节复制
+            const uint8_t *source = output + position - distance;
+            uint8_t *destination = output + position;
+            if (distance >= length)
+                std::memcpy(destination, source, length);
+            else
+                for (uint32_t i = 0; i < length; i++)
+                    destination[i] = source[i];
+            position += length;
+        }
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,273 @@
+#ifndef __VL_DEFLATE_HPP__
+#define __VL_DEFLATE_HPP__
+
+#include <vector>
+#include <cstdint>
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 快速的zlib/deflate压缩和解压
+    /// @details 压缩使用贪婪的LZ77匹配加每块动态哈夫曼编码，追求速度而不是压缩率；
+    /// 解压要求事先知道解压后的大小，输入可能来自损坏的文件，所有读写都检查范围
+    class Deflate : public ntl::Object
+    {
+    public:
+        using SelfType = Deflate;
+        using ParentType = ntl::Object;
+
+    public:
+        constexpr Deflate() noexcept = default;
+        constexpr explicit Deflate(const SelfType &from) noexcept = default;
+        ~Deflate() override = default;
+
+    public:
+        constexpr SelfType &operator=(const SelfType &from) noexcept = default;
+
+    public:
+        /// @brief 压缩为zlib数据流
+        /// @param data 数据
+        /// @param size 大小
+        /// @param output 输出，追加在末尾
+        static void compress_zlib(const uint8_t *data, size_t size, std::vector<uint8_t> &output);
+
+        /// @brief 压缩为原始deflate数据流
+        /// @param data 数据
+        /// @param size 大小
+        /// @param output 输出，追加在末尾
+        static void compress(const uint8_t *data, size_t size, std::vector<uint8_t> &output);
+
+        /// @brief 解压zlib数据流，检查Adler-32校验和
+        /// @param data 数据
+        /// @param size 大小
+        /// @param output 输出
+        /// @param output_size 解压后的大小，必须恰好相等
+        /// @return 是否成功，数据损坏或大小不符时失败
+        static bool decompress_zlib(const uint8_t *data, size_t size, uint8_t *output, size_t output_size) noexcept;
+
+        /// @brief 解压原始deflate数据流
+        /// @param data 数据
+        /// @param size 大小
+        /// @param output 输出
+        /// @param output_size 解压后的大小，必须恰好相等
+        /// @return 是否成功
+        static bool decompress(const uint8_t *data, size_t size, uint8_t *output, size_t output_size) noexcept;
+
+        /// @brief 计算Adler-32校验和
+        /// @param adler 初始值，首次为1
+        /// @param data 数据
+        /// @param size 大小
+        /// @return 校验和
+        static uint32_t adler32(uint32_t adler, const uint8_t *data, size_t size) noexcept;
+
+        /// @brief 计算CRC-32校验和
+        /// @param crc 初始值，首次为0
+        /// @param data 数据
+        /// @param size 大小
+        /// @return 校验和
+        static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t size) noexcept;
+
+    protected:
+        /// @brief 按LSB优先顺序写入比特
+        struct BitWriter
+        {
+            std::vector<uint8_t> &m_output;
+            uint64_t m_bits = 0;
+            uint32_t m_count = 0;
+
+            explicit BitWriter(std::vector<uint8_t> &output) : m_output(output) {}
+
+            /// @brief 写入不超过16位
+            void put(uint32_t value, uint32_t count)
+            {
+                m_bits |= static_cast<uint64_t>(value) << m_count;
+                m_count += count;
+                if (m_count >= 32)
+                {
+                    for (int i = 0; i < 4; i++)
+                        m_output.push_back(static_cast<uint8_t>(m_bits >> (i * 8)));
+                    m_bits >>= 32;
+                    m_count -= 32;
+                }
+            }
+
+            /// @brief 补齐到字节边界并写出剩余的比特
+            void align()
+            {
+                while (m_count > 0)
+                {
+                    m_output.push_back(static_cast<uint8_t>(m_bits));
+                    m_bits >>= 8;
+                    m_count = m_count > 8 ? m_count - 8 : 0;
+                }
+                m_bits = 0;
+            }
+        };
+
+        /// @brief 按LSB优先顺序读取比特，读过数据末尾时置错误标志
+        struct BitReader
+        {
+            const uint8_t *m_data = nullptr;
+            size_t m_size = 0;
+            size_t m_position = 0;
+            uint64_t m_bits = 0;
+            uint32_t m_count = 0;
+            bool m_is_overrun = false;
+
+            BitReader(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+            /// @brief 补充到至少57位或数据结束
+            void refill()
+            {
+                while (m_count <= 56 && m_position < m_size)
+                {
+                    m_bits |= static_cast<uint64_t>(m_data[m_position++]) << m_count;
+                    m_count += 8;
+                }
+            }
+
+            /// @brief 查看不超过32位，不足时高位为0
+            uint32_t peek(uint32_t count)
+            {
+                if (m_count < count)
+                    refill();
+                return static_cast<uint32_t>(m_bits & ((uint64_t(1) << count) - 1));
+            }
+
+            /// @brief 丢弃已查看的比特
+            void skip(uint32_t count)
+            {
+                if (m_count < count)
+                {
+                    m_is_overrun = true;
+                    m_bits = 0;
+                    m_count = 0;
+                    return;
+                }
+                m_bits >>= count;
+                m_count -= count;
+            }
+
+            /// @brief 读取不超过32位
+            uint32_t get(uint32_t count)
+            {
+                uint32_t value = peek(count);
+                skip(count);
+                return value;
+            }
+
+            /// @brief 丢弃到字节边界，并把缓冲中剩余的整字节退回数据中
+            void align()
+            {
+                skip(m_count % 8);
+                m_position -= m_count / 8;
+                m_bits = 0;
+                m_count = 0;
+            }
+        };
+
+        /// @brief 范式哈夫曼码的解码表
+        struct Huffman
+        {
+            /// @brief 短码的查找表，每项为(符号 << 4) | 码长，0表示需要逐位解码
+            uint16_t m_fast[1 << 9];
+
+            /// @brief 每种码长的码数
+            uint16_t m_counts[16];
+
+            /// @brief 按码排列的符号
+            uint16_t m_symbols[288];
+        };
+
+        static constexpr uint32_t FAST_BITS = 9;
+
+        static constexpr uint32_t WINDOW_SIZE = 32768;
+        static constexpr uint32_t MIN_MATCH = 4;
+        static constexpr uint32_t MAX_MATCH = 258;
+        static constexpr uint32_t HASH_BITS = 15;
+        static constexpr size_t BLOCK_TOKENS = 1 << 16;
+
+        static constexpr uint16_t LENGTH_BASE[29] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static constexpr uint8_t LENGTH_EXTRA[29] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static constexpr uint16_t DISTANCE_BASE[30] = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static constexpr uint8_t DISTANCE_EXTRA[30] = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        static constexpr uint8_t CODE_LENGTH_ORDER[19] = {
+            16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    protected:
+        /// @brief 获取匹配长度对应的符号，0~28
+        /// @param length 长度，3~258
+        /// @return 符号
+        static uint32_t get_length_symbol(uint32_t length) noexcept;
+
+        /// @brief 获取距离对应的符号，0~29
+        /// @param distance 距离，1~32768
+        /// @return 符号
+        static uint32_t get_distance_symbol(uint32_t distance) noexcept;
+
+        /// @brief 计算两段数据相同前缀的长度
+        /// @param a 数据a
+        /// @param b 数据b
+        /// @param limit 最大长度
+        /// @return 长度
+        static uint32_t get_match_length(const uint8_t *a, const uint8_t *b, uint32_t limit) noexcept;
+
+        /// @brief 由码长建立解码表
+        /// @param lengths 每个符号的码长，0表示不使用
+        /// @param count 符号数
+        /// @param huffman 输出
+        /// @return 码长是否合法，不允许超额分配；不完整的码只在最多一个码时允许
+        static bool build_decoder(const uint8_t *lengths, uint32_t count, Huffman &huffman) noexcept;
+
+        /// @brief 解码一个符号
+        /// @param reader 比特读取器
+        /// @param huffman 解码表
+        /// @return 符号，数据损坏时为-1
+        static int32_t decode_symbol(BitReader &reader, const Huffman &huffman) noexcept;
+
+        /// @brief 解码一个哈夫曼块的内容
+        /// @param reader 比特读取器
+        /// @param literals 字面量和长度的解码表
+        /// @param distances 距离的解码表
+        /// @param output 输出
+        /// @param output_size 输出的容量
+        /// @param position 当前的输出位置
+        /// @return 是否成功
+        static bool inflate_block(
+            BitReader &reader,
+            const Huffman &literals,
+            const Huffman &distances,
+            uint8_t *output,
+            size_t output_size,
+            size_t &position) noexcept;
+
+        /// @brief 写出一块
+        /// @param writer 比特写入器
+        /// @param tokens 记号
+        /// @param data 块对应的原始数据
+        /// @param size 原始数据大小
+        /// @param is_final 是否为最后一块
+        static void write_block(BitWriter &writer, const std::vector<uint32_t> &tokens, const uint8_t *data, size_t size, bool is_final);
+
+        /// @brief 计算限制最大长度的哈夫曼码长
+        /// @param frequencies 频率
+        /// @param max_length 最大码长
+        /// @param lengths 输出的码长
+        static void build_code_lengths(const std::vector<uint32_t> &frequencies, uint32_t max_length, std::vector<uint8_t> &lengths);
+
+        /// @brief 由码长计算按位反转的范式哈夫曼码
+        /// @param lengths 码长
+        /// @param codes 输出的码
+        static void build_codes(const std::vector<uint8_t> &lengths, std::vector<uint16_t> &codes);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,143 @@
+#ifndef __VL_DEVICEUTILS_CPP__
+#define __VL_DEVICEUTILS_CPP__
+
+#include <algorithm>
+#include "DeviceUtils.hpp"
+
+namespace vl
+{
+    std::optional<uint32_t>
+    DeviceUtils::find_memory_type(
+        const vk::PhysicalDevice &physical_device,
+        uint32_t type_bits,
+        vk::MemoryPropertyFlags properties)
+    {
+        vk::PhysicalDeviceMemoryProperties memory_properties = physical_device.getMemoryProperties();
+
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+        {
+            if ((type_bits & (1u << i)) &&
+                (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+                return i;
+        }
+
+        return std::nullopt;
+    }
+
+    vk::ResultValue<vk::Buffer>
+    DeviceUtils::create_buffer(
+        const vk::Device &device,
+        vk::DeviceSize size,
+        vk::BufferUsageFlags usage,
+        const std::vector<uint32_t> &queue_families)
+    {
+        vk::BufferCreateInfo create_info;
+        create_info.setSize(size);
+        create_info.setUsage(usage);
+        create_info.setSharingMode(vk::SharingMode::eExclusive);
+
+        // 去掉重复的系列
+        std::vector<uint32_t> families;
+        for (auto iter = queue_families.cbegin(); iter != queue_families.cend(); iter++)
+            if (std::find(families.cbegin(), families.cend(), *iter) == families.cend())
+                families.push_back(*iter);
+        if (families.size() > 1)
+        {
+            create_info.setSharingMode(vk::SharingMode::eConcurrent);
+            create_info.setQueueFamilyIndexCount(static_cast<uint32_t>(families.size()));
+            create_info.setPQueueFamilyIndices(families.data());
+        }
+
+        return device.createBuffer(create_info);
+    }
+
+    vk::ResultValue<vk::DeviceMemory>
+    DeviceUtils::allocate_buffer_memory(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        const vk::Buffer &buffer,
+        vk::MemoryPropertyFlags preferred,
+        vk::MemoryPropertyFlags required)
+    {
+        vk::MemoryRequirements requirements = device.getBufferMemoryRequirements(buffer);
+        auto memory_result = allocate_memory(device, physical_device, requirements, preferred, required);
+        if (memory_result.result != vk::Result::eSuccess)
+            return memory_result;
+
+        vk::Result result = device.bindBufferMemory(buffer, memory_result.value, 0);
+        if (result != vk::Result::eSuccess)
+        {
+            device.freeMemory(memory_result.value);
+            return vk::ResultValue<vk::DeviceMemory>(result, vk::DeviceMemory(nullptr));
+        }
+
+        return memory_result;
+    }
+
+    vk::ResultValue<vk::DeviceMemory>
+    DeviceUtils::allocate_image_memory(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        const vk::Image &image,
+        vk::MemoryPropertyFlags preferred,
+        vk::MemoryPropertyFlags required)
+    {
+        vk::MemoryRequirements requirements = device.getImageMemoryRequirements(image);
+        auto memory_result = allocate_memory(device, physical_device, requirements, preferred, required);
+        if (memory_result.result != vk::Result::eSuccess)
+            return memory_result;
+
+        vk::Result result = device.bindImageMemory(image, memory_result.value, 0);
+        if (result != vk::Result::eSuccess)
+        {
+            device.freeMemory(memory_result.value);
+            return vk::ResultValue<vk::DeviceMemory>(result, vk::DeviceMemory(nullptr));
+        }
+
+        return memory_result;
+    }
+
+    vk::ResultValue<vk::ShaderModule>
+    DeviceUtils::create_shader_module(
+        const vk::Device &device,
+        const uint32_t *code,
+        size_t size)
+    {
+        vk::ShaderModuleCreateInfo create_info;
+        create_info.setCodeSize(size);
+        create_info.setPCode(code);
+
+        return device.createShaderModule(create_info);
+    }
+
+    vk::ResultValue<vk::DeviceMemory>
+    DeviceUtils::allocate_memory(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        const vk::MemoryRequirements &requirements,
+        vk::MemoryPropertyFlags preferred,
+        vk::MemoryPropertyFlags required)
+    {
+        // 先尝试优先的属性，找不到再退回必须的属性
+        std::optional<uint32_t> type = find_memory_type(physical_device, requirements.memoryTypeBits, preferred | required);
+        if (!type.has_value())
+            type = find_memory_type(physical_device, requirements.memoryTypeBits, required);
+        if (!type.has_value())
+        {
+            ntl::log.loge(
+                NTL_STRING("DeviceUtils::allocate_memory"),
+                NTL_STRING("Unable to find suitable memory type"));
+            return vk::ResultValue<vk::DeviceMemory>(
+                vk::Result::eErrorOutOfDeviceMemory,
+                vk::DeviceMemory(nullptr));
+        }
+
+        vk::MemoryAllocateInfo allocate_info;
+        allocate_info.setAllocationSize(requirements.size);
+        allocate_info.setMemoryTypeIndex(*type);
+
+        return device.allocateMemory(allocate_info);
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
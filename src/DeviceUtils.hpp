@@ -1,6 +1,8 @@
 #ifndef __VL_DEVICEUTILS_HPP__
 #define __VL_DEVICEUTILS_HPP__
 
+#include <optional>
+#include <vector>
 #include "Vulkan.hpp"
 #include <ntl/NTL.hpp>
 
@@ -21,8 +23,75 @@ namespace vl
     public:
         constexpr SelfType &operator=(const SelfType &from) = default;
 
-        public:
-        
+    public:
+        /// @brief 查找合适的内存类型
+        /// @param physical_device 物理设备
+        /// @param type_bits 可用的内存类型位
+        /// @param properties 需要的内存属性
+        /// @return 内存类型索引，没有则返回空
+        static std::optional<uint32_t> find_memory_type(const vk::PhysicalDevice &physical_device, uint32_t type_bits, vk::MemoryPropertyFlags properties);
+
+        /// @brief 创建缓冲
+        /// @param device 逻辑设备
+        /// @param size 大小
+        /// @param usage 用途
+        /// @param queue_families 共享缓冲的队列系列，多于一个不同系列时使用并发共享模式
+        /// @return 结果
+        static vk::ResultValue<vk::Buffer> create_buffer(
+            const vk::Device &device,
+            vk::DeviceSize size,
+            vk::BufferUsageFlags usage,
+            const std::vector<uint32_t> &queue_families = {});
+
+        /// @brief 为缓冲分配并绑定内存
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param buffer 缓冲
+        /// @param preferred 优先选择的内存属性
+        /// @param required 必须满足的内存属性
+        /// @return 结果
+        static vk::ResultValue<vk::DeviceMemory> allocate_buffer_memory(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            const vk::Buffer &buffer,
+            vk::MemoryPropertyFlags preferred,
+            vk::MemoryPropertyFlags required);
+
+        /// @brief 为图像分配并绑定内存
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param image 图像
+        /// @param preferred 优先选择的内存属性
+        /// @param required 必须满足的内存属性
+        /// @return 结果
+        static vk::ResultValue<vk::DeviceMemory> allocate_image_memory(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            const vk::Image &image,
+            vk::MemoryPropertyFlags preferred,
+            vk::MemoryPropertyFlags required);
+
+        /// @brief 创建着色器模块
+        /// @param device 逻辑设备
+        /// @param code SPIR-V代码
+        /// @param size 代码的字节数
+        /// @return 结果
+        static vk::ResultValue<vk::ShaderModule> create_shader_module(const vk::Device &device, const uint32_t *code, size_t size);
+
+    protected:
+        /// @brief 按内存需求分配内存
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param requirements 内存需求
+        /// @param preferred 优先选择的内存属性
+        /// @param required 必须满足的内存属性
+        /// @return 结果
+        static vk::ResultValue<vk::DeviceMemory> allocate_memory(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            const vk::MemoryRequirements &requirements,
+            vk::MemoryPropertyFlags preferred,
+            vk::MemoryPropertyFlags required);
     };
 } // namespace vl
 
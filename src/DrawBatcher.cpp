@@ -0,0 +1,92 @@
+#ifndef __VL_DRAWBATCHER_CPP__
+#define __VL_DRAWBATCHER_CPP__
+
+#include <algorithm>
+#include "DrawBatcher.hpp"
+
+namespace vl
+{
+    uint32_t
+    DrawBatcher::build(
+        const RenderQueue &queue,
+        const Draw *draws,
+        VkDrawIndexedIndirectCommand *commands,
+        uint32_t max_command_count)
+    {
+        m_batches.clear();
+        m_command_count = 0;
+
+        const std::vector<uint64_t> &keys = queue.get_keys();
+        const std::vector<uint32_t> &indices = queue.get_indices();
+        size_t count = std::min(queue.size(), static_cast<size_t>(max_command_count));
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t pass = RenderQueue::get_pass(keys[i]);
+            uint32_t pipeline = RenderQueue::get_pipeline(keys[i]);
+            uint32_t descriptor_set = RenderQueue::get_descriptor_set(keys[i]);
+            if (m_batches.empty() ||
+                m_batches.back().m_pass != pass ||
+                m_batches.back().m_pipeline != pipeline ||
+                m_batches.back().m_descriptor_set != descriptor_set)
+            {
+                Batch batch;
+                batch.m_pass = pass;
+                batch.m_pipeline = pipeline;
+                batch.m_descriptor_set = descriptor_set;
+                batch.m_first_command = m_command_count;
+                m_batches.push_back(batch);
+            }
+
+            const Draw &draw = draws[indices[i]];
+            VkDrawIndexedIndirectCommand &command = commands[m_command_count];
+            command.indexCount = draw.m_index_count;
+            command.instanceCount = draw.m_instance_count;
+            command.firstIndex = draw.m_first_index;
+            command.vertexOffset = draw.m_vertex_offset;
+            command.firstInstance = draw.m_first_instance;
+            m_batches.back().m_command_count++;
+            m_command_count++;
+        }
+
+        return m_command_count;
+    }
+
+    const std::vector<DrawBatcher::Batch> &
+    DrawBatcher::get_batches() const noexcept
+    {
+        return m_batches;
+    }
+
+    uint32_t
+    DrawBatcher::get_command_count() const noexcept
+    {
+        return m_command_count;
+    }
+
+    template <typename Dispatch, typename Func>
+    void
+    DrawBatcher::record(
+        CommandList<Dispatch> &list,
+        const vk::Buffer &buffer,
+        vk::DeviceSize offset,
+        uint32_t max_draw_count,
+        Func bind) const
+    {
+        max_draw_count = std::max(max_draw_count, 1u);
+        for (const Batch &batch : m_batches)
+        {
+            bind(batch);
+            for (uint32_t first = 0; first < batch.m_command_count; first += max_draw_count)
+            {
+                uint32_t draw_count = std::min(max_draw_count, batch.m_command_count - first);
+                list.draw_indexed_indirect(
+                    buffer,
+                    offset + (batch.m_first_command + first) * sizeof(VkDrawIndexedIndirectCommand),
+                    draw_count,
+                    sizeof(VkDrawIndexedIndirectCommand));
+            }
+        }
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
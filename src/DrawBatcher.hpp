@@ -0,0 +1,97 @@
+#ifndef __VL_DRAWBATCHER_HPP__
+#define __VL_DRAWBATCHER_HPP__
+
+#include <vector>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "RenderQueue.hpp"
+#include "CommandList.hpp"
+
+namespace vl
+{
+    /// @brief 把通道、管线和描述符集相同的绘制合并为一次vkCmdDrawIndexedIndirect
+    /// @details 先用RenderQueue排序，相邻且通道、管线和描述符集相同的绘制成为一批，
+    /// 一批不会跨越通道，
+    /// 每次绘制写一个VkDrawIndexedIndirectCommand。Vulkan 1.0没有gl_DrawID，
+    /// 每次绘制的数据通过firstInstance传给着色器，由gl_InstanceIndex读取，
+    /// 需要启用drawIndirectFirstInstance
+    class DrawBatcher : public ntl::Object
+    {
+    public:
+        using SelfType = DrawBatcher;
+        using ParentType = ntl::Object;
+
+        /// @brief 一次索引绘制
+        struct Draw
+        {
+            uint32_t m_index_count = 0;
+            uint32_t m_instance_count = 1;
+            uint32_t m_first_index = 0;
+            int32_t m_vertex_offset = 0;
+
+            /// @brief 着色器中gl_InstanceIndex的起点，一般为物体的索引
+            uint32_t m_first_instance = 0;
+        };
+
+        /// @brief 一批，间接缓冲中连续的若干命令
+        struct Batch
+        {
+            uint32_t m_pass = 0;
+            uint32_t m_pipeline = 0;
+            uint32_t m_descriptor_set = 0;
+            uint32_t m_first_command = 0;
+            uint32_t m_command_count = 0;
+        };
+
+    protected:
+        std::vector<Batch> m_batches;
+        uint32_t m_command_count = 0;
+
+    public:
+        DrawBatcher() = default;
+        explicit DrawBatcher(const SelfType &from) = default;
+        ~DrawBatcher() override = default;
+
+    public:
+        SelfType &operator=(const SelfType &from) = default;
+
+    public:
+        /// @brief 按排序后的队列生成间接命令和批，不需要设备
+        /// @param queue 已排序的队列，索引指向draws
+        /// @param draws 绘制
+        /// @param commands 输出的间接命令，一般为映射的间接缓冲
+        /// @param max_command_count commands的容量，超出的绘制被丢弃
+        /// @return 写入的命令数
+        uint32_t build(
+            const RenderQueue &queue,
+            const Draw *draws,
+            VkDrawIndexedIndirectCommand *commands,
+            uint32_t max_command_count);
+
+        /// @brief 获取批
+        /// @return 批
+        const std::vector<Batch> &get_batches() const noexcept;
+
+        /// @brief 获取上次build写入的命令数
+        /// @return 命令数
+        uint32_t get_command_count() const noexcept;
+
+        /// @brief 录制全部批
+        /// @tparam Dispatch 分发表类型
+        /// @tparam Func 函数类型，参数为(const Batch &)
+        /// @param list 命令列表
+        /// @param buffer 间接缓冲
+        /// @param offset build写入的位置在缓冲中的偏移
+        /// @param max_draw_count 每次间接绘制的最大命令数，不支持multiDrawIndirect时为1
+        /// @param bind 为一批绑定管线和描述符集，经过CommandList时重复的绑定会被去掉
+        template <typename Dispatch, typename Func>
+        void record(
+            CommandList<Dispatch> &list,
+            const vk::Buffer &buffer,
+            vk::DeviceSize offset,
+            uint32_t max_draw_count,
+            Func bind) const;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,229 @@
+#ifndef __VL_ENCODEQUEUE_CPP__
+#define __VL_ENCODEQUEUE_CPP__
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include "EncodeQueue.hpp"
+
+namespace vl
+{
+    double
+    EncodeQueue::Statistics::megabytes_per_second_per_core() const noexcept
+    {
+        if (m_encode_seconds <= 0.0)
+            return 0.0;
+        return static_cast<double>(m_input_bytes) / (1024.0 * 1024.0) / m_encode_seconds;
+    }
+
+    EncodeQueue::~EncodeQueue()
+    {
+        destroy();
+    }
+
+    bool
+    EncodeQueue::create(
+        const Config &config,
+        SinkType sink)
+    {
+        if (config.m_capacity == 0 || !sink)
+        {
+            ntl::log.loge(
+                NTL_STRING("EncodeQueue::create"),
+                NTL_STRING("Capacity must not be zero and sink must be set"));
+            return false;
+        }
+
+        m_config = config;
+        m_sink = std::move(sink);
+        m_pool = std::make_unique<ThreadPool>(config.m_thread_count);
+        m_statistics = Statistics();
+        m_statistics.m_thread_count = m_pool->get_thread_count();
+        m_is_stopping = false;
+        m_writer = std::thread(&EncodeQueue::writer_loop, this);
+
+        return true;
+    }
+
+    void
+    EncodeQueue::destroy()
+    {
+        if (!m_writer.joinable())
+            return;
+
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_stopping = true;
+        }
+        m_encoded_cv.notify_all();
+        m_writer.join();
+        m_pool.reset();
+    }
+
+    std::optional<uint64_t>
+    EncodeQueue::push(
+        Input &&input)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_space_cv.wait(lock, [this]()
+                            { return m_pending < m_config.m_capacity || m_is_stopping; });
+            if (m_is_stopping)
+                return std::nullopt;
+            m_pending++;
+        }
+        return dispatch(std::move(input));
+    }
+
+    std::optional<uint64_t>
+    EncodeQueue::try_push(
+        Input &&input)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_pending >= m_config.m_capacity || m_is_stopping)
+                return std::nullopt;
+            m_pending++;
+        }
+        return dispatch(std::move(input));
+    }
+
+    void
+    EncodeQueue::flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_written_cv.wait(lock, [this]()
+                          { return m_pending == 0; });
+    }
+
+    EncodeQueue::Statistics
+    EncodeQueue::get_statistics()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_statistics;
+    }
+
+    ntl::String
+    EncodeQueue::format()
+    {
+        Statistics statistics = get_statistics();
+
+        ntl::StringStream sstr;
+        sstr << std::endl
+             << NTL_STRING("\tformat:") << ImageEncoder::get_extension(m_config.m_format) << std::endl
+             << NTL_STRING("\tthreads:") << statistics.m_thread_count << std::endl
+             << NTL_STRING("\tframes:") << statistics.m_frames << std::endl
+             << NTL_STRING("\tfailed:") << statistics.m_failed << std::endl
+             << NTL_STRING("\tinput bytes:") << statistics.m_input_bytes << std::endl
+             << NTL_STRING("\toutput bytes:") << statistics.m_output_bytes << std::endl
+             << NTL_STRING("\tMB/s per core:") << statistics.megabytes_per_second_per_core() << std::endl;
+        return sstr.str();
+    }
+
+    EncodeQueue::SinkType
+    EncodeQueue::create_file_sink(
+        const std::string &prefix,
+        ImageEncoder::Format format)
+    {
+        std::string extension = ImageEncoder::get_extension(format);
+
+        return [prefix, extension](uint64_t index, const std::vector<uint8_t> &data) -> bool
+        {
+            char number[32];
+            std::snprintf(number, sizeof(number), "%06llu.", static_cast<unsigned long long>(index));
+
+            std::ofstream fout(prefix + number + extension, std::ios::binary);
+            if (fout.fail())
+                return false;
+            fout.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+            return !fout.fail();
+        };
+    }
+
+    uint64_t
+    EncodeQueue::dispatch(
+        Input &&input)
+    {
+        uint64_t index;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            index = m_next_index++;
+        }
+
+        // std::function需要可复制，输入通过shared_ptr交给任务
+        auto shared_input = std::make_shared<Input>(std::move(input));
+        m_pool->post([this, index, shared_input]()
+                     {
+                         auto begin = std::chrono::steady_clock::now();
+
+                         ImageEncoder::Image image;
+                         image.m_pixels = shared_input->m_pixels.data();
+                         image.m_width = shared_input->m_width;
+                         image.m_height = shared_input->m_height;
+                         image.m_row_pitch = shared_input->m_row_pitch;
+                         image.m_layout = shared_input->m_layout;
+
+                         std::vector<uint8_t> output;
+                         bool success = shared_input->m_pixels.size() >= static_cast<size_t>(image.m_row_pitch) * image.m_height &&
+                                        ImageEncoder::encode(m_config.m_format, image, output);
+
+                         double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                         size_t input_bytes = shared_input->m_pixels.size();
+                         shared_input->m_pixels = std::vector<uint8_t>();
+
+                         {
+                             std::lock_guard<std::mutex> lock(m_mutex);
+                             m_statistics.m_encode_seconds += seconds;
+                             m_statistics.m_input_bytes += input_bytes;
+                             if (success)
+                                 m_encoded[index] = std::move(output);
+                             else
+                                 m_encoded[index] = std::nullopt;
+                         }
+                         m_encoded_cv.notify_one(); });
+
+        return index;
+    }
+
+    void
+    EncodeQueue::writer_loop()
+    {
+        while (true)
+        {
+            std::optional<std::vector<uint8_t>> data;
+            uint64_t index;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_encoded_cv.wait(lock, [this]()
+                                  { return m_is_stopping || m_encoded.count(m_next_write) != 0; });
+
+                auto iter = m_encoded.find(m_next_write);
+                if (iter == m_encoded.end())
+                    return;
+
+                index = iter->first;
+                data = std::move(iter->second);
+                m_encoded.erase(iter);
+            }
+
+            // 输出可能很慢，不持有锁
+            bool success = data.has_value() && m_sink(index, *data);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_next_write++;
+                m_pending--;
+                m_statistics.m_frames++;
+                if (success)
+                    m_statistics.m_output_bytes += data->size();
+                else
+                    m_statistics.m_failed++;
+            }
+            m_space_cv.notify_one();
+            m_written_cv.notify_all();
+        }
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,150 @@
+#ifndef __VL_ENCODEQUEUE_HPP__
+#define __VL_ENCODEQUEUE_HPP__
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <string>
+#include <ntl/NTL.hpp>
+#include "ImageEncoder.hpp"
+#include "ThreadPool.hpp"
+
+namespace vl
+{
+    /// @brief 并行图像编码队列
+    /// @details 帧在线程池中并行编码，由写出线程按提交顺序交给输出函数；
+    /// 已提交但还没有写出的帧数有上限，输出慢时push会阻塞，内存不会无限增长
+    class EncodeQueue : public ntl::Object
+    {
+    public:
+        using SelfType = EncodeQueue;
+        using ParentType = ntl::Object;
+
+        /// @brief 输出函数类型，参数为帧序号和编码后的数据，编码失败时数据为空
+        using SinkType = std::function<bool(uint64_t index, const std::vector<uint8_t> &data)>;
+
+        /// @brief 配置
+        struct Config
+        {
+            ImageEncoder::Format m_format = ImageEncoder::Format::ePng;
+
+            /// @brief 最多同时存在的帧数
+            size_t m_capacity = 8;
+
+            /// @brief 编码线程数，为0时使用硬件线程数
+            size_t m_thread_count = 0;
+        };
+
+        /// @brief 一帧输入
+        struct Input
+        {
+            std::vector<uint8_t> m_pixels;
+            uint32_t m_width = 0;
+            uint32_t m_height = 0;
+            uint32_t m_row_pitch = 0;
+            ImageEncoder::PixelLayout m_layout = ImageEncoder::PixelLayout::eRgba;
+        };
+
+        /// @brief 统计信息
+        struct Statistics
+        {
+            uint64_t m_frames = 0;
+            uint64_t m_failed = 0;
+            uint64_t m_input_bytes = 0;
+            uint64_t m_output_bytes = 0;
+
+            /// @brief 所有编码线程耗时之和
+            double m_encode_seconds = 0.0;
+
+            /// @brief 编码线程数
+            size_t m_thread_count = 0;
+
+            /// @brief 单核吞吐量
+            /// @return 输入MB/s
+            double megabytes_per_second_per_core() const noexcept;
+        };
+
+    protected:
+        Config m_config;
+        SinkType m_sink;
+        std::unique_ptr<ThreadPool> m_pool;
+
+        std::mutex m_mutex;
+        std::condition_variable m_space_cv;
+        std::condition_variable m_encoded_cv;
+        std::condition_variable m_written_cv;
+
+        /// @brief 已提交但还没有写出的帧数
+        size_t m_pending = 0;
+
+        /// @brief 下一个提交的帧序号
+        uint64_t m_next_index = 0;
+
+        /// @brief 下一个要写出的帧序号
+        uint64_t m_next_write = 0;
+
+        /// @brief 已编码、等待按顺序写出的帧
+        std::map<uint64_t, std::optional<std::vector<uint8_t>>> m_encoded;
+
+        Statistics m_statistics;
+        std::thread m_writer;
+        bool m_is_stopping = false;
+
+    public:
+        EncodeQueue() = default;
+        ~EncodeQueue() override;
+
+        EncodeQueue(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 启动编码线程和写出线程
+        /// @param config 配置
+        /// @param sink 输出函数
+        /// @return 是否成功
+        bool create(const Config &config, SinkType sink);
+
+        /// @brief 写出所有已提交的帧后停止
+        void destroy();
+
+        /// @brief 提交一帧，队列满时阻塞
+        /// @param input 输入
+        /// @return 帧序号
+        std::optional<uint64_t> push(Input &&input);
+
+        /// @brief 提交一帧，队列满时直接返回
+        /// @param input 输入
+        /// @return 帧序号，队列满时返回空
+        std::optional<uint64_t> try_push(Input &&input);
+
+        /// @brief 等待所有已提交的帧写出
+        void flush();
+
+        /// @brief 获取统计信息
+        /// @return 统计信息
+        Statistics get_statistics();
+
+        /// @brief 格式化统计信息
+        /// @return 格式化后的结果
+        ntl::String format();
+
+    public:
+        /// @brief 创建按序号命名文件的输出函数，例如prefix000001.png
+        /// @param prefix 路径前缀
+        /// @param format 格式
+        /// @return 输出函数
+        static SinkType create_file_sink(const std::string &prefix, ImageEncoder::Format format);
+
+    protected:
+        /// @brief 把一帧交给线程池，调用时已占用容量
+        /// @param input 输入
+        /// @return 帧序号
+        uint64_t dispatch(Input &&input);
+
+        /// @brief 写出线程
+        void writer_loop();
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef __VL_FRUSTUMUTILS_CPP__
+#define __VL_FRUSTUMUTILS_CPP__
+
+#include <cmath>
+#include "FrustumUtils.hpp"
+
+namespace vl
+{
+    void
+    FrustumUtils::extract_planes(
+        const float view_projection[16],
+        float planes[PLANE_COUNT * 4],
+        bool is_zero_to_one_depth) noexcept
+    {
+        // 第i行为(m[i], m[4 + i], m[8 + i], m[12 + i])
+        auto row = [view_projection](int i, int j) -> float
+        {
+            return view_projection[j * 4 + i];
+        };
+
+        for (int j = 0; j < 4; j++)
+        {
+            planes[0 * 4 + j] = row(3, j) + row(0, j);
+            planes[1 * 4 + j] = row(3, j) - row(0, j);
+            planes[2 * 4 + j] = row(3, j) + row(1, j);
+            planes[3 * 4 + j] = row(3, j) - row(1, j);
+            planes[4 * 4 + j] = is_zero_to_one_depth ? row(2, j) : row(3, j) + row(2, j);
+            planes[5 * 4 + j] = row(3, j) - row(2, j);
+        }
+
+        for (uint32_t i = 0; i < PLANE_COUNT; i++)
+        {
+            float *plane = planes + i * 4;
+            float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            if (length > 0.0f)
+                for (int j = 0; j < 4; j++)
+                    plane[j] /= length;
+        }
+    }
+
+    bool
+    FrustumUtils::is_sphere_visible(
+        const float planes[PLANE_COUNT * 4],
+        const float center[3],
+        float radius) noexcept
+    {
+        for (uint32_t i = 0; i < PLANE_COUNT; i++)
+        {
+            const float *plane = planes + i * 4;
+            if (plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3] < -radius)
+                return false;
+        }
+        return true;
+    }
+
+    bool
+    FrustumUtils::is_box_visible(
+        const float planes[PLANE_COUNT * 4],
+        const float min[3],
+        const float max[3]) noexcept
+    {
+        // 只需检查沿法线方向最远的顶点
+        for (uint32_t i = 0; i < PLANE_COUNT; i++)
+        {
+            const float *plane = planes + i * 4;
+            float x = plane[0] > 0.0f ? max[0] : min[0];
+            float y = plane[1] > 0.0f ? max[1] : min[1];
+            float z = plane[2] > 0.0f ? max[2] : min[2];
+            if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f)
+                return false;
+        }
+        return true;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef __VL_FRUSTUMUTILS_HPP__
+#define __VL_FRUSTUMUTILS_HPP__
+
+#include <cstdint>
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 视锥体工具
+    class FrustumUtils : public ntl::Object
+    {
+    public:
+        using SelfType = FrustumUtils;
+        using ParentType = ntl::Object;
+
+        /// @brief 平面数量，依次为左、右、下、上、近、远
+        static constexpr uint32_t PLANE_COUNT = 6;
+
+    public:
+        constexpr FrustumUtils() noexcept = default;
+        constexpr explicit FrustumUtils(const SelfType &) noexcept = default;
+        ~FrustumUtils() override = default;
+
+    public:
+        constexpr SelfType &operator=(const SelfType &from) = default;
+
+    public:
+        /// @brief 从投影乘观察矩阵中提取六个平面(a, b, c, d)，法线指向视锥体内部并已归一化
+        /// @param view_projection 列主序的矩阵，与linmath.h的mat4x4相同
+        /// @param planes 输出，每个平面4个分量
+        /// @param is_zero_to_one_depth 裁剪空间深度是否为[0, w]（Vulkan），否则为[-w, w]（OpenGL）
+        static void extract_planes(
+            const float view_projection[16],
+            float planes[PLANE_COUNT * 4],
+            bool is_zero_to_one_depth = true) noexcept;
+
+        /// @brief 球体是否与视锥体相交
+        /// @param planes 平面
+        /// @param center 球心
+        /// @param radius 半径
+        /// @return 是否可见
+        static bool is_sphere_visible(
+            const float planes[PLANE_COUNT * 4],
+            const float center[3],
+            float radius) noexcept;
+
+        /// @brief 轴对齐包围盒是否与视锥体相交，保守测试，可能把视锥体角落外的盒子判为可见
+        /// @param planes 平面
+        /// @param min 最小点
+        /// @param max 最大点
+        /// @return 是否可见
+        static bool is_box_visible(
+            const float planes[PLANE_COUNT * 4],
+            const float min[3],
+            const float max[3]) noexcept;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,612 @@
+#ifndef __VL_GPUCULLER_CPP__
+#define __VL_GPUCULLER_CPP__
+
+#include <algorithm>
+#include <cstring>
+#include "GpuCuller.hpp"
+#include "DeviceUtils.hpp"
+
+namespace vl
+{
+    vk::Result
+    GpuCuller::create(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        const DefaultQueueFamilyIndices &indices,
+        const Config &config)
+    {
+        if (config.m_max_objects == 0 || config.m_cull_code == nullptr ||
+            config.m_hiz_width == 0 || config.m_hiz_height == 0 ||
+            !indices.m_graphics_family.has_value() || !indices.m_compute_family.has_value())
+        {
+            ntl::log.loge(
+                NTL_STRING("GpuCuller::create"),
+                NTL_STRING("Invalid config"));
+            return vk::Result::eErrorInitializationFailed;
+        }
+
+        m_device = device;
+        m_config = config;
+        m_is_family_shared = *indices.m_compute_family != *indices.m_graphics_family;
+
+        // 绘制命令和数量由计算系列写入，图形系列读取
+        std::vector<uint32_t> families = {*indices.m_compute_family, *indices.m_graphics_family};
+        vk::BufferUsageFlags output_usage =
+            vk::BufferUsageFlagBits::eStorageBuffer |
+            vk::BufferUsageFlagBits::eIndirectBuffer |
+            vk::BufferUsageFlagBits::eTransferSrc |
+            vk::BufferUsageFlagBits::eTransferDst;
+
+        vk::Result result = m_object_buffer.create(
+            m_device,
+            physical_device,
+            sizeof(Object) * config.m_max_objects,
+            vk::BufferUsageFlagBits::eStorageBuffer);
+        if (result == vk::Result::eSuccess)
+            result = create_buffer(
+                physical_device,
+                sizeof(VkDrawIndexedIndirectCommand) * config.m_max_objects,
+                output_usage,
+                families,
+                m_draw_buffer,
+                m_draw_memory);
+        if (result == vk::Result::eSuccess)
+            result = create_buffer(
+                physical_device,
+                sizeof(uint32_t),
+                output_usage,
+                families,
+                m_count_buffer,
+                m_count_memory);
+        if (result == vk::Result::eSuccess)
+            result = create_buffer(
+                physical_device,
+                sizeof(Uniforms),
+                vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst,
+                {},
+                m_uniform_buffer,
+                m_uniform_memory);
+        if (result == vk::Result::eSuccess)
+            result = create_hiz(physical_device);
+        if (result == vk::Result::eSuccess)
+            result = create_pipelines();
+        if (result != vk::Result::eSuccess)
+        {
+            ntl::log.loge(
+                NTL_STRING("GpuCuller::create"),
+                ntl::StringUtils::to_string(
+                    NTL_STRING("Failed to create culler, error code:"),
+                    static_cast<long>(result)));
+            destroy();
+            return result;
+        }
+
+        if (config.m_is_draw_indirect_count_enabled)
+            m_draw_indexed_indirect_count = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                m_device.getProcAddr("vkCmdDrawIndexedIndirectCountKHR"));
+
+        return vk::Result::eSuccess;
+    }
+
+    void
+    GpuCuller::destroy()
+    {
+        if (!m_device)
+            return;
+
+        if (m_cull_pipeline)
+            m_device.destroyPipeline(m_cull_pipeline);
+        if (m_hiz_pipeline)
+            m_device.destroyPipeline(m_hiz_pipeline);
+        if (m_cull_pipeline_layout)
+            m_device.destroyPipelineLayout(m_cull_pipeline_layout);
+        if (m_hiz_pipeline_layout)
+            m_device.destroyPipelineLayout(m_hiz_pipeline_layout);
+        if (m_descriptor_pool)
+            m_device.destroyDescriptorPool(m_descriptor_pool);
+        if (m_cull_set_layout)
+            m_device.destroyDescriptorSetLayout(m_cull_set_layout);
+        if (m_hiz_set_layout)
+            m_device.destroyDescriptorSetLayout(m_hiz_set_layout);
+
+        if (m_sampler)
+            m_device.destroySampler(m_sampler);
+        for (auto iter = m_hiz_level_views.cbegin(); iter != m_hiz_level_views.cend(); iter++)
+            m_device.destroyImageView(*iter);
+        if (m_hiz_view)
+            m_device.destroyImageView(m_hiz_view);
+        if (m_hiz_image)
+            m_device.destroyImage(m_hiz_image);
+        if (m_hiz_memory)
+            m_device.freeMemory(m_hiz_memory);
+
+        const vk::Buffer buffers[] = {m_draw_buffer, m_count_buffer, m_uniform_buffer};
+        const vk::DeviceMemory memories[] = {m_draw_memory, m_count_memory, m_uniform_memory};
+        for (size_t i = 0; i < 3; i++)
+        {
+            if (buffers[i])
+                m_device.destroyBuffer(buffers[i]);
+            if (memories[i])
+                m_device.freeMemory(memories[i]);
+        }
+        m_object_buffer.destroy(m_device);
+
+        m_cull_pipeline = nullptr;
+        m_hiz_pipeline = nullptr;
+        m_cull_pipeline_layout = nullptr;
+        m_hiz_pipeline_layout = nullptr;
+        m_descriptor_pool = nullptr;
+        m_cull_set_layout = nullptr;
+        m_hiz_set_layout = nullptr;
+        m_cull_set = nullptr;
+        m_hiz_sets.clear();
+        m_sampler = nullptr;
+        m_hiz_level_views.clear();
+        m_hiz_view = nullptr;
+        m_hiz_image = nullptr;
+        m_hiz_memory = nullptr;
+        m_hiz_levels = 0;
+        m_draw_buffer = nullptr;
+        m_draw_memory = nullptr;
+        m_count_buffer = nullptr;
+        m_count_memory = nullptr;
+        m_uniform_buffer = nullptr;
+        m_uniform_memory = nullptr;
+        m_draw_indexed_indirect_count = nullptr;
+        m_is_hiz_initialized = false;
+        m_has_depth = false;
+        m_device = nullptr;
+    }
+
+    GpuCuller::Object *
+    GpuCuller::get_objects() const noexcept
+    {
+        return m_object_buffer.data<Object>();
+    }
+
+    bool
+    GpuCuller::set_depth(
+        const vk::ImageView &depth_view,
+        vk::SharingMode depth_sharing_mode,
+        vk::ImageLayout depth_layout)
+    {
+        if (m_hiz_sets.empty())
+            return false;
+
+        // 独占模式的图像在另一个系列上使用前需要释放和获取所有权，否则内容未定义
+        if (m_is_family_shared && depth_sharing_mode != vk::SharingMode::eConcurrent)
+        {
+            ntl::log.loge(
+                NTL_STRING("GpuCuller::set_depth"),
+                NTL_STRING("The depth image must be shared concurrently by the graphics and compute families"));
+            m_has_depth = false;
+            return false;
+        }
+
+        vk::DescriptorImageInfo image_info(m_sampler, depth_view, depth_layout);
+        vk::WriteDescriptorSet write;
+        write.setDstSet(m_hiz_sets.at(0));
+        write.setDstBinding(0);
+        write.setDescriptorCount(1);
+        write.setDescriptorType(vk::DescriptorType::eCombinedImageSampler);
+        write.setPImageInfo(&image_info);
+        m_device.updateDescriptorSets(write, nullptr);
+        m_has_depth = true;
+        return true;
+    }
+
+    void
+    GpuCuller::record_hiz(
+        const vk::CommandBuffer &command_buffer)
+    {
+        if (!m_hiz_pipeline || !m_has_depth)
+        {
+            ntl::log.loge(
+                NTL_STRING("GpuCuller::record_hiz"),
+                NTL_STRING("Hi-Z pipeline or depth image is not available"));
+            return;
+        }
+
+        // 上一次剔除读取完成后才能覆盖金字塔
+        vk::ImageMemoryBarrier barrier;
+        barrier.setSrcAccessMask(m_is_hiz_initialized ? vk::AccessFlagBits::eShaderRead : vk::AccessFlags());
+        barrier.setDstAccessMask(vk::AccessFlagBits::eShaderWrite);
+        barrier.setOldLayout(m_is_hiz_initialized ? vk::ImageLayout::eGeneral : vk::ImageLayout::eUndefined);
+        barrier.setNewLayout(vk::ImageLayout::eGeneral);
+        barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setImage(m_hiz_image);
+        barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, m_hiz_levels, 0, 1));
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::DependencyFlags(),
+            nullptr,
+            nullptr,
+            barrier);
+        m_is_hiz_initialized = true;
+
+        command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_hiz_pipeline);
+        int32_t source_size[2] = {static_cast<int32_t>(m_config.m_hiz_width), static_cast<int32_t>(m_config.m_hiz_height)};
+        for (uint32_t level = 0; level < m_hiz_levels; level++)
+        {
+            int32_t sizes[4] = {
+                source_size[0],
+                source_size[1],
+                std::max(static_cast<int32_t>(m_config.m_hiz_width >> level), 1),
+                std::max(static_cast<int32_t>(m_config.m_hiz_height >> level), 1),
+            };
+            command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_hiz_pipeline_layout, 0, m_hiz_sets.at(level), nullptr);
+            command_buffer.pushConstants(m_hiz_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(sizes), sizes);
+            command_buffer.dispatch(
+                (sizes[2] + HIZ_WORKGROUP_SIZE - 1) / HIZ_WORKGROUP_SIZE,
+                (sizes[3] + HIZ_WORKGROUP_SIZE - 1) / HIZ_WORKGROUP_SIZE,
+                1);
+
+            // 下一层和剔除读取这一层
+            barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+            barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+            barrier.setOldLayout(vk::ImageLayout::eGeneral);
+            barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, level, 1, 0, 1));
+            command_buffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eComputeShader,
+                vk::PipelineStageFlagBits::eComputeShader,
+                vk::DependencyFlags(),
+                nullptr,
+                nullptr,
+                barrier);
+
+            source_size[0] = sizes[2];
+            source_size[1] = sizes[3];
+        }
+    }
+
+    void
+    GpuCuller::record_cull(
+        const vk::CommandBuffer &command_buffer,
+        const float view_projection[16],
+        uint32_t object_count,
+        bool is_hiz_enabled)
+    {
+        object_count = std::min(object_count, m_config.m_max_objects);
+
+        Uniforms uniforms;
+        std::memcpy(uniforms.m_view_projection, view_projection, sizeof(uniforms.m_view_projection));
+        FrustumUtils::extract_planes(view_projection, uniforms.m_planes);
+        uniforms.m_object_count = object_count;
+        uniforms.m_hiz_levels = is_hiz_enabled && m_is_hiz_initialized ? m_hiz_levels : 0;
+        uniforms.m_hiz_width = static_cast<float>(m_config.m_hiz_width);
+        uniforms.m_hiz_height = static_cast<float>(m_config.m_hiz_height);
+
+        // 上一帧的间接绘制和剔除完成后才能覆盖输出
+        vk::MemoryBarrier barrier;
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            barrier,
+            nullptr,
+            nullptr);
+
+        command_buffer.fillBuffer(m_count_buffer, 0, VK_WHOLE_SIZE, 0);
+        // 没有绘制数量时按最大数量绘制，多余的命令需要实例数为0
+        if (!m_draw_indexed_indirect_count)
+            command_buffer.fillBuffer(m_draw_buffer, 0, VK_WHOLE_SIZE, 0);
+        command_buffer.updateBuffer(m_uniform_buffer, 0, sizeof(Uniforms), &uniforms);
+
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eUniformRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::DependencyFlags(),
+            barrier,
+            nullptr,
+            nullptr);
+
+        if (object_count > 0)
+        {
+            command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_cull_pipeline);
+            command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_cull_pipeline_layout, 0, m_cull_set, nullptr);
+            command_buffer.dispatch((object_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+        }
+
+        // 输出用于间接绘制，也可以复制回主机
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eTransferRead);
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            barrier,
+            nullptr,
+            nullptr);
+    }
+
+    void
+    GpuCuller::record_draw(
+        const vk::CommandBuffer &command_buffer,
+        uint32_t max_draw_count)
+    {
+        max_draw_count = std::min(max_draw_count, m_config.m_max_objects);
+        const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+        if (m_draw_indexed_indirect_count)
+            m_draw_indexed_indirect_count(
+                static_cast<VkCommandBuffer>(command_buffer),
+                static_cast<VkBuffer>(m_draw_buffer),
+                0,
+                static_cast<VkBuffer>(m_count_buffer),
+                0,
+                max_draw_count,
+                stride);
+        else if (m_config.m_is_multi_draw_indirect_enabled)
+            command_buffer.drawIndexedIndirect(m_draw_buffer, 0, max_draw_count, stride);
+        else
+            for (uint32_t i = 0; i < max_draw_count; i++)
+                command_buffer.drawIndexedIndirect(m_draw_buffer, static_cast<vk::DeviceSize>(i) * stride, 1, stride);
+    }
+
+    vk::Result
+    GpuCuller::create_buffer(
+        const vk::PhysicalDevice &physical_device,
+        vk::DeviceSize size,
+        vk::BufferUsageFlags usage,
+        const std::vector<uint32_t> &queue_families,
+        vk::Buffer &buffer,
+        vk::DeviceMemory &memory)
+    {
+        auto buffer_result = DeviceUtils::create_buffer(m_device, size, usage, queue_families);
+        if (buffer_result.result != vk::Result::eSuccess)
+            return buffer_result.result;
+        buffer = buffer_result.value;
+
+        auto memory_result = DeviceUtils::allocate_buffer_memory(
+            m_device,
+            physical_device,
+            buffer,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::MemoryPropertyFlags());
+        if (memory_result.result != vk::Result::eSuccess)
+            return memory_result.result;
+        memory = memory_result.value;
+
+        return vk::Result::eSuccess;
+    }
+
+    vk::Result
+    GpuCuller::create_hiz(
+        const vk::PhysicalDevice &physical_device)
+    {
+        m_hiz_levels = 1;
+        for (uint32_t size = std::max(m_config.m_hiz_width, m_config.m_hiz_height); size > 1; size >>= 1)
+            m_hiz_levels++;
+
+        vk::ImageCreateInfo image_info;
+        image_info.setImageType(vk::ImageType::e2D);
+        image_info.setFormat(vk::Format::eR32Sfloat);
+        image_info.setExtent(vk::Extent3D(m_config.m_hiz_width, m_config.m_hiz_height, 1));
+        image_info.setMipLevels(m_hiz_levels);
+        image_info.setArrayLayers(1);
+        image_info.setSamples(vk::SampleCountFlagBits::e1);
+        image_info.setTiling(vk::ImageTiling::eOptimal);
+        image_info.setUsage(vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled);
+        image_info.setSharingMode(vk::SharingMode::eExclusive);
+        image_info.setInitialLayout(vk::ImageLayout::eUndefined);
+        auto image_result = m_device.createImage(image_info);
+        if (image_result.result != vk::Result::eSuccess)
+            return image_result.result;
+        m_hiz_image = image_result.value;
+
+        auto memory_result = DeviceUtils::allocate_image_memory(
+            m_device,
+            physical_device,
+            m_hiz_image,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::MemoryPropertyFlags());
+        if (memory_result.result != vk::Result::eSuccess)
+            return memory_result.result;
+        m_hiz_memory = memory_result.value;
+
+        vk::ImageViewCreateInfo view_info;
+        view_info.setImage(m_hiz_image);
+        view_info.setViewType(vk::ImageViewType::e2D);
+        view_info.setFormat(vk::Format::eR32Sfloat);
+        view_info.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, m_hiz_levels, 0, 1));
+        auto view_result = m_device.createImageView(view_info);
+        if (view_result.result != vk::Result::eSuccess)
+            return view_result.result;
+        m_hiz_view = view_result.value;
+
+        for (uint32_t level = 0; level < m_hiz_levels; level++)
+        {
+            view_info.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, level, 1, 0, 1));
+            view_result = m_device.createImageView(view_info);
+            if (view_result.result != vk::Result::eSuccess)
+                return view_result.result;
+            m_hiz_level_views.push_back(view_result.value);
+        }
+
+        // texelFetch不使用过滤，但组合图像采样器仍需要采样器
+        vk::SamplerCreateInfo sampler_info;
+        sampler_info.setMagFilter(vk::Filter::eNearest);
+        sampler_info.setMinFilter(vk::Filter::eNearest);
+        sampler_info.setMipmapMode(vk::SamplerMipmapMode::eNearest);
+        sampler_info.setAddressModeU(vk::SamplerAddressMode::eClampToEdge);
+        sampler_info.setAddressModeV(vk::SamplerAddressMode::eClampToEdge);
+        sampler_info.setAddressModeW(vk::SamplerAddressMode::eClampToEdge);
+        sampler_info.setMaxLod(static_cast<float>(m_hiz_levels));
+        auto sampler_result = m_device.createSampler(sampler_info);
+        if (sampler_result.result != vk::Result::eSuccess)
+            return sampler_result.result;
+        m_sampler = sampler_result.value;
+
+        return vk::Result::eSuccess;
+    }
+
+    vk::Result
+    GpuCuller::create_pipelines()
+    {
+        // 剔除：uniform、物体、绘制命令、数量、金字塔
+        vk::DescriptorSetLayoutBinding cull_bindings[] = {
+            vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eCompute),
+            vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute),
+            vk::DescriptorSetLayoutBinding(2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute),
+            vk::DescriptorSetLayoutBinding(3, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute),
+            vk::DescriptorSetLayoutBinding(4, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute),
+        };
+        vk::DescriptorSetLayoutCreateInfo set_layout_info;
+        set_layout_info.setBindingCount(5);
+        set_layout_info.setPBindings(cull_bindings);
+        auto set_layout_result = m_device.createDescriptorSetLayout(set_layout_info);
+        if (set_layout_result.result != vk::Result::eSuccess)
+            return set_layout_result.result;
+        m_cull_set_layout = set_layout_result.value;
+
+        // 金字塔：上一层（或深度图像）、这一层
+        vk::DescriptorSetLayoutBinding hiz_bindings[] = {
+            vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute),
+            vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute),
+        };
+        set_layout_info.setBindingCount(2);
+        set_layout_info.setPBindings(hiz_bindings);
+        set_layout_result = m_device.createDescriptorSetLayout(set_layout_info);
+        if (set_layout_result.result != vk::Result::eSuccess)
+            return set_layout_result.result;
+        m_hiz_set_layout = set_layout_result.value;
+
+        vk::DescriptorPoolSize pool_sizes[] = {
+            vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, 1),
+            vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 3),
+            vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, 1 + m_hiz_levels),
+            vk::DescriptorPoolSize(vk::DescriptorType::eStorageImage, m_hiz_levels),
+        };
+        vk::DescriptorPoolCreateInfo pool_info;
+        pool_info.setMaxSets(1 + m_hiz_levels);
+        pool_info.setPoolSizeCount(4);
+        pool_info.setPPoolSizes(pool_sizes);
+        auto pool_result = m_device.createDescriptorPool(pool_info);
+        if (pool_result.result != vk::Result::eSuccess)
+            return pool_result.result;
+        m_descriptor_pool = pool_result.value;
+
+        std::vector<vk::DescriptorSetLayout> set_layouts(1 + m_hiz_levels, m_hiz_set_layout);
+        set_layouts.at(0) = m_cull_set_layout;
+        vk::DescriptorSetAllocateInfo set_info;
+        set_info.setDescriptorPool(m_descriptor_pool);
+        set_info.setDescriptorSetCount(static_cast<uint32_t>(set_layouts.size()));
+        set_info.setPSetLayouts(set_layouts.data());
+        auto set_result = m_device.allocateDescriptorSets(set_info);
+        if (set_result.result != vk::Result::eSuccess)
+            return set_result.result;
+        m_cull_set = set_result.value.at(0);
+        m_hiz_sets.assign(set_result.value.begin() + 1, set_result.value.end());
+
+        // 写入描述符，第0层的来源在set_depth中写入
+        vk::DescriptorBufferInfo buffer_infos[] = {
+            vk::DescriptorBufferInfo(m_uniform_buffer, 0, VK_WHOLE_SIZE),
+            vk::DescriptorBufferInfo(m_object_buffer.m_buffer, 0, VK_WHOLE_SIZE),
+            vk::DescriptorBufferInfo(m_draw_buffer, 0, VK_WHOLE_SIZE),
+            vk::DescriptorBufferInfo(m_count_buffer, 0, VK_WHOLE_SIZE),
+        };
+        std::vector<vk::DescriptorImageInfo> image_infos;
+        image_infos.reserve(1 + m_hiz_levels * 2);
+        image_infos.push_back(vk::DescriptorImageInfo(m_sampler, m_hiz_view, vk::ImageLayout::eGeneral));
+
+        std::vector<vk::WriteDescriptorSet> writes;
+        for (uint32_t binding = 0; binding < 5; binding++)
+        {
+            vk::WriteDescriptorSet write;
+            write.setDstSet(m_cull_set);
+            write.setDstBinding(binding);
+            write.setDescriptorCount(1);
+            write.setDescriptorType(cull_bindings[binding].descriptorType);
+            if (binding < 4)
+                write.setPBufferInfo(&buffer_infos[binding]);
+            else
+                write.setPImageInfo(&image_infos.back());
+            writes.push_back(write);
+        }
+        for (uint32_t level = 0; level < m_hiz_levels; level++)
+        {
+            vk::WriteDescriptorSet write;
+            write.setDstSet(m_hiz_sets.at(level));
+            write.setDescriptorCount(1);
+            if (level > 0)
+            {
+                image_infos.push_back(vk::DescriptorImageInfo(m_sampler, m_hiz_level_views.at(level - 1), vk::ImageLayout::eGeneral));
+                write.setDstBinding(0);
+                write.setDescriptorType(vk::DescriptorType::eCombinedImageSampler);
+                write.setPImageInfo(&image_infos.back());
+                writes.push_back(write);
+            }
+            image_infos.push_back(vk::DescriptorImageInfo(nullptr, m_hiz_level_views.at(level), vk::ImageLayout::eGeneral));
+            write.setDstBinding(1);
+            write.setDescriptorType(vk::DescriptorType::eStorageImage);
+            write.setPImageInfo(&image_infos.back());
+            writes.push_back(write);
+        }
+        m_device.updateDescriptorSets(writes, nullptr);
+
+        vk::PipelineLayoutCreateInfo layout_info;
+        layout_info.setSetLayoutCount(1);
+        layout_info.setPSetLayouts(&m_cull_set_layout);
+        auto layout_result = m_device.createPipelineLayout(layout_info);
+        if (layout_result.result != vk::Result::eSuccess)
+            return layout_result.result;
+        m_cull_pipeline_layout = layout_result.value;
+
+        vk::PushConstantRange push_constant(vk::ShaderStageFlagBits::eCompute, 0, sizeof(int32_t) * 4);
+        layout_info.setPSetLayouts(&m_hiz_set_layout);
+        layout_info.setPushConstantRangeCount(1);
+        layout_info.setPPushConstantRanges(&push_constant);
+        layout_result = m_device.createPipelineLayout(layout_info);
+        if (layout_result.result != vk::Result::eSuccess)
+            return layout_result.result;
+        m_hiz_pipeline_layout = layout_result.value;
+
+        auto pipeline_result = create_pipeline(m_config.m_cull_code, m_config.m_cull_code_size, m_cull_pipeline_layout);
+        if (pipeline_result.result != vk::Result::eSuccess)
+            return pipeline_result.result;
+        m_cull_pipeline = pipeline_result.value;
+
+        // 没有提供hiz.comp时只做视锥体剔除
+        if (m_config.m_hiz_code != nullptr)
+        {
+            pipeline_result = create_pipeline(m_config.m_hiz_code, m_config.m_hiz_code_size, m_hiz_pipeline_layout);
+            if (pipeline_result.result != vk::Result::eSuccess)
+                return pipeline_result.result;
+            m_hiz_pipeline = pipeline_result.value;
+        }
+
+        return vk::Result::eSuccess;
+    }
+
+    vk::ResultValue<vk::Pipeline>
+    GpuCuller::create_pipeline(
+        const uint32_t *code,
+        size_t size,
+        const vk::PipelineLayout &layout)
+    {
+        auto module_result = DeviceUtils::create_shader_module(m_device, code, size);
+        if (module_result.result != vk::Result::eSuccess)
+            return vk::ResultValue<vk::Pipeline>(module_result.result, vk::Pipeline(nullptr));
+
+        vk::PipelineShaderStageCreateInfo stage_info;
+        stage_info.setStage(vk::ShaderStageFlagBits::eCompute);
+        stage_info.setModule(module_result.value);
+        stage_info.setPName("main");
+
+        vk::ComputePipelineCreateInfo pipeline_info;
+        pipeline_info.setStage(stage_info);
+        pipeline_info.setLayout(layout);
+        auto pipeline_result = m_device.createComputePipeline(nullptr, pipeline_info);
+
+        m_device.destroyShaderModule(module_result.value);
+        return pipeline_result;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,216 @@
+#ifndef __VL_GPUCULLER_HPP__
+#define __VL_GPUCULLER_HPP__
+
+#include <vector>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "DefaultQueueFamilyIndices.hpp"
+#include "FrustumUtils.hpp"
+#include "MappedBuffer.hpp"
+
+namespace vl
+{
+    /// @brief 用计算着色器做视锥体和Hi-Z剔除，可见物体压缩为间接绘制命令
+    /// @details 剔除在DefaultQueueFamilyIndices选出的计算队列系列上进行，
+    /// 输出的缓冲在计算和图形系列不同时以并发模式共享，深度图像也需要如此
+    class GpuCuller : public ntl::Object
+    {
+    public:
+        using SelfType = GpuCuller;
+        using ParentType = ntl::Object;
+
+        /// @brief 每个物体的输入，与cull.comp中的CullObject相同
+        struct Object
+        {
+            /// @brief 世界空间的包围球(x, y, z, 半径)
+            float m_sphere[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+            /// @brief 索引数量
+            uint32_t m_index_count = 0;
+
+            /// @brief 第一个索引
+            uint32_t m_first_index = 0;
+
+            /// @brief 顶点偏移
+            int32_t m_vertex_offset = 0;
+
+            uint32_t m_reserved = 0;
+        };
+
+        /// @brief 与cull.comp中的CullUniforms相同，std140布局
+        struct Uniforms
+        {
+            float m_view_projection[16];
+            float m_planes[FrustumUtils::PLANE_COUNT * 4];
+            uint32_t m_object_count;
+            uint32_t m_hiz_levels;
+            float m_hiz_width;
+            float m_hiz_height;
+        };
+
+        /// @brief 创建参数
+        struct Config
+        {
+            /// @brief 最多物体数
+            uint32_t m_max_objects = 0;
+
+            /// @brief cull.comp的SPIR-V
+            const uint32_t *m_cull_code = nullptr;
+            size_t m_cull_code_size = 0;
+
+            /// @brief hiz.comp的SPIR-V
+            const uint32_t *m_hiz_code = nullptr;
+            size_t m_hiz_code_size = 0;
+
+            /// @brief Hi-Z金字塔第0层的大小，与深度图像相同
+            uint32_t m_hiz_width = 1;
+            uint32_t m_hiz_height = 1;
+
+            /// @brief 是否启用了VK_KHR_draw_indirect_count
+            bool m_is_draw_indirect_count_enabled = false;
+
+            /// @brief 是否启用了multiDrawIndirect特性
+            bool m_is_multi_draw_indirect_enabled = false;
+        };
+
+        static constexpr uint32_t WORKGROUP_SIZE = 64;
+        static constexpr uint32_t HIZ_WORKGROUP_SIZE = 8;
+
+    public:
+        /// @brief 物体缓冲，主机写入后需要刷新
+        MappedBuffer m_object_buffer;
+
+        /// @brief VkDrawIndexedIndirectCommand数组
+        vk::Buffer m_draw_buffer;
+
+        /// @brief 可见物体数
+        vk::Buffer m_count_buffer;
+
+        /// @brief Hi-Z金字塔，R32_SFLOAT，始终处于eGeneral布局
+        vk::Image m_hiz_image;
+
+        /// @brief 金字塔层数
+        uint32_t m_hiz_levels = 0;
+
+    protected:
+        vk::Device m_device;
+        Config m_config;
+
+        vk::DeviceMemory m_draw_memory;
+        vk::DeviceMemory m_count_memory;
+        vk::Buffer m_uniform_buffer;
+        vk::DeviceMemory m_uniform_memory;
+
+        vk::DeviceMemory m_hiz_memory;
+        vk::ImageView m_hiz_view;
+        std::vector<vk::ImageView> m_hiz_level_views;
+        vk::Sampler m_sampler;
+
+        vk::DescriptorSetLayout m_cull_set_layout;
+        vk::DescriptorSetLayout m_hiz_set_layout;
+        vk::DescriptorPool m_descriptor_pool;
+        vk::DescriptorSet m_cull_set;
+        std::vector<vk::DescriptorSet> m_hiz_sets;
+        vk::PipelineLayout m_cull_pipeline_layout;
+        vk::PipelineLayout m_hiz_pipeline_layout;
+        vk::Pipeline m_cull_pipeline;
+        vk::Pipeline m_hiz_pipeline;
+
+        /// @brief 通过vkGetDeviceProcAddr取得，未启用拓展时为空
+        PFN_vkCmdDrawIndexedIndirectCountKHR m_draw_indexed_indirect_count = nullptr;
+
+        /// @brief 金字塔是否已从未定义布局转换过
+        bool m_is_hiz_initialized = false;
+
+        /// @brief 是否已设置深度图像
+        bool m_has_depth = false;
+
+        /// @brief 计算和图形系列是否不同
+        bool m_is_family_shared = false;
+
+    public:
+        GpuCuller() = default;
+        ~GpuCuller() override = default;
+
+        GpuCuller(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 创建缓冲、金字塔和计算管线
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param indices 队列系列索引，剔除在计算系列上，绘制在图形系列上
+        /// @param config 创建参数
+        /// @return 结果
+        vk::Result create(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            const DefaultQueueFamilyIndices &indices,
+            const Config &config);
+
+        /// @brief 销毁，调用前需要保证设备已空闲
+        void destroy();
+
+        /// @brief 获取映射的物体数组
+        /// @return 物体数组
+        Object *get_objects() const noexcept;
+
+        /// @brief 设置生成金字塔使用的深度图像，不能在使用中的命令缓冲执行期间调用
+        /// @details 深度图像需要带有eSampled用途，例如上一帧prepare_depth创建的深度图像。
+        /// 深度在图形系列上写入、在计算系列上读取，两个系列不同时深度图像需要以并发模式
+        /// 在两个系列间共享，独占模式需要的所有权转移不由剔除器记录
+        /// @param depth_view 深度图像视图，只包含深度方面
+        /// @param depth_sharing_mode 深度图像创建时的共享模式
+        /// @param depth_layout 生成金字塔时深度图像所处的布局
+        /// @return 是否成功，系列不同而深度图像为独占模式时失败
+        bool set_depth(
+            const vk::ImageView &depth_view,
+            vk::SharingMode depth_sharing_mode,
+            vk::ImageLayout depth_layout = vk::ImageLayout::eDepthStencilReadOnlyOptimal);
+
+        /// @brief 从深度图像生成Hi-Z金字塔，深度写入需要已对计算着色器可见，
+        /// 系列不同时由信号量保证图形队列的写入在计算队列读取之前完成
+        /// @param command_buffer 计算系列的命令缓冲
+        void record_hiz(const vk::CommandBuffer &command_buffer);
+
+        /// @brief 记录剔除
+        /// @param command_buffer 计算系列的命令缓冲
+        /// @param view_projection 列主序的投影乘观察矩阵
+        /// @param object_count 物体数
+        /// @param is_hiz_enabled 是否使用金字塔做遮挡剔除，需要之前记录过record_hiz
+        void record_cull(
+            const vk::CommandBuffer &command_buffer,
+            const float view_projection[16],
+            uint32_t object_count,
+            bool is_hiz_enabled);
+
+        /// @brief 记录间接绘制，没有VK_KHR_draw_indirect_count时绘制max_draw_count个命令，多余的实例数为0
+        /// @param command_buffer 图形系列的命令缓冲，已绑定管线、顶点和索引缓冲
+        /// @param max_draw_count 最多绘制的命令数
+        void record_draw(const vk::CommandBuffer &command_buffer, uint32_t max_draw_count);
+
+    protected:
+        /// @brief 创建设备本地的缓冲
+        vk::Result create_buffer(
+            const vk::PhysicalDevice &physical_device,
+            vk::DeviceSize size,
+            vk::BufferUsageFlags usage,
+            const std::vector<uint32_t> &queue_families,
+            vk::Buffer &buffer,
+            vk::DeviceMemory &memory);
+
+        /// @brief 创建金字塔图像和视图
+        vk::Result create_hiz(const vk::PhysicalDevice &physical_device);
+
+        /// @brief 创建描述符和计算管线
+        vk::Result create_pipelines();
+
+        /// @brief 创建计算管线
+        vk::ResultValue<vk::Pipeline> create_pipeline(
+            const uint32_t *code,
+            size_t size,
+            const vk::PipelineLayout &layout);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,280 @@
+#ifndef __VL_HEADLESSCONTEXT_CPP__
+#define __VL_HEADLESSCONTEXT_CPP__
+
+#include <set>
+#include "HeadlessContext.hpp"
+#include "PhysicalDeviceUtils.hpp"
+
+namespace vl
+{
+    vk::Result
+    HeadlessContext::create(
+        const Config &config)
+    {
+        // 应用信息
+        vk::ApplicationInfo app_info;
+        app_info.setPApplicationName(config.m_name.c_str());
+        app_info.setApplicationVersion(VK_MAKE_VERSION(1, 0, 0));
+        app_info.setPEngineName("No Engine");
+        app_info.setEngineVersion(VK_MAKE_VERSION(1, 0, 0));
+        app_info.setApiVersion(VK_API_VERSION_1_0);
+
+        // 不需要表面相关的拓展
+        std::vector<const char *> layers;
+        for (auto iter = config.m_validation_layers.cbegin(); iter != config.m_validation_layers.cend(); iter++)
+            layers.push_back(iter->c_str());
+
+        vk::InstanceCreateInfo instance_info;
+        instance_info.setPApplicationInfo(&app_info);
+        instance_info.enabledLayerCount = static_cast<uint32_t>(layers.size());
+        instance_info.ppEnabledLayerNames = layers.data();
+
+        auto instance_result = vk::createInstance(instance_info);
+        if (instance_result.result != vk::Result::eSuccess)
+        {
+            ntl::log.loge(
+                NTL_STRING("HeadlessContext::create"),
+                ntl::StringUtils::to_string(
+                    NTL_STRING("Failed to create instance, error code:"),
+                    static_cast<long>(instance_result.result)));
+            return instance_result.result;
+        }
+        m_instance = instance_result.value;
+
+        // 选择物理设备，名称匹配的优先
+        std::vector<VkPhysicalDevice> devices = PhysicalDeviceUtils::get_physical_devices(m_instance);
+        for (auto iter = devices.cbegin(); iter != devices.cend(); iter++)
+        {
+            vk::PhysicalDevice device = vk::PhysicalDevice(*iter);
+            DefaultQueueFamilyIndices indices;
+            if (!check_queue_families(PhysicalDeviceUtils::get_physical_device_queue_family_properties(device), indices))
+                continue;
+            if (config.m_need_sparse_binding && !indices.m_sparse_binding_family.has_value())
+                continue;
+
+            std::string name = device.getProperties().deviceName.data();
+            bool is_preferred = !config.m_device_name.empty() && name.find(config.m_device_name) != std::string::npos;
+            if (!m_physical_device || is_preferred)
+            {
+                m_physical_device = device;
+                m_queue_family_indices = indices;
+            }
+            if (is_preferred)
+                break;
+        }
+        if (!m_physical_device)
+        {
+            ntl::log.loge(
+                NTL_STRING("HeadlessContext::create"),
+                NTL_STRING("Unable to find a suitable physical device"));
+            destroy();
+            return vk::Result::eErrorInitializationFailed;
+        }
+
+        m_properties = m_physical_device.getProperties();
+        m_features = intersect_features(config.m_features, m_physical_device.getFeatures());
+
+        // 每个不同的队列系列创建一个队列
+        std::set<uint32_t> families = {
+            *m_queue_family_indices.m_graphics_family,
+            *m_queue_family_indices.m_compute_family,
+        };
+        if (m_queue_family_indices.m_sparse_binding_family.has_value())
+            families.insert(*m_queue_family_indices.m_sparse_binding_family);
+
+        // 只启用支持的拓展
+        std::vector<const char *> extensions;
+        auto extension_result = m_physical_device.enumerateDeviceExtensionProperties();
+        if (extension_result.result == vk::Result::eSuccess)
+            for (auto iter = config.m_device_extensions.cbegin(); iter != config.m_device_extensions.cend(); iter++)
+                for (auto property = extension_result.value.cbegin(); property != extension_result.value.cend(); property++)
+                    if (*iter == property->extensionName.data())
+                    {
+                        m_device_extensions.push_back(*iter);
+                        break;
+                    }
+        for (auto iter = m_device_extensions.cbegin(); iter != m_device_extensions.cend(); iter++)
+            extensions.push_back(iter->c_str());
+
+        float priority = 1.0f;
+        std::vector<vk::DeviceQueueCreateInfo> queue_infos;
+        for (auto iter = families.cbegin(); iter != families.cend(); iter++)
+        {
+            vk::DeviceQueueCreateInfo queue_info;
+            queue_info.setQueueFamilyIndex(*iter);
+            queue_info.setQueueCount(1);
+            queue_info.setPQueuePriorities(&priority);
+            queue_infos.push_back(queue_info);
+        }
+
+        vk::DeviceCreateInfo device_info;
+        device_info.setQueueCreateInfoCount(static_cast<uint32_t>(queue_infos.size()));
+        device_info.setPQueueCreateInfos(queue_infos.data());
+        device_info.setPEnabledFeatures(&m_features);
+        device_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        device_info.ppEnabledExtensionNames = extensions.data();
+
+        auto device_result = m_physical_device.createDevice(device_info);
+        if (device_result.result != vk::Result::eSuccess)
+        {
+            ntl::log.loge(
+                NTL_STRING("HeadlessContext::create"),
+                ntl::StringUtils::to_string(
+                    NTL_STRING("Failed to create device, error code:"),
+                    static_cast<long>(device_result.result)));
+            destroy();
+            return device_result.result;
+        }
+        m_device = device_result.value;
+
+        m_graphics_queue = m_device.getQueue(*m_queue_family_indices.m_graphics_family, 0);
+        m_compute_queue = m_device.getQueue(*m_queue_family_indices.m_compute_family, 0);
+        if (m_queue_family_indices.m_sparse_binding_family.has_value())
+            m_sparse_binding_queue = m_device.getQueue(*m_queue_family_indices.m_sparse_binding_family, 0);
+
+        vk::CommandPoolCreateInfo pool_info;
+        pool_info.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+        pool_info.setQueueFamilyIndex(*m_queue_family_indices.m_graphics_family);
+        auto pool_result = m_device.createCommandPool(pool_info);
+        if (pool_result.result != vk::Result::eSuccess)
+        {
+            destroy();
+            return pool_result.result;
+        }
+        m_command_pool = pool_result.value;
+
+        pool_info.setQueueFamilyIndex(*m_queue_family_indices.m_compute_family);
+        pool_result = m_device.createCommandPool(pool_info);
+        if (pool_result.result != vk::Result::eSuccess)
+        {
+            destroy();
+            return pool_result.result;
+        }
+        m_compute_command_pool = pool_result.value;
+
+        return vk::Result::eSuccess;
+    }
+
+    void
+    HeadlessContext::destroy()
+    {
+        if (m_device)
+        {
+            m_device.waitIdle();
+            if (m_command_pool)
+                m_device.destroyCommandPool(m_command_pool);
+            if (m_compute_command_pool)
+                m_device.destroyCommandPool(m_compute_command_pool);
+            m_device.destroy();
+        }
+        if (m_instance)
+            m_instance.destroy();
+
+        m_command_pool = nullptr;
+        m_compute_command_pool = nullptr;
+        m_device = nullptr;
+        m_physical_device = nullptr;
+        m_instance = nullptr;
+        m_graphics_queue = nullptr;
+        m_compute_queue = nullptr;
+        m_sparse_binding_queue = nullptr;
+        m_queue_family_indices = DefaultQueueFamilyIndices();
+        m_device_extensions.clear();
+    }
+
+    vk::ResultValue<vk::CommandBuffer>
+    HeadlessContext::begin_one_time(
+        bool is_compute)
+    {
+        vk::CommandPool pool = is_compute ? m_compute_command_pool : m_command_pool;
+        vk::CommandBufferAllocateInfo allocate_info;
+        allocate_info.setCommandPool(pool);
+        allocate_info.setLevel(vk::CommandBufferLevel::ePrimary);
+        allocate_info.setCommandBufferCount(1);
+        auto command_result = m_device.allocateCommandBuffers(allocate_info);
+        if (command_result.result != vk::Result::eSuccess)
+            return vk::ResultValue<vk::CommandBuffer>(command_result.result, vk::CommandBuffer(nullptr));
+
+        vk::CommandBuffer command_buffer = command_result.value.at(0);
+        vk::CommandBufferBeginInfo begin_info;
+        begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        vk::Result result = command_buffer.begin(begin_info);
+        if (result != vk::Result::eSuccess)
+        {
+            m_device.freeCommandBuffers(pool, command_buffer);
+            return vk::ResultValue<vk::CommandBuffer>(result, vk::CommandBuffer(nullptr));
+        }
+
+        return vk::ResultValue<vk::CommandBuffer>(vk::Result::eSuccess, command_buffer);
+    }
+
+    vk::Result
+    HeadlessContext::end_one_time(
+        const vk::CommandBuffer &command_buffer,
+        bool is_compute)
+    {
+        vk::Result result = command_buffer.end();
+        if (result == vk::Result::eSuccess)
+        {
+            auto fence_result = m_device.createFence(vk::FenceCreateInfo());
+            result = fence_result.result;
+            if (result == vk::Result::eSuccess)
+            {
+                vk::SubmitInfo submit_info;
+                submit_info.setCommandBufferCount(1);
+                submit_info.setPCommandBuffers(&command_buffer);
+                vk::Queue queue = is_compute ? m_compute_queue : m_graphics_queue;
+                result = queue.submit(submit_info, fence_result.value);
+                if (result == vk::Result::eSuccess)
+                    result = m_device.waitForFences(fence_result.value, VK_TRUE, UINT64_MAX);
+                m_device.destroyFence(fence_result.value);
+            }
+        }
+
+        m_device.freeCommandBuffers(is_compute ? m_compute_command_pool : m_command_pool, command_buffer);
+        return result;
+    }
+
+    std::string
+    HeadlessContext::get_device_name() const
+    {
+        return m_properties.deviceName.data();
+    }
+
+    bool
+    HeadlessContext::is_extension_enabled(
+        const std::string &name) const
+    {
+        for (auto iter = m_device_extensions.cbegin(); iter != m_device_extensions.cend(); iter++)
+            if (*iter == name)
+                return true;
+        return false;
+    }
+
+    bool
+    HeadlessContext::check_queue_families(
+        const std::vector<VkQueueFamilyProperties> &families,
+        DefaultQueueFamilyIndices &result)
+    {
+        // DefaultQueueFamilyIndices::find要求稀少绑定队列，软件实现通常没有，这里只看图形和计算
+        result.find(families);
+        return result.m_graphics_family.has_value() &&
+               result.m_compute_family.has_value();
+    }
+
+    vk::PhysicalDeviceFeatures
+    HeadlessContext::intersect_features(
+        const vk::PhysicalDeviceFeatures &requested,
+        const vk::PhysicalDeviceFeatures &supported)
+    {
+        // 特性结构全部由VkBool32组成
+        vk::PhysicalDeviceFeatures result = requested;
+        VkBool32 *output = reinterpret_cast<VkBool32 *>(&result);
+        const VkBool32 *available = reinterpret_cast<const VkBool32 *>(&supported);
+        for (size_t i = 0; i < sizeof(vk::PhysicalDeviceFeatures) / sizeof(VkBool32); i++)
+            output[i] = output[i] && available[i];
+        return result;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
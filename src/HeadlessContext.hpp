@@ -0,0 +1,133 @@
+#ifndef __VL_HEADLESSCONTEXT_HPP__
+#define __VL_HEADLESSCONTEXT_HPP__
+
+#include <string>
+#include <vector>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "DefaultQueueFamilyIndices.hpp"
+
+namespace vl
+{
+    /// @brief 无窗口的Vulkan上下文，用于基准测试和在lavapipe等软件实现上验证
+    class HeadlessContext : public ntl::Object
+    {
+    public:
+        using SelfType = HeadlessContext;
+        using ParentType = ntl::Object;
+
+        /// @brief 创建参数
+        struct Config
+        {
+            /// @brief 程序名
+            std::string m_name = "headless";
+
+            /// @brief 验证层
+            std::vector<std::string> m_validation_layers;
+
+            /// @brief 优先选择名称包含此字符串的物理设备，例如"llvmpipe"，为空时选择第一个合适的设备
+            std::string m_device_name;
+
+            /// @brief 希望启用的特性，只启用设备支持的部分
+            vk::PhysicalDeviceFeatures m_features;
+
+            /// @brief 希望启用的设备拓展，只启用设备支持的部分
+            std::vector<std::string> m_device_extensions;
+
+            /// @brief 是否必须有稀少绑定队列
+            bool m_need_sparse_binding = false;
+        };
+
+    public:
+        /// @brief 实例
+        vk::Instance m_instance;
+
+        /// @brief 物理设备
+        vk::PhysicalDevice m_physical_device;
+
+        /// @brief 逻辑设备
+        vk::Device m_device;
+
+        /// @brief 队列系列索引
+        DefaultQueueFamilyIndices m_queue_family_indices;
+
+        /// @brief 图形队列
+        vk::Queue m_graphics_queue;
+
+        /// @brief 计算队列
+        vk::Queue m_compute_queue;
+
+        /// @brief 稀少绑定队列，没有时为空
+        vk::Queue m_sparse_binding_queue;
+
+        /// @brief 图形队列的命令池
+        vk::CommandPool m_command_pool;
+
+        /// @brief 计算队列的命令池
+        vk::CommandPool m_compute_command_pool;
+
+        /// @brief 物理设备属性
+        vk::PhysicalDeviceProperties m_properties;
+
+        /// @brief 实际启用的特性
+        vk::PhysicalDeviceFeatures m_features;
+
+        /// @brief 实际启用的设备拓展
+        std::vector<std::string> m_device_extensions;
+
+    public:
+        HeadlessContext() = default;
+        ~HeadlessContext() override = default;
+
+        HeadlessContext(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 创建实例、选择物理设备并创建逻辑设备
+        /// @param config 创建参数
+        /// @return 结果
+        vk::Result create(const Config &config);
+
+        /// @brief 销毁
+        void destroy();
+
+        /// @brief 分配并开始一个一次性命令缓冲
+        /// @param is_compute 是否从计算队列的命令池分配
+        /// @return 结果
+        vk::ResultValue<vk::CommandBuffer> begin_one_time(bool is_compute = false);
+
+        /// @brief 结束命令缓冲，提交并等待完成，然后释放
+        /// @param command_buffer 命令缓冲
+        /// @param is_compute 是否提交到计算队列，需要与分配时一致
+        /// @return 结果
+        vk::Result end_one_time(const vk::CommandBuffer &command_buffer, bool is_compute = false);
+
+        /// @brief 设备拓展是否已启用
+        /// @param name 拓展名
+        /// @return 是否启用
+        bool is_extension_enabled(const std::string &name) const;
+
+        /// @brief 设备名
+        /// @return 名称
+        std::string get_device_name() const;
+
+    public:
+        /// @brief 检查队列系列：需要图形和计算队列，不要求稀少绑定
+        /// @param families 队列系列属性
+        /// @param result 队列系列索引
+        /// @return 是否合适
+        static bool check_queue_families(
+            const std::vector<VkQueueFamilyProperties> &families,
+            DefaultQueueFamilyIndices &result);
+
+        /// @brief 取两组特性的交集
+        /// @param requested 希望启用的特性
+        /// @param supported 支持的特性
+        /// @return 交集
+        static vk::PhysicalDeviceFeatures intersect_features(
+            const vk::PhysicalDeviceFeatures &requested,
+            const vk::PhysicalDeviceFeatures &supported);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,489 @@
+#ifndef __VL_IMAGEENCODER_CPP__
+#define __VL_IMAGEENCODER_CPP__
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include "ImageEncoder.hpp"
+#include "Deflate.hpp"
+#include "Simd.hpp"
+
+namespace vl
+{
+    bool
+    ImageEncoder::encode(
+        Format format,
+        const Image &image,
+        std::vector<uint8_t> &output)
+    {
+        switch (format)
+        {
+        case Format::ePpm:
+            return encode_ppm(image, output);
+        case Format::eQoi:
+            return encode_qoi(image, output);
+        case Format::ePng:
+            return encode_png(image, output);
+        default:
+            return false;
+        }
+    }
+
+    bool
+    ImageEncoder::encode_ppm(
+        const Image &image,
+        std::vector<uint8_t> &output)
+    {
+        if (!is_valid(image))
+            return false;
+
+        char header[64];
+        int header_size = std::snprintf(header, sizeof(header), "P6\n%u %u\n255\n", image.m_width, image.m_height);
+
+        size_t row_size = static_cast<size_t>(image.m_width) * 3;
+        size_t offset = output.size();
+        output.resize(offset + header_size + row_size * image.m_height);
+        std::memcpy(output.data() + offset, header, header_size);
+        offset += header_size;
+
+        for (uint32_t y = 0; y < image.m_height; y++)
+        {
+            convert_row_to_rgb(
+                image.m_pixels + static_cast<size_t>(y) * image.m_row_pitch,
+                output.data() + offset,
+                image.m_width,
+                image.m_layout);
+            offset += row_size;
+        }
+
+        return true;
+    }
+
+    bool
+    ImageEncoder::encode_qoi(
+        const Image &image,
+        std::vector<uint8_t> &output)
+    {
+        if (!is_valid(image))
+            return false;
+
+        auto put32 = [&output](uint32_t value)
+        {
+            output.push_back(static_cast<uint8_t>(value >> 24));
+            output.push_back(static_cast<uint8_t>(value >> 16));
+            output.push_back(static_cast<uint8_t>(value >> 8));
+            output.push_back(static_cast<uint8_t>(value));
+        };
+
+        output.reserve(output.size() + 14 + static_cast<size_t>(image.m_width) * image.m_height * 5 / 2 + 8);
+        output.push_back('q');
+        output.push_back('o');
+        output.push_back('i');
+        output.push_back('f');
+        put32(image.m_width);
+        put32(image.m_height);
+        output.push_back(4);
+        output.push_back(0);
+
+        uint8_t index[64][4] = {};
+        uint8_t previous[4] = {0, 0, 0, 255};
+        uint32_t run = 0;
+        std::vector<uint8_t> row(static_cast<size_t>(image.m_width) * 4);
+        size_t pixel_count = static_cast<size_t>(image.m_width) * image.m_height;
+        size_t pixel_index = 0;
+
+        for (uint32_t y = 0; y < image.m_height; y++)
+        {
+            convert_row_to_rgba(image.m_pixels + static_cast<size_t>(y) * image.m_row_pitch, row.data(), image.m_width, image.m_layout);
+
+            for (uint32_t x = 0; x < image.m_width; x++, pixel_index++)
+            {
+                const uint8_t *pixel = row.data() + static_cast<size_t>(x) * 4;
+
+                if (std::memcmp(pixel, previous, 4) == 0)
+                {
+                    run++;
+                    if (run == 62 || pixel_index + 1 == pixel_count)
+                    {
+                        output.push_back(static_cast<uint8_t>(0xc0 | (run - 1)));
+                        run = 0;
+                    }
+                    continue;
+                }
+
+                if (run > 0)
+                {
+                    output.push_back(static_cast<uint8_t>(0xc0 | (run - 1)));
+                    run = 0;
+                }
+
+                uint32_t hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+                if (std::memcmp(index[hash], pixel, 4) == 0)
+                    output.push_back(static_cast<uint8_t>(hash));
+                else
+                {
+                    std::memcpy(index[hash], pixel, 4);
+
+                    if (pixel[3] == previous[3])
+                    {
+                        int8_t dr = static_cast<int8_t>(pixel[0] - previous[0]);
+                        int8_t dg = static_cast<int8_t>(pixel[1] - previous[1]);
+                        int8_t db = static_cast<int8_t>(pixel[2] - previous[2]);
+                        int8_t dr_dg = static_cast<int8_t>(dr - dg);
+                        int8_t db_dg = static_cast<int8_t>(db - dg);
+
+                        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                            output.push_back(static_cast<uint8_t>(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                        else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7)
+                        {
+                            output.push_back(static_cast<uint8_t>(0x80 | (dg + 32)));
+                            output.push_back(static_cast<uint8_t>((dr_dg + 8) << 4 | (db_dg + 8)));
+                        }
+                        else
+                        {
+                            output.push_back(0xfe);
+                            output.insert(output.end(), pixel, pixel + 3);
+                        }
+                    }
+                    else
+                    {
+                        output.push_back(0xff);
+                        output.insert(output.end(), pixel, pixel + 4);
+                    }
+                }
+
+                std::memcpy(previous, pixel, 4);
+            }
+        }
+
+        const uint8_t padding[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+        output.insert(output.end(), padding, padding + 8);
+
+        return true;
+    }
+
+    bool
+    ImageEncoder::encode_png(
+        const Image &image,
+        std::vector<uint8_t> &output)
+    {
+        if (!is_valid(image))
+            return false;
+
+        const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        output.insert(output.end(), signature, signature + 8);
+
+        // IHDR: 8位RGBA，不隔行
+        uint8_t header[13] = {
+            static_cast<uint8_t>(image.m_width >> 24), static_cast<uint8_t>(image.m_width >> 16),
+            static_cast<uint8_t>(image.m_width >> 8), static_cast<uint8_t>(image.m_width),
+            static_cast<uint8_t>(image.m_height >> 24), static_cast<uint8_t>(image.m_height >> 16),
+            static_cast<uint8_t>(image.m_height >> 8), static_cast<uint8_t>(image.m_height),
+            8, 6, 0, 0, 0};
+        write_png_chunk(output, "IHDR", header, sizeof(header));
+
+        // 行缓冲前面留出16字节的0，滤波时左侧像素可以直接越界读取
+        size_t row_size = static_cast<size_t>(image.m_width) * 4;
+        std::vector<uint8_t> row_buffers[2];
+        row_buffers[0].assign(row_size + 32, 0);
+        row_buffers[1].assign(row_size + 32, 0);
+        uint8_t *current = row_buffers[0].data() + 16;
+        uint8_t *previous = row_buffers[1].data() + 16;
+
+        std::vector<uint8_t> filtered((row_size + 1) * image.m_height);
+        for (uint32_t y = 0; y < image.m_height; y++)
+        {
+            convert_row_to_rgba(image.m_pixels + static_cast<size_t>(y) * image.m_row_pitch, current, image.m_width, image.m_layout);
+            filter_png_row(current, previous, row_size, filtered.data() + (row_size + 1) * y);
+            std::swap(current, previous);
+        }
+
+        std::vector<uint8_t> compressed;
+        compressed.reserve(filtered.size() / 2);
+        Deflate::compress_zlib(filtered.data(), filtered.size(), compressed);
+        write_png_chunk(output, "IDAT", compressed.data(), compressed.size());
+        write_png_chunk(output, "IEND", nullptr, 0);
+
+        return true;
+    }
+
+    const char *
+    ImageEncoder::get_extension(
+        Format format) noexcept
+    {
+        switch (format)
+        {
+        case Format::ePpm:
+            return "ppm";
+        case Format::eQoi:
+            return "qoi";
+        case Format::ePng:
+            return "png";
+        default:
+            return "bin";
+        }
+    }
+
+    void
+    ImageEncoder::convert_row_to_rgba(
+        const uint8_t *source,
+        uint8_t *destination,
+        uint32_t width,
+        PixelLayout layout) noexcept
+    {
+        if (layout == PixelLayout::eRgba)
+        {
+            std::memcpy(destination, source, static_cast<size_t>(width) * 4);
+            return;
+        }
+
+        uint32_t x = 0;
+#if defined(VL_SIMD_SSSE3)
+        const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + x * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + x * 4), _mm_shuffle_epi8(pixels, shuffle));
+        }
+#elif defined(VL_SIMD_SSE2)
+        // 交换每个32位像素的第0和第2字节
+        const __m128i keep = _mm_set1_epi32(static_cast<int>(0xff00ff00u));
+        const __m128i low = _mm_set1_epi32(0xff);
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + x * 4));
+            __m128i swapped = _mm_or_si128(
+                _mm_and_si128(pixels, keep),
+                _mm_or_si128(
+                    _mm_and_si128(_mm_srli_epi32(pixels, 16), low),
+                    _mm_slli_epi32(_mm_and_si128(pixels, low), 16)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + x * 4), swapped);
+        }
+#elif defined(VL_SIMD_NEON)
+        for (; x + 16 <= width; x += 16)
+        {
+            uint8x16x4_t pixels = vld4q_u8(source + x * 4);
+            uint8x16_t red = pixels.val[2];
+            pixels.val[2] = pixels.val[0];
+            pixels.val[0] = red;
+            vst4q_u8(destination + x * 4, pixels);
+        }
+#endif
+        for (; x < width; x++)
+        {
+            destination[x * 4 + 0] = source[x * 4 + 2];
+            destination[x * 4 + 1] = source[x * 4 + 1];
+            destination[x * 4 + 2] = source[x * 4 + 0];
+            destination[x * 4 + 3] = source[x * 4 + 3];
+        }
+    }
+
+    void
+    ImageEncoder::convert_row_to_rgb(
+        const uint8_t *source,
+        uint8_t *destination,
+        uint32_t width,
+        PixelLayout layout) noexcept
+    {
+        uint32_t red = layout == PixelLayout::eRgba ? 0 : 2;
+        uint32_t blue = 2 - red;
+
+        uint32_t x = 0;
+#if defined(VL_SIMD_SSSE3)
+        // 每次写16字节但只前进12字节，剩余不足6个像素时改用标量避免越界
+        const __m128i shuffle = layout == PixelLayout::eRgba
+                                    ? _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1)
+                                    : _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        for (; x + 6 <= width; x += 4)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + x * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + x * 3), _mm_shuffle_epi8(pixels, shuffle));
+        }
+#elif defined(VL_SIMD_NEON)
+        for (; x + 16 <= width; x += 16)
+        {
+            uint8x16x4_t pixels = vld4q_u8(source + x * 4);
+            uint8x16x3_t rgb;
+            rgb.val[0] = pixels.val[red];
+            rgb.val[1] = pixels.val[1];
+            rgb.val[2] = pixels.val[blue];
+            vst3q_u8(destination + x * 3, rgb);
+        }
+#endif
+        for (; x < width; x++)
+        {
+            destination[x * 3 + 0] = source[x * 4 + red];
+            destination[x * 3 + 1] = source[x * 4 + 1];
+            destination[x * 3 + 2] = source[x * 4 + blue];
+        }
+    }
+
+    bool
+    ImageEncoder::is_valid(
+        const Image &image) noexcept
+    {
+        if (image.m_pixels == nullptr ||
+            image.m_width == 0 ||
+            image.m_height == 0 ||
+            image.m_row_pitch < image.m_width * 4)
+        {
+            ntl::log.loge(
+                NTL_STRING("ImageEncoder::is_valid"),
+                NTL_STRING("Invalid image"));
+            return false;
+        }
+        return true;
+    }
+
+    void
+    ImageEncoder::filter_png_row(
+        const uint8_t *current,
+        const uint8_t *previous,
+        size_t size,
+        uint8_t *output)
+    {
+        auto scalar_filter = [current, previous](uint32_t type, size_t i) -> uint8_t
+        {
+            int x = current[i];
+            int a = current[static_cast<std::ptrdiff_t>(i) - 4];
+            int b = previous[i];
+            int c = previous[static_cast<std::ptrdiff_t>(i) - 4];
+
+            switch (type)
+            {
+            case 1:
+                return static_cast<uint8_t>(x - a);
+            case 2:
+                return static_cast<uint8_t>(x - b);
+            case 3:
+                return static_cast<uint8_t>(x - ((a + b) >> 1));
+            case 4:
+            {
+                int pa = std::abs(b - c);
+                int pb = std::abs(a - c);
+                int pc = std::abs(a + b - 2 * c);
+                int predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+                return static_cast<uint8_t>(x - predictor);
+            }
+            default:
+                return static_cast<uint8_t>(x);
+            }
+        };
+
+        uint64_t costs[5] = {};
+        size_t i = 0;
+
+#if defined(VL_SIMD_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+
+        // 一次计算16字节的四种滤波结果
+        auto filter_vectors = [current, previous, zero](size_t index, __m128i *results)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(current + index));
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(current + index - 4));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(previous + index));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(previous + index - 4));
+
+            results[0] = x;
+            results[1] = _mm_sub_epi8(x, a);
+            results[2] = _mm_sub_epi8(x, b);
+
+            // _mm_avg_epu8向上取整，PNG需要向下取整
+            __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+            results[3] = _mm_sub_epi8(x, average);
+
+            auto paeth = [zero](__m128i a8, __m128i b8, __m128i c8) -> __m128i
+            {
+                __m128i a16 = a8;
+                __m128i b16 = b8;
+                __m128i c16 = c8;
+                __m128i bc = _mm_sub_epi16(b16, c16);
+                __m128i ac = _mm_sub_epi16(a16, c16);
+                __m128i pa = _mm_max_epi16(bc, _mm_sub_epi16(zero, bc));
+                __m128i pb = _mm_max_epi16(ac, _mm_sub_epi16(zero, ac));
+                __m128i abc = _mm_add_epi16(bc, ac);
+                __m128i pc = _mm_max_epi16(abc, _mm_sub_epi16(zero, abc));
+
+                __m128i use_a = _mm_andnot_si128(_mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc)), _mm_set1_epi16(-1));
+                __m128i use_b = _mm_andnot_si128(_mm_cmpgt_epi16(pb, pc), _mm_set1_epi16(-1));
+                __m128i b_or_c = _mm_or_si128(_mm_and_si128(use_b, b16), _mm_andnot_si128(use_b, c16));
+                return _mm_or_si128(_mm_and_si128(use_a, a16), _mm_andnot_si128(use_a, b_or_c));
+            };
+            __m128i low = paeth(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero));
+            __m128i high = paeth(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero));
+            results[4] = _mm_sub_epi8(x, _mm_packus_epi16(low, high));
+        };
+
+        __m128i sums[5] = {zero, zero, zero, zero, zero};
+        for (; i + 16 <= size; i += 16)
+        {
+            __m128i results[5];
+            filter_vectors(i, results);
+            for (int k = 0; k < 5; k++)
+            {
+                // 以有符号字节的绝对值之和作为代价
+                __m128i magnitude = _mm_min_epu8(results[k], _mm_sub_epi8(zero, results[k]));
+                sums[k] = _mm_add_epi64(sums[k], _mm_sad_epu8(magnitude, zero));
+            }
+        }
+        for (int k = 0; k < 5; k++)
+        {
+            uint64_t lanes[2];
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), sums[k]);
+            costs[k] = lanes[0] + lanes[1];
+        }
+#endif
+        for (size_t j = i; j < size; j++)
+        {
+            for (uint32_t k = 0; k < 5; k++)
+            {
+                int8_t value = static_cast<int8_t>(scalar_filter(k, j));
+                costs[k] += static_cast<uint64_t>(value < 0 ? -value : value);
+            }
+        }
+
+        uint32_t best = 0;
+        for (uint32_t k = 1; k < 5; k++)
+            if (costs[k] < costs[best])
+                best = k;
+
+        output[0] = static_cast<uint8_t>(best);
+        i = 0;
+#if defined(VL_SIMD_SSE2)
+        for (; i + 16 <= size; i += 16)
+        {
+            __m128i results[5];
+            filter_vectors(i, results);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 1 + i), results[best]);
+        }
+#endif
+        for (; i < size; i++)
+            output[1 + i] = scalar_filter(best, i);
+    }
+
+    void
+    ImageEncoder::write_png_chunk(
+        std::vector<uint8_t> &output,
+        const char *type,
+        const uint8_t *data,
+        size_t size)
+    {
+        output.push_back(static_cast<uint8_t>(size >> 24));
+        output.push_back(static_cast<uint8_t>(size >> 16));
+        output.push_back(static_cast<uint8_t>(size >> 8));
+        output.push_back(static_cast<uint8_t>(size));
+
+        size_t begin = output.size();
+        output.insert(output.end(), type, type + 4);
+        if (size != 0)
+            output.insert(output.end(), data, data + size);
+
+        uint32_t crc = Deflate::crc32(0, output.data() + begin, output.size() - begin);
+        output.push_back(static_cast<uint8_t>(crc >> 24));
+        output.push_back(static_cast<uint8_t>(crc >> 16));
+        output.push_back(static_cast<uint8_t>(crc >> 8));
+        output.push_back(static_cast<uint8_t>(crc));
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,120 @@
+#ifndef __VL_IMAGEENCODER_HPP__
+#define __VL_IMAGEENCODER_HPP__
+
+#include <vector>
+#include <cstdint>
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 图像编码工具，把8位RGBA/BGRA像素写为PPM、QOI或PNG
+    class ImageEncoder : public ntl::Object
+    {
+    public:
+        using SelfType = ImageEncoder;
+        using ParentType = ntl::Object;
+
+        /// @brief 文件格式
+        enum class Format
+        {
+            ePpm,
+            eQoi,
+            ePng,
+        };
+
+        /// @brief 像素的通道顺序
+        enum class PixelLayout
+        {
+            eRgba,
+            eBgra,
+        };
+
+        /// @brief 输入图像，不持有像素
+        struct Image
+        {
+            const uint8_t *m_pixels = nullptr;
+            uint32_t m_width = 0;
+            uint32_t m_height = 0;
+
+            /// @brief 每行字节数
+            uint32_t m_row_pitch = 0;
+
+            PixelLayout m_layout = PixelLayout::eRgba;
+        };
+
+    public:
+        constexpr ImageEncoder() noexcept = default;
+        constexpr explicit ImageEncoder(const SelfType &from) noexcept = default;
+        ~ImageEncoder() override = default;
+
+    public:
+        constexpr SelfType &operator=(const SelfType &from) noexcept = default;
+
+    public:
+        /// @brief 按格式编码
+        /// @param format 格式
+        /// @param image 图像
+        /// @param output 输出
+        /// @return 是否成功
+        static bool encode(Format format, const Image &image, std::vector<uint8_t> &output);
+
+        /// @brief 编码为二进制PPM(P6)
+        /// @param image 图像
+        /// @param output 输出
+        /// @return 是否成功
+        static bool encode_ppm(const Image &image, std::vector<uint8_t> &output);
+
+        /// @brief 编码为QOI
+        /// @param image 图像
+        /// @param output 输出
+        /// @return 是否成功
+        static bool encode_qoi(const Image &image, std::vector<uint8_t> &output);
+
+        /// @brief 编码为RGBA PNG
+        /// @param image 图像
+        /// @param output 输出
+        /// @return 是否成功
+        static bool encode_png(const Image &image, std::vector<uint8_t> &output);
+
+        /// @brief 获取格式的扩展名
+        /// @param format 格式
+        /// @return 扩展名，不含点
+        static const char *get_extension(Format format) noexcept;
+
+        /// @brief 把一行像素转换为RGBA
+        /// @param source 源像素
+        /// @param destination 目标
+        /// @param width 像素数
+        /// @param layout 源的通道顺序
+        static void convert_row_to_rgba(const uint8_t *source, uint8_t *destination, uint32_t width, PixelLayout layout) noexcept;
+
+        /// @brief 把一行像素转换为RGB，丢弃透明通道
+        /// @param source 源像素
+        /// @param destination 目标
+        /// @param width 像素数
+        /// @param layout 源的通道顺序
+        static void convert_row_to_rgb(const uint8_t *source, uint8_t *destination, uint32_t width, PixelLayout layout) noexcept;
+
+    protected:
+        /// @brief 检查图像参数
+        /// @param image 图像
+        /// @return 是否有效
+        static bool is_valid(const Image &image) noexcept;
+
+        /// @brief 对一行做PNG滤波，按绝对值和最小的启发式选择滤波器
+        /// @param current 当前行，前面需要有4字节的0
+        /// @param previous 上一行，前面需要有4字节的0
+        /// @param size 行的字节数
+        /// @param output 输出，第一个字节为滤波器类型
+        static void filter_png_row(const uint8_t *current, const uint8_t *previous, size_t size, uint8_t *output);
+
+        /// @brief 写出PNG块
+        /// @param output 输出
+        /// @param type 块类型
+        /// @param data 数据
+        /// @param size 大小
+        static void write_png_chunk(std::vector<uint8_t> &output, const char *type, const uint8_t *data, size_t size);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
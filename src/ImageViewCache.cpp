@@ -0,0 +1,284 @@
+#ifndef __VL_IMAGEVIEWCACHE_CPP__
+#define __VL_IMAGEVIEWCACHE_CPP__
+
+#include <algorithm>
+#include "ImageViewCache.hpp"
+
+namespace vl
+{
+    size_t
+    ImageViewCache::KeyHash::operator()(
+        const Key &key) const noexcept
+    {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        for (uint32_t word : key)
+            hash = (hash ^ word) * 1099511628211ull;
+        return static_cast<size_t>(hash);
+    }
+
+    void
+    ImageViewCache::destroy(
+        const vk::Device &device)
+    {
+        if (device)
+        {
+            for (const auto &item : m_entries)
+                device.destroyImageView(item.second.m_view);
+            for (const auto &item : m_uncached)
+                device.destroyImageView(item.first);
+        }
+        m_statistics.m_destroyed += m_entries.size() + m_uncached.size();
+        m_statistics.m_live = 0;
+        m_entries.clear();
+        m_keys.clear();
+        m_image_views.clear();
+        m_uncached.clear();
+    }
+
+    vk::ResultValue<vk::ImageView>
+    ImageViewCache::acquire(
+        const vk::Device &device,
+        const vk::ImageViewCreateInfo &info)
+    {
+        m_statistics.m_requests++;
+        std::optional<Key> key = make_key(info);
+        if (key.has_value())
+        {
+            auto iter = m_entries.find(*key);
+            if (iter != m_entries.end())
+            {
+                iter->second.m_ref_count++;
+                m_statistics.m_hits++;
+                return {vk::Result::eSuccess, iter->second.m_view};
+            }
+        }
+
+        auto view_result = device.createImageView(info);
+        if (view_result.result != vk::Result::eSuccess)
+        {
+            m_statistics.m_failures++;
+            return view_result;
+        }
+
+        VkImage image = static_cast<VkImage>(info.image);
+        VkImageView view = static_cast<VkImageView>(view_result.value);
+        if (key.has_value())
+        {
+            m_entries.emplace(*key, Entry{view_result.value, image, 1});
+            m_keys.emplace(view, std::move(*key));
+            m_statistics.m_misses++;
+        }
+        else
+        {
+            m_uncached.emplace(view, image);
+            m_statistics.m_uncached++;
+        }
+        m_image_views[image].push_back(view);
+        m_statistics.m_live++;
+        m_statistics.m_peak_live = std::max(m_statistics.m_peak_live, m_statistics.m_live);
+        return view_result;
+    }
+
+    void
+    ImageViewCache::release(
+        const vk::Device &device,
+        const vk::ImageView &view)
+    {
+        VkImageView handle = static_cast<VkImageView>(view);
+        auto key_iter = m_keys.find(handle);
+        if (key_iter != m_keys.end())
+        {
+            Entry &entry = m_entries.at(key_iter->second);
+            if (entry.m_ref_count > 0)
+                entry.m_ref_count--;
+            return;
+        }
+
+        auto uncached_iter = m_uncached.find(handle);
+        if (uncached_iter == m_uncached.end())
+        {
+            ntl::log.loge(
+                NTL_STRING("ImageViewCache::release"),
+                NTL_STRING("The image view was not acquired from the cache"));
+            return;
+        }
+        forget(uncached_iter->second, handle);
+        device.destroyImageView(view);
+        m_uncached.erase(uncached_iter);
+        m_statistics.m_destroyed++;
+        m_statistics.m_live--;
+    }
+
+    uint32_t
+    ImageViewCache::release_image(
+        const vk::Device &device,
+        const vk::Image &image)
+    {
+        auto iter = m_image_views.find(static_cast<VkImage>(image));
+        if (iter == m_image_views.end())
+            return 0;
+
+        uint32_t referenced = 0;
+        for (VkImageView view : iter->second)
+        {
+            auto key_iter = m_keys.find(view);
+            if (key_iter != m_keys.end())
+            {
+                referenced += m_entries.at(key_iter->second).m_ref_count > 0 ? 1 : 0;
+                m_entries.erase(key_iter->second);
+                m_keys.erase(key_iter);
+            }
+            else
+            {
+                referenced++;
+                m_uncached.erase(view);
+            }
+            device.destroyImageView(view);
+        }
+        m_statistics.m_destroyed += iter->second.size();
+        m_statistics.m_live -= static_cast<uint32_t>(iter->second.size());
+        m_image_views.erase(iter);
+
+        if (referenced > 0)
+            ntl::log.loge(
+                NTL_STRING("ImageViewCache::release_image"),
+                NTL_STRING("Destroyed image views that are still referenced"));
+        return referenced;
+    }
+
+    uint32_t
+    ImageViewCache::trim(
+        const vk::Device &device)
+    {
+        uint32_t count = 0;
+        for (auto iter = m_entries.begin(); iter != m_entries.end();)
+        {
+            if (iter->second.m_ref_count > 0)
+            {
+                iter++;
+                continue;
+            }
+            VkImageView view = static_cast<VkImageView>(iter->second.m_view);
+            device.destroyImageView(iter->second.m_view);
+            forget(iter->second.m_image, view);
+            m_keys.erase(view);
+            iter = m_entries.erase(iter);
+            count++;
+        }
+        m_statistics.m_destroyed += count;
+        m_statistics.m_live -= count;
+        return count;
+    }
+
+    uint32_t
+    ImageViewCache::get_ref_count(
+        const vk::ImageView &view) const noexcept
+    {
+        auto iter = m_keys.find(static_cast<VkImageView>(view));
+        if (iter == m_keys.end())
+            return 0;
+        return m_entries.at(iter->second).m_ref_count;
+    }
+
+    uint32_t
+    ImageViewCache::get_size() const noexcept
+    {
+        return static_cast<uint32_t>(m_entries.size());
+    }
+
+    double
+    ImageViewCache::get_hit_rate() const noexcept
+    {
+        if (m_statistics.m_requests == 0)
+            return 0.0;
+        return static_cast<double>(m_statistics.m_hits) / static_cast<double>(m_statistics.m_requests);
+    }
+
+    const ImageViewCache::Statistics &
+    ImageViewCache::get_statistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+    ntl::String
+    ImageViewCache::format() const
+    {
+        ntl::StringStream sstr;
+        sstr << std::endl
+             << NTL_STRING("\trequests:") << m_statistics.m_requests << std::endl
+             << NTL_STRING("\thits:") << m_statistics.m_hits << std::endl
+             << NTL_STRING("\tmisses:") << m_statistics.m_misses << std::endl
+             << NTL_STRING("\tuncached:") << m_statistics.m_uncached << std::endl
+             << NTL_STRING("\tfailures:") << m_statistics.m_failures << std::endl
+             << NTL_STRING("\tdestroyed:") << m_statistics.m_destroyed << std::endl
+             << NTL_STRING("\tlive:") << m_statistics.m_live << NTL_STRING(" (peak ") << m_statistics.m_peak_live << NTL_STRING(")") << std::endl
+             << NTL_STRING("\timages:") << m_image_views.size() << std::endl
+             << NTL_STRING("\thit rate:") << get_hit_rate() << std::endl;
+        return sstr.str();
+    }
+
+    std::optional<ImageViewCache::Key>
+    ImageViewCache::make_key(
+        const vk::ImageViewCreateInfo &info)
+    {
+        Key key;
+        key.reserve(24);
+        auto push_handle = [&key](uint64_t value)
+        {
+            key.push_back(static_cast<uint32_t>(value));
+            key.push_back(static_cast<uint32_t>(value >> 32));
+        };
+
+        const VkImageViewCreateInfo &c_info = info;
+        key.push_back(c_info.flags);
+        push_handle(reinterpret_cast<uint64_t>(c_info.image));
+        key.push_back(c_info.viewType);
+        key.push_back(c_info.format);
+        key.push_back(c_info.components.r);
+        key.push_back(c_info.components.g);
+        key.push_back(c_info.components.b);
+        key.push_back(c_info.components.a);
+        key.push_back(c_info.subresourceRange.aspectMask);
+        key.push_back(c_info.subresourceRange.baseMipLevel);
+        key.push_back(c_info.subresourceRange.levelCount);
+        key.push_back(c_info.subresourceRange.baseArrayLayer);
+        key.push_back(c_info.subresourceRange.layerCount);
+
+        // 每个结构前加上sType，顺序不同的链视为不同
+        for (const VkBaseInStructure *next = static_cast<const VkBaseInStructure *>(c_info.pNext); next != nullptr; next = next->pNext)
+        {
+            key.push_back(next->sType);
+            switch (next->sType)
+            {
+            case VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO:
+                key.push_back(reinterpret_cast<const VkImageViewUsageCreateInfo *>(next)->usage);
+                break;
+            case VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO:
+                push_handle(reinterpret_cast<uint64_t>(reinterpret_cast<const VkSamplerYcbcrConversionInfo *>(next)->conversion));
+                break;
+            case VK_STRUCTURE_TYPE_IMAGE_VIEW_ASTC_DECODE_MODE_EXT:
+                key.push_back(reinterpret_cast<const VkImageViewASTCDecodeModeEXT *>(next)->decodeMode);
+                break;
+            default:
+                return std::nullopt;
+            }
+        }
+        return key;
+    }
+
+    void
+    ImageViewCache::forget(
+        VkImage image,
+        VkImageView view)
+    {
+        auto iter = m_image_views.find(image);
+        if (iter == m_image_views.end())
+            return;
+        iter->second.erase(std::remove(iter->second.begin(), iter->second.end(), view), iter->second.end());
+        if (iter->second.empty())
+            m_image_views.erase(iter);
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
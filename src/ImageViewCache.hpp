@@ -0,0 +1,130 @@
+#ifndef __VL_IMAGEVIEWCACHE_HPP__
+#define __VL_IMAGEVIEWCACHE_HPP__
+
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 图像视图缓存：按创建信息去重，多个材质引用同一图像的相同视图时共享同一个带引用计数的视图
+    /// @details 键包括图像句柄，与SamplerCache相同地处理pNext链，链中有未知结构时创建不缓存的视图。
+    /// 引用计数为0的视图留在缓存中直到trim；销毁图像前必须调用release_image销毁它的所有视图
+    class ImageViewCache : public ntl::Object
+    {
+    public:
+        using SelfType = ImageViewCache;
+        using ParentType = ntl::Object;
+
+        /// @brief 缓存的键，每个字段占一个或两个字
+        using Key = std::vector<uint32_t>;
+
+        /// @brief 键的哈希
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const noexcept;
+        };
+
+        /// @brief 统计信息
+        struct Statistics
+        {
+            /// @brief acquire的次数
+            uint64_t m_requests = 0;
+
+            /// @brief 命中缓存的次数
+            uint64_t m_hits = 0;
+
+            /// @brief 未命中，创建了新视图的次数
+            uint64_t m_misses = 0;
+
+            /// @brief pNext链中有未知结构，创建了不缓存的视图的次数
+            uint64_t m_uncached = 0;
+
+            /// @brief 创建失败的次数
+            uint64_t m_failures = 0;
+
+            /// @brief 销毁的视图数
+            uint64_t m_destroyed = 0;
+
+            /// @brief 存在的视图数，包括不缓存的
+            uint32_t m_live = 0;
+            uint32_t m_peak_live = 0;
+        };
+
+    protected:
+        /// @brief 缓存的视图
+        struct Entry
+        {
+            vk::ImageView m_view;
+            VkImage m_image = VK_NULL_HANDLE;
+            uint32_t m_ref_count = 0;
+        };
+
+        std::unordered_map<Key, Entry, KeyHash> m_entries;
+
+        /// @brief 视图到键，用于release
+        std::unordered_map<VkImageView, Key> m_keys;
+
+        /// @brief 每个图像的视图，包括不缓存的，用于release_image
+        std::unordered_map<VkImage, std::vector<VkImageView>> m_image_views;
+
+        /// @brief 不缓存的视图和它们的图像
+        std::unordered_map<VkImageView, VkImage> m_uncached;
+
+        Statistics m_statistics;
+
+    public:
+        ImageViewCache() = default;
+        ~ImageViewCache() override = default;
+
+        ImageViewCache(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 销毁所有视图，不检查引用计数
+        void destroy(const vk::Device &device);
+
+        /// @brief 获取与创建信息相同的视图，引用计数加1
+        /// @param device 逻辑设备
+        /// @param info 创建信息
+        /// @return 视图
+        vk::ResultValue<vk::ImageView> acquire(const vk::Device &device, const vk::ImageViewCreateInfo &info);
+
+        /// @brief 引用计数减1，不缓存的视图立即销毁
+        void release(const vk::Device &device, const vk::ImageView &view);
+
+        /// @brief 销毁图像的所有视图，图像销毁前调用
+        /// @return 仍有引用的视图数，正常时为0
+        uint32_t release_image(const vk::Device &device, const vk::Image &image);
+
+        /// @brief 销毁引用计数为0的视图
+        /// @return 销毁的数量
+        uint32_t trim(const vk::Device &device);
+
+        /// @brief 获取视图的引用计数，不是由缓存创建的为0
+        uint32_t get_ref_count(const vk::ImageView &view) const noexcept;
+
+        /// @brief 获取缓存的视图数
+        uint32_t get_size() const noexcept;
+
+        /// @brief 获取命中率
+        double get_hit_rate() const noexcept;
+
+        const Statistics &get_statistics() const noexcept;
+
+        ntl::String format() const;
+
+    public:
+        /// @brief 生成创建信息的键
+        /// @return pNext链中有未知结构时为空
+        static std::optional<Key> make_key(const vk::ImageViewCreateInfo &info);
+
+    protected:
+        /// @brief 从视图列表中移除一个视图
+        void forget(VkImage image, VkImageView view);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
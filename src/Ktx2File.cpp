@@ -0,0 +1,513 @@
+#ifndef __VL_KTX2FILE_CPP__
+#define __VL_KTX2FILE_CPP__
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "Ktx2File.hpp"
+#include "Deflate.hpp"
+
+namespace vl
+{
+    static_assert(sizeof(Ktx2File::Header) == 80, "Ktx2File::Header must be packed");
+    static_assert(sizeof(Ktx2File::Level) == 24, "Ktx2File::Level must be packed");
+
+    Ktx2File::~Ktx2File()
+    {
+        close();
+    }
+
+    bool
+    Ktx2File::open(
+        const std::string &path,
+        Mode mode)
+    {
+        close();
+        if (!m_file.open(path, mode))
+            return false;
+
+        m_data = m_file.get_data();
+        m_size = m_file.get_size();
+        if (!parse())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool
+    Ktx2File::open_memory(
+        const void *data,
+        size_t size)
+    {
+        close();
+        m_data = static_cast<const uint8_t *>(data);
+        m_size = size;
+        if (!parse())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void
+    Ktx2File::close() noexcept
+    {
+        m_file.close();
+        m_data = nullptr;
+        m_size = 0;
+        m_header = nullptr;
+        m_levels = nullptr;
+        m_format_info = FormatInfo();
+    }
+
+    bool
+    Ktx2File::is_open() const noexcept
+    {
+        return m_header != nullptr;
+    }
+
+    const Ktx2File::Header &
+    Ktx2File::get_header() const noexcept
+    {
+        return *m_header;
+    }
+
+    vk::Format
+    Ktx2File::get_format() const noexcept
+    {
+        return static_cast<vk::Format>(m_header->m_vk_format);
+    }
+
+    uint32_t
+    Ktx2File::get_width() const noexcept
+    {
+        return m_header->m_pixel_width;
+    }
+
+    uint32_t
+    Ktx2File::get_height() const noexcept
+    {
+        return m_header->m_pixel_height;
+    }
+
+    uint32_t
+    Ktx2File::get_level_count() const noexcept
+    {
+        return m_header->m_level_count;
+    }
+
+    const Ktx2File::Level &
+    Ktx2File::get_level(uint32_t level) const noexcept
+    {
+        return m_levels[level];
+    }
+
+    const uint8_t *
+    Ktx2File::get_level_data(uint32_t level) const noexcept
+    {
+        return m_data + m_levels[level].m_offset;
+    }
+
+    uint32_t
+    Ktx2File::get_tail_level(vk::DeviceSize budget) const noexcept
+    {
+        // 从最小的一级往大累加，直到超出预算
+        uint32_t tail = m_header->m_level_count - 1;
+        uint64_t total = m_levels[tail].m_uncompressed_size;
+        while (tail > 0 && total + m_levels[tail - 1].m_uncompressed_size <= budget)
+        {
+            tail--;
+            total += m_levels[tail].m_uncompressed_size;
+        }
+        return tail;
+    }
+
+    bool
+    Ktx2File::read_level(
+        uint32_t level,
+        uint8_t *destination) const noexcept
+    {
+        const Level &entry = m_levels[level];
+        if (m_header->m_supercompression == SUPERCOMPRESSION_ZLIB)
+            return Deflate::decompress_zlib(
+                get_level_data(level),
+                static_cast<size_t>(entry.m_size),
+                destination,
+                static_cast<size_t>(entry.m_uncompressed_size));
+
+        std::memcpy(destination, get_level_data(level), static_cast<size_t>(entry.m_size));
+        return true;
+    }
+
+    std::optional<StagingRing::Allocation>
+    Ktx2File::stage_level(
+        StagingRing &ring,
+        uint32_t level,
+        vk::DeviceSize alignment) const
+    {
+        // 复制到图像时缓冲偏移必须是块字节数的倍数，两者都是2的幂
+        alignment = std::max<vk::DeviceSize>(alignment, m_format_info.m_block_bytes);
+        std::optional<StagingRing::Allocation> allocation = ring.allocate(m_levels[level].m_uncompressed_size, alignment);
+        if (!allocation.has_value())
+            return std::nullopt;
+
+        if (!read_level(level, static_cast<uint8_t *>(allocation->m_pointer)))
+        {
+            ntl::log.loge(
+                NTL_STRING("Ktx2File::stage_level"),
+                NTL_STRING("Failed to decompress level"));
+            return std::nullopt;
+        }
+        return allocation;
+    }
+
+    vk::BufferImageCopy
+    Ktx2File::get_copy_region(
+        uint32_t level,
+        vk::DeviceSize buffer_offset) const noexcept
+    {
+        return vk::BufferImageCopy()
+            .setBufferOffset(buffer_offset)
+            .setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level, 0, 1))
+            .setImageExtent(vk::Extent3D(
+                std::max(m_header->m_pixel_width >> level, 1u),
+                std::max(m_header->m_pixel_height >> level, 1u),
+                1));
+    }
+
+    std::optional<Ktx2File::FormatInfo>
+    Ktx2File::get_format_info(vk::Format format) noexcept
+    {
+        switch (format)
+        {
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Srgb:
+            return FormatInfo{1, 4};
+        case vk::Format::eBc1RgbUnormBlock:
+        case vk::Format::eBc1RgbSrgbBlock:
+        case vk::Format::eBc1RgbaUnormBlock:
+        case vk::Format::eBc1RgbaSrgbBlock:
+        case vk::Format::eBc4UnormBlock:
+        case vk::Format::eEtc2R8G8B8UnormBlock:
+        case vk::Format::eEtc2R8G8B8SrgbBlock:
+        case vk::Format::eEacR11UnormBlock:
+            return FormatInfo{4, 8};
+        case vk::Format::eBc3UnormBlock:
+        case vk::Format::eBc3SrgbBlock:
+        case vk::Format::eBc5UnormBlock:
+        case vk::Format::eBc7UnormBlock:
+        case vk::Format::eBc7SrgbBlock:
+        case vk::Format::eEtc2R8G8B8A8UnormBlock:
+        case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+        case vk::Format::eEacR11G11UnormBlock:
+            return FormatInfo{4, 16};
+        default:
+            return std::nullopt;
+        }
+    }
+
+    uint64_t
+    Ktx2File::get_level_size(
+        const FormatInfo &info,
+        uint32_t width,
+        uint32_t height,
+        uint32_t level) noexcept
+    {
+        uint64_t blocks_x = (std::max(width >> level, 1u) + info.m_block_size - 1) / info.m_block_size;
+        uint64_t blocks_y = (std::max(height >> level, 1u) + info.m_block_size - 1) / info.m_block_size;
+        return blocks_x * blocks_y * info.m_block_bytes;
+    }
+
+    bool
+    Ktx2File::write(
+        const std::string &path,
+        vk::Format format,
+        uint32_t width,
+        uint32_t height,
+        const std::vector<std::vector<uint8_t>> &levels,
+        Supercompression supercompression)
+    {
+        auto fail = [](const ntl::String &message)
+        {
+            ntl::log.loge(
+                NTL_STRING("Ktx2File::write"),
+                message);
+            return false;
+        };
+
+        std::optional<FormatInfo> info = get_format_info(format);
+        if (!info.has_value())
+            return fail(NTL_STRING("Unsupported format"));
+        if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION)
+            return fail(NTL_STRING("Invalid size"));
+        uint32_t max_level_count = 1;
+        while ((std::max(width, height) >> max_level_count) > 0)
+            max_level_count++;
+        if (levels.empty() || levels.size() > max_level_count)
+            return fail(NTL_STRING("Invalid level count"));
+        for (uint32_t level = 0; level < levels.size(); level++)
+            if (levels[level].size() != get_level_size(*info, width, height, level))
+                return fail(NTL_STRING("Level size does not match the format"));
+
+        bool is_supercompressed = supercompression == SUPERCOMPRESSION_ZLIB;
+        std::vector<std::vector<uint8_t>> compressed(is_supercompressed ? levels.size() : 0);
+        for (size_t level = 0; level < compressed.size(); level++)
+            Deflate::compress_zlib(levels[level].data(), levels[level].size(), compressed[level]);
+
+        std::vector<uint32_t> dfd;
+        build_dfd(format, is_supercompressed, dfd);
+
+        // 只有一个键值对，键和值都以0结尾，整体按4字节对齐
+        static const char writer[] = "KTXwriter\0Vulkan-Learn";
+        std::vector<uint8_t> kvd(sizeof(uint32_t) + sizeof(writer));
+        uint32_t writer_size = sizeof(writer);
+        std::memcpy(kvd.data(), &writer_size, sizeof(uint32_t));
+        std::memcpy(kvd.data() + sizeof(uint32_t), writer, sizeof(writer));
+        kvd.resize((kvd.size() + 3) / 4 * 4, 0);
+
+        Header header;
+        std::memcpy(header.m_identifier, IDENTIFIER, sizeof(IDENTIFIER));
+        header.m_vk_format = static_cast<uint32_t>(format);
+        header.m_type_size = 1;
+        header.m_pixel_width = width;
+        header.m_pixel_height = height;
+        header.m_face_count = 1;
+        header.m_level_count = static_cast<uint32_t>(levels.size());
+        header.m_supercompression = supercompression;
+        header.m_dfd_offset = static_cast<uint32_t>(sizeof(Header) + sizeof(Level) * levels.size());
+        header.m_dfd_size = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+        header.m_kvd_offset = header.m_dfd_offset + header.m_dfd_size;
+        header.m_kvd_size = static_cast<uint32_t>(kvd.size());
+
+        // 从最后一级开始放置，未超压缩时每级按块字节数和4的公倍数对齐，两者都是2的幂
+        uint64_t alignment = is_supercompressed ? 1 : std::max<uint64_t>(info->m_block_bytes, 4);
+        std::vector<Level> table(levels.size());
+        uint64_t offset = static_cast<uint64_t>(header.m_kvd_offset) + header.m_kvd_size;
+        for (size_t i = levels.size(); i-- > 0;)
+        {
+            offset = (offset + alignment - 1) / alignment * alignment;
+            table[i].m_offset = offset;
+            table[i].m_size = is_supercompressed ? compressed[i].size() : levels[i].size();
+            table[i].m_uncompressed_size = levels[i].size();
+            offset += table[i].m_size;
+        }
+
+        std::ofstream fout(path, std::ios::binary);
+        if (!fout)
+            return fail(NTL_STRING("Failed to open file"));
+
+        static const char padding[16] = {};
+        fout.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        fout.write(reinterpret_cast<const char *>(table.data()), static_cast<std::streamsize>(sizeof(Level) * table.size()));
+        fout.write(reinterpret_cast<const char *>(dfd.data()), static_cast<std::streamsize>(header.m_dfd_size));
+        fout.write(reinterpret_cast<const char *>(kvd.data()), static_cast<std::streamsize>(kvd.size()));
+        uint64_t position = static_cast<uint64_t>(header.m_kvd_offset) + header.m_kvd_size;
+        for (size_t i = levels.size(); i-- > 0;)
+        {
+            const std::vector<uint8_t> &data = is_supercompressed ? compressed[i] : levels[i];
+            fout.write(padding, static_cast<std::streamsize>(table[i].m_offset - position));
+            fout.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+            position = table[i].m_offset + table[i].m_size;
+        }
+
+        return static_cast<bool>(fout);
+    }
+
+    bool
+    Ktx2File::parse()
+    {
+        auto fail = [](const ntl::String &message)
+        {
+            ntl::log.loge(
+                NTL_STRING("Ktx2File::parse"),
+                message);
+            return false;
+        };
+
+        if (m_data == nullptr || m_size < sizeof(Header))
+            return fail(NTL_STRING("File is too small"));
+
+        // 直接按结构读取，映射按页对齐，std::vector按max_align_t对齐
+        if (reinterpret_cast<uintptr_t>(m_data) % alignof(Header) != 0)
+            return fail(NTL_STRING("Data is not aligned"));
+        const Header *header = reinterpret_cast<const Header *>(m_data);
+        if (std::memcmp(header->m_identifier, IDENTIFIER, sizeof(IDENTIFIER)) != 0)
+            return fail(NTL_STRING("Invalid identifier"));
+
+        std::optional<FormatInfo> info = get_format_info(static_cast<vk::Format>(header->m_vk_format));
+        if (!info.has_value() || header->m_type_size != 1)
+            return fail(NTL_STRING("Unsupported format"));
+        if (header->m_pixel_width == 0 || header->m_pixel_width > MAX_DIMENSION ||
+            header->m_pixel_height == 0 || header->m_pixel_height > MAX_DIMENSION)
+            return fail(NTL_STRING("Invalid size"));
+        if (header->m_pixel_depth != 0 || header->m_layer_count != 0 || header->m_face_count != 1)
+            return fail(NTL_STRING("Only 2D textures are supported"));
+
+        // 级数为0表示要求加载时生成mip，这里不支持
+        uint32_t max_level_count = 1;
+        while ((std::max(header->m_pixel_width, header->m_pixel_height) >> max_level_count) > 0)
+            max_level_count++;
+        if (header->m_level_count == 0 || header->m_level_count > max_level_count)
+            return fail(NTL_STRING("Invalid level count"));
+        if (header->m_supercompression != SUPERCOMPRESSION_NONE && header->m_supercompression != SUPERCOMPRESSION_ZLIB)
+            return fail(NTL_STRING("Unsupported supercompression"));
+        uint64_t index_end = sizeof(Header) + sizeof(Level) * static_cast<uint64_t>(header->m_level_count);
+        if (m_size < index_end)
+            return fail(NTL_STRING("Level index is truncated"));
+
+        // 数据格式描述的第一个字是它的总字节数
+        if (header->m_dfd_offset % 4 != 0 || header->m_dfd_size < sizeof(uint32_t) ||
+            header->m_dfd_offset > m_size || header->m_dfd_size > m_size - header->m_dfd_offset)
+            return fail(NTL_STRING("Data format descriptor is out of range"));
+        uint32_t dfd_total_size = 0;
+        std::memcpy(&dfd_total_size, m_data + header->m_dfd_offset, sizeof(uint32_t));
+        if (dfd_total_size != header->m_dfd_size)
+            return fail(NTL_STRING("Data format descriptor size does not match"));
+        if (header->m_kvd_offset > m_size || header->m_kvd_size > m_size - header->m_kvd_offset)
+            return fail(NTL_STRING("Key/value data is out of range"));
+        if (header->m_sgd_offset != 0 || header->m_sgd_size != 0)
+            return fail(NTL_STRING("Supercompression global data is not supported"));
+
+        // 每级的大小与格式一致，未超压缩时按块对齐，整体从最后一级开始依次存放，互不重叠
+        bool is_supercompressed = header->m_supercompression == SUPERCOMPRESSION_ZLIB;
+        uint64_t alignment = is_supercompressed ? 1 : std::max<uint64_t>(info->m_block_bytes, 4);
+        const Level *levels = reinterpret_cast<const Level *>(m_data + sizeof(Header));
+        for (uint32_t i = 0; i < header->m_level_count; i++)
+        {
+            const Level &level = levels[i];
+            if (level.m_offset % alignment != 0)
+                return fail(NTL_STRING("Level is not aligned"));
+            if (level.m_offset < index_end || level.m_offset > m_size || level.m_size > m_size - level.m_offset)
+                return fail(NTL_STRING("Level is out of range"));
+            if (level.m_uncompressed_size != get_level_size(*info, header->m_pixel_width, header->m_pixel_height, i))
+                return fail(NTL_STRING("Level size does not match the format"));
+            if (is_supercompressed ? level.m_size == 0 : level.m_size != level.m_uncompressed_size)
+                return fail(NTL_STRING("Invalid level data size"));
+            if (i > 0 && level.m_offset + level.m_size > levels[i - 1].m_offset)
+                return fail(NTL_STRING("Levels must be stored smallest first"));
+        }
+
+        m_header = header;
+        m_levels = levels;
+        m_format_info = *info;
+        return true;
+    }
+
+    void
+    Ktx2File::build_dfd(
+        vk::Format format,
+        bool is_supercompressed,
+        std::vector<uint32_t> &words)
+    {
+        // 样本：位偏移、位数、通道，范围为[0, 上限]
+        struct Sample
+        {
+            uint32_t m_bit_offset;
+            uint32_t m_bit_length;
+            uint32_t m_channel;
+        };
+
+        // 颜色模型：RGBSDA为1，BC1到BC7为128到134，ETC2为161；通道编号由模型决定，透明度都为15
+        uint32_t model = 1;
+        bool is_srgb = false;
+        std::vector<Sample> samples;
+        switch (format)
+        {
+        case vk::Format::eR8G8B8A8Srgb:
+            is_srgb = true;
+            [[fallthrough]];
+        case vk::Format::eR8G8B8A8Unorm:
+            samples = {{0, 8, 0}, {8, 8, 1}, {16, 8, 2}, {24, 8, 15}};
+            break;
+        case vk::Format::eBc1RgbSrgbBlock:
+            is_srgb = true;
+            [[fallthrough]];
+        case vk::Format::eBc1RgbUnormBlock:
+            model = 128;
+            samples = {{0, 64, 0}};
+            break;
+        case vk::Format::eBc1RgbaSrgbBlock:
+            is_srgb = true;
+            [[fallthrough]];
+        case vk::Format::eBc1RgbaUnormBlock:
+            model = 128;
+            samples = {{0, 64, 1}};
+            break;
+        case vk::Format::eBc3SrgbBlock:
+            is_srgb = true;
+            [[fallthrough]];
+        case vk::Format::eBc3UnormBlock:
+            model = 130;
+            samples = {{0, 64, 15}, {64, 64, 0}};
+            break;
+        case vk::Format::eBc4UnormBlock:
+            model = 131;
+            samples = {{0, 64, 0}};
+            break;
+        case vk::Format::eBc5UnormBlock:
+            model = 132;
+            samples = {{0, 64, 0}, {64, 64, 1}};
+            break;
+        case vk::Format::eBc7SrgbBlock:
+            is_srgb = true;
+            [[fallthrough]];
+        case vk::Format::eBc7UnormBlock:
+            model = 134;
+            samples = {{0, 128, 0}};
+            break;
+        case vk::Format::eEtc2R8G8B8SrgbBlock:
+            is_srgb = true;
+            [[fallthrough]];
+        case vk::Format::eEtc2R8G8B8UnormBlock:
+            model = 161;
+            samples = {{0, 64, 2}};
+            break;
+        case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+            is_srgb = true;
+            [[fallthrough]];
+        case vk::Format::eEtc2R8G8B8A8UnormBlock:
+            model = 161;
+            samples = {{0, 64, 15}, {64, 64, 2}};
+            break;
+        case vk::Format::eEacR11UnormBlock:
+            model = 161;
+            samples = {{0, 64, 0}};
+            break;
+        case vk::Format::eEacR11G11UnormBlock:
+            model = 161;
+            samples = {{0, 64, 0}, {64, 64, 1}};
+            break;
+        default:
+            break;
+        }
+
+        FormatInfo info = get_format_info(format).value_or(FormatInfo());
+        uint32_t block_size = 24 + 16 * static_cast<uint32_t>(samples.size());
+        uint32_t dimension = info.m_block_size - 1;
+        words.clear();
+        words.push_back(4 + block_size);
+        // 厂商和描述类型都为0，版本2
+        words.push_back(0);
+        words.push_back(2 | (block_size << 16));
+        // BT.709原色，线性或sRGB传递函数，非预乘透明度
+        words.push_back(model | (1 << 8) | ((is_srgb ? 2u : 1u) << 16));
+        words.push_back(dimension | (dimension << 8));
+        words.push_back(is_supercompressed ? 0 : info.m_block_bytes);
+        words.push_back(0);
+        for (const Sample &sample : samples)
+        {
+            // sRGB格式的透明度仍是线性的
+            uint32_t qualifiers = is_srgb && sample.m_channel == 15 ? 0x10 : 0;
+            uint32_t upper = sample.m_bit_length >= 32 ? UINT32_MAX : (1u << sample.m_bit_length) - 1;
+            words.push_back(sample.m_bit_offset | ((sample.m_bit_length - 1) << 16) | ((sample.m_channel | qualifiers) << 24));
+            words.push_back(0);
+            words.push_back(0);
+            words.push_back(upper);
+        }
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,230 @@
+#ifndef __VL_KTX2FILE_HPP__
+#define __VL_KTX2FILE_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <optional>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "StagingRing.hpp"
+#include "MappedFile.hpp"
+
+namespace vl
+{
+    /// @brief KTX2纹理文件，只支持单层、单面的二维纹理
+    /// @details 文件头之后是每一级的索引、数据格式描述和键值对，各级数据从最小的一级开始存放，第0级在文件末尾，
+    /// 未超压缩时每一级按块的字节数对齐，可以从映射直接复制到暂存环；超压缩只支持zlib，解压直接写入暂存环。
+    /// 先上传文件开头的小级别即可开始渲染，大的级别随后流式加载
+    class Ktx2File : public ntl::Object
+    {
+    public:
+        using SelfType = Ktx2File;
+        using ParentType = ntl::Object;
+
+        /// @brief 打开方式
+        using Mode = MappedFile::Mode;
+
+        /// @brief 超压缩方式
+        enum Supercompression : uint32_t
+        {
+            SUPERCOMPRESSION_NONE = 0,
+            /// @brief 每一级单独压缩为zlib数据流
+            SUPERCOMPRESSION_ZLIB = 3,
+        };
+
+        /// @brief 文件头和索引，数值均为小端序
+        struct Header
+        {
+            uint8_t m_identifier[12] = {};
+            uint32_t m_vk_format = 0;
+            uint32_t m_type_size = 0;
+            uint32_t m_pixel_width = 0;
+            uint32_t m_pixel_height = 0;
+            uint32_t m_pixel_depth = 0;
+            uint32_t m_layer_count = 0;
+            uint32_t m_face_count = 0;
+            uint32_t m_level_count = 0;
+            uint32_t m_supercompression = 0;
+
+            uint32_t m_dfd_offset = 0;
+            uint32_t m_dfd_size = 0;
+            uint32_t m_kvd_offset = 0;
+            uint32_t m_kvd_size = 0;
+            uint64_t m_sgd_offset = 0;
+            uint64_t m_sgd_size = 0;
+        };
+
+        /// @brief 一级的索引
+        struct Level
+        {
+            /// @brief 相对文件开头的偏移
+            uint64_t m_offset = 0;
+
+            /// @brief 文件中的字节数
+            uint64_t m_size = 0;
+
+            /// @brief 解压后的字节数
+            uint64_t m_uncompressed_size = 0;
+        };
+
+        /// @brief 格式的块信息
+        struct FormatInfo
+        {
+            /// @brief 块的边长，未压缩格式为1
+            uint32_t m_block_size = 1;
+
+            /// @brief 每块的字节数
+            uint32_t m_block_bytes = 4;
+        };
+
+        /// @brief 文件标识"«KTX 20»\r\n\x1A\n"
+        static constexpr uint8_t IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+        /// @brief 最多的级数，对应65536的边长
+        static constexpr uint32_t MAX_LEVEL_COUNT = 17;
+
+        /// @brief 宽和高的上限
+        static constexpr uint32_t MAX_DIMENSION = 65536;
+
+    protected:
+        /// @brief 文件的全部内容
+        const uint8_t *m_data = nullptr;
+        size_t m_size = 0;
+
+        const Header *m_header = nullptr;
+        const Level *m_levels = nullptr;
+        FormatInfo m_format_info;
+
+        /// @brief open打开的文件，open_memory时不使用
+        MappedFile m_file;
+
+    public:
+        Ktx2File() = default;
+        ~Ktx2File() override;
+
+        Ktx2File(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 打开并检查文件
+        /// @param path 路径
+        /// @param mode 打开方式
+        /// @return 是否成功
+        bool open(const std::string &path, Mode mode = Mode::eMap);
+
+        /// @brief 使用内存中的文件内容，不复制，内存需要在close前保持有效
+        /// @param data 内容，至少按8字节对齐
+        /// @param size 字节数
+        /// @return 是否通过检查
+        bool open_memory(const void *data, size_t size);
+
+        /// @brief 关闭
+        void close() noexcept;
+
+        /// @brief 是否已打开
+        /// @return 是否已打开
+        bool is_open() const noexcept;
+
+        /// @brief 获取文件头，需要已打开
+        /// @return 文件头
+        const Header &get_header() const noexcept;
+
+        /// @brief 获取格式
+        /// @return 格式
+        vk::Format get_format() const noexcept;
+
+        /// @brief 获取第0级的宽度
+        /// @return 宽度
+        uint32_t get_width() const noexcept;
+
+        /// @brief 获取第0级的高度
+        /// @return 高度
+        uint32_t get_height() const noexcept;
+
+        /// @brief 获取级数
+        /// @return 级数
+        uint32_t get_level_count() const noexcept;
+
+        /// @brief 获取一级的索引
+        /// @param level 级别
+        /// @return 索引
+        const Level &get_level(uint32_t level) const noexcept;
+
+        /// @brief 获取一级在文件中的数据
+        /// @param level 级别
+        /// @return 数据，超压缩时为压缩的数据流
+        const uint8_t *get_level_data(uint32_t level) const noexcept;
+
+        /// @brief 找出能放进预算的最大的尾部级别，从它到最后一级一起上传即可开始采样
+        /// @param budget 字节数，按解压后的大小计算
+        /// @return 级别，最后一级超过预算时仍为最后一级
+        uint32_t get_tail_level(vk::DeviceSize budget) const noexcept;
+
+        /// @brief 把一级解压到目标
+        /// @param level 级别
+        /// @param destination 目标，get_level(level).m_uncompressed_size字节
+        /// @return 是否成功，超压缩的数据损坏时失败
+        bool read_level(uint32_t level, uint8_t *destination) const noexcept;
+
+        /// @brief 在暂存环中分配并把一级直接写入分配
+        /// @details 解压失败时分配的空间要到下次release才回收
+        /// @param ring 暂存环
+        /// @param level 级别
+        /// @param alignment 对齐，至少为块的字节数
+        /// @return 分配，暂存环空间不足或解压失败时为空
+        std::optional<StagingRing::Allocation> stage_level(
+            StagingRing &ring,
+            uint32_t level,
+            vk::DeviceSize alignment = 16) const;
+
+        /// @brief 获取把stage_level的结果复制到图像对应级别的区域
+        /// @param level 级别
+        /// @param buffer_offset 分配的偏移
+        /// @return 复制区域，目标为第0层
+        vk::BufferImageCopy get_copy_region(uint32_t level, vk::DeviceSize buffer_offset) const noexcept;
+
+    public:
+        /// @brief 获取支持的格式的块信息
+        /// @param format 格式
+        /// @return 块信息，不支持时为空
+        static std::optional<FormatInfo> get_format_info(vk::Format format) noexcept;
+
+        /// @brief 计算一级的字节数
+        /// @param info 块信息
+        /// @param width 第0级的宽度
+        /// @param height 第0级的高度
+        /// @param level 级别
+        /// @return 字节数
+        static uint64_t get_level_size(const FormatInfo &info, uint32_t width, uint32_t height, uint32_t level) noexcept;
+
+        /// @brief 写入文件
+        /// @param path 路径
+        /// @param format 格式，需要被get_format_info支持
+        /// @param width 第0级的宽度
+        /// @param height 第0级的高度
+        /// @param levels 各级数据，第0级在前
+        /// @param supercompression 超压缩方式
+        /// @return 是否成功
+        static bool write(
+            const std::string &path,
+            vk::Format format,
+            uint32_t width,
+            uint32_t height,
+            const std::vector<std::vector<uint8_t>> &levels,
+            Supercompression supercompression = SUPERCOMPRESSION_NONE);
+
+    protected:
+        /// @brief 检查m_data中的文件头和索引
+        /// @return 是否通过
+        bool parse();
+
+        /// @brief 生成格式的数据格式描述，只含一个基本描述块
+        /// @param format 格式
+        /// @param is_supercompressed 是否超压缩，此时每平面字节数为0
+        /// @param words 输出，第一个字为总字节数
+        static void build_dfd(vk::Format format, bool is_supercompressed, std::vector<uint32_t> &words);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
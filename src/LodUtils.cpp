@@ -0,0 +1,469 @@
+#ifndef __VL_LODUTILS_CPP__
+#define __VL_LODUTILS_CPP__
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "LodUtils.hpp"
+#include "MeshUtils.hpp"
+
+namespace vl
+{
+    static_assert(sizeof(LodUtils::Lod) == 16, "LodUtils::Lod must be packed");
+
+    size_t
+    LodUtils::simplify(
+        const uint32_t *indices,
+        size_t index_count,
+        const float *positions,
+        size_t position_stride,
+        size_t vertex_count,
+        size_t target_index_count,
+        float target_error,
+        std::vector<uint32_t> &destination,
+        float *result_error)
+    {
+        destination.clear();
+        if (result_error != nullptr)
+            *result_error = 0.0f;
+        if (index_count % 3 != 0)
+            return 0;
+        for (size_t i = 0; i < index_count; i++)
+            if (indices[i] >= vertex_count)
+                return 0;
+        // 索引重复的退化三角形不影响形状，先去掉
+        destination.reserve(index_count);
+        for (size_t i = 0; i < index_count; i += 3)
+            if (indices[i] != indices[i + 1] && indices[i + 1] != indices[i + 2] && indices[i + 2] != indices[i])
+                destination.insert(destination.end(), indices + i, indices + i + 3);
+        if (destination.size() <= target_index_count)
+            return destination.size();
+
+        auto position = [&](uint32_t vertex)
+        {
+            return reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(positions) + vertex * position_stride);
+        };
+
+        // 顶点到三角形的邻接表和以顶点为起点的有向边，每一轮按当前的索引重建
+        std::vector<uint32_t> offsets(vertex_count + 1), adjacency, edge_ends, cursor(vertex_count);
+        auto build_adjacency = [&]()
+        {
+            std::fill(offsets.begin(), offsets.end(), 0);
+            for (uint32_t vertex : destination)
+                offsets[vertex + 1]++;
+            for (size_t v = 0; v < vertex_count; v++)
+                offsets[v + 1] += offsets[v];
+            adjacency.resize(destination.size());
+            edge_ends.resize(destination.size());
+            std::copy(offsets.begin(), offsets.end() - 1, cursor.begin());
+            for (size_t i = 0; i < destination.size(); i++)
+            {
+                uint32_t slot = cursor[destination[i]]++;
+                adjacency[slot] = static_cast<uint32_t>(i / 3);
+                edge_ends[slot] = destination[i - i % 3 + (i + 1) % 3];
+            }
+        };
+
+        // 有向边a->b的数量，另一侧三角形的b->a不存在时为开放边
+        auto count_edges = [&](uint32_t a, uint32_t b)
+        {
+            uint32_t count = 0;
+            for (uint32_t i = offsets[a]; i < offsets[a + 1]; i++)
+                count += edge_ends[i] == b;
+            return count;
+        };
+
+        // 顶点分类：接缝和非流形顶点锁定，开放边界上的顶点只能沿边界折叠
+        const uint8_t KIND_MANIFOLD = 0, KIND_BORDER = 1, KIND_LOCKED = 2;
+        std::vector<uint8_t> kinds(vertex_count, KIND_MANIFOLD);
+        {
+            std::vector<uint32_t> order(vertex_count);
+            std::iota(order.begin(), order.end(), 0);
+            auto less = [&](uint32_t a, uint32_t b)
+            {
+                return std::lexicographical_compare(position(a), position(a) + 3, position(b), position(b) + 3);
+            };
+            std::sort(order.begin(), order.end(), less);
+            for (size_t i = 1; i < vertex_count; i++)
+                if (!less(order[i - 1], order[i]))
+                    kinds[order[i - 1]] = kinds[order[i]] = KIND_LOCKED;
+        }
+
+        build_adjacency();
+        std::vector<uint32_t> open_counts(vertex_count, 0);
+        for (size_t i = 0; i < destination.size(); i++)
+        {
+            uint32_t a = destination[i], b = destination[i - i % 3 + (i + 1) % 3];
+            uint32_t forward = count_edges(a, b), backward = count_edges(b, a);
+            if (forward > 1 || backward > 1)
+                kinds[a] = kinds[b] = KIND_LOCKED;
+            else if (backward == 0)
+                open_counts[a]++, open_counts[b]++;
+        }
+        for (size_t v = 0; v < vertex_count; v++)
+            if (kinds[v] == KIND_MANIFOLD && open_counts[v] > 0)
+                kinds[v] = open_counts[v] == 2 ? KIND_BORDER : KIND_LOCKED;
+
+        // 每个顶点的二次误差：相邻三角形平面按面积加权，开放边额外加一个垂直于三角形的平面保持轮廓
+        struct Quadric
+        {
+            double m_a2 = 0.0, m_b2 = 0.0, m_c2 = 0.0, m_ab = 0.0, m_ac = 0.0, m_bc = 0.0;
+            double m_ad = 0.0, m_bd = 0.0, m_cd = 0.0, m_d2 = 0.0;
+            double m_weight = 0.0;
+
+            void add_plane(const double n[3], double d, double weight)
+            {
+                m_a2 += weight * n[0] * n[0], m_b2 += weight * n[1] * n[1], m_c2 += weight * n[2] * n[2];
+                m_ab += weight * n[0] * n[1], m_ac += weight * n[0] * n[2], m_bc += weight * n[1] * n[2];
+                m_ad += weight * n[0] * d, m_bd += weight * n[1] * d, m_cd += weight * n[2] * d;
+                m_d2 += weight * d * d;
+                m_weight += weight;
+            }
+
+            void add(const Quadric &other)
+            {
+                m_a2 += other.m_a2, m_b2 += other.m_b2, m_c2 += other.m_c2;
+                m_ab += other.m_ab, m_ac += other.m_ac, m_bc += other.m_bc;
+                m_ad += other.m_ad, m_bd += other.m_bd, m_cd += other.m_cd;
+                m_d2 += other.m_d2;
+                m_weight += other.m_weight;
+            }
+
+            /// @brief 到各平面距离平方的加权平均
+            static double error(const Quadric &q, const Quadric &r, const float *p)
+            {
+                double x = p[0], y = p[1], z = p[2];
+                double value =
+                    (q.m_a2 + r.m_a2) * x * x + (q.m_b2 + r.m_b2) * y * y + (q.m_c2 + r.m_c2) * z * z +
+                    2.0 * ((q.m_ab + r.m_ab) * x * y + (q.m_ac + r.m_ac) * x * z + (q.m_bc + r.m_bc) * y * z) +
+                    2.0 * ((q.m_ad + r.m_ad) * x + (q.m_bd + r.m_bd) * y + (q.m_cd + r.m_cd) * z) +
+                    (q.m_d2 + r.m_d2);
+                double weight = q.m_weight + r.m_weight;
+                return weight > 0.0 ? std::abs(value) / weight : 0.0;
+            }
+        };
+
+        // 每个三角形在原网格中的单位法线，随三角形一起保留，防止多轮折叠累积后翻转
+        const double BORDER_WEIGHT = 10.0;
+        std::vector<Quadric> quadrics(vertex_count);
+        std::vector<float> reference_normals(destination.size(), 0.0f);
+        for (size_t t = 0; t < destination.size() / 3; t++)
+        {
+            const uint32_t *triangle = &destination[t * 3];
+            const float *p[3] = {position(triangle[0]), position(triangle[1]), position(triangle[2])};
+            double e1[3] = {p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2]};
+            double e2[3] = {p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2]};
+            double n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (length == 0.0)
+                continue;
+            for (size_t k = 0; k < 3; k++)
+                n[k] /= length;
+            double d = -(n[0] * p[0][0] + n[1] * p[0][1] + n[2] * p[0][2]);
+            for (size_t k = 0; k < 3; k++)
+            {
+                quadrics[triangle[k]].add_plane(n, d, length * 0.5);
+                reference_normals[t * 3 + k] = static_cast<float>(n[k]);
+            }
+
+            for (size_t k = 0; k < 3; k++)
+            {
+                uint32_t a = triangle[k], b = triangle[(k + 1) % 3];
+                if (count_edges(b, a) != 0)
+                    continue;
+                const float *pa = position(a), *pb = position(b);
+                double edge[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+                double plane[3] = {edge[1] * n[2] - edge[2] * n[1], edge[2] * n[0] - edge[0] * n[2], edge[0] * n[1] - edge[1] * n[0]};
+                double plane_length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+                if (plane_length == 0.0)
+                    continue;
+                for (size_t j = 0; j < 3; j++)
+                    plane[j] /= plane_length;
+                double plane_d = -(plane[0] * pa[0] + plane[1] * pa[1] + plane[2] * pa[2]);
+                double weight = (edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2]) * BORDER_WEIGHT;
+                quadrics[a].add_plane(plane, plane_d, weight);
+                quadrics[b].add_plane(plane, plane_d, weight);
+            }
+        }
+
+        struct Collapse
+        {
+            uint32_t m_from;
+            uint32_t m_to;
+            float m_cost;
+        };
+        std::vector<Collapse> collapses;
+        std::vector<uint32_t> remap(vertex_count);
+        std::iota(remap.begin(), remap.end(), 0);
+        std::vector<uint8_t> is_pass_locked(vertex_count);
+        std::vector<uint32_t> stamps(vertex_count, 0);
+        uint32_t stamp = 0;
+        const double max_cost = static_cast<double>(target_error) * target_error;
+        double result_cost = 0.0;
+
+        // 把from移到to的位置后，from周围不含to的三角形不能翻转或退化
+        auto is_flipped = [&](uint32_t from, uint32_t to)
+        {
+            const float *target = position(to);
+            for (uint32_t i = offsets[from]; i < offsets[from + 1]; i++)
+            {
+                const uint32_t *triangle = &destination[adjacency[i] * 3];
+                const float *reference = &reference_normals[adjacency[i] * 3];
+                if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+                    continue;
+                size_t k = triangle[0] == from ? 0 : (triangle[1] == from ? 1 : 2);
+                const float *b = position(triangle[(k + 1) % 3]), *c = position(triangle[(k + 2) % 3]);
+                auto normal = [&](const float *a, float n[3])
+                {
+                    float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+                    float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+                    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+                    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+                    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+                };
+                float before[3], after[3];
+                normal(position(from), before);
+                normal(target, after);
+                // 与原网格的朝向相差超过约75度时，三角形已经立起成为细长的侧面，也视为翻转
+                float after_length = std::sqrt(after[0] * after[0] + after[1] * after[1] + after[2] * after[2]);
+                float before_length = std::sqrt(before[0] * before[0] + before[1] * before[1] + before[2] * before[2]);
+                float dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+                float reference_dot = reference[0] * after[0] + reference[1] * after[1] + reference[2] * after[2];
+                if (dot <= 0.01f * before_length * after_length || reference_dot <= 0.25f * after_length)
+                    return true;
+            }
+            return false;
+        };
+
+        // 两端共同的邻居数必须等于共享这条边的三角形数，否则折叠会产生非流形
+        auto is_topology_valid = [&](uint32_t from, uint32_t to, uint32_t shared)
+        {
+            stamp++;
+            for (uint32_t i = offsets[from]; i < offsets[from + 1]; i++)
+                for (size_t k = 0; k < 3; k++)
+                    stamps[destination[adjacency[i] * 3 + k]] = stamp;
+            stamps[from] = stamps[to] = 0;
+
+            uint32_t common = 0;
+            for (uint32_t i = offsets[to]; i < offsets[to + 1]; i++)
+                for (size_t k = 0; k < 3; k++)
+                {
+                    uint32_t vertex = destination[adjacency[i] * 3 + k];
+                    if (stamps[vertex] == stamp)
+                    {
+                        stamps[vertex] = 0;
+                        common++;
+                    }
+                }
+            return common == shared;
+        };
+
+        // 总被拒绝的低代价折叠(如极点附近)会一直占据排序的前部，上一轮执行过的代价作为下限，避免每轮只执行少量折叠
+        double pass_scale = 1.5, pass_floor = 0.0;
+        while (destination.size() > target_index_count)
+        {
+            build_adjacency();
+
+            // 内部边在两个三角形中各出现一次，只取a < b的一次；两个方向都允许时取代价小的
+            collapses.clear();
+            for (size_t i = 0; i < destination.size(); i++)
+            {
+                uint32_t a = destination[i], b = destination[i - i % 3 + (i + 1) % 3];
+                bool is_open = count_edges(b, a) == 0;
+                if (!is_open && a > b)
+                    continue;
+
+                auto is_allowed = [&](uint32_t from)
+                {
+                    return kinds[from] == KIND_MANIFOLD || (kinds[from] == KIND_BORDER && is_open);
+                };
+                Collapse collapse = {a, b, 0.0f};
+                bool has_forward = is_allowed(a), has_backward = is_allowed(b);
+                if (!has_forward && !has_backward)
+                    continue;
+                float forward = has_forward ? static_cast<float>(Quadric::error(quadrics[a], quadrics[b], position(b))) : 0.0f;
+                float backward = has_backward ? static_cast<float>(Quadric::error(quadrics[b], quadrics[a], position(a))) : 0.0f;
+                if (has_forward && (!has_backward || forward <= backward))
+                    collapse.m_cost = forward;
+                else
+                    collapse = {b, a, backward};
+                collapses.push_back(collapse);
+            }
+            if (collapses.empty())
+                break;
+
+            // 内部的折叠删除两个三角形，按此估计本轮需要的折叠数；代价明显高于估计位置的折叠留到下一轮，使折叠分布均匀，
+            // 所以只需要对代价不超过pass_cost的部分排序
+            auto less = [](const Collapse &x, const Collapse &y)
+            {
+                return x.m_cost < y.m_cost;
+            };
+            const size_t goal = (destination.size() - target_index_count + 2) / 3;
+            const size_t estimate = std::min(collapses.size(), std::max<size_t>(goal / 2, 1));
+            std::nth_element(collapses.begin(), collapses.begin() + (estimate - 1), collapses.end(), less);
+            const double pass_cost = std::min(std::max(collapses[estimate - 1].m_cost * pass_scale, pass_floor), max_cost);
+            auto candidates_end = std::partition(collapses.begin(), collapses.end(), [&](const Collapse &collapse)
+                                                 { return collapse.m_cost <= pass_cost; });
+            std::sort(collapses.begin(), candidates_end, less);
+
+            std::fill(is_pass_locked.begin(), is_pass_locked.end(), 0);
+            size_t removed = 0, performed = 0;
+            for (auto it = collapses.begin(); it != candidates_end && removed < goal; ++it)
+            {
+                const Collapse &collapse = *it;
+                const uint32_t from = collapse.m_from, to = collapse.m_to;
+                if (is_pass_locked[from] || is_pass_locked[to])
+                    continue;
+
+                uint32_t shared = 0;
+                for (uint32_t i = offsets[from]; i < offsets[from + 1]; i++)
+                {
+                    const uint32_t *triangle = &destination[adjacency[i] * 3];
+                    shared += triangle[0] == to || triangle[1] == to || triangle[2] == to;
+                }
+                if (!is_topology_valid(from, to, shared) || is_flipped(from, to))
+                    continue;
+
+                // from周围的三角形会改变，它们的顶点在本轮不再参与折叠
+                for (uint32_t i = offsets[from]; i < offsets[from + 1]; i++)
+                    for (size_t k = 0; k < 3; k++)
+                        is_pass_locked[destination[adjacency[i] * 3 + k]] = 1;
+                is_pass_locked[to] = 1;
+
+                remap[from] = to;
+                quadrics[to].add(quadrics[from]);
+                result_cost = std::max(result_cost, static_cast<double>(collapse.m_cost));
+                removed += shared;
+                performed++;
+            }
+            // 代价范围内的折叠都被跳过时放宽范围，直到达到误差上限
+            if (performed == 0)
+            {
+                if (candidates_end == collapses.end() || pass_cost >= max_cost)
+                    break;
+                pass_scale *= 4.0;
+                continue;
+            }
+            pass_scale = 1.5;
+            pass_floor = pass_cost;
+
+            // 改写索引并删除退化的三角形
+            size_t write = 0;
+            for (size_t t = 0; t < destination.size() / 3; t++)
+            {
+                uint32_t a = remap[destination[t * 3]], b = remap[destination[t * 3 + 1]], c = remap[destination[t * 3 + 2]];
+                if (a == b || b == c || c == a)
+                    continue;
+                std::copy(&reference_normals[t * 3], &reference_normals[t * 3] + 3, &reference_normals[write]);
+                destination[write++] = a;
+                destination[write++] = b;
+                destination[write++] = c;
+            }
+            destination.resize(write);
+            reference_normals.resize(write);
+        }
+
+        if (result_error != nullptr)
+            *result_error = static_cast<float>(std::sqrt(result_cost));
+        return destination.size();
+    }
+
+    uint32_t
+    LodUtils::build_chain(
+        std::vector<uint32_t> &indices,
+        const float *positions,
+        size_t position_stride,
+        size_t vertex_count,
+        std::vector<Lod> &lods,
+        uint32_t max_lod_count,
+        float ratio,
+        float max_error,
+        uint32_t cache_size)
+    {
+        lods.clear();
+        if (indices.empty() || indices.size() % 3 != 0 || indices.size() > UINT32_MAX)
+            return 0;
+
+        const size_t original_count = indices.size();
+        lods.push_back({0, static_cast<uint32_t>(original_count), 0.0f, 0});
+        max_lod_count = std::min(max_lod_count, MAX_LOD_COUNT);
+
+        std::vector<uint32_t> simplified;
+        size_t triangle_target = original_count / 3;
+        for (uint32_t level = 1; level < max_lod_count; level++)
+        {
+            triangle_target = static_cast<size_t>(triangle_target * ratio);
+            if (triangle_target == 0)
+                break;
+
+            // 从上一级简化，误差上限扣除上一级已有的误差
+            const Lod previous = lods.back();
+            float error = 0.0f;
+            size_t count = simplify(
+                indices.data() + previous.m_first_index,
+                previous.m_index_count,
+                positions,
+                position_stride,
+                vertex_count,
+                triangle_target * 3,
+                max_error - previous.m_error,
+                simplified,
+                &error);
+
+            // 相对上一级减少不到10%时说明已达到误差上限或无法继续简化
+            if (count == 0 || count > previous.m_index_count * 0.9 ||
+                static_cast<uint64_t>(indices.size()) + count > UINT32_MAX)
+                break;
+
+            if (cache_size > 0)
+                MeshUtils::optimize_vertex_cache(simplified, vertex_count, cache_size);
+            Lod lod;
+            lod.m_first_index = static_cast<uint32_t>(indices.size());
+            lod.m_index_count = static_cast<uint32_t>(count);
+            lod.m_error = previous.m_error + error;
+            lods.push_back(lod);
+            indices.insert(indices.end(), simplified.begin(), simplified.end());
+        }
+
+        return static_cast<uint32_t>(lods.size());
+    }
+
+    float
+    LodUtils::get_projection_scale(
+        float fovy,
+        float viewport_height) noexcept
+    {
+        return viewport_height / (2.0f * std::tan(fovy * 0.5f));
+    }
+
+    uint32_t
+    LodUtils::select(
+        const Lod *lods,
+        uint32_t lod_count,
+        float distance,
+        float projection_scale,
+        float threshold,
+        uint32_t current,
+        float hysteresis) noexcept
+    {
+        if (lod_count == 0 || !(distance > 0.0f))
+            return 0;
+
+        // 误差投影不超过阈值即error * projection_scale <= threshold * distance，避免除法
+        auto coarsest = [&](float allowed)
+        {
+            uint32_t lod = 0;
+            while (lod + 1 < lod_count && lods[lod + 1].m_error * projection_scale <= allowed)
+                lod++;
+            return lod;
+        };
+
+        uint32_t fine = coarsest(threshold * distance);
+        if (current >= lod_count)
+            return fine;
+        uint32_t tight = coarsest(threshold * (1.0f - hysteresis) * distance);
+        return std::min(std::max(current, tight), fine);
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
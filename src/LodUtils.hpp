@@ -0,0 +1,130 @@
+#ifndef __VL_LODUTILS_HPP__
+#define __VL_LODUTILS_HPP__
+
+#include <cstdint>
+#include <vector>
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 细节层次(LOD)：用二次误差度量(QEM)的边折叠简化网格，并按投影到屏幕的误差选择层级
+    /// @details 边折叠把一个顶点合并到相邻的已有顶点上，不生成新顶点，所以各级LOD共用同一个顶点缓冲，
+    /// 只有索引不同；位置相同而属性不同的顶点(接缝)和非流形顶点不会移动，开放边界上的顶点只沿边界折叠
+    class LodUtils : public ntl::Object
+    {
+    public:
+        using SelfType = LodUtils;
+        using ParentType = ntl::Object;
+
+        /// @brief 一级LOD在索引缓冲中的范围
+        struct Lod
+        {
+            /// @brief 第一个索引
+            uint32_t m_first_index = 0;
+
+            /// @brief 索引数
+            uint32_t m_index_count = 0;
+
+            /// @brief 相对原网格的几何误差的估计，模型空间的距离，第0级为0，逐级不减
+            /// @details 由二次误差度量得到，是到原三角形平面距离的加权均方根，不是上界，实际的最大偏差可能略大
+            float m_error = 0.0f;
+
+            uint32_t m_reserved = 0;
+        };
+
+        /// @brief 最多的LOD级数
+        static constexpr uint32_t MAX_LOD_COUNT = 8;
+
+        /// @brief 默认每级保留的三角形比例
+        static constexpr float DEFAULT_LOD_RATIO = 0.5f;
+
+        /// @brief 默认允许的屏幕空间误差，像素
+        static constexpr float DEFAULT_PIXEL_THRESHOLD = 1.0f;
+
+    public:
+        constexpr LodUtils() noexcept = default;
+        constexpr explicit LodUtils(const SelfType &) noexcept = default;
+        ~LodUtils() override = default;
+
+    public:
+        constexpr SelfType &operator=(const SelfType &from) = default;
+
+    public:
+        /// @brief 简化网格
+        /// @details 每一轮按代价排序所有可折叠的边，不相邻的折叠依次执行，直到达到目标索引数或误差上限；
+        /// 会使三角形翻转的折叠被跳过，所以结果可能多于目标索引数
+        /// @param indices 三角形列表的索引
+        /// @param index_count 索引数
+        /// @param positions 位置，每个顶点3个float
+        /// @param position_stride 相邻两个位置之间的字节数
+        /// @param vertex_count 顶点数
+        /// @param target_index_count 目标索引数
+        /// @param target_error 误差上限，模型空间的距离
+        /// @param destination 输出的索引，引用原顶点
+        /// @param result_error 不为空时输出简化后的误差，即执行过的折叠中最大的二次误差的平方根
+        /// @return 输出的索引数，参数无效时为0
+        static size_t simplify(
+            const uint32_t *indices,
+            size_t index_count,
+            const float *positions,
+            size_t position_stride,
+            size_t vertex_count,
+            size_t target_index_count,
+            float target_error,
+            std::vector<uint32_t> &destination,
+            float *result_error = nullptr);
+
+        /// @brief 生成LOD链，第k级的目标三角形数为原网格的ratio^k
+        /// @details 每级从上一级简化，总耗时约为简化一次原网格的两倍；误差取逐级误差之和，作为相对原网格误差的估计；
+        /// 它不是上界，实际的最大偏差可能略大，需要严格保证屏幕空间误差时调小select的threshold
+        /// @param indices 原网格的索引，即第0级，各级LOD的索引依次追加在后面
+        /// @param positions 位置，每个顶点3个float
+        /// @param position_stride 相邻两个位置之间的字节数
+        /// @param vertex_count 顶点数
+        /// @param lods 输出的各级LOD
+        /// @param max_lod_count 最多级数，包括第0级，不超过MAX_LOD_COUNT
+        /// @param ratio 每级保留的三角形比例
+        /// @param max_error 误差上限，超过后不再生成更粗的级别
+        /// @param cache_size 不为0时对每级做顶点缓存优化
+        /// @return 级数
+        static uint32_t build_chain(
+            std::vector<uint32_t> &indices,
+            const float *positions,
+            size_t position_stride,
+            size_t vertex_count,
+            std::vector<Lod> &lods,
+            uint32_t max_lod_count = MAX_LOD_COUNT,
+            float ratio = DEFAULT_LOD_RATIO,
+            float max_error = 1e30f,
+            uint32_t cache_size = 16);
+
+        /// @brief 计算模型空间误差到像素的比例系数
+        /// @param fovy 垂直视野，弧度
+        /// @param viewport_height 视口高度，像素
+        /// @return 距离为1时1个单位的误差对应的像素数
+        static float get_projection_scale(float fovy, float viewport_height) noexcept;
+
+        /// @brief 按投影误差选择LOD：选择投影误差不超过threshold的最粗级别
+        /// @details 误差的投影为error * projection_scale / distance；current有效时带滞后，
+        /// 变粗需要投影误差不超过threshold * (1 - hysteresis)，变细在超过threshold时立即发生，
+        /// 所以在阈值附近来回移动时不会每帧切换，且估计误差的投影始终不超过threshold
+        /// @param lods 各级LOD
+        /// @param lod_count 级数
+        /// @param distance 相机到包围球的最近距离，相机在球内时传0或负数，总是选第0级
+        /// @param projection_scale get_projection_scale的结果，乘以模型的均匀缩放
+        /// @param threshold 允许的屏幕空间误差，像素
+        /// @param current 上一帧的级别，没有时为UINT32_MAX
+        /// @param hysteresis 滞后比例，0~1
+        /// @return 级别
+        static uint32_t select(
+            const Lod *lods,
+            uint32_t lod_count,
+            float distance,
+            float projection_scale,
+            float threshold = DEFAULT_PIXEL_THRESHOLD,
+            uint32_t current = UINT32_MAX,
+            float hysteresis = 0.0f) noexcept;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,134 @@
+#ifndef __VL_MAPPEDBUFFER_CPP__
+#define __VL_MAPPEDBUFFER_CPP__
+
+#include "MappedBuffer.hpp"
+#include "DeviceUtils.hpp"
+
+namespace vl
+{
+    vk::Result
+    MappedBuffer::create(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        vk::DeviceSize size,
+        vk::BufferUsageFlags usage,
+        vk::MemoryPropertyFlags preferred)
+    {
+        auto buffer_result = DeviceUtils::create_buffer(device, size, usage);
+        if (buffer_result.result != vk::Result::eSuccess)
+        {
+            ntl::log.loge(
+                NTL_STRING("MappedBuffer::create"),
+                ntl::StringUtils::to_string(
+                    NTL_STRING("Failed to create buffer, error code:"),
+                    static_cast<long>(buffer_result.result)));
+            return buffer_result.result;
+        }
+        m_buffer = buffer_result.value;
+
+        auto memory_result = DeviceUtils::allocate_buffer_memory(
+            device,
+            physical_device,
+            m_buffer,
+            preferred,
+            vk::MemoryPropertyFlagBits::eHostVisible);
+        if (memory_result.result != vk::Result::eSuccess)
+        {
+            destroy(device);
+            return memory_result.result;
+        }
+        m_memory = memory_result.value;
+
+        auto map_result = device.mapMemory(m_memory, 0, VK_WHOLE_SIZE);
+        if (map_result.result != vk::Result::eSuccess)
+        {
+            destroy(device);
+            return map_result.result;
+        }
+        m_mapped = map_result.value;
+        m_size = size;
+
+        // 按与分配时相同的顺序找到选中的内存类型，非一致内存需要手动刷新
+        vk::MemoryRequirements requirements = device.getBufferMemoryRequirements(m_buffer);
+        std::optional<uint32_t> type = DeviceUtils::find_memory_type(
+            physical_device,
+            requirements.memoryTypeBits,
+            preferred | vk::MemoryPropertyFlagBits::eHostVisible);
+        if (!type.has_value())
+            type = DeviceUtils::find_memory_type(
+                physical_device,
+                requirements.memoryTypeBits,
+                vk::MemoryPropertyFlagBits::eHostVisible);
+        vk::MemoryPropertyFlags flags = physical_device.getMemoryProperties().memoryTypes[*type].propertyFlags;
+        m_is_coherent = static_cast<bool>(flags & vk::MemoryPropertyFlagBits::eHostCoherent);
+        m_atom_size = physical_device.getProperties().limits.nonCoherentAtomSize;
+
+        return vk::Result::eSuccess;
+    }
+
+    void
+    MappedBuffer::destroy(
+        const vk::Device &device)
+    {
+        if (m_mapped != nullptr)
+            device.unmapMemory(m_memory);
+        if (m_buffer)
+            device.destroyBuffer(m_buffer);
+        if (m_memory)
+            device.freeMemory(m_memory);
+
+        m_buffer = nullptr;
+        m_memory = nullptr;
+        m_mapped = nullptr;
+        m_size = 0;
+    }
+
+    vk::Result
+    MappedBuffer::flush(
+        const vk::Device &device,
+        vk::DeviceSize offset,
+        vk::DeviceSize size)
+    {
+        if (m_is_coherent)
+            return vk::Result::eSuccess;
+        return device.flushMappedMemoryRanges(get_aligned_range(offset, size));
+    }
+
+    vk::Result
+    MappedBuffer::invalidate(
+        const vk::Device &device,
+        vk::DeviceSize offset,
+        vk::DeviceSize size)
+    {
+        if (m_is_coherent)
+            return vk::Result::eSuccess;
+        return device.invalidateMappedMemoryRanges(get_aligned_range(offset, size));
+    }
+
+    vk::MappedMemoryRange
+    MappedBuffer::get_aligned_range(
+        vk::DeviceSize offset,
+        vk::DeviceSize size) const
+    {
+        vk::MappedMemoryRange range;
+        range.setMemory(m_memory);
+
+        vk::DeviceSize begin = offset / m_atom_size * m_atom_size;
+        range.setOffset(begin);
+
+        if (size == VK_WHOLE_SIZE)
+            range.setSize(VK_WHOLE_SIZE);
+        else
+        {
+            vk::DeviceSize end = (offset + size + m_atom_size - 1) / m_atom_size * m_atom_size;
+            if (end >= m_size)
+                range.setSize(VK_WHOLE_SIZE);
+            else
+                range.setSize(end - begin);
+        }
+
+        return range;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef __VL_MAPPEDBUFFER_HPP__
+#define __VL_MAPPEDBUFFER_HPP__
+
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 持久映射的主机可见缓冲
+    class MappedBuffer : public ntl::Object
+    {
+    public:
+        using SelfType = MappedBuffer;
+        using ParentType = ntl::Object;
+
+    public:
+        /// @brief 缓冲
+        vk::Buffer m_buffer;
+
+        /// @brief 内存
+        vk::DeviceMemory m_memory;
+
+        /// @brief 大小
+        vk::DeviceSize m_size = 0;
+
+        /// @brief 映射的地址
+        void *m_mapped = nullptr;
+
+        /// @brief 内存是否主机一致
+        bool m_is_coherent = false;
+
+        /// @brief 非一致内存的刷新对齐
+        vk::DeviceSize m_atom_size = 1;
+
+    public:
+        MappedBuffer() = default;
+        explicit MappedBuffer(const SelfType &from) = default;
+        ~MappedBuffer() override = default;
+
+    public:
+        SelfType &operator=(const SelfType &from) = default;
+
+    public:
+        /// @brief 创建并映射缓冲
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param size 大小
+        /// @param usage 用途
+        /// @param preferred 优先选择的内存属性，例如HostCached
+        /// @return 结果
+        vk::Result create(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            vk::DeviceSize size,
+            vk::BufferUsageFlags usage,
+            vk::MemoryPropertyFlags preferred = vk::MemoryPropertyFlagBits::eHostCoherent);
+
+        /// @brief 取消映射并销毁缓冲
+        /// @param device 逻辑设备
+        void destroy(const vk::Device &device);
+
+        /// @brief 使主机写入对设备可见
+        /// @param device 逻辑设备
+        /// @param offset 偏移
+        /// @param size 大小
+        /// @return 结果
+        vk::Result flush(const vk::Device &device, vk::DeviceSize offset = 0, vk::DeviceSize size = VK_WHOLE_SIZE);
+
+        /// @brief 使设备写入对主机可见
+        /// @param device 逻辑设备
+        /// @param offset 偏移
+        /// @param size 大小
+        /// @return 结果
+        vk::Result invalidate(const vk::Device &device, vk::DeviceSize offset = 0, vk::DeviceSize size = VK_WHOLE_SIZE);
+
+        /// @brief 获取映射的地址
+        /// @tparam T 元素类型
+        /// @return 地址
+        template <typename T>
+        T *data() const noexcept { return static_cast<T *>(m_mapped); }
+
+    protected:
+        /// @brief 把范围扩展到刷新对齐
+        /// @param offset 偏移
+        /// @param size 大小
+        /// @return 对齐后的范围
+        vk::MappedMemoryRange get_aligned_range(vk::DeviceSize offset, vk::DeviceSize size) const;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,174 @@
+#ifndef __VL_MAPPEDFILE_CPP__
+#define __VL_MAPPEDFILE_CPP__
+
+#include <cstdio>
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+// winnt.h把MemoryBarrier定义为宏，之后的vk::MemoryBarrier会被替换
+#ifdef MemoryBarrier
+#undef MemoryBarrier
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vl
+{
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    bool
+    MappedFile::open(
+        const std::string &path,
+        Mode mode)
+    {
+        close();
+
+        if (mode == Mode::eRead)
+        {
+            std::FILE *file = std::fopen(path.c_str(), "rb");
+            if (file == nullptr)
+            {
+                ntl::log.loge(
+                    NTL_STRING("MappedFile::open"),
+                    NTL_STRING("Failed to open file"));
+                return false;
+            }
+            std::fseek(file, 0, SEEK_END);
+            long size = std::ftell(file);
+            std::fseek(file, 0, SEEK_SET);
+            m_buffer.resize(size > 0 ? static_cast<size_t>(size) : 0);
+            size_t read = m_buffer.empty() ? 0 : std::fread(m_buffer.data(), 1, m_buffer.size(), file);
+            std::fclose(file);
+            if (m_buffer.empty() || read != m_buffer.size())
+            {
+                ntl::log.loge(
+                    NTL_STRING("MappedFile::open"),
+                    NTL_STRING("Failed to read file"));
+                close();
+                return false;
+            }
+
+            m_data = m_buffer.data();
+            m_size = m_buffer.size();
+            return true;
+        }
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            ntl::log.loge(
+                NTL_STRING("MappedFile::open"),
+                NTL_STRING("Failed to open file"));
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        {
+            m_mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_mapping_handle != nullptr)
+                m_mapped = MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0);
+        }
+        // 映射会保持文件打开
+        CloseHandle(file);
+        m_size = m_mapped != nullptr ? static_cast<size_t>(size.QuadPart) : 0;
+#else
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            ntl::log.loge(
+                NTL_STRING("MappedFile::open"),
+                NTL_STRING("Failed to open file"));
+            return false;
+        }
+        struct stat status;
+        if (fstat(file, &status) == 0 && status.st_size > 0)
+        {
+            void *mapped = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapped != MAP_FAILED)
+            {
+                m_mapped = mapped;
+                m_size = static_cast<size_t>(status.st_size);
+                // 内容通常整块顺序读取
+                madvise(m_mapped, m_size, MADV_SEQUENTIAL);
+            }
+        }
+        // 映射会保持文件打开
+        ::close(file);
+#endif
+        if (m_mapped == nullptr)
+        {
+            ntl::log.loge(
+                NTL_STRING("MappedFile::open"),
+                NTL_STRING("Failed to map file"));
+            close();
+            return false;
+        }
+        m_data = static_cast<const uint8_t *>(m_mapped);
+        return true;
+    }
+
+    void
+    MappedFile::close() noexcept
+    {
+        if (m_mapped != nullptr)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(m_mapped);
+#else
+            munmap(m_mapped, m_size);
+#endif
+        }
+#ifdef _WIN32
+        if (m_mapping_handle != nullptr)
+            CloseHandle(m_mapping_handle);
+#endif
+
+        m_mapped = nullptr;
+        m_mapping_handle = nullptr;
+        m_buffer.clear();
+        m_buffer.shrink_to_fit();
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    bool
+    MappedFile::is_open() const noexcept
+    {
+        return m_data != nullptr;
+    }
+
+    bool
+    MappedFile::is_mapped() const noexcept
+    {
+        return m_mapped != nullptr;
+    }
+
+    const uint8_t *
+    MappedFile::get_data() const noexcept
+    {
+        return m_data;
+    }
+
+    size_t
+    MappedFile::get_size() const noexcept
+    {
+        return m_size;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef __VL_MAPPEDFILE_HPP__
+#define __VL_MAPPEDFILE_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 只读打开的文件，默认用内存映射，也可以整个读入内部缓冲
+    class MappedFile : public ntl::Object
+    {
+    public:
+        using SelfType = MappedFile;
+        using ParentType = ntl::Object;
+
+        /// @brief 打开方式
+        enum class Mode
+        {
+            /// @brief 内存映射
+            eMap,
+            /// @brief 读入内部缓冲
+            eRead,
+        };
+
+    protected:
+        /// @brief 文件的全部内容
+        const uint8_t *m_data = nullptr;
+        size_t m_size = 0;
+
+        /// @brief Mode::eRead时的缓冲
+        std::vector<uint8_t> m_buffer;
+
+        /// @brief 映射的地址，未映射时为空
+        void *m_mapped = nullptr;
+
+        /// @brief Windows下的文件映射对象
+        void *m_mapping_handle = nullptr;
+
+    public:
+        MappedFile() = default;
+        ~MappedFile() override;
+
+        MappedFile(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 打开文件，空文件视为失败
+        /// @param path 路径
+        /// @param mode 打开方式
+        /// @return 是否成功
+        bool open(const std::string &path, Mode mode = Mode::eMap);
+
+        /// @brief 关闭
+        void close() noexcept;
+
+        /// @brief 是否已打开
+        /// @return 是否已打开
+        bool is_open() const noexcept;
+
+        /// @brief 是否为内存映射
+        /// @return 是否为内存映射
+        bool is_mapped() const noexcept;
+
+        /// @brief 获取内容，映射按页对齐，缓冲按max_align_t对齐
+        /// @return 内容，未打开时为空
+        const uint8_t *get_data() const noexcept;
+
+        /// @brief 获取字节数
+        /// @return 字节数
+        size_t get_size() const noexcept;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
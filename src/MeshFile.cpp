@@ -0,0 +1,357 @@
+#ifndef __VL_MESHFILE_CPP__
+#define __VL_MESHFILE_CPP__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "MeshFile.hpp"
+
+namespace vl
+{
+    static_assert(sizeof(MeshFile::Header) == 144, "MeshFile::Header must be packed");
+    static_assert(sizeof(MeshFile::Chunk) == 24, "MeshFile::Chunk must be packed");
+
+    MeshFile::~MeshFile()
+    {
+        close();
+    }
+
+    bool
+    MeshFile::open(
+        const std::string &path,
+        Mode mode)
+    {
+        close();
+        if (!m_file.open(path, mode))
+            return false;
+
+        m_data = m_file.get_data();
+        m_size = m_file.get_size();
+        if (!parse())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool
+    MeshFile::open_memory(
+        const void *data,
+        size_t size)
+    {
+        close();
+        m_data = static_cast<const uint8_t *>(data);
+        m_size = size;
+        if (!parse())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void
+    MeshFile::close() noexcept
+    {
+        m_file.close();
+        m_data = nullptr;
+        m_size = 0;
+        m_header = nullptr;
+        m_chunks = nullptr;
+    }
+
+    bool
+    MeshFile::is_open() const noexcept
+    {
+        return m_header != nullptr;
+    }
+
+    const MeshFile::Header &
+    MeshFile::get_header() const noexcept
+    {
+        return *m_header;
+    }
+
+    const MeshFile::Chunk *
+    MeshFile::get_chunks() const noexcept
+    {
+        return m_chunks;
+    }
+
+    const MeshFile::Chunk *
+    MeshFile::find_chunk(uint32_t type) const noexcept
+    {
+        if (m_header == nullptr)
+            return nullptr;
+        for (uint32_t i = 0; i < m_header->m_chunk_count; i++)
+            if (m_chunks[i].m_type == type)
+                return &m_chunks[i];
+        return nullptr;
+    }
+
+    const void *
+    MeshFile::get_chunk_data(const Chunk &chunk) const noexcept
+    {
+        return m_data + chunk.m_offset;
+    }
+
+    void
+    MeshFile::get_layout(VertexLayout &layout) const
+    {
+        layout.clear();
+        for (uint32_t i = 0; i < m_header->m_element_count; i++)
+        {
+            const Element &element = m_header->m_elements[i];
+            layout.add(
+                static_cast<VertexLayout::Attribute>(element.m_attribute),
+                static_cast<VertexLayout::Encoding>(element.m_encoding),
+                element.m_location);
+        }
+    }
+
+    std::optional<StagingRing::Allocation>
+    MeshFile::stage_chunk(
+        StagingRing &ring,
+        uint32_t type,
+        vk::DeviceSize alignment) const
+    {
+        const Chunk *chunk = find_chunk(type);
+        if (chunk == nullptr)
+            return std::nullopt;
+
+        std::optional<StagingRing::Allocation> allocation = ring.allocate(chunk->m_size, alignment);
+        if (allocation.has_value())
+            std::memcpy(allocation->m_pointer, get_chunk_data(*chunk), static_cast<size_t>(chunk->m_size));
+        return allocation;
+    }
+
+    bool
+    MeshFile::parse()
+    {
+        auto fail = [](const ntl::String &message)
+        {
+            ntl::log.loge(
+                NTL_STRING("MeshFile::parse"),
+                message);
+            return false;
+        };
+
+        if (m_data == nullptr || m_size < sizeof(Header))
+            return fail(NTL_STRING("File is too small"));
+
+        // 直接按结构读取，映射按页对齐，std::vector按max_align_t对齐
+        if (reinterpret_cast<uintptr_t>(m_data) % alignof(Chunk) != 0)
+            return fail(NTL_STRING("Data is not aligned"));
+        const Header *header = reinterpret_cast<const Header *>(m_data);
+        if (header->m_magic != MAGIC)
+            return fail(NTL_STRING("Invalid magic"));
+        if (header->m_version != VERSION)
+            return fail(NTL_STRING("Unsupported version"));
+        if (header->m_chunk_count > MAX_CHUNK_COUNT)
+            return fail(NTL_STRING("Too many chunks"));
+        if (header->m_element_count > MAX_ELEMENT_COUNT)
+            return fail(NTL_STRING("Too many vertex elements"));
+        if (m_size < sizeof(Header) + sizeof(Chunk) * header->m_chunk_count)
+            return fail(NTL_STRING("Chunk table is truncated"));
+
+        // 布局必须能还原出相同的步长
+        VertexLayout layout;
+        for (uint32_t i = 0; i < header->m_element_count; i++)
+        {
+            const Element &element = header->m_elements[i];
+            if (element.m_attribute >= VertexLayout::ATTRIBUTE_COUNT || element.m_encoding > VertexLayout::ENCODING_QUANTIZED)
+                return fail(NTL_STRING("Invalid vertex element"));
+            layout.add(
+                static_cast<VertexLayout::Attribute>(element.m_attribute),
+                static_cast<VertexLayout::Encoding>(element.m_encoding),
+                element.m_location);
+        }
+        if (layout.get_stride(0) != header->m_vertex_stride)
+            return fail(NTL_STRING("Vertex stride does not match the layout"));
+        if (header->m_index_size != 2 && header->m_index_size != 4)
+            return fail(NTL_STRING("Invalid index size"));
+
+        const Chunk *chunks = reinterpret_cast<const Chunk *>(m_data + sizeof(Header));
+        for (uint32_t i = 0; i < header->m_chunk_count; i++)
+        {
+            const Chunk &chunk = chunks[i];
+            if (chunk.m_offset % ALIGNMENT != 0)
+                return fail(NTL_STRING("Chunk is not aligned"));
+            if (chunk.m_offset > m_size || chunk.m_size > m_size - chunk.m_offset)
+                return fail(NTL_STRING("Chunk is out of range"));
+            if (chunk.m_type == CHUNK_VERTICES &&
+                chunk.m_size != static_cast<uint64_t>(header->m_vertex_count) * header->m_vertex_stride)
+                return fail(NTL_STRING("Vertex chunk size does not match the header"));
+            if (chunk.m_type == CHUNK_INDICES &&
+                chunk.m_size != static_cast<uint64_t>(header->m_index_count) * header->m_index_size)
+                return fail(NTL_STRING("Index chunk size does not match the header"));
+        }
+
+        // LOD从第0级开始，每级的范围在索引块内，误差逐级不减
+        uint64_t base_index_count = header->m_index_count;
+        const Chunk *lods = nullptr;
+        for (uint32_t i = 0; i < header->m_chunk_count && lods == nullptr; i++)
+            if (chunks[i].m_type == CHUNK_LODS)
+                lods = &chunks[i];
+        if (lods != nullptr)
+        {
+            if (lods->m_count == 0 || lods->m_count > LodUtils::MAX_LOD_COUNT ||
+                lods->m_size != static_cast<uint64_t>(lods->m_count) * sizeof(LodUtils::Lod))
+                return fail(NTL_STRING("LOD chunk size does not match its count"));
+
+            const LodUtils::Lod *list = reinterpret_cast<const LodUtils::Lod *>(m_data + lods->m_offset);
+            if (list[0].m_first_index != 0 || list[0].m_error != 0.0f)
+                return fail(NTL_STRING("LOD 0 must start at the first index"));
+            for (uint32_t i = 0; i < lods->m_count; i++)
+                if (list[i].m_index_count == 0 || list[i].m_index_count % 3 != 0 ||
+                    static_cast<uint64_t>(list[i].m_first_index) + list[i].m_index_count > header->m_index_count ||
+                    !(list[i].m_error >= (i > 0 ? list[i - 1].m_error : 0.0f)))
+                    return fail(NTL_STRING("LOD is out of range"));
+            base_index_count = list[0].m_index_count;
+        }
+
+        // 簇的四个块同时存在，只检查每个簇的范围，不检查局部索引的内容
+        const Chunk *meshlet_chunks[4] = {nullptr, nullptr, nullptr, nullptr};
+        for (uint32_t i = 0; i < header->m_chunk_count; i++)
+            if (chunks[i].m_type >= CHUNK_MESHLETS && chunks[i].m_type <= CHUNK_MESHLET_TRIANGLES &&
+                meshlet_chunks[chunks[i].m_type - CHUNK_MESHLETS] == nullptr)
+                meshlet_chunks[chunks[i].m_type - CHUNK_MESHLETS] = &chunks[i];
+        if (meshlet_chunks[0] || meshlet_chunks[1] || meshlet_chunks[2] || meshlet_chunks[3])
+        {
+            if (!meshlet_chunks[0] || !meshlet_chunks[1] || !meshlet_chunks[2] || !meshlet_chunks[3])
+                return fail(NTL_STRING("Meshlet chunks are incomplete"));
+
+            const Chunk &meshlets = *meshlet_chunks[0];
+            const Chunk &bounds = *meshlet_chunks[1];
+            const Chunk &vertices = *meshlet_chunks[2];
+            const Chunk &triangles = *meshlet_chunks[3];
+            if (meshlets.m_size != static_cast<uint64_t>(meshlets.m_count) * sizeof(MeshletUtils::Meshlet) ||
+                bounds.m_count != meshlets.m_count ||
+                bounds.m_size != static_cast<uint64_t>(bounds.m_count) * sizeof(MeshletUtils::Bounds) ||
+                vertices.m_size != static_cast<uint64_t>(vertices.m_count) * sizeof(uint32_t) ||
+                triangles.m_size != static_cast<uint64_t>(triangles.m_count) * 3)
+                return fail(NTL_STRING("Meshlet chunk size does not match its count"));
+            if (static_cast<uint64_t>(triangles.m_count) * 3 != base_index_count)
+                return fail(NTL_STRING("Meshlet triangles do not match the index count"));
+
+            const MeshletUtils::Meshlet *list = reinterpret_cast<const MeshletUtils::Meshlet *>(m_data + meshlets.m_offset);
+            for (uint32_t i = 0; i < meshlets.m_count; i++)
+                if (list[i].m_vertex_count > MeshletUtils::MAX_VERTEX_LIMIT ||
+                    static_cast<uint64_t>(list[i].m_vertex_offset) + list[i].m_vertex_count > vertices.m_count ||
+                    static_cast<uint64_t>(list[i].m_triangle_offset) + list[i].m_triangle_count > triangles.m_count)
+                    return fail(NTL_STRING("Meshlet is out of range"));
+        }
+
+        m_header = header;
+        m_chunks = chunks;
+        return true;
+    }
+
+    bool
+    MeshFile::set_layout(
+        const VertexLayout &layout,
+        Header &header)
+    {
+        const std::vector<VertexLayout::Element> &elements = layout.get_elements();
+        if (elements.size() > MAX_ELEMENT_COUNT)
+            return false;
+
+        for (size_t i = 0; i < elements.size(); i++)
+        {
+            if (elements[i].m_binding != 0 || elements[i].m_location > UINT8_MAX)
+                return false;
+            header.m_elements[i].m_attribute = static_cast<uint8_t>(elements[i].m_attribute);
+            header.m_elements[i].m_encoding = static_cast<uint8_t>(elements[i].m_encoding);
+            header.m_elements[i].m_location = static_cast<uint8_t>(elements[i].m_location);
+        }
+        header.m_element_count = static_cast<uint32_t>(elements.size());
+        header.m_vertex_stride = layout.get_stride(0);
+        return true;
+    }
+
+    void
+    MeshFile::compute_bounds(
+        const float *positions,
+        size_t vertex_count,
+        Header &header) noexcept
+    {
+        if (vertex_count == 0)
+            return;
+
+        std::copy(positions, positions + 3, header.m_bounds_min);
+        std::copy(positions, positions + 3, header.m_bounds_max);
+        for (size_t v = 1; v < vertex_count; v++)
+            for (size_t k = 0; k < 3; k++)
+            {
+                header.m_bounds_min[k] = std::min(header.m_bounds_min[k], positions[v * 3 + k]);
+                header.m_bounds_max[k] = std::max(header.m_bounds_max[k], positions[v * 3 + k]);
+            }
+
+        // 以包围盒中心为球心，半径为最远的顶点
+        float radius_squared = 0.0f;
+        for (size_t k = 0; k < 3; k++)
+            header.m_sphere[k] = (header.m_bounds_min[k] + header.m_bounds_max[k]) * 0.5f;
+        for (size_t v = 0; v < vertex_count; v++)
+        {
+            float dx = positions[v * 3] - header.m_sphere[0];
+            float dy = positions[v * 3 + 1] - header.m_sphere[1];
+            float dz = positions[v * 3 + 2] - header.m_sphere[2];
+            radius_squared = std::max(radius_squared, dx * dx + dy * dy + dz * dz);
+        }
+        header.m_sphere[3] = std::sqrt(radius_squared);
+    }
+
+    bool
+    MeshFile::write(
+        const std::string &path,
+        Header header,
+        const std::vector<ChunkSource> &chunks)
+    {
+        if (chunks.size() > MAX_CHUNK_COUNT)
+            return false;
+
+        header.m_magic = MAGIC;
+        header.m_version = VERSION;
+        header.m_chunk_count = static_cast<uint32_t>(chunks.size());
+
+        // 块表之后按对齐依次放置块
+        std::vector<Chunk> table(chunks.size());
+        uint64_t offset = sizeof(Header) + sizeof(Chunk) * chunks.size();
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            offset = (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+            table[i].m_type = chunks[i].m_type;
+            table[i].m_count = chunks[i].m_count;
+            table[i].m_offset = offset;
+            table[i].m_size = chunks[i].m_size;
+            offset += chunks[i].m_size;
+        }
+
+        std::ofstream fout(path, std::ios::binary);
+        if (!fout)
+        {
+            ntl::log.loge(
+                NTL_STRING("MeshFile::write"),
+                NTL_STRING("Failed to open file"));
+            return false;
+        }
+
+        static const char padding[ALIGNMENT] = {};
+        uint64_t position = sizeof(Header) + sizeof(Chunk) * chunks.size();
+        fout.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        fout.write(reinterpret_cast<const char *>(table.data()), static_cast<std::streamsize>(sizeof(Chunk) * table.size()));
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            fout.write(padding, static_cast<std::streamsize>(table[i].m_offset - position));
+            fout.write(static_cast<const char *>(chunks[i].m_data), static_cast<std::streamsize>(chunks[i].m_size));
+            position = table[i].m_offset + table[i].m_size;
+        }
+
+        return static_cast<bool>(fout);
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,225 @@
+#ifndef __VL_MESHFILE_HPP__
+#define __VL_MESHFILE_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <optional>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "VertexLayout.hpp"
+#include "MeshletUtils.hpp"
+#include "LodUtils.hpp"
+#include "StagingRing.hpp"
+#include "MappedFile.hpp"
+
+namespace vl
+{
+    /// @brief 二进制网格文件
+    /// @details 文件由文件头、块表和若干按ALIGNMENT对齐的块组成，数值均为小端序。
+    /// 默认用内存映射打开，块的数据从映射直接复制到暂存环，不经过中间的std::vector
+    class MeshFile : public ntl::Object
+    {
+    public:
+        using SelfType = MeshFile;
+        using ParentType = ntl::Object;
+
+        /// @brief 打开方式
+        using Mode = MappedFile::Mode;
+
+        /// @brief 块类型
+        enum ChunkType : uint32_t
+        {
+            /// @brief 顶点，按文件头中的布局交错存放
+            CHUNK_VERTICES = 1,
+            /// @brief 索引，每个索引index_size字节；有簇时按簇的顺序存放；有LOD时各级依次存放，第0级在前
+            CHUNK_INDICES = 2,
+            /// @brief 簇，MeshletUtils::Meshlet数组
+            CHUNK_MESHLETS = 3,
+            /// @brief 簇的包围体，MeshletUtils::Bounds数组，与CHUNK_MESHLETS一一对应
+            CHUNK_MESHLET_BOUNDS = 4,
+            /// @brief 簇顶点，uint32_t数组
+            CHUNK_MESHLET_VERTICES = 5,
+            /// @brief 簇的局部索引，uint8_t数组，每个三角形3个
+            CHUNK_MESHLET_TRIANGLES = 6,
+            /// @brief LOD链，LodUtils::Lod数组，范围指向CHUNK_INDICES；簇只描述第0级
+            CHUNK_LODS = 7,
+        };
+
+        /// @brief 顶点布局中的一个属性
+        struct Element
+        {
+            uint8_t m_attribute = 0;
+            uint8_t m_encoding = 0;
+            uint8_t m_location = 0;
+            uint8_t m_reserved = 0;
+        };
+
+        /// @brief 最多的顶点属性数
+        static constexpr uint32_t MAX_ELEMENT_COUNT = 8;
+
+        /// @brief 文件头
+        struct Header
+        {
+            uint32_t m_magic = 0;
+            uint32_t m_version = 0;
+            uint32_t m_chunk_count = 0;
+            uint32_t m_element_count = 0;
+
+            uint32_t m_vertex_count = 0;
+
+            /// @brief 索引数，有LOD时为各级之和
+            uint32_t m_index_count = 0;
+            uint32_t m_vertex_stride = 0;
+
+            /// @brief 每个索引的字节数，2或4
+            uint32_t m_index_size = 4;
+
+            /// @brief 顶点布局，只有绑定0
+            Element m_elements[MAX_ELEMENT_COUNT];
+
+            /// @brief 量化参数
+            VertexLayout::Quantization m_quantization;
+
+            /// @brief 轴对齐包围盒
+            float m_bounds_min[3] = {0.0f, 0.0f, 0.0f};
+            float m_bounds_max[3] = {0.0f, 0.0f, 0.0f};
+
+            /// @brief 包围球，中心和半径
+            float m_sphere[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        };
+
+        /// @brief 块表中的一项
+        struct Chunk
+        {
+            uint32_t m_type = 0;
+
+            /// @brief 块中元素的数量
+            uint32_t m_count = 0;
+
+            /// @brief 相对文件开头的偏移
+            uint64_t m_offset = 0;
+
+            /// @brief 字节数
+            uint64_t m_size = 0;
+        };
+
+        /// @brief 写入时的一个块
+        struct ChunkSource
+        {
+            uint32_t m_type = 0;
+            uint32_t m_count = 0;
+            const void *m_data = nullptr;
+            uint64_t m_size = 0;
+        };
+
+        /// @brief 文件标识"VLMS"
+        static constexpr uint32_t MAGIC = 0x534D4C56;
+
+        /// @brief 版本
+        static constexpr uint32_t VERSION = 1;
+
+        /// @brief 块的对齐，满足缓存行和所有顶点格式的对齐
+        static constexpr uint64_t ALIGNMENT = 64;
+
+        /// @brief 最多的块数
+        static constexpr uint32_t MAX_CHUNK_COUNT = 64;
+
+    protected:
+        /// @brief 文件的全部内容
+        const uint8_t *m_data = nullptr;
+        size_t m_size = 0;
+
+        const Header *m_header = nullptr;
+        const Chunk *m_chunks = nullptr;
+
+        /// @brief open打开的文件，open_memory时不使用
+        MappedFile m_file;
+
+    public:
+        MeshFile() = default;
+        ~MeshFile() override;
+
+        MeshFile(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 打开并检查文件
+        /// @param path 路径
+        /// @param mode 打开方式
+        /// @return 是否成功
+        bool open(const std::string &path, Mode mode = Mode::eMap);
+
+        /// @brief 使用内存中的文件内容，不复制，内存需要在close前保持有效
+        /// @param data 内容，至少按8字节对齐
+        /// @param size 字节数
+        /// @return 是否通过检查
+        bool open_memory(const void *data, size_t size);
+
+        /// @brief 关闭
+        void close() noexcept;
+
+        /// @brief 是否已打开
+        /// @return 是否已打开
+        bool is_open() const noexcept;
+
+        /// @brief 获取文件头，需要已打开
+        /// @return 文件头
+        const Header &get_header() const noexcept;
+
+        /// @brief 获取块表
+        /// @return 块表，共get_header().m_chunk_count项
+        const Chunk *get_chunks() const noexcept;
+
+        /// @brief 查找第一个指定类型的块
+        /// @param type 类型
+        /// @return 块，不存在时为空
+        const Chunk *find_chunk(uint32_t type) const noexcept;
+
+        /// @brief 获取块的数据
+        /// @param chunk 块
+        /// @return 数据，对齐到ALIGNMENT
+        const void *get_chunk_data(const Chunk &chunk) const noexcept;
+
+        /// @brief 按文件头还原顶点布局
+        /// @param layout 输出的布局
+        void get_layout(VertexLayout &layout) const;
+
+        /// @brief 把一个块直接从文件复制到暂存环
+        /// @param ring 暂存环
+        /// @param type 块类型
+        /// @param alignment 对齐
+        /// @return 分配，块不存在或暂存环空间不足时为空
+        std::optional<StagingRing::Allocation> stage_chunk(
+            StagingRing &ring,
+            uint32_t type,
+            vk::DeviceSize alignment = 16) const;
+
+    public:
+        /// @brief 把顶点布局写入文件头，只支持绑定0
+        /// @param layout 布局
+        /// @param header 文件头
+        /// @return 是否成功
+        static bool set_layout(const VertexLayout &layout, Header &header);
+
+        /// @brief 计算包围盒和包围球
+        /// @param positions 位置，每个顶点3个float
+        /// @param vertex_count 顶点数
+        /// @param header 文件头
+        static void compute_bounds(const float *positions, size_t vertex_count, Header &header) noexcept;
+
+        /// @brief 写入文件，文件头中的标识、版本和块数由此函数填写
+        /// @param path 路径
+        /// @param header 文件头
+        /// @param chunks 块
+        /// @return 是否成功
+        static bool write(const std::string &path, Header header, const std::vector<ChunkSource> &chunks);
+
+    protected:
+        /// @brief 检查m_data中的文件头和块表
+        /// @return 是否通过
+        bool parse();
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,346 @@
+#ifndef __VL_MESHUTILS_CPP__
+#define __VL_MESHUTILS_CPP__
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include "MeshUtils.hpp"
+
+namespace vl
+{
+    uint64_t
+    MeshUtils::hash_bytes(
+        const uint8_t *data,
+        size_t size) noexcept
+    {
+        // 顶点一般由若干个4字节分量组成，按4字节做FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4)
+        {
+            uint32_t word;
+            std::memcpy(&word, data + i, 4);
+            hash ^= word;
+            hash *= 1099511628211ull;
+        }
+        for (; i < size; i++)
+        {
+            hash ^= data[i];
+            hash *= 1099511628211ull;
+        }
+        return hash ^ (hash >> 29);
+    }
+
+    size_t
+    MeshUtils::generate_remap(
+        const void *vertices,
+        size_t vertex_count,
+        size_t vertex_size,
+        std::vector<uint32_t> &remap)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(vertices);
+        remap.assign(vertex_count, UINT32_MAX);
+
+        // 开放寻址哈希表，存放每个唯一顶点第一次出现的位置
+        size_t table_size = 1;
+        while (table_size < vertex_count * 2)
+            table_size <<= 1;
+        std::vector<uint32_t> table(table_size, UINT32_MAX);
+        const size_t mask = table_size - 1;
+
+        size_t unique_count = 0;
+        for (size_t i = 0; i < vertex_count; i++)
+        {
+            const uint8_t *vertex = bytes + i * vertex_size;
+            size_t slot = static_cast<size_t>(hash_bytes(vertex, vertex_size)) & mask;
+            while (table[slot] != UINT32_MAX &&
+                   std::memcmp(bytes + static_cast<size_t>(table[slot]) * vertex_size, vertex, vertex_size) != 0)
+                slot = (slot + 1) & mask;
+
+            if (table[slot] == UINT32_MAX)
+            {
+                table[slot] = static_cast<uint32_t>(i);
+                remap[i] = static_cast<uint32_t>(unique_count++);
+            }
+            else
+                remap[i] = remap[table[slot]];
+        }
+
+        return unique_count;
+    }
+
+    void
+    MeshUtils::remap_vertices(
+        const void *vertices,
+        size_t vertex_count,
+        size_t vertex_size,
+        const std::vector<uint32_t> &remap,
+        void *destination) noexcept
+    {
+        const uint8_t *source = static_cast<const uint8_t *>(vertices);
+        uint8_t *target = static_cast<uint8_t *>(destination);
+        for (size_t i = 0; i < vertex_count; i++)
+            if (remap[i] != UINT32_MAX)
+                std::memcpy(target + static_cast<size_t>(remap[i]) * vertex_size, source + i * vertex_size, vertex_size);
+    }
+
+    size_t
+    MeshUtils::weld(
+        const void *vertices,
+        size_t vertex_count,
+        size_t vertex_size,
+        std::vector<uint8_t> &welded,
+        std::vector<uint32_t> &indices)
+    {
+        size_t unique_count = generate_remap(vertices, vertex_count, vertex_size, indices);
+        welded.resize(unique_count * vertex_size);
+        remap_vertices(vertices, vertex_count, vertex_size, indices, welded.data());
+        return unique_count;
+    }
+
+    void
+    MeshUtils::optimize_vertex_cache(
+        std::vector<uint32_t> &indices,
+        size_t vertex_count,
+        uint32_t cache_size,
+        std::vector<uint32_t> *clusters)
+    {
+        // Sander et al. 2007, Fast Triangle Reordering for Vertex Locality and Reduced Overdraw
+        const size_t triangle_count = indices.size() / 3;
+        if (clusters)
+            clusters->clear();
+        if (triangle_count == 0)
+            return;
+
+        // 顶点到三角形的邻接表
+        std::vector<uint32_t> live(vertex_count, 0);
+        for (size_t i = 0; i < triangle_count * 3; i++)
+            live[indices[i]]++;
+        std::vector<uint32_t> offsets(vertex_count + 1, 0);
+        for (size_t v = 0; v < vertex_count; v++)
+            offsets[v + 1] = offsets[v] + live[v];
+        std::vector<uint32_t> adjacency(triangle_count * 3);
+        {
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t t = 0; t < triangle_count; t++)
+                for (size_t k = 0; k < 3; k++)
+                    adjacency[cursor[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+        }
+
+        // 时间戳：当前时间减去顶点进入缓存的时间大于cache_size时认为已被挤出
+        std::vector<uint32_t> cache_time(vertex_count, 0);
+        uint32_t timestamp = cache_size + 1;
+        std::vector<bool> is_emitted(triangle_count, false);
+        std::vector<uint32_t> dead_end;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> result;
+        result.reserve(triangle_count * 3);
+
+        size_t cursor = 0;
+        int64_t fanning = 0;
+        bool is_jump = true;
+        while (fanning >= 0)
+        {
+            // 跳到不在缓存中的顶点时开始新的簇
+            if (is_jump && clusters && (clusters->empty() || clusters->back() != result.size() / 3))
+                clusters->push_back(static_cast<uint32_t>(result.size() / 3));
+
+            uint32_t vertex = static_cast<uint32_t>(fanning);
+            candidates.clear();
+            for (uint32_t a = offsets[vertex]; a < offsets[vertex + 1]; a++)
+            {
+                uint32_t t = adjacency[a];
+                if (is_emitted[t])
+                    continue;
+                is_emitted[t] = true;
+
+                for (size_t k = 0; k < 3; k++)
+                {
+                    uint32_t v = indices[t * 3 + k];
+                    result.push_back(v);
+                    dead_end.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (timestamp - cache_time[v] > cache_size)
+                        cache_time[v] = timestamp++;
+                }
+            }
+
+            // 优先选择仍在缓存中、且扇出完它的三角形后不会被挤出的顶点
+            int64_t next = -1;
+            int64_t best_priority = -1;
+            for (uint32_t v : candidates)
+            {
+                if (live[v] == 0)
+                    continue;
+                int64_t priority = 0;
+                if (timestamp - cache_time[v] + 2 * live[v] <= cache_size)
+                    priority = timestamp - cache_time[v];
+                if (priority > best_priority)
+                {
+                    best_priority = priority;
+                    next = v;
+                }
+            }
+
+            is_jump = false;
+            if (next == -1)
+            {
+                // 死路：先回到最近用过的顶点，再按顺序找还有三角形的顶点
+                while (!dead_end.empty())
+                {
+                    uint32_t v = dead_end.back();
+                    dead_end.pop_back();
+                    if (live[v] > 0)
+                    {
+                        next = v;
+                        break;
+                    }
+                }
+                if (next == -1)
+                {
+                    while (cursor < vertex_count && live[cursor] == 0)
+                        cursor++;
+                    if (cursor < vertex_count)
+                        next = static_cast<int64_t>(cursor);
+                }
+
+                // 跳到已不在缓存中的顶点，缓存从头开始
+                is_jump = next != -1 && timestamp - cache_time[next] > cache_size;
+            }
+            fanning = next;
+        }
+
+        indices.swap(result);
+    }
+
+    void
+    MeshUtils::optimize_overdraw(
+        std::vector<uint32_t> &indices,
+        const float *positions,
+        size_t position_stride,
+        size_t vertex_count,
+        const std::vector<uint32_t> &clusters)
+    {
+        const size_t triangle_count = indices.size() / 3;
+        if (clusters.size() < 2)
+            return;
+
+        const uint8_t *base = reinterpret_cast<const uint8_t *>(positions);
+        auto position = [&](uint32_t v)
+        {
+            return reinterpret_cast<const float *>(base + static_cast<size_t>(v) * position_stride);
+        };
+
+        // 整个网格的中心
+        float center[3] = {0.0f, 0.0f, 0.0f};
+        for (size_t v = 0; v < vertex_count; v++)
+            for (size_t k = 0; k < 3; k++)
+                center[k] += position(static_cast<uint32_t>(v))[k];
+        for (size_t k = 0; k < 3; k++)
+            center[k] /= static_cast<float>(std::max<size_t>(vertex_count, 1));
+
+        // 每个簇的面积加权中心与法线，度量为(簇中心 - 网格中心)·法线，越朝外越先画
+        const size_t cluster_count = clusters.size();
+        std::vector<float> sort_keys(cluster_count);
+        for (size_t c = 0; c < cluster_count; c++)
+        {
+            size_t begin = clusters[c];
+            size_t end = c + 1 < cluster_count ? clusters[c + 1] : triangle_count;
+            float cluster_center[3] = {0.0f, 0.0f, 0.0f};
+            float normal[3] = {0.0f, 0.0f, 0.0f};
+            float area = 0.0f;
+            for (size_t t = begin; t < end; t++)
+            {
+                const float *a = position(indices[t * 3 + 0]);
+                const float *b = position(indices[t * 3 + 1]);
+                const float *c2 = position(indices[t * 3 + 2]);
+                float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+                float e2[3] = {c2[0] - a[0], c2[1] - a[1], c2[2] - a[2]};
+                float n[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                              e1[2] * e2[0] - e1[0] * e2[2],
+                              e1[0] * e2[1] - e1[1] * e2[0]};
+                float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                for (size_t k = 0; k < 3; k++)
+                {
+                    cluster_center[k] += (a[k] + b[k] + c2[k]) * (length / 3.0f);
+                    normal[k] += n[k];
+                }
+                area += length;
+            }
+
+            float normal_length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            float key = 0.0f;
+            if (area > 0.0f && normal_length > 0.0f)
+                for (size_t k = 0; k < 3; k++)
+                    key += (cluster_center[k] / area - center[k]) * (normal[k] / normal_length);
+            sort_keys[c] = key;
+        }
+
+        std::vector<uint32_t> order(cluster_count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+                         { return sort_keys[a] > sort_keys[b]; });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (uint32_t c : order)
+        {
+            size_t begin = clusters[c];
+            size_t end = c + 1 < cluster_count ? clusters[c + 1] : triangle_count;
+            result.insert(result.end(), indices.begin() + begin * 3, indices.begin() + end * 3);
+        }
+        indices.swap(result);
+    }
+
+    size_t
+    MeshUtils::optimize_vertex_fetch(
+        std::vector<uint32_t> &indices,
+        void *vertices,
+        size_t vertex_count,
+        size_t vertex_size)
+    {
+        std::vector<uint32_t> remap(vertex_count, UINT32_MAX);
+        uint32_t next = 0;
+        for (uint32_t &index : indices)
+        {
+            if (remap[index] == UINT32_MAX)
+                remap[index] = next++;
+            index = remap[index];
+        }
+
+        std::vector<uint8_t> copy(static_cast<uint8_t *>(vertices), static_cast<uint8_t *>(vertices) + vertex_count * vertex_size);
+        remap_vertices(copy.data(), vertex_count, vertex_size, remap, vertices);
+        return next;
+    }
+
+    MeshUtils::CacheStatistics
+    MeshUtils::analyze_vertex_cache(
+        const uint32_t *indices,
+        size_t index_count,
+        size_t vertex_count,
+        uint32_t cache_size)
+    {
+        // FIFO缓存：顶点进入缓存时的序号与当前序号之差小于cache_size即命中
+        CacheStatistics statistics;
+        std::vector<size_t> cache_time(vertex_count, 0);
+        size_t timestamp = static_cast<size_t>(cache_size) + 1;
+        for (size_t i = 0; i < index_count; i++)
+        {
+            uint32_t v = indices[i];
+            if (timestamp - cache_time[v] > cache_size)
+            {
+                cache_time[v] = timestamp++;
+                statistics.m_transformed_count++;
+            }
+        }
+
+        size_t triangle_count = index_count / 3;
+        statistics.m_acmr = triangle_count ? static_cast<float>(statistics.m_transformed_count) / triangle_count : 0.0f;
+        statistics.m_atvr = vertex_count ? static_cast<float>(statistics.m_transformed_count) / vertex_count : 0.0f;
+        return statistics;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
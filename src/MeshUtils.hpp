@@ -0,0 +1,136 @@
+#ifndef __VL_MESHUTILS_HPP__
+#define __VL_MESHUTILS_HPP__
+
+#include <cstdint>
+#include <vector>
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 网格处理工具：合并重复顶点、为顶点缓存和取顶点重排、按遮挡排序簇
+    /// @details 顶点是任意的字节块，只按内容比较；三角形列表的索引为uint32_t
+    class MeshUtils : public ntl::Object
+    {
+    public:
+        using SelfType = MeshUtils;
+        using ParentType = ntl::Object;
+
+        /// @brief 顶点缓存模拟的结果
+        struct CacheStatistics
+        {
+            /// @brief 需要变换的顶点数，即缓存未命中次数
+            size_t m_transformed_count = 0;
+
+            /// @brief 每个三角形平均变换的顶点数，0.5~3，越小越好
+            float m_acmr = 0.0f;
+
+            /// @brief 每个顶点平均变换的次数，1最好
+            float m_atvr = 0.0f;
+        };
+
+        /// @brief 默认的顶点缓存大小
+        static constexpr uint32_t DEFAULT_CACHE_SIZE = 16;
+
+    public:
+        constexpr MeshUtils() noexcept = default;
+        constexpr explicit MeshUtils(const SelfType &) noexcept = default;
+        ~MeshUtils() override = default;
+
+    public:
+        constexpr SelfType &operator=(const SelfType &from) = default;
+
+    public:
+        /// @brief 找出内容相同的顶点
+        /// @param vertices 顶点
+        /// @param vertex_count 顶点数
+        /// @param vertex_size 每个顶点的字节数
+        /// @param remap 输出每个顶点在去重后的索引，按第一次出现的顺序编号
+        /// @return 去重后的顶点数
+        static size_t generate_remap(
+            const void *vertices,
+            size_t vertex_count,
+            size_t vertex_size,
+            std::vector<uint32_t> &remap);
+
+        /// @brief 按generate_remap的结果复制顶点
+        /// @param vertices 顶点
+        /// @param vertex_count 顶点数
+        /// @param vertex_size 每个顶点的字节数
+        /// @param remap generate_remap的结果
+        /// @param destination 输出，大小为去重后的顶点数
+        static void remap_vertices(
+            const void *vertices,
+            size_t vertex_count,
+            size_t vertex_size,
+            const std::vector<uint32_t> &remap,
+            void *destination) noexcept;
+
+        /// @brief 把不带索引的三角形列表合并为顶点缓冲和索引缓冲
+        /// @param vertices 顶点，每3个一个三角形
+        /// @param vertex_count 顶点数
+        /// @param vertex_size 每个顶点的字节数
+        /// @param welded 输出的顶点
+        /// @param indices 输出的索引
+        /// @return 去重后的顶点数
+        static size_t weld(
+            const void *vertices,
+            size_t vertex_count,
+            size_t vertex_size,
+            std::vector<uint8_t> &welded,
+            std::vector<uint32_t> &indices);
+
+        /// @brief 用Tipsify重排三角形，提高变换后顶点缓存的命中率
+        /// @param indices 索引，原地重排
+        /// @param vertex_count 顶点数
+        /// @param cache_size 目标缓存大小
+        /// @param clusters 不为空时输出每个簇第一个三角形的序号，簇在顶点缓存无法延续时断开，可用于optimize_overdraw
+        static void optimize_vertex_cache(
+            std::vector<uint32_t> &indices,
+            size_t vertex_count,
+            uint32_t cache_size = DEFAULT_CACHE_SIZE,
+            std::vector<uint32_t> *clusters = nullptr);
+
+        /// @brief 按与视角无关的遮挡度量排序簇：朝外的簇先画，簇内顺序不变
+        /// @param indices 索引，原地重排
+        /// @param positions 位置，每个顶点3个float
+        /// @param position_stride 相邻两个位置之间的字节数
+        /// @param vertex_count 顶点数
+        /// @param clusters optimize_vertex_cache输出的簇
+        static void optimize_overdraw(
+            std::vector<uint32_t> &indices,
+            const float *positions,
+            size_t position_stride,
+            size_t vertex_count,
+            const std::vector<uint32_t> &clusters);
+
+        /// @brief 按第一次被索引的顺序重排顶点，提高取顶点的局部性，未被引用的顶点被丢弃
+        /// @param indices 索引，原地改写
+        /// @param vertices 顶点，原地重排
+        /// @param vertex_count 顶点数
+        /// @param vertex_size 每个顶点的字节数
+        /// @return 重排后的顶点数
+        static size_t optimize_vertex_fetch(
+            std::vector<uint32_t> &indices,
+            void *vertices,
+            size_t vertex_count,
+            size_t vertex_size);
+
+        /// @brief 用FIFO顶点缓存模拟变换的顶点数
+        /// @param indices 索引
+        /// @param index_count 索引数
+        /// @param vertex_count 顶点数
+        /// @param cache_size 缓存大小
+        /// @return 统计
+        static CacheStatistics analyze_vertex_cache(
+            const uint32_t *indices,
+            size_t index_count,
+            size_t vertex_count,
+            uint32_t cache_size = DEFAULT_CACHE_SIZE);
+
+    protected:
+        /// @brief 对顶点的字节计算哈希
+        static uint64_t hash_bytes(const uint8_t *data, size_t size) noexcept;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,370 @@
+#ifndef __VL_MESHLETUTILS_CPP__
+#define __VL_MESHLETUTILS_CPP__
+
+#include <algorithm>
+#include <cmath>
+#include "MeshletUtils.hpp"
+
+namespace vl
+{
+    static_assert(sizeof(MeshletUtils::Meshlet) == 16, "MeshletUtils::Meshlet must be packed");
+    static_assert(sizeof(MeshletUtils::Bounds) == 48, "MeshletUtils::Bounds must match three vec4");
+
+    size_t
+    MeshletUtils::build(
+        const uint32_t *indices,
+        size_t index_count,
+        const float *positions,
+        size_t position_stride,
+        size_t vertex_count,
+        std::vector<Meshlet> &meshlets,
+        std::vector<uint32_t> &meshlet_vertices,
+        std::vector<uint8_t> &meshlet_triangles,
+        uint32_t max_vertices,
+        uint32_t max_triangles,
+        float cone_weight)
+    {
+        meshlets.clear();
+        meshlet_vertices.clear();
+        meshlet_triangles.clear();
+        if (max_vertices < 3 || max_vertices > MAX_VERTEX_LIMIT || max_triangles == 0 || index_count % 3 != 0)
+            return 0;
+        for (size_t i = 0; i < index_count; i++)
+            if (indices[i] >= vertex_count)
+                return 0;
+
+        const size_t triangle_count = index_count / 3;
+        auto position = [&](uint32_t vertex)
+        {
+            return reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(positions) + vertex * position_stride);
+        };
+
+        // 每个三角形的重心和单位法线，退化的三角形法线为0
+        std::vector<float> triangle_data(triangle_count * 6);
+        double total_area = 0.0;
+        for (size_t t = 0; t < triangle_count; t++)
+        {
+            const float *a = position(indices[t * 3]), *b = position(indices[t * 3 + 1]), *c = position(indices[t * 3 + 2]);
+            float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            float normal[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            total_area += length * 0.5;
+
+            float *data = &triangle_data[t * 6];
+            for (size_t k = 0; k < 3; k++)
+            {
+                data[k] = (a[k] + b[k] + c[k]) / 3.0f;
+                data[3 + k] = length > 0.0f ? normal[k] / length : 0.0f;
+            }
+        }
+
+        // 把簇看作圆盘估计它的半径，用来把距离归一化到与法线差异相近的范围
+        float expected_radius = static_cast<float>(std::sqrt(total_area / triangle_count * max_triangles / 3.14159265358979));
+        if (!(expected_radius > 0.0f))
+            expected_radius = 1.0f;
+        const float distance_weight = (1.0f - cone_weight) / expected_radius;
+
+        // 顶点到未使用三角形的邻接表，三角形使用后从表中移除
+        std::vector<uint32_t> offsets(vertex_count + 1, 0);
+        std::vector<uint32_t> live_counts(vertex_count, 0);
+        for (size_t i = 0; i < index_count; i++)
+            live_counts[indices[i]]++;
+        for (size_t v = 0; v < vertex_count; v++)
+            offsets[v + 1] = offsets[v] + live_counts[v];
+        std::vector<uint32_t> adjacency(index_count);
+        std::fill(live_counts.begin(), live_counts.end(), 0);
+        for (size_t i = 0; i < index_count; i++)
+            adjacency[offsets[indices[i]] + live_counts[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+        const uint16_t NONE = UINT16_MAX;
+        std::vector<uint16_t> local(vertex_count, NONE);
+        std::vector<uint8_t> is_emitted(triangle_count, 0);
+
+        Meshlet current;
+        float center_sum[3] = {0.0f, 0.0f, 0.0f};
+        float normal_sum[3] = {0.0f, 0.0f, 0.0f};
+
+        auto count_new = [&](uint32_t triangle)
+        {
+            uint32_t a = indices[triangle * 3], b = indices[triangle * 3 + 1], c = indices[triangle * 3 + 2];
+            return static_cast<uint32_t>(local[a] == NONE) +
+                   static_cast<uint32_t>(local[b] == NONE && b != a) +
+                   static_cast<uint32_t>(local[c] == NONE && c != a && c != b);
+        };
+
+        auto flush = [&]()
+        {
+            if (current.m_triangle_count == 0)
+                return;
+            for (size_t i = current.m_vertex_offset; i < meshlet_vertices.size(); i++)
+                local[meshlet_vertices[i]] = NONE;
+            meshlets.push_back(current);
+
+            current = Meshlet();
+            current.m_vertex_offset = static_cast<uint32_t>(meshlet_vertices.size());
+            current.m_triangle_offset = static_cast<uint32_t>(meshlet_triangles.size() / 3);
+            std::fill(center_sum, center_sum + 3, 0.0f);
+            std::fill(normal_sum, normal_sum + 3, 0.0f);
+        };
+
+        auto add = [&](uint32_t triangle)
+        {
+            for (size_t k = 0; k < 3; k++)
+            {
+                uint32_t vertex = indices[triangle * 3 + k];
+                if (local[vertex] == NONE)
+                {
+                    local[vertex] = static_cast<uint16_t>(current.m_vertex_count++);
+                    meshlet_vertices.push_back(vertex);
+                }
+                meshlet_triangles.push_back(static_cast<uint8_t>(local[vertex]));
+
+                // 每个角在邻接表中各有一项，退化三角形的重复顶点也一样
+                uint32_t *list = &adjacency[offsets[vertex]];
+                uint32_t &count = live_counts[vertex];
+                for (uint32_t i = 0; i < count; i++)
+                    if (list[i] == triangle)
+                    {
+                        list[i] = list[--count];
+                        break;
+                    }
+            }
+            current.m_triangle_count++;
+            is_emitted[triangle] = 1;
+
+            const float *data = &triangle_data[triangle * 6];
+            for (size_t k = 0; k < 3; k++)
+            {
+                center_sum[k] += data[k];
+                normal_sum[k] += data[3 + k];
+            }
+        };
+
+        size_t seed = 0;
+        for (size_t emitted = 0; emitted < triangle_count; emitted++)
+        {
+            uint32_t best = UINT32_MAX;
+            uint32_t best_new = 4;
+            float best_score = 0.0f;
+
+            if (current.m_triangle_count > 0)
+            {
+                float center[3], axis[3] = {0.0f, 0.0f, 0.0f};
+                float length = std::sqrt(normal_sum[0] * normal_sum[0] + normal_sum[1] * normal_sum[1] + normal_sum[2] * normal_sum[2]);
+                for (size_t k = 0; k < 3; k++)
+                {
+                    center[k] = center_sum[k] / current.m_triangle_count;
+                    if (length > 0.0f)
+                        axis[k] = normal_sum[k] / length;
+                }
+
+                // 候选为与簇共享顶点的未使用三角形
+                for (size_t i = current.m_vertex_offset; i < meshlet_vertices.size(); i++)
+                {
+                    uint32_t vertex = meshlet_vertices[i];
+                    const uint32_t *list = &adjacency[offsets[vertex]];
+                    for (uint32_t j = 0; j < live_counts[vertex]; j++)
+                    {
+                        uint32_t triangle = list[j];
+                        uint32_t new_count = count_new(triangle);
+                        if (new_count > best_new)
+                            continue;
+
+                        const float *data = &triangle_data[triangle * 6];
+                        float dx = data[0] - center[0], dy = data[1] - center[1], dz = data[2] - center[2];
+                        float spread = 1.0f - (data[3] * axis[0] + data[4] * axis[1] + data[5] * axis[2]);
+                        float score = std::sqrt(dx * dx + dy * dy + dz * dz) * distance_weight + spread * cone_weight;
+                        if (new_count < best_new || score < best_score)
+                        {
+                            best = triangle;
+                            best_new = new_count;
+                            best_score = score;
+                        }
+                    }
+                }
+            }
+
+            // 没有相邻的三角形时取输入顺序中下一个未使用的
+            if (best == UINT32_MAX)
+            {
+                while (is_emitted[seed])
+                    seed++;
+                best = static_cast<uint32_t>(seed);
+                best_new = count_new(best);
+            }
+
+            if (current.m_vertex_count + best_new > max_vertices || current.m_triangle_count >= max_triangles)
+                flush();
+            add(best);
+        }
+        flush();
+
+        return meshlets.size();
+    }
+
+    MeshletUtils::Bounds
+    MeshletUtils::compute_bounds(
+        const Meshlet &meshlet,
+        const uint32_t *meshlet_vertices,
+        const uint8_t *meshlet_triangles,
+        const float *positions,
+        size_t position_stride) noexcept
+    {
+        Bounds bounds;
+        if (meshlet.m_vertex_count == 0)
+            return bounds;
+
+        auto position = [&](uint32_t local)
+        {
+            uint32_t vertex = meshlet_vertices[meshlet.m_vertex_offset + local];
+            return reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(positions) + vertex * position_stride);
+        };
+        auto distance = [](const float *a, const float *b)
+        {
+            float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+            return std::sqrt(dx * dx + dy * dy + dz * dz);
+        };
+
+        // Ritter包围球：以三个轴上跨度最大的一对极值点为初始直径，再逐个包含外面的点
+        uint32_t extremes[6] = {0, 0, 0, 0, 0, 0};
+        for (uint32_t i = 1; i < meshlet.m_vertex_count; i++)
+        {
+            const float *p = position(i);
+            for (size_t k = 0; k < 3; k++)
+            {
+                if (p[k] < position(extremes[k * 2])[k])
+                    extremes[k * 2] = i;
+                if (p[k] > position(extremes[k * 2 + 1])[k])
+                    extremes[k * 2 + 1] = i;
+            }
+        }
+        size_t axis = 0;
+        for (size_t k = 1; k < 3; k++)
+            if (distance(position(extremes[k * 2]), position(extremes[k * 2 + 1])) >
+                distance(position(extremes[axis * 2]), position(extremes[axis * 2 + 1])))
+                axis = k;
+
+        const float *lower = position(extremes[axis * 2]), *upper = position(extremes[axis * 2 + 1]);
+        float *center = bounds.m_center;
+        for (size_t k = 0; k < 3; k++)
+            center[k] = (lower[k] + upper[k]) * 0.5f;
+        float radius = distance(lower, upper) * 0.5f;
+        for (uint32_t i = 0; i < meshlet.m_vertex_count; i++)
+        {
+            const float *p = position(i);
+            float d = distance(p, center);
+            if (d > radius)
+            {
+                float new_radius = (radius + d) * 0.5f;
+                float t = (new_radius - radius) / d;
+                for (size_t k = 0; k < 3; k++)
+                    center[k] += (p[k] - center[k]) * t;
+                radius = new_radius;
+            }
+        }
+        bounds.m_radius = radius;
+
+        // 法线锥：轴为平均法线，张角由与轴夹角最大的法线决定
+        auto triangle_normal = [&](uint32_t triangle, float normal[3], const float *&corner)
+        {
+            const uint8_t *local = meshlet_triangles + (static_cast<size_t>(meshlet.m_triangle_offset) + triangle) * 3;
+            const float *a = position(local[0]), *b = position(local[1]), *c = position(local[2]);
+            float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+            normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+            normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+            float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (length == 0.0f)
+                return false;
+            for (size_t k = 0; k < 3; k++)
+                normal[k] /= length;
+            corner = a;
+            return true;
+        };
+
+        float cone_axis[3] = {0.0f, 0.0f, 0.0f};
+        for (uint32_t t = 0; t < meshlet.m_triangle_count; t++)
+        {
+            float normal[3];
+            const float *corner = nullptr;
+            if (triangle_normal(t, normal, corner))
+                for (size_t k = 0; k < 3; k++)
+                    cone_axis[k] += normal[k];
+        }
+        float axis_length = std::sqrt(cone_axis[0] * cone_axis[0] + cone_axis[1] * cone_axis[1] + cone_axis[2] * cone_axis[2]);
+        if (axis_length == 0.0f)
+            return bounds;
+        for (size_t k = 0; k < 3; k++)
+            cone_axis[k] /= axis_length;
+
+        float min_dot = 1.0f;
+        for (uint32_t t = 0; t < meshlet.m_triangle_count; t++)
+        {
+            float normal[3];
+            const float *corner = nullptr;
+            if (triangle_normal(t, normal, corner))
+                min_dot = std::min(min_dot, normal[0] * cone_axis[0] + normal[1] * cone_axis[1] + normal[2] * cone_axis[2]);
+        }
+        if (min_dot <= MIN_CONE_DOT)
+            return bounds;
+
+        // 锥顶沿轴从中心后退，直到位于每个三角形平面的背面
+        float max_t = 0.0f;
+        for (uint32_t t = 0; t < meshlet.m_triangle_count; t++)
+        {
+            float normal[3];
+            const float *corner = nullptr;
+            if (!triangle_normal(t, normal, corner))
+                continue;
+            float dc = (center[0] - corner[0]) * normal[0] + (center[1] - corner[1]) * normal[1] + (center[2] - corner[2]) * normal[2];
+            float dn = cone_axis[0] * normal[0] + cone_axis[1] * normal[1] + cone_axis[2] * normal[2];
+            max_t = std::max(max_t, dc / dn);
+        }
+
+        for (size_t k = 0; k < 3; k++)
+        {
+            bounds.m_cone_apex[k] = center[k] - cone_axis[k] * max_t;
+            bounds.m_cone_axis[k] = cone_axis[k];
+        }
+        bounds.m_cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+        return bounds;
+    }
+
+    void
+    MeshletUtils::unpack_indices(
+        const std::vector<Meshlet> &meshlets,
+        const std::vector<uint32_t> &meshlet_vertices,
+        const std::vector<uint8_t> &meshlet_triangles,
+        std::vector<uint32_t> &indices)
+    {
+        indices.resize(meshlet_triangles.size());
+        for (const Meshlet &meshlet : meshlets)
+        {
+            const size_t first = static_cast<size_t>(meshlet.m_triangle_offset) * 3;
+            for (size_t i = first; i < first + meshlet.m_triangle_count * 3; i++)
+                indices[i] = meshlet_vertices[meshlet.m_vertex_offset + meshlet_triangles[i]];
+        }
+    }
+
+    bool
+    MeshletUtils::is_cone_culled(
+        const Bounds &bounds,
+        const float camera_position[3]) noexcept
+    {
+        if (bounds.m_cone_cutoff >= 1.0f)
+            return false;
+
+        float direction[3] = {
+            bounds.m_cone_apex[0] - camera_position[0],
+            bounds.m_cone_apex[1] - camera_position[1],
+            bounds.m_cone_apex[2] - camera_position[2],
+        };
+        float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+        float projection = direction[0] * bounds.m_cone_axis[0] + direction[1] * bounds.m_cone_axis[1] + direction[2] * bounds.m_cone_axis[2];
+        return length > 0.0f && projection >= bounds.m_cone_cutoff * length;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
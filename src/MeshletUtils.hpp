@@ -0,0 +1,135 @@
+#ifndef __VL_MESHLETUTILS_HPP__
+#define __VL_MESHLETUTILS_HPP__
+
+#include <cstdint>
+#include <vector>
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 把索引网格拆成顶点数和三角形数有上限的簇(meshlet)，并计算簇的包围球和法线锥
+    /// @details 簇内的三角形用uint8_t的局部索引引用簇的顶点列表，可直接用于网格着色器；
+    /// 没有网格着色器时用unpack_indices把簇按顺序展开为普通索引，每个簇是一次索引绘制
+    class MeshletUtils : public ntl::Object
+    {
+    public:
+        using SelfType = MeshletUtils;
+        using ParentType = ntl::Object;
+
+        /// @brief 一个簇
+        struct Meshlet
+        {
+            /// @brief 在簇顶点数组中的起始位置
+            uint32_t m_vertex_offset = 0;
+
+            /// @brief 第一个三角形的序号，局部索引从m_triangle_offset * 3开始，
+            /// 展开后的第一个索引也是m_triangle_offset * 3
+            uint32_t m_triangle_offset = 0;
+
+            uint32_t m_vertex_count = 0;
+            uint32_t m_triangle_count = 0;
+        };
+
+        /// @brief 簇的包围体，布局与cluster.comp中Cluster的前三个vec4相同
+        struct Bounds
+        {
+            /// @brief 包围球的中心和半径
+            float m_center[3] = {0.0f, 0.0f, 0.0f};
+            float m_radius = 0.0f;
+
+            /// @brief 法线锥的顶点，位于所有三角形平面的背面
+            float m_cone_apex[3] = {0.0f, 0.0f, 0.0f};
+
+            /// @brief 法线锥半张角的正弦，dot(normalize(apex - camera), axis) >= cutoff时全部三角形背向相机；
+            /// 1表示法线过于分散，不能剔除
+            float m_cone_cutoff = 1.0f;
+
+            /// @brief 法线锥的轴
+            float m_cone_axis[3] = {0.0f, 0.0f, 0.0f};
+
+            float m_reserved = 0.0f;
+        };
+
+        /// @brief 默认的簇顶点数上限
+        static constexpr uint32_t DEFAULT_MAX_VERTICES = 64;
+
+        /// @brief 默认的簇三角形数上限，取4的倍数使每个簇的局部索引按4字节对齐
+        static constexpr uint32_t DEFAULT_MAX_TRIANGLES = 124;
+
+        /// @brief 局部索引为uint8_t，顶点数不能超过256
+        static constexpr uint32_t MAX_VERTEX_LIMIT = 256;
+
+        /// @brief 法线锥的最小余弦，更分散时不生成法线锥
+        static constexpr float MIN_CONE_DOT = 0.1f;
+
+    public:
+        constexpr MeshletUtils() noexcept = default;
+        constexpr explicit MeshletUtils(const SelfType &) noexcept = default;
+        ~MeshletUtils() override = default;
+
+    public:
+        constexpr SelfType &operator=(const SelfType &from) = default;
+
+    public:
+        /// @brief 生成簇
+        /// @details 从输入顺序中第一个未使用的三角形开始，每次加入与簇共享顶点的三角形中新增顶点最少的，
+        /// 新增顶点相同时选离簇中心近、法线接近簇平均法线的；输入先经过MeshUtils::optimize_vertex_cache时簇更紧凑
+        /// @param indices 三角形列表的索引
+        /// @param index_count 索引数
+        /// @param positions 位置，每个顶点3个float
+        /// @param position_stride 相邻两个位置之间的字节数
+        /// @param vertex_count 顶点数
+        /// @param meshlets 输出的簇
+        /// @param meshlet_vertices 输出的簇顶点，即每个簇的局部索引到网格顶点的映射
+        /// @param meshlet_triangles 输出的局部索引，每个三角形3个
+        /// @param max_vertices 簇顶点数上限，3~MAX_VERTEX_LIMIT
+        /// @param max_triangles 簇三角形数上限
+        /// @param cone_weight 0~1，越大越偏向法线一致的簇，法线锥剔除效果更好，但簇的包围球更大
+        /// @return 簇数，参数无效时为0
+        static size_t build(
+            const uint32_t *indices,
+            size_t index_count,
+            const float *positions,
+            size_t position_stride,
+            size_t vertex_count,
+            std::vector<Meshlet> &meshlets,
+            std::vector<uint32_t> &meshlet_vertices,
+            std::vector<uint8_t> &meshlet_triangles,
+            uint32_t max_vertices = DEFAULT_MAX_VERTICES,
+            uint32_t max_triangles = DEFAULT_MAX_TRIANGLES,
+            float cone_weight = 0.25f);
+
+        /// @brief 计算一个簇的包围球和法线锥
+        /// @param meshlet 簇
+        /// @param meshlet_vertices 簇顶点
+        /// @param meshlet_triangles 局部索引
+        /// @param positions 位置，每个顶点3个float
+        /// @param position_stride 相邻两个位置之间的字节数
+        /// @return 包围体
+        static Bounds compute_bounds(
+            const Meshlet &meshlet,
+            const uint32_t *meshlet_vertices,
+            const uint8_t *meshlet_triangles,
+            const float *positions,
+            size_t position_stride) noexcept;
+
+        /// @brief 把所有簇按顺序展开为网格顶点的索引，簇i对应从m_triangle_offset * 3开始的m_triangle_count * 3个索引
+        /// @param meshlets 簇
+        /// @param meshlet_vertices 簇顶点
+        /// @param meshlet_triangles 局部索引
+        /// @param indices 输出的索引
+        static void unpack_indices(
+            const std::vector<Meshlet> &meshlets,
+            const std::vector<uint32_t> &meshlet_vertices,
+            const std::vector<uint8_t> &meshlet_triangles,
+            std::vector<uint32_t> &indices);
+
+        /// @brief 法线锥测试，与cluster.comp相同
+        /// @param bounds 包围体，与相机在同一空间
+        /// @param camera_position 相机位置
+        /// @return 是否全部三角形背向相机
+        static bool is_cone_culled(const Bounds &bounds, const float camera_position[3]) noexcept;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,485 @@
+#ifndef __VL_MIPGENERATOR_CPP__
+#define __VL_MIPGENERATOR_CPP__
+
+#include <algorithm>
+#include <cstring>
+#include "MipGenerator.hpp"
+#include "DeviceUtils.hpp"
+
+namespace vl
+{
+    vk::Result
+    MipGenerator::create(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        const Config &config)
+    {
+        if (config.m_code == nullptr || config.m_max_images == 0)
+        {
+            ntl::log.loge(
+                NTL_STRING("MipGenerator::create"),
+                NTL_STRING("Invalid config"));
+            return vk::Result::eErrorInitializationFailed;
+        }
+
+        m_device = device;
+        m_config = config;
+
+        // 计数器按存储缓冲的偏移对齐，每个图像绑定自己的一段
+        vk::DeviceSize alignment = std::max<vk::DeviceSize>(
+            physical_device.getProperties().limits.minStorageBufferOffsetAlignment, sizeof(uint32_t));
+        m_counter_stride = (sizeof(uint32_t) + alignment - 1) / alignment * alignment;
+
+        vk::Result result = m_counter_buffer.create(
+            m_device,
+            physical_device,
+            m_counter_stride * config.m_max_images,
+            vk::BufferUsageFlagBits::eStorageBuffer);
+        if (result == vk::Result::eSuccess)
+        {
+            std::memset(m_counter_buffer.m_mapped, 0, static_cast<size_t>(m_counter_buffer.m_size));
+            result = m_counter_buffer.flush(m_device);
+        }
+        if (result == vk::Result::eSuccess)
+            result = create_pipeline();
+        if (result != vk::Result::eSuccess)
+        {
+            ntl::log.loge(
+                NTL_STRING("MipGenerator::create"),
+                ntl::StringUtils::to_string(
+                    NTL_STRING("Failed to create mip generator, error code:"),
+                    static_cast<long>(result)));
+            destroy();
+            return result;
+        }
+
+        return vk::Result::eSuccess;
+    }
+
+    void
+    MipGenerator::destroy()
+    {
+        if (!m_device)
+            return;
+
+        clear_images();
+        if (m_pipeline)
+            m_device.destroyPipeline(m_pipeline);
+        if (m_pipeline_layout)
+            m_device.destroyPipelineLayout(m_pipeline_layout);
+        if (m_descriptor_pool)
+            m_device.destroyDescriptorPool(m_descriptor_pool);
+        if (m_set_layout)
+            m_device.destroyDescriptorSetLayout(m_set_layout);
+        m_counter_buffer.destroy(m_device);
+
+        m_pipeline = nullptr;
+        m_pipeline_layout = nullptr;
+        m_descriptor_pool = nullptr;
+        m_set_layout = nullptr;
+        m_counter_stride = 0;
+        m_device = nullptr;
+    }
+
+    vk::Result
+    MipGenerator::add_image(
+        const vk::Image &image,
+        uint32_t width,
+        uint32_t height,
+        uint32_t level_count,
+        uint32_t &index)
+    {
+        if (width == 0 || height == 0 || width > MAX_SIZE || height > MAX_SIZE ||
+            level_count == 0 || level_count > get_level_count(width, height))
+        {
+            ntl::log.loge(
+                NTL_STRING("MipGenerator::add_image"),
+                NTL_STRING("Invalid image size or level count"));
+            return vk::Result::eErrorFormatNotSupported;
+        }
+        if (m_targets.size() >= m_config.m_max_images)
+            return vk::Result::eErrorOutOfPoolMemory;
+
+        Target target;
+        target.m_image = image;
+        target.m_width = width;
+        target.m_height = height;
+        target.m_level_count = level_count;
+
+        vk::ImageViewCreateInfo view_info;
+        view_info.setImage(image);
+        view_info.setViewType(vk::ImageViewType::e2D);
+        view_info.setFormat(FORMAT);
+        for (uint32_t level = 0; level < level_count; level++)
+        {
+            view_info.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, level, 1, 0, 1));
+            auto view_result = m_device.createImageView(view_info);
+            if (view_result.result != vk::Result::eSuccess)
+            {
+                for (auto iter = target.m_views.cbegin(); iter != target.m_views.cend(); iter++)
+                    m_device.destroyImageView(*iter);
+                return view_result.result;
+            }
+            target.m_views.push_back(view_result.value);
+        }
+
+        vk::DescriptorSetAllocateInfo set_info;
+        set_info.setDescriptorPool(m_descriptor_pool);
+        set_info.setDescriptorSetCount(1);
+        set_info.setPSetLayouts(&m_set_layout);
+        auto set_result = m_device.allocateDescriptorSets(set_info);
+        if (set_result.result != vk::Result::eSuccess)
+        {
+            for (auto iter = target.m_views.cbegin(); iter != target.m_views.cend(); iter++)
+                m_device.destroyImageView(*iter);
+            return set_result.result;
+        }
+        target.m_set = set_result.value.at(0);
+
+        // 数组中多余的元素指向最后一级，着色器不会写入它们
+        std::vector<vk::DescriptorImageInfo> image_infos;
+        image_infos.push_back(vk::DescriptorImageInfo(nullptr, target.m_views.at(0), vk::ImageLayout::eGeneral));
+        for (uint32_t level = 1; level < MAX_LEVELS; level++)
+            image_infos.push_back(vk::DescriptorImageInfo(
+                nullptr, target.m_views.at(std::min(level, level_count - 1)), vk::ImageLayout::eGeneral));
+        vk::DescriptorBufferInfo buffer_info(
+            m_counter_buffer.m_buffer, m_counter_stride * m_targets.size(), sizeof(uint32_t));
+
+        vk::WriteDescriptorSet writes[3];
+        for (uint32_t binding = 0; binding < 3; binding++)
+        {
+            writes[binding].setDstSet(target.m_set);
+            writes[binding].setDstBinding(binding);
+        }
+        writes[0].setDescriptorCount(1);
+        writes[0].setDescriptorType(vk::DescriptorType::eStorageImage);
+        writes[0].setPImageInfo(&image_infos.at(0));
+        writes[1].setDescriptorCount(MAX_LEVELS - 1);
+        writes[1].setDescriptorType(vk::DescriptorType::eStorageImage);
+        writes[1].setPImageInfo(&image_infos.at(1));
+        writes[2].setDescriptorCount(1);
+        writes[2].setDescriptorType(vk::DescriptorType::eStorageBuffer);
+        writes[2].setPBufferInfo(&buffer_info);
+        m_device.updateDescriptorSets(writes, nullptr);
+
+        index = static_cast<uint32_t>(m_targets.size());
+        m_targets.push_back(target);
+        return vk::Result::eSuccess;
+    }
+
+    void
+    MipGenerator::clear_images()
+    {
+        if (!m_device)
+            return;
+
+        for (const Target &target : m_targets)
+            for (auto iter = target.m_views.cbegin(); iter != target.m_views.cend(); iter++)
+                m_device.destroyImageView(*iter);
+        if (m_descriptor_pool && !m_targets.empty())
+            (void)m_device.resetDescriptorPool(m_descriptor_pool);
+        m_targets.clear();
+    }
+
+    void
+    MipGenerator::record(
+        const vk::CommandBuffer &command_buffer,
+        uint32_t index,
+        vk::ImageLayout base_layout)
+    {
+        if (index >= m_targets.size())
+        {
+            ntl::log.loge(
+                NTL_STRING("MipGenerator::record"),
+                NTL_STRING("Invalid image index"));
+            return;
+        }
+        const Target &target = m_targets.at(index);
+
+        // 第0级由复制写入后读取，其余各级原有内容丢弃；上一次调度清零的计数器对这一次可见
+        vk::ImageMemoryBarrier barriers[2];
+        barriers[0].setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barriers[0].setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+        barriers[0].setOldLayout(base_layout);
+        barriers[0].setNewLayout(vk::ImageLayout::eGeneral);
+        barriers[0].setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barriers[0].setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barriers[0].setImage(target.m_image);
+        barriers[0].setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+        barriers[1] = barriers[0];
+        barriers[1].setSrcAccessMask(vk::AccessFlags());
+        barriers[1].setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+        barriers[1].setOldLayout(vk::ImageLayout::eUndefined);
+        barriers[1].setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 1, target.m_level_count - 1, 0, 1));
+        vk::MemoryBarrier counter_barrier;
+        counter_barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+        counter_barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+        uint32_t barrier_count = target.m_level_count > 1 ? 2 : 1;
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::DependencyFlags(),
+            counter_barrier,
+            nullptr,
+            vk::ArrayProxy<const vk::ImageMemoryBarrier>(barrier_count, barriers));
+
+        if (target.m_level_count > 1)
+        {
+            uint32_t level1_width = std::max(target.m_width >> 1, 1u);
+            uint32_t level1_height = std::max(target.m_height >> 1, 1u);
+            uint32_t group_size = TILE_SIZE / 2;
+            uint32_t group_x = (level1_width + group_size - 1) / group_size;
+            uint32_t group_y = (level1_height + group_size - 1) / group_size;
+
+            Params params;
+            params.m_size[0] = static_cast<int32_t>(target.m_width);
+            params.m_size[1] = static_cast<int32_t>(target.m_height);
+            params.m_level_count = static_cast<int32_t>(target.m_level_count);
+            params.m_workgroup_count = group_x * group_y;
+
+            command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_pipeline);
+            command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_pipeline_layout, 0, target.m_set, nullptr);
+            command_buffer.pushConstants(m_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(Params), &params);
+            command_buffer.dispatch(group_x, group_y, 1);
+        }
+
+        // 所有级别供片段着色器采样
+        vk::ImageMemoryBarrier barrier = barriers[0];
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+        barrier.setOldLayout(vk::ImageLayout::eGeneral);
+        barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+        barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, target.m_level_count, 0, 1));
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eFragmentShader,
+            vk::DependencyFlags(),
+            nullptr,
+            nullptr,
+            barrier);
+    }
+
+    uint32_t
+    MipGenerator::get_level_count(uint32_t width, uint32_t height) noexcept
+    {
+        uint32_t level_count = 1;
+        for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+            level_count++;
+        return level_count;
+    }
+
+    bool
+    MipGenerator::is_blit_supported(const vk::PhysicalDevice &physical_device, vk::Format format)
+    {
+        vk::FormatFeatureFlags required =
+            vk::FormatFeatureFlagBits::eBlitSrc |
+            vk::FormatFeatureFlagBits::eBlitDst |
+            vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+        vk::FormatProperties properties = physical_device.getFormatProperties(format);
+        return (properties.optimalTilingFeatures & required) == required;
+    }
+
+    bool
+    MipGenerator::is_compute_supported(const vk::PhysicalDevice &physical_device, uint32_t width, uint32_t height)
+    {
+        if (width == 0 || height == 0 || width > MAX_SIZE || height > MAX_SIZE)
+            return false;
+
+        vk::FormatProperties properties = physical_device.getFormatProperties(FORMAT);
+        return static_cast<bool>(properties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eStorageImage);
+    }
+
+    void
+    MipGenerator::record_blit(
+        const vk::CommandBuffer &command_buffer,
+        const vk::Image &image,
+        uint32_t width,
+        uint32_t height,
+        uint32_t level_count,
+        vk::ImageLayout base_layout)
+    {
+        vk::ImageMemoryBarrier barrier;
+        barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setImage(image);
+
+        // 每一级写入后转为TransferSrc供下一级读取，读取完成后转为ShaderReadOnly
+        vk::ImageLayout layout = base_layout;
+        int32_t source_width = static_cast<int32_t>(width);
+        int32_t source_height = static_cast<int32_t>(height);
+        for (uint32_t level = 1; level < level_count; level++)
+        {
+            barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+            barrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+            barrier.setOldLayout(layout);
+            barrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
+            barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, level - 1, 1, 0, 1));
+            vk::ImageMemoryBarrier destination_barrier = barrier;
+            destination_barrier.setSrcAccessMask(vk::AccessFlags());
+            destination_barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+            destination_barrier.setOldLayout(vk::ImageLayout::eUndefined);
+            destination_barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+            destination_barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, level, 1, 0, 1));
+            const vk::ImageMemoryBarrier barriers[] = {barrier, destination_barrier};
+            command_buffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTransfer,
+                vk::PipelineStageFlagBits::eTransfer,
+                vk::DependencyFlags(),
+                nullptr,
+                nullptr,
+                barriers);
+
+            int32_t destination_width = std::max(source_width >> 1, 1);
+            int32_t destination_height = std::max(source_height >> 1, 1);
+            vk::ImageBlit blit;
+            blit.setSrcSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level - 1, 0, 1));
+            blit.setSrcOffsets({vk::Offset3D(0, 0, 0), vk::Offset3D(source_width, source_height, 1)});
+            blit.setDstSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level, 0, 1));
+            blit.setDstOffsets({vk::Offset3D(0, 0, 0), vk::Offset3D(destination_width, destination_height, 1)});
+            command_buffer.blitImage(
+                image,
+                vk::ImageLayout::eTransferSrcOptimal,
+                image,
+                vk::ImageLayout::eTransferDstOptimal,
+                blit,
+                vk::Filter::eLinear);
+
+            barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferRead);
+            barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+            barrier.setOldLayout(vk::ImageLayout::eTransferSrcOptimal);
+            barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+            command_buffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTransfer,
+                vk::PipelineStageFlagBits::eFragmentShader,
+                vk::DependencyFlags(),
+                nullptr,
+                nullptr,
+                barrier);
+
+            layout = vk::ImageLayout::eTransferDstOptimal;
+            source_width = destination_width;
+            source_height = destination_height;
+        }
+
+        // 最后一级只被写入
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+        barrier.setOldLayout(layout);
+        barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+        barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, level_count - 1, 1, 0, 1));
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eFragmentShader,
+            vk::DependencyFlags(),
+            nullptr,
+            nullptr,
+            barrier);
+    }
+
+    void
+    MipGenerator::downsample(const uint8_t *source, uint32_t width, uint32_t height, uint8_t *destination) noexcept
+    {
+        uint32_t destination_width = std::max(width >> 1, 1u);
+        uint32_t destination_height = std::max(height >> 1, 1u);
+        for (uint32_t y = 0; y < destination_height; y++)
+        {
+            // 奇数尺寸舍去最后一行、一列，边长为1时重复同一个纹素
+            const uint8_t *row0 = source + static_cast<size_t>(y * 2) * width * 4;
+            const uint8_t *row1 = source + static_cast<size_t>(std::min(y * 2 + 1, height - 1)) * width * 4;
+            uint8_t *output = destination + static_cast<size_t>(y) * destination_width * 4;
+            for (uint32_t x = 0; x < destination_width; x++)
+            {
+                uint32_t x0 = x * 2 * 4;
+                uint32_t x1 = std::min(x * 2 + 1, width - 1) * 4;
+                for (uint32_t c = 0; c < 4; c++)
+                    output[x * 4 + c] = static_cast<uint8_t>(
+                        (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+            }
+        }
+    }
+
+    void
+    MipGenerator::generate(
+        const uint8_t *pixels,
+        uint32_t width,
+        uint32_t height,
+        uint32_t level_count,
+        std::vector<std::vector<uint8_t>> &levels)
+    {
+        levels.resize(level_count > 0 ? level_count - 1 : 0);
+        const uint8_t *source = pixels;
+        for (uint32_t level = 1; level < level_count; level++)
+        {
+            std::vector<uint8_t> &destination = levels.at(level - 1);
+            destination.resize(static_cast<size_t>(std::max(width >> 1, 1u)) * std::max(height >> 1, 1u) * 4);
+            downsample(source, width, height, destination.data());
+            source = destination.data();
+            width = std::max(width >> 1, 1u);
+            height = std::max(height >> 1, 1u);
+        }
+    }
+
+    vk::Result
+    MipGenerator::create_pipeline()
+    {
+        // 第0级、第1到第12级、计数器
+        vk::DescriptorSetLayoutBinding bindings[] = {
+            vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute),
+            vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageImage, MAX_LEVELS - 1, vk::ShaderStageFlagBits::eCompute),
+            vk::DescriptorSetLayoutBinding(2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute),
+        };
+        vk::DescriptorSetLayoutCreateInfo set_layout_info;
+        set_layout_info.setBindingCount(3);
+        set_layout_info.setPBindings(bindings);
+        auto set_layout_result = m_device.createDescriptorSetLayout(set_layout_info);
+        if (set_layout_result.result != vk::Result::eSuccess)
+            return set_layout_result.result;
+        m_set_layout = set_layout_result.value;
+
+        vk::DescriptorPoolSize pool_sizes[] = {
+            vk::DescriptorPoolSize(vk::DescriptorType::eStorageImage, MAX_LEVELS * m_config.m_max_images),
+            vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, m_config.m_max_images),
+        };
+        vk::DescriptorPoolCreateInfo pool_info;
+        pool_info.setMaxSets(m_config.m_max_images);
+        pool_info.setPoolSizeCount(2);
+        pool_info.setPPoolSizes(pool_sizes);
+        auto pool_result = m_device.createDescriptorPool(pool_info);
+        if (pool_result.result != vk::Result::eSuccess)
+            return pool_result.result;
+        m_descriptor_pool = pool_result.value;
+
+        vk::PushConstantRange push_constant(vk::ShaderStageFlagBits::eCompute, 0, sizeof(Params));
+        vk::PipelineLayoutCreateInfo layout_info;
+        layout_info.setSetLayoutCount(1);
+        layout_info.setPSetLayouts(&m_set_layout);
+        layout_info.setPushConstantRangeCount(1);
+        layout_info.setPPushConstantRanges(&push_constant);
+        auto layout_result = m_device.createPipelineLayout(layout_info);
+        if (layout_result.result != vk::Result::eSuccess)
+            return layout_result.result;
+        m_pipeline_layout = layout_result.value;
+
+        auto module_result = DeviceUtils::create_shader_module(m_device, m_config.m_code, m_config.m_code_size);
+        if (module_result.result != vk::Result::eSuccess)
+            return module_result.result;
+
+        vk::PipelineShaderStageCreateInfo stage_info;
+        stage_info.setStage(vk::ShaderStageFlagBits::eCompute);
+        stage_info.setModule(module_result.value);
+        stage_info.setPName("main");
+
+        vk::ComputePipelineCreateInfo pipeline_info;
+        pipeline_info.setStage(stage_info);
+        pipeline_info.setLayout(m_pipeline_layout);
+        auto pipeline_result = m_device.createComputePipeline(nullptr, pipeline_info);
+        m_device.destroyShaderModule(module_result.value);
+        if (pipeline_result.result != vk::Result::eSuccess)
+            return pipeline_result.result;
+        m_pipeline = pipeline_result.value;
+
+        return vk::Result::eSuccess;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
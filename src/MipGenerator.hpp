@@ -0,0 +1,193 @@
+#ifndef __VL_MIPGENERATOR_HPP__
+#define __VL_MIPGENERATOR_HPP__
+
+#include <vector>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "MappedBuffer.hpp"
+
+namespace vl
+{
+    /// @brief 生成mip链
+    /// @details 快速路径用mip.comp在一次调度中写入所有级别，每一级为上一级2x2纹素的整数平均，
+    /// 与CPU上的downsample逐位一致；边长超过MAX_SIZE或格式不支持存储图像时用逐级blit的链代替
+    class MipGenerator : public ntl::Object
+    {
+    public:
+        using SelfType = MipGenerator;
+        using ParentType = ntl::Object;
+
+        /// @brief 计算路径支持的格式
+        static constexpr vk::Format FORMAT = vk::Format::eR8G8B8A8Unorm;
+
+        /// @brief 计算路径一次调度支持的最大边长
+        static constexpr uint32_t MAX_SIZE = 4096;
+
+        /// @brief MAX_SIZE对应的级数
+        static constexpr uint32_t MAX_LEVELS = 13;
+
+        /// @brief 每个工作组处理的第0级区域边长
+        static constexpr uint32_t TILE_SIZE = 64;
+
+        /// @brief 与mip.comp中的Params相同
+        struct Params
+        {
+            int32_t m_size[2];
+            int32_t m_level_count;
+            uint32_t m_workgroup_count;
+        };
+
+        /// @brief 创建参数
+        struct Config
+        {
+            /// @brief mip.comp的SPIR-V
+            const uint32_t *m_code = nullptr;
+            size_t m_code_size = 0;
+
+            /// @brief 最多同时注册的图像数
+            uint32_t m_max_images = 64;
+        };
+
+    protected:
+        /// @brief 注册的图像
+        struct Target
+        {
+            vk::Image m_image;
+            uint32_t m_width = 0;
+            uint32_t m_height = 0;
+            uint32_t m_level_count = 0;
+
+            /// @brief 每一级的视图
+            std::vector<vk::ImageView> m_views;
+
+            vk::DescriptorSet m_set;
+        };
+
+    protected:
+        vk::Device m_device;
+        Config m_config;
+
+        /// @brief 每个图像一个计数器，工作组用它找出最后完成的一个，相邻计数器间隔m_counter_stride
+        MappedBuffer m_counter_buffer;
+        vk::DeviceSize m_counter_stride = 0;
+
+        vk::DescriptorSetLayout m_set_layout;
+        vk::DescriptorPool m_descriptor_pool;
+        vk::PipelineLayout m_pipeline_layout;
+        vk::Pipeline m_pipeline;
+
+        std::vector<Target> m_targets;
+
+    public:
+        MipGenerator() = default;
+        ~MipGenerator() override = default;
+
+        MipGenerator(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 创建计算管线
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param config 创建参数
+        /// @return 结果
+        vk::Result create(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            const Config &config);
+
+        /// @brief 销毁，调用前需要保证设备已空闲
+        void destroy();
+
+        /// @brief 注册图像，为每一级创建视图和描述符集
+        /// @param image 图像，格式为FORMAT，用途包含Storage
+        /// @param width 第0级的宽度，不超过MAX_SIZE
+        /// @param height 第0级的高度，不超过MAX_SIZE
+        /// @param level_count 级数，不超过get_level_count的结果
+        /// @param index 输出的图像索引
+        /// @return 结果，图像数达到上限时为eErrorOutOfPoolMemory
+        vk::Result add_image(
+            const vk::Image &image,
+            uint32_t width,
+            uint32_t height,
+            uint32_t level_count,
+            uint32_t &index);
+
+        /// @brief 销毁所有注册的图像的视图和描述符集，调用前需要保证设备已不再使用它们
+        void clear_images();
+
+        /// @brief 记录一次调度生成注册的图像的所有级别
+        /// @details 调用前第0级处于base_layout并由复制命令写入，之后所有级别处于ShaderReadOnlyOptimal
+        /// @param command_buffer 同时支持图形和计算的命令缓冲
+        /// @param index add_image得到的索引
+        /// @param base_layout 第0级当前的布局
+        void record(
+            const vk::CommandBuffer &command_buffer,
+            uint32_t index,
+            vk::ImageLayout base_layout = vk::ImageLayout::eTransferDstOptimal);
+
+    public:
+        /// @brief 获取完整mip链的级数
+        /// @param width 宽度
+        /// @param height 高度
+        /// @return 级数
+        static uint32_t get_level_count(uint32_t width, uint32_t height) noexcept;
+
+        /// @brief 格式是否支持线性过滤的blit
+        /// @param physical_device 物理设备
+        /// @param format 格式
+        /// @return 是否支持
+        static bool is_blit_supported(const vk::PhysicalDevice &physical_device, vk::Format format);
+
+        /// @brief 是否可以使用计算路径
+        /// @param physical_device 物理设备
+        /// @param width 宽度
+        /// @param height 高度
+        /// @return FORMAT支持存储图像并且尺寸不超过MAX_SIZE
+        static bool is_compute_supported(const vk::PhysicalDevice &physical_device, uint32_t width, uint32_t height);
+
+        /// @brief 记录逐级blit生成mip链，每一级从上一级线性过滤缩小一半
+        /// @details 调用前第0级处于base_layout并由复制命令写入，之后所有级别处于ShaderReadOnlyOptimal；
+        /// 图像用途需要包含TransferSrc和TransferDst
+        /// @param command_buffer 支持图形的命令缓冲
+        /// @param image 图像
+        /// @param width 第0级的宽度
+        /// @param height 第0级的高度
+        /// @param level_count 级数
+        /// @param base_layout 第0级当前的布局
+        static void record_blit(
+            const vk::CommandBuffer &command_buffer,
+            const vk::Image &image,
+            uint32_t width,
+            uint32_t height,
+            uint32_t level_count,
+            vk::ImageLayout base_layout = vk::ImageLayout::eTransferDstOptimal);
+
+        /// @brief 在CPU上把RGBA8图像缩小一级，与mip.comp的结果相同
+        /// @param source 源图像，紧密排列
+        /// @param width 源宽度
+        /// @param height 源高度
+        /// @param destination 目标，max(width / 2, 1) * max(height / 2, 1)个像素
+        static void downsample(const uint8_t *source, uint32_t width, uint32_t height, uint8_t *destination) noexcept;
+
+        /// @brief 在CPU上生成mip链
+        /// @param pixels 第0级，紧密排列的RGBA8
+        /// @param width 宽度
+        /// @param height 高度
+        /// @param level_count 级数
+        /// @param levels 输出第1级开始的各级
+        static void generate(
+            const uint8_t *pixels,
+            uint32_t width,
+            uint32_t height,
+            uint32_t level_count,
+            std::vector<std::vector<uint8_t>> &levels);
+
+    protected:
+        /// @brief 创建描述符集布局、描述符池和管线
+        /// @return 结果
+        vk::Result create_pipeline();
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,254 @@
+#ifndef __VL_PIPELINELAYOUTCACHE_CPP__
+#define __VL_PIPELINELAYOUTCACHE_CPP__
+
+#include <algorithm>
+#include "PipelineLayoutCache.hpp"
+
+namespace vl
+{
+    size_t
+    PipelineLayoutCache::KeyHash::operator()(
+        const Key &key) const noexcept
+    {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        for (uint32_t word : key)
+            hash = (hash ^ word) * 1099511628211ull;
+        return static_cast<size_t>(hash);
+    }
+
+    void
+    PipelineLayoutCache::destroy(
+        const vk::Device &device)
+    {
+        if (device)
+        {
+            for (const auto &item : m_pipeline_layouts)
+                device.destroyPipelineLayout(item.second.m_layout);
+            for (const auto &item : m_set_layouts)
+                device.destroyDescriptorSetLayout(item.second);
+        }
+        m_pipeline_layouts.clear();
+        m_set_layouts.clear();
+        m_keys.clear();
+    }
+
+    vk::ResultValue<vk::DescriptorSetLayout>
+    PipelineLayoutCache::acquire_set_layout(
+        const vk::Device &device,
+        const std::vector<vk::DescriptorSetLayoutBinding> &bindings)
+    {
+        m_statistics.m_set_layout_requests++;
+
+        // 按binding排序后作为键，与传入的顺序无关
+        std::vector<vk::DescriptorSetLayoutBinding> sorted = bindings;
+        std::sort(
+            sorted.begin(), sorted.end(),
+            [](const vk::DescriptorSetLayoutBinding &a, const vk::DescriptorSetLayoutBinding &b)
+            { return a.binding < b.binding; });
+        Key key;
+        key.reserve(sorted.size() * 4);
+        for (const vk::DescriptorSetLayoutBinding &binding : sorted)
+        {
+            key.push_back(binding.binding);
+            key.push_back(static_cast<uint32_t>(binding.descriptorType));
+            key.push_back(binding.descriptorCount);
+            key.push_back(static_cast<uint32_t>(binding.stageFlags));
+        }
+
+        auto iter = m_set_layouts.find(key);
+        if (iter != m_set_layouts.end())
+        {
+            m_statistics.m_set_layout_hits++;
+            return {vk::Result::eSuccess, iter->second};
+        }
+
+        vk::DescriptorSetLayoutCreateInfo info;
+        info.setBindingCount(static_cast<uint32_t>(sorted.size()));
+        info.setPBindings(sorted.data());
+        auto layout_result = device.createDescriptorSetLayout(info);
+        if (layout_result.result != vk::Result::eSuccess)
+        {
+            m_statistics.m_failures++;
+            return layout_result;
+        }
+        m_set_layouts.emplace(std::move(key), layout_result.value);
+        return layout_result;
+    }
+
+    vk::ResultValue<vk::PipelineLayout>
+    PipelineLayoutCache::acquire_pipeline_layout(
+        const vk::Device &device,
+        const Layout &layout)
+    {
+        m_statistics.m_pipeline_layout_requests++;
+
+        std::vector<vk::DescriptorSetLayout> set_layouts;
+        for (const auto &bindings : layout.m_sets)
+        {
+            auto set_layout_result = acquire_set_layout(device, bindings);
+            if (set_layout_result.result != vk::Result::eSuccess)
+                return {set_layout_result.result, vk::PipelineLayout()};
+            set_layouts.push_back(set_layout_result.value);
+        }
+
+        // 集布局已经去重，键为它们的句柄加上推送常量范围
+        Key key;
+        key.reserve(set_layouts.size() * 2 + layout.m_push_constant_ranges.size() * 3 + 1);
+        key.push_back(static_cast<uint32_t>(set_layouts.size()));
+        for (const vk::DescriptorSetLayout &set_layout : set_layouts)
+        {
+            uint64_t handle = reinterpret_cast<uint64_t>(static_cast<VkDescriptorSetLayout>(set_layout));
+            key.push_back(static_cast<uint32_t>(handle));
+            key.push_back(static_cast<uint32_t>(handle >> 32));
+        }
+        for (const vk::PushConstantRange &range : layout.m_push_constant_ranges)
+        {
+            key.push_back(static_cast<uint32_t>(range.stageFlags));
+            key.push_back(range.offset);
+            key.push_back(range.size);
+        }
+
+        auto iter = m_pipeline_layouts.find(key);
+        if (iter != m_pipeline_layouts.end())
+        {
+            m_statistics.m_pipeline_layout_hits++;
+            return {vk::Result::eSuccess, iter->second.m_layout};
+        }
+
+        vk::PipelineLayoutCreateInfo info;
+        info.setSetLayoutCount(static_cast<uint32_t>(set_layouts.size()));
+        info.setPSetLayouts(set_layouts.data());
+        info.setPushConstantRangeCount(static_cast<uint32_t>(layout.m_push_constant_ranges.size()));
+        info.setPPushConstantRanges(layout.m_push_constant_ranges.data());
+        auto layout_result = device.createPipelineLayout(info);
+        if (layout_result.result != vk::Result::eSuccess)
+        {
+            m_statistics.m_failures++;
+            return layout_result;
+        }
+        m_keys.emplace(static_cast<VkPipelineLayout>(layout_result.value), key);
+        m_pipeline_layouts.emplace(std::move(key), Entry{layout_result.value, std::move(set_layouts)});
+        return layout_result;
+    }
+
+    vk::ResultValue<vk::PipelineLayout>
+    PipelineLayoutCache::acquire(
+        const vk::Device &device,
+        const std::vector<const SpirvReflection *> &stages)
+    {
+        Layout layout;
+        if (!merge(stages, layout))
+        {
+            m_statistics.m_failures++;
+            return {vk::Result::eErrorUnknown, vk::PipelineLayout()};
+        }
+        return acquire_pipeline_layout(device, layout);
+    }
+
+    const std::vector<vk::DescriptorSetLayout> &
+    PipelineLayoutCache::get_set_layouts(
+        const vk::PipelineLayout &layout) const
+    {
+        static const std::vector<vk::DescriptorSetLayout> empty;
+        auto iter = m_keys.find(static_cast<VkPipelineLayout>(layout));
+        if (iter == m_keys.end())
+            return empty;
+        return m_pipeline_layouts.at(iter->second).m_set_layouts;
+    }
+
+    uint32_t
+    PipelineLayoutCache::get_set_layout_count() const noexcept
+    {
+        return static_cast<uint32_t>(m_set_layouts.size());
+    }
+
+    uint32_t
+    PipelineLayoutCache::get_pipeline_layout_count() const noexcept
+    {
+        return static_cast<uint32_t>(m_pipeline_layouts.size());
+    }
+
+    const PipelineLayoutCache::Statistics &
+    PipelineLayoutCache::get_statistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+    ntl::String
+    PipelineLayoutCache::format() const
+    {
+        ntl::StringStream sstr;
+        sstr << std::endl
+             << NTL_STRING("\tset layouts:") << m_set_layouts.size() << NTL_STRING(" (") << m_statistics.m_set_layout_hits
+             << NTL_STRING(" hits in ") << m_statistics.m_set_layout_requests << NTL_STRING(" requests)") << std::endl
+             << NTL_STRING("\tpipeline layouts:") << m_pipeline_layouts.size() << NTL_STRING(" (") << m_statistics.m_pipeline_layout_hits
+             << NTL_STRING(" hits in ") << m_statistics.m_pipeline_layout_requests << NTL_STRING(" requests)") << std::endl
+             << NTL_STRING("\tfailures:") << m_statistics.m_failures << std::endl;
+        return sstr.str();
+    }
+
+    bool
+    PipelineLayoutCache::merge(
+        const std::vector<const SpirvReflection *> &stages,
+        Layout &layout)
+    {
+        layout.m_sets.clear();
+        layout.m_push_constant_ranges.clear();
+        uint32_t push_constant_begin = UINT32_MAX, push_constant_end = 0;
+        vk::ShaderStageFlags push_constant_stages;
+
+        for (const SpirvReflection *stage : stages)
+        {
+            for (const SpirvReflection::Binding &binding : stage->get_bindings())
+            {
+                if (binding.m_count == 0)
+                {
+                    ntl::log.loge(
+                        NTL_STRING("PipelineLayoutCache::merge"),
+                        NTL_STRING("Runtime sized descriptor arrays are not supported"));
+                    return false;
+                }
+                if (binding.m_set >= layout.m_sets.size())
+                    layout.m_sets.resize(binding.m_set + 1);
+                auto &bindings = layout.m_sets[binding.m_set];
+                auto iter = std::find_if(
+                    bindings.begin(), bindings.end(),
+                    [&binding](const vk::DescriptorSetLayoutBinding &item)
+                    { return item.binding == binding.m_binding; });
+                if (iter == bindings.end())
+                {
+                    bindings.emplace_back(binding.m_binding, binding.m_type, binding.m_count, binding.m_stages);
+                    continue;
+                }
+                if (iter->descriptorType != binding.m_type || iter->descriptorCount != binding.m_count)
+                {
+                    ntl::log.loge(
+                        NTL_STRING("PipelineLayoutCache::merge"),
+                        NTL_STRING("Binding declared differently in two stages"));
+                    return false;
+                }
+                iter->stageFlags |= binding.m_stages;
+            }
+
+            const SpirvReflection::PushConstant &push_constant = stage->get_push_constant();
+            if (push_constant.m_size > 0)
+            {
+                push_constant_begin = std::min(push_constant_begin, push_constant.m_offset);
+                push_constant_end = std::max(push_constant_end, push_constant.m_offset + push_constant.m_size);
+                push_constant_stages |= push_constant.m_stages;
+            }
+        }
+
+        for (auto &bindings : layout.m_sets)
+            std::sort(
+                bindings.begin(), bindings.end(),
+                [](const vk::DescriptorSetLayoutBinding &a, const vk::DescriptorSetLayoutBinding &b)
+                { return a.binding < b.binding; });
+        if (push_constant_end > 0)
+            layout.m_push_constant_ranges.emplace_back(push_constant_stages, push_constant_begin, push_constant_end - push_constant_begin);
+        return true;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
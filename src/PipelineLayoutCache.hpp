@@ -0,0 +1,131 @@
+#ifndef __VL_PIPELINELAYOUTCACHE_HPP__
+#define __VL_PIPELINELAYOUTCACHE_HPP__
+
+#include <vector>
+#include <unordered_map>
+#include "Vulkan.hpp"
+#include "SpirvReflection.hpp"
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 管线布局缓存：合并各阶段的反射结果，生成并缓存描述符集布局和管线布局
+    /// @details 相同的绑定共享同一个描述符集布局，相同的集布局和推送常量范围共享同一个管线布局。
+    /// 布局创建后一直留在缓存中，由缓存在destroy时销毁，调用者不要销毁
+    class PipelineLayoutCache : public ntl::Object
+    {
+    public:
+        using SelfType = PipelineLayoutCache;
+        using ParentType = ntl::Object;
+
+        /// @brief 缓存的键
+        using Key = std::vector<uint32_t>;
+
+        /// @brief 键的哈希
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const noexcept;
+        };
+
+        /// @brief 合并后的布局
+        struct Layout
+        {
+            /// @brief 每个集的绑定，下标为set，中间没有用到的集为空
+            std::vector<std::vector<vk::DescriptorSetLayoutBinding>> m_sets;
+
+            /// @brief 推送常量范围，各阶段合并为一个，没有推送常量时为空
+            std::vector<vk::PushConstantRange> m_push_constant_ranges;
+        };
+
+        /// @brief 统计信息
+        struct Statistics
+        {
+            /// @brief 获取集布局的次数
+            uint64_t m_set_layout_requests = 0;
+            uint64_t m_set_layout_hits = 0;
+
+            /// @brief 获取管线布局的次数
+            uint64_t m_pipeline_layout_requests = 0;
+            uint64_t m_pipeline_layout_hits = 0;
+
+            /// @brief 合并失败或创建失败的次数
+            uint64_t m_failures = 0;
+        };
+
+    protected:
+        /// @brief 缓存的管线布局和它的集布局
+        struct Entry
+        {
+            vk::PipelineLayout m_layout;
+            std::vector<vk::DescriptorSetLayout> m_set_layouts;
+        };
+
+        std::unordered_map<Key, vk::DescriptorSetLayout, KeyHash> m_set_layouts;
+        std::unordered_map<Key, Entry, KeyHash> m_pipeline_layouts;
+
+        /// @brief 管线布局到键，用于get_set_layouts
+        std::unordered_map<VkPipelineLayout, Key> m_keys;
+
+        Statistics m_statistics;
+
+    public:
+        PipelineLayoutCache() = default;
+        ~PipelineLayoutCache() override = default;
+
+        PipelineLayoutCache(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 销毁所有布局
+        void destroy(const vk::Device &device);
+
+        /// @brief 获取绑定相同的描述符集布局
+        /// @param device 逻辑设备
+        /// @param bindings 绑定，不支持不可变采样器
+        /// @return 集布局
+        vk::ResultValue<vk::DescriptorSetLayout> acquire_set_layout(
+            const vk::Device &device,
+            const std::vector<vk::DescriptorSetLayoutBinding> &bindings);
+
+        /// @brief 获取与合并后的布局相同的管线布局
+        /// @param device 逻辑设备
+        /// @param layout 合并后的布局
+        /// @return 管线布局
+        vk::ResultValue<vk::PipelineLayout> acquire_pipeline_layout(
+            const vk::Device &device,
+            const Layout &layout);
+
+        /// @brief 合并各阶段的反射结果并获取管线布局
+        /// @param device 逻辑设备
+        /// @param stages 各阶段的反射结果
+        /// @return 管线布局，合并失败时为eErrorUnknown
+        vk::ResultValue<vk::PipelineLayout> acquire(
+            const vk::Device &device,
+            const std::vector<const SpirvReflection *> &stages);
+
+        /// @brief 获取管线布局的集布局，用于分配描述符集
+        /// @return 集布局，下标为set，不是由缓存创建的管线布局时为空
+        const std::vector<vk::DescriptorSetLayout> &get_set_layouts(const vk::PipelineLayout &layout) const;
+
+        /// @brief 获取缓存的集布局数
+        uint32_t get_set_layout_count() const noexcept;
+
+        /// @brief 获取缓存的管线布局数
+        uint32_t get_pipeline_layout_count() const noexcept;
+
+        const Statistics &get_statistics() const noexcept;
+
+        ntl::String format() const;
+
+    public:
+        /// @brief 合并各阶段的反射结果：同一绑定的阶段取并集，推送常量合并为一个覆盖所有阶段的范围
+        /// @param stages 各阶段的反射结果
+        /// @param layout 输出
+        /// @return 同一绑定在不同阶段的类型或数量不同，或有运行时大小的数组时失败
+        static bool merge(
+            const std::vector<const SpirvReflection *> &stages,
+            Layout &layout);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,533 @@
+#ifndef __VL_READBACKQUEUE_CPP__
+#define __VL_READBACKQUEUE_CPP__
+
+#include <cstring>
+#include "ReadbackQueue.hpp"
+
+namespace vl
+{
+    double
+    ReadbackQueue::Statistics::megabytes_per_second() const noexcept
+    {
+        if (m_seconds <= 0.0)
+            return 0.0;
+        return static_cast<double>(m_bytes) / (1024.0 * 1024.0) / m_seconds;
+    }
+
+    ReadbackQueue::~ReadbackQueue()
+    {
+        destroy();
+    }
+
+    vk::Result
+    ReadbackQueue::create(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        const vk::Queue &queue,
+        uint32_t queue_family_index,
+        const Config &config)
+    {
+        if (config.m_ring_size == 0 || config.m_slot_size == 0)
+        {
+            ntl::log.loge(
+                NTL_STRING("ReadbackQueue::create"),
+                NTL_STRING("Ring size and slot size must not be zero"));
+            return vk::Result::eErrorInitializationFailed;
+        }
+
+        m_device = device;
+        m_queue = queue;
+        m_config = config;
+
+        vk::CommandPoolCreateInfo pool_info;
+        pool_info.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+        pool_info.setQueueFamilyIndex(queue_family_index);
+        auto pool_result = m_device.createCommandPool(pool_info);
+        if (pool_result.result != vk::Result::eSuccess)
+            return pool_result.result;
+        m_command_pool = pool_result.value;
+
+        vk::CommandBufferAllocateInfo allocate_info;
+        allocate_info.setCommandPool(m_command_pool);
+        allocate_info.setLevel(vk::CommandBufferLevel::ePrimary);
+        allocate_info.setCommandBufferCount(config.m_ring_size);
+        auto command_result = m_device.allocateCommandBuffers(allocate_info);
+        if (command_result.result != vk::Result::eSuccess)
+        {
+            destroy();
+            return command_result.result;
+        }
+
+        m_slots.resize(config.m_ring_size);
+        for (uint32_t i = 0; i < config.m_ring_size; i++)
+        {
+            Slot &slot = m_slots.at(i);
+            slot.m_command_buffer = command_result.value.at(i);
+
+            // 回读的内存由主机读取，优先使用主机缓存的内存
+            vk::Result result = slot.m_buffer.create(
+                m_device,
+                physical_device,
+                config.m_slot_size,
+                vk::BufferUsageFlagBits::eTransferDst,
+                vk::MemoryPropertyFlagBits::eHostCached);
+            if (result != vk::Result::eSuccess)
+            {
+                destroy();
+                return result;
+            }
+
+            auto fence_result = m_device.createFence(vk::FenceCreateInfo());
+            if (fence_result.result != vk::Result::eSuccess)
+            {
+                destroy();
+                return fence_result.result;
+            }
+            slot.m_fence = fence_result.value;
+        }
+
+        m_is_stopping = false;
+        m_worker = std::thread(&ReadbackQueue::worker_loop, this);
+
+        return vk::Result::eSuccess;
+    }
+
+    void
+    ReadbackQueue::destroy()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_stopping = true;
+        }
+        m_in_flight_cv.notify_all();
+        m_free_cv.notify_all();
+        if (m_worker.joinable())
+            m_worker.join();
+
+        for (auto iter = m_slots.begin(); iter != m_slots.end(); iter++)
+        {
+            // 未完成的帧以空像素交付，避免future永远等待
+            if (iter->m_is_busy)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                fail_slot(*iter, vk::Result::eNotReady);
+            }
+
+            iter->m_buffer.destroy(m_device);
+            if (iter->m_fence)
+                m_device.destroyFence(iter->m_fence);
+        }
+        m_slots.clear();
+        m_recorded.clear();
+        m_in_flight.clear();
+
+        if (m_command_pool)
+            m_device.destroyCommandPool(m_command_pool);
+        m_command_pool = nullptr;
+    }
+
+    std::optional<std::future<ReadbackQueue::Frame>>
+    ReadbackQueue::record(
+        const vk::CommandBuffer &command_buffer,
+        const Source &source)
+    {
+        std::optional<uint32_t> slot_index = acquire_slot();
+        if (!slot_index.has_value())
+            return std::nullopt;
+
+        auto future = record_copy(*slot_index, command_buffer, source);
+        if (future.has_value())
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_recorded.push_back(*slot_index);
+        }
+        return future;
+    }
+
+    void
+    ReadbackQueue::submitted(
+        const Signal &signal)
+    {
+        if (signal.m_timeline && !m_config.m_is_timeline_enabled)
+        {
+            ntl::log.loge(
+                NTL_STRING("ReadbackQueue::submitted"),
+                NTL_STRING("Timeline semaphores are not enabled, see Config::m_is_timeline_enabled"));
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto iter = m_recorded.cbegin(); iter != m_recorded.cend(); iter++)
+                fail_slot(m_slots.at(*iter), vk::Result::eErrorFeatureNotPresent);
+            m_recorded.clear();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto iter = m_recorded.cbegin(); iter != m_recorded.cend(); iter++)
+            {
+                m_slots.at(*iter).m_signal = signal;
+                m_in_flight.push_back(*iter);
+            }
+            m_recorded.clear();
+        }
+        m_in_flight_cv.notify_one();
+    }
+
+    std::optional<std::future<ReadbackQueue::Frame>>
+    ReadbackQueue::capture(
+        const Source &source,
+        const vk::Semaphore &wait_semaphore,
+        vk::PipelineStageFlags wait_stage)
+    {
+        std::optional<uint32_t> slot_index = acquire_slot();
+        if (!slot_index.has_value())
+            return std::nullopt;
+
+        Slot &slot = m_slots.at(*slot_index);
+        // 格空闲时后台线程不会访问它的栅栏
+        vk::Result result = m_device.resetFences(slot.m_fence);
+        if (result == vk::Result::eSuccess)
+            result = slot.m_command_buffer.reset();
+
+        vk::CommandBufferBeginInfo begin_info;
+        begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+        if (result == vk::Result::eSuccess)
+            result = slot.m_command_buffer.begin(begin_info);
+        if (result != vk::Result::eSuccess)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            slot.m_is_busy = false;
+            m_next_slot = *slot_index;
+            return std::nullopt;
+        }
+
+        auto future = record_copy(*slot_index, slot.m_command_buffer, source);
+        result = slot.m_command_buffer.end();
+        if (!future.has_value())
+            return std::nullopt;
+
+        vk::SubmitInfo submit_info;
+        submit_info.setCommandBuffers(slot.m_command_buffer);
+        if (wait_semaphore)
+        {
+            submit_info.setWaitSemaphores(wait_semaphore);
+            submit_info.setWaitDstStageMask(wait_stage);
+        }
+
+        if (result == vk::Result::eSuccess)
+            result = m_queue.submit(submit_info, slot.m_fence);
+        if (result != vk::Result::eSuccess)
+        {
+            ntl::log.loge(
+                NTL_STRING("ReadbackQueue::capture"),
+                ntl::StringUtils::to_string(
+                    NTL_STRING("Failed to submit readback, error code:"),
+                    static_cast<long>(result)));
+            std::lock_guard<std::mutex> lock(m_mutex);
+            fail_slot(slot, result);
+            return future;
+        }
+
+        Signal signal;
+        signal.m_fence = slot.m_fence;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            slot.m_signal = signal;
+            m_in_flight.push_back(*slot_index);
+        }
+        m_in_flight_cv.notify_one();
+
+        return future;
+    }
+
+    ReadbackQueue::Statistics
+    ReadbackQueue::get_statistics()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_statistics;
+    }
+
+    ntl::String
+    ReadbackQueue::format()
+    {
+        Statistics statistics = get_statistics();
+
+        ntl::StringStream sstr;
+        sstr << std::endl
+             << NTL_STRING("\tframes:") << statistics.m_frames << std::endl
+             << NTL_STRING("\tdropped:") << statistics.m_dropped << std::endl
+             << NTL_STRING("\tfailed:") << statistics.m_failed << std::endl
+             << NTL_STRING("\tbytes:") << statistics.m_bytes << std::endl
+             << NTL_STRING("\tseconds:") << statistics.m_seconds << std::endl
+             << NTL_STRING("\tMB/s:") << statistics.megabytes_per_second() << std::endl;
+        return sstr.str();
+    }
+
+    uint32_t
+    ReadbackQueue::get_texel_size(
+        vk::Format format) noexcept
+    {
+        switch (format)
+        {
+        case vk::Format::eR8Unorm:
+        case vk::Format::eR8Uint:
+            return 1;
+
+        case vk::Format::eR8G8Unorm:
+        case vk::Format::eR16Sfloat:
+        case vk::Format::eD16Unorm:
+            return 2;
+
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Srgb:
+        case vk::Format::eB8G8R8A8Unorm:
+        case vk::Format::eB8G8R8A8Srgb:
+        case vk::Format::eA2B10G10R10UnormPack32:
+        case vk::Format::eR32Sfloat:
+        case vk::Format::eD32Sfloat:
+            return 4;
+
+        case vk::Format::eR16G16B16A16Sfloat:
+            return 8;
+
+        case vk::Format::eR32G32B32A32Sfloat:
+            return 16;
+
+        default:
+            return 0;
+        }
+    }
+
+    vk::ImageAspectFlags
+    ReadbackQueue::get_aspect(
+        vk::Format format) noexcept
+    {
+        switch (format)
+        {
+        case vk::Format::eD16Unorm:
+        case vk::Format::eD32Sfloat:
+            return vk::ImageAspectFlagBits::eDepth;
+
+        default:
+            return vk::ImageAspectFlagBits::eColor;
+        }
+    }
+
+    std::optional<uint32_t>
+    ReadbackQueue::acquire_slot()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (!m_first_record.has_value())
+            m_first_record = std::chrono::steady_clock::now();
+
+        // 格按顺序轮转使用，下一格仍在使用中说明环已满
+        while (m_slots.at(m_next_slot).m_is_busy)
+        {
+            if (m_config.m_back_pressure == BackPressure::eDrop || m_is_stopping)
+            {
+                m_statistics.m_dropped++;
+                return std::nullopt;
+            }
+            m_free_cv.wait(lock);
+        }
+
+        uint32_t slot_index = m_next_slot;
+        m_next_slot = (m_next_slot + 1) % static_cast<uint32_t>(m_slots.size());
+        m_slots.at(slot_index).m_is_busy = true;
+        return slot_index;
+    }
+
+    std::optional<std::future<ReadbackQueue::Frame>>
+    ReadbackQueue::record_copy(
+        uint32_t slot_index,
+        const vk::CommandBuffer &command_buffer,
+        const Source &source)
+    {
+        Slot &slot = m_slots.at(slot_index);
+
+        uint32_t texel_size = get_texel_size(source.m_format);
+        vk::DeviceSize size = static_cast<vk::DeviceSize>(source.m_extent.width) * source.m_extent.height * texel_size;
+        if (texel_size == 0 || size > m_config.m_slot_size)
+        {
+            ntl::log.loge(
+                NTL_STRING("ReadbackQueue::record_copy"),
+                NTL_STRING("Image format is not supported or image is larger than slot size"));
+            std::lock_guard<std::mutex> lock(m_mutex);
+            slot.m_is_busy = false;
+            m_next_slot = slot_index;
+            return std::nullopt;
+        }
+
+        slot.m_promise = std::promise<Frame>();
+        slot.m_frame = Frame();
+        slot.m_frame.m_index = m_frame_index++;
+        slot.m_frame.m_extent = source.m_extent;
+        slot.m_frame.m_format = source.m_format;
+        slot.m_frame.m_row_pitch = source.m_extent.width * texel_size;
+
+        vk::ImageAspectFlags aspect = get_aspect(source.m_format);
+        vk::ImageSubresourceRange range(aspect, 0, 1, 0, 1);
+        bool need_transition = source.m_layout != vk::ImageLayout::eTransferSrcOptimal;
+
+        if (need_transition)
+        {
+            vk::ImageMemoryBarrier barrier;
+            barrier.setSrcAccessMask(source.m_src_access);
+            barrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+            barrier.setOldLayout(source.m_layout);
+            barrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
+            barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+            barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+            barrier.setImage(source.m_image);
+            barrier.setSubresourceRange(range);
+            command_buffer.pipelineBarrier(
+                source.m_src_stage,
+                vk::PipelineStageFlagBits::eTransfer,
+                vk::DependencyFlags(),
+                nullptr,
+                nullptr,
+                barrier);
+        }
+
+        vk::BufferImageCopy region;
+        region.setBufferOffset(0);
+        region.setBufferRowLength(0);
+        region.setBufferImageHeight(0);
+        region.setImageSubresource(vk::ImageSubresourceLayers(aspect, 0, 0, 1));
+        region.setImageOffset(vk::Offset3D(0, 0, 0));
+        region.setImageExtent(vk::Extent3D(source.m_extent.width, source.m_extent.height, 1));
+        command_buffer.copyImageToBuffer(
+            source.m_image,
+            vk::ImageLayout::eTransferSrcOptimal,
+            slot.m_buffer.m_buffer,
+            region);
+
+        if (need_transition)
+        {
+            vk::ImageMemoryBarrier barrier;
+            barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferRead);
+            barrier.setDstAccessMask(vk::AccessFlags());
+            barrier.setOldLayout(vk::ImageLayout::eTransferSrcOptimal);
+            barrier.setNewLayout(source.m_layout);
+            barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+            barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+            barrier.setImage(source.m_image);
+            barrier.setSubresourceRange(range);
+            command_buffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTransfer,
+                vk::PipelineStageFlagBits::eBottomOfPipe,
+                vk::DependencyFlags(),
+                nullptr,
+                nullptr,
+                barrier);
+        }
+
+        // 让复制结果对主机读取可见
+        vk::BufferMemoryBarrier host_barrier;
+        host_barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        host_barrier.setDstAccessMask(vk::AccessFlagBits::eHostRead);
+        host_barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        host_barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        host_barrier.setBuffer(slot.m_buffer.m_buffer);
+        host_barrier.setOffset(0);
+        host_barrier.setSize(size);
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eHost,
+            vk::DependencyFlags(),
+            nullptr,
+            host_barrier,
+            nullptr);
+
+        return slot.m_promise.get_future();
+    }
+
+    void
+    ReadbackQueue::fail_slot(
+        Slot &slot,
+        vk::Result result)
+    {
+        slot.m_frame.m_pixels.clear();
+        slot.m_frame.m_result = result;
+        slot.m_promise.set_value(std::move(slot.m_frame));
+        slot.m_is_busy = false;
+        m_statistics.m_failed++;
+        m_free_cv.notify_one();
+    }
+
+    void
+    ReadbackQueue::worker_loop()
+    {
+        const uint64_t timeout = 1000000;
+
+        while (true)
+        {
+            uint32_t slot_index = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_in_flight_cv.wait(lock, [this]()
+                                    { return m_is_stopping || !m_in_flight.empty(); });
+                if (m_is_stopping)
+                    return;
+                slot_index = m_in_flight.front();
+            }
+
+            // 按提交顺序等待，最旧的一帧完成前后面的帧不会先完成
+            Slot &slot = m_slots.at(slot_index);
+            vk::Result result = wait_signal(slot, timeout);
+            if (result == vk::Result::eTimeout)
+                continue;
+
+            // 设备丢失等错误不会再恢复，交付空帧，否则future永远不会完成
+            if (result != vk::Result::eSuccess)
+            {
+                ntl::log.loge(
+                    NTL_STRING("ReadbackQueue::worker_loop"),
+                    ntl::StringUtils::to_string(
+                        NTL_STRING("Failed to wait for readback, error code:"),
+                        static_cast<long>(result)));
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_in_flight.pop_front();
+                fail_slot(slot, result);
+                continue;
+            }
+
+            slot.m_buffer.invalidate(m_device);
+            size_t size = static_cast<size_t>(slot.m_frame.m_row_pitch) * slot.m_frame.m_extent.height;
+            slot.m_frame.m_pixels.resize(size);
+            std::memcpy(slot.m_frame.m_pixels.data(), slot.m_buffer.m_mapped, size);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_in_flight.pop_front();
+                slot.m_promise.set_value(std::move(slot.m_frame));
+                slot.m_is_busy = false;
+
+                m_statistics.m_frames++;
+                m_statistics.m_bytes += size;
+                m_statistics.m_seconds = std::chrono::duration<double>(
+                                             std::chrono::steady_clock::now() - *m_first_record)
+                                             .count();
+            }
+            m_free_cv.notify_one();
+        }
+    }
+
+    vk::Result
+    ReadbackQueue::wait_signal(
+        const Slot &slot,
+        uint64_t timeout)
+    {
+        if (slot.m_signal.m_timeline)
+        {
+            vk::SemaphoreWaitInfo wait_info;
+            wait_info.setSemaphores(slot.m_signal.m_timeline);
+            wait_info.setValues(slot.m_signal.m_value);
+            return m_device.waitSemaphores(wait_info, timeout);
+        }
+
+        return m_device.waitForFences(slot.m_signal.m_fence, VK_TRUE, timeout);
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,246 @@
+#ifndef __VL_READBACKQUEUE_HPP__
+#define __VL_READBACKQUEUE_HPP__
+
+#include <vector>
+#include <deque>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <optional>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "MappedBuffer.hpp"
+
+namespace vl
+{
+    /// @brief 异步的GPU到CPU图像回读队列
+    /// @details 把交换链或离屏图像复制到一圈主机缓存的缓冲中，
+    /// 由后台线程等待栅栏或时间线信号量完成后把像素交给future，渲染线程从不等待GPU
+    class ReadbackQueue : public ntl::Object
+    {
+    public:
+        using SelfType = ReadbackQueue;
+        using ParentType = ntl::Object;
+
+        /// @brief 环满时的处理方式
+        enum class BackPressure
+        {
+            /// @brief 丢弃新的请求
+            eDrop,
+            /// @brief 等待最旧的一帧完成
+            eWait,
+        };
+
+        /// @brief 配置
+        struct Config
+        {
+            /// @brief 环中缓冲的数量
+            uint32_t m_ring_size = 3;
+
+            /// @brief 每个缓冲的大小，需要能装下最大的一帧
+            vk::DeviceSize m_slot_size = 0;
+
+            /// @brief 环满时的处理方式
+            BackPressure m_back_pressure = BackPressure::eDrop;
+
+            /// @brief 是否可以使用时间线信号量作为完成信号
+            /// @details vkWaitSemaphores是Vulkan 1.2的核心函数，调用者需要以1.2创建实例和设备并启用timelineSemaphore特性后才能设为true。
+            /// HeadlessContext创建的是1.0实例，不满足此要求；为false时带时间线信号量的提交会以eErrorFeatureNotPresent失败
+            bool m_is_timeline_enabled = false;
+        };
+
+        /// @brief 要回读的图像
+        struct Source
+        {
+            vk::Image m_image;
+            vk::Extent2D m_extent;
+            vk::Format m_format = vk::Format::eB8G8R8A8Unorm;
+
+            /// @brief 复制前后图像所在的布局
+            vk::ImageLayout m_layout = vk::ImageLayout::ePresentSrcKHR;
+
+            /// @brief 最后写入图像的阶段，深度图像通常为eLateFragmentTests
+            vk::PipelineStageFlags m_src_stage = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+
+            /// @brief 最后写入图像的访问类型，深度图像通常为eDepthStencilAttachmentWrite
+            vk::AccessFlags m_src_access = vk::AccessFlagBits::eColorAttachmentWrite;
+        };
+
+        /// @brief 完成信号，栅栏和时间线信号量二选一，使用时间线信号量需要Config::m_is_timeline_enabled
+        struct Signal
+        {
+            vk::Fence m_fence;
+            vk::Semaphore m_timeline;
+            uint64_t m_value = 0;
+        };
+
+        /// @brief 回读得到的一帧
+        struct Frame
+        {
+            /// @brief 帧序号
+            uint64_t m_index = 0;
+            vk::Extent2D m_extent;
+            vk::Format m_format = vk::Format::eUndefined;
+
+            /// @brief 每行字节数，像素紧密排列
+            uint32_t m_row_pitch = 0;
+
+            /// @brief 像素，失败或队列销毁时未完成的帧为空
+            std::vector<uint8_t> m_pixels;
+
+            /// @brief 结果，队列销毁时未完成的帧为eNotReady，提交或等待失败时为对应的错误码
+            vk::Result m_result = vk::Result::eSuccess;
+        };
+
+        /// @brief 统计信息
+        struct Statistics
+        {
+            uint64_t m_frames = 0;
+            uint64_t m_dropped = 0;
+
+            /// @brief 没有得到像素的帧，包括销毁时未完成的
+            uint64_t m_failed = 0;
+            uint64_t m_bytes = 0;
+            double m_seconds = 0.0;
+
+            /// @brief 吞吐量
+            /// @return MB/s
+            double megabytes_per_second() const noexcept;
+        };
+
+    protected:
+        /// @brief 环中的一格
+        struct Slot
+        {
+            MappedBuffer m_buffer;
+            vk::CommandBuffer m_command_buffer;
+            vk::Fence m_fence;
+            Signal m_signal;
+            std::promise<Frame> m_promise;
+            Frame m_frame;
+            bool m_is_busy = false;
+        };
+
+    protected:
+        vk::Device m_device;
+        vk::Queue m_queue;
+        vk::CommandPool m_command_pool;
+        Config m_config;
+
+        std::vector<Slot> m_slots;
+
+        /// @brief 下一个要使用的格
+        uint32_t m_next_slot = 0;
+
+        /// @brief 已记录但还没有提交的格
+        std::vector<uint32_t> m_recorded;
+
+        /// @brief 已提交、等待完成的格，按提交顺序
+        std::deque<uint32_t> m_in_flight;
+
+        uint64_t m_frame_index = 0;
+        Statistics m_statistics;
+        std::optional<std::chrono::steady_clock::time_point> m_first_record;
+
+        std::mutex m_mutex;
+        std::condition_variable m_in_flight_cv;
+        std::condition_variable m_free_cv;
+        std::thread m_worker;
+        bool m_is_stopping = false;
+
+    public:
+        ReadbackQueue() = default;
+        ~ReadbackQueue() override;
+
+        ReadbackQueue(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 创建环和后台线程
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param queue 自行提交时使用的队列
+        /// @param queue_family_index 队列所在的系列
+        /// @param config 配置
+        /// @return 结果
+        vk::Result create(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            const vk::Queue &queue,
+            uint32_t queue_family_index,
+            const Config &config);
+
+        /// @brief 停止后台线程并销毁所有对象，调用前需要保证设备已空闲
+        void destroy();
+
+        /// @brief 把复制命令记录到调用者的命令缓冲中，提交后需要调用submitted
+        /// @param command_buffer 命令缓冲
+        /// @param source 要回读的图像
+        /// @return 帧的future，环满并且丢弃时返回空
+        std::optional<std::future<Frame>> record(const vk::CommandBuffer &command_buffer, const Source &source);
+
+        /// @brief 告知队列之前记录的复制已随命令缓冲提交
+        /// @details 使用栅栏时，调用者在观察到栅栏完成前不应重置它，推荐使用时间线信号量
+        /// @param signal 该次提交的完成信号
+        void submitted(const Signal &signal);
+
+        /// @brief 使用内部命令缓冲记录并提交一次复制
+        /// @param source 要回读的图像
+        /// @param wait_semaphore 提交前等待的信号量，例如渲染完成信号量
+        /// @param wait_stage 等待的阶段
+        /// @return 帧的future，环满并且丢弃时返回空
+        std::optional<std::future<Frame>> capture(
+            const Source &source,
+            const vk::Semaphore &wait_semaphore = nullptr,
+            vk::PipelineStageFlags wait_stage = vk::PipelineStageFlagBits::eTransfer);
+
+        /// @brief 获取统计信息
+        /// @return 统计信息
+        Statistics get_statistics();
+
+        /// @brief 格式化统计信息
+        /// @return 格式化后的结果
+        ntl::String format();
+
+    public:
+        /// @brief 获取格式每个像素的字节数
+        /// @param format 格式
+        /// @return 字节数，不支持的格式返回0
+        static uint32_t get_texel_size(vk::Format format) noexcept;
+
+        /// @brief 获取复制时使用的图像方面
+        /// @param format 格式
+        /// @return 深度格式为eDepth，其余为eColor
+        static vk::ImageAspectFlags get_aspect(vk::Format format) noexcept;
+
+    protected:
+        /// @brief 取得一个空闲的格
+        /// @return 格的索引，丢弃时返回空
+        std::optional<uint32_t> acquire_slot();
+
+        /// @brief 记录复制命令
+        /// @param slot_index 格的索引
+        /// @param command_buffer 命令缓冲
+        /// @param source 要回读的图像
+        /// @return 帧的future
+        std::optional<std::future<Frame>> record_copy(uint32_t slot_index, const vk::CommandBuffer &command_buffer, const Source &source);
+
+        /// @brief 以空像素交付格中的帧并释放格，需要持有m_mutex
+        /// @param slot 格
+        /// @param result 帧的结果
+        void fail_slot(Slot &slot, vk::Result result);
+
+        /// @brief 后台线程
+        void worker_loop();
+
+        /// @brief 等待格的完成信号
+        /// @param slot 格
+        /// @param timeout 超时，纳秒
+        /// @return eSuccess表示完成，eTimeout表示未完成，其余为错误
+        vk::Result wait_signal(const Slot &slot, uint64_t timeout);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,241 @@
+#ifndef __VL_RENDERQUEUE_CPP__
+#define __VL_RENDERQUEUE_CPP__
+
+#include <cmath>
+#include <algorithm>
+#include "RenderQueue.hpp"
+
+namespace vl
+{
+    void
+    RenderQueue::clear() noexcept
+    {
+        m_keys.clear();
+        m_indices.clear();
+    }
+
+    void
+    RenderQueue::reserve(
+        size_t count)
+    {
+        m_keys.reserve(count);
+        m_indices.reserve(count);
+    }
+
+    void
+    RenderQueue::push(
+        uint64_t key,
+        uint32_t index)
+    {
+        m_keys.push_back(key);
+        m_indices.push_back(index);
+    }
+
+    size_t
+    RenderQueue::size() const noexcept
+    {
+        return m_keys.size();
+    }
+
+    const std::vector<uint64_t> &
+    RenderQueue::get_keys() const noexcept
+    {
+        return m_keys;
+    }
+
+    const std::vector<uint32_t> &
+    RenderQueue::get_indices() const noexcept
+    {
+        return m_indices;
+    }
+
+    void
+    RenderQueue::sort(
+        ThreadPool *pool)
+    {
+        size_t count = m_keys.size();
+        if (count < 2)
+            return;
+
+        m_temp_keys.resize(count);
+        m_temp_indices.resize(count);
+
+        // 分成若干段，每段有自己的直方图，分发时各段写入自己的区间，保持稳定
+        size_t chunk_count = 1;
+        if (pool != nullptr && count >= PARALLEL_THRESHOLD)
+            chunk_count = pool->get_thread_count() + 1;
+        size_t chunk_size = (count + chunk_count - 1) / chunk_count;
+        chunk_count = (count + chunk_size - 1) / chunk_size;
+
+        auto run = [pool, chunk_count](auto func)
+        {
+            if (chunk_count == 1)
+                func(size_t(0), size_t(1));
+            else
+                pool->parallel_for(chunk_count, 1, func);
+        };
+
+        // 先统计全部8个字节，用于跳过所有键都相同的字节
+        std::vector<size_t> totals(8 * 256, 0);
+        {
+            std::vector<size_t> histograms(chunk_count * 8 * 256, 0);
+            run([&](size_t begin, size_t end)
+                {
+                    for (size_t chunk = begin; chunk < end; chunk++)
+                    {
+                        size_t *histogram = histograms.data() + chunk * 8 * 256;
+                        size_t last = std::min(count, (chunk + 1) * chunk_size);
+                        for (size_t i = chunk * chunk_size; i < last; i++)
+                        {
+                            uint64_t key = m_keys[i];
+                            for (int byte = 0; byte < 8; byte++)
+                                histogram[byte * 256 + ((key >> (byte * 8)) & 0xFF)]++;
+                        }
+                    }
+                });
+            for (size_t chunk = 0; chunk < chunk_count; chunk++)
+                for (size_t i = 0; i < 8 * 256; i++)
+                    totals[i] += histograms[chunk * 8 * 256 + i];
+        }
+
+        std::vector<size_t> offsets(chunk_count * 256);
+        for (int byte = 0; byte < 8; byte++)
+        {
+            const size_t *total = totals.data() + byte * 256;
+            if (std::find(total, total + 256, count) != total + 256)
+                continue;
+            int shift = byte * 8;
+
+            // 每段这一字节的直方图，单段时就是总的直方图
+            if (chunk_count == 1)
+                std::copy(total, total + 256, offsets.begin());
+            else
+            {
+                std::fill(offsets.begin(), offsets.end(), 0);
+                run([&](size_t begin, size_t end)
+                    {
+                        for (size_t chunk = begin; chunk < end; chunk++)
+                        {
+                            size_t *histogram = offsets.data() + chunk * 256;
+                            size_t last = std::min(count, (chunk + 1) * chunk_size);
+                            for (size_t i = chunk * chunk_size; i < last; i++)
+                                histogram[(m_keys[i] >> shift) & 0xFF]++;
+                        }
+                    });
+            }
+
+            // 按(桶, 段)的顺序求前缀和
+            size_t sum = 0;
+            for (size_t bucket = 0; bucket < 256; bucket++)
+                for (size_t chunk = 0; chunk < chunk_count; chunk++)
+                {
+                    size_t value = offsets[chunk * 256 + bucket];
+                    offsets[chunk * 256 + bucket] = sum;
+                    sum += value;
+                }
+
+            run([&](size_t begin, size_t end)
+                {
+                    for (size_t chunk = begin; chunk < end; chunk++)
+                    {
+                        size_t *offset = offsets.data() + chunk * 256;
+                        size_t last = std::min(count, (chunk + 1) * chunk_size);
+                        for (size_t i = chunk * chunk_size; i < last; i++)
+                        {
+                            uint64_t key = m_keys[i];
+                            size_t destination = offset[(key >> shift) & 0xFF]++;
+                            m_temp_keys[destination] = key;
+                            m_temp_indices[destination] = m_indices[i];
+                        }
+                    }
+                });
+
+            m_keys.swap(m_temp_keys);
+            m_indices.swap(m_temp_indices);
+        }
+    }
+
+    template <typename Func>
+    RenderQueue::Statistics
+    RenderQueue::emit(
+        Func func) const
+    {
+        Statistics statistics;
+        uint64_t previous = 0;
+        for (size_t i = 0; i < m_keys.size(); i++)
+        {
+            uint64_t key = m_keys[i];
+            uint32_t changes = 0;
+            if (i == 0 || get_pass(key) != get_pass(previous))
+                changes |= CHANGE_PASS;
+            if (i == 0 || get_pipeline(key) != get_pipeline(previous))
+                changes |= CHANGE_PIPELINE;
+            if (i == 0 || get_descriptor_set(key) != get_descriptor_set(previous))
+                changes |= CHANGE_DESCRIPTOR_SET;
+
+            // 管线变化后描述符集需要重新绑定
+            if (changes & CHANGE_PIPELINE)
+                changes |= CHANGE_DESCRIPTOR_SET;
+
+            statistics.m_pass_changes += (changes & CHANGE_PASS) ? 1 : 0;
+            statistics.m_pipeline_changes += (changes & CHANGE_PIPELINE) ? 1 : 0;
+            statistics.m_descriptor_set_changes += (changes & CHANGE_DESCRIPTOR_SET) ? 1 : 0;
+            statistics.m_draw_count++;
+
+            func(key, m_indices[i], changes);
+            previous = key;
+        }
+        return statistics;
+    }
+
+    uint64_t
+    RenderQueue::make_key(
+        uint32_t pass,
+        uint32_t pipeline,
+        uint32_t descriptor_set,
+        float depth,
+        bool is_back_to_front) noexcept
+    {
+        constexpr uint32_t depth_max = (1u << DEPTH_BITS) - 1;
+        // NaN转换为整数是未定义行为，放在最远处
+        float clamped = std::isnan(depth) ? 1.0f : std::min(std::max(depth, 0.0f), 1.0f);
+        uint32_t quantized = static_cast<uint32_t>(clamped * depth_max);
+        if (is_back_to_front)
+            quantized = depth_max - quantized;
+
+        return (static_cast<uint64_t>(pass & ((1u << PASS_BITS) - 1)) << PASS_SHIFT) |
+               (static_cast<uint64_t>(pipeline & ((1u << PIPELINE_BITS) - 1)) << PIPELINE_SHIFT) |
+               (static_cast<uint64_t>(descriptor_set & ((1u << DESCRIPTOR_SET_BITS) - 1)) << DESCRIPTOR_SET_SHIFT) |
+               (static_cast<uint64_t>(quantized) << DEPTH_SHIFT);
+    }
+
+    uint32_t
+    RenderQueue::get_pass(
+        uint64_t key) noexcept
+    {
+        return static_cast<uint32_t>(key >> PASS_SHIFT) & ((1u << PASS_BITS) - 1);
+    }
+
+    uint32_t
+    RenderQueue::get_pipeline(
+        uint64_t key) noexcept
+    {
+        return static_cast<uint32_t>(key >> PIPELINE_SHIFT) & ((1u << PIPELINE_BITS) - 1);
+    }
+
+    uint32_t
+    RenderQueue::get_descriptor_set(
+        uint64_t key) noexcept
+    {
+        return static_cast<uint32_t>(key >> DESCRIPTOR_SET_SHIFT) & ((1u << DESCRIPTOR_SET_BITS) - 1);
+    }
+
+    uint32_t
+    RenderQueue::get_depth(
+        uint64_t key) noexcept
+    {
+        return static_cast<uint32_t>(key >> DEPTH_SHIFT) & ((1u << DEPTH_BITS) - 1);
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,121 @@
+#ifndef __VL_RENDERQUEUE_HPP__
+#define __VL_RENDERQUEUE_HPP__
+
+#include <vector>
+#include <ntl/NTL.hpp>
+#include "ThreadPool.hpp"
+
+namespace vl
+{
+    /// @brief 绘制队列：用64位排序键对绘制排序，使相同的状态相邻
+    /// @details 键从高到低依次为通道、管线、描述符集、深度，按键升序排序后，
+    /// 录制时只有在某一部分变化时才需要重新绑定
+    class RenderQueue : public ntl::Object
+    {
+    public:
+        using SelfType = RenderQueue;
+        using ParentType = ntl::Object;
+
+        /// @brief 排序后相邻两项之间变化的部分
+        enum Change : uint32_t
+        {
+            CHANGE_PASS = 1,
+            CHANGE_PIPELINE = 2,
+            CHANGE_DESCRIPTOR_SET = 4,
+        };
+
+        /// @brief 录制时的状态变化统计
+        struct Statistics
+        {
+            size_t m_draw_count = 0;
+            size_t m_pass_changes = 0;
+            size_t m_pipeline_changes = 0;
+            size_t m_descriptor_set_changes = 0;
+        };
+
+        static constexpr uint32_t PASS_BITS = 8;
+        static constexpr uint32_t PIPELINE_BITS = 12;
+        static constexpr uint32_t DESCRIPTOR_SET_BITS = 20;
+        static constexpr uint32_t DEPTH_BITS = 24;
+
+        static constexpr uint32_t DEPTH_SHIFT = 0;
+        static constexpr uint32_t DESCRIPTOR_SET_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+        static constexpr uint32_t PIPELINE_SHIFT = DESCRIPTOR_SET_SHIFT + DESCRIPTOR_SET_BITS;
+        static constexpr uint32_t PASS_SHIFT = PIPELINE_SHIFT + PIPELINE_BITS;
+
+        /// @brief 少于此数量时不并行排序
+        static constexpr size_t PARALLEL_THRESHOLD = 1 << 16;
+
+    protected:
+        std::vector<uint64_t> m_keys;
+        std::vector<uint32_t> m_indices;
+        std::vector<uint64_t> m_temp_keys;
+        std::vector<uint32_t> m_temp_indices;
+
+    public:
+        RenderQueue() = default;
+        explicit RenderQueue(const SelfType &from) = default;
+        ~RenderQueue() override = default;
+
+    public:
+        SelfType &operator=(const SelfType &from) = default;
+
+    public:
+        /// @brief 清空，保留容量
+        void clear() noexcept;
+
+        /// @brief 预留容量
+        /// @param count 数量
+        void reserve(size_t count);
+
+        /// @brief 添加一次绘制
+        /// @param key 排序键
+        /// @param index 调用者的绘制索引
+        void push(uint64_t key, uint32_t index);
+
+        /// @brief 获取数量
+        /// @return 数量
+        size_t size() const noexcept;
+
+        /// @brief 获取排序键
+        /// @return 排序键
+        const std::vector<uint64_t> &get_keys() const noexcept;
+
+        /// @brief 获取绘制索引，排序后与排序键一一对应
+        /// @return 绘制索引
+        const std::vector<uint32_t> &get_indices() const noexcept;
+
+        /// @brief 按键升序做稳定的LSD基数排序，每次8位，所有键相同的字节跳过
+        /// @param pool 线程池，数量足够多时并行统计和分发
+        void sort(ThreadPool *pool = nullptr);
+
+        /// @brief 按当前顺序遍历，告知每次绘制前哪些部分发生了变化
+        /// @tparam Func 函数类型，参数为(uint64_t key, uint32_t index, uint32_t changes)
+        /// @param func 函数，changes为Change的组合，第一项包含全部
+        /// @return 状态变化统计
+        template <typename Func>
+        Statistics emit(Func func) const;
+
+    public:
+        /// @brief 组合排序键
+        /// @param pass 通道
+        /// @param pipeline 管线
+        /// @param descriptor_set 描述符集
+        /// @param depth 归一化的深度，[0, 1]，超出范围的被截断，NaN视为1
+        /// @param is_back_to_front 是否从后往前，用于半透明物体
+        /// @return 排序键
+        static uint64_t make_key(
+            uint32_t pass,
+            uint32_t pipeline,
+            uint32_t descriptor_set,
+            float depth,
+            bool is_back_to_front = false) noexcept;
+
+        static uint32_t get_pass(uint64_t key) noexcept;
+        static uint32_t get_pipeline(uint64_t key) noexcept;
+        static uint32_t get_descriptor_set(uint64_t key) noexcept;
+        static uint32_t get_depth(uint64_t key) noexcept;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,260 @@
+#ifndef __VL_SAMPLERCACHE_CPP__
+#define __VL_SAMPLERCACHE_CPP__
+
+#include <cstring>
+#include <algorithm>
+#include "SamplerCache.hpp"
+
+namespace vl
+{
+    size_t
+    SamplerCache::KeyHash::operator()(
+        const Key &key) const noexcept
+    {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        for (uint32_t word : key)
+            hash = (hash ^ word) * 1099511628211ull;
+        return static_cast<size_t>(hash);
+    }
+
+    void
+    SamplerCache::create(
+        uint32_t max_count) noexcept
+    {
+        m_max_count = max_count;
+    }
+
+    void
+    SamplerCache::destroy(
+        const vk::Device &device)
+    {
+        if (device)
+        {
+            for (const auto &item : m_entries)
+                device.destroySampler(item.second.m_sampler);
+            for (VkSampler sampler : m_uncached)
+                device.destroySampler(sampler);
+        }
+        m_statistics.m_destroyed += m_entries.size() + m_uncached.size();
+        m_statistics.m_live = 0;
+        m_entries.clear();
+        m_keys.clear();
+        m_uncached.clear();
+    }
+
+    vk::ResultValue<vk::Sampler>
+    SamplerCache::acquire(
+        const vk::Device &device,
+        const vk::SamplerCreateInfo &info)
+    {
+        m_statistics.m_requests++;
+        std::optional<Key> key = make_key(info);
+        if (key.has_value())
+        {
+            auto iter = m_entries.find(*key);
+            if (iter != m_entries.end())
+            {
+                iter->second.m_ref_count++;
+                m_statistics.m_hits++;
+                return {vk::Result::eSuccess, iter->second.m_sampler};
+            }
+        }
+
+        // 未使用的采样器可能仍被进行中的帧使用，由调用者在安全的时刻trim
+        if (m_statistics.m_live >= m_max_count)
+        {
+            m_statistics.m_failures++;
+            ntl::log.loge(
+                NTL_STRING("SamplerCache::acquire"),
+                NTL_STRING("Too many samplers in use"));
+            return {vk::Result::eErrorTooManyObjects, vk::Sampler()};
+        }
+
+        auto sampler_result = device.createSampler(info);
+        if (sampler_result.result != vk::Result::eSuccess)
+        {
+            m_statistics.m_failures++;
+            return sampler_result;
+        }
+
+        VkSampler sampler = static_cast<VkSampler>(sampler_result.value);
+        if (key.has_value())
+        {
+            m_entries.emplace(*key, Entry{sampler_result.value, 1});
+            m_keys.emplace(sampler, std::move(*key));
+            m_statistics.m_misses++;
+        }
+        else
+        {
+            m_uncached.insert(sampler);
+            m_statistics.m_uncached++;
+        }
+        m_statistics.m_live++;
+        m_statistics.m_peak_live = std::max(m_statistics.m_peak_live, m_statistics.m_live);
+        return sampler_result;
+    }
+
+    void
+    SamplerCache::release(
+        const vk::Device &device,
+        const vk::Sampler &sampler)
+    {
+        VkSampler handle = static_cast<VkSampler>(sampler);
+        auto key_iter = m_keys.find(handle);
+        if (key_iter != m_keys.end())
+        {
+            Entry &entry = m_entries.at(key_iter->second);
+            if (entry.m_ref_count > 0)
+                entry.m_ref_count--;
+            return;
+        }
+
+        auto uncached_iter = m_uncached.find(handle);
+        if (uncached_iter == m_uncached.end())
+        {
+            ntl::log.loge(
+                NTL_STRING("SamplerCache::release"),
+                NTL_STRING("The sampler was not acquired from the cache"));
+            return;
+        }
+        device.destroySampler(sampler);
+        m_uncached.erase(uncached_iter);
+        m_statistics.m_destroyed++;
+        m_statistics.m_live--;
+    }
+
+    uint32_t
+    SamplerCache::trim(
+        const vk::Device &device)
+    {
+        uint32_t count = 0;
+        for (auto iter = m_entries.begin(); iter != m_entries.end();)
+        {
+            if (iter->second.m_ref_count > 0)
+            {
+                iter++;
+                continue;
+            }
+            device.destroySampler(iter->second.m_sampler);
+            m_keys.erase(static_cast<VkSampler>(iter->second.m_sampler));
+            iter = m_entries.erase(iter);
+            count++;
+        }
+        m_statistics.m_destroyed += count;
+        m_statistics.m_live -= count;
+        return count;
+    }
+
+    uint32_t
+    SamplerCache::get_ref_count(
+        const vk::Sampler &sampler) const noexcept
+    {
+        auto iter = m_keys.find(static_cast<VkSampler>(sampler));
+        if (iter == m_keys.end())
+            return 0;
+        return m_entries.at(iter->second).m_ref_count;
+    }
+
+    uint32_t
+    SamplerCache::get_size() const noexcept
+    {
+        return static_cast<uint32_t>(m_entries.size());
+    }
+
+    double
+    SamplerCache::get_hit_rate() const noexcept
+    {
+        if (m_statistics.m_requests == 0)
+            return 0.0;
+        return static_cast<double>(m_statistics.m_hits) / static_cast<double>(m_statistics.m_requests);
+    }
+
+    const SamplerCache::Statistics &
+    SamplerCache::get_statistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+    ntl::String
+    SamplerCache::format() const
+    {
+        ntl::StringStream sstr;
+        sstr << std::endl
+             << NTL_STRING("\trequests:") << m_statistics.m_requests << std::endl
+             << NTL_STRING("\thits:") << m_statistics.m_hits << std::endl
+             << NTL_STRING("\tmisses:") << m_statistics.m_misses << std::endl
+             << NTL_STRING("\tuncached:") << m_statistics.m_uncached << std::endl
+             << NTL_STRING("\tfailures:") << m_statistics.m_failures << std::endl
+             << NTL_STRING("\tdestroyed:") << m_statistics.m_destroyed << std::endl
+             << NTL_STRING("\tlive:") << m_statistics.m_live << NTL_STRING(" (peak ") << m_statistics.m_peak_live
+             << NTL_STRING(", limit ") << m_max_count << NTL_STRING(")") << std::endl
+             << NTL_STRING("\thit rate:") << get_hit_rate() << std::endl;
+        return sstr.str();
+    }
+
+    std::optional<SamplerCache::Key>
+    SamplerCache::make_key(
+        const vk::SamplerCreateInfo &info)
+    {
+        Key key;
+        key.reserve(24);
+        auto push_float = [&key](float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            key.push_back(bits);
+        };
+        auto push_handle = [&key](uint64_t value)
+        {
+            key.push_back(static_cast<uint32_t>(value));
+            key.push_back(static_cast<uint32_t>(value >> 32));
+        };
+
+        const VkSamplerCreateInfo &c_info = info;
+        key.push_back(c_info.flags);
+        key.push_back(c_info.magFilter);
+        key.push_back(c_info.minFilter);
+        key.push_back(c_info.mipmapMode);
+        key.push_back(c_info.addressModeU);
+        key.push_back(c_info.addressModeV);
+        key.push_back(c_info.addressModeW);
+        push_float(c_info.mipLodBias);
+        key.push_back(c_info.anisotropyEnable);
+        push_float(c_info.maxAnisotropy);
+        key.push_back(c_info.compareEnable);
+        key.push_back(c_info.compareOp);
+        push_float(c_info.minLod);
+        push_float(c_info.maxLod);
+        key.push_back(c_info.borderColor);
+        key.push_back(c_info.unnormalizedCoordinates);
+
+        // 每个结构前加上sType，顺序不同的链视为不同
+        for (const VkBaseInStructure *next = static_cast<const VkBaseInStructure *>(c_info.pNext); next != nullptr; next = next->pNext)
+        {
+            key.push_back(next->sType);
+            switch (next->sType)
+            {
+            case VK_STRUCTURE_TYPE_SAMPLER_REDUCTION_MODE_CREATE_INFO:
+                key.push_back(reinterpret_cast<const VkSamplerReductionModeCreateInfo *>(next)->reductionMode);
+                break;
+            case VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO:
+                push_handle(reinterpret_cast<uint64_t>(reinterpret_cast<const VkSamplerYcbcrConversionInfo *>(next)->conversion));
+                break;
+            case VK_STRUCTURE_TYPE_SAMPLER_CUSTOM_BORDER_COLOR_CREATE_INFO_EXT:
+            {
+                const VkSamplerCustomBorderColorCreateInfoEXT *border = reinterpret_cast<const VkSamplerCustomBorderColorCreateInfoEXT *>(next);
+                for (uint32_t i = 0; i < 4; i++)
+                    key.push_back(border->customBorderColor.uint32[i]);
+                key.push_back(border->format);
+                break;
+            }
+            default:
+                return std::nullopt;
+            }
+        }
+        return key;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,129 @@
+#ifndef __VL_SAMPLERCACHE_HPP__
+#define __VL_SAMPLERCACHE_HPP__
+
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 采样器缓存：按创建信息去重，相同的创建信息共享同一个带引用计数的采样器
+    /// @details 键由创建信息的各个字段和pNext链中已知结构的字段组成，与结构所在的内存无关。
+    /// 链中有未知结构时无法判断是否相同，直接创建不缓存的采样器，释放时销毁。
+    /// 引用计数为0的采样器仍留在缓存中，之后相同的请求直接命中，trim时才销毁。
+    /// 已提交的命令可能仍在使用释放的采样器，所以acquire不会自动trim：采样器数量达到上限（maxSamplerAllocationCount）时返回错误，
+    /// 调用者在这些提交完成后（如帧的完成值已过或设备空闲时）调用trim再重试
+    class SamplerCache : public ntl::Object
+    {
+    public:
+        using SelfType = SamplerCache;
+        using ParentType = ntl::Object;
+
+        /// @brief 缓存的键，每个字段占一个或两个字
+        using Key = std::vector<uint32_t>;
+
+        /// @brief 键的哈希
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const noexcept;
+        };
+
+        /// @brief 统计信息
+        struct Statistics
+        {
+            /// @brief acquire的次数
+            uint64_t m_requests = 0;
+
+            /// @brief 命中缓存的次数
+            uint64_t m_hits = 0;
+
+            /// @brief 未命中，创建了新采样器的次数
+            uint64_t m_misses = 0;
+
+            /// @brief pNext链中有未知结构，创建了不缓存的采样器的次数
+            uint64_t m_uncached = 0;
+
+            /// @brief 达到上限或创建失败的次数
+            uint64_t m_failures = 0;
+
+            /// @brief 销毁的采样器数
+            uint64_t m_destroyed = 0;
+
+            /// @brief 存在的采样器数，包括不缓存的
+            uint32_t m_live = 0;
+            uint32_t m_peak_live = 0;
+        };
+
+    protected:
+        /// @brief 缓存的采样器
+        struct Entry
+        {
+            vk::Sampler m_sampler;
+            uint32_t m_ref_count = 0;
+        };
+
+        /// @brief 采样器数量的上限
+        uint32_t m_max_count = 4000;
+
+        std::unordered_map<Key, Entry, KeyHash> m_entries;
+
+        /// @brief 采样器到键，用于release
+        std::unordered_map<VkSampler, Key> m_keys;
+
+        /// @brief 不缓存的采样器
+        std::unordered_set<VkSampler> m_uncached;
+
+        Statistics m_statistics;
+
+    public:
+        SamplerCache() = default;
+        ~SamplerCache() override = default;
+
+        SamplerCache(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 设置采样器数量的上限
+        /// @param max_count 通常为物理设备的maxSamplerAllocationCount，其他地方创建的采样器需要从中扣除
+        void create(uint32_t max_count) noexcept;
+
+        /// @brief 销毁所有采样器，不检查引用计数
+        void destroy(const vk::Device &device);
+
+        /// @brief 获取与创建信息相同的采样器，引用计数加1
+        /// @param device 逻辑设备
+        /// @param info 创建信息
+        /// @return 采样器，达到上限时为eErrorTooManyObjects，不会销毁未使用的采样器
+        vk::ResultValue<vk::Sampler> acquire(const vk::Device &device, const vk::SamplerCreateInfo &info);
+
+        /// @brief 引用计数减1，不缓存的采样器立即销毁，此时GPU必须已不再使用它
+        void release(const vk::Device &device, const vk::Sampler &sampler);
+
+        /// @brief 销毁引用计数为0的采样器，使用它们的提交必须都已完成
+        /// @return 销毁的数量
+        uint32_t trim(const vk::Device &device);
+
+        /// @brief 获取采样器的引用计数，不是由缓存创建的为0
+        uint32_t get_ref_count(const vk::Sampler &sampler) const noexcept;
+
+        /// @brief 获取缓存的采样器数
+        uint32_t get_size() const noexcept;
+
+        /// @brief 获取命中率
+        double get_hit_rate() const noexcept;
+
+        const Statistics &get_statistics() const noexcept;
+
+        ntl::String format() const;
+
+    public:
+        /// @brief 生成创建信息的键
+        /// @return pNext链中有未知结构时为空
+        static std::optional<Key> make_key(const vk::SamplerCreateInfo &info);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,364 @@
+#ifndef __VL_SHADERARCHIVE_CPP__
+#define __VL_SHADERARCHIVE_CPP__
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+#include "ShaderArchive.hpp"
+
+namespace vl
+{
+    static_assert(sizeof(ShaderArchive::Header) == 16, "ShaderArchive::Header must be packed");
+    static_assert(sizeof(ShaderArchive::Entry) == 88, "ShaderArchive::Entry must be packed");
+
+    ShaderArchive::~ShaderArchive()
+    {
+        close();
+    }
+
+    bool
+    ShaderArchive::open(
+        const std::string &path,
+        Mode mode)
+    {
+        close();
+        if (!m_file.open(path, mode))
+            return false;
+
+        m_data = m_file.get_data();
+        m_size = m_file.get_size();
+        if (!parse())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool
+    ShaderArchive::open_memory(
+        const void *data,
+        size_t size)
+    {
+        close();
+        m_data = static_cast<const uint8_t *>(data);
+        m_size = size;
+        if (!parse())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void
+    ShaderArchive::close() noexcept
+    {
+        m_file.close();
+        m_data = nullptr;
+        m_size = 0;
+        m_header = nullptr;
+        m_entries = nullptr;
+    }
+
+    bool
+    ShaderArchive::is_open() const noexcept
+    {
+        return m_header != nullptr;
+    }
+
+    const ShaderArchive::Header &
+    ShaderArchive::get_header() const noexcept
+    {
+        return *m_header;
+    }
+
+    const ShaderArchive::Entry *
+    ShaderArchive::get_entries() const noexcept
+    {
+        return m_entries;
+    }
+
+    const ShaderArchive::Entry *
+    ShaderArchive::find(const std::string &name) const noexcept
+    {
+        if (m_header == nullptr || name.size() >= MAX_NAME_LENGTH)
+            return nullptr;
+        const Entry *end = m_entries + m_header->m_entry_count;
+        const Entry *iter = std::lower_bound(
+            m_entries, end, name,
+            [](const Entry &entry, const std::string &value)
+            { return std::strncmp(entry.m_name, value.c_str(), MAX_NAME_LENGTH) < 0; });
+        if (iter == end || std::strncmp(iter->m_name, name.c_str(), MAX_NAME_LENGTH) != 0)
+            return nullptr;
+        return iter;
+    }
+
+    const uint32_t *
+    ShaderArchive::get_code(const Entry &entry) const noexcept
+    {
+        return reinterpret_cast<const uint32_t *>(m_data + entry.m_offset);
+    }
+
+    uint64_t
+    ShaderArchive::hash(
+        const uint32_t *code,
+        size_t size) noexcept
+    {
+        // FNV-1a，每次一个字
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size / sizeof(uint32_t); i++)
+            hash = (hash ^ code[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    std::vector<uint32_t>
+    ShaderArchive::strip(
+        const uint32_t *code,
+        size_t size)
+    {
+        enum : uint32_t
+        {
+            SPIRV_MAGIC = 0x07230203,
+            OP_SOURCE_CONTINUED = 2,
+            OP_SOURCE = 3,
+            OP_SOURCE_EXTENSION = 4,
+            OP_NAME = 5,
+            OP_MEMBER_NAME = 6,
+            OP_STRING = 7,
+            OP_LINE = 8,
+            OP_EXTENSION = 10,
+            OP_EXT_INST_IMPORT = 11,
+            OP_EXT_INST = 12,
+            OP_NO_LINE = 317,
+            OP_MODULE_PROCESSED = 330,
+            OP_EXT_INST_WITH_FORWARD_REFS_KHR = 4433,
+        };
+
+        size_t word_count = size / sizeof(uint32_t);
+        if (code == nullptr || size % sizeof(uint32_t) != 0 || word_count < 5 || code[0] != SPIRV_MAGIC)
+        {
+            ntl::log.loge(
+                NTL_STRING("ShaderArchive::strip"),
+                NTL_STRING("Invalid SPIR-V module"));
+            return {};
+        }
+
+        // 文件头不变，ID上界保持原值
+        std::vector<uint32_t> result(code, code + 5);
+        result.reserve(word_count);
+        std::unordered_set<uint32_t> non_semantic_sets;
+        for (size_t i = 5; i < word_count;)
+        {
+            uint32_t count = code[i] >> 16;
+            uint32_t opcode = code[i] & 0xFFFF;
+            if (count == 0 || i + count > word_count)
+            {
+                ntl::log.loge(
+                    NTL_STRING("ShaderArchive::strip"),
+                    NTL_STRING("Truncated instruction"));
+                return {};
+            }
+            const uint32_t *instruction = code + i;
+            i += count;
+
+            bool is_debug = false;
+            switch (opcode)
+            {
+            case OP_SOURCE_CONTINUED:
+            case OP_SOURCE:
+            case OP_SOURCE_EXTENSION:
+            case OP_NAME:
+            case OP_MEMBER_NAME:
+            case OP_STRING:
+            case OP_LINE:
+            case OP_NO_LINE:
+            case OP_MODULE_PROCESSED:
+                is_debug = true;
+                break;
+            case OP_EXTENSION:
+            {
+                // 这个拓展只允许用于NonSemantic指令集，指令去掉后不再需要
+                static const char relaxed[] = "SPV_KHR_relaxed_extended_instruction";
+                is_debug = count == 1 + (sizeof(relaxed) + sizeof(uint32_t) - 1) / sizeof(uint32_t) &&
+                           std::memcmp(instruction + 1, relaxed, sizeof(relaxed)) == 0;
+                break;
+            }
+            case OP_EXT_INST_IMPORT:
+            {
+                // NonSemantic.*指令集（如NonSemantic.Shader.DebugInfo）可以整体去掉
+                static const char prefix[] = "NonSemantic.";
+                if (count >= 2 + (sizeof(prefix) - 1) / sizeof(uint32_t) &&
+                    std::memcmp(instruction + 2, prefix, sizeof(prefix) - 1) == 0)
+                {
+                    non_semantic_sets.insert(instruction[1]);
+                    is_debug = true;
+                }
+                break;
+            }
+            case OP_EXT_INST:
+            case OP_EXT_INST_WITH_FORWARD_REFS_KHR:
+                is_debug = count >= 4 && non_semantic_sets.count(instruction[3]) > 0;
+                break;
+            }
+            if (!is_debug)
+                result.insert(result.end(), instruction, instruction + count);
+        }
+        return result;
+    }
+
+    bool
+    ShaderArchive::write(
+        const std::string &path,
+        const std::vector<Source> &sources,
+        bool is_stripped)
+    {
+        if (sources.size() > MAX_ENTRY_COUNT)
+            return false;
+
+        // 按名称排序，便于打开后二分查找
+        std::vector<const Source *> sorted;
+        for (const Source &source : sources)
+        {
+            if (source.m_name.empty() || source.m_name.size() >= MAX_NAME_LENGTH)
+            {
+                ntl::log.loge(
+                    NTL_STRING("ShaderArchive::write"),
+                    NTL_STRING("Invalid shader name"));
+                return false;
+            }
+            sorted.push_back(&source);
+        }
+        std::sort(
+            sorted.begin(), sorted.end(),
+            [](const Source *a, const Source *b)
+            { return std::strncmp(a->m_name.c_str(), b->m_name.c_str(), MAX_NAME_LENGTH) < 0; });
+        for (size_t i = 1; i < sorted.size(); i++)
+            if (sorted[i - 1]->m_name == sorted[i]->m_name)
+            {
+                ntl::log.loge(
+                    NTL_STRING("ShaderArchive::write"),
+                    NTL_STRING("Duplicate shader name"));
+                return false;
+            }
+
+        // 准备内容，相同哈希且内容相同的只保留第一份
+        std::vector<std::vector<uint32_t>> blobs;
+        std::vector<Entry> table(sorted.size());
+        uint64_t offset = sizeof(Header) + sizeof(Entry) * sorted.size();
+        for (size_t i = 0; i < sorted.size(); i++)
+        {
+            const Source &source = *sorted[i];
+            std::vector<uint32_t> code = is_stripped
+                                             ? strip(source.m_code, source.m_size)
+                                             : std::vector<uint32_t>(source.m_code, source.m_code + source.m_size / sizeof(uint32_t));
+            if (code.empty())
+                return false;
+            uint64_t size = code.size() * sizeof(uint32_t);
+
+            Entry &entry = table[i];
+            std::memcpy(entry.m_name, source.m_name.c_str(), source.m_name.size());
+            entry.m_hash = hash(code.data(), size);
+            entry.m_size = size;
+            entry.m_source_hash = hash(source.m_code, source.m_size);
+            entry.m_source_size = source.m_size;
+            for (size_t j = 0; j < i; j++)
+                if (table[j].m_hash == entry.m_hash && table[j].m_size == size &&
+                    std::memcmp(blobs[j].data(), code.data(), size) == 0)
+                {
+                    entry.m_offset = table[j].m_offset;
+                    break;
+                }
+            if (entry.m_offset == 0)
+            {
+                offset = (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+                entry.m_offset = offset;
+                offset += size;
+            }
+            blobs.push_back(std::move(code));
+        }
+
+        std::ofstream fout(path, std::ios::binary);
+        if (!fout)
+        {
+            ntl::log.loge(
+                NTL_STRING("ShaderArchive::write"),
+                NTL_STRING("Failed to open file"));
+            return false;
+        }
+
+        Header header;
+        header.m_magic = MAGIC;
+        header.m_version = VERSION;
+        header.m_entry_count = static_cast<uint32_t>(table.size());
+        header.m_flags = is_stripped ? static_cast<uint32_t>(FLAG_STRIPPED) : 0u;
+
+        static const char padding[ALIGNMENT] = {};
+        uint64_t position = sizeof(Header) + sizeof(Entry) * table.size();
+        fout.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        fout.write(reinterpret_cast<const char *>(table.data()), static_cast<std::streamsize>(sizeof(Entry) * table.size()));
+        for (size_t i = 0; i < table.size(); i++)
+        {
+            // 重复的内容指向之前的偏移，不再写入
+            if (table[i].m_offset < position)
+                continue;
+            fout.write(padding, static_cast<std::streamsize>(table[i].m_offset - position));
+            fout.write(reinterpret_cast<const char *>(blobs[i].data()), static_cast<std::streamsize>(table[i].m_size));
+            position = table[i].m_offset + table[i].m_size;
+        }
+
+        return static_cast<bool>(fout);
+    }
+
+    bool
+    ShaderArchive::parse()
+    {
+        auto fail = [](const ntl::String &message)
+        {
+            ntl::log.loge(
+                NTL_STRING("ShaderArchive::parse"),
+                message);
+            return false;
+        };
+
+        if (m_data == nullptr || m_size < sizeof(Header))
+            return fail(NTL_STRING("File is too small"));
+
+        // 直接按结构读取，映射按页对齐，std::vector按max_align_t对齐
+        if (reinterpret_cast<uintptr_t>(m_data) % alignof(Entry) != 0)
+            return fail(NTL_STRING("Data is not aligned"));
+        const Header *header = reinterpret_cast<const Header *>(m_data);
+        if (header->m_magic != MAGIC)
+            return fail(NTL_STRING("Invalid magic"));
+        if (header->m_version != VERSION)
+            return fail(NTL_STRING("Unsupported version"));
+        if (header->m_entry_count > MAX_ENTRY_COUNT)
+            return fail(NTL_STRING("Too many entries"));
+        if (m_size < sizeof(Header) + sizeof(Entry) * header->m_entry_count)
+            return fail(NTL_STRING("Entry table is truncated"));
+
+        // 名称以0结尾且严格递增，代码对齐、在文件范围内并以SPIR-V标识开头
+        const Entry *entries = reinterpret_cast<const Entry *>(m_data + sizeof(Header));
+        for (uint32_t i = 0; i < header->m_entry_count; i++)
+        {
+            const Entry &entry = entries[i];
+            if (entry.m_name[0] == '\0' || std::memchr(entry.m_name, '\0', MAX_NAME_LENGTH) == nullptr)
+                return fail(NTL_STRING("Invalid entry name"));
+            if (i > 0 && std::strncmp(entries[i - 1].m_name, entry.m_name, MAX_NAME_LENGTH) >= 0)
+                return fail(NTL_STRING("Entries are not sorted"));
+            if (entry.m_offset % ALIGNMENT != 0 || entry.m_size < 5 * sizeof(uint32_t) || entry.m_size % sizeof(uint32_t) != 0)
+                return fail(NTL_STRING("Invalid entry range"));
+            if (entry.m_offset > m_size || entry.m_size > m_size - entry.m_offset)
+                return fail(NTL_STRING("Entry is out of range"));
+            if (*reinterpret_cast<const uint32_t *>(m_data + entry.m_offset) != 0x07230203)
+                return fail(NTL_STRING("Entry is not SPIR-V"));
+        }
+
+        m_header = header;
+        m_entries = entries;
+        return true;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,169 @@
+#ifndef __VL_SHADERARCHIVE_HPP__
+#define __VL_SHADERARCHIVE_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ntl/NTL.hpp>
+#include "MappedFile.hpp"
+
+namespace vl
+{
+    /// @brief 打包的着色器文件
+    /// @details 文件由文件头、按名称排序的条目表和按ALIGNMENT对齐的SPIR-V组成，数值均为小端序。
+    /// 内容相同的着色器只存一份，多个条目指向同一偏移；条目中保存内容的哈希和去掉调试信息之前原始内容的哈希，
+    /// 加载时不用重新计算。
+    /// 默认用内存映射打开，着色器代码直接从映射传给vkCreateShaderModule
+    class ShaderArchive : public ntl::Object
+    {
+    public:
+        using SelfType = ShaderArchive;
+        using ParentType = ntl::Object;
+
+        /// @brief 打开方式
+        using Mode = MappedFile::Mode;
+
+        /// @brief 文件标志
+        enum Flags : uint32_t
+        {
+            /// @brief 着色器已去掉调试信息
+            FLAG_STRIPPED = 1,
+        };
+
+        /// @brief 文件头
+        struct Header
+        {
+            uint32_t m_magic = 0;
+            uint32_t m_version = 0;
+            uint32_t m_entry_count = 0;
+            uint32_t m_flags = 0;
+        };
+
+        /// @brief 名称的最大字节数，包括结尾的0
+        static constexpr uint32_t MAX_NAME_LENGTH = 48;
+
+        /// @brief 条目表中的一项
+        struct Entry
+        {
+            char m_name[MAX_NAME_LENGTH] = {};
+
+            /// @brief 内容的哈希，见hash
+            uint64_t m_hash = 0;
+
+            /// @brief 相对文件开头的偏移
+            uint64_t m_offset = 0;
+
+            /// @brief 字节数
+            uint64_t m_size = 0;
+
+            /// @brief 写入前原始内容的哈希和字节数，没有去掉调试信息时与m_hash和m_size相同
+            uint64_t m_source_hash = 0;
+            uint64_t m_source_size = 0;
+        };
+
+        /// @brief 写入时的一个着色器
+        struct Source
+        {
+            std::string m_name;
+            const uint32_t *m_code = nullptr;
+            size_t m_size = 0;
+        };
+
+        /// @brief 文件标识"VLSA"
+        static constexpr uint32_t MAGIC = 0x41534C56;
+
+        /// @brief 版本
+        static constexpr uint32_t VERSION = 2;
+
+        /// @brief 着色器代码的对齐
+        static constexpr uint64_t ALIGNMENT = 16;
+
+        /// @brief 最多的条目数
+        static constexpr uint32_t MAX_ENTRY_COUNT = 65536;
+
+    protected:
+        /// @brief 文件的全部内容
+        const uint8_t *m_data = nullptr;
+        size_t m_size = 0;
+
+        const Header *m_header = nullptr;
+        const Entry *m_entries = nullptr;
+
+        /// @brief open打开的文件，open_memory时不使用
+        MappedFile m_file;
+
+    public:
+        ShaderArchive() = default;
+        ~ShaderArchive() override;
+
+        ShaderArchive(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 打开并检查文件
+        /// @param path 路径
+        /// @param mode 打开方式
+        /// @return 是否成功
+        bool open(const std::string &path, Mode mode = Mode::eMap);
+
+        /// @brief 使用内存中的文件内容，不复制，内存需要在close前保持有效
+        /// @param data 内容，至少按8字节对齐
+        /// @param size 字节数
+        /// @return 是否通过检查
+        bool open_memory(const void *data, size_t size);
+
+        /// @brief 关闭
+        void close() noexcept;
+
+        /// @brief 是否已打开
+        /// @return 是否已打开
+        bool is_open() const noexcept;
+
+        /// @brief 获取文件头，需要已打开
+        /// @return 文件头
+        const Header &get_header() const noexcept;
+
+        /// @brief 获取条目表
+        /// @return 条目表，共get_header().m_entry_count项，按名称排序
+        const Entry *get_entries() const noexcept;
+
+        /// @brief 按名称二分查找条目
+        /// @param name 名称
+        /// @return 条目，不存在时为空
+        const Entry *find(const std::string &name) const noexcept;
+
+        /// @brief 获取条目的代码
+        /// @param entry 条目
+        /// @return 代码，对齐到ALIGNMENT
+        const uint32_t *get_code(const Entry &entry) const noexcept;
+
+    public:
+        /// @brief 计算SPIR-V内容的64位哈希
+        /// @param code 代码
+        /// @param size 字节数
+        /// @return 哈希
+        static uint64_t hash(const uint32_t *code, size_t size) noexcept;
+
+        /// @brief 去掉调试信息：OpSource、OpName、OpMemberName、OpString、OpLine、OpModuleProcessed
+        /// 和NonSemantic扩展指令（包括OpExtInstWithForwardRefsKHR及只为它声明的拓展），
+        /// 不影响语义，驱动需要解析的代码更少
+        /// @param code 代码
+        /// @param size 字节数
+        /// @return 去掉后的代码，输入无效时为空
+        static std::vector<uint32_t> strip(const uint32_t *code, size_t size);
+
+        /// @brief 写入文件，条目按名称排序，内容相同的着色器只写一份
+        /// @param path 路径
+        /// @param sources 着色器，名称不能重复，长度小于MAX_NAME_LENGTH
+        /// @param is_stripped 是否先去掉调试信息
+        /// @return 是否成功
+        static bool write(const std::string &path, const std::vector<Source> &sources, bool is_stripped);
+
+    protected:
+        /// @brief 检查m_data中的文件头和条目表
+        /// @return 是否通过
+        bool parse();
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,218 @@
+#ifndef __VL_SHADERLIBRARY_CPP__
+#define __VL_SHADERLIBRARY_CPP__
+
+#include <algorithm>
+#include "ShaderLibrary.hpp"
+#include "DeviceUtils.hpp"
+
+namespace vl
+{
+    size_t
+    ShaderLibrary::KeyHash::operator()(
+        const Key &key) const noexcept
+    {
+        // 第一项已经是内容的哈希
+        return static_cast<size_t>(key.first ^ (key.second * 1099511628211ull));
+    }
+
+    void
+    ShaderLibrary::create(
+        bool is_stripped) noexcept
+    {
+        m_is_stripped = is_stripped;
+    }
+
+    bool
+    ShaderLibrary::open_archive(
+        const std::string &path,
+        ShaderArchive::Mode mode)
+    {
+        return m_archive.open(path, mode);
+    }
+
+    const ShaderArchive &
+    ShaderLibrary::get_archive() const noexcept
+    {
+        return m_archive;
+    }
+
+    void
+    ShaderLibrary::destroy(
+        const vk::Device &device)
+    {
+        if (device)
+            for (const auto &item : m_entries)
+                device.destroyShaderModule(item.second.m_module);
+        m_statistics.m_destroyed += m_entries.size();
+        m_statistics.m_live = 0;
+        m_entries.clear();
+        m_keys.clear();
+        m_archive.close();
+    }
+
+    vk::ResultValue<vk::ShaderModule>
+    ShaderLibrary::acquire(
+        const vk::Device &device,
+        const uint32_t *code,
+        size_t size)
+    {
+        Key key(ShaderArchive::hash(code, size), size);
+        return acquire(device, code, size, key, false);
+    }
+
+    vk::ResultValue<vk::ShaderModule>
+    ShaderLibrary::acquire(
+        const vk::Device &device,
+        const std::string &name)
+    {
+        const ShaderArchive::Entry *entry = m_archive.find(name);
+        if (entry == nullptr)
+        {
+            m_statistics.m_requests++;
+            m_statistics.m_failures++;
+            ntl::log.loge(
+                NTL_STRING("ShaderLibrary::acquire"),
+                NTL_STRING("Shader not found in archive"));
+            return {vk::Result::eErrorUnknown, vk::ShaderModule()};
+        }
+        Key key(entry->m_source_hash, entry->m_source_size);
+        bool is_stripped = (m_archive.get_header().m_flags & ShaderArchive::FLAG_STRIPPED) != 0;
+        return acquire(device, m_archive.get_code(*entry), static_cast<size_t>(entry->m_size), key, is_stripped);
+    }
+
+    void
+    ShaderLibrary::release(
+        const vk::ShaderModule &module)
+    {
+        auto key_iter = m_keys.find(static_cast<VkShaderModule>(module));
+        if (key_iter == m_keys.end())
+        {
+            ntl::log.loge(
+                NTL_STRING("ShaderLibrary::release"),
+                NTL_STRING("The shader module was not acquired from the library"));
+            return;
+        }
+        Entry &entry = m_entries.at(key_iter->second);
+        if (entry.m_ref_count > 0)
+            entry.m_ref_count--;
+    }
+
+    uint32_t
+    ShaderLibrary::trim(
+        const vk::Device &device)
+    {
+        uint32_t count = 0;
+        for (auto iter = m_entries.begin(); iter != m_entries.end();)
+        {
+            if (iter->second.m_ref_count > 0)
+            {
+                iter++;
+                continue;
+            }
+            device.destroyShaderModule(iter->second.m_module);
+            m_keys.erase(static_cast<VkShaderModule>(iter->second.m_module));
+            iter = m_entries.erase(iter);
+            count++;
+        }
+        m_statistics.m_destroyed += count;
+        m_statistics.m_live -= count;
+        return count;
+    }
+
+    uint32_t
+    ShaderLibrary::get_ref_count(
+        const vk::ShaderModule &module) const noexcept
+    {
+        auto iter = m_keys.find(static_cast<VkShaderModule>(module));
+        if (iter == m_keys.end())
+            return 0;
+        return m_entries.at(iter->second).m_ref_count;
+    }
+
+    uint32_t
+    ShaderLibrary::get_size() const noexcept
+    {
+        return static_cast<uint32_t>(m_entries.size());
+    }
+
+    double
+    ShaderLibrary::get_hit_rate() const noexcept
+    {
+        if (m_statistics.m_requests == 0)
+            return 0.0;
+        return static_cast<double>(m_statistics.m_hits) / static_cast<double>(m_statistics.m_requests);
+    }
+
+    const ShaderLibrary::Statistics &
+    ShaderLibrary::get_statistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+    ntl::String
+    ShaderLibrary::format() const
+    {
+        ntl::StringStream sstr;
+        sstr << std::endl
+             << NTL_STRING("\trequests:") << m_statistics.m_requests << std::endl
+             << NTL_STRING("\thits:") << m_statistics.m_hits << std::endl
+             << NTL_STRING("\tmodules created:") << m_statistics.m_modules_created << std::endl
+             << NTL_STRING("\tbytes requested:") << m_statistics.m_bytes_requested << std::endl
+             << NTL_STRING("\tbytes parsed:") << m_statistics.m_bytes_parsed << std::endl
+             << NTL_STRING("\tbytes stripped:") << m_statistics.m_bytes_stripped << std::endl
+             << NTL_STRING("\tfailures:") << m_statistics.m_failures << std::endl
+             << NTL_STRING("\tdestroyed:") << m_statistics.m_destroyed << std::endl
+             << NTL_STRING("\tlive:") << m_statistics.m_live << NTL_STRING(" (peak ") << m_statistics.m_peak_live << NTL_STRING(")") << std::endl
+             << NTL_STRING("\thit rate:") << get_hit_rate() << std::endl;
+        return sstr.str();
+    }
+
+    vk::ResultValue<vk::ShaderModule>
+    ShaderLibrary::acquire(
+        const vk::Device &device,
+        const uint32_t *code,
+        size_t size,
+        const Key &key,
+        bool is_stripped)
+    {
+        m_statistics.m_requests++;
+        m_statistics.m_bytes_requested += size;
+        auto iter = m_entries.find(key);
+        if (iter != m_entries.end())
+        {
+            iter->second.m_ref_count++;
+            m_statistics.m_hits++;
+            return {vk::Result::eSuccess, iter->second.m_module};
+        }
+
+        // 只在未命中时去掉调试信息，键仍为原始内容
+        std::vector<uint32_t> stripped;
+        if (m_is_stripped && !is_stripped)
+        {
+            stripped = ShaderArchive::strip(code, size);
+            if (!stripped.empty())
+            {
+                m_statistics.m_bytes_stripped += size - stripped.size() * sizeof(uint32_t);
+                code = stripped.data();
+                size = stripped.size() * sizeof(uint32_t);
+            }
+        }
+
+        auto module_result = DeviceUtils::create_shader_module(device, code, size);
+        if (module_result.result != vk::Result::eSuccess)
+        {
+            m_statistics.m_failures++;
+            return module_result;
+        }
+
+        m_entries.emplace(key, Entry{module_result.value, 1});
+        m_keys.emplace(static_cast<VkShaderModule>(module_result.value), key);
+        m_statistics.m_modules_created++;
+        m_statistics.m_bytes_parsed += size;
+        m_statistics.m_live++;
+        m_statistics.m_peak_live = std::max(m_statistics.m_peak_live, m_statistics.m_live);
+        return module_result;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
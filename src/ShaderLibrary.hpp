@@ -0,0 +1,159 @@
+#ifndef __VL_SHADERLIBRARY_HPP__
+#define __VL_SHADERLIBRARY_HPP__
+
+#include <string>
+#include <utility>
+#include <unordered_map>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "ShaderArchive.hpp"
+
+namespace vl
+{
+    /// @brief 着色器库：按SPIR-V内容去重着色器模块，相同内容共享同一个带引用计数的模块
+    /// @details 键为传入代码的哈希和字节数，命中时只需计算哈希。启用去掉调试信息时，
+    /// 未命中的代码先去掉调试信息再创建模块，反射得到的名称会为空。
+    /// 可以打开打包的着色器文件，按名称获取模块，代码从内存映射直接传给驱动；
+    /// 按名称获取时使用文件中保存的原始内容的哈希作为键，与按内容获取同一着色器共享模块；
+    /// 引用计数为0的模块留在缓存中直到trim
+    class ShaderLibrary : public ntl::Object
+    {
+    public:
+        using SelfType = ShaderLibrary;
+        using ParentType = ntl::Object;
+
+        /// @brief 缓存的键，原始内容的哈希和字节数
+        using Key = std::pair<uint64_t, uint64_t>;
+
+        /// @brief 键的哈希
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const noexcept;
+        };
+
+        /// @brief 统计信息
+        struct Statistics
+        {
+            /// @brief acquire的次数
+            uint64_t m_requests = 0;
+
+            /// @brief 命中缓存的次数
+            uint64_t m_hits = 0;
+
+            /// @brief 创建的模块数
+            uint64_t m_modules_created = 0;
+
+            /// @brief 请求的代码字节数，包括命中的
+            uint64_t m_bytes_requested = 0;
+
+            /// @brief 交给驱动解析的代码字节数
+            uint64_t m_bytes_parsed = 0;
+
+            /// @brief 去掉的调试信息字节数
+            uint64_t m_bytes_stripped = 0;
+
+            /// @brief 创建失败或名称不存在的次数
+            uint64_t m_failures = 0;
+
+            /// @brief 销毁的模块数
+            uint64_t m_destroyed = 0;
+
+            /// @brief 存在的模块数
+            uint32_t m_live = 0;
+            uint32_t m_peak_live = 0;
+        };
+
+    protected:
+        /// @brief 缓存的模块
+        struct Entry
+        {
+            vk::ShaderModule m_module;
+            uint32_t m_ref_count = 0;
+        };
+
+        /// @brief 是否去掉调试信息
+        bool m_is_stripped = false;
+
+        ShaderArchive m_archive;
+
+        std::unordered_map<Key, Entry, KeyHash> m_entries;
+
+        /// @brief 模块到键，用于release
+        std::unordered_map<VkShaderModule, Key> m_keys;
+
+        Statistics m_statistics;
+
+    public:
+        ShaderLibrary() = default;
+        ~ShaderLibrary() override = default;
+
+        ShaderLibrary(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 设置是否去掉调试信息
+        /// @param is_stripped 发布版本通常为true，调试时保留名称和行号便于RenderDoc等工具查看
+        void create(bool is_stripped) noexcept;
+
+        /// @brief 打开打包的着色器文件
+        /// @param path 路径
+        /// @param mode 打开方式
+        /// @return 是否成功
+        bool open_archive(const std::string &path, ShaderArchive::Mode mode = ShaderArchive::Mode::eMap);
+
+        /// @brief 获取打开的着色器文件
+        const ShaderArchive &get_archive() const noexcept;
+
+        /// @brief 销毁所有模块，不检查引用计数，并关闭着色器文件
+        void destroy(const vk::Device &device);
+
+        /// @brief 获取内容相同的模块，引用计数加1
+        /// @param device 逻辑设备
+        /// @param code 代码
+        /// @param size 字节数
+        /// @return 模块
+        vk::ResultValue<vk::ShaderModule> acquire(
+            const vk::Device &device,
+            const uint32_t *code,
+            size_t size);
+
+        /// @brief 从着色器文件获取模块，使用文件中保存的原始内容的哈希
+        /// @param device 逻辑设备
+        /// @param name 名称
+        /// @return 模块，名称不存在时为eErrorUnknown
+        vk::ResultValue<vk::ShaderModule> acquire(
+            const vk::Device &device,
+            const std::string &name);
+
+        /// @brief 引用计数减1，模块留在缓存中直到trim
+        void release(const vk::ShaderModule &module);
+
+        /// @brief 销毁引用计数为0的模块，管线创建完成后可以调用
+        /// @return 销毁的数量
+        uint32_t trim(const vk::Device &device);
+
+        /// @brief 获取模块的引用计数，不是由库创建的为0
+        uint32_t get_ref_count(const vk::ShaderModule &module) const noexcept;
+
+        /// @brief 获取缓存的模块数
+        uint32_t get_size() const noexcept;
+
+        /// @brief 获取命中率
+        double get_hit_rate() const noexcept;
+
+        const Statistics &get_statistics() const noexcept;
+
+        ntl::String format() const;
+
+    protected:
+        /// @brief 按键查找，未命中时创建模块
+        vk::ResultValue<vk::ShaderModule> acquire(
+            const vk::Device &device,
+            const uint32_t *code,
+            size_t size,
+            const Key &key,
+            bool is_stripped);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
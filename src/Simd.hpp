@@ -0,0 +1,42 @@
+#ifndef __VL_SIMD_HPP__
+#define __VL_SIMD_HPP__
+
+// 按编译目标选择SIMD指令集，定义VL_NO_SIMD时全部使用标量实现
+
+#if !defined(VL_NO_SIMD)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VL_SIMD_SSE2
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#define VL_SIMD_SSSE3
+#endif
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define VL_SIMD_SSE41
+#endif
+
+#if defined(__AVX__)
+#define VL_SIMD_AVX
+#endif
+
+#if defined(__AVX2__)
+#define VL_SIMD_AVX2
+#endif
+
+#if (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#define VL_SIMD_NEON
+#endif
+
+#endif
+
+#if defined(VL_SIMD_SSE2)
+#include <immintrin.h>
+#endif
+
+#if defined(VL_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,776 @@
+#ifndef __VL_SPIRVREFLECTION_CPP__
+#define __VL_SPIRVREFLECTION_CPP__
+
+#include <cstring>
+#include <iterator>
+#include <algorithm>
+#include <unordered_map>
+#include "SpirvReflection.hpp"
+
+namespace vl
+{
+    struct SpirvReflection::Module
+    {
+        /// @brief 用到的操作码、修饰和存储类别，取自SPIR-V规范
+        enum : uint32_t
+        {
+            SPIRV_MAGIC = 0x07230203,
+
+            OP_NAME = 5,
+            OP_ENTRY_POINT = 15,
+            OP_TYPE_BOOL = 20,
+            OP_TYPE_INT = 21,
+            OP_TYPE_FLOAT = 22,
+            OP_TYPE_VECTOR = 23,
+            OP_TYPE_MATRIX = 24,
+            OP_TYPE_IMAGE = 25,
+            OP_TYPE_SAMPLER = 26,
+            OP_TYPE_SAMPLED_IMAGE = 27,
+            OP_TYPE_ARRAY = 28,
+            OP_TYPE_RUNTIME_ARRAY = 29,
+            OP_TYPE_STRUCT = 30,
+            OP_TYPE_POINTER = 32,
+            OP_CONSTANT = 43,
+            OP_SPEC_CONSTANT_TRUE = 48,
+            OP_SPEC_CONSTANT_FALSE = 49,
+            OP_SPEC_CONSTANT = 50,
+            OP_VARIABLE = 59,
+            OP_DECORATE = 71,
+            OP_MEMBER_DECORATE = 72,
+            OP_TYPE_ACCELERATION_STRUCTURE = 5341,
+
+            DECORATION_SPEC_ID = 1,
+            DECORATION_BLOCK = 2,
+            DECORATION_BUFFER_BLOCK = 3,
+            DECORATION_ROW_MAJOR = 4,
+            DECORATION_ARRAY_STRIDE = 6,
+            DECORATION_MATRIX_STRIDE = 7,
+            DECORATION_BUILT_IN = 11,
+            DECORATION_LOCATION = 30,
+            DECORATION_BINDING = 33,
+            DECORATION_DESCRIPTOR_SET = 34,
+            DECORATION_OFFSET = 35,
+
+            STORAGE_UNIFORM_CONSTANT = 0,
+            STORAGE_INPUT = 1,
+            STORAGE_UNIFORM = 2,
+            STORAGE_PUSH_CONSTANT = 9,
+            STORAGE_STORAGE_BUFFER = 12,
+
+            DIM_BUFFER = 5,
+            DIM_SUBPASS_DATA = 6,
+
+            NONE = UINT32_MAX,
+        };
+
+        /// @brief 类型，操作数不包括结果ID
+        struct Type
+        {
+            uint32_t m_opcode = 0;
+            std::vector<uint32_t> m_operands;
+        };
+
+        /// @brief 变量或结构成员的修饰
+        struct Decoration
+        {
+            uint32_t m_set = NONE;
+            uint32_t m_binding = NONE;
+            uint32_t m_location = NONE;
+            uint32_t m_spec_id = NONE;
+            uint32_t m_offset = NONE;
+            uint32_t m_array_stride = 0;
+            uint32_t m_matrix_stride = 0;
+            bool m_is_block = false;
+            bool m_is_buffer_block = false;
+            bool m_is_row_major = false;
+            bool m_is_built_in = false;
+        };
+
+        struct Variable
+        {
+            uint32_t m_type = 0;
+            uint32_t m_id = 0;
+            uint32_t m_storage = 0;
+        };
+
+        struct SpecConstant
+        {
+            uint32_t m_type = 0;
+            uint32_t m_id = 0;
+            uint64_t m_value = 0;
+        };
+
+        struct EntryPoint
+        {
+            uint32_t m_model = 0;
+            std::string m_name;
+        };
+
+        std::unordered_map<uint32_t, Type> m_types;
+        std::unordered_map<uint32_t, Decoration> m_decorations;
+
+        /// @brief 键为结构ID左移32位加成员序号
+        std::unordered_map<uint64_t, Decoration> m_member_decorations;
+
+        std::unordered_map<uint32_t, std::string> m_names;
+
+        /// @brief 常量和特化常量的（默认）值，用于数组长度
+        std::unordered_map<uint32_t, uint64_t> m_constants;
+
+        std::vector<Variable> m_variables;
+        std::vector<SpecConstant> m_spec_constants;
+        std::vector<EntryPoint> m_entry_points;
+
+        const Type *get_type(uint32_t id) const
+        {
+            auto iter = m_types.find(id);
+            return iter == m_types.end() ? nullptr : &iter->second;
+        }
+
+        const Decoration &get_decoration(uint32_t id) const
+        {
+            static const Decoration empty;
+            auto iter = m_decorations.find(id);
+            return iter == m_decorations.end() ? empty : iter->second;
+        }
+
+        const Decoration &get_member_decoration(uint32_t id, uint32_t member) const
+        {
+            static const Decoration empty;
+            auto iter = m_member_decorations.find((static_cast<uint64_t>(id) << 32) | member);
+            return iter == m_member_decorations.end() ? empty : iter->second;
+        }
+
+        const std::string &get_name(uint32_t id) const
+        {
+            static const std::string empty;
+            auto iter = m_names.find(id);
+            return iter == m_names.end() ? empty : iter->second;
+        }
+
+        uint32_t get_constant(uint32_t id) const
+        {
+            auto iter = m_constants.find(id);
+            return iter == m_constants.end() ? 0 : static_cast<uint32_t>(iter->second);
+        }
+
+        /// @brief 读取以0结尾、按小端序打包在字中的字符串
+        static std::string read_string(const uint32_t *words, size_t count)
+        {
+            std::string result;
+            for (size_t i = 0; i < count; i++)
+                for (uint32_t j = 0; j < 4; j++)
+                {
+                    char c = static_cast<char>((words[i] >> (j * 8)) & 0xFF);
+                    if (c == '\0')
+                        return result;
+                    result.push_back(c);
+                }
+            return result;
+        }
+    };
+
+    bool
+    SpirvReflection::parse(
+        const uint32_t *code,
+        size_t size,
+        const std::string &entry_point)
+    {
+        size_t word_count = size / sizeof(uint32_t);
+        if (code == nullptr || size % sizeof(uint32_t) != 0 || word_count < 5 || code[0] != Module::SPIRV_MAGIC)
+        {
+            ntl::log.loge(
+                NTL_STRING("SpirvReflection::parse"),
+                NTL_STRING("Invalid SPIR-V module"));
+            return false;
+        }
+
+        // 第一遍：收集类型、修饰、常量和变量，声明都在函数之前
+        Module module;
+        for (size_t i = 5; i < word_count;)
+        {
+            uint32_t count = code[i] >> 16;
+            uint32_t opcode = code[i] & 0xFFFF;
+            if (count == 0 || i + count > word_count)
+            {
+                ntl::log.loge(
+                    NTL_STRING("SpirvReflection::parse"),
+                    NTL_STRING("Truncated instruction"));
+                return false;
+            }
+            const uint32_t *operands = code + i + 1;
+            uint32_t operand_count = count - 1;
+            i += count;
+
+            switch (opcode)
+            {
+            case Module::OP_NAME:
+                if (operand_count >= 2)
+                    module.m_names[operands[0]] = Module::read_string(operands + 1, operand_count - 1);
+                break;
+            case Module::OP_ENTRY_POINT:
+                if (operand_count >= 3)
+                    module.m_entry_points.push_back({operands[0], Module::read_string(operands + 2, operand_count - 2)});
+                break;
+            case Module::OP_TYPE_BOOL:
+            case Module::OP_TYPE_INT:
+            case Module::OP_TYPE_FLOAT:
+            case Module::OP_TYPE_VECTOR:
+            case Module::OP_TYPE_MATRIX:
+            case Module::OP_TYPE_IMAGE:
+            case Module::OP_TYPE_SAMPLER:
+            case Module::OP_TYPE_SAMPLED_IMAGE:
+            case Module::OP_TYPE_ARRAY:
+            case Module::OP_TYPE_RUNTIME_ARRAY:
+            case Module::OP_TYPE_STRUCT:
+            case Module::OP_TYPE_POINTER:
+            case Module::OP_TYPE_ACCELERATION_STRUCTURE:
+                if (operand_count >= 1)
+                    module.m_types[operands[0]] = {opcode, std::vector<uint32_t>(operands + 1, operands + operand_count)};
+                break;
+            case Module::OP_CONSTANT:
+            case Module::OP_SPEC_CONSTANT:
+            {
+                if (operand_count < 3)
+                    break;
+                uint64_t value = operands[2];
+                if (operand_count >= 4)
+                    value |= static_cast<uint64_t>(operands[3]) << 32;
+                module.m_constants[operands[1]] = value;
+                if (opcode == Module::OP_SPEC_CONSTANT)
+                    module.m_spec_constants.push_back({operands[0], operands[1], value});
+                break;
+            }
+            case Module::OP_SPEC_CONSTANT_TRUE:
+            case Module::OP_SPEC_CONSTANT_FALSE:
+                if (operand_count >= 2)
+                {
+                    uint64_t value = opcode == Module::OP_SPEC_CONSTANT_TRUE ? 1 : 0;
+                    module.m_constants[operands[1]] = value;
+                    module.m_spec_constants.push_back({operands[0], operands[1], value});
+                }
+                break;
+            case Module::OP_VARIABLE:
+                if (operand_count >= 3)
+                    module.m_variables.push_back({operands[0], operands[1], operands[2]});
+                break;
+            case Module::OP_DECORATE:
+            case Module::OP_MEMBER_DECORATE:
+            {
+                bool is_member = opcode == Module::OP_MEMBER_DECORATE;
+                uint32_t first = is_member ? 2 : 1;
+                if (operand_count <= first)
+                    break;
+                Module::Decoration &decoration = is_member
+                                                     ? module.m_member_decorations[(static_cast<uint64_t>(operands[0]) << 32) | operands[1]]
+                                                     : module.m_decorations[operands[0]];
+                uint32_t value = operand_count > first + 1 ? operands[first + 1] : 0;
+                switch (operands[first])
+                {
+                case Module::DECORATION_SPEC_ID:
+                    decoration.m_spec_id = value;
+                    break;
+                case Module::DECORATION_BLOCK:
+                    decoration.m_is_block = true;
+                    break;
+                case Module::DECORATION_BUFFER_BLOCK:
+                    decoration.m_is_buffer_block = true;
+                    break;
+                case Module::DECORATION_ROW_MAJOR:
+                    decoration.m_is_row_major = true;
+                    break;
+                case Module::DECORATION_ARRAY_STRIDE:
+                    decoration.m_array_stride = value;
+                    break;
+                case Module::DECORATION_MATRIX_STRIDE:
+                    decoration.m_matrix_stride = value;
+                    break;
+                case Module::DECORATION_BUILT_IN:
+                    decoration.m_is_built_in = true;
+                    break;
+                case Module::DECORATION_LOCATION:
+                    decoration.m_location = value;
+                    break;
+                case Module::DECORATION_BINDING:
+                    decoration.m_binding = value;
+                    break;
+                case Module::DECORATION_DESCRIPTOR_SET:
+                    decoration.m_set = value;
+                    break;
+                case Module::DECORATION_OFFSET:
+                    decoration.m_offset = value;
+                    break;
+                }
+                break;
+            }
+            }
+        }
+
+        // 选择入口点
+        auto entry_iter = std::find_if(
+            module.m_entry_points.begin(), module.m_entry_points.end(),
+            [&entry_point](const Module::EntryPoint &entry)
+            { return entry_point.empty() || entry.m_name == entry_point; });
+        if (entry_iter == module.m_entry_points.end())
+        {
+            ntl::log.loge(
+                NTL_STRING("SpirvReflection::parse"),
+                NTL_STRING("Entry point not found"));
+            return false;
+        }
+        const vk::ShaderStageFlagBits stages[] = {
+            vk::ShaderStageFlagBits::eVertex,
+            vk::ShaderStageFlagBits::eTessellationControl,
+            vk::ShaderStageFlagBits::eTessellationEvaluation,
+            vk::ShaderStageFlagBits::eGeometry,
+            vk::ShaderStageFlagBits::eFragment,
+            vk::ShaderStageFlagBits::eCompute,
+        };
+        if (entry_iter->m_model >= std::size(stages))
+        {
+            ntl::log.loge(
+                NTL_STRING("SpirvReflection::parse"),
+                NTL_STRING("Unsupported execution model"));
+            return false;
+        }
+        vk::ShaderStageFlagBits stage = stages[entry_iter->m_model];
+
+        // 第二遍：按存储类别处理全局变量
+        std::vector<Binding> bindings;
+        PushConstant push_constant;
+        std::vector<VertexInput> vertex_inputs;
+        for (const Module::Variable &variable : module.m_variables)
+        {
+            const Module::Type *pointer = module.get_type(variable.m_type);
+            if (pointer == nullptr || pointer->m_opcode != Module::OP_TYPE_POINTER || pointer->m_operands.size() < 2)
+                continue;
+            uint32_t type_id = pointer->m_operands[1];
+            const Module::Decoration &decoration = module.get_decoration(variable.m_id);
+
+            if (variable.m_storage == Module::STORAGE_PUSH_CONSTANT)
+            {
+                const Module::Type *type = module.get_type(type_id);
+                if (type == nullptr || type->m_opcode != Module::OP_TYPE_STRUCT)
+                    continue;
+                // 范围从第一个用到的成员开始，不同阶段可以使用块的不同部分
+                uint32_t offset = UINT32_MAX;
+                for (uint32_t i = 0; i < type->m_operands.size(); i++)
+                    offset = std::min(offset, module.get_member_decoration(type_id, i).m_offset);
+                uint32_t end = get_type_size(module, type_id, 0, false);
+                push_constant.m_offset = offset == Module::NONE ? 0 : offset;
+                push_constant.m_size = end > push_constant.m_offset ? end - push_constant.m_offset : 0;
+                push_constant.m_stages = stage;
+                push_constant.m_name = module.get_name(variable.m_id);
+                continue;
+            }
+
+            if (variable.m_storage == Module::STORAGE_INPUT)
+            {
+                if (stage != vk::ShaderStageFlagBits::eVertex || decoration.m_is_built_in)
+                    continue;
+                const Module::Type *type = module.get_type(type_id);
+                if (type == nullptr || type->m_opcode == Module::OP_TYPE_STRUCT || decoration.m_location == Module::NONE)
+                    continue;
+                add_vertex_inputs(module, type_id, decoration.m_location, module.get_name(variable.m_id), vertex_inputs);
+                continue;
+            }
+
+            if (variable.m_storage != Module::STORAGE_UNIFORM_CONSTANT &&
+                variable.m_storage != Module::STORAGE_UNIFORM &&
+                variable.m_storage != Module::STORAGE_STORAGE_BUFFER)
+                continue;
+
+            // 剥去数组，得到描述符的数量
+            Binding binding;
+            const Module::Type *type = module.get_type(type_id);
+            while (type != nullptr && (type->m_opcode == Module::OP_TYPE_ARRAY || type->m_opcode == Module::OP_TYPE_RUNTIME_ARRAY))
+            {
+                if (type->m_opcode == Module::OP_TYPE_ARRAY && type->m_operands.size() >= 2)
+                    binding.m_count *= module.get_constant(type->m_operands[1]);
+                else
+                    binding.m_count = 0;
+                type_id = type->m_operands.at(0);
+                type = module.get_type(type_id);
+            }
+            if (type == nullptr)
+                continue;
+
+            switch (type->m_opcode)
+            {
+            case Module::OP_TYPE_STRUCT:
+            {
+                const Module::Decoration &type_decoration = module.get_decoration(type_id);
+                if (variable.m_storage == Module::STORAGE_UNIFORM && type_decoration.m_is_block)
+                    binding.m_type = vk::DescriptorType::eUniformBuffer;
+                else if (variable.m_storage == Module::STORAGE_STORAGE_BUFFER || type_decoration.m_is_buffer_block)
+                    binding.m_type = vk::DescriptorType::eStorageBuffer;
+                else
+                    continue;
+                binding.m_block_size = get_type_size(module, type_id, 0, false);
+                break;
+            }
+            case Module::OP_TYPE_SAMPLER:
+                binding.m_type = vk::DescriptorType::eSampler;
+                break;
+            case Module::OP_TYPE_SAMPLED_IMAGE:
+                binding.m_type = vk::DescriptorType::eCombinedImageSampler;
+                break;
+            case Module::OP_TYPE_IMAGE:
+            {
+                // 操作数：采样类型、维度、深度、数组、多重采样、采样方式（1为采样，2为存储）
+                if (type->m_operands.size() < 6)
+                    continue;
+                uint32_t dim = type->m_operands[1];
+                bool is_storage = type->m_operands[5] == 2;
+                if (dim == Module::DIM_BUFFER)
+                    binding.m_type = is_storage ? vk::DescriptorType::eStorageTexelBuffer : vk::DescriptorType::eUniformTexelBuffer;
+                else if (dim == Module::DIM_SUBPASS_DATA)
+                    binding.m_type = vk::DescriptorType::eInputAttachment;
+                else
+                    binding.m_type = is_storage ? vk::DescriptorType::eStorageImage : vk::DescriptorType::eSampledImage;
+                break;
+            }
+            case Module::OP_TYPE_ACCELERATION_STRUCTURE:
+                binding.m_type = vk::DescriptorType::eAccelerationStructureKHR;
+                break;
+            default:
+                continue;
+            }
+
+            if (decoration.m_set == Module::NONE || decoration.m_binding == Module::NONE)
+            {
+                ntl::log.loge(
+                    NTL_STRING("SpirvReflection::parse"),
+                    NTL_STRING("Resource without descriptor set or binding"));
+                return false;
+            }
+            binding.m_set = decoration.m_set;
+            binding.m_binding = decoration.m_binding;
+            binding.m_stages = stage;
+            // 没有实例名的块取块名
+            binding.m_name = module.get_name(variable.m_id);
+            if (binding.m_name.empty())
+                binding.m_name = module.get_name(type_id);
+            bindings.push_back(std::move(binding));
+        }
+
+        // 特化常量，没有SpecId的是由其他常量计算出来的，跳过
+        std::vector<SpecConstant> spec_constants;
+        for (const Module::SpecConstant &constant : module.m_spec_constants)
+        {
+            const Module::Decoration &decoration = module.get_decoration(constant.m_id);
+            const Module::Type *type = module.get_type(constant.m_type);
+            if (decoration.m_spec_id == Module::NONE || type == nullptr)
+                continue;
+            SpecConstant spec_constant;
+            spec_constant.m_id = decoration.m_spec_id;
+            spec_constant.m_default_value = constant.m_value;
+            spec_constant.m_name = module.get_name(constant.m_id);
+            if (type->m_opcode == Module::OP_TYPE_BOOL)
+                spec_constant.m_type = SCALAR_BOOL;
+            else if (type->m_opcode == Module::OP_TYPE_FLOAT && !type->m_operands.empty())
+            {
+                spec_constant.m_type = SCALAR_FLOAT;
+                spec_constant.m_size = type->m_operands[0] / 8;
+            }
+            else if (type->m_opcode == Module::OP_TYPE_INT && type->m_operands.size() >= 2)
+            {
+                spec_constant.m_type = type->m_operands[1] != 0 ? SCALAR_INT : SCALAR_UINT;
+                spec_constant.m_size = type->m_operands[0] / 8;
+            }
+            else
+                continue;
+            spec_constants.push_back(std::move(spec_constant));
+        }
+
+        std::sort(
+            bindings.begin(), bindings.end(),
+            [](const Binding &a, const Binding &b)
+            { return a.m_set != b.m_set ? a.m_set < b.m_set : a.m_binding < b.m_binding; });
+        std::sort(
+            vertex_inputs.begin(), vertex_inputs.end(),
+            [](const VertexInput &a, const VertexInput &b)
+            { return a.m_location < b.m_location; });
+        std::sort(
+            spec_constants.begin(), spec_constants.end(),
+            [](const SpecConstant &a, const SpecConstant &b)
+            { return a.m_id < b.m_id; });
+
+        m_stage = stage;
+        m_entry_point = entry_iter->m_name;
+        m_bindings = std::move(bindings);
+        m_push_constant = std::move(push_constant);
+        m_vertex_inputs = std::move(vertex_inputs);
+        m_spec_constants = std::move(spec_constants);
+        return true;
+    }
+
+    vk::ShaderStageFlagBits
+    SpirvReflection::get_stage() const noexcept
+    {
+        return m_stage;
+    }
+
+    const std::string &
+    SpirvReflection::get_entry_point() const noexcept
+    {
+        return m_entry_point;
+    }
+
+    const std::vector<SpirvReflection::Binding> &
+    SpirvReflection::get_bindings() const noexcept
+    {
+        return m_bindings;
+    }
+
+    const SpirvReflection::PushConstant &
+    SpirvReflection::get_push_constant() const noexcept
+    {
+        return m_push_constant;
+    }
+
+    const std::vector<SpirvReflection::VertexInput> &
+    SpirvReflection::get_vertex_inputs() const noexcept
+    {
+        return m_vertex_inputs;
+    }
+
+    const std::vector<SpirvReflection::SpecConstant> &
+    SpirvReflection::get_spec_constants() const noexcept
+    {
+        return m_spec_constants;
+    }
+
+    std::vector<vk::VertexInputAttributeDescription>
+    SpirvReflection::make_vertex_attributes(
+        uint32_t binding,
+        uint32_t &stride) const
+    {
+        // 16位格式的大小不一定是4的倍数，偏移对齐到4字节
+        std::vector<vk::VertexInputAttributeDescription> attributes;
+        stride = 0;
+        for (const VertexInput &input : m_vertex_inputs)
+        {
+            attributes.emplace_back(input.m_location, binding, input.m_format, stride);
+            stride += (get_format_size(input.m_format) + 3) & ~3u;
+        }
+        return attributes;
+    }
+
+    std::vector<vk::SpecializationMapEntry>
+    SpirvReflection::make_specialization_entries(
+        std::vector<uint8_t> &data) const
+    {
+        std::vector<vk::SpecializationMapEntry> entries;
+        data.clear();
+        for (const SpecConstant &constant : m_spec_constants)
+        {
+            uint32_t offset = static_cast<uint32_t>(data.size());
+            entries.emplace_back(constant.m_id, offset, constant.m_size);
+            data.resize(offset + constant.m_size);
+            std::memcpy(data.data() + offset, &constant.m_default_value, std::min<size_t>(constant.m_size, sizeof(uint64_t)));
+        }
+        return entries;
+    }
+
+    ntl::String
+    SpirvReflection::format() const
+    {
+        ntl::StringStream sstr;
+        sstr << std::endl
+             << NTL_STRING("\tstage:") << static_cast<uint32_t>(m_stage) << std::endl
+             << NTL_STRING("\tbindings:") << m_bindings.size() << std::endl;
+        for (const Binding &binding : m_bindings)
+            sstr << NTL_STRING("\t\tset ") << binding.m_set << NTL_STRING(" binding ") << binding.m_binding
+                 << NTL_STRING(": type ") << static_cast<uint32_t>(binding.m_type) << NTL_STRING(", count ") << binding.m_count
+                 << NTL_STRING(", block ") << binding.m_block_size << std::endl;
+        sstr << NTL_STRING("\tpush constant:") << m_push_constant.m_offset << NTL_STRING(", ") << m_push_constant.m_size << std::endl
+             << NTL_STRING("\tvertex inputs:") << m_vertex_inputs.size() << std::endl;
+        for (const VertexInput &input : m_vertex_inputs)
+            sstr << NTL_STRING("\t\tlocation ") << input.m_location << NTL_STRING(": format ") << static_cast<uint32_t>(input.m_format) << std::endl;
+        sstr << NTL_STRING("\tspec constants:") << m_spec_constants.size() << std::endl;
+        for (const SpecConstant &constant : m_spec_constants)
+            sstr << NTL_STRING("\t\tid ") << constant.m_id << NTL_STRING(": type ") << static_cast<uint32_t>(constant.m_type)
+                 << NTL_STRING(", size ") << constant.m_size << NTL_STRING(", default ") << constant.m_default_value << std::endl;
+        return sstr.str();
+    }
+
+    uint32_t
+    SpirvReflection::get_format_size(
+        vk::Format format) noexcept
+    {
+        switch (format)
+        {
+        case vk::Format::eR16Sfloat:
+        case vk::Format::eR16Sint:
+        case vk::Format::eR16Uint:
+            return 2;
+        case vk::Format::eR16G16Sfloat:
+        case vk::Format::eR16G16Sint:
+        case vk::Format::eR16G16Uint:
+        case vk::Format::eR32Sfloat:
+        case vk::Format::eR32Sint:
+        case vk::Format::eR32Uint:
+            return 4;
+        case vk::Format::eR16G16B16Sfloat:
+        case vk::Format::eR16G16B16Sint:
+        case vk::Format::eR16G16B16Uint:
+            return 6;
+        case vk::Format::eR16G16B16A16Sfloat:
+        case vk::Format::eR16G16B16A16Sint:
+        case vk::Format::eR16G16B16A16Uint:
+        case vk::Format::eR32G32Sfloat:
+        case vk::Format::eR32G32Sint:
+        case vk::Format::eR32G32Uint:
+        case vk::Format::eR64Sfloat:
+            return 8;
+        case vk::Format::eR32G32B32Sfloat:
+        case vk::Format::eR32G32B32Sint:
+        case vk::Format::eR32G32B32Uint:
+            return 12;
+        case vk::Format::eR32G32B32A32Sfloat:
+        case vk::Format::eR32G32B32A32Sint:
+        case vk::Format::eR32G32B32A32Uint:
+        case vk::Format::eR64G64Sfloat:
+            return 16;
+        case vk::Format::eR64G64B64Sfloat:
+            return 24;
+        case vk::Format::eR64G64B64A64Sfloat:
+            return 32;
+        default:
+            return 0;
+        }
+    }
+
+    uint32_t
+    SpirvReflection::get_type_size(
+        const Module &module,
+        uint32_t type,
+        uint32_t matrix_stride,
+        bool is_row_major)
+    {
+        const Module::Type *info = module.get_type(type);
+        if (info == nullptr)
+            return 0;
+        const std::vector<uint32_t> &operands = info->m_operands;
+        switch (info->m_opcode)
+        {
+        case Module::OP_TYPE_BOOL:
+            return 4;
+        case Module::OP_TYPE_INT:
+        case Module::OP_TYPE_FLOAT:
+            return operands.at(0) / 8;
+        case Module::OP_TYPE_VECTOR:
+            return operands.at(1) * get_type_size(module, operands.at(0), 0, false);
+        case Module::OP_TYPE_MATRIX:
+        {
+            // 列主序时步长在列之间，行主序时在行之间，行数为列向量的分量数
+            uint32_t columns = operands.at(1);
+            if (matrix_stride == 0)
+                return columns * get_type_size(module, operands.at(0), 0, false);
+            const Module::Type *column = module.get_type(operands.at(0));
+            uint32_t rows = column != nullptr && column->m_operands.size() >= 2 ? column->m_operands[1] : columns;
+            return (is_row_major ? rows : columns) * matrix_stride;
+        }
+        case Module::OP_TYPE_ARRAY:
+        {
+            uint32_t stride = module.get_decoration(type).m_array_stride;
+            if (stride == 0)
+                stride = get_type_size(module, operands.at(0), matrix_stride, is_row_major);
+            return module.get_constant(operands.at(1)) * stride;
+        }
+        case Module::OP_TYPE_STRUCT:
+        {
+            // 有Offset修饰时取最远的成员末尾，否则依次排列
+            uint32_t size = 0;
+            for (uint32_t i = 0; i < operands.size(); i++)
+            {
+                const Module::Decoration &member = module.get_member_decoration(type, i);
+                uint32_t offset = member.m_offset == Module::NONE ? size : member.m_offset;
+                size = std::max(size, offset + get_type_size(module, operands[i], member.m_matrix_stride, member.m_is_row_major));
+            }
+            return size;
+        }
+        case Module::OP_TYPE_POINTER:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    vk::Format
+    SpirvReflection::get_vertex_format(
+        const Module &module,
+        uint32_t type)
+    {
+        const Module::Type *info = module.get_type(type);
+        uint32_t components = 1;
+        if (info != nullptr && info->m_opcode == Module::OP_TYPE_VECTOR)
+        {
+            components = info->m_operands.at(1);
+            info = module.get_type(info->m_operands.at(0));
+        }
+        if (info == nullptr || components < 1 || components > 4 || info->m_operands.empty())
+            return vk::Format::eUndefined;
+
+        static const vk::Format float32[] = {vk::Format::eR32Sfloat, vk::Format::eR32G32Sfloat, vk::Format::eR32G32B32Sfloat, vk::Format::eR32G32B32A32Sfloat};
+        static const vk::Format sint32[] = {vk::Format::eR32Sint, vk::Format::eR32G32Sint, vk::Format::eR32G32B32Sint, vk::Format::eR32G32B32A32Sint};
+        static const vk::Format uint32[] = {vk::Format::eR32Uint, vk::Format::eR32G32Uint, vk::Format::eR32G32B32Uint, vk::Format::eR32G32B32A32Uint};
+        static const vk::Format float16[] = {vk::Format::eR16Sfloat, vk::Format::eR16G16Sfloat, vk::Format::eR16G16B16Sfloat, vk::Format::eR16G16B16A16Sfloat};
+        static const vk::Format sint16[] = {vk::Format::eR16Sint, vk::Format::eR16G16Sint, vk::Format::eR16G16B16Sint, vk::Format::eR16G16B16A16Sint};
+        static const vk::Format uint16[] = {vk::Format::eR16Uint, vk::Format::eR16G16Uint, vk::Format::eR16G16B16Uint, vk::Format::eR16G16B16A16Uint};
+        static const vk::Format float64[] = {vk::Format::eR64Sfloat, vk::Format::eR64G64Sfloat, vk::Format::eR64G64B64Sfloat, vk::Format::eR64G64B64A64Sfloat};
+
+        uint32_t width = info->m_operands[0];
+        bool is_signed = info->m_opcode == Module::OP_TYPE_INT && info->m_operands.size() >= 2 && info->m_operands[1] != 0;
+        if (info->m_opcode == Module::OP_TYPE_FLOAT)
+        {
+            if (width == 32)
+                return float32[components - 1];
+            if (width == 16)
+                return float16[components - 1];
+            if (width == 64)
+                return float64[components - 1];
+        }
+        else if (info->m_opcode == Module::OP_TYPE_INT)
+        {
+            if (width == 32)
+                return is_signed ? sint32[components - 1] : uint32[components - 1];
+            if (width == 16)
+                return is_signed ? sint16[components - 1] : uint16[components - 1];
+        }
+        return vk::Format::eUndefined;
+    }
+
+    void
+    SpirvReflection::add_vertex_inputs(
+        const Module &module,
+        uint32_t type,
+        uint32_t location,
+        const std::string &name,
+        std::vector<VertexInput> &inputs)
+    {
+        const Module::Type *info = module.get_type(type);
+        if (info == nullptr)
+            return;
+
+        // 数组的每个元素、矩阵的每一列各占连续的location，64位的三、四分量向量占两个
+        if (info->m_opcode == Module::OP_TYPE_ARRAY || info->m_opcode == Module::OP_TYPE_MATRIX)
+        {
+            uint32_t count = info->m_opcode == Module::OP_TYPE_ARRAY
+                                 ? module.get_constant(info->m_operands.at(1))
+                                 : info->m_operands.at(1);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                size_t first = inputs.size();
+                add_vertex_inputs(module, info->m_operands.at(0), location, name, inputs);
+                for (size_t j = first; j < inputs.size(); j++)
+                    location += get_format_size(inputs[j].m_format) > 16 ? 2 : 1;
+            }
+            return;
+        }
+        inputs.push_back({location, get_vertex_format(module, type), name});
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,172 @@
+#ifndef __VL_SPIRVREFLECTION_HPP__
+#define __VL_SPIRVREFLECTION_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief SPIR-V反射：从着色器模块的代码中取出描述符绑定、推送常量、顶点输入和特化常量
+    /// @details 只解析声明，不分析函数体，因此模块中声明但入口点没有用到的资源也会被列出。
+    /// 模块有多个入口点时按名称选择，用于确定着色器阶段和顶点输入
+    class SpirvReflection : public ntl::Object
+    {
+    public:
+        using SelfType = SpirvReflection;
+        using ParentType = ntl::Object;
+
+        /// @brief 特化常量的类型
+        enum ScalarType : uint32_t
+        {
+            SCALAR_BOOL,
+            SCALAR_INT,
+            SCALAR_UINT,
+            SCALAR_FLOAT,
+        };
+
+        /// @brief 描述符绑定
+        struct Binding
+        {
+            uint32_t m_set = 0;
+            uint32_t m_binding = 0;
+            vk::DescriptorType m_type = vk::DescriptorType::eSampler;
+
+            /// @brief 数组长度，不是数组时为1，运行时大小的数组为0
+            uint32_t m_count = 1;
+
+            vk::ShaderStageFlags m_stages;
+
+            /// @brief 缓冲块的字节数，末尾是运行时大小的数组时不包括数组，不是缓冲时为0
+            uint32_t m_block_size = 0;
+
+            std::string m_name;
+        };
+
+        /// @brief 推送常量块，m_size为0时没有
+        struct PushConstant
+        {
+            /// @brief 第一个成员的偏移
+            uint32_t m_offset = 0;
+            uint32_t m_size = 0;
+            vk::ShaderStageFlags m_stages;
+            std::string m_name;
+        };
+
+        /// @brief 顶点输入，矩阵和数组按每列、每个元素拆成多个location
+        struct VertexInput
+        {
+            uint32_t m_location = 0;
+            vk::Format m_format = vk::Format::eUndefined;
+            std::string m_name;
+        };
+
+        /// @brief 特化常量
+        struct SpecConstant
+        {
+            uint32_t m_id = 0;
+            ScalarType m_type = SCALAR_BOOL;
+
+            /// @brief 字节数，bool为4（VkBool32）
+            uint32_t m_size = 4;
+
+            /// @brief 默认值的位，bool为0或1
+            uint64_t m_default_value = 0;
+
+            std::string m_name;
+        };
+
+    protected:
+        vk::ShaderStageFlagBits m_stage = vk::ShaderStageFlagBits::eVertex;
+        std::string m_entry_point;
+        std::vector<Binding> m_bindings;
+        PushConstant m_push_constant;
+        std::vector<VertexInput> m_vertex_inputs;
+        std::vector<SpecConstant> m_spec_constants;
+
+        /// @brief 解析时的中间结果：类型、修饰、常量和变量
+        struct Module;
+
+    public:
+        SpirvReflection() = default;
+        ~SpirvReflection() override = default;
+
+        SpirvReflection(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 解析着色器模块的代码
+        /// @param code 代码，与vkCreateShaderModule相同
+        /// @param size 字节数，必须是4的倍数
+        /// @param entry_point 入口点名称，为空时取第一个入口点
+        /// @return 是否成功，失败时保留之前的结果
+        bool parse(
+            const uint32_t *code,
+            size_t size,
+            const std::string &entry_point = "main");
+
+        /// @brief 入口点的着色器阶段
+        vk::ShaderStageFlagBits get_stage() const noexcept;
+
+        const std::string &get_entry_point() const noexcept;
+
+        /// @brief 获取描述符绑定，按set和binding排序
+        const std::vector<Binding> &get_bindings() const noexcept;
+
+        /// @brief 获取推送常量块
+        const PushConstant &get_push_constant() const noexcept;
+
+        /// @brief 获取顶点输入，只有顶点着色器有，按location排序
+        const std::vector<VertexInput> &get_vertex_inputs() const noexcept;
+
+        /// @brief 获取特化常量，按ID排序
+        const std::vector<SpecConstant> &get_spec_constants() const noexcept;
+
+        /// @brief 把顶点输入紧密排列在一个顶点缓冲绑定中
+        /// @param binding 顶点缓冲绑定
+        /// @param stride 输出每个顶点的字节数
+        /// @return 属性描述
+        std::vector<vk::VertexInputAttributeDescription> make_vertex_attributes(
+            uint32_t binding,
+            uint32_t &stride) const;
+
+        /// @brief 把特化常量按ID顺序紧密排列
+        /// @param data 输出特化数据，填入默认值，调用者可以修改后用于VkSpecializationInfo
+        /// @return 映射项
+        std::vector<vk::SpecializationMapEntry> make_specialization_entries(
+            std::vector<uint8_t> &data) const;
+
+        ntl::String format() const;
+
+    public:
+        /// @brief 获取顶点格式的字节数，未知格式为0
+        static uint32_t get_format_size(vk::Format format) noexcept;
+
+    protected:
+        /// @brief 计算类型的字节数，运行时大小的数组为0
+        /// @param module 中间结果
+        /// @param type 类型ID
+        /// @param matrix_stride 成员上的MatrixStride修饰，不是矩阵时忽略
+        /// @param is_row_major 成员是否为行主序
+        static uint32_t get_type_size(
+            const Module &module,
+            uint32_t type,
+            uint32_t matrix_stride,
+            bool is_row_major);
+
+        /// @brief 获取标量或向量的顶点格式
+        static vk::Format get_vertex_format(const Module &module, uint32_t type);
+
+        /// @brief 把一个输入变量按location展开
+        static void add_vertex_inputs(
+            const Module &module,
+            uint32_t type,
+            uint32_t location,
+            const std::string &name,
+            std::vector<VertexInput> &inputs);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,171 @@
+#ifndef __VL_STAGINGRING_CPP__
+#define __VL_STAGINGRING_CPP__
+
+#include <algorithm>
+#include "StagingRing.hpp"
+
+namespace vl
+{
+    vk::Result
+    StagingRing::create(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        vk::DeviceSize size)
+    {
+        vk::Result result = m_buffer.create(
+            device,
+            physical_device,
+            size,
+            vk::BufferUsageFlagBits::eTransferSrc,
+            vk::MemoryPropertyFlagBits::eHostCoherent);
+        if (result != vk::Result::eSuccess)
+        {
+            ntl::log.loge(
+                NTL_STRING("StagingRing::create"),
+                ntl::StringUtils::to_string(
+                    NTL_STRING("Failed to create staging buffer, error code:"),
+                    static_cast<long>(result)));
+            return result;
+        }
+
+        m_is_owner = true;
+        reset();
+        return vk::Result::eSuccess;
+    }
+
+    void
+    StagingRing::attach(const MappedBuffer &buffer) noexcept
+    {
+        m_buffer = buffer;
+        m_is_owner = false;
+        reset();
+    }
+
+    void
+    StagingRing::destroy(const vk::Device &device)
+    {
+        if (m_is_owner)
+            m_buffer.destroy(device);
+        m_buffer = MappedBuffer();
+        m_is_owner = false;
+        reset();
+    }
+
+    std::optional<StagingRing::Allocation>
+    StagingRing::allocate(
+        vk::DeviceSize size,
+        vk::DeviceSize alignment)
+    {
+        const vk::DeviceSize capacity = m_buffer.m_size;
+        if (capacity == 0 || size > capacity)
+        {
+            m_statistics.m_failed_allocations++;
+            return std::nullopt;
+        }
+
+        alignment = std::max<vk::DeviceSize>(alignment, 1);
+        vk::DeviceSize offset = (m_head % capacity + alignment - 1) & ~(alignment - 1);
+        vk::DeviceSize skipped = offset - m_head % capacity;
+
+        // 尾部放不下时跳到开头，跳过的部分随下一次分配一起回收
+        if (offset + size > capacity)
+        {
+            skipped = capacity - m_head % capacity;
+            offset = 0;
+        }
+
+        if (m_head + skipped + size - m_tail > capacity)
+        {
+            m_statistics.m_failed_allocations++;
+            return std::nullopt;
+        }
+
+        m_head += skipped + size;
+        m_statistics.m_allocations++;
+        m_statistics.m_bytes += size;
+        if (offset == 0 && skipped > 0)
+            m_statistics.m_wasted_bytes += skipped;
+
+        Allocation allocation;
+        allocation.m_offset = offset;
+        allocation.m_size = size;
+        allocation.m_pointer = static_cast<uint8_t *>(m_buffer.m_mapped) + offset;
+        return allocation;
+    }
+
+    vk::Result
+    StagingRing::flush(const vk::Device &device)
+    {
+        const vk::DeviceSize capacity = m_buffer.m_size;
+        if (m_buffer.m_is_coherent || m_flushed == m_head)
+        {
+            m_flushed = m_head;
+            return vk::Result::eSuccess;
+        }
+
+        // 跨过环尾时分两段刷新
+        vk::DeviceSize begin = m_flushed % capacity;
+        vk::DeviceSize size = m_head - m_flushed;
+        vk::Result result = vk::Result::eSuccess;
+        if (size >= capacity)
+            result = m_buffer.flush(device);
+        else if (begin + size <= capacity)
+            result = m_buffer.flush(device, begin, size);
+        else
+        {
+            result = m_buffer.flush(device, begin, capacity - begin);
+            if (result == vk::Result::eSuccess)
+                result = m_buffer.flush(device, 0, begin + size - capacity);
+        }
+
+        m_flushed = m_head;
+        return result;
+    }
+
+    vk::DeviceSize
+    StagingRing::submit() noexcept
+    {
+        return m_head;
+    }
+
+    void
+    StagingRing::release(vk::DeviceSize mark) noexcept
+    {
+        if (mark > m_tail && mark <= m_head)
+            m_tail = mark;
+    }
+
+    void
+    StagingRing::reset() noexcept
+    {
+        m_head = 0;
+        m_tail = 0;
+        m_flushed = 0;
+    }
+
+    const vk::Buffer &
+    StagingRing::get_buffer() const noexcept
+    {
+        return m_buffer.m_buffer;
+    }
+
+    vk::DeviceSize
+    StagingRing::get_capacity() const noexcept
+    {
+        return m_buffer.m_size;
+    }
+
+    vk::DeviceSize
+    StagingRing::get_used() const noexcept
+    {
+        return m_head - m_tail;
+    }
+
+    const StagingRing::Statistics &
+    StagingRing::get_statistics() const noexcept
+    {
+        return m_statistics;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,127 @@
+#ifndef __VL_STAGINGRING_HPP__
+#define __VL_STAGINGRING_HPP__
+
+#include <optional>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "MappedBuffer.hpp"
+
+namespace vl
+{
+    /// @brief 上传用的环形暂存缓冲
+    /// @details 在一块持久映射的缓冲中按顺序分配，数据直接写入映射的内存，再由复制命令上传。
+    /// 每次提交后调用submit得到一个标记，GPU完成该次提交后调用release回收标记之前的空间
+    class StagingRing : public ntl::Object
+    {
+    public:
+        using SelfType = StagingRing;
+        using ParentType = ntl::Object;
+
+        /// @brief 一次分配
+        struct Allocation
+        {
+            /// @brief 在缓冲中的偏移，用作复制命令的srcOffset
+            vk::DeviceSize m_offset = 0;
+
+            /// @brief 大小
+            vk::DeviceSize m_size = 0;
+
+            /// @brief 映射的地址
+            void *m_pointer = nullptr;
+        };
+
+        /// @brief 统计信息
+        struct Statistics
+        {
+            uint64_t m_allocations = 0;
+            uint64_t m_failed_allocations = 0;
+            uint64_t m_bytes = 0;
+
+            /// @brief 环尾部放不下而跳过的字节数
+            uint64_t m_wasted_bytes = 0;
+        };
+
+    protected:
+        MappedBuffer m_buffer;
+
+        /// @brief 是否由create创建，destroy时需要销毁缓冲
+        bool m_is_owner = false;
+
+        /// @brief 已分配的总字节数，单调增加，对容量取模得到偏移
+        vk::DeviceSize m_head = 0;
+
+        /// @brief 已回收的总字节数
+        vk::DeviceSize m_tail = 0;
+
+        /// @brief 上次刷新到的位置
+        vk::DeviceSize m_flushed = 0;
+
+        Statistics m_statistics;
+
+    public:
+        StagingRing() = default;
+        ~StagingRing() override = default;
+
+        StagingRing(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 创建映射的暂存缓冲
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param size 容量
+        /// @return 结果
+        vk::Result create(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            vk::DeviceSize size);
+
+        /// @brief 使用已有的映射缓冲，不接管它的生命周期
+        /// @param buffer 映射缓冲，用途需要包含TransferSrc
+        void attach(const MappedBuffer &buffer) noexcept;
+
+        /// @brief 销毁create创建的缓冲
+        /// @param device 逻辑设备
+        void destroy(const vk::Device &device);
+
+        /// @brief 分配一段空间，尾部放不下时从头开始
+        /// @param size 大小
+        /// @param alignment 对齐，需要是2的幂，复制到图像时至少为纹素大小
+        /// @return 分配，空间不足时为空，需要先release
+        std::optional<Allocation> allocate(vk::DeviceSize size, vk::DeviceSize alignment = 16);
+
+        /// @brief 刷新上次刷新以来写入的范围，非一致内存需要在提交前调用
+        /// @param device 逻辑设备
+        /// @return 结果
+        vk::Result flush(const vk::Device &device);
+
+        /// @brief 标记到目前为止的分配已随一次提交发出
+        /// @return 标记，该次提交完成后传给release
+        vk::DeviceSize submit() noexcept;
+
+        /// @brief 回收标记之前的空间
+        /// @param mark submit返回的标记
+        void release(vk::DeviceSize mark) noexcept;
+
+        /// @brief 回收全部空间，调用前需要保证设备已不再读取
+        void reset() noexcept;
+
+        /// @brief 获取缓冲
+        /// @return 缓冲
+        const vk::Buffer &get_buffer() const noexcept;
+
+        /// @brief 获取容量
+        /// @return 容量
+        vk::DeviceSize get_capacity() const noexcept;
+
+        /// @brief 获取正在使用的字节数
+        /// @return 字节数
+        vk::DeviceSize get_used() const noexcept;
+
+        /// @brief 获取统计信息
+        /// @return 统计信息
+        const Statistics &get_statistics() const noexcept;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
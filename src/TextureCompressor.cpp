@@ -0,0 +1,1176 @@
+#ifndef __VL_TEXTURECOMPRESSOR_CPP__
+#define __VL_TEXTURECOMPRESSOR_CPP__
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include "TextureCompressor.hpp"
+#include "Simd.hpp"
+
+namespace vl
+{
+    uint32_t
+    TextureCompressor::get_block_bytes(Format format) noexcept
+    {
+        switch (format)
+        {
+        case Format::eBC1:
+        case Format::eBC4:
+        case Format::eETC2:
+        case Format::eEACR:
+            return 8;
+        default:
+            return 16;
+        }
+    }
+
+    size_t
+    TextureCompressor::get_compressed_size(Format format, uint32_t width, uint32_t height) noexcept
+    {
+        size_t block_count = static_cast<size_t>((width + BLOCK_SIZE - 1) / BLOCK_SIZE) * ((height + BLOCK_SIZE - 1) / BLOCK_SIZE);
+        return block_count * get_block_bytes(format);
+    }
+
+    vk::Format
+    TextureCompressor::get_vk_format(Format format) noexcept
+    {
+        switch (format)
+        {
+        case Format::eBC1:
+            return vk::Format::eBc1RgbUnormBlock;
+        case Format::eBC3:
+            return vk::Format::eBc3UnormBlock;
+        case Format::eBC4:
+            return vk::Format::eBc4UnormBlock;
+        case Format::eBC5:
+            return vk::Format::eBc5UnormBlock;
+        case Format::eBC7:
+            return vk::Format::eBc7UnormBlock;
+        case Format::eETC2:
+            return vk::Format::eEtc2R8G8B8UnormBlock;
+        case Format::eETC2A:
+            return vk::Format::eEtc2R8G8B8A8UnormBlock;
+        case Format::eEACR:
+            return vk::Format::eEacR11UnormBlock;
+        case Format::eEACRG:
+            return vk::Format::eEacR11G11UnormBlock;
+        }
+        return vk::Format::eUndefined;
+    }
+
+    const char *
+    TextureCompressor::get_name(Format format) noexcept
+    {
+        switch (format)
+        {
+        case Format::eBC1:
+            return "BC1";
+        case Format::eBC3:
+            return "BC3";
+        case Format::eBC4:
+            return "BC4";
+        case Format::eBC5:
+            return "BC5";
+        case Format::eBC7:
+            return "BC7";
+        case Format::eETC2:
+            return "ETC2";
+        case Format::eETC2A:
+            return "ETC2A";
+        case Format::eEACR:
+            return "EAC R11";
+        case Format::eEACRG:
+            return "EAC RG11";
+        }
+        return "unknown";
+    }
+
+    uint32_t
+    TextureCompressor::get_channel_count(Format format) noexcept
+    {
+        switch (format)
+        {
+        case Format::eBC4:
+        case Format::eEACR:
+            return 1;
+        case Format::eBC5:
+        case Format::eEACRG:
+            return 2;
+        case Format::eBC1:
+        case Format::eETC2:
+            return 3;
+        default:
+            return 4;
+        }
+    }
+
+    std::vector<TextureCompressor::Format>
+    TextureCompressor::get_candidates(Usage usage)
+    {
+        // 不透明颜色取每像素4位的格式，带透明度时BC7优于BC3
+        switch (usage)
+        {
+        case Usage::eColor:
+            return {Format::eBC1, Format::eETC2};
+        case Usage::eColorAlpha:
+            return {Format::eBC7, Format::eBC3, Format::eETC2A};
+        case Usage::eGray:
+            return {Format::eBC4, Format::eEACR};
+        case Usage::eNormal:
+            return {Format::eBC5, Format::eEACRG};
+        }
+        return {};
+    }
+
+    std::optional<TextureCompressor::Format>
+    TextureCompressor::choose_format(const vk::PhysicalDevice &physical_device, Usage usage)
+    {
+        vk::FormatFeatureFlags required =
+            vk::FormatFeatureFlagBits::eSampledImage |
+            vk::FormatFeatureFlagBits::eSampledImageFilterLinear |
+            vk::FormatFeatureFlagBits::eTransferDst;
+        for (Format format : get_candidates(usage))
+        {
+            vk::FormatProperties properties = physical_device.getFormatProperties(get_vk_format(format));
+            if ((properties.optimalTilingFeatures & required) == required)
+                return format;
+        }
+        return std::nullopt;
+    }
+
+    void
+    TextureCompressor::compress(
+        Format format,
+        const uint8_t *pixels,
+        uint32_t width,
+        uint32_t height,
+        uint8_t *destination,
+        ThreadPool *pool)
+    {
+        const uint32_t blocks_x = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const uint32_t blocks_y = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const uint32_t block_bytes = get_block_bytes(format);
+
+        // 每个块独立，按块行分给线程
+        auto compress_rows = [=](size_t begin, size_t end)
+        {
+            uint8_t block[64];
+            for (size_t by = begin; by < end; by++)
+            {
+                uint8_t *output = destination + by * blocks_x * block_bytes;
+                for (uint32_t bx = 0; bx < blocks_x; bx++)
+                {
+                    load_block(pixels, width, height, bx * BLOCK_SIZE, static_cast<uint32_t>(by) * BLOCK_SIZE, block);
+                    encode_block(format, block, output + bx * block_bytes);
+                }
+            }
+        };
+
+        if (pool == nullptr || blocks_y <= PARALLEL_GRAIN)
+            compress_rows(0, blocks_y);
+        else
+            pool->parallel_for(blocks_y, PARALLEL_GRAIN, compress_rows);
+    }
+
+    void
+    TextureCompressor::decompress(
+        Format format,
+        const uint8_t *source,
+        uint32_t width,
+        uint32_t height,
+        uint8_t *pixels,
+        ThreadPool *pool)
+    {
+        const uint32_t blocks_x = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const uint32_t blocks_y = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const uint32_t block_bytes = get_block_bytes(format);
+
+        auto decompress_rows = [=](size_t begin, size_t end)
+        {
+            uint8_t block[64];
+            for (size_t by = begin; by < end; by++)
+            {
+                const uint8_t *input = source + by * blocks_x * block_bytes;
+                for (uint32_t bx = 0; bx < blocks_x; bx++)
+                {
+                    decode_block(format, input + bx * block_bytes, block);
+                    store_block(block, width, height, bx * BLOCK_SIZE, static_cast<uint32_t>(by) * BLOCK_SIZE, pixels);
+                }
+            }
+        };
+
+        if (pool == nullptr || blocks_y <= PARALLEL_GRAIN)
+            decompress_rows(0, blocks_y);
+        else
+            pool->parallel_for(blocks_y, PARALLEL_GRAIN, decompress_rows);
+    }
+
+    void
+    TextureCompressor::encode_block(Format format, const uint8_t block[64], uint8_t *destination) noexcept
+    {
+        switch (format)
+        {
+        case Format::eBC1:
+            encode_bc1(block, destination);
+            break;
+        case Format::eBC3:
+            encode_bc4(block, 3, destination);
+            encode_bc1(block, destination + 8);
+            break;
+        case Format::eBC4:
+            encode_bc4(block, 0, destination);
+            break;
+        case Format::eBC5:
+            encode_bc4(block, 0, destination);
+            encode_bc4(block, 1, destination + 8);
+            break;
+        case Format::eBC7:
+            encode_bc7(block, destination);
+            break;
+        case Format::eETC2:
+            encode_etc2(block, destination);
+            break;
+        case Format::eETC2A:
+            encode_eac(block, 3, false, destination);
+            encode_etc2(block, destination + 8);
+            break;
+        case Format::eEACR:
+            encode_eac(block, 0, true, destination);
+            break;
+        case Format::eEACRG:
+            encode_eac(block, 0, true, destination);
+            encode_eac(block, 1, true, destination + 8);
+            break;
+        }
+    }
+
+    void
+    TextureCompressor::decode_block(Format format, const uint8_t *source, uint8_t block[64]) noexcept
+    {
+        // 没有的通道G、B为0，A为255
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            block[i * 4 + 1] = 0;
+            block[i * 4 + 2] = 0;
+            block[i * 4 + 3] = 255;
+        }
+
+        switch (format)
+        {
+        case Format::eBC1:
+            decode_bc1(source, block);
+            break;
+        case Format::eBC3:
+            decode_bc1(source + 8, block);
+            decode_bc4(source, 3, block);
+            break;
+        case Format::eBC4:
+            decode_bc4(source, 0, block);
+            break;
+        case Format::eBC5:
+            decode_bc4(source, 0, block);
+            decode_bc4(source + 8, 1, block);
+            break;
+        case Format::eBC7:
+            decode_bc7(source, block);
+            break;
+        case Format::eETC2:
+            decode_etc2(source, block);
+            break;
+        case Format::eETC2A:
+            decode_etc2(source + 8, block);
+            decode_eac(source, 3, false, block);
+            break;
+        case Format::eEACR:
+            decode_eac(source, 0, true, block);
+            break;
+        case Format::eEACRG:
+            decode_eac(source, 0, true, block);
+            decode_eac(source + 8, 1, true, block);
+            break;
+        }
+    }
+
+    double
+    TextureCompressor::compute_psnr(
+        Format format,
+        const uint8_t *original,
+        const uint8_t *decoded,
+        uint32_t width,
+        uint32_t height) noexcept
+    {
+        const uint32_t channel_count = get_channel_count(format);
+        const size_t pixel_count = static_cast<size_t>(width) * height;
+        uint64_t sum = 0;
+        for (size_t i = 0; i < pixel_count; i++)
+            for (uint32_t c = 0; c < channel_count; c++)
+            {
+                int32_t difference = static_cast<int32_t>(original[i * 4 + c]) - decoded[i * 4 + c];
+                sum += static_cast<uint64_t>(difference * difference);
+            }
+        if (sum == 0 || pixel_count == 0)
+            return std::numeric_limits<double>::infinity();
+
+        double mse = static_cast<double>(sum) / (static_cast<double>(pixel_count) * channel_count);
+        return 10.0 * std::log10(255.0 * 255.0 / mse);
+    }
+
+    void
+    TextureCompressor::compute_distances(const uint8_t block[64], const uint8_t color[4], bool has_alpha, uint32_t distances[16]) noexcept
+    {
+#if defined(VL_SIMD_SSE2) || defined(VL_SIMD_NEON)
+        uint32_t packed;
+        std::memcpy(&packed, color, sizeof(packed));
+        const uint32_t mask = has_alpha ? 0xffffffffu : 0x00ffffffu;
+#endif
+#if defined(VL_SIMD_SSE2)
+        // 绝对差按字节求出，扩展为16位后madd得到每个像素两对通道的平方和，再两两相加
+        const __m128i reference = _mm_set1_epi32(static_cast<int>(packed));
+        const __m128i channels = _mm_set1_epi32(static_cast<int>(mask));
+        const __m128i zero = _mm_setzero_si128();
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i * 16));
+            __m128i difference = _mm_or_si128(_mm_subs_epu8(pixels, reference), _mm_subs_epu8(reference, pixels));
+            difference = _mm_and_si128(difference, channels);
+            __m128i low = _mm_unpacklo_epi8(difference, zero);
+            __m128i high = _mm_unpackhi_epi8(difference, zero);
+            low = _mm_madd_epi16(low, low);
+            high = _mm_madd_epi16(high, high);
+            __m128 even = _mm_shuffle_ps(_mm_castsi128_ps(low), _mm_castsi128_ps(high), _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 odd = _mm_shuffle_ps(_mm_castsi128_ps(low), _mm_castsi128_ps(high), _MM_SHUFFLE(3, 1, 3, 1));
+            __m128i sum = _mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(distances + i * 4), sum);
+        }
+#elif defined(VL_SIMD_NEON)
+        const uint8x16_t reference = vreinterpretq_u8_u32(vdupq_n_u32(packed));
+        const uint8x16_t channels = vreinterpretq_u8_u32(vdupq_n_u32(mask));
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            uint8x16_t difference = vandq_u8(vabdq_u8(vld1q_u8(block + i * 16), reference), channels);
+            uint16x8_t low = vmull_u8(vget_low_u8(difference), vget_low_u8(difference));
+            uint16x8_t high = vmull_high_u8(difference, difference);
+            vst1q_u32(distances + i * 4, vpaddq_u32(vpaddlq_u16(low), vpaddlq_u16(high)));
+        }
+#else
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t sum = 0;
+            for (uint32_t c = 0; c < (has_alpha ? 4u : 3u); c++)
+            {
+                int32_t difference = static_cast<int32_t>(block[i * 4 + c]) - color[c];
+                sum += static_cast<uint32_t>(difference * difference);
+            }
+            distances[i] = sum;
+        }
+#endif
+    }
+
+    uint32_t
+    TextureCompressor::fit_palette(
+        const uint8_t block[64],
+        const uint8_t (*palette)[4],
+        uint32_t palette_size,
+        bool has_alpha,
+        uint8_t indices[16]) noexcept
+    {
+        uint32_t best[16];
+        uint32_t distances[16];
+        compute_distances(block, palette[0], has_alpha, best);
+        std::memset(indices, 0, 16);
+        for (uint32_t p = 1; p < palette_size; p++)
+        {
+            compute_distances(block, palette[p], has_alpha, distances);
+            for (uint32_t i = 0; i < 16; i++)
+                if (distances[i] < best[i])
+                {
+                    best[i] = distances[i];
+                    indices[i] = static_cast<uint8_t>(p);
+                }
+        }
+
+        uint32_t error = 0;
+        for (uint32_t i = 0; i < 16; i++)
+            error += best[i];
+        return error;
+    }
+
+    void
+    TextureCompressor::find_endpoints(const uint8_t block[64], uint32_t channel_count, float low[4], float high[4]) noexcept
+    {
+        float mean[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (uint32_t i = 0; i < 16; i++)
+            for (uint32_t c = 0; c < channel_count; c++)
+                mean[c] += block[i * 4 + c];
+        for (uint32_t c = 0; c < channel_count; c++)
+            mean[c] /= 16.0f;
+
+        float covariance[4][4] = {};
+        for (uint32_t i = 0; i < 16; i++)
+            for (uint32_t a = 0; a < channel_count; a++)
+                for (uint32_t b = a; b < channel_count; b++)
+                    covariance[a][b] += (block[i * 4 + a] - mean[a]) * (block[i * 4 + b] - mean[b]);
+        for (uint32_t a = 0; a < channel_count; a++)
+            for (uint32_t b = 0; b < a; b++)
+                covariance[a][b] = covariance[b][a];
+
+        // 幂迭代求主轴，从各通道范围构成的方向开始
+        float axis[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (uint32_t c = 0; c < channel_count; c++)
+        {
+            uint8_t minimum = 255, maximum = 0;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                minimum = std::min(minimum, block[i * 4 + c]);
+                maximum = std::max(maximum, block[i * 4 + c]);
+            }
+            axis[c] = static_cast<float>(maximum - minimum);
+        }
+        for (uint32_t iteration = 0; iteration < 8; iteration++)
+        {
+            float next[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            float length = 0.0f;
+            for (uint32_t a = 0; a < channel_count; a++)
+            {
+                for (uint32_t b = 0; b < channel_count; b++)
+                    next[a] += covariance[a][b] * axis[b];
+                length = std::max(length, std::fabs(next[a]));
+            }
+            if (length <= 0.0f)
+                break;
+            for (uint32_t c = 0; c < channel_count; c++)
+                axis[c] = next[c] / length;
+        }
+
+        float length = 0.0f;
+        for (uint32_t c = 0; c < channel_count; c++)
+            length += axis[c] * axis[c];
+        float minimum = 0.0f, maximum = 0.0f;
+        if (length > 0.0f)
+        {
+            length = std::sqrt(length);
+            for (uint32_t c = 0; c < channel_count; c++)
+                axis[c] /= length;
+            minimum = std::numeric_limits<float>::max();
+            maximum = -std::numeric_limits<float>::max();
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                float t = 0.0f;
+                for (uint32_t c = 0; c < channel_count; c++)
+                    t += (block[i * 4 + c] - mean[c]) * axis[c];
+                minimum = std::min(minimum, t);
+                maximum = std::max(maximum, t);
+            }
+        }
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            low[c] = c < channel_count ? std::clamp(mean[c] + axis[c] * minimum, 0.0f, 255.0f) : 255.0f;
+            high[c] = c < channel_count ? std::clamp(mean[c] + axis[c] * maximum, 0.0f, 255.0f) : 255.0f;
+        }
+    }
+
+    bool
+    TextureCompressor::refine_endpoints(const uint8_t block[64], uint32_t channel_count, const float weights[16], float low[4], float high[4]) noexcept
+    {
+        float alpha2 = 0.0f, beta2 = 0.0f, alpha_beta = 0.0f;
+        float alpha_x[4] = {0.0f, 0.0f, 0.0f, 0.0f}, beta_x[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            float beta = weights[i], alpha = 1.0f - beta;
+            alpha2 += alpha * alpha;
+            beta2 += beta * beta;
+            alpha_beta += alpha * beta;
+            for (uint32_t c = 0; c < channel_count; c++)
+            {
+                alpha_x[c] += alpha * block[i * 4 + c];
+                beta_x[c] += beta * block[i * 4 + c];
+            }
+        }
+
+        float determinant = alpha2 * beta2 - alpha_beta * alpha_beta;
+        if (std::fabs(determinant) < 1e-6f)
+            return false;
+        for (uint32_t c = 0; c < channel_count; c++)
+        {
+            low[c] = std::clamp((alpha_x[c] * beta2 - beta_x[c] * alpha_beta) / determinant, 0.0f, 255.0f);
+            high[c] = std::clamp((beta_x[c] * alpha2 - alpha_x[c] * alpha_beta) / determinant, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    void
+    TextureCompressor::load_block(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint8_t block[64]) noexcept
+    {
+        for (uint32_t row = 0; row < BLOCK_SIZE; row++)
+        {
+            const uint8_t *source = pixels + static_cast<size_t>(std::min(y + row, height - 1)) * width * 4;
+            if (x + BLOCK_SIZE <= width)
+            {
+                std::memcpy(block + row * 16, source + x * 4, 16);
+                continue;
+            }
+            for (uint32_t column = 0; column < BLOCK_SIZE; column++)
+                std::memcpy(block + row * 16 + column * 4, source + std::min(x + column, width - 1) * 4, 4);
+        }
+    }
+
+    void
+    TextureCompressor::store_block(const uint8_t block[64], uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint8_t *pixels) noexcept
+    {
+        for (uint32_t row = 0; row < BLOCK_SIZE && y + row < height; row++)
+        {
+            uint32_t count = std::min(BLOCK_SIZE, width - x);
+            std::memcpy(pixels + (static_cast<size_t>(y + row) * width + x) * 4, block + row * 16, count * 4);
+        }
+    }
+
+    void
+    TextureCompressor::bc1_palette(uint16_t color0, uint16_t color1, uint8_t palette[4][4]) noexcept
+    {
+        const uint16_t colors[2] = {color0, color1};
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            uint32_t r = colors[i] >> 11, g = (colors[i] >> 5) & 63, b = colors[i] & 31;
+            palette[i][0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+            palette[i][1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+            palette[i][2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+        }
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            if (color0 > color1)
+            {
+                palette[2][c] = static_cast<uint8_t>((palette[0][c] * 2 + palette[1][c]) / 3);
+                palette[3][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c] * 2) / 3);
+            }
+            else
+            {
+                // 3色模式，不带透明度的格式中最后一个为黑色
+                palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+                palette[3][c] = 0;
+            }
+        }
+        for (uint32_t i = 0; i < 4; i++)
+            palette[i][3] = 255;
+    }
+
+    void
+    TextureCompressor::encode_bc1(const uint8_t block[64], uint8_t destination[8]) noexcept
+    {
+        auto to_565 = [](const float color[4])
+        {
+            uint32_t r = static_cast<uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+            uint32_t g = static_cast<uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+            uint32_t b = static_cast<uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+            return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        };
+
+        // 只使用4色模式：color0 > color1，两个中间色按1/3和2/3插值
+        uint16_t best_colors[2] = {0, 0};
+        uint8_t best_indices[16] = {};
+        uint32_t best_error = UINT32_MAX;
+        auto evaluate = [&](uint16_t color0, uint16_t color1)
+        {
+            if (color0 < color1)
+                std::swap(color0, color1);
+            uint8_t palette[4][4];
+            bc1_palette(color0, color1, palette);
+
+            uint8_t indices[16];
+            uint32_t error = fit_palette(block, palette, color0 == color1 ? 1 : 4, false, indices);
+            if (error < best_error)
+            {
+                best_error = error;
+                best_colors[0] = color0;
+                best_colors[1] = color1;
+                std::memcpy(best_indices, indices, 16);
+            }
+        };
+
+        float low[4], high[4];
+        find_endpoints(block, 3, low, high);
+        evaluate(to_565(high), to_565(low));
+
+        // 按索引的插值权重重新求端点，索引0为color0
+        static const float weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+        for (uint32_t iteration = 0; iteration < 2 && best_error > 0; iteration++)
+        {
+            float index_weights[16];
+            for (uint32_t i = 0; i < 16; i++)
+                index_weights[i] = weights[best_indices[i]];
+            if (!refine_endpoints(block, 3, index_weights, high, low))
+                break;
+            evaluate(to_565(high), to_565(low));
+        }
+
+        uint32_t bits = 0;
+        for (uint32_t i = 0; i < 16; i++)
+            bits |= static_cast<uint32_t>(best_indices[i]) << (i * 2);
+        destination[0] = static_cast<uint8_t>(best_colors[0]);
+        destination[1] = static_cast<uint8_t>(best_colors[0] >> 8);
+        destination[2] = static_cast<uint8_t>(best_colors[1]);
+        destination[3] = static_cast<uint8_t>(best_colors[1] >> 8);
+        for (uint32_t i = 0; i < 4; i++)
+            destination[4 + i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+
+    void
+    TextureCompressor::decode_bc1(const uint8_t source[8], uint8_t block[64]) noexcept
+    {
+        uint8_t palette[4][4];
+        bc1_palette(static_cast<uint16_t>(source[0] | (source[1] << 8)), static_cast<uint16_t>(source[2] | (source[3] << 8)), palette);
+
+        uint32_t bits = source[4] | (source[5] << 8) | (source[6] << 16) | (static_cast<uint32_t>(source[7]) << 24);
+        for (uint32_t i = 0; i < 16; i++)
+            std::memcpy(block + i * 4, palette[(bits >> (i * 2)) & 3], 3);
+    }
+
+    void
+    TextureCompressor::bc4_palette(uint8_t endpoint0, uint8_t endpoint1, uint8_t palette[8]) noexcept
+    {
+        palette[0] = endpoint0;
+        palette[1] = endpoint1;
+        if (endpoint0 > endpoint1)
+            for (uint32_t k = 1; k < 7; k++)
+                palette[k + 1] = static_cast<uint8_t>(((7 - k) * endpoint0 + k * endpoint1 + 3) / 7);
+        else
+        {
+            for (uint32_t k = 1; k < 5; k++)
+                palette[k + 1] = static_cast<uint8_t>(((5 - k) * endpoint0 + k * endpoint1 + 2) / 5);
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void
+    TextureCompressor::encode_bc4(const uint8_t block[64], uint32_t channel, uint8_t destination[8]) noexcept
+    {
+        uint8_t values[16];
+        for (uint32_t i = 0; i < 16; i++)
+            values[i] = block[i * 4 + channel];
+
+        // 8值模式用最小值和最大值；6值模式另有0和255，块中含有这两个值时用其余值的范围
+        uint8_t best_encoded[8] = {};
+        uint32_t best_error = UINT32_MAX;
+        auto evaluate = [&](uint8_t endpoint0, uint8_t endpoint1)
+        {
+            uint8_t palette[8];
+            bc4_palette(endpoint0, endpoint1, palette);
+
+            uint64_t bits = 0;
+            uint32_t error = 0;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                uint32_t best = 0, best_distance = UINT32_MAX;
+                for (uint32_t k = 0; k < 8; k++)
+                {
+                    int32_t difference = static_cast<int32_t>(values[i]) - palette[k];
+                    uint32_t distance = static_cast<uint32_t>(difference * difference);
+                    if (distance < best_distance)
+                    {
+                        best_distance = distance;
+                        best = k;
+                    }
+                }
+                error += best_distance;
+                bits |= static_cast<uint64_t>(best) << (i * 3);
+            }
+            if (error < best_error)
+            {
+                best_error = error;
+                best_encoded[0] = endpoint0;
+                best_encoded[1] = endpoint1;
+                for (uint32_t i = 0; i < 6; i++)
+                    best_encoded[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+            }
+        };
+
+        uint8_t minimum = 255, maximum = 0, inner_minimum = 255, inner_maximum = 0;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            minimum = std::min(minimum, values[i]);
+            maximum = std::max(maximum, values[i]);
+            if (values[i] != 0 && values[i] != 255)
+            {
+                inner_minimum = std::min(inner_minimum, values[i]);
+                inner_maximum = std::max(inner_maximum, values[i]);
+            }
+        }
+        if (maximum > minimum)
+            evaluate(maximum, minimum);
+        else
+            evaluate(minimum, minimum);
+        if (inner_minimum <= inner_maximum && (minimum == 0 || maximum == 255))
+            evaluate(inner_minimum, inner_maximum);
+        std::memcpy(destination, best_encoded, 8);
+    }
+
+    void
+    TextureCompressor::decode_bc4(const uint8_t source[8], uint32_t channel, uint8_t block[64]) noexcept
+    {
+        uint8_t palette[8];
+        bc4_palette(source[0], source[1], palette);
+
+        uint64_t bits = 0;
+        for (uint32_t i = 0; i < 6; i++)
+            bits |= static_cast<uint64_t>(source[2 + i]) << (i * 8);
+        for (uint32_t i = 0; i < 16; i++)
+            block[i * 4 + channel] = palette[(bits >> (i * 3)) & 7];
+    }
+
+    void
+    TextureCompressor::encode_bc7(const uint8_t block[64], uint8_t destination[16]) noexcept
+    {
+        static const uint32_t weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        // 模式6：端点为7位RGBA加每个端点一个共享的最低位(p位)
+        uint8_t best_endpoints[2][4] = {};
+        uint8_t best_indices[16] = {};
+        uint32_t best_error = UINT32_MAX;
+        auto evaluate = [&](const float low[4], const float high[4])
+        {
+            for (uint32_t p = 0; p < 4; p++)
+            {
+                uint8_t endpoints[2][4];
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    uint32_t p0 = p & 1, p1 = p >> 1;
+                    int32_t v0 = static_cast<int32_t>(std::lround((low[c] - p0) / 2.0f));
+                    int32_t v1 = static_cast<int32_t>(std::lround((high[c] - p1) / 2.0f));
+                    endpoints[0][c] = static_cast<uint8_t>(std::clamp(v0, 0, 127) * 2 + p0);
+                    endpoints[1][c] = static_cast<uint8_t>(std::clamp(v1, 0, 127) * 2 + p1);
+                }
+
+                uint8_t palette[16][4];
+                for (uint32_t k = 0; k < 16; k++)
+                    for (uint32_t c = 0; c < 4; c++)
+                        palette[k][c] = static_cast<uint8_t>(((64 - weights[k]) * endpoints[0][c] + weights[k] * endpoints[1][c] + 32) >> 6);
+                uint8_t indices[16];
+                uint32_t error = fit_palette(block, palette, 16, true, indices);
+                if (error < best_error)
+                {
+                    best_error = error;
+                    std::memcpy(best_endpoints, endpoints, sizeof(endpoints));
+                    std::memcpy(best_indices, indices, 16);
+                }
+            }
+        };
+
+        float low[4], high[4];
+        find_endpoints(block, 4, low, high);
+        evaluate(low, high);
+        for (uint32_t iteration = 0; iteration < 2 && best_error > 0; iteration++)
+        {
+            float index_weights[16];
+            for (uint32_t i = 0; i < 16; i++)
+                index_weights[i] = weights[best_indices[i]] / 64.0f;
+            if (!refine_endpoints(block, 4, index_weights, low, high))
+                break;
+            evaluate(low, high);
+        }
+
+        // 第一个像素的索引最高位隐含为0，需要时交换端点
+        if (best_indices[0] & 8)
+        {
+            std::swap(best_endpoints[0], best_endpoints[1]);
+            for (uint32_t i = 0; i < 16; i++)
+                best_indices[i] = static_cast<uint8_t>(15 - best_indices[i]);
+        }
+
+        std::memset(destination, 0, 16);
+        uint32_t position = 0;
+        auto write = [&](uint32_t value, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; i++, position++)
+                destination[position / 8] |= static_cast<uint8_t>(((value >> i) & 1u) << (position % 8));
+        };
+        write(1u << 6, 7);
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            write(best_endpoints[0][c] >> 1, 7);
+            write(best_endpoints[1][c] >> 1, 7);
+        }
+        write(best_endpoints[0][0] & 1u, 1);
+        write(best_endpoints[1][0] & 1u, 1);
+        write(best_indices[0], 3);
+        for (uint32_t i = 1; i < 16; i++)
+            write(best_indices[i], 4);
+    }
+
+    void
+    TextureCompressor::decode_bc7(const uint8_t source[16], uint8_t block[64]) noexcept
+    {
+        static const uint32_t weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        uint32_t position = 0;
+        auto read = [&](uint32_t count)
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < count; i++, position++)
+                value |= ((source[position / 8] >> (position % 8)) & 1u) << i;
+            return value;
+        };
+
+        // 只解码编码器使用的模式6，其余模式输出透明黑色
+        if (read(7) != (1u << 6))
+        {
+            std::memset(block, 0, 64);
+            return;
+        }
+        uint8_t endpoints[2][4];
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            endpoints[0][c] = static_cast<uint8_t>(read(7) << 1);
+            endpoints[1][c] = static_cast<uint8_t>(read(7) << 1);
+        }
+        uint32_t p0 = read(1), p1 = read(1);
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            endpoints[0][c] |= p0;
+            endpoints[1][c] |= p1;
+        }
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t index = read(i == 0 ? 3 : 4);
+            for (uint32_t c = 0; c < 4; c++)
+                block[i * 4 + c] = static_cast<uint8_t>(((64 - weights[index]) * endpoints[0][c] + weights[index] * endpoints[1][c] + 32) >> 6);
+        }
+    }
+
+    void
+    TextureCompressor::encode_etc2(const uint8_t block[64], uint8_t destination[8]) noexcept
+    {
+        static const int32_t tables[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+        // 子块中的像素：不翻转时为左右两个2x4，翻转时为上下两个4x2
+        auto in_subblock = [](uint32_t pixel, uint32_t flip, uint32_t subblock)
+        {
+            uint32_t coordinate = flip ? pixel / 4 : pixel % 4;
+            return (coordinate >= 2) == (subblock == 1);
+        };
+
+        // 为一个子块选择修正值表和每个像素的修正值，返回误差
+        auto fit_subblock = [&](const uint8_t base[3], uint32_t flip, uint32_t subblock, uint32_t &table, uint8_t selectors[16])
+        {
+            uint32_t best_error = UINT32_MAX;
+            for (uint32_t t = 0; t < 8; t++)
+            {
+                // 选择值0到3对应+a、+b、-a、-b
+                const int32_t modifiers[4] = {tables[t][0], tables[t][1], -tables[t][0], -tables[t][1]};
+                uint8_t palette[4][4];
+                for (uint32_t m = 0; m < 4; m++)
+                {
+                    for (uint32_t c = 0; c < 3; c++)
+                        palette[m][c] = static_cast<uint8_t>(std::clamp(base[c] + modifiers[m], 0, 255));
+                    palette[m][3] = 255;
+                }
+                uint8_t indices[16];
+                uint32_t best[16], distances[16];
+                compute_distances(block, palette[0], false, best);
+                std::memset(indices, 0, 16);
+                for (uint32_t m = 1; m < 4; m++)
+                {
+                    compute_distances(block, palette[m], false, distances);
+                    for (uint32_t i = 0; i < 16; i++)
+                        if (distances[i] < best[i])
+                        {
+                            best[i] = distances[i];
+                            indices[i] = static_cast<uint8_t>(m);
+                        }
+                }
+
+                uint32_t error = 0;
+                for (uint32_t i = 0; i < 16; i++)
+                    if (in_subblock(i, flip, subblock))
+                        error += best[i];
+                if (error < best_error)
+                {
+                    best_error = error;
+                    table = t;
+                    for (uint32_t i = 0; i < 16; i++)
+                        if (in_subblock(i, flip, subblock))
+                            selectors[i] = indices[i];
+                }
+            }
+            return best_error;
+        };
+
+        uint64_t best_bits = 0;
+        uint32_t best_error = UINT32_MAX;
+        for (uint32_t flip = 0; flip < 2; flip++)
+        {
+            float averages[2][3] = {};
+            for (uint32_t i = 0; i < 16; i++)
+                for (uint32_t c = 0; c < 3; c++)
+                    averages[in_subblock(i, flip, 1) ? 1 : 0][c] += block[i * 4 + c] / 8.0f;
+
+            for (uint32_t differential = 0; differential < 2; differential++)
+            {
+                float centers[2][3];
+                std::memcpy(centers, averages, sizeof(centers));
+                for (uint32_t pass = 0; pass < 2; pass++)
+                {
+                    // 独立模式每个子块4位颜色；差分模式第一个5位，第二个为3位有符号差值
+                    uint32_t quantized[2][3];
+                    uint8_t bases[2][3];
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        if (differential)
+                        {
+                            int32_t first = std::clamp(static_cast<int32_t>(centers[0][c] * 31.0f / 255.0f + 0.5f), 0, 31);
+                            int32_t second = std::clamp(static_cast<int32_t>(centers[1][c] * 31.0f / 255.0f + 0.5f), 0, 31);
+                            second = std::clamp(second, first - 4, first + 3);
+                            quantized[0][c] = static_cast<uint32_t>(first);
+                            quantized[1][c] = static_cast<uint32_t>(second);
+                            for (uint32_t s = 0; s < 2; s++)
+                                bases[s][c] = static_cast<uint8_t>((quantized[s][c] << 3) | (quantized[s][c] >> 2));
+                        }
+                        else
+                            for (uint32_t s = 0; s < 2; s++)
+                            {
+                                quantized[s][c] = std::min(static_cast<uint32_t>(centers[s][c] * 15.0f / 255.0f + 0.5f), 15u);
+                                bases[s][c] = static_cast<uint8_t>(quantized[s][c] * 17);
+                            }
+                    }
+
+                    uint32_t table_indices[2];
+                    uint8_t selectors[16] = {};
+                    uint32_t error = fit_subblock(bases[0], flip, 0, table_indices[0], selectors) +
+                                     fit_subblock(bases[1], flip, 1, table_indices[1], selectors);
+                    if (error < best_error)
+                    {
+                        best_error = error;
+
+                        uint64_t bits = 0;
+                        for (uint32_t c = 0; c < 3; c++)
+                        {
+                            uint32_t shift = 56 - c * 8;
+                            if (differential)
+                            {
+                                uint32_t delta = (quantized[1][c] - quantized[0][c]) & 7u;
+                                bits |= static_cast<uint64_t>((quantized[0][c] << 3) | delta) << shift;
+                            }
+                            else
+                                bits |= static_cast<uint64_t>((quantized[0][c] << 4) | quantized[1][c]) << shift;
+                        }
+                        bits |= static_cast<uint64_t>(table_indices[0]) << 37;
+                        bits |= static_cast<uint64_t>(table_indices[1]) << 34;
+                        bits |= static_cast<uint64_t>(differential) << 33;
+                        bits |= static_cast<uint64_t>(flip) << 32;
+
+                        // 像素按列编号，选择值的高位在高16位
+                        for (uint32_t i = 0; i < 16; i++)
+                        {
+                            uint32_t column_index = (i % 4) * 4 + i / 4;
+                            bits |= static_cast<uint64_t>(selectors[i] >> 1) << (16 + column_index);
+                            bits |= static_cast<uint64_t>(selectors[i] & 1u) << column_index;
+                        }
+                        best_bits = bits;
+                    }
+
+                    // 修正值确定后，基色取像素减去修正值的平均，再量化一次
+                    float sums[2][3] = {};
+                    for (uint32_t k = 0; k < 16; k++)
+                    {
+                        uint32_t subblock = in_subblock(k, flip, 1) ? 1 : 0;
+                        const int32_t *table = tables[table_indices[subblock]];
+                        int32_t modifier = selectors[k] & 1u ? table[1] : table[0];
+                        if (selectors[k] & 2u)
+                            modifier = -modifier;
+                        for (uint32_t c = 0; c < 3; c++)
+                            sums[subblock][c] += static_cast<float>(block[k * 4 + c] - modifier) / 8.0f;
+                    }
+                    for (uint32_t t = 0; t < 2; t++)
+                        for (uint32_t c = 0; c < 3; c++)
+                            centers[t][c] = std::clamp(sums[t][c], 0.0f, 255.0f);
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < 8; i++)
+            destination[i] = static_cast<uint8_t>(best_bits >> (56 - i * 8));
+    }
+
+    void
+    TextureCompressor::decode_etc2(const uint8_t source[8], uint8_t block[64]) noexcept
+    {
+        static const int32_t tables[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+        uint64_t bits = 0;
+        for (uint32_t i = 0; i < 8; i++)
+            bits = (bits << 8) | source[i];
+
+        // 只解码编码器使用的独立和差分模式，差分溢出表示的T、H、平面模式不支持
+        uint32_t differential = (bits >> 33) & 1u;
+        uint32_t flip = (bits >> 32) & 1u;
+        int32_t bases[2][3];
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            uint32_t value = (bits >> (56 - c * 8)) & 0xffu;
+            if (differential)
+            {
+                int32_t first = static_cast<int32_t>(value >> 3);
+                int32_t delta = static_cast<int32_t>(value & 7u);
+                int32_t second = first + (delta >= 4 ? delta - 8 : delta);
+                second = std::clamp(second, 0, 31);
+                bases[0][c] = (first << 3) | (first >> 2);
+                bases[1][c] = (second << 3) | (second >> 2);
+            }
+            else
+            {
+                bases[0][c] = static_cast<int32_t>(value >> 4) * 17;
+                bases[1][c] = static_cast<int32_t>(value & 15u) * 17;
+            }
+        }
+        uint32_t table_indices[2] = {static_cast<uint32_t>(bits >> 37) & 7u, static_cast<uint32_t>(bits >> 34) & 7u};
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t x = i % 4, y = i / 4;
+            uint32_t subblock = (flip ? y : x) >= 2 ? 1 : 0;
+            uint32_t column_index = x * 4 + y;
+            uint32_t selector = static_cast<uint32_t>(((bits >> (16 + column_index)) & 1u) << 1 | ((bits >> column_index) & 1u));
+            const int32_t *table = tables[table_indices[subblock]];
+            int32_t modifier = selector & 1u ? table[1] : table[0];
+            if (selector & 2u)
+                modifier = -modifier;
+            for (uint32_t c = 0; c < 3; c++)
+                block[i * 4 + c] = static_cast<uint8_t>(std::clamp(bases[subblock][c] + modifier, 0, 255));
+        }
+    }
+
+    void
+    TextureCompressor::encode_eac(const uint8_t block[64], uint32_t channel, bool is_11_bit, uint8_t destination[8]) noexcept
+    {
+        static const int32_t tables[16][8] = {
+            {-3, -6, -9, -15, 2, 5, 8, 14},
+            {-3, -7, -10, -13, 2, 6, 9, 12},
+            {-2, -5, -8, -13, 1, 4, 7, 12},
+            {-2, -4, -6, -13, 1, 3, 5, 12},
+            {-3, -6, -8, -12, 2, 5, 7, 11},
+            {-3, -7, -9, -11, 2, 6, 8, 10},
+            {-4, -7, -8, -11, 3, 6, 7, 10},
+            {-3, -5, -8, -11, 2, 4, 7, 10},
+            {-2, -6, -8, -10, 1, 5, 7, 9},
+            {-2, -5, -8, -10, 1, 4, 7, 9},
+            {-2, -4, -8, -10, 1, 3, 7, 9},
+            {-2, -5, -7, -10, 1, 4, 6, 9},
+            {-3, -4, -7, -10, 2, 3, 6, 9},
+            {-1, -2, -3, -10, 0, 1, 2, 9},
+            {-4, -6, -8, -9, 3, 5, 7, 8},
+            {-3, -5, -7, -9, 2, 4, 6, 8},
+        };
+
+        // 11位时在11位的范围内比较：值为base * 8 + 4 + modifier * multiplier * 8
+        const int32_t scale = is_11_bit ? 8 : 1;
+        const int32_t offset = is_11_bit ? 4 : 0;
+        const int32_t maximum_value = is_11_bit ? 2047 : 255;
+        int32_t targets[16];
+        int32_t minimum = INT32_MAX, maximum = INT32_MIN;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            int32_t value = block[i * 4 + channel];
+            targets[i] = is_11_bit ? (value * 2047 + 127) / 255 : value;
+            minimum = std::min(minimum, targets[i]);
+            maximum = std::max(maximum, targets[i]);
+        }
+
+        uint64_t best_bits = 0;
+        uint32_t best_error = UINT32_MAX;
+        for (uint32_t t = 0; t < 16 && best_error > 0; t++)
+        {
+            const int32_t *table = tables[t];
+            int32_t span = table[7] - table[3];
+            int32_t center = (table[7] + table[3]) * scale;
+            int32_t estimate = std::clamp((maximum - minimum + span * scale / 2) / (span * scale), 1, 15);
+            for (int32_t multiplier = std::max(estimate - 1, 1); multiplier <= std::min(estimate + 1, 15); multiplier++)
+            {
+                // center为两端修正值之和乘以scale，除以2得到中点的偏移
+                int32_t base_estimate = ((minimum + maximum - center * multiplier) / 2 - offset) / scale;
+                for (int32_t base = base_estimate - 1; base <= base_estimate + 1; base++)
+                {
+                    if (base < 0 || base > 255)
+                        continue;
+                    int32_t palette[8];
+                    for (uint32_t k = 0; k < 8; k++)
+                        palette[k] = std::clamp(base * scale + offset + table[k] * multiplier * scale, 0, maximum_value);
+
+                    uint64_t bits = 0;
+                    uint32_t error = 0;
+                    for (uint32_t i = 0; i < 16 && error < best_error; i++)
+                    {
+                        uint32_t best = 0, best_distance = UINT32_MAX;
+                        for (uint32_t k = 0; k < 8; k++)
+                        {
+                            int32_t value = palette[k];
+                            uint32_t distance = static_cast<uint32_t>((value - targets[i]) * (value - targets[i]));
+                            if (distance < best_distance)
+                            {
+                                best_distance = distance;
+                                best = k;
+                            }
+                        }
+                        error += best_distance;
+                        // 像素按列编号，第一个像素在最高的3位
+                        uint32_t column_index = (i % 4) * 4 + i / 4;
+                        bits |= static_cast<uint64_t>(best) << (45 - column_index * 3);
+                    }
+                    if (error < best_error)
+                    {
+                        best_error = error;
+                        best_bits = bits | static_cast<uint64_t>(base) << 56 | static_cast<uint64_t>(multiplier) << 52 | static_cast<uint64_t>(t) << 48;
+                    }
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < 8; i++)
+            destination[i] = static_cast<uint8_t>(best_bits >> (56 - i * 8));
+    }
+
+    void
+    TextureCompressor::decode_eac(const uint8_t source[8], uint32_t channel, bool is_11_bit, uint8_t block[64]) noexcept
+    {
+        static const int32_t tables[16][8] = {
+            {-3, -6, -9, -15, 2, 5, 8, 14},
+            {-3, -7, -10, -13, 2, 6, 9, 12},
+            {-2, -5, -8, -13, 1, 4, 7, 12},
+            {-2, -4, -6, -13, 1, 3, 5, 12},
+            {-3, -6, -8, -12, 2, 5, 7, 11},
+            {-3, -7, -9, -11, 2, 6, 8, 10},
+            {-4, -7, -8, -11, 3, 6, 7, 10},
+            {-3, -5, -8, -11, 2, 4, 7, 10},
+            {-2, -6, -8, -10, 1, 5, 7, 9},
+            {-2, -5, -8, -10, 1, 4, 7, 9},
+            {-2, -4, -8, -10, 1, 3, 7, 9},
+            {-2, -5, -7, -10, 1, 4, 6, 9},
+            {-3, -4, -7, -10, 2, 3, 6, 9},
+            {-1, -2, -3, -10, 0, 1, 2, 9},
+            {-4, -6, -8, -9, 3, 5, 7, 8},
+            {-3, -5, -7, -9, 2, 4, 6, 8},
+        };
+
+        uint64_t bits = 0;
+        for (uint32_t i = 0; i < 8; i++)
+            bits = (bits << 8) | source[i];
+        int32_t base = static_cast<int32_t>(bits >> 56);
+        int32_t multiplier = static_cast<int32_t>((bits >> 52) & 15u);
+        const int32_t *table = tables[(bits >> 48) & 15u];
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t column_index = (i % 4) * 4 + i / 4;
+            int32_t modifier = table[(bits >> (45 - column_index * 3)) & 7u];
+            if (is_11_bit)
+            {
+                // 乘数为0时修正值按1/8使用
+                int32_t value = base * 8 + 4 + (multiplier == 0 ? modifier : modifier * multiplier * 8);
+                block[i * 4 + channel] = static_cast<uint8_t>((std::clamp(value, 0, 2047) * 255 + 1023) / 2047);
+            }
+            else
+                block[i * 4 + channel] = static_cast<uint8_t>(std::clamp(base + modifier * multiplier, 0, 255));
+        }
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,239 @@
+#ifndef __VL_TEXTURECOMPRESSOR_HPP__
+#define __VL_TEXTURECOMPRESSOR_HPP__
+
+#include <cstdint>
+#include <vector>
+#include <optional>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "ThreadPool.hpp"
+
+namespace vl
+{
+    /// @brief 把RGBA8图像压缩为4x4块的BCn或ETC2/EAC格式，并能解压用于计算误差
+    /// @details BC7只使用模式6（单个子集、RGBA端点、4位索引），ETC2只使用与ETC1相同的独立和差分模式，
+    /// 都是合法的码流，压缩质量低于穷举所有模式的编码器，但速度快得多；
+    /// 图像尺寸不是4的倍数时边缘的块重复最后一行、一列
+    class TextureCompressor : public ntl::Object
+    {
+    public:
+        using SelfType = TextureCompressor;
+        using ParentType = ntl::Object;
+
+        /// @brief 压缩格式
+        enum class Format
+        {
+            /// @brief RGB，每块8字节
+            eBC1,
+            /// @brief RGBA，BC1的颜色加BC4的透明度，每块16字节
+            eBC3,
+            /// @brief 单通道R，每块8字节
+            eBC4,
+            /// @brief 双通道RG，用于法线贴图，每块16字节
+            eBC5,
+            /// @brief RGBA，每块16字节
+            eBC7,
+            /// @brief RGB，每块8字节
+            eETC2,
+            /// @brief RGBA，EAC的透明度加ETC2的颜色，每块16字节
+            eETC2A,
+            /// @brief 单通道R，11位，每块8字节
+            eEACR,
+            /// @brief 双通道RG，11位，每块16字节
+            eEACRG,
+        };
+
+        /// @brief 纹理内容，决定可以使用哪些格式
+        enum class Usage
+        {
+            /// @brief 不透明颜色
+            eColor,
+            /// @brief 带透明度的颜色
+            eColorAlpha,
+            /// @brief 单通道，例如粗糙度
+            eGray,
+            /// @brief 切线空间法线，只保存xy
+            eNormal,
+        };
+
+        /// @brief 块的边长
+        static constexpr uint32_t BLOCK_SIZE = 4;
+
+        /// @brief 每个线程任务压缩的块行数
+        static constexpr size_t PARALLEL_GRAIN = 4;
+
+    public:
+        constexpr TextureCompressor() noexcept = default;
+        ~TextureCompressor() override = default;
+
+    public:
+        /// @brief 获取每块的字节数
+        /// @param format 格式
+        /// @return 8或16
+        static uint32_t get_block_bytes(Format format) noexcept;
+
+        /// @brief 获取压缩后的字节数
+        /// @param format 格式
+        /// @param width 宽度
+        /// @param height 高度
+        /// @return 字节数
+        static size_t get_compressed_size(Format format, uint32_t width, uint32_t height) noexcept;
+
+        /// @brief 获取对应的Vulkan格式
+        /// @param format 格式
+        /// @return Vulkan格式，都是UNORM
+        static vk::Format get_vk_format(Format format) noexcept;
+
+        /// @brief 获取格式名
+        /// @param format 格式
+        /// @return 名称，例如"BC7"
+        static const char *get_name(Format format) noexcept;
+
+        /// @brief 获取参与误差计算的通道数
+        /// @param format 格式
+        /// @return 1到4，从R开始
+        static uint32_t get_channel_count(Format format) noexcept;
+
+        /// @brief 获取适合某种内容的格式，按质量从高到低排列，BC在ETC2之前
+        /// @param usage 内容
+        /// @return 格式
+        static std::vector<Format> get_candidates(Usage usage);
+
+        /// @brief 选择设备支持采样和线性过滤的格式
+        /// @details 创建设备时还需要启用对应的textureCompressionBC或textureCompressionETC2特性
+        /// @param physical_device 物理设备
+        /// @param usage 内容
+        /// @return 格式，都不支持时为空，此时应上传未压缩的RGBA8
+        static std::optional<Format> choose_format(const vk::PhysicalDevice &physical_device, Usage usage);
+
+        /// @brief 压缩图像
+        /// @param format 格式
+        /// @param pixels 紧密排列的RGBA8
+        /// @param width 宽度
+        /// @param height 高度
+        /// @param destination 目标，get_compressed_size字节，块按行排列
+        /// @param pool 线程池，为空时在调用线程压缩
+        static void compress(
+            Format format,
+            const uint8_t *pixels,
+            uint32_t width,
+            uint32_t height,
+            uint8_t *destination,
+            ThreadPool *pool = nullptr);
+
+        /// @brief 解压图像
+        /// @param format 格式
+        /// @param source 压缩的块
+        /// @param width 宽度
+        /// @param height 高度
+        /// @param pixels 目标，紧密排列的RGBA8，没有的通道G、B为0，A为255
+        /// @param pool 线程池，为空时在调用线程解压
+        static void decompress(
+            Format format,
+            const uint8_t *source,
+            uint32_t width,
+            uint32_t height,
+            uint8_t *pixels,
+            ThreadPool *pool = nullptr);
+
+        /// @brief 压缩一个块
+        /// @param format 格式
+        /// @param block 16个RGBA8像素，按行排列
+        /// @param destination 目标，get_block_bytes字节
+        static void encode_block(Format format, const uint8_t block[64], uint8_t *destination) noexcept;
+
+        /// @brief 解压一个块
+        /// @param format 格式
+        /// @param source 压缩的块
+        /// @param block 16个RGBA8像素，按行排列
+        static void decode_block(Format format, const uint8_t *source, uint8_t block[64]) noexcept;
+
+        /// @brief 计算峰值信噪比，只比较格式保存的通道
+        /// @param format 格式
+        /// @param original 原图像，紧密排列的RGBA8
+        /// @param decoded 解压后的图像
+        /// @param width 宽度
+        /// @param height 高度
+        /// @return PSNR，单位dB，完全相同时为无穷大
+        static double compute_psnr(
+            Format format,
+            const uint8_t *original,
+            const uint8_t *decoded,
+            uint32_t width,
+            uint32_t height) noexcept;
+
+    protected:
+        /// @brief 计算16个像素到一个颜色的距离平方，SIMD实现
+        /// @param block 16个RGBA8像素
+        /// @param color 颜色
+        /// @param has_alpha 是否计入透明度
+        /// @param distances 输出
+        static void compute_distances(const uint8_t block[64], const uint8_t color[4], bool has_alpha, uint32_t distances[16]) noexcept;
+
+        /// @brief 为每个像素选择调色板中最近的颜色
+        /// @param block 16个RGBA8像素
+        /// @param palette 调色板
+        /// @param palette_size 调色板大小
+        /// @param has_alpha 是否计入透明度
+        /// @param indices 输出的索引
+        /// @return 总误差
+        static uint32_t fit_palette(
+            const uint8_t block[64],
+            const uint8_t (*palette)[4],
+            uint32_t palette_size,
+            bool has_alpha,
+            uint8_t indices[16]) noexcept;
+
+        /// @brief 用主成分方向上的投影求颜色的两个端点
+        /// @param block 16个RGBA8像素
+        /// @param channel_count 3或4
+        /// @param low 输出端点
+        /// @param high 输出端点
+        static void find_endpoints(const uint8_t block[64], uint32_t channel_count, float low[4], float high[4]) noexcept;
+
+        /// @brief 索引确定后用最小二乘法重新求端点
+        /// @param block 16个RGBA8像素
+        /// @param channel_count 3或4
+        /// @param weights 每个像素的插值权重，0为low，1为high
+        /// @param low 输出端点
+        /// @param high 输出端点
+        /// @return 是否有解，所有权重相同时没有
+        static bool refine_endpoints(const uint8_t block[64], uint32_t channel_count, const float weights[16], float low[4], float high[4]) noexcept;
+
+        /// @brief 读取一个块，超出图像的部分重复边缘
+        static void load_block(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint8_t block[64]) noexcept;
+
+        /// @brief 写回一个块，只写图像内的部分
+        static void store_block(const uint8_t block[64], uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint8_t *pixels) noexcept;
+
+        /// @brief 由两个565端点求BC1的4项调色板，color0 <= color1时为3色模式
+        static void bc1_palette(uint16_t color0, uint16_t color1, uint8_t palette[4][4]) noexcept;
+
+        static void encode_bc1(const uint8_t block[64], uint8_t destination[8]) noexcept;
+        static void decode_bc1(const uint8_t source[8], uint8_t block[64]) noexcept;
+
+        /// @brief 由两个端点求BC4的8项调色板，endpoint0 > endpoint1时为8值模式，否则为6值模式加0和255
+        static void bc4_palette(uint8_t endpoint0, uint8_t endpoint1, uint8_t palette[8]) noexcept;
+
+        /// @brief BC4的单通道块，也用于BC3的透明度和BC5
+        /// @param block 16个RGBA8像素
+        /// @param channel 通道
+        static void encode_bc4(const uint8_t block[64], uint32_t channel, uint8_t destination[8]) noexcept;
+        static void decode_bc4(const uint8_t source[8], uint32_t channel, uint8_t block[64]) noexcept;
+
+        static void encode_bc7(const uint8_t block[64], uint8_t destination[16]) noexcept;
+        static void decode_bc7(const uint8_t source[16], uint8_t block[64]) noexcept;
+
+        static void encode_etc2(const uint8_t block[64], uint8_t destination[8]) noexcept;
+        static void decode_etc2(const uint8_t source[8], uint8_t block[64]) noexcept;
+
+        /// @brief EAC的单通道块，用于ETC2A的透明度和EAC R11、RG11
+        /// @param block 16个RGBA8像素
+        /// @param channel 通道
+        /// @param is_11_bit 是否为R11、RG11，否则为ETC2A的8位透明度
+        static void encode_eac(const uint8_t block[64], uint32_t channel, bool is_11_bit, uint8_t destination[8]) noexcept;
+        static void decode_eac(const uint8_t source[8], uint32_t channel, bool is_11_bit, uint8_t block[64]) noexcept;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
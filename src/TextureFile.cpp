@@ -0,0 +1,248 @@
+#ifndef __VL_TEXTUREFILE_CPP__
+#define __VL_TEXTUREFILE_CPP__
+
+#include <cstring>
+#include "TextureFile.hpp"
+#include "Simd.hpp"
+
+namespace vl
+{
+    TextureFile::~TextureFile()
+    {
+        close();
+    }
+
+    bool
+    TextureFile::open(
+        const std::string &path,
+        Mode mode)
+    {
+        close();
+        if (!m_file.open(path, mode))
+            return false;
+
+        m_data = m_file.get_data();
+        m_size = m_file.get_size();
+        if (!parse())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool
+    TextureFile::open_memory(
+        const void *data,
+        size_t size)
+    {
+        close();
+        m_data = static_cast<const uint8_t *>(data);
+        m_size = size;
+        if (!parse())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void
+    TextureFile::close() noexcept
+    {
+        m_file.close();
+        m_data = nullptr;
+        m_size = 0;
+        m_format = Format::eUnknown;
+        m_width = 0;
+        m_height = 0;
+        m_pixels = nullptr;
+    }
+
+    bool
+    TextureFile::is_open() const noexcept
+    {
+        return m_pixels != nullptr;
+    }
+
+    TextureFile::Format
+    TextureFile::get_format() const noexcept
+    {
+        return m_format;
+    }
+
+    uint32_t
+    TextureFile::get_width() const noexcept
+    {
+        return m_width;
+    }
+
+    uint32_t
+    TextureFile::get_height() const noexcept
+    {
+        return m_height;
+    }
+
+    const uint8_t *
+    TextureFile::get_pixels() const noexcept
+    {
+        return m_pixels;
+    }
+
+    vk::DeviceSize
+    TextureFile::get_decoded_size() const noexcept
+    {
+        return static_cast<vk::DeviceSize>(m_width) * m_height * 4;
+    }
+
+    bool
+    TextureFile::decode(
+        uint8_t *destination,
+        size_t row_pitch) const noexcept
+    {
+        if (m_pixels == nullptr || destination == nullptr || row_pitch < static_cast<size_t>(m_width) * 4)
+            return false;
+
+        // 紧密排列时整张图一次扩展，否则逐行
+        if (row_pitch == static_cast<size_t>(m_width) * 4)
+        {
+            expand_rgb_to_rgba(m_pixels, destination, static_cast<size_t>(m_width) * m_height);
+            return true;
+        }
+        for (uint32_t y = 0; y < m_height; y++)
+            expand_rgb_to_rgba(m_pixels + static_cast<size_t>(y) * m_width * 3, destination + y * row_pitch, m_width);
+        return true;
+    }
+
+    std::optional<StagingRing::Allocation>
+    TextureFile::stage(
+        StagingRing &ring,
+        vk::DeviceSize alignment) const
+    {
+        if (m_pixels == nullptr)
+            return std::nullopt;
+
+        std::optional<StagingRing::Allocation> allocation = ring.allocate(get_decoded_size(), alignment < 4 ? 4 : alignment);
+        if (allocation.has_value())
+            decode(static_cast<uint8_t *>(allocation->m_pointer), static_cast<size_t>(m_width) * 4);
+        return allocation;
+    }
+
+    vk::BufferImageCopy
+    TextureFile::get_copy_region(vk::DeviceSize buffer_offset) const noexcept
+    {
+        vk::BufferImageCopy region;
+        region.setBufferOffset(buffer_offset);
+        region.setBufferRowLength(0);
+        region.setBufferImageHeight(0);
+        region.setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1));
+        region.setImageOffset(vk::Offset3D(0, 0, 0));
+        region.setImageExtent(vk::Extent3D(m_width, m_height, 1));
+        return region;
+    }
+
+    void
+    TextureFile::expand_rgb_to_rgba(
+        const uint8_t *source,
+        uint8_t *destination,
+        size_t pixel_count) noexcept
+    {
+        size_t x = 0;
+#if defined(VL_SIMD_SSSE3)
+        // 每次读48字节、写64字节共16个像素，用alignr拼出跨越两个寄存器的像素，不会读越界
+        const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+        for (; x + 16 <= pixel_count; x += 16)
+        {
+            const uint8_t *in = source + x * 3;
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 16));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 32));
+            __m128i *out = reinterpret_cast<__m128i *>(destination + x * 4);
+            _mm_storeu_si128(out, _mm_or_si128(_mm_shuffle_epi8(a, shuffle), alpha));
+            _mm_storeu_si128(out + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), shuffle), alpha));
+            _mm_storeu_si128(out + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), shuffle), alpha));
+            _mm_storeu_si128(out + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), shuffle), alpha));
+        }
+#elif defined(VL_SIMD_NEON)
+        uint8x16x4_t pixels;
+        pixels.val[3] = vdupq_n_u8(255);
+        for (; x + 16 <= pixel_count; x += 16)
+        {
+            uint8x16x3_t rgb = vld3q_u8(source + x * 3);
+            pixels.val[0] = rgb.val[0];
+            pixels.val[1] = rgb.val[1];
+            pixels.val[2] = rgb.val[2];
+            vst4q_u8(destination + x * 4, pixels);
+        }
+#endif
+        for (; x < pixel_count; x++)
+        {
+            destination[x * 4 + 0] = source[x * 3 + 0];
+            destination[x * 4 + 1] = source[x * 3 + 1];
+            destination[x * 4 + 2] = source[x * 3 + 2];
+            destination[x * 4 + 3] = 255;
+        }
+    }
+
+    bool
+    TextureFile::parse()
+    {
+        auto fail = [](const ntl::String &message)
+        {
+            ntl::log.loge(
+                NTL_STRING("TextureFile::parse"),
+                message);
+            return false;
+        };
+
+        if (m_data == nullptr || m_size < 2 || m_data[0] != 'P' || m_data[1] != '6')
+            return fail(NTL_STRING("Not a binary PPM file"));
+
+        // 文件头为P6、宽、高、最大值，以空白分隔，#开始的注释到行尾；最大值之后恰好一个空白字符
+        size_t position = 2;
+        auto is_space = [](uint8_t c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+        };
+        auto read_number = [&](uint32_t &value)
+        {
+            while (position < m_size && (is_space(m_data[position]) || m_data[position] == '#'))
+            {
+                if (m_data[position] == '#')
+                    while (position < m_size && m_data[position] != '\n')
+                        position++;
+                else
+                    position++;
+            }
+            size_t start = position;
+            uint64_t number = 0;
+            while (position < m_size && m_data[position] >= '0' && m_data[position] <= '9' && number <= UINT32_MAX)
+                number = number * 10 + (m_data[position++] - '0');
+            if (position == start || number > UINT32_MAX || position >= m_size || !is_space(m_data[position]))
+                return false;
+            value = static_cast<uint32_t>(number);
+            return true;
+        };
+
+        uint32_t width = 0, height = 0, max_value = 0;
+        if (!read_number(width) || !read_number(height) || !read_number(max_value))
+            return fail(NTL_STRING("Invalid PPM header"));
+        if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION)
+            return fail(NTL_STRING("Invalid PPM size"));
+        if (max_value != 255)
+            return fail(NTL_STRING("Only 8-bit PPM with max value 255 is supported"));
+        position++;
+
+        if (static_cast<uint64_t>(width) * height * 3 > m_size - position)
+            return fail(NTL_STRING("PPM pixels are truncated"));
+
+        m_format = Format::ePpm;
+        m_width = width;
+        m_height = height;
+        m_pixels = m_data + position;
+        return true;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
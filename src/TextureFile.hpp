@@ -0,0 +1,133 @@
+#ifndef __VL_TEXTUREFILE_HPP__
+#define __VL_TEXTUREFILE_HPP__
+
+#include <cstdint>
+#include <string>
+#include <optional>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "MappedFile.hpp"
+#include "StagingRing.hpp"
+
+namespace vl
+{
+    /// @brief 纹理文件，目前支持二进制PPM(P6)
+    /// @details 打开时只解析一次文件头，像素留在映射中，解码时直接从映射扩展为RGBA写入目标，
+    /// 例如暂存环的分配，不经过中间缓冲
+    class TextureFile : public ntl::Object
+    {
+    public:
+        using SelfType = TextureFile;
+        using ParentType = ntl::Object;
+
+        /// @brief 打开方式
+        using Mode = MappedFile::Mode;
+
+        /// @brief 文件格式
+        enum class Format
+        {
+            eUnknown,
+            /// @brief 二进制PPM，每像素3字节，最大值255
+            ePpm,
+        };
+
+        /// @brief 解码后的格式
+        static constexpr vk::Format DECODED_FORMAT = vk::Format::eR8G8B8A8Unorm;
+
+        /// @brief 宽和高的上限
+        static constexpr uint32_t MAX_DIMENSION = 65536;
+
+    protected:
+        /// @brief 文件的全部内容
+        const uint8_t *m_data = nullptr;
+        size_t m_size = 0;
+
+        /// @brief open打开的文件，open_memory时不使用
+        MappedFile m_file;
+
+        Format m_format = Format::eUnknown;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+
+        /// @brief 第一个像素，指向m_data内部
+        const uint8_t *m_pixels = nullptr;
+
+    public:
+        TextureFile() = default;
+        ~TextureFile() override;
+
+        TextureFile(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 打开并解析文件头
+        /// @param path 路径
+        /// @param mode 打开方式
+        /// @return 是否成功
+        bool open(const std::string &path, Mode mode = Mode::eMap);
+
+        /// @brief 使用内存中的文件内容，不复制，内存需要在close前保持有效
+        /// @param data 内容
+        /// @param size 字节数
+        /// @return 是否通过检查
+        bool open_memory(const void *data, size_t size);
+
+        /// @brief 关闭
+        void close() noexcept;
+
+        /// @brief 是否已打开
+        /// @return 是否已打开
+        bool is_open() const noexcept;
+
+        /// @brief 获取格式
+        /// @return 格式
+        Format get_format() const noexcept;
+
+        /// @brief 获取宽度
+        /// @return 宽度
+        uint32_t get_width() const noexcept;
+
+        /// @brief 获取高度
+        /// @return 高度
+        uint32_t get_height() const noexcept;
+
+        /// @brief 获取文件中的像素，每行紧密排列
+        /// @return 第一个像素
+        const uint8_t *get_pixels() const noexcept;
+
+        /// @brief 获取解码为RGBA后紧密排列的字节数
+        /// @return 字节数
+        vk::DeviceSize get_decoded_size() const noexcept;
+
+        /// @brief 解码为RGBA
+        /// @param destination 目标，例如映射的缓冲或线性图像
+        /// @param row_pitch 目标每行的字节数，至少为宽度的4倍
+        /// @return 是否成功
+        bool decode(uint8_t *destination, size_t row_pitch) const noexcept;
+
+        /// @brief 在暂存环中分配并直接解码到分配中，每行紧密排列
+        /// @param ring 暂存环
+        /// @param alignment 对齐，至少为4
+        /// @return 分配，未打开或暂存环空间不足时为空
+        std::optional<StagingRing::Allocation> stage(StagingRing &ring, vk::DeviceSize alignment = 16) const;
+
+        /// @brief 获取把stage的结果复制到整个图像的区域
+        /// @param buffer_offset 分配的偏移
+        /// @return 复制区域，目标为第0层第0级
+        vk::BufferImageCopy get_copy_region(vk::DeviceSize buffer_offset) const noexcept;
+
+    public:
+        /// @brief 把RGB像素扩展为RGBA，透明度为255
+        /// @param source 源像素，每像素3字节
+        /// @param destination 目标，每像素4字节，不能与源重叠
+        /// @param pixel_count 像素数
+        static void expand_rgb_to_rgba(const uint8_t *source, uint8_t *destination, size_t pixel_count) noexcept;
+
+    protected:
+        /// @brief 检查m_data中的文件头
+        /// @return 是否通过
+        bool parse();
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
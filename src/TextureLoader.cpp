@@ -0,0 +1,611 @@
+#ifndef __VL_TEXTURELOADER_CPP__
+#define __VL_TEXTURELOADER_CPP__
+
+#include <algorithm>
+#include "TextureLoader.hpp"
+#include "DeviceUtils.hpp"
+
+namespace vl
+{
+    double
+    TextureLoader::Statistics::average_latency_seconds() const noexcept
+    {
+        if (m_resident == 0)
+            return 0.0;
+        return m_latency_seconds / static_cast<double>(m_resident);
+    }
+
+    TextureLoader::~TextureLoader()
+    {
+        // 线程池的任务使用互斥量和槽位，需要在它们析构之前停止；没有设备时图像不会被销毁
+        destroy(vk::Device());
+    }
+
+    bool
+    TextureLoader::create(
+        StagingRing &ring,
+        const Config &config)
+    {
+        if (config.m_slot_count == 0 || ring.get_capacity() < FALLBACK_SIZE * FALLBACK_SIZE * 4)
+        {
+            ntl::log.loge(
+                NTL_STRING("TextureLoader::create"),
+                NTL_STRING("Slot count must not be zero and the staging ring must not be empty"));
+            return false;
+        }
+
+        m_config = config;
+        m_ring = &ring;
+        m_slots = std::vector<Slot>(config.m_slot_count);
+        m_fallback = Slot();
+        m_free.clear();
+        for (uint32_t i = config.m_slot_count; i > 0; i--)
+            m_free.push_back(i - 1);
+        m_parsed.clear();
+        m_decoded.clear();
+        m_unsubmitted.clear();
+        m_in_flight.clear();
+        m_allocated.clear();
+        m_published.clear();
+        m_is_fallback_staged = false;
+        m_is_stopping = false;
+
+        m_pool = std::make_unique<ThreadPool>(config.m_thread_count);
+        m_statistics = Statistics();
+        m_statistics.m_thread_count = m_pool->get_thread_count();
+
+        return true;
+    }
+
+    void
+    TextureLoader::destroy(
+        const vk::Device &device)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_stopping = true;
+        }
+        // 线程池析构时执行完队列中的任务，任务看到m_is_stopping后直接返回
+        m_pool.reset();
+
+        if (device)
+        {
+            for (Slot &slot : m_slots)
+                destroy_image(device, slot);
+            destroy_image(device, m_fallback);
+        }
+        m_slots.clear();
+        m_fallback = Slot();
+        m_allocated.clear();
+        m_ring = nullptr;
+    }
+
+    std::optional<uint32_t>
+    TextureLoader::request(
+        const std::string &path)
+    {
+        uint32_t index;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_free.empty() || m_is_stopping)
+                return std::nullopt;
+
+            index = m_free.back();
+            m_free.pop_back();
+            Slot &slot = m_slots[index];
+            slot.m_state = State::eLoading;
+            slot.m_path = path;
+            slot.m_request_time = std::chrono::steady_clock::now();
+            m_statistics.m_requested++;
+        }
+
+        m_pool->post([this, index]()
+                     { load(index); });
+        return index;
+    }
+
+    std::vector<TextureLoader::Upload>
+    TextureLoader::update()
+    {
+        std::vector<Upload> uploads;
+
+        // 后备纹理最先上传，与第一批绘制在同一次提交中
+        if (!m_is_fallback_staged)
+        {
+            std::optional<StagingRing::Allocation> allocation = m_ring->allocate(FALLBACK_SIZE * FALLBACK_SIZE * 4, 16);
+            if (allocation.has_value())
+            {
+                fill_fallback(static_cast<uint8_t *>(allocation->m_pointer));
+                m_fallback.m_state = State::eUploading;
+                m_fallback.m_width = FALLBACK_SIZE;
+                m_fallback.m_height = FALLBACK_SIZE;
+                m_fallback.m_allocation = *allocation;
+                m_fallback.m_mark = m_ring->submit();
+                m_allocated.push_back(&m_fallback);
+                uploads.push_back({FALLBACK_SLOT, *allocation, FALLBACK_SIZE, FALLBACK_SIZE});
+                m_is_fallback_staged = true;
+            }
+        }
+
+        std::vector<uint32_t> dispatched;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!uploads.empty() && uploads.front().m_slot == FALLBACK_SLOT)
+                m_unsubmitted.push_back(FALLBACK_SLOT);
+
+            for (uint32_t index : m_decoded)
+            {
+                Slot &slot = m_slots[index];
+                slot.m_state = State::eUploading;
+                uploads.push_back({index, slot.m_allocation, slot.m_width, slot.m_height});
+                m_unsubmitted.push_back(index);
+            }
+            m_decoded.clear();
+
+            // 按请求顺序分配，超出预算或暂存环已满时留到下一次
+            vk::DeviceSize budget = m_config.m_upload_budget;
+            while (!m_parsed.empty())
+            {
+                uint32_t index = m_parsed.front();
+                Slot &slot = m_slots[index];
+                vk::DeviceSize size = static_cast<vk::DeviceSize>(slot.m_width) * slot.m_height * 4;
+                if (size > m_ring->get_capacity())
+                {
+                    ntl::log.loge(
+                        NTL_STRING("TextureLoader::update"),
+                        NTL_STRING("Texture is larger than the staging ring"));
+                    slot.m_state = State::eFailed;
+                    slot.m_file.reset();
+                    m_statistics.m_failed++;
+                    m_parsed.pop_front();
+                    continue;
+                }
+                // 至少分配一个，预算小于单个纹理时也能前进
+                if (size > budget && !dispatched.empty())
+                    break;
+
+                std::optional<StagingRing::Allocation> allocation = m_ring->allocate(size, 16);
+                if (!allocation.has_value())
+                    break;
+
+                slot.m_state = State::eDecoding;
+                slot.m_allocation = *allocation;
+                slot.m_mark = m_ring->submit();
+                m_allocated.push_back(&slot);
+                m_parsed.pop_front();
+                dispatched.push_back(index);
+                budget -= std::min(budget, size);
+            }
+        }
+
+        for (uint32_t index : dispatched)
+            m_pool->post([this, index]()
+                         { decode(index); });
+
+        return uploads;
+    }
+
+    vk::Result
+    TextureLoader::record(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        const vk::CommandBuffer &command_buffer,
+        const std::vector<Upload> &uploads)
+    {
+        if (uploads.empty())
+            return vk::Result::eSuccess;
+
+        vk::Result result = m_ring->flush(device);
+        if (result != vk::Result::eSuccess)
+        {
+            cancel(device, uploads);
+            return result;
+        }
+
+        // 图像只在渲染线程创建和使用，不需要加锁
+        std::vector<Slot *> slots;
+        std::vector<vk::ImageMemoryBarrier> barriers;
+        for (const Upload &upload : uploads)
+        {
+            Slot &slot = get_slot(upload.m_slot);
+            result = create_image(device, physical_device, slot);
+            if (result != vk::Result::eSuccess)
+            {
+                // 命令在所有图像创建之后才记录，这次的上传都没有记录
+                cancel(device, uploads);
+                return result;
+            }
+            slots.push_back(&slot);
+
+            vk::ImageMemoryBarrier barrier;
+            barrier.setSrcAccessMask(vk::AccessFlags());
+            barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+            barrier.setOldLayout(vk::ImageLayout::eUndefined);
+            barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+            barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+            barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+            barrier.setImage(slot.m_image);
+            barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+            barriers.push_back(barrier);
+        }
+
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTopOfPipe,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            nullptr,
+            nullptr,
+            barriers);
+
+        for (size_t i = 0; i < uploads.size(); i++)
+        {
+            vk::BufferImageCopy region;
+            region.setBufferOffset(uploads[i].m_allocation.m_offset);
+            region.setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1));
+            region.setImageExtent(vk::Extent3D(uploads[i].m_width, uploads[i].m_height, 1));
+            command_buffer.copyBufferToImage(m_ring->get_buffer(), slots[i]->m_image, vk::ImageLayout::eTransferDstOptimal, region);
+        }
+
+        for (vk::ImageMemoryBarrier &barrier : barriers)
+        {
+            barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+            barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+            barrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
+            barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+        }
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eFragmentShader,
+            vk::DependencyFlags(),
+            nullptr,
+            nullptr,
+            barriers);
+
+        return vk::Result::eSuccess;
+    }
+
+    void
+    TextureLoader::submitted(
+        uint64_t value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (uint32_t index : m_unsubmitted)
+        {
+            get_slot(index).m_submit_value = value;
+            m_in_flight.push_back(index);
+        }
+        m_unsubmitted.clear();
+    }
+
+    void
+    TextureLoader::retire(
+        uint64_t completed)
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto retired = std::stable_partition(
+            m_in_flight.begin(), m_in_flight.end(),
+            [this, completed](uint32_t index)
+            { return get_slot(index).m_submit_value > completed; });
+        for (auto iter = retired; iter != m_in_flight.end(); iter++)
+        {
+            Slot &slot = get_slot(*iter);
+            slot.m_state = State::eResident;
+            if (*iter == FALLBACK_SLOT)
+                continue;
+            m_published.push_back(*iter);
+
+            double latency = std::chrono::duration<double>(now - slot.m_request_time).count();
+            m_statistics.m_resident++;
+            m_statistics.m_latency_seconds += latency;
+            m_statistics.m_max_latency_seconds = std::max(m_statistics.m_max_latency_seconds, latency);
+        }
+        m_in_flight.erase(retired, m_in_flight.end());
+
+        // 暂存环只能按分配顺序回收，停在第一个还在解码或上传的槽位
+        std::optional<vk::DeviceSize> mark;
+        while (!m_allocated.empty() &&
+               (m_allocated.front()->m_state == State::eResident || m_allocated.front()->m_state == State::eFailed))
+        {
+            mark = m_allocated.front()->m_mark;
+            m_allocated.pop_front();
+        }
+        if (mark.has_value())
+            m_ring->release(*mark);
+    }
+
+    std::vector<uint32_t>
+    TextureLoader::take_published()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<uint32_t> published;
+        published.swap(m_published);
+        return published;
+    }
+
+    void
+    TextureLoader::write_descriptors(
+        const vk::Device &device,
+        const vk::DescriptorSet &set,
+        uint32_t binding,
+        const vk::Sampler &sampler,
+        uint32_t first,
+        uint32_t count)
+    {
+        count = std::min(count, m_config.m_slot_count - std::min(first, m_config.m_slot_count));
+        if (count == 0)
+            return;
+
+        std::vector<vk::DescriptorImageInfo> image_infos;
+        image_infos.reserve(count);
+        for (uint32_t slot = first; slot < first + count; slot++)
+            image_infos.push_back(vk::DescriptorImageInfo(sampler, get_view(slot), vk::ImageLayout::eShaderReadOnlyOptimal));
+
+        vk::WriteDescriptorSet write;
+        write.setDstSet(set);
+        write.setDstBinding(binding);
+        write.setDstArrayElement(first);
+        write.setDescriptorCount(count);
+        write.setDescriptorType(vk::DescriptorType::eCombinedImageSampler);
+        write.setPImageInfo(image_infos.data());
+        device.updateDescriptorSets(write, nullptr);
+    }
+
+    void
+    TextureLoader::write_descriptors(
+        const vk::Device &device,
+        const vk::DescriptorSet &set,
+        uint32_t binding,
+        const vk::Sampler &sampler,
+        const std::vector<uint32_t> &slots)
+    {
+        if (slots.empty())
+            return;
+
+        // 先准备好所有图像信息，写入时指针不能失效
+        std::vector<vk::DescriptorImageInfo> image_infos;
+        image_infos.reserve(slots.size());
+        for (uint32_t slot : slots)
+            image_infos.push_back(vk::DescriptorImageInfo(sampler, get_view(slot), vk::ImageLayout::eShaderReadOnlyOptimal));
+
+        std::vector<vk::WriteDescriptorSet> writes;
+        writes.reserve(slots.size());
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            if (slots[i] >= m_config.m_slot_count)
+                continue;
+            vk::WriteDescriptorSet write;
+            write.setDstSet(set);
+            write.setDstBinding(binding);
+            write.setDstArrayElement(slots[i]);
+            write.setDescriptorCount(1);
+            write.setDescriptorType(vk::DescriptorType::eCombinedImageSampler);
+            write.setPImageInfo(&image_infos[i]);
+            writes.push_back(write);
+        }
+        device.updateDescriptorSets(writes, nullptr);
+    }
+
+    TextureLoader::State
+    TextureLoader::get_state(
+        uint32_t slot)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (slot >= m_slots.size())
+            return State::eEmpty;
+        return m_slots[slot].m_state;
+    }
+
+    vk::ImageView
+    TextureLoader::get_view(
+        uint32_t slot)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (slot < m_slots.size() && m_slots[slot].m_state == State::eResident)
+            return m_slots[slot].m_view;
+        return m_fallback.m_view;
+    }
+
+    bool
+    TextureLoader::is_idle()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_statistics.m_resident + m_statistics.m_failed == m_statistics.m_requested;
+    }
+
+    TextureLoader::Statistics
+    TextureLoader::get_statistics()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_statistics;
+    }
+
+    ntl::String
+    TextureLoader::format()
+    {
+        Statistics statistics = get_statistics();
+
+        ntl::StringStream sstr;
+        sstr << std::endl
+             << NTL_STRING("\tthreads:") << statistics.m_thread_count << std::endl
+             << NTL_STRING("\trequested:") << statistics.m_requested << std::endl
+             << NTL_STRING("\tresident:") << statistics.m_resident << std::endl
+             << NTL_STRING("\tfailed:") << statistics.m_failed << std::endl
+             << NTL_STRING("\tdecoded bytes:") << statistics.m_bytes << std::endl
+             << NTL_STRING("\tdecode seconds:") << statistics.m_decode_seconds << std::endl
+             << NTL_STRING("\taverage latency:") << statistics.average_latency_seconds() << std::endl
+             << NTL_STRING("\tmax latency:") << statistics.m_max_latency_seconds << std::endl;
+        return sstr.str();
+    }
+
+    void
+    TextureLoader::fill_fallback(
+        uint8_t *destination) noexcept
+    {
+        for (uint32_t y = 0; y < FALLBACK_SIZE; y++)
+            for (uint32_t x = 0; x < FALLBACK_SIZE; x++)
+            {
+                uint8_t *pixel = destination + (y * FALLBACK_SIZE + x) * 4;
+                bool is_magenta = ((x ^ y) & 1) == 0;
+                pixel[0] = is_magenta ? 255 : 0;
+                pixel[1] = 0;
+                pixel[2] = is_magenta ? 255 : 0;
+                pixel[3] = 255;
+            }
+    }
+
+    void
+    TextureLoader::load(
+        uint32_t index)
+    {
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_is_stopping)
+                return;
+            path = m_slots[index].m_path;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        auto file = std::make_unique<TextureFile>();
+        bool success = file->open(path);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Slot &slot = m_slots[index];
+        m_statistics.m_decode_seconds += seconds;
+        if (!success)
+        {
+            slot.m_state = State::eFailed;
+            m_statistics.m_failed++;
+            return;
+        }
+        slot.m_width = file->get_width();
+        slot.m_height = file->get_height();
+        slot.m_file = std::move(file);
+        slot.m_state = State::eParsed;
+        m_parsed.push_back(index);
+    }
+
+    void
+    TextureLoader::decode(
+        uint32_t index)
+    {
+        // eDecoding期间只有这个任务访问槽位的文件和分配
+        Slot &slot = m_slots[index];
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_is_stopping)
+                return;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        bool success = slot.m_file->decode(static_cast<uint8_t *>(slot.m_allocation.m_pointer), static_cast<size_t>(slot.m_width) * 4);
+        slot.m_file.reset();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_statistics.m_decode_seconds += seconds;
+        if (!success)
+        {
+            slot.m_state = State::eFailed;
+            m_statistics.m_failed++;
+            return;
+        }
+        m_statistics.m_bytes += slot.m_allocation.m_size;
+        slot.m_state = State::eDecoded;
+        m_decoded.push_back(index);
+    }
+
+    TextureLoader::Slot &
+    TextureLoader::get_slot(
+        uint32_t index) noexcept
+    {
+        return index == FALLBACK_SLOT ? m_fallback : m_slots[index];
+    }
+
+    vk::Result
+    TextureLoader::create_image(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        Slot &slot)
+    {
+        vk::ImageCreateInfo image_info;
+        image_info.setImageType(vk::ImageType::e2D);
+        image_info.setFormat(TextureFile::DECODED_FORMAT);
+        image_info.setExtent(vk::Extent3D(slot.m_width, slot.m_height, 1));
+        image_info.setMipLevels(1);
+        image_info.setArrayLayers(1);
+        image_info.setSamples(vk::SampleCountFlagBits::e1);
+        image_info.setTiling(vk::ImageTiling::eOptimal);
+        image_info.setUsage(vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled);
+        image_info.setSharingMode(vk::SharingMode::eExclusive);
+        image_info.setInitialLayout(vk::ImageLayout::eUndefined);
+        auto image_result = device.createImage(image_info);
+        if (image_result.result != vk::Result::eSuccess)
+            return image_result.result;
+        slot.m_image = image_result.value;
+
+        auto memory_result = DeviceUtils::allocate_image_memory(
+            device,
+            physical_device,
+            slot.m_image,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::MemoryPropertyFlags());
+        if (memory_result.result != vk::Result::eSuccess)
+            return memory_result.result;
+        slot.m_memory = memory_result.value;
+
+        vk::ImageViewCreateInfo view_info;
+        view_info.setImage(slot.m_image);
+        view_info.setViewType(vk::ImageViewType::e2D);
+        view_info.setFormat(TextureFile::DECODED_FORMAT);
+        view_info.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+        auto view_result = device.createImageView(view_info);
+        if (view_result.result != vk::Result::eSuccess)
+            return view_result.result;
+        slot.m_view = view_result.value;
+
+        return vk::Result::eSuccess;
+    }
+
+    void
+    TextureLoader::destroy_image(
+        const vk::Device &device,
+        Slot &slot)
+    {
+        if (slot.m_view)
+            device.destroyImageView(slot.m_view);
+        if (slot.m_image)
+            device.destroyImage(slot.m_image);
+        if (slot.m_memory)
+            device.freeMemory(slot.m_memory);
+        slot.m_view = nullptr;
+        slot.m_image = nullptr;
+        slot.m_memory = nullptr;
+    }
+
+    void
+    TextureLoader::cancel(
+        const vk::Device &device,
+        const std::vector<Upload> &uploads)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const Upload &upload : uploads)
+        {
+            Slot &slot = get_slot(upload.m_slot);
+            destroy_image(device, slot);
+            slot.m_state = State::eFailed;
+            m_unsubmitted.erase(std::remove(m_unsubmitted.begin(), m_unsubmitted.end(), upload.m_slot), m_unsubmitted.end());
+
+            // 后备纹理不计入统计，下一次update重新分配并上传
+            if (upload.m_slot == FALLBACK_SLOT)
+                m_is_fallback_staged = false;
+            else
+                m_statistics.m_failed++;
+        }
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
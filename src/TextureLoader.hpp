@@ -0,0 +1,316 @@
+#ifndef __VL_TEXTURELOADER_HPP__
+#define __VL_TEXTURELOADER_HPP__
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <optional>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "ThreadPool.hpp"
+#include "StagingRing.hpp"
+#include "TextureFile.hpp"
+
+namespace vl
+{
+    /// @brief 异步纹理加载器
+    /// @details request立即返回描述符槽位，文件的打开、解析和解码在线程池中进行，
+    /// 解码直接写入暂存环。渲染线程每帧调用update取得已解码的纹理并用record记录上传，
+    /// 提交后调用submitted，GPU完成后调用retire，纹理此时才发布到槽位；
+    /// 在此之前槽位使用后备纹理，渲染不需要等待任何纹理。
+    /// 暂存环的分配和回收只在渲染线程进行，暂存环需要专供加载器使用
+    class TextureLoader : public ntl::Object
+    {
+    public:
+        using SelfType = TextureLoader;
+        using ParentType = ntl::Object;
+
+        /// @brief 后备纹理在Upload中使用的槽位
+        static constexpr uint32_t FALLBACK_SLOT = UINT32_MAX;
+
+        /// @brief 后备纹理的边长，品红与黑色相间的棋盘格
+        static constexpr uint32_t FALLBACK_SIZE = 8;
+
+        /// @brief 槽位状态
+        enum class State
+        {
+            eEmpty,
+            /// @brief 等待打开和解析文件头
+            eLoading,
+            /// @brief 已解析，等待暂存环空间
+            eParsed,
+            /// @brief 正在解码到暂存环
+            eDecoding,
+            /// @brief 已解码，等待记录上传
+            eDecoded,
+            /// @brief 上传已记录，等待GPU完成
+            eUploading,
+            /// @brief 已上传并发布
+            eResident,
+            /// @brief 加载失败，一直使用后备纹理
+            eFailed,
+        };
+
+        /// @brief 配置
+        struct Config
+        {
+            /// @brief 解码线程数，为0时使用硬件线程数
+            size_t m_thread_count = 0;
+
+            /// @brief 槽位数，即描述符数组的大小
+            uint32_t m_slot_count = 1024;
+
+            /// @brief 每次update最多分配给解码的暂存字节数，限制每帧的上传量
+            vk::DeviceSize m_upload_budget = 32 * 1024 * 1024;
+        };
+
+        /// @brief 一次要记录的上传
+        struct Upload
+        {
+            /// @brief 槽位，后备纹理为FALLBACK_SLOT
+            uint32_t m_slot = 0;
+
+            /// @brief 暂存环中紧密排列的RGBA像素
+            StagingRing::Allocation m_allocation;
+
+            uint32_t m_width = 0;
+            uint32_t m_height = 0;
+        };
+
+        /// @brief 统计信息
+        struct Statistics
+        {
+            uint64_t m_requested = 0;
+            uint64_t m_resident = 0;
+            uint64_t m_failed = 0;
+
+            /// @brief 解码后的字节数
+            uint64_t m_bytes = 0;
+
+            /// @brief 所有线程解析和解码耗时之和
+            double m_decode_seconds = 0.0;
+
+            /// @brief 从请求到发布的耗时之和与最大值
+            double m_latency_seconds = 0.0;
+            double m_max_latency_seconds = 0.0;
+
+            /// @brief 解码线程数
+            size_t m_thread_count = 0;
+
+            /// @brief 平均从请求到发布的耗时
+            /// @return 秒
+            double average_latency_seconds() const noexcept;
+        };
+
+    protected:
+        /// @brief 槽位
+        struct Slot
+        {
+            State m_state = State::eEmpty;
+            std::string m_path;
+
+            /// @brief 打开的文件，只在eLoading到eDecoding期间存在
+            std::unique_ptr<TextureFile> m_file;
+
+            uint32_t m_width = 0;
+            uint32_t m_height = 0;
+            StagingRing::Allocation m_allocation;
+
+            /// @brief 分配之后暂存环的位置，回收到此为止
+            vk::DeviceSize m_mark = 0;
+
+            /// @brief 上传所在提交的值
+            uint64_t m_submit_value = 0;
+
+            std::chrono::steady_clock::time_point m_request_time;
+
+            vk::Image m_image;
+            vk::DeviceMemory m_memory;
+            vk::ImageView m_view;
+        };
+
+    protected:
+        Config m_config;
+        StagingRing *m_ring = nullptr;
+        std::unique_ptr<ThreadPool> m_pool;
+
+        /// @brief 保护槽位状态、各个列表和统计信息
+        std::mutex m_mutex;
+
+        std::vector<Slot> m_slots;
+        Slot m_fallback;
+
+        /// @brief 空闲的槽位，从末尾取
+        std::vector<uint32_t> m_free;
+
+        /// @brief 已解析、等待分配的槽位，按请求顺序
+        std::deque<uint32_t> m_parsed;
+
+        /// @brief 已解码、等待update交出的槽位
+        std::vector<uint32_t> m_decoded;
+
+        /// @brief 已交出、等待submitted的槽位，可能包含FALLBACK_SLOT
+        std::vector<uint32_t> m_unsubmitted;
+
+        /// @brief 已提交、等待retire的槽位，可能包含FALLBACK_SLOT
+        std::vector<uint32_t> m_in_flight;
+
+        /// @brief 持有暂存环空间的槽位，按分配顺序，只能从头回收
+        std::deque<Slot *> m_allocated;
+
+        /// @brief 已发布、等待take_published取走的槽位
+        std::vector<uint32_t> m_published;
+
+        Statistics m_statistics;
+        bool m_is_fallback_staged = false;
+        bool m_is_stopping = false;
+
+    public:
+        TextureLoader() = default;
+        ~TextureLoader() override;
+
+        TextureLoader(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 启动解码线程
+        /// @param ring 暂存环，专供加载器使用，需要比最大的纹理大
+        /// @param config 配置
+        /// @return 是否成功
+        bool create(StagingRing &ring, const Config &config);
+
+        /// @brief 停止解码线程并销毁所有图像，调用前需要保证设备已不再使用它们
+        /// @param device 逻辑设备，只在CPU上使用时可以为空
+        void destroy(const vk::Device &device);
+
+        /// @brief 请求加载纹理，立即返回
+        /// @param path 路径
+        /// @return 槽位，槽位用完时为空
+        std::optional<uint32_t> request(const std::string &path);
+
+        /// @brief 为已解析的纹理分配暂存空间并开始解码，交出已解码的纹理，每帧在渲染线程调用一次
+        /// @return 需要记录的上传，第一次调用时包含后备纹理
+        std::vector<Upload> update();
+
+        /// @brief 创建图像并记录上传命令，上传之后图像处于ShaderReadOnlyOptimal
+        /// @details 失败时不记录任何命令，这些上传的槽位变为eFailed，后备纹理在下一次update重新上传
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param command_buffer 命令缓冲，需要在使用纹理的绘制之前提交
+        /// @param uploads update的结果
+        /// @return 结果
+        vk::Result record(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            const vk::CommandBuffer &command_buffer,
+            const std::vector<Upload> &uploads);
+
+        /// @brief 告知加载器update交出的上传已随一次提交发出
+        /// @param value 该次提交的值，例如时间线信号量的值或帧序号，单调增加
+        void submitted(uint64_t value);
+
+        /// @brief 值不超过completed的提交已完成，发布其中的纹理并回收暂存空间
+        /// @param completed 已完成的提交的值
+        void retire(uint64_t completed);
+
+        /// @brief 取走上次调用以来发布的槽位，用于更新描述符
+        /// @return 槽位
+        std::vector<uint32_t> take_published();
+
+        /// @brief 写入一段连续槽位的描述符，未驻留的槽位使用后备纹理，通常在创建描述符集后调用
+        /// @param device 逻辑设备
+        /// @param set 描述符集
+        /// @param binding 组合图像采样器数组的绑定
+        /// @param sampler 采样器
+        /// @param first 第一个槽位
+        /// @param count 槽位数
+        void write_descriptors(
+            const vk::Device &device,
+            const vk::DescriptorSet &set,
+            uint32_t binding,
+            const vk::Sampler &sampler,
+            uint32_t first,
+            uint32_t count);
+
+        /// @brief 写入指定槽位的描述符，例如take_published的结果
+        /// @details 描述符集正被未完成的命令缓冲使用时不能更新，
+        /// 需要每帧一个描述符集或使用UpdateAfterBind的描述符集
+        /// @param device 逻辑设备
+        /// @param set 描述符集
+        /// @param binding 组合图像采样器数组的绑定
+        /// @param sampler 采样器
+        /// @param slots 槽位
+        void write_descriptors(
+            const vk::Device &device,
+            const vk::DescriptorSet &set,
+            uint32_t binding,
+            const vk::Sampler &sampler,
+            const std::vector<uint32_t> &slots);
+
+        /// @brief 获取槽位状态
+        /// @param slot 槽位
+        /// @return 状态
+        State get_state(uint32_t slot);
+
+        /// @brief 获取槽位当前应使用的图像视图
+        /// @param slot 槽位
+        /// @return 驻留时为纹理的视图，否则为后备纹理的视图
+        vk::ImageView get_view(uint32_t slot);
+
+        /// @brief 是否所有请求都已驻留或失败
+        /// @return 是否空闲
+        bool is_idle();
+
+        /// @brief 获取统计信息
+        /// @return 统计信息
+        Statistics get_statistics();
+
+        /// @brief 格式化统计信息
+        /// @return 格式化后的结果
+        ntl::String format();
+
+    public:
+        /// @brief 生成后备纹理的像素
+        /// @param destination 目标，FALLBACK_SIZE * FALLBACK_SIZE个RGBA像素
+        static void fill_fallback(uint8_t *destination) noexcept;
+
+    protected:
+        /// @brief 在线程池中打开并解析文件头
+        /// @param index 槽位
+        void load(uint32_t index);
+
+        /// @brief 在线程池中解码到暂存环
+        /// @param index 槽位
+        void decode(uint32_t index);
+
+        /// @brief 按索引取得槽位
+        /// @param index 槽位，FALLBACK_SLOT为后备纹理
+        /// @return 槽位
+        Slot &get_slot(uint32_t index) noexcept;
+
+        /// @brief 创建槽位的图像、内存和视图
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param slot 槽位
+        /// @return 结果
+        vk::Result create_image(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            Slot &slot);
+
+        /// @brief 销毁槽位的图像、内存和视图
+        /// @param device 逻辑设备
+        /// @param slot 槽位
+        void destroy_image(const vk::Device &device, Slot &slot);
+
+        /// @brief 记录失败时取消这些上传，销毁已创建的图像并从m_unsubmitted中移除
+        /// @param device 逻辑设备
+        /// @param uploads update的结果
+        void cancel(const vk::Device &device, const std::vector<Upload> &uploads);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,828 @@
+#ifndef __VL_TEXTURESTREAMER_CPP__
+#define __VL_TEXTURESTREAMER_CPP__
+
+#include <algorithm>
+#include <cmath>
+#include "TextureStreamer.hpp"
+#include "DeviceUtils.hpp"
+
+namespace vl
+{
+    bool
+    TextureStreamer::create(
+        const Config &config,
+        StagingRing *ring)
+    {
+        if (config.m_texture_count == 0)
+        {
+            ntl::log.loge(
+                NTL_STRING("TextureStreamer::create"),
+                NTL_STRING("Texture count must not be zero"));
+            return false;
+        }
+
+        m_config = config;
+        m_ring = ring;
+        m_textures.clear();
+        m_textures.reserve(config.m_texture_count);
+        m_unsubmitted.clear();
+        m_in_flight.clear();
+        m_published.clear();
+        m_garbage.clear();
+        m_unsubmitted_mark.reset();
+        m_marks.clear();
+        m_last_submitted = 0;
+        m_allocated_bytes = 0;
+        m_statistics = Statistics();
+
+        return true;
+    }
+
+    void
+    TextureStreamer::destroy(
+        const vk::Device &device)
+    {
+        if (device)
+        {
+            for (Texture &texture : m_textures)
+            {
+                destroy_image(device, texture.m_image, texture.m_memory, texture.m_view);
+                destroy_image(device, texture.m_next_image, texture.m_next_memory, texture.m_next_view);
+            }
+            for (Garbage &garbage : m_garbage)
+                destroy_image(device, garbage.m_image, garbage.m_memory, garbage.m_view);
+        }
+        m_textures.clear();
+        m_unsubmitted.clear();
+        m_in_flight.clear();
+        m_published.clear();
+        m_garbage.clear();
+        m_unsubmitted_mark.reset();
+        m_marks.clear();
+        m_allocated_bytes = 0;
+        m_ring = nullptr;
+    }
+
+    std::optional<uint32_t>
+    TextureStreamer::add(
+        const std::string &path)
+    {
+        auto file = std::make_unique<Ktx2File>();
+        if (!file->open(path))
+            return std::nullopt;
+
+        Texture texture;
+        texture.m_format = file->get_format();
+        texture.m_width = file->get_width();
+        texture.m_height = file->get_height();
+        texture.m_level_count = file->get_level_count();
+        std::vector<vk::DeviceSize> level_sizes;
+        for (uint32_t level = 0; level < texture.m_level_count; level++)
+            level_sizes.push_back(file->get_level(level).m_uncompressed_size);
+        texture.m_file = std::move(file);
+
+        return add(std::move(texture), level_sizes);
+    }
+
+    std::optional<uint32_t>
+    TextureStreamer::add(
+        const Description &description)
+    {
+        uint32_t max_level_count = 1;
+        while ((std::max(description.m_width, description.m_height) >> max_level_count) > 0)
+            max_level_count++;
+        if (description.m_width == 0 || description.m_height == 0 ||
+            description.m_level_sizes.empty() || description.m_level_sizes.size() > max_level_count)
+        {
+            ntl::log.loge(
+                NTL_STRING("TextureStreamer::add"),
+                NTL_STRING("Invalid texture description"));
+            return std::nullopt;
+        }
+
+        Texture texture;
+        texture.m_format = description.m_format;
+        texture.m_width = description.m_width;
+        texture.m_height = description.m_height;
+        texture.m_level_count = static_cast<uint32_t>(description.m_level_sizes.size());
+
+        return add(std::move(texture), description.m_level_sizes);
+    }
+
+    void
+    TextureStreamer::request(
+        uint32_t texture,
+        uint32_t level,
+        uint64_t frame) noexcept
+    {
+        if (texture >= m_textures.size())
+            return;
+
+        // 新的一帧覆盖上一帧的请求
+        Texture &target = m_textures[texture];
+        if (!target.m_last_used.has_value() || *target.m_last_used != frame)
+        {
+            target.m_requested_level = level;
+            target.m_last_used = frame;
+        }
+        else
+            target.m_requested_level = std::min(target.m_requested_level, level);
+    }
+
+    void
+    TextureStreamer::submit_feedback(
+        const uint32_t *levels,
+        uint32_t count,
+        uint64_t frame) noexcept
+    {
+        count = std::min(count, static_cast<uint32_t>(m_textures.size()));
+        for (uint32_t i = 0; i < count; i++)
+            if (levels[i] != NO_LEVEL)
+                request(i, levels[i], frame);
+    }
+
+    std::vector<TextureStreamer::Change>
+    TextureStreamer::update(
+        uint64_t frame,
+        vk::DeviceSize budget)
+    {
+        std::vector<Change> changes;
+        m_statistics.m_budget = budget;
+
+        vk::DeviceSize usage = 0;
+        for (const Texture &texture : m_textures)
+            usage += get_planned_size(texture);
+
+        // 尾部不受预算限制，没有它纹理无法采样
+        vk::DeviceSize uploaded = 0;
+        for (uint32_t i = 0; i < m_textures.size(); i++)
+        {
+            Texture &texture = m_textures[i];
+            if (texture.m_resident_level != NO_LEVEL || texture.m_target_level != NO_LEVEL)
+                continue;
+            uploaded += texture.m_suffix_sizes[texture.m_tail_level];
+            plan(i, texture.m_tail_level, usage, changes);
+        }
+
+        if (usage > budget)
+            evict(frame, budget, NO_LEVEL, usage, changes);
+
+        // 本帧使用且需要更精细级别的纹理，差距大的优先
+        std::vector<uint32_t> candidates;
+        for (uint32_t i = 0; i < m_textures.size(); i++)
+        {
+            const Texture &texture = m_textures[i];
+            if (texture.m_resident_level == NO_LEVEL || texture.m_target_level != NO_LEVEL ||
+                texture.m_last_used != frame)
+                continue;
+            if (get_requested_level(i) < texture.m_resident_level)
+                candidates.push_back(i);
+        }
+        std::sort(
+            candidates.begin(), candidates.end(),
+            [this](uint32_t left, uint32_t right)
+            {
+                uint32_t left_deficit = m_textures[left].m_resident_level - get_requested_level(left);
+                uint32_t right_deficit = m_textures[right].m_resident_level - get_requested_level(right);
+                if (left_deficit != right_deficit)
+                    return left_deficit > right_deficit;
+                return left < right;
+            });
+
+        bool has_loaded = false;
+        for (uint32_t index : candidates)
+        {
+            Texture &texture = m_textures[index];
+            uint32_t resident = texture.m_resident_level;
+            vk::DeviceSize resident_size = texture.m_suffix_sizes[resident];
+
+            // 找出上传预算内最精细的级别，每次update至少前进一级
+            uint32_t level = get_requested_level(index);
+            while (level < resident &&
+                   uploaded + texture.m_suffix_sizes[level] - resident_size > m_config.m_upload_budget)
+                level++;
+            if (level == resident && !has_loaded)
+                level = resident - 1;
+            if (level == resident)
+            {
+                m_statistics.m_deferred++;
+                continue;
+            }
+
+            // 显存不够时先淘汰其他纹理，仍不够则换更粗的级别
+            vk::DeviceSize growth = texture.m_suffix_sizes[level] - resident_size;
+            if (usage + growth > budget)
+                evict(frame, budget > growth ? budget - growth : 0, index, usage, changes);
+            while (level < resident && usage + texture.m_suffix_sizes[level] - resident_size > budget)
+                level++;
+            if (level == resident)
+            {
+                m_statistics.m_deferred++;
+                continue;
+            }
+
+            uploaded += texture.m_suffix_sizes[level] - resident_size;
+            plan(index, level, usage, changes);
+            has_loaded = true;
+        }
+
+        // 变更完成前新旧图像同时存在
+        vk::DeviceSize peak = 0;
+        for (const Texture &texture : m_textures)
+        {
+            if (texture.m_resident_level != NO_LEVEL)
+                peak += texture.m_suffix_sizes[texture.m_resident_level];
+            if (texture.m_target_level != NO_LEVEL)
+                peak += texture.m_suffix_sizes[texture.m_target_level];
+        }
+        m_statistics.m_usage = usage;
+        m_statistics.m_peak_usage = std::max(m_statistics.m_peak_usage, peak);
+        if (usage > budget)
+            m_statistics.m_over_budget_updates++;
+
+        return changes;
+    }
+
+    vk::Result
+    TextureStreamer::record(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        const vk::CommandBuffer &command_buffer,
+        const std::vector<Change> &changes)
+    {
+        // 先把所有新级别写入暂存环，放不下的加载取消
+        std::vector<Change> recorded;
+        std::vector<std::vector<vk::BufferImageCopy>> uploads;
+        bool has_staged = false;
+        for (const Change &change : changes)
+        {
+            Texture &texture = m_textures[change.m_texture];
+            if (texture.m_target_level != change.m_new_level)
+                continue;
+
+            uint32_t old_level = change.m_old_level == NO_LEVEL ? texture.m_level_count : change.m_old_level;
+            std::vector<vk::BufferImageCopy> regions;
+            bool success = true;
+            for (uint32_t level = change.m_new_level; level < old_level && success; level++)
+            {
+                std::optional<StagingRing::Allocation> allocation;
+                if (m_ring != nullptr && texture.m_file)
+                    allocation = texture.m_file->stage_level(*m_ring, level);
+                success = allocation.has_value();
+                if (!success)
+                    break;
+
+                has_staged = true;
+                vk::BufferImageCopy region = texture.m_file->get_copy_region(level, allocation->m_offset);
+                region.imageSubresource.setMipLevel(level - change.m_new_level);
+                regions.push_back(region);
+            }
+            if (!success)
+            {
+                cancel(change.m_texture);
+                continue;
+            }
+            recorded.push_back(change);
+            uploads.push_back(std::move(regions));
+        }
+        if (has_staged)
+        {
+            m_unsubmitted_mark = m_ring->submit();
+            vk::Result result = m_ring->flush(device);
+            if (result != vk::Result::eSuccess)
+            {
+                cancel(device, recorded);
+                return result;
+            }
+        }
+        if (recorded.empty())
+            return vk::Result::eSuccess;
+
+        std::vector<vk::ImageMemoryBarrier> barriers;
+        for (const Change &change : recorded)
+        {
+            Texture &texture = m_textures[change.m_texture];
+            vk::Result result = create_image(device, physical_device, texture, change.m_new_level);
+            if (result != vk::Result::eSuccess)
+            {
+                // 命令在所有图像创建之后才记录，取消全部变更，否则retire会发布空的视图
+                cancel(device, recorded);
+                return result;
+            }
+
+            vk::ImageMemoryBarrier barrier;
+            barrier.setSrcAccessMask(vk::AccessFlags());
+            barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+            barrier.setOldLayout(vk::ImageLayout::eUndefined);
+            barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+            barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+            barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+            barrier.setImage(texture.m_next_image);
+            barrier.setSubresourceRange(vk::ImageSubresourceRange(
+                vk::ImageAspectFlagBits::eColor, 0, texture.m_level_count - change.m_new_level, 0, 1));
+            barriers.push_back(barrier);
+
+            // 旧图像在本次提交中只被读取，渲染仍可以继续采样
+            if (!texture.m_image)
+                continue;
+            barrier.setSrcAccessMask(vk::AccessFlagBits::eShaderRead);
+            barrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+            barrier.setOldLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+            barrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
+            barrier.setImage(texture.m_image);
+            barrier.setSubresourceRange(vk::ImageSubresourceRange(
+                vk::ImageAspectFlagBits::eColor, 0, texture.m_level_count - change.m_old_level, 0, 1));
+            barriers.push_back(barrier);
+        }
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTopOfPipe | vk::PipelineStageFlagBits::eFragmentShader,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::DependencyFlags(),
+            nullptr,
+            nullptr,
+            barriers);
+
+        for (size_t i = 0; i < recorded.size(); i++)
+        {
+            const Change &change = recorded[i];
+            Texture &texture = m_textures[change.m_texture];
+
+            // 两个图像都保留的级别直接在GPU上复制
+            if (texture.m_image)
+            {
+                std::vector<vk::ImageCopy> copies;
+                for (uint32_t level = std::max(change.m_old_level, change.m_new_level); level < texture.m_level_count; level++)
+                {
+                    vk::ImageCopy copy;
+                    copy.setSrcSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level - change.m_old_level, 0, 1));
+                    copy.setDstSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level - change.m_new_level, 0, 1));
+                    copy.setExtent(vk::Extent3D(std::max(texture.m_width >> level, 1u), std::max(texture.m_height >> level, 1u), 1));
+                    copies.push_back(copy);
+                }
+                command_buffer.copyImage(
+                    texture.m_image, vk::ImageLayout::eTransferSrcOptimal,
+                    texture.m_next_image, vk::ImageLayout::eTransferDstOptimal,
+                    copies);
+            }
+            if (!uploads[i].empty())
+                command_buffer.copyBufferToImage(m_ring->get_buffer(), texture.m_next_image, vk::ImageLayout::eTransferDstOptimal, uploads[i]);
+        }
+
+        for (vk::ImageMemoryBarrier &barrier : barriers)
+        {
+            bool is_source = barrier.oldLayout == vk::ImageLayout::eShaderReadOnlyOptimal;
+            barrier.setSrcAccessMask(is_source ? vk::AccessFlagBits::eTransferRead : vk::AccessFlagBits::eTransferWrite);
+            barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+            barrier.setOldLayout(is_source ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::eTransferDstOptimal);
+            barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+        }
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eFragmentShader,
+            vk::DependencyFlags(),
+            nullptr,
+            nullptr,
+            barriers);
+
+        return vk::Result::eSuccess;
+    }
+
+    void
+    TextureStreamer::submitted(
+        uint64_t value)
+    {
+        for (uint32_t index : m_unsubmitted)
+        {
+            m_textures[index].m_submit_value = value;
+            m_in_flight.push_back(index);
+        }
+        m_unsubmitted.clear();
+
+        if (m_unsubmitted_mark.has_value())
+        {
+            m_marks.push_back({*m_unsubmitted_mark, value});
+            m_unsubmitted_mark.reset();
+        }
+        m_last_submitted = std::max(m_last_submitted, value);
+    }
+
+    void
+    TextureStreamer::retire(
+        uint64_t completed,
+        const vk::Device &device)
+    {
+        auto retired = std::stable_partition(
+            m_in_flight.begin(), m_in_flight.end(),
+            [this, completed](uint32_t index)
+            { return m_textures[index].m_submit_value > completed; });
+        for (auto iter = retired; iter != m_in_flight.end(); iter++)
+        {
+            // 已提交的帧可能还在采样旧视图，等它们都完成后再销毁
+            Texture &texture = m_textures[*iter];
+            if (texture.m_image)
+                m_garbage.push_back({texture.m_image, texture.m_memory, texture.m_view, texture.m_allocation_size, m_last_submitted});
+            texture.m_image = texture.m_next_image;
+            texture.m_memory = texture.m_next_memory;
+            texture.m_view = texture.m_next_view;
+            texture.m_allocation_size = texture.m_next_allocation_size;
+            texture.m_next_image = nullptr;
+            texture.m_next_memory = nullptr;
+            texture.m_next_view = nullptr;
+            texture.m_next_allocation_size = 0;
+            texture.m_resident_level = texture.m_target_level;
+            texture.m_target_level = NO_LEVEL;
+            m_published.push_back(*iter);
+        }
+        m_in_flight.erase(retired, m_in_flight.end());
+
+        std::optional<vk::DeviceSize> mark;
+        while (!m_marks.empty() && m_marks.front().m_value <= completed)
+        {
+            mark = m_marks.front().m_mark;
+            m_marks.pop_front();
+        }
+        if (mark.has_value() && m_ring != nullptr)
+            m_ring->release(*mark);
+
+        while (!m_garbage.empty() && m_garbage.front().m_value <= completed)
+        {
+            Garbage &garbage = m_garbage.front();
+            if (device)
+                destroy_image(device, garbage.m_image, garbage.m_memory, garbage.m_view);
+            m_allocated_bytes -= std::min(m_allocated_bytes, garbage.m_allocation_size);
+            m_garbage.pop_front();
+        }
+    }
+
+    std::vector<uint32_t>
+    TextureStreamer::take_published()
+    {
+        std::vector<uint32_t> published;
+        published.swap(m_published);
+        return published;
+    }
+
+    vk::ImageView
+    TextureStreamer::get_view(
+        uint32_t texture) const noexcept
+    {
+        if (texture >= m_textures.size())
+            return nullptr;
+        return m_textures[texture].m_view;
+    }
+
+    uint32_t
+    TextureStreamer::get_resident_level(
+        uint32_t texture) const noexcept
+    {
+        if (texture >= m_textures.size())
+            return NO_LEVEL;
+        return m_textures[texture].m_resident_level;
+    }
+
+    uint32_t
+    TextureStreamer::get_requested_level(
+        uint32_t texture) const noexcept
+    {
+        if (texture >= m_textures.size())
+            return NO_LEVEL;
+        const Texture &target = m_textures[texture];
+        return std::min(target.m_requested_level, target.m_tail_level);
+    }
+
+    uint32_t
+    TextureStreamer::get_tail_level(
+        uint32_t texture) const noexcept
+    {
+        if (texture >= m_textures.size())
+            return NO_LEVEL;
+        return m_textures[texture].m_tail_level;
+    }
+
+    uint32_t
+    TextureStreamer::get_level_count(
+        uint32_t texture) const noexcept
+    {
+        if (texture >= m_textures.size())
+            return 0;
+        return m_textures[texture].m_level_count;
+    }
+
+    vk::Image
+    TextureStreamer::get_image(
+        uint32_t texture) const noexcept
+    {
+        if (texture >= m_textures.size())
+            return nullptr;
+        return m_textures[texture].m_image;
+    }
+
+    vk::DeviceSize
+    TextureStreamer::compute_budget(
+        const MemoryBudget &memory,
+        vk::DeviceSize reserve) const noexcept
+    {
+        // 报告的用量包含本对象的分配，扣除后才是其他用途的用量
+        vk::DeviceSize other = memory.m_usage > m_allocated_bytes ? memory.m_usage - m_allocated_bytes : 0;
+        if (memory.m_budget <= other + reserve)
+            return 0;
+        return memory.m_budget - other - reserve;
+    }
+
+    const TextureStreamer::Statistics &
+    TextureStreamer::get_statistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+    ntl::String
+    TextureStreamer::format() const
+    {
+        ntl::StringStream sstr;
+        sstr << std::endl
+             << NTL_STRING("\ttextures:") << m_textures.size() << std::endl
+             << NTL_STRING("\tloads:") << m_statistics.m_loads << std::endl
+             << NTL_STRING("\tevictions:") << m_statistics.m_evictions << std::endl
+             << NTL_STRING("\tdeferred:") << m_statistics.m_deferred << std::endl
+             << NTL_STRING("\tuploaded bytes:") << m_statistics.m_uploaded_bytes << std::endl
+             << NTL_STRING("\tevicted bytes:") << m_statistics.m_evicted_bytes << std::endl
+             << NTL_STRING("\tusage:") << m_statistics.m_usage << std::endl
+             << NTL_STRING("\tpeak usage:") << m_statistics.m_peak_usage << std::endl
+             << NTL_STRING("\tbudget:") << m_statistics.m_budget << std::endl
+             << NTL_STRING("\tover budget updates:") << m_statistics.m_over_budget_updates << std::endl
+             << NTL_STRING("\tallocated bytes:") << m_allocated_bytes << std::endl;
+        return sstr.str();
+    }
+
+    TextureStreamer::MemoryBudget
+    TextureStreamer::query_memory_budget(
+        const vk::PhysicalDevice &physical_device,
+        bool has_memory_budget)
+    {
+        MemoryBudget result;
+        if (has_memory_budget && physical_device.getProperties().apiVersion >= VK_API_VERSION_1_1)
+        {
+            auto chain = physical_device.getMemoryProperties2<vk::PhysicalDeviceMemoryProperties2, vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+            const vk::PhysicalDeviceMemoryProperties &properties = chain.get<vk::PhysicalDeviceMemoryProperties2>().memoryProperties;
+            const vk::PhysicalDeviceMemoryBudgetPropertiesEXT &budget = chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+            for (uint32_t i = 0; i < properties.memoryHeapCount; i++)
+                if (properties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal)
+                {
+                    result.m_budget += budget.heapBudget[i];
+                    result.m_usage += budget.heapUsage[i];
+                }
+            result.m_is_reported = true;
+            return result;
+        }
+
+        vk::PhysicalDeviceMemoryProperties properties = physical_device.getMemoryProperties();
+        for (uint32_t i = 0; i < properties.memoryHeapCount; i++)
+            if (properties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal)
+                result.m_budget += properties.memoryHeaps[i].size;
+        return result;
+    }
+
+    uint32_t
+    TextureStreamer::compute_level(
+        uint32_t width,
+        uint32_t height,
+        float pixel_extent) noexcept
+    {
+        if (!(pixel_extent > 0.0f))
+            return NO_LEVEL;
+        float ratio = static_cast<float>(std::max(width, height)) / pixel_extent;
+        if (ratio <= 1.0f)
+            return 0;
+        return std::min(static_cast<uint32_t>(std::floor(std::log2(ratio))), 31u);
+    }
+
+    std::optional<uint32_t>
+    TextureStreamer::add(
+        Texture &&texture,
+        const std::vector<vk::DeviceSize> &level_sizes)
+    {
+        if (m_textures.size() >= m_config.m_texture_count)
+        {
+            ntl::log.loge(
+                NTL_STRING("TextureStreamer::add"),
+                NTL_STRING("Texture count exceeds the config"));
+            return std::nullopt;
+        }
+
+        texture.m_suffix_sizes.assign(level_sizes.size() + 1, 0);
+        for (size_t level = level_sizes.size(); level > 0; level--)
+            texture.m_suffix_sizes[level - 1] = texture.m_suffix_sizes[level] + level_sizes[level - 1];
+
+        // 与Ktx2File::get_tail_level相同：最后一级超出预算时仍常驻最后一级
+        texture.m_tail_level = texture.m_level_count - 1;
+        while (texture.m_tail_level > 0 && texture.m_suffix_sizes[texture.m_tail_level - 1] <= m_config.m_tail_budget)
+            texture.m_tail_level--;
+
+        m_textures.push_back(std::move(texture));
+        return static_cast<uint32_t>(m_textures.size() - 1);
+    }
+
+    vk::DeviceSize
+    TextureStreamer::get_planned_size(
+        const Texture &texture) noexcept
+    {
+        uint32_t level = texture.m_target_level != NO_LEVEL ? texture.m_target_level : texture.m_resident_level;
+        return level == NO_LEVEL ? 0 : texture.m_suffix_sizes[level];
+    }
+
+    void
+    TextureStreamer::plan(
+        uint32_t index,
+        uint32_t level,
+        vk::DeviceSize &usage,
+        std::vector<Change> &changes)
+    {
+        Texture &texture = m_textures[index];
+        usage = usage - get_planned_size(texture) + texture.m_suffix_sizes[level];
+
+        vk::DeviceSize resident_size = texture.m_resident_level == NO_LEVEL ? 0 : texture.m_suffix_sizes[texture.m_resident_level];
+        if (texture.m_suffix_sizes[level] > resident_size)
+        {
+            m_statistics.m_loads++;
+            m_statistics.m_uploaded_bytes += texture.m_suffix_sizes[level] - resident_size;
+        }
+        else
+        {
+            m_statistics.m_evictions++;
+            m_statistics.m_evicted_bytes += resident_size - texture.m_suffix_sizes[level];
+        }
+
+        texture.m_target_level = level;
+        changes.push_back({index, texture.m_resident_level, level});
+        m_unsubmitted.push_back(index);
+    }
+
+    void
+    TextureStreamer::evict(
+        uint64_t frame,
+        vk::DeviceSize limit,
+        uint32_t exclude,
+        vk::DeviceSize &usage,
+        std::vector<Change> &changes)
+    {
+        std::vector<uint32_t> candidates;
+        for (uint32_t i = 0; i < m_textures.size(); i++)
+        {
+            const Texture &texture = m_textures[i];
+            if (i == exclude || texture.m_resident_level == NO_LEVEL || texture.m_target_level != NO_LEVEL)
+                continue;
+            uint32_t floor = texture.m_last_used == frame ? get_requested_level(i) : texture.m_tail_level;
+            if (texture.m_resident_level < floor)
+                candidates.push_back(i);
+        }
+        // 最久未使用的在前，同时未使用的先淘汰大的
+        std::sort(
+            candidates.begin(), candidates.end(),
+            [this](uint32_t left, uint32_t right)
+            {
+                const Texture &left_texture = m_textures[left];
+                const Texture &right_texture = m_textures[right];
+                if (left_texture.m_last_used != right_texture.m_last_used)
+                    return left_texture.m_last_used < right_texture.m_last_used;
+                return left_texture.m_suffix_sizes[left_texture.m_resident_level] >
+                       right_texture.m_suffix_sizes[right_texture.m_resident_level];
+            });
+
+        for (uint32_t index : candidates)
+        {
+            if (usage <= limit)
+                break;
+
+            const Texture &texture = m_textures[index];
+            uint32_t floor = texture.m_last_used == frame ? get_requested_level(index) : texture.m_tail_level;
+            vk::DeviceSize resident_size = texture.m_suffix_sizes[texture.m_resident_level];
+            uint32_t level = texture.m_resident_level + 1;
+            while (level < floor && usage - resident_size + texture.m_suffix_sizes[level] > limit)
+                level++;
+            plan(index, level, usage, changes);
+        }
+    }
+
+    void
+    TextureStreamer::cancel(
+        uint32_t index) noexcept
+    {
+        Texture &texture = m_textures[index];
+        vk::DeviceSize resident_size = texture.m_resident_level == NO_LEVEL ? 0 : texture.m_suffix_sizes[texture.m_resident_level];
+        vk::DeviceSize target_size = texture.m_suffix_sizes[texture.m_target_level];
+        if (target_size > resident_size)
+        {
+            m_statistics.m_loads--;
+            m_statistics.m_uploaded_bytes -= target_size - resident_size;
+            m_statistics.m_deferred++;
+        }
+        else
+        {
+            m_statistics.m_evictions--;
+            m_statistics.m_evicted_bytes -= resident_size - target_size;
+        }
+
+        texture.m_target_level = NO_LEVEL;
+        m_unsubmitted.erase(std::remove(m_unsubmitted.begin(), m_unsubmitted.end(), index), m_unsubmitted.end());
+    }
+
+    void
+    TextureStreamer::cancel(
+        const vk::Device &device,
+        const std::vector<Change> &changes)
+    {
+        for (const Change &change : changes)
+        {
+            destroy_next_image(device, m_textures[change.m_texture]);
+            cancel(change.m_texture);
+        }
+    }
+
+    vk::Result
+    TextureStreamer::create_image(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        Texture &texture,
+        uint32_t level)
+    {
+        uint32_t level_count = texture.m_level_count - level;
+
+        vk::ImageCreateInfo image_info;
+        image_info.setImageType(vk::ImageType::e2D);
+        image_info.setFormat(texture.m_format);
+        image_info.setExtent(vk::Extent3D(std::max(texture.m_width >> level, 1u), std::max(texture.m_height >> level, 1u), 1));
+        image_info.setMipLevels(level_count);
+        image_info.setArrayLayers(1);
+        image_info.setSamples(vk::SampleCountFlagBits::e1);
+        image_info.setTiling(vk::ImageTiling::eOptimal);
+        image_info.setUsage(vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled);
+        image_info.setSharingMode(vk::SharingMode::eExclusive);
+        image_info.setInitialLayout(vk::ImageLayout::eUndefined);
+        auto image_result = device.createImage(image_info);
+        if (image_result.result != vk::Result::eSuccess)
+            return image_result.result;
+        texture.m_next_image = image_result.value;
+
+        // 失败的分配和绑定已由allocate_image_memory释放内存
+
+        auto memory_result = DeviceUtils::allocate_image_memory(
+            device,
+            physical_device,
+            texture.m_next_image,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::MemoryPropertyFlags());
+        if (memory_result.result != vk::Result::eSuccess)
+        {
+            destroy_next_image(device, texture);
+            return memory_result.result;
+        }
+        texture.m_next_memory = memory_result.value;
+        texture.m_next_allocation_size = device.getImageMemoryRequirements(texture.m_next_image).size;
+        m_allocated_bytes += texture.m_next_allocation_size;
+
+        vk::ImageViewCreateInfo view_info;
+        view_info.setImage(texture.m_next_image);
+        view_info.setViewType(vk::ImageViewType::e2D);
+        view_info.setFormat(texture.m_format);
+        view_info.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, level_count, 0, 1));
+        auto view_result = device.createImageView(view_info);
+        if (view_result.result != vk::Result::eSuccess)
+        {
+            destroy_next_image(device, texture);
+            return view_result.result;
+        }
+        texture.m_next_view = view_result.value;
+
+        return vk::Result::eSuccess;
+    }
+
+    void
+    TextureStreamer::destroy_image(
+        const vk::Device &device,
+        vk::Image &image,
+        vk::DeviceMemory &memory,
+        vk::ImageView &view)
+    {
+        if (view)
+            device.destroyImageView(view);
+        if (image)
+            device.destroyImage(image);
+        if (memory)
+            device.freeMemory(memory);
+        view = nullptr;
+        image = nullptr;
+        memory = nullptr;
+    }
+
+    void
+    TextureStreamer::destroy_next_image(
+        const vk::Device &device,
+        Texture &texture)
+    {
+        destroy_image(device, texture.m_next_image, texture.m_next_memory, texture.m_next_view);
+        m_allocated_bytes -= std::min(m_allocated_bytes, texture.m_next_allocation_size);
+        texture.m_next_allocation_size = 0;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
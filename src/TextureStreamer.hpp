@@ -0,0 +1,397 @@
+#ifndef __VL_TEXTURESTREAMER_HPP__
+#define __VL_TEXTURESTREAMER_HPP__
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <string>
+#include <optional>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "StagingRing.hpp"
+#include "Ktx2File.hpp"
+
+namespace vl
+{
+    /// @brief 纹理流式加载：按屏幕空间反馈的需求级别加载更精细的mip，显存超出预算时按最近最少使用淘汰mip
+    /// @details 每个纹理始终驻留能放进尾部预算的小级别。渲染线程每帧用request或submit_feedback报告
+    /// 各纹理需要的最精细级别，调用update得到本帧的变更，用record为变更创建新图像、
+    /// 把保留的级别从旧图像复制过去并从暂存环上传新的级别，提交后调用submitted，
+    /// GPU完成后调用retire，新视图此时才发布，旧图像在已提交的帧都完成后销毁，渲染从不等待上传。
+    /// update只依赖CPU上的状态，可以不创建Vulkan对象，用合成的访问序列单独模拟
+    class TextureStreamer : public ntl::Object
+    {
+    public:
+        using SelfType = TextureStreamer;
+        using ParentType = ntl::Object;
+
+        /// @brief 没有级别，用于未驻留的纹理和没有请求的纹理
+        static constexpr uint32_t NO_LEVEL = UINT32_MAX;
+
+        /// @brief 配置
+        struct Config
+        {
+            /// @brief 最多的纹理数
+            uint32_t m_texture_count = 1024;
+
+            /// @brief 每次update最多上传的字节数
+            vk::DeviceSize m_upload_budget = 16 * 1024 * 1024;
+
+            /// @brief 常驻的尾部级别的字节数上限，见Ktx2File::get_tail_level
+            vk::DeviceSize m_tail_budget = 64 * 1024;
+        };
+
+        /// @brief 一个纹理的描述，不从文件添加时使用
+        struct Description
+        {
+            vk::Format m_format = vk::Format::eR8G8B8A8Unorm;
+            uint32_t m_width = 0;
+            uint32_t m_height = 0;
+
+            /// @brief 各级的字节数，第0级在前
+            std::vector<vk::DeviceSize> m_level_sizes;
+        };
+
+        /// @brief 一次驻留变更：新级别比旧级别精细时为加载，否则为淘汰
+        struct Change
+        {
+            uint32_t m_texture = 0;
+
+            /// @brief 变更前驻留的最精细级别，尚未驻留时为NO_LEVEL
+            uint32_t m_old_level = NO_LEVEL;
+
+            /// @brief 变更后驻留的最精细级别
+            uint32_t m_new_level = 0;
+        };
+
+        /// @brief 设备本地堆的预算和用量，来自VK_EXT_memory_budget
+        struct MemoryBudget
+        {
+            vk::DeviceSize m_budget = 0;
+            vk::DeviceSize m_usage = 0;
+
+            /// @brief 是否由拓展报告，否则预算为堆的大小，用量未知
+            bool m_is_reported = false;
+        };
+
+        /// @brief 统计信息
+        struct Statistics
+        {
+            uint64_t m_loads = 0;
+            uint64_t m_evictions = 0;
+
+            /// @brief 因为上传或显存预算推迟的加载
+            uint64_t m_deferred = 0;
+
+            uint64_t m_uploaded_bytes = 0;
+            uint64_t m_evicted_bytes = 0;
+
+            /// @brief 所有变更完成后的用量
+            vk::DeviceSize m_usage = 0;
+
+            /// @brief 变更期间新旧图像同时存在的用量的最大值
+            vk::DeviceSize m_peak_usage = 0;
+
+            /// @brief 上一次update的预算
+            vk::DeviceSize m_budget = 0;
+
+            /// @brief 淘汰后仍超出预算的update次数，此时本帧使用的级别无法淘汰
+            uint64_t m_over_budget_updates = 0;
+        };
+
+    protected:
+        /// @brief 纹理
+        struct Texture
+        {
+            /// @brief 从文件添加时打开的文件，用于上传
+            std::unique_ptr<Ktx2File> m_file;
+
+            vk::Format m_format = vk::Format::eUndefined;
+            uint32_t m_width = 0;
+            uint32_t m_height = 0;
+            uint32_t m_level_count = 0;
+
+            /// @brief 常驻的最精细级别
+            uint32_t m_tail_level = 0;
+
+            /// @brief 从每一级到最后一级的总字节数，多一项0
+            std::vector<vk::DeviceSize> m_suffix_sizes;
+
+            /// @brief 已发布的最精细级别
+            uint32_t m_resident_level = NO_LEVEL;
+
+            /// @brief 进行中的变更的目标级别
+            uint32_t m_target_level = NO_LEVEL;
+
+            /// @brief 最近一次使用的帧中请求的最精细级别
+            uint32_t m_requested_level = NO_LEVEL;
+
+            /// @brief 最近一次使用的帧
+            std::optional<uint64_t> m_last_used;
+
+            /// @brief 变更所在提交的值
+            uint64_t m_submit_value = 0;
+
+            vk::Image m_image;
+            vk::DeviceMemory m_memory;
+            vk::ImageView m_view;
+            vk::DeviceSize m_allocation_size = 0;
+
+            /// @brief 进行中的变更创建的图像
+            vk::Image m_next_image;
+            vk::DeviceMemory m_next_memory;
+            vk::ImageView m_next_view;
+            vk::DeviceSize m_next_allocation_size = 0;
+        };
+
+        /// @brief 等待销毁的旧图像
+        struct Garbage
+        {
+            vk::Image m_image;
+            vk::DeviceMemory m_memory;
+            vk::ImageView m_view;
+            vk::DeviceSize m_allocation_size = 0;
+
+            /// @brief 值不超过它的提交完成后才能销毁
+            uint64_t m_value = 0;
+        };
+
+        /// @brief 暂存环回收的位置
+        struct Mark
+        {
+            vk::DeviceSize m_mark = 0;
+            uint64_t m_value = 0;
+        };
+
+    protected:
+        Config m_config;
+        StagingRing *m_ring = nullptr;
+
+        std::vector<Texture> m_textures;
+
+        /// @brief update交出、等待submitted的纹理
+        std::vector<uint32_t> m_unsubmitted;
+
+        /// @brief 已提交、等待retire的纹理
+        std::vector<uint32_t> m_in_flight;
+
+        /// @brief 已发布、等待take_published取走的纹理
+        std::vector<uint32_t> m_published;
+
+        std::deque<Garbage> m_garbage;
+
+        /// @brief 尚未提交的暂存环位置和已提交的位置，按分配顺序
+        std::optional<vk::DeviceSize> m_unsubmitted_mark;
+        std::deque<Mark> m_marks;
+
+        /// @brief 最近一次提交的值
+        uint64_t m_last_submitted = 0;
+
+        /// @brief 本对象分配的设备内存
+        vk::DeviceSize m_allocated_bytes = 0;
+
+        Statistics m_statistics;
+
+    public:
+        TextureStreamer() = default;
+        ~TextureStreamer() override = default;
+
+        TextureStreamer(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 初始化
+        /// @param config 配置
+        /// @param ring 上传使用的暂存环，只在CPU上模拟时可以为空
+        /// @return 是否成功
+        bool create(const Config &config, StagingRing *ring = nullptr);
+
+        /// @brief 销毁所有图像，调用前需要保证设备已不再使用它们
+        /// @param device 逻辑设备，只在CPU上模拟时可以为空
+        void destroy(const vk::Device &device);
+
+        /// @brief 添加KTX2文件，文件保持打开，各级从映射上传
+        /// @param path 路径
+        /// @return 纹理，文件无效或纹理已满时为空
+        std::optional<uint32_t> add(const std::string &path);
+
+        /// @brief 添加没有文件的纹理，只能在CPU上模拟
+        /// @param description 描述
+        /// @return 纹理，描述无效或纹理已满时为空
+        std::optional<uint32_t> add(const Description &description);
+
+        /// @brief 报告本帧使用了纹理，同一帧内多次报告取最精细的级别
+        /// @param texture 纹理
+        /// @param level 需要的最精细级别
+        /// @param frame 帧序号，单调增加
+        void request(uint32_t texture, uint32_t level, uint64_t frame) noexcept;
+
+        /// @brief 报告GPU写入的反馈，例如着色器对每个纹理用atomicMin写入的最精细级别
+        /// @param levels 每个纹理一项，NO_LEVEL表示本帧未使用
+        /// @param count 项数
+        /// @param frame 反馈所属的帧
+        void submit_feedback(const uint32_t *levels, uint32_t count, uint64_t frame) noexcept;
+
+        /// @brief 决定本帧的加载和淘汰，每帧在渲染线程调用一次
+        /// @details 先让尚未驻留的纹理加载尾部，再按需求与驻留级别的差距从大到小加载本帧使用的纹理，
+        /// 每次update的上传量不超过配置的预算；用量超出预算时从最久未使用的纹理开始逐级淘汰，
+        /// 本帧使用的纹理只淘汰比需求更精细的级别，放不下的加载留到以后
+        /// @param frame 帧序号，与request一致
+        /// @param budget 流式纹理可以使用的字节数，见compute_budget
+        /// @return 需要记录的变更
+        std::vector<Change> update(uint64_t frame, vk::DeviceSize budget);
+
+        /// @brief 为变更创建图像并记录复制和上传，之后新图像处于ShaderReadOnlyOptimal
+        /// @details 暂存环空间不足的加载被取消，下次update重新决定；
+        /// 刷新暂存环或创建图像失败时不记录任何命令，所有变更被取消
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param command_buffer 命令缓冲，需要在使用纹理的绘制之前提交
+        /// @param changes update的结果
+        /// @return 结果
+        vk::Result record(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            const vk::CommandBuffer &command_buffer,
+            const std::vector<Change> &changes);
+
+        /// @brief 告知update交出的变更已随一次提交发出
+        /// @param value 该次提交的值，单调增加
+        void submitted(uint64_t value);
+
+        /// @brief 值不超过completed的提交已完成，发布其中的变更并销毁不再使用的旧图像
+        /// @param completed 已完成的提交的值
+        /// @param device 逻辑设备，只在CPU上模拟时可以为空
+        void retire(uint64_t completed, const vk::Device &device);
+
+        /// @brief 取走上次调用以来视图发生变化的纹理，用于更新描述符
+        /// @return 纹理
+        std::vector<uint32_t> take_published();
+
+        /// @brief 获取纹理当前的视图
+        /// @param texture 纹理
+        /// @return 视图，尾部驻留之前为空
+        vk::ImageView get_view(uint32_t texture) const noexcept;
+
+        /// @brief 获取纹理已发布的最精细级别
+        /// @param texture 纹理
+        /// @return 级别，尾部驻留之前为NO_LEVEL
+        uint32_t get_resident_level(uint32_t texture) const noexcept;
+
+        /// @brief 获取纹理最近一次使用时请求的级别，限制在常驻级别以内
+        /// @param texture 纹理
+        /// @return 级别
+        uint32_t get_requested_level(uint32_t texture) const noexcept;
+
+        /// @brief 获取纹理常驻的尾部级别
+        /// @param texture 纹理
+        /// @return 级别
+        uint32_t get_tail_level(uint32_t texture) const noexcept;
+
+        /// @brief 获取纹理的级数
+        /// @param texture 纹理
+        /// @return 级数
+        uint32_t get_level_count(uint32_t texture) const noexcept;
+
+        /// @brief 获取纹理的图像，用于读回等调试用途
+        /// @param texture 纹理
+        /// @return 图像，尾部驻留之前为空
+        vk::Image get_image(uint32_t texture) const noexcept;
+
+        /// @brief 由设备的预算算出流式纹理可以使用的字节数：预算减去其他用途的用量和保留量
+        /// @param memory query_memory_budget的结果
+        /// @param reserve 为其他分配保留的字节数
+        /// @return 字节数
+        vk::DeviceSize compute_budget(const MemoryBudget &memory, vk::DeviceSize reserve) const noexcept;
+
+        /// @brief 获取统计信息
+        /// @return 统计信息
+        const Statistics &get_statistics() const noexcept;
+
+        /// @brief 格式化统计信息
+        /// @return 格式化后的结果
+        ntl::String format() const;
+
+    public:
+        /// @brief 查询设备本地堆的预算和用量
+        /// @details 需要设备启用VK_EXT_memory_budget且物理设备支持Vulkan 1.1，否则预算为堆的大小
+        /// @param physical_device 物理设备
+        /// @param has_memory_budget 是否启用了VK_EXT_memory_budget
+        /// @return 所有设备本地堆之和
+        static MemoryBudget query_memory_budget(const vk::PhysicalDevice &physical_device, bool has_memory_budget);
+
+        /// @brief 由纹理覆盖的屏幕像素数计算需要的级别，每像素约一个纹素
+        /// @param width 第0级的宽度
+        /// @param height 第0级的高度
+        /// @param pixel_extent 纹理在屏幕上的边长，像素
+        /// @return 级别，不在屏幕上时为NO_LEVEL
+        static uint32_t compute_level(uint32_t width, uint32_t height, float pixel_extent) noexcept;
+
+    protected:
+        /// @brief 添加纹理的公共部分
+        /// @param texture 已填好格式、尺寸、级数和尾部级别的纹理
+        /// @param level_sizes 各级的字节数
+        /// @return 纹理
+        std::optional<uint32_t> add(Texture &&texture, const std::vector<vk::DeviceSize> &level_sizes);
+
+        /// @brief 纹理在所有变更完成后的字节数
+        /// @param texture 纹理
+        /// @return 字节数
+        static vk::DeviceSize get_planned_size(const Texture &texture) noexcept;
+
+        /// @brief 计划一次变更
+        /// @param index 纹理
+        /// @param level 新级别
+        /// @param usage 计划用量，随变更更新
+        /// @param changes 输出的变更
+        void plan(uint32_t index, uint32_t level, vk::DeviceSize &usage, std::vector<Change> &changes);
+
+        /// @brief 从最久未使用的纹理开始逐级淘汰，直到用量不超过上限
+        /// @details 本帧使用的纹理只淘汰比需求更精细的级别，常驻的尾部和进行中的变更不动
+        /// @param frame 当前帧
+        /// @param limit 用量上限
+        /// @param exclude 不淘汰的纹理，没有时为NO_LEVEL
+        /// @param usage 计划用量，随变更更新
+        /// @param changes 输出的变更
+        void evict(uint64_t frame, vk::DeviceSize limit, uint32_t exclude, vk::DeviceSize &usage, std::vector<Change> &changes);
+
+        /// @brief 取消一个已计划的变更
+        /// @param index 纹理
+        void cancel(uint32_t index) noexcept;
+
+        /// @brief 记录失败时取消变更，销毁已为它们创建的新图像
+        /// @param device 逻辑设备
+        /// @param changes 变更
+        void cancel(const vk::Device &device, const std::vector<Change> &changes);
+
+        /// @brief 为变更创建图像、内存和视图，失败时销毁已创建的部分
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param texture 纹理
+        /// @param level 新的最精细级别
+        /// @return 结果
+        vk::Result create_image(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            Texture &texture,
+            uint32_t level);
+
+        /// @brief 销毁图像、内存和视图
+        /// @param device 逻辑设备
+        /// @param image 图像
+        /// @param memory 内存
+        /// @param view 视图
+        static void destroy_image(
+            const vk::Device &device,
+            vk::Image &image,
+            vk::DeviceMemory &memory,
+            vk::ImageView &view);
+
+        /// @brief 销毁进行中的变更创建的图像
+        /// @param device 逻辑设备
+        /// @param texture 纹理
+        void destroy_next_image(const vk::Device &device, Texture &texture);
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,143 @@
+#ifndef __VL_THREADPOOL_CPP__
+#define __VL_THREADPOOL_CPP__
+
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include "ThreadPool.hpp"
+
+namespace vl
+{
+    ThreadPool::ThreadPool(
+        size_t thread_count)
+    {
+        if (thread_count == 0)
+            thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+        for (size_t i = 0; i < thread_count; i++)
+            m_threads.emplace_back(&ThreadPool::worker_loop, this);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_stopping = true;
+        }
+        m_task_cv.notify_all();
+
+        for (auto iter = m_threads.begin(); iter != m_threads.end(); iter++)
+            iter->join();
+    }
+
+    size_t
+    ThreadPool::get_thread_count() const noexcept
+    {
+        return m_threads.size();
+    }
+
+    void
+    ThreadPool::post(
+        TaskType task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_task_cv.notify_one();
+    }
+
+    template <typename Func>
+    auto
+    ThreadPool::submit(
+        Func func) -> std::future<decltype(func())>
+    {
+        using ResultType = decltype(func());
+
+        auto task = std::make_shared<std::packaged_task<ResultType()>>(std::move(func));
+        std::future<ResultType> future = task->get_future();
+        post([task]()
+             { (*task)(); });
+        return future;
+    }
+
+    template <typename Func>
+    void
+    ThreadPool::parallel_for(
+        size_t count,
+        size_t grain,
+        Func func)
+    {
+        if (count == 0)
+            return;
+
+        grain = std::max<size_t>(1, grain);
+        size_t chunk_count = (count + grain - 1) / grain;
+        if (chunk_count == 1)
+        {
+            func(size_t(0), count);
+            return;
+        }
+
+        // 每个参与者从共享的计数器领取块，调用线程也一起领取
+        struct SharedState
+        {
+            std::atomic<size_t> m_next_chunk{0};
+            std::atomic<size_t> m_done_chunks{0};
+            std::mutex m_mutex;
+            std::condition_variable m_done_cv;
+        };
+        auto state = std::make_shared<SharedState>();
+
+        auto run_chunks = [state, count, grain, chunk_count, &func]()
+        {
+            size_t done = 0;
+            while (true)
+            {
+                size_t chunk = state->m_next_chunk.fetch_add(1);
+                if (chunk >= chunk_count)
+                    break;
+                size_t begin = chunk * grain;
+                func(begin, std::min(count, begin + grain));
+                done++;
+            }
+
+            if (done != 0 &&
+                state->m_done_chunks.fetch_add(done) + done == chunk_count)
+            {
+                std::lock_guard<std::mutex> lock(state->m_mutex);
+                state->m_done_cv.notify_all();
+            }
+        };
+
+        size_t helper_count = std::min(m_threads.size(), chunk_count - 1);
+        for (size_t i = 0; i < helper_count; i++)
+            post(run_chunks);
+        run_chunks();
+
+        std::unique_lock<std::mutex> lock(state->m_mutex);
+        state->m_done_cv.wait(lock, [state, chunk_count]()
+                              { return state->m_done_chunks.load() == chunk_count; });
+    }
+
+    void
+    ThreadPool::worker_loop()
+    {
+        while (true)
+        {
+            TaskType task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_task_cv.wait(lock, [this]()
+                               { return m_is_stopping || !m_tasks.empty(); });
+                if (m_is_stopping && m_tasks.empty())
+                    return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
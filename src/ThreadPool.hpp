@@ -0,0 +1,71 @@
+#ifndef __VL_THREADPOOL_HPP__
+#define __VL_THREADPOOL_HPP__
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 线程池
+    class ThreadPool : public ntl::Object
+    {
+    public:
+        using SelfType = ThreadPool;
+        using ParentType = ntl::Object;
+
+        /// @brief 任务类型
+        using TaskType = std::function<void()>;
+
+    protected:
+        std::vector<std::thread> m_threads;
+        std::deque<TaskType> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_task_cv;
+        bool m_is_stopping = false;
+
+    public:
+        /// @brief 创建线程池
+        /// @param thread_count 线程数，为0时使用硬件线程数
+        explicit ThreadPool(size_t thread_count = 0);
+        ~ThreadPool() override;
+
+        ThreadPool(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 获取线程数
+        /// @return 线程数
+        size_t get_thread_count() const noexcept;
+
+        /// @brief 提交一个任务
+        /// @param task 任务
+        void post(TaskType task);
+
+        /// @brief 提交一个任务
+        /// @tparam Func 函数类型
+        /// @param func 函数
+        /// @return 结果的future
+        template <typename Func>
+        auto submit(Func func) -> std::future<decltype(func())>;
+
+        /// @brief 把[0, count)分块并行执行，调用线程也参与执行，全部完成后返回
+        /// @tparam Func 函数类型，参数为(begin, end)
+        /// @param count 总数
+        /// @param grain 每块的最小数量
+        /// @param func 函数
+        template <typename Func>
+        void parallel_for(size_t count, size_t grain, Func func);
+
+    protected:
+        /// @brief 工作线程
+        void worker_loop();
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
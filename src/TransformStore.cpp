@@ -0,0 +1,399 @@
+#ifndef __VL_TRANSFORMSTORE_CPP__
+#define __VL_TRANSFORMSTORE_CPP__
+
+#include <cmath>
+#include <algorithm>
+#include "TransformStore.hpp"
+#include "Simd.hpp"
+
+namespace vl
+{
+    // 每种Lanes提供同一组运算，V中的每个通道是一个物体
+    // store_column把4个寄存器（某一列的4行）转置后写到每个物体的对应列
+
+    struct TransformStore::ScalarLanes
+    {
+        using V = float;
+        static constexpr size_t WIDTH = 1;
+
+        static V load(const float *p) { return *p; }
+        static V set1(float f) { return f; }
+        static V add(V a, V b) { return a + b; }
+        static V sub(V a, V b) { return a - b; }
+        static V mul(V a, V b) { return a * b; }
+
+        static void store_column(uint8_t *destination, size_t, size_t column, V r0, V r1, V r2, V r3)
+        {
+            float *out = reinterpret_cast<float *>(destination) + column * 4;
+            out[0] = r0;
+            out[1] = r1;
+            out[2] = r2;
+            out[3] = r3;
+        }
+    };
+
+#if defined(VL_SIMD_SSE2)
+    struct TransformStore::Sse2Lanes
+    {
+        using V = __m128;
+        static constexpr size_t WIDTH = 4;
+
+        static V load(const float *p) { return _mm_loadu_ps(p); }
+        static V set1(float f) { return _mm_set1_ps(f); }
+        static V add(V a, V b) { return _mm_add_ps(a, b); }
+        static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+        static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+
+        static void store_column(uint8_t *destination, size_t stride, size_t column, V r0, V r1, V r2, V r3)
+        {
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            destination += column * 16;
+            _mm_storeu_ps(reinterpret_cast<float *>(destination), r0);
+            _mm_storeu_ps(reinterpret_cast<float *>(destination + stride), r1);
+            _mm_storeu_ps(reinterpret_cast<float *>(destination + stride * 2), r2);
+            _mm_storeu_ps(reinterpret_cast<float *>(destination + stride * 3), r3);
+        }
+    };
+#endif
+
+#if defined(VL_SIMD_AVX)
+    struct TransformStore::AvxLanes
+    {
+        using V = __m256;
+        static constexpr size_t WIDTH = 8;
+
+        static V load(const float *p) { return _mm256_loadu_ps(p); }
+        static V set1(float f) { return _mm256_set1_ps(f); }
+        static V add(V a, V b) { return _mm256_add_ps(a, b); }
+        static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+        static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+
+        static void store_column(uint8_t *destination, size_t stride, size_t column, V r0, V r1, V r2, V r3)
+        {
+            // 在两个128位通道内分别转置，低半部分是物体0~3，高半部分是物体4~7
+            V t0 = _mm256_unpacklo_ps(r0, r1);
+            V t1 = _mm256_unpacklo_ps(r2, r3);
+            V t2 = _mm256_unpackhi_ps(r0, r1);
+            V t3 = _mm256_unpackhi_ps(r2, r3);
+            V c[4] = {
+                _mm256_shuffle_ps(t0, t1, 0x44),
+                _mm256_shuffle_ps(t0, t1, 0xEE),
+                _mm256_shuffle_ps(t2, t3, 0x44),
+                _mm256_shuffle_ps(t2, t3, 0xEE),
+            };
+
+            destination += column * 16;
+            for (size_t i = 0; i < 4; i++)
+            {
+                _mm_storeu_ps(reinterpret_cast<float *>(destination + stride * i), _mm256_castps256_ps128(c[i]));
+                _mm_storeu_ps(reinterpret_cast<float *>(destination + stride * (i + 4)), _mm256_extractf128_ps(c[i], 1));
+            }
+        }
+    };
+#endif
+
+#if defined(VL_SIMD_NEON)
+    struct TransformStore::NeonLanes
+    {
+        using V = float32x4_t;
+        static constexpr size_t WIDTH = 4;
+
+        static V load(const float *p) { return vld1q_f32(p); }
+        static V set1(float f) { return vdupq_n_f32(f); }
+        static V add(V a, V b) { return vaddq_f32(a, b); }
+        static V sub(V a, V b) { return vsubq_f32(a, b); }
+        static V mul(V a, V b) { return vmulq_f32(a, b); }
+
+        static void store_column(uint8_t *destination, size_t stride, size_t column, V r0, V r1, V r2, V r3)
+        {
+            float32x4x2_t t01 = vtrnq_f32(r0, r1);
+            float32x4x2_t t23 = vtrnq_f32(r2, r3);
+            destination += column * 16;
+            vst1q_f32(reinterpret_cast<float *>(destination),
+                      vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+            vst1q_f32(reinterpret_cast<float *>(destination + stride),
+                      vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+            vst1q_f32(reinterpret_cast<float *>(destination + stride * 2),
+                      vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+            vst1q_f32(reinterpret_cast<float *>(destination + stride * 3),
+                      vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+        }
+    };
+#endif
+
+    size_t
+    TransformStore::size() const noexcept
+    {
+        return m_position_x.size();
+    }
+
+    void
+    TransformStore::resize(
+        size_t count)
+    {
+        m_position_x.resize(count, 0.0f);
+        m_position_y.resize(count, 0.0f);
+        m_position_z.resize(count, 0.0f);
+        m_rotation_x.resize(count, 0.0f);
+        m_rotation_y.resize(count, 0.0f);
+        m_rotation_z.resize(count, 0.0f);
+        m_rotation_w.resize(count, 1.0f);
+        m_scale_x.resize(count, 1.0f);
+        m_scale_y.resize(count, 1.0f);
+        m_scale_z.resize(count, 1.0f);
+    }
+
+    void
+    TransformStore::clear() noexcept
+    {
+        resize(0);
+    }
+
+    size_t
+    TransformStore::add(
+        const Transform &transform)
+    {
+        size_t index = size();
+        resize(index + 1);
+        set(index, transform);
+        return index;
+    }
+
+    void
+    TransformStore::set(
+        size_t index,
+        const Transform &transform)
+    {
+        set_position(index, transform.m_position[0], transform.m_position[1], transform.m_position[2]);
+        set_rotation(index, transform.m_rotation[0], transform.m_rotation[1], transform.m_rotation[2], transform.m_rotation[3]);
+        set_scale(index, transform.m_scale[0], transform.m_scale[1], transform.m_scale[2]);
+    }
+
+    TransformStore::Transform
+    TransformStore::get(
+        size_t index) const
+    {
+        Transform transform;
+        transform.m_position[0] = m_position_x[index];
+        transform.m_position[1] = m_position_y[index];
+        transform.m_position[2] = m_position_z[index];
+        transform.m_rotation[0] = m_rotation_x[index];
+        transform.m_rotation[1] = m_rotation_y[index];
+        transform.m_rotation[2] = m_rotation_z[index];
+        transform.m_rotation[3] = m_rotation_w[index];
+        transform.m_scale[0] = m_scale_x[index];
+        transform.m_scale[1] = m_scale_y[index];
+        transform.m_scale[2] = m_scale_z[index];
+        return transform;
+    }
+
+    void
+    TransformStore::set_position(
+        size_t index,
+        float x,
+        float y,
+        float z)
+    {
+        m_position_x[index] = x;
+        m_position_y[index] = y;
+        m_position_z[index] = z;
+    }
+
+    void
+    TransformStore::set_rotation(
+        size_t index,
+        float x,
+        float y,
+        float z,
+        float w)
+    {
+        m_rotation_x[index] = x;
+        m_rotation_y[index] = y;
+        m_rotation_z[index] = z;
+        m_rotation_w[index] = w;
+    }
+
+    void
+    TransformStore::set_scale(
+        size_t index,
+        float x,
+        float y,
+        float z)
+    {
+        m_scale_x[index] = x;
+        m_scale_y[index] = y;
+        m_scale_z[index] = z;
+    }
+
+    void
+    TransformStore::compute(
+        const float view_projection[16],
+        void *destination,
+        size_t stride,
+        ThreadPool *pool) const
+    {
+        if (pool == nullptr || size() <= PARALLEL_GRAIN)
+        {
+            compute_range(view_projection, destination, stride, 0, size());
+            return;
+        }
+
+        uint8_t *bytes = static_cast<uint8_t *>(destination);
+        pool->parallel_for(
+            size(),
+            PARALLEL_GRAIN,
+            [this, view_projection, bytes, stride](size_t begin, size_t end)
+            { compute_range(view_projection, bytes + begin * stride, stride, begin, end); });
+    }
+
+    void
+    TransformStore::compute_range(
+        const float view_projection[16],
+        void *destination,
+        size_t stride,
+        size_t begin,
+        size_t end) const
+    {
+        uint8_t *bytes = static_cast<uint8_t *>(destination);
+        size_t index = begin;
+
+#if defined(VL_SIMD_AVX)
+        index = compute_lanes<AvxLanes>(view_projection, bytes, stride, index, end);
+#endif
+#if defined(VL_SIMD_SSE2)
+        index = compute_lanes<Sse2Lanes>(view_projection, bytes + (index - begin) * stride, stride, index, end);
+#elif defined(VL_SIMD_NEON)
+        index = compute_lanes<NeonLanes>(view_projection, bytes + (index - begin) * stride, stride, index, end);
+#endif
+        compute_lanes<ScalarLanes>(view_projection, bytes + (index - begin) * stride, stride, index, end);
+    }
+
+    vk::Result
+    TransformStore::write(
+        const vk::Device &device,
+        MappedBuffer &buffer,
+        vk::DeviceSize offset,
+        vk::DeviceSize stride,
+        const float view_projection[16],
+        ThreadPool *pool) const
+    {
+        vk::DeviceSize required = offset + stride * size();
+        if (stride < MATRIX_SIZE || buffer.m_mapped == nullptr || required > buffer.m_size)
+        {
+            ntl::log.loge(
+                NTL_STRING("TransformStore::write"),
+                ntl::StringUtils::to_string(
+                    NTL_STRING("Buffer is not mapped or too small, required size:"),
+                    static_cast<unsigned long long>(required)));
+            return vk::Result::eErrorOutOfDeviceMemory;
+        }
+
+        compute(view_projection, buffer.data<uint8_t>() + offset, static_cast<size_t>(stride), pool);
+        return buffer.flush(device, offset, stride * size());
+    }
+
+    vk::DeviceSize
+    TransformStore::get_stride(
+        const vk::PhysicalDeviceLimits &limits,
+        bool is_dynamic_uniform)
+    {
+        if (!is_dynamic_uniform)
+            return MATRIX_SIZE;
+
+        vk::DeviceSize alignment = std::max<vk::DeviceSize>(1, limits.minUniformBufferOffsetAlignment);
+        return (MATRIX_SIZE + alignment - 1) / alignment * alignment;
+    }
+
+    void
+    TransformStore::make_rotation(
+        float x,
+        float y,
+        float z,
+        float angle,
+        float quaternion[4])
+    {
+        float length = std::sqrt(x * x + y * y + z * z);
+        if (length < 1e-6f)
+        {
+            quaternion[0] = quaternion[1] = quaternion[2] = 0.0f;
+            quaternion[3] = 1.0f;
+            return;
+        }
+
+        float s = std::sin(angle * 0.5f) / length;
+        quaternion[0] = x * s;
+        quaternion[1] = y * s;
+        quaternion[2] = z * s;
+        quaternion[3] = std::cos(angle * 0.5f);
+    }
+
+    template <typename Lanes>
+    size_t
+    TransformStore::compute_lanes(
+        const float view_projection[16],
+        uint8_t *destination,
+        size_t stride,
+        size_t begin,
+        size_t end) const
+    {
+        using V = typename Lanes::V;
+
+        // 视图投影矩阵的每个元素广播到所有通道，vp[k][r]为第k列第r行
+        V vp[4][4];
+        for (size_t k = 0; k < 4; k++)
+            for (size_t r = 0; r < 4; r++)
+                vp[k][r] = Lanes::set1(view_projection[k * 4 + r]);
+        const V one = Lanes::set1(1.0f);
+        const V two = Lanes::set1(2.0f);
+
+        size_t index = begin;
+        for (; index + Lanes::WIDTH <= end; index += Lanes::WIDTH)
+        {
+            V qx = Lanes::load(&m_rotation_x[index]);
+            V qy = Lanes::load(&m_rotation_y[index]);
+            V qz = Lanes::load(&m_rotation_z[index]);
+            V qw = Lanes::load(&m_rotation_w[index]);
+            V sx = Lanes::load(&m_scale_x[index]);
+            V sy = Lanes::load(&m_scale_y[index]);
+            V sz = Lanes::load(&m_scale_z[index]);
+
+            V xx = Lanes::mul(qx, qx), yy = Lanes::mul(qy, qy), zz = Lanes::mul(qz, qz);
+            V xy = Lanes::mul(qx, qy), xz = Lanes::mul(qx, qz), yz = Lanes::mul(qy, qz);
+            V wx = Lanes::mul(qw, qx), wy = Lanes::mul(qw, qy), wz = Lanes::mul(qw, qz);
+
+            // 模型矩阵的前三列：旋转乘缩放
+            V m[3][3];
+            m[0][0] = Lanes::mul(Lanes::sub(one, Lanes::mul(two, Lanes::add(yy, zz))), sx);
+            m[0][1] = Lanes::mul(Lanes::mul(two, Lanes::add(xy, wz)), sx);
+            m[0][2] = Lanes::mul(Lanes::mul(two, Lanes::sub(xz, wy)), sx);
+            m[1][0] = Lanes::mul(Lanes::mul(two, Lanes::sub(xy, wz)), sy);
+            m[1][1] = Lanes::mul(Lanes::sub(one, Lanes::mul(two, Lanes::add(xx, zz))), sy);
+            m[1][2] = Lanes::mul(Lanes::mul(two, Lanes::add(yz, wx)), sy);
+            m[2][0] = Lanes::mul(Lanes::mul(two, Lanes::add(xz, wy)), sz);
+            m[2][1] = Lanes::mul(Lanes::mul(two, Lanes::sub(yz, wx)), sz);
+            m[2][2] = Lanes::mul(Lanes::sub(one, Lanes::mul(two, Lanes::add(xx, yy))), sz);
+
+            uint8_t *out = destination + (index - begin) * stride;
+            for (size_t c = 0; c < 3; c++)
+            {
+                V r[4];
+                for (size_t i = 0; i < 4; i++)
+                    r[i] = Lanes::add(Lanes::add(Lanes::mul(vp[0][i], m[c][0]), Lanes::mul(vp[1][i], m[c][1])), Lanes::mul(vp[2][i], m[c][2]));
+                Lanes::store_column(out, stride, c, r[0], r[1], r[2], r[3]);
+            }
+
+            // 第四列：平移
+            V tx = Lanes::load(&m_position_x[index]);
+            V ty = Lanes::load(&m_position_y[index]);
+            V tz = Lanes::load(&m_position_z[index]);
+            V r[4];
+            for (size_t i = 0; i < 4; i++)
+                r[i] = Lanes::add(Lanes::add(Lanes::mul(vp[0][i], tx), Lanes::mul(vp[1][i], ty)), Lanes::add(Lanes::mul(vp[2][i], tz), vp[3][i]));
+            Lanes::store_column(out, stride, 3, r[0], r[1], r[2], r[3]);
+        }
+
+        return index;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
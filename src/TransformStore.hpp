@@ -0,0 +1,173 @@
+#ifndef __VL_TRANSFORMSTORE_HPP__
+#define __VL_TRANSFORMSTORE_HPP__
+
+#include <vector>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "MappedBuffer.hpp"
+#include "ThreadPool.hpp"
+
+namespace vl
+{
+    /// @brief 以结构数组（SoA）保存大量物体的变换，批量计算MVP矩阵
+    class TransformStore : public ntl::Object
+    {
+    public:
+        using SelfType = TransformStore;
+        using ParentType = ntl::Object;
+
+        /// @brief 单个物体的变换
+        struct Transform
+        {
+            /// @brief 位置
+            float m_position[3] = {0.0f, 0.0f, 0.0f};
+
+            /// @brief 旋转，单位四元数(x, y, z, w)
+            float m_rotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+
+            /// @brief 缩放
+            float m_scale[3] = {1.0f, 1.0f, 1.0f};
+        };
+
+        /// @brief 一个矩阵的大小，列主序的mat4
+        static constexpr vk::DeviceSize MATRIX_SIZE = sizeof(float) * 16;
+
+        /// @brief 每个并行块的物体数
+        static constexpr size_t PARALLEL_GRAIN = 4096;
+
+    protected:
+        std::vector<float> m_position_x;
+        std::vector<float> m_position_y;
+        std::vector<float> m_position_z;
+        std::vector<float> m_rotation_x;
+        std::vector<float> m_rotation_y;
+        std::vector<float> m_rotation_z;
+        std::vector<float> m_rotation_w;
+        std::vector<float> m_scale_x;
+        std::vector<float> m_scale_y;
+        std::vector<float> m_scale_z;
+
+    public:
+        TransformStore() = default;
+        explicit TransformStore(const SelfType &from) = default;
+        ~TransformStore() override = default;
+
+    public:
+        SelfType &operator=(const SelfType &from) = default;
+
+    public:
+        /// @brief 获取物体数量
+        /// @return 数量
+        size_t size() const noexcept;
+
+        /// @brief 改变物体数量，新物体为单位变换
+        /// @param count 数量
+        void resize(size_t count);
+
+        /// @brief 清空
+        void clear() noexcept;
+
+        /// @brief 添加一个物体
+        /// @param transform 变换
+        /// @return 物体的索引
+        size_t add(const Transform &transform);
+
+        /// @brief 设置物体的变换
+        /// @param index 索引
+        /// @param transform 变换
+        void set(size_t index, const Transform &transform);
+
+        /// @brief 获取物体的变换
+        /// @param index 索引
+        /// @return 变换
+        Transform get(size_t index) const;
+
+        /// @brief 设置位置
+        void set_position(size_t index, float x, float y, float z);
+
+        /// @brief 设置旋转，四元数需要已归一化
+        void set_rotation(size_t index, float x, float y, float z, float w);
+
+        /// @brief 设置缩放
+        void set_scale(size_t index, float x, float y, float z);
+
+        /// @brief 计算所有物体的MVP
+        /// @param view_projection 列主序的投影乘观察矩阵
+        /// @param destination 输出，第i个物体写到destination + i * stride
+        /// @param stride 步长，至少为MATRIX_SIZE
+        /// @param pool 线程池，为空时在调用线程计算
+        void compute(
+            const float view_projection[16],
+            void *destination,
+            size_t stride = MATRIX_SIZE,
+            ThreadPool *pool = nullptr) const;
+
+        /// @brief 计算[begin, end)范围内物体的MVP
+        /// @param view_projection 列主序的投影乘观察矩阵
+        /// @param destination 输出，第i个物体写到destination + (i - begin) * stride
+        /// @param stride 步长，至少为MATRIX_SIZE
+        /// @param begin 开始
+        /// @param end 结束
+        void compute_range(
+            const float view_projection[16],
+            void *destination,
+            size_t stride,
+            size_t begin,
+            size_t end) const;
+
+        /// @brief 把所有物体的MVP直接写入持久映射的缓冲并刷新
+        /// @param device 逻辑设备
+        /// @param buffer 缓冲
+        /// @param offset 写入的起始偏移
+        /// @param stride 步长，用作动态uniform缓冲时需要按minUniformBufferOffsetAlignment对齐
+        /// @param view_projection 列主序的投影乘观察矩阵
+        /// @param pool 线程池，为空时在调用线程计算
+        /// @return 结果
+        vk::Result write(
+            const vk::Device &device,
+            MappedBuffer &buffer,
+            vk::DeviceSize offset,
+            vk::DeviceSize stride,
+            const float view_projection[16],
+            ThreadPool *pool = nullptr) const;
+
+    public:
+        /// @brief 获取每个矩阵在缓冲中的步长
+        /// @param limits 物理设备限制
+        /// @param is_dynamic_uniform 是否作为动态uniform缓冲使用，否则为存储缓冲中紧密排列的数组
+        /// @return 步长
+        static vk::DeviceSize get_stride(
+            const vk::PhysicalDeviceLimits &limits,
+            bool is_dynamic_uniform);
+
+        /// @brief 由旋转轴和角度得到四元数
+        /// @param x 旋转轴x
+        /// @param y 旋转轴y
+        /// @param z 旋转轴z
+        /// @param angle 弧度
+        /// @param quaternion 输出(x, y, z, w)
+        static void make_rotation(
+            float x,
+            float y,
+            float z,
+            float angle,
+            float quaternion[4]);
+
+    protected:
+        struct ScalarLanes;
+        struct Sse2Lanes;
+        struct AvxLanes;
+        struct NeonLanes;
+
+        /// @brief 按Lanes的宽度整组计算，返回处理到的位置
+        template <typename Lanes>
+        size_t compute_lanes(
+            const float view_projection[16],
+            uint8_t *destination,
+            size_t stride,
+            size_t begin,
+            size_t end) const;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
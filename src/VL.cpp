@@ -11,6 +11,41 @@
 #include "PhysicalDeviceUtils.cpp"
 #include "QueueUtils.cpp"
 #include "DeviceUtils.cpp"
+#include "MappedBuffer.cpp"
+#include "ReadbackQueue.cpp"
+#include "ThreadPool.cpp"
+#include "Deflate.cpp"
+#include "ImageEncoder.cpp"
+#include "EncodeQueue.cpp"
+#include "TransformStore.cpp"
+#include "HeadlessContext.cpp"
+#include "FrustumUtils.cpp"
+#include "GpuCuller.cpp"
+#include "CpuCuller.cpp"
+#include "RenderQueue.cpp"
+#include "CommandList.cpp"
+#include "DrawBatcher.cpp"
+#include "MeshUtils.cpp"
+#include "MeshletUtils.cpp"
+#include "LodUtils.cpp"
+#include "ClusterCuller.cpp"
+#include "VertexLayout.cpp"
+#include "StagingRing.cpp"
+#include "MappedFile.cpp"
+#include "MeshFile.cpp"
+#include "TextureFile.cpp"
+#include "TextureLoader.cpp"
+#include "MipGenerator.cpp"
+#include "TextureCompressor.cpp"
+#include "Ktx2File.cpp"
+#include "TextureStreamer.cpp"
+#include "VirtualTexture.cpp"
+#include "SamplerCache.cpp"
+#include "ImageViewCache.cpp"
+#include "SpirvReflection.cpp"
+#include "PipelineLayoutCache.cpp"
+#include "ShaderArchive.cpp"
+#include "ShaderLibrary.cpp"
 #include "VulkanApplication.cpp"
 
 #endif
\ No newline at end of file
@@ -13,6 +13,41 @@
 #include "PhysicalDeviceUtils.hpp"
 #include "QueueUtils.hpp"
 #include "DeviceUtils.hpp"
+#include "MappedBuffer.hpp"
+#include "ReadbackQueue.hpp"
+#include "ThreadPool.hpp"
+#include "Deflate.hpp"
+#include "ImageEncoder.hpp"
+#include "EncodeQueue.hpp"
+#include "TransformStore.hpp"
+#include "HeadlessContext.hpp"
+#include "FrustumUtils.hpp"
+#include "GpuCuller.hpp"
+#include "CpuCuller.hpp"
+#include "RenderQueue.hpp"
+#include "CommandList.hpp"
+#include "DrawBatcher.hpp"
+#include "MeshUtils.hpp"
+#include "MeshletUtils.hpp"
+#include "LodUtils.hpp"
+#include "ClusterCuller.hpp"
+#include "VertexLayout.hpp"
+#include "StagingRing.hpp"
+#include "MappedFile.hpp"
+#include "MeshFile.hpp"
+#include "TextureFile.hpp"
+#include "TextureLoader.hpp"
+#include "MipGenerator.hpp"
+#include "TextureCompressor.hpp"
+#include "Ktx2File.hpp"
+#include "TextureStreamer.hpp"
+#include "VirtualTexture.hpp"
+#include "SamplerCache.hpp"
+#include "ImageViewCache.hpp"
+#include "SpirvReflection.hpp"
+#include "PipelineLayoutCache.hpp"
+#include "ShaderArchive.hpp"
+#include "ShaderLibrary.hpp"
 #include "VulkanUtils.hpp"
 #include "VulkanApplication.hpp"
 
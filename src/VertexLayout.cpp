@@ -0,0 +1,326 @@
+#ifndef __VL_VERTEXLAYOUT_CPP__
+#define __VL_VERTEXLAYOUT_CPP__
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "VertexLayout.hpp"
+
+namespace vl
+{
+    VertexLayout::SelfType &
+    VertexLayout::add(
+        Attribute attribute,
+        Encoding encoding,
+        uint32_t location,
+        uint32_t binding)
+    {
+        if (binding >= MAX_BINDING_COUNT)
+        {
+            ntl::log.loge(
+                NTL_STRING("VertexLayout::add"),
+                NTL_STRING("Binding is out of range"));
+            return *this;
+        }
+
+        Element element;
+        element.m_attribute = attribute;
+        element.m_encoding = encoding;
+        element.m_location = location;
+        element.m_binding = binding;
+        element.m_offset = m_strides[binding];
+
+        bool is_quantized = encoding == ENCODING_QUANTIZED;
+        switch (attribute)
+        {
+        case ATTRIBUTE_POSITION:
+            element.m_format = is_quantized ? vk::Format::eR16G16B16A16Unorm : vk::Format::eR32G32B32Sfloat;
+            element.m_size = is_quantized ? 8 : 12;
+            break;
+        case ATTRIBUTE_NORMAL:
+            element.m_format = is_quantized ? vk::Format::eR16G16Snorm : vk::Format::eR32G32B32Sfloat;
+            element.m_size = is_quantized ? 4 : 12;
+            break;
+        default:
+            element.m_format = is_quantized ? vk::Format::eR16G16Unorm : vk::Format::eR32G32Sfloat;
+            element.m_size = is_quantized ? 4 : 8;
+            break;
+        }
+
+        // 各格式的大小都是4的倍数，偏移自然对齐
+        m_strides[binding] += element.m_size;
+        m_elements.push_back(element);
+        return *this;
+    }
+
+    void
+    VertexLayout::clear() noexcept
+    {
+        m_elements.clear();
+        std::fill(std::begin(m_strides), std::end(m_strides), 0u);
+    }
+
+    const std::vector<VertexLayout::Element> &
+    VertexLayout::get_elements() const noexcept
+    {
+        return m_elements;
+    }
+
+    uint32_t
+    VertexLayout::get_stride(uint32_t binding) const noexcept
+    {
+        return binding < MAX_BINDING_COUNT ? m_strides[binding] : 0;
+    }
+
+    std::vector<vk::VertexInputBindingDescription>
+    VertexLayout::get_binding_descriptions(
+        vk::VertexInputRate input_rate) const
+    {
+        std::vector<vk::VertexInputBindingDescription> descriptions;
+        for (uint32_t binding = 0; binding < MAX_BINDING_COUNT; binding++)
+            if (m_strides[binding] > 0)
+                descriptions.emplace_back(binding, m_strides[binding], input_rate);
+        return descriptions;
+    }
+
+    std::vector<vk::VertexInputAttributeDescription>
+    VertexLayout::get_attribute_descriptions() const
+    {
+        std::vector<vk::VertexInputAttributeDescription> descriptions;
+        descriptions.reserve(m_elements.size());
+        for (const Element &element : m_elements)
+            descriptions.emplace_back(element.m_location, element.m_binding, element.m_format, element.m_offset);
+        return descriptions;
+    }
+
+    void
+    VertexLayout::pack(
+        const Source &source,
+        const Quantization &quantization,
+        uint32_t binding,
+        void *destination) const noexcept
+    {
+        const uint32_t stride = get_stride(binding);
+        uint8_t *output = static_cast<uint8_t *>(destination);
+
+        // 量化为最近的整数，解码误差不超过半个量化步长
+        auto quantize = [](float value, float offset, float scale) -> uint16_t
+        {
+            float normalized = scale > 0.0f ? (value - offset) / scale : 0.0f;
+            return static_cast<uint16_t>(std::min(std::max(normalized, 0.0f), 1.0f) * 65535.0f + 0.5f);
+        };
+
+        for (const Element &element : m_elements)
+        {
+            if (element.m_binding != binding)
+                continue;
+
+            for (size_t v = 0; v < source.m_vertex_count; v++)
+            {
+                uint8_t *target = output + v * stride + element.m_offset;
+                switch (element.m_attribute)
+                {
+                case ATTRIBUTE_POSITION:
+                {
+                    const float *position = source.m_positions + v * 3;
+                    if (element.m_encoding == ENCODING_FLOAT)
+                    {
+                        std::memcpy(target, position, sizeof(float) * 3);
+                        break;
+                    }
+                    uint16_t packed[4] = {0, 0, 0, 0};
+                    for (size_t k = 0; k < 3; k++)
+                        packed[k] = quantize(position[k], quantization.m_position_offset[k], quantization.m_position_scale[k]);
+                    std::memcpy(target, packed, sizeof(packed));
+                    break;
+                }
+                case ATTRIBUTE_NORMAL:
+                {
+                    const float *normal = source.m_normals + v * 3;
+                    if (element.m_encoding == ENCODING_FLOAT)
+                    {
+                        std::memcpy(target, normal, sizeof(float) * 3);
+                        break;
+                    }
+                    int16_t packed[2];
+                    encode_octahedral(normal, packed);
+                    std::memcpy(target, packed, sizeof(packed));
+                    break;
+                }
+                default:
+                {
+                    const float *uv = source.m_uvs + v * 2;
+                    if (element.m_encoding == ENCODING_FLOAT)
+                    {
+                        std::memcpy(target, uv, sizeof(float) * 2);
+                        break;
+                    }
+                    uint16_t packed[2];
+                    for (size_t k = 0; k < 2; k++)
+                        packed[k] = quantize(uv[k], quantization.m_uv_offset[k], quantization.m_uv_scale[k]);
+                    std::memcpy(target, packed, sizeof(packed));
+                    break;
+                }
+                }
+            }
+        }
+    }
+
+    void
+    VertexLayout::unpack(
+        const void *data,
+        size_t vertex_count,
+        const Quantization &quantization,
+        uint32_t binding,
+        float *positions,
+        float *normals,
+        float *uvs) const noexcept
+    {
+        const uint32_t stride = get_stride(binding);
+        const uint8_t *input = static_cast<const uint8_t *>(data);
+
+        for (const Element &element : m_elements)
+        {
+            if (element.m_binding != binding)
+                continue;
+
+            for (size_t v = 0; v < vertex_count; v++)
+            {
+                const uint8_t *source = input + v * stride + element.m_offset;
+                if (element.m_attribute == ATTRIBUTE_POSITION && positions)
+                {
+                    float *position = positions + v * 3;
+                    if (element.m_encoding == ENCODING_FLOAT)
+                    {
+                        std::memcpy(position, source, sizeof(float) * 3);
+                        continue;
+                    }
+                    uint16_t packed[4];
+                    std::memcpy(packed, source, sizeof(packed));
+                    for (size_t k = 0; k < 3; k++)
+                        position[k] = quantization.m_position_offset[k] + packed[k] / 65535.0f * quantization.m_position_scale[k];
+                }
+                else if (element.m_attribute == ATTRIBUTE_NORMAL && normals)
+                {
+                    float *normal = normals + v * 3;
+                    if (element.m_encoding == ENCODING_FLOAT)
+                    {
+                        std::memcpy(normal, source, sizeof(float) * 3);
+                        continue;
+                    }
+                    int16_t packed[2];
+                    std::memcpy(packed, source, sizeof(packed));
+                    decode_octahedral(packed, normal);
+                }
+                else if (element.m_attribute == ATTRIBUTE_UV && uvs)
+                {
+                    float *uv = uvs + v * 2;
+                    if (element.m_encoding == ENCODING_FLOAT)
+                    {
+                        std::memcpy(uv, source, sizeof(float) * 2);
+                        continue;
+                    }
+                    uint16_t packed[2];
+                    std::memcpy(packed, source, sizeof(packed));
+                    for (size_t k = 0; k < 2; k++)
+                        uv[k] = quantization.m_uv_offset[k] + packed[k] / 65535.0f * quantization.m_uv_scale[k];
+                }
+            }
+        }
+    }
+
+    VertexLayout::Quantization
+    VertexLayout::compute_quantization(const Source &source) noexcept
+    {
+        Quantization quantization;
+        if (source.m_vertex_count == 0)
+            return quantization;
+
+        if (source.m_positions)
+        {
+            float minimum[3], maximum[3];
+            std::copy(source.m_positions, source.m_positions + 3, minimum);
+            std::copy(source.m_positions, source.m_positions + 3, maximum);
+            for (size_t v = 1; v < source.m_vertex_count; v++)
+                for (size_t k = 0; k < 3; k++)
+                {
+                    minimum[k] = std::min(minimum[k], source.m_positions[v * 3 + k]);
+                    maximum[k] = std::max(maximum[k], source.m_positions[v * 3 + k]);
+                }
+            for (size_t k = 0; k < 3; k++)
+            {
+                quantization.m_position_offset[k] = minimum[k];
+                quantization.m_position_scale[k] = maximum[k] - minimum[k];
+            }
+        }
+
+        if (source.m_uvs)
+        {
+            float minimum[2], maximum[2];
+            std::copy(source.m_uvs, source.m_uvs + 2, minimum);
+            std::copy(source.m_uvs, source.m_uvs + 2, maximum);
+            for (size_t v = 1; v < source.m_vertex_count; v++)
+                for (size_t k = 0; k < 2; k++)
+                {
+                    minimum[k] = std::min(minimum[k], source.m_uvs[v * 2 + k]);
+                    maximum[k] = std::max(maximum[k], source.m_uvs[v * 2 + k]);
+                }
+            for (size_t k = 0; k < 2; k++)
+            {
+                quantization.m_uv_offset[k] = minimum[k];
+                quantization.m_uv_scale[k] = maximum[k] - minimum[k];
+            }
+        }
+
+        return quantization;
+    }
+
+    void
+    VertexLayout::encode_octahedral(
+        const float *normal,
+        int16_t *encoded) noexcept
+    {
+        // 投影到八面体|x| + |y| + |z| = 1，下半球沿对角线折到外侧
+        float length = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+        float x = length > 0.0f ? normal[0] / length : 0.0f;
+        float y = length > 0.0f ? normal[1] / length : 0.0f;
+        if (normal[2] < 0.0f)
+        {
+            float folded_x = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float folded_y = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = folded_x;
+            y = folded_y;
+        }
+
+        // 四舍五入到最近的整数
+        x = std::min(std::max(x, -1.0f), 1.0f) * 32767.0f;
+        y = std::min(std::max(y, -1.0f), 1.0f) * 32767.0f;
+        encoded[0] = static_cast<int16_t>(x + (x >= 0.0f ? 0.5f : -0.5f));
+        encoded[1] = static_cast<int16_t>(y + (y >= 0.0f ? 0.5f : -0.5f));
+    }
+
+    void
+    VertexLayout::decode_octahedral(
+        const int16_t *encoded,
+        float *normal) noexcept
+    {
+        // 与着色器中的解码相同，SNORM读出的值为max(value / 32767, -1)
+        float x = std::max(encoded[0] / 32767.0f, -1.0f);
+        float y = std::max(encoded[1] / 32767.0f, -1.0f);
+        float z = 1.0f - std::abs(x) - std::abs(y);
+        if (z < 0.0f)
+        {
+            float folded_x = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float folded_y = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = folded_x;
+            y = folded_y;
+        }
+
+        float length = std::sqrt(x * x + y * y + z * z);
+        normal[0] = x / length;
+        normal[1] = y / length;
+        normal[2] = z / length;
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
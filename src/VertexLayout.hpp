@@ -0,0 +1,168 @@
+#ifndef __VL_VERTEXLAYOUT_HPP__
+#define __VL_VERTEXLAYOUT_HPP__
+
+#include <cstdint>
+#include <vector>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+
+namespace vl
+{
+    /// @brief 顶点布局：把分开的float属性打包为交错的顶点流，可选量化，并生成对应的顶点输入描述
+    /// @details 量化格式都属于Vulkan要求必须支持的顶点缓冲格式：
+    /// 位置为R16G16B16A16_UNORM，着色器中解码为offset + value * scale；
+    /// 法线为八面体编码的R16G16_SNORM；纹理坐标为R16G16_UNORM，解码方式与位置相同
+    class VertexLayout : public ntl::Object
+    {
+    public:
+        using SelfType = VertexLayout;
+        using ParentType = ntl::Object;
+
+        /// @brief 属性
+        enum Attribute : uint32_t
+        {
+            /// @brief 位置，3个float
+            ATTRIBUTE_POSITION,
+            /// @brief 法线，3个float，单位长度
+            ATTRIBUTE_NORMAL,
+            /// @brief 纹理坐标，2个float
+            ATTRIBUTE_UV,
+            ATTRIBUTE_COUNT,
+        };
+
+        /// @brief 编码
+        enum Encoding : uint32_t
+        {
+            /// @brief 32位浮点，不损失精度
+            ENCODING_FLOAT,
+            /// @brief 16位量化
+            ENCODING_QUANTIZED,
+        };
+
+        /// @brief 顶点流中的一个属性
+        struct Element
+        {
+            Attribute m_attribute = ATTRIBUTE_POSITION;
+            Encoding m_encoding = ENCODING_FLOAT;
+            uint32_t m_location = 0;
+            uint32_t m_binding = 0;
+            uint32_t m_offset = 0;
+            uint32_t m_size = 0;
+            vk::Format m_format = vk::Format::eUndefined;
+        };
+
+        /// @brief 分开存放的源数据，与cube.cpp的顶点数组一样紧密排列
+        struct Source
+        {
+            const float *m_positions = nullptr;
+            const float *m_normals = nullptr;
+            const float *m_uvs = nullptr;
+            size_t m_vertex_count = 0;
+        };
+
+        /// @brief 每个网格的量化参数，解码为offset + value * scale，需要传给着色器
+        struct Quantization
+        {
+            float m_position_offset[3] = {0.0f, 0.0f, 0.0f};
+            float m_position_scale[3] = {1.0f, 1.0f, 1.0f};
+            float m_uv_offset[2] = {0.0f, 0.0f};
+            float m_uv_scale[2] = {1.0f, 1.0f};
+        };
+
+        /// @brief 最多的顶点缓冲绑定数
+        static constexpr uint32_t MAX_BINDING_COUNT = 16;
+
+    protected:
+        std::vector<Element> m_elements;
+        uint32_t m_strides[MAX_BINDING_COUNT] = {};
+
+    public:
+        VertexLayout() = default;
+        explicit VertexLayout(const SelfType &from) = default;
+        ~VertexLayout() override = default;
+
+    public:
+        SelfType &operator=(const SelfType &from) = default;
+
+    public:
+        /// @brief 追加一个属性，放在绑定的顶点流末尾
+        /// @param attribute 属性
+        /// @param encoding 编码
+        /// @param location 着色器中的location
+        /// @param binding 顶点缓冲绑定，同一绑定的属性交错存放
+        /// @return 自身
+        SelfType &add(
+            Attribute attribute,
+            Encoding encoding,
+            uint32_t location,
+            uint32_t binding = 0);
+
+        /// @brief 清空
+        void clear() noexcept;
+
+        /// @brief 获取全部属性
+        /// @return 属性
+        const std::vector<Element> &get_elements() const noexcept;
+
+        /// @brief 获取一个绑定中每个顶点的字节数
+        /// @param binding 绑定
+        /// @return 字节数，没有属性时为0
+        uint32_t get_stride(uint32_t binding) const noexcept;
+
+        /// @brief 生成用到的绑定的描述
+        /// @param input_rate 输入频率
+        /// @return 绑定描述
+        std::vector<vk::VertexInputBindingDescription> get_binding_descriptions(
+            vk::VertexInputRate input_rate = vk::VertexInputRate::eVertex) const;
+
+        /// @brief 生成属性描述
+        /// @return 属性描述
+        std::vector<vk::VertexInputAttributeDescription> get_attribute_descriptions() const;
+
+        /// @brief 打包一个绑定的顶点流
+        /// @param source 源数据，布局中用到的属性不能为空
+        /// @param quantization 量化参数
+        /// @param binding 绑定
+        /// @param destination 输出，大小为顶点数乘以get_stride(binding)，一般为映射的暂存缓冲
+        void pack(
+            const Source &source,
+            const Quantization &quantization,
+            uint32_t binding,
+            void *destination) const noexcept;
+
+        /// @brief 按着色器的方式解码一个绑定的顶点流，用于检查误差
+        /// @param data 顶点流
+        /// @param vertex_count 顶点数
+        /// @param quantization 量化参数
+        /// @param binding 绑定
+        /// @param positions 输出位置，可以为空
+        /// @param normals 输出法线，可以为空
+        /// @param uvs 输出纹理坐标，可以为空
+        void unpack(
+            const void *data,
+            size_t vertex_count,
+            const Quantization &quantization,
+            uint32_t binding,
+            float *positions,
+            float *normals,
+            float *uvs) const noexcept;
+
+    public:
+        /// @brief 按源数据的包围盒计算量化参数
+        /// @param source 源数据
+        /// @return 量化参数
+        static Quantization compute_quantization(const Source &source) noexcept;
+
+        /// @brief 八面体编码单位法线
+        /// @param normal 法线
+        /// @param encoded 输出的两个snorm16
+        static void encode_octahedral(const float *normal, int16_t *encoded) noexcept;
+
+        /// @brief 八面体解码
+        /// @param encoded 两个snorm16
+        /// @param normal 输出的单位法线
+        static void decode_octahedral(const int16_t *encoded, float *normal) noexcept;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
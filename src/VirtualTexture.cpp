@@ -0,0 +1,910 @@
+#ifndef __VL_VIRTUALTEXTURE_CPP__
+#define __VL_VIRTUALTEXTURE_CPP__
+
+#include <algorithm>
+#include "VirtualTexture.hpp"
+#include "DeviceUtils.hpp"
+
+namespace vl
+{
+    bool
+    VirtualTexture::create(
+        const Config &config)
+    {
+        return build(config, std::nullopt);
+    }
+
+    vk::Result
+    VirtualTexture::create(
+        const vk::Device &device,
+        const vk::PhysicalDevice &physical_device,
+        const Config &config,
+        StagingRing &ring)
+    {
+        std::optional<vk::Extent3D> page_extent = query_page_extent(physical_device, config.m_format);
+        if (!page_extent.has_value())
+        {
+            ntl::log.loge(
+                NTL_STRING("VirtualTexture::create"),
+                NTL_STRING("Sparse residency is not supported for the format"));
+            return vk::Result::eErrorFormatNotSupported;
+        }
+
+        uint32_t level_count = 1;
+        while ((std::max(config.m_width, config.m_height) >> level_count) > 0)
+            level_count++;
+
+        vk::ImageCreateInfo image_info;
+        image_info.setFlags(vk::ImageCreateFlagBits::eSparseBinding | vk::ImageCreateFlagBits::eSparseResidency);
+        image_info.setImageType(vk::ImageType::e2D);
+        image_info.setFormat(config.m_format);
+        image_info.setExtent(vk::Extent3D(config.m_width, config.m_height, 1));
+        image_info.setMipLevels(level_count);
+        image_info.setArrayLayers(1);
+        image_info.setSamples(vk::SampleCountFlagBits::e1);
+        image_info.setTiling(vk::ImageTiling::eOptimal);
+        image_info.setUsage(vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled);
+        image_info.setSharingMode(vk::SharingMode::eExclusive);
+        image_info.setInitialLayout(vk::ImageLayout::eUndefined);
+        auto image_result = device.createImage(image_info);
+        if (image_result.result != vk::Result::eSuccess)
+            return image_result.result;
+        m_image = image_result.value;
+
+        // 稀疏图像的对齐就是页的字节数
+        vk::MemoryRequirements requirements = device.getImageMemoryRequirements(m_image);
+        std::optional<vk::SparseImageMemoryRequirements> sparse;
+        for (const vk::SparseImageMemoryRequirements &item : device.getImageSparseMemoryRequirements(m_image))
+            if (item.formatProperties.aspectMask & vk::ImageAspectFlagBits::eColor)
+                sparse = item;
+        Config actual = config;
+        actual.m_page_width = page_extent->width;
+        actual.m_page_height = page_extent->height;
+        if (!sparse.has_value() || !build(actual, std::min(sparse->imageMipTailFirstLod, level_count)))
+        {
+            ntl::log.loge(
+                NTL_STRING("VirtualTexture::create"),
+                NTL_STRING("Unable to build the page table"));
+            destroy(device);
+            return vk::Result::eErrorInitializationFailed;
+        }
+        m_page_size = requirements.alignment;
+        m_tail_offset = sparse->imageMipTailOffset;
+        m_tail_size = m_tail_level < m_level_count ? sparse->imageMipTailSize : 0;
+
+        std::optional<uint32_t> type = DeviceUtils::find_memory_type(physical_device, requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        if (!type.has_value())
+            type = DeviceUtils::find_memory_type(physical_device, requirements.memoryTypeBits, vk::MemoryPropertyFlags());
+        if (!type.has_value())
+        {
+            destroy(device);
+            return vk::Result::eErrorOutOfDeviceMemory;
+        }
+        vk::MemoryAllocateInfo allocate_info;
+        allocate_info.setAllocationSize(m_page_size * m_config.m_physical_page_count);
+        allocate_info.setMemoryTypeIndex(*type);
+        auto memory_result = device.allocateMemory(allocate_info);
+        if (memory_result.result != vk::Result::eSuccess)
+        {
+            destroy(device);
+            return memory_result.result;
+        }
+        m_memory = memory_result.value;
+        if (m_tail_size > 0)
+        {
+            allocate_info.setAllocationSize(m_tail_size);
+            memory_result = device.allocateMemory(allocate_info);
+            if (memory_result.result != vk::Result::eSuccess)
+            {
+                destroy(device);
+                return memory_result.result;
+            }
+            m_tail_memory = memory_result.value;
+        }
+
+        vk::ImageViewCreateInfo view_info;
+        view_info.setImage(m_image);
+        view_info.setViewType(vk::ImageViewType::e2D);
+        view_info.setFormat(config.m_format);
+        view_info.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, m_level_count, 0, 1));
+        auto view_result = device.createImageView(view_info);
+        if (view_result.result != vk::Result::eSuccess)
+        {
+            destroy(device);
+            return view_result.result;
+        }
+        m_view = view_result.value;
+
+        vk::Result result = m_feedback.create(
+            device,
+            physical_device,
+            static_cast<vk::DeviceSize>(config.m_feedback_count) * sizeof(uint32_t),
+            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+            vk::MemoryPropertyFlagBits::eHostCached);
+        if (result != vk::Result::eSuccess)
+        {
+            destroy(device);
+            return result;
+        }
+
+        m_ring = &ring;
+        return vk::Result::eSuccess;
+    }
+
+    void
+    VirtualTexture::destroy(
+        const vk::Device &device)
+    {
+        if (device)
+        {
+            if (m_view)
+                device.destroyImageView(m_view);
+            if (m_image)
+                device.destroyImage(m_image);
+            if (m_memory)
+                device.freeMemory(m_memory);
+            if (m_tail_memory)
+                device.freeMemory(m_tail_memory);
+            m_feedback.destroy(device);
+        }
+        m_view = nullptr;
+        m_image = nullptr;
+        m_memory = nullptr;
+        m_tail_memory = nullptr;
+        m_ring = nullptr;
+        m_levels.clear();
+        m_entries.clear();
+        m_free_pages.clear();
+        m_requested.clear();
+        m_unsubmitted.clear();
+        m_in_flight.clear();
+        m_unsubmitted_releases.clear();
+        m_releases.clear();
+        m_unbinds.clear();
+        m_min_levels.clear();
+        m_unsubmitted_mark.reset();
+        m_marks.clear();
+    }
+
+    void
+    VirtualTexture::request(
+        uint32_t level,
+        uint32_t x,
+        uint32_t y,
+        uint64_t frame) noexcept
+    {
+        if (frame != m_request_frame)
+        {
+            m_requested.clear();
+            m_request_frame = frame;
+        }
+        m_statistics.m_requests++;
+
+        // 本帧已使用的页的父页也已使用
+        uint32_t index = get_entry(level, x, y);
+        while (index != NO_PAGE)
+        {
+            Entry &entry = m_entries[index];
+            if (entry.m_last_used == frame)
+                break;
+            entry.m_last_used = frame;
+            m_requested.push_back(index);
+            index = get_parent(entry);
+        }
+    }
+
+    void
+    VirtualTexture::submit_feedback(
+        const uint32_t *pages,
+        uint32_t count,
+        uint64_t frame) noexcept
+    {
+        for (uint32_t i = 0; i < count; i++)
+            if (pages[i] != NO_PAGE)
+            {
+                Page page = unpack_page(pages[i]);
+                request(page.m_level, page.m_x, page.m_y, frame);
+            }
+    }
+
+    vk::Result
+    VirtualTexture::read_feedback(
+        const vk::Device &device,
+        uint64_t frame)
+    {
+        vk::Result result = m_feedback.invalidate(device);
+        if (result != vk::Result::eSuccess)
+            return result;
+        submit_feedback(m_feedback.data<uint32_t>(), m_config.m_feedback_count, frame);
+        return vk::Result::eSuccess;
+    }
+
+    void
+    VirtualTexture::record_feedback_clear(
+        const vk::CommandBuffer &command_buffer) const
+    {
+        command_buffer.fillBuffer(m_feedback.m_buffer, 0, VK_WHOLE_SIZE, NO_PAGE);
+        vk::BufferMemoryBarrier barrier;
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eShaderWrite);
+        barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setBuffer(m_feedback.m_buffer);
+        barrier.setOffset(0);
+        barrier.setSize(VK_WHOLE_SIZE);
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eFragmentShader,
+            vk::DependencyFlags(),
+            nullptr,
+            barrier,
+            nullptr);
+    }
+
+    std::vector<VirtualTexture::Page>
+    VirtualTexture::update(
+        uint64_t frame)
+    {
+        if (m_request_frame != frame)
+            m_requested.clear();
+
+        // 先淘汰最久未使用的叶子页，保证以后的加载有空闲的物理页
+        size_t available = m_free_pages.size() + m_unsubmitted_releases.size() + m_releases.size();
+        if (available < m_config.m_max_loads)
+        {
+            std::vector<uint32_t> candidates;
+            for (uint32_t i = 0; i < m_entries.size(); i++)
+            {
+                const Entry &entry = m_entries[i];
+                if (entry.m_state == State::eResident && entry.m_child_count == 0 && entry.m_last_used != frame)
+                    candidates.push_back(i);
+            }
+            std::sort(
+                candidates.begin(), candidates.end(),
+                [this](uint32_t left, uint32_t right)
+                {
+                    const Entry &left_entry = m_entries[left];
+                    const Entry &right_entry = m_entries[right];
+                    if (left_entry.m_last_used != right_entry.m_last_used)
+                        return left_entry.m_last_used < right_entry.m_last_used;
+                    if (left_entry.m_level != right_entry.m_level)
+                        return left_entry.m_level < right_entry.m_level;
+                    return left < right;
+                });
+            for (uint32_t index : candidates)
+            {
+                if (available >= m_config.m_max_loads)
+                    break;
+                evict(index);
+                available++;
+            }
+        }
+
+        // 请求的父页也在请求中，从粗到细加载即可保证父页先于子页
+        std::vector<uint32_t> candidates;
+        for (uint32_t index : m_requested)
+            if (m_entries[index].m_state == State::eEmpty)
+                candidates.push_back(index);
+        std::sort(
+            candidates.begin(), candidates.end(),
+            [this](uint32_t left, uint32_t right)
+            {
+                if (m_entries[left].m_level != m_entries[right].m_level)
+                    return m_entries[left].m_level > m_entries[right].m_level;
+                return left < right;
+            });
+
+        std::vector<Page> loads;
+        for (uint32_t index : candidates)
+        {
+            const Entry &entry = m_entries[index];
+            uint32_t parent = get_parent(entry);
+            if (loads.size() >= m_config.m_max_loads ||
+                (parent != NO_PAGE && m_entries[parent].m_state == State::eEmpty) ||
+                !load(index))
+            {
+                m_statistics.m_deferred++;
+                continue;
+            }
+            loads.push_back({entry.m_level, entry.m_x, entry.m_y});
+        }
+
+        m_statistics.m_peak_resident_pages = std::max(m_statistics.m_peak_resident_pages, m_statistics.m_resident_pages);
+        return loads;
+    }
+
+    vk::Result
+    VirtualTexture::record(
+        const vk::Device &device,
+        const vk::CommandBuffer &command_buffer,
+        const PageSource &source)
+    {
+        vk::DeviceSize alignment = std::max<vk::DeviceSize>(16, m_format_info.m_block_bytes);
+        std::vector<vk::BufferImageCopy> regions;
+
+        vk::ImageMemoryBarrier barrier;
+        barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+        barrier.setImage(m_image);
+        barrier.setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, m_level_count, 0, 1));
+
+        // 第一次使用时整个图像切换到General，并上传尾部的各级
+        bool is_initializing = !m_is_initialized;
+        if (is_initializing)
+        {
+            for (uint32_t level = m_tail_level; level < m_level_count; level++)
+            {
+                uint32_t width = std::max(m_config.m_width >> level, 1u), height = std::max(m_config.m_height >> level, 1u);
+                vk::DeviceSize size = Ktx2File::get_level_size(m_format_info, width, height, 0);
+                std::optional<StagingRing::Allocation> allocation = m_ring->allocate(size, alignment);
+                if (!allocation.has_value() || !source(level, 0, 0, width, height, static_cast<uint8_t *>(allocation->m_pointer)))
+                {
+                    ntl::log.loge(
+                        NTL_STRING("VirtualTexture::record"),
+                        NTL_STRING("Unable to stage the mip tail"));
+                    cancel_unsubmitted();
+                    return vk::Result::eErrorOutOfDeviceMemory;
+                }
+                vk::BufferImageCopy region;
+                region.setBufferOffset(allocation->m_offset);
+                region.setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level, 0, 1));
+                region.setImageExtent(vk::Extent3D(width, height, 1));
+                regions.push_back(region);
+                m_statistics.m_uploaded_bytes += size;
+            }
+
+            barrier.setSrcAccessMask(vk::AccessFlags());
+            barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+            barrier.setOldLayout(vk::ImageLayout::eUndefined);
+            barrier.setNewLayout(vk::ImageLayout::eGeneral);
+            command_buffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTopOfPipe,
+                vk::PipelineStageFlagBits::eTransfer,
+                vk::DependencyFlags(),
+                nullptr,
+                nullptr,
+                barrier);
+            m_is_initialized = true;
+        }
+
+        // 按计划的顺序暂存，父页被取消时子页也取消
+        std::vector<uint32_t> loads = m_unsubmitted;
+        for (uint32_t index : loads)
+        {
+            Entry &entry = m_entries[index];
+            uint32_t parent = get_parent(entry);
+            if (parent != NO_PAGE && m_entries[parent].m_state == State::eEmpty)
+            {
+                cancel(index);
+                continue;
+            }
+
+            vk::Rect2D rect = get_region(entry);
+            vk::DeviceSize size = Ktx2File::get_level_size(m_format_info, rect.extent.width, rect.extent.height, 0);
+            std::optional<StagingRing::Allocation> allocation = m_ring->allocate(size, alignment);
+            if (!allocation.has_value() ||
+                !source(entry.m_level, rect.offset.x, rect.offset.y, rect.extent.width, rect.extent.height, static_cast<uint8_t *>(allocation->m_pointer)))
+            {
+                cancel(index);
+                continue;
+            }
+            vk::BufferImageCopy region;
+            region.setBufferOffset(allocation->m_offset);
+            region.setImageSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, entry.m_level, 0, 1));
+            region.setImageOffset(vk::Offset3D(rect.offset.x, rect.offset.y, 0));
+            region.setImageExtent(vk::Extent3D(rect.extent.width, rect.extent.height, 1));
+            regions.push_back(region);
+            m_statistics.m_uploaded_bytes += size;
+        }
+        if (regions.empty())
+            return vk::Result::eSuccess;
+
+        m_unsubmitted_mark = m_ring->submit();
+        vk::Result result = m_ring->flush(device);
+        if (result != vk::Result::eSuccess)
+        {
+            // 复制没有记录，页不能绑定为驻留，尾部下次重新上传
+            cancel_unsubmitted();
+            if (is_initializing)
+                m_is_initialized = false;
+            return result;
+        }
+
+        command_buffer.copyBufferToImage(m_ring->get_buffer(), m_image, vk::ImageLayout::eGeneral, regions);
+
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+        barrier.setOldLayout(vk::ImageLayout::eGeneral);
+        barrier.setNewLayout(vk::ImageLayout::eGeneral);
+        command_buffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eFragmentShader,
+            vk::DependencyFlags(),
+            nullptr,
+            nullptr,
+            barrier);
+
+        return vk::Result::eSuccess;
+    }
+
+    vk::Result
+    VirtualTexture::bind(
+        const vk::Queue &queue,
+        const vk::Semaphore &signal,
+        const vk::Fence &fence)
+    {
+        std::vector<vk::SparseImageMemoryBind> binds;
+        for (uint32_t index : m_unsubmitted)
+        {
+            const Entry &entry = m_entries[index];
+            vk::Rect2D rect = get_region(entry);
+            vk::SparseImageMemoryBind bind;
+            bind.setSubresource(vk::ImageSubresource(vk::ImageAspectFlagBits::eColor, entry.m_level, 0));
+            bind.setOffset(vk::Offset3D(rect.offset.x, rect.offset.y, 0));
+            bind.setExtent(vk::Extent3D(rect.extent.width, rect.extent.height, 1));
+            bind.setMemory(m_memory);
+            bind.setMemoryOffset(entry.m_physical * m_page_size);
+            binds.push_back(bind);
+        }
+        size_t bind_count = binds.size();
+
+        // 物理页已回收而页仍为空时解除绑定，已重新加载的页在上面绑定了新的内存
+        for (uint32_t index : m_unbinds)
+        {
+            const Entry &entry = m_entries[index];
+            if (entry.m_state != State::eEmpty)
+                continue;
+            vk::Rect2D rect = get_region(entry);
+            vk::SparseImageMemoryBind bind;
+            bind.setSubresource(vk::ImageSubresource(vk::ImageAspectFlagBits::eColor, entry.m_level, 0));
+            bind.setOffset(vk::Offset3D(rect.offset.x, rect.offset.y, 0));
+            bind.setExtent(vk::Extent3D(rect.extent.width, rect.extent.height, 1));
+            binds.push_back(bind);
+        }
+
+        std::vector<vk::SparseMemoryBind> opaque_binds;
+        if (!m_is_tail_bound && m_tail_size > 0)
+            opaque_binds.push_back(vk::SparseMemoryBind(m_tail_offset, m_tail_size, m_tail_memory, 0));
+        if (binds.empty() && opaque_binds.empty() && !signal && !fence)
+            return vk::Result::eSuccess;
+
+        vk::SparseImageMemoryBindInfo image_bind(m_image, binds);
+        vk::SparseImageOpaqueMemoryBindInfo opaque_bind(m_image, opaque_binds);
+        vk::BindSparseInfo bind_info;
+        if (!binds.empty())
+            bind_info.setImageBinds(image_bind);
+        if (!opaque_binds.empty())
+            bind_info.setImageOpaqueBinds(opaque_bind);
+        if (signal)
+            bind_info.setSignalSemaphores(signal);
+        vk::Result result = queue.bindSparse(bind_info, fence);
+        if (result != vk::Result::eSuccess)
+            return result;
+
+        m_is_tail_bound = true;
+        m_statistics.m_binds += bind_count;
+        m_statistics.m_unbinds += binds.size() - bind_count;
+        m_statistics.m_bind_calls++;
+        m_unbinds.clear();
+        return vk::Result::eSuccess;
+    }
+
+    void
+    VirtualTexture::submitted(
+        uint64_t value)
+    {
+        for (uint32_t index : m_unsubmitted)
+        {
+            m_entries[index].m_submit_value = value;
+            m_in_flight.push_back(index);
+        }
+        m_unsubmitted.clear();
+
+        // 淘汰前的提交和这一次都可能采样被淘汰的页
+        for (Release &release : m_unsubmitted_releases)
+        {
+            release.m_value = value;
+            m_releases.push_back(release);
+        }
+        m_unsubmitted_releases.clear();
+
+        if (m_unsubmitted_mark.has_value())
+        {
+            m_marks.push_back({*m_unsubmitted_mark, value});
+            m_unsubmitted_mark.reset();
+        }
+        m_last_submitted = std::max(m_last_submitted, value);
+    }
+
+    void
+    VirtualTexture::retire(
+        uint64_t completed)
+    {
+        // 按计划的顺序完成，父页的最小级别先于子页更新
+        auto retired = std::stable_partition(
+            m_in_flight.begin(), m_in_flight.end(),
+            [this, completed](uint32_t index)
+            { return m_entries[index].m_submit_value > completed; });
+        for (auto iter = retired; iter != m_in_flight.end(); iter++)
+        {
+            Entry &entry = m_entries[*iter];
+            entry.m_state = State::eResident;
+            set_min_level(entry, entry.m_level);
+        }
+        m_in_flight.erase(retired, m_in_flight.end());
+
+        while (!m_releases.empty() && m_releases.front().m_value <= completed)
+        {
+            const Release &release = m_releases.front();
+            m_free_pages.push_back(release.m_physical);
+            if (m_image)
+                m_unbinds.push_back(release.m_entry);
+            m_releases.pop_front();
+        }
+
+        std::optional<vk::DeviceSize> mark;
+        while (!m_marks.empty() && m_marks.front().m_value <= completed)
+        {
+            mark = m_marks.front().m_mark;
+            m_marks.pop_front();
+        }
+        if (mark.has_value() && m_ring != nullptr)
+            m_ring->release(*mark);
+    }
+
+    bool
+    VirtualTexture::is_resident(
+        uint32_t level,
+        uint32_t x,
+        uint32_t y) const noexcept
+    {
+        if (level >= m_tail_level)
+            return level < m_level_count;
+        uint32_t index = get_entry(level, x, y);
+        return index != NO_PAGE && m_entries[index].m_state == State::eResident;
+    }
+
+    const std::vector<uint8_t> &
+    VirtualTexture::get_min_level_map() const noexcept
+    {
+        return m_min_levels;
+    }
+
+    bool
+    VirtualTexture::take_map_dirty() noexcept
+    {
+        bool is_dirty = m_is_map_dirty;
+        m_is_map_dirty = false;
+        return is_dirty;
+    }
+
+    vk::Extent2D
+    VirtualTexture::get_page_count(
+        uint32_t level) const noexcept
+    {
+        if (level >= m_tail_level)
+            return vk::Extent2D(1, 1);
+        return vk::Extent2D(m_levels[level].m_columns, m_levels[level].m_rows);
+    }
+
+    uint32_t
+    VirtualTexture::get_page_width() const noexcept
+    {
+        return m_config.m_page_width;
+    }
+
+    uint32_t
+    VirtualTexture::get_page_height() const noexcept
+    {
+        return m_config.m_page_height;
+    }
+
+    uint32_t
+    VirtualTexture::get_level_count() const noexcept
+    {
+        return m_level_count;
+    }
+
+    uint32_t
+    VirtualTexture::get_tail_level() const noexcept
+    {
+        return m_tail_level;
+    }
+
+    uint32_t
+    VirtualTexture::get_free_page_count() const noexcept
+    {
+        return static_cast<uint32_t>(m_free_pages.size());
+    }
+
+    const vk::Image &
+    VirtualTexture::get_image() const noexcept
+    {
+        return m_image;
+    }
+
+    const vk::ImageView &
+    VirtualTexture::get_view() const noexcept
+    {
+        return m_view;
+    }
+
+    const vk::Buffer &
+    VirtualTexture::get_feedback_buffer() const noexcept
+    {
+        return m_feedback.m_buffer;
+    }
+
+    const VirtualTexture::Statistics &
+    VirtualTexture::get_statistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+    ntl::String
+    VirtualTexture::format() const
+    {
+        ntl::StringStream sstr;
+        sstr << std::endl
+             << NTL_STRING("\tsize:") << m_config.m_width << NTL_STRING("x") << m_config.m_height << std::endl
+             << NTL_STRING("\tpage:") << m_config.m_page_width << NTL_STRING("x") << m_config.m_page_height << std::endl
+             << NTL_STRING("\tlevels:") << m_level_count << NTL_STRING(", tail from ") << m_tail_level << std::endl
+             << NTL_STRING("\tphysical pages:") << m_config.m_physical_page_count << std::endl
+             << NTL_STRING("\trequests:") << m_statistics.m_requests << std::endl
+             << NTL_STRING("\tloads:") << m_statistics.m_loads << std::endl
+             << NTL_STRING("\tevictions:") << m_statistics.m_evictions << std::endl
+             << NTL_STRING("\tdeferred:") << m_statistics.m_deferred << std::endl
+             << NTL_STRING("\tbinds:") << m_statistics.m_binds << std::endl
+             << NTL_STRING("\tunbinds:") << m_statistics.m_unbinds << std::endl
+             << NTL_STRING("\tbind calls:") << m_statistics.m_bind_calls << std::endl
+             << NTL_STRING("\tuploaded bytes:") << m_statistics.m_uploaded_bytes << std::endl
+             << NTL_STRING("\tresident pages:") << m_statistics.m_resident_pages << std::endl
+             << NTL_STRING("\tpeak resident pages:") << m_statistics.m_peak_resident_pages << std::endl;
+        return sstr.str();
+    }
+
+    uint32_t
+    VirtualTexture::pack_page(
+        uint32_t level,
+        uint32_t x,
+        uint32_t y) noexcept
+    {
+        return (level & 0xF) << 28 | (y & 0x3FFF) << 14 | (x & 0x3FFF);
+    }
+
+    VirtualTexture::Page
+    VirtualTexture::unpack_page(
+        uint32_t packed) noexcept
+    {
+        return {packed >> 28, packed & 0x3FFF, (packed >> 14) & 0x3FFF};
+    }
+
+    std::optional<vk::Extent3D>
+    VirtualTexture::query_page_extent(
+        const vk::PhysicalDevice &physical_device,
+        vk::Format format)
+    {
+        vk::PhysicalDeviceFeatures features = physical_device.getFeatures();
+        if (!features.sparseBinding || !features.sparseResidencyImage2D)
+            return std::nullopt;
+
+        std::vector<vk::SparseImageFormatProperties> properties = physical_device.getSparseImageFormatProperties(
+            format,
+            vk::ImageType::e2D,
+            vk::SampleCountFlagBits::e1,
+            vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+            vk::ImageTiling::eOptimal);
+        for (const vk::SparseImageFormatProperties &property : properties)
+            if (property.aspectMask & vk::ImageAspectFlagBits::eColor)
+                return property.imageGranularity;
+        return std::nullopt;
+    }
+
+    bool
+    VirtualTexture::build(
+        const Config &config,
+        std::optional<uint32_t> tail_level)
+    {
+        std::optional<Ktx2File::FormatInfo> format_info = Ktx2File::get_format_info(config.m_format);
+        if (!format_info.has_value() ||
+            config.m_width == 0 || config.m_height == 0 ||
+            config.m_width > Ktx2File::MAX_DIMENSION || config.m_height > Ktx2File::MAX_DIMENSION ||
+            config.m_page_width == 0 || config.m_page_height == 0 ||
+            config.m_page_width % format_info->m_block_size != 0 || config.m_page_height % format_info->m_block_size != 0 ||
+            config.m_physical_page_count == 0 || config.m_max_loads == 0)
+        {
+            ntl::log.loge(
+                NTL_STRING("VirtualTexture::build"),
+                NTL_STRING("Invalid config"));
+            return false;
+        }
+
+        m_config = config;
+        m_format_info = *format_info;
+        m_level_count = 1;
+        while ((std::max(config.m_width, config.m_height) >> m_level_count) > 0)
+            m_level_count++;
+
+        // 尾部从第一个放不下整页的级别开始
+        if (tail_level.has_value())
+            m_tail_level = *tail_level;
+        else
+        {
+            m_tail_level = 0;
+            while (m_tail_level < m_level_count &&
+                   std::max(config.m_width >> m_tail_level, 1u) >= config.m_page_width &&
+                   std::max(config.m_height >> m_tail_level, 1u) >= config.m_page_height)
+                m_tail_level++;
+        }
+
+        m_levels.clear();
+        m_entries.clear();
+        for (uint32_t level = 0; level < m_tail_level; level++)
+        {
+            Level item;
+            item.m_width = std::max(config.m_width >> level, 1u);
+            item.m_height = std::max(config.m_height >> level, 1u);
+            item.m_columns = (item.m_width + config.m_page_width - 1) / config.m_page_width;
+            item.m_rows = (item.m_height + config.m_page_height - 1) / config.m_page_height;
+            item.m_first = static_cast<uint32_t>(m_entries.size());
+            if (item.m_columns > 0x4000 || item.m_rows > 0x4000 || level >= 0xF)
+            {
+                ntl::log.loge(
+                    NTL_STRING("VirtualTexture::build"),
+                    NTL_STRING("Too many pages for the feedback encoding"));
+                return false;
+            }
+            m_levels.push_back(item);
+
+            for (uint32_t y = 0; y < item.m_rows; y++)
+                for (uint32_t x = 0; x < item.m_columns; x++)
+                {
+                    Entry entry;
+                    entry.m_level = level;
+                    entry.m_x = x;
+                    entry.m_y = y;
+                    m_entries.push_back(entry);
+                }
+        }
+
+        m_free_pages.clear();
+        for (uint32_t i = config.m_physical_page_count; i > 0; i--)
+            m_free_pages.push_back(i - 1);
+
+        size_t map_size = m_levels.empty() ? 1 : static_cast<size_t>(m_levels[0].m_columns) * m_levels[0].m_rows;
+        m_min_levels.assign(map_size, static_cast<uint8_t>(m_tail_level));
+        m_is_map_dirty = true;
+
+        m_requested.clear();
+        m_request_frame = 0;
+        m_unsubmitted.clear();
+        m_in_flight.clear();
+        m_unsubmitted_releases.clear();
+        m_releases.clear();
+        m_unbinds.clear();
+        m_unsubmitted_mark.reset();
+        m_marks.clear();
+        m_last_submitted = 0;
+        m_is_tail_bound = false;
+        m_is_initialized = false;
+        m_statistics = Statistics();
+        return true;
+    }
+
+    uint32_t
+    VirtualTexture::get_entry(
+        uint32_t level,
+        uint32_t x,
+        uint32_t y) const noexcept
+    {
+        if (level >= m_tail_level)
+            return NO_PAGE;
+        const Level &item = m_levels[level];
+        if (x >= item.m_columns || y >= item.m_rows)
+            return NO_PAGE;
+        return item.m_first + y * item.m_columns + x;
+    }
+
+    uint32_t
+    VirtualTexture::get_parent(
+        const Entry &entry) const noexcept
+    {
+        return get_entry(entry.m_level + 1, entry.m_x >> 1, entry.m_y >> 1);
+    }
+
+    bool
+    VirtualTexture::load(
+        uint32_t index)
+    {
+        if (m_free_pages.empty())
+            return false;
+
+        Entry &entry = m_entries[index];
+        entry.m_state = State::eLoading;
+        entry.m_physical = m_free_pages.back();
+        m_free_pages.pop_back();
+        uint32_t parent = get_parent(entry);
+        if (parent != NO_PAGE)
+            m_entries[parent].m_child_count++;
+        m_unsubmitted.push_back(index);
+
+        m_statistics.m_loads++;
+        m_statistics.m_resident_pages++;
+        return true;
+    }
+
+    void
+    VirtualTexture::evict(
+        uint32_t index)
+    {
+        // 父页已驻留，区域退回父页的级别
+        Entry &entry = m_entries[index];
+        set_min_level(entry, entry.m_level + 1);
+        entry.m_state = State::eEmpty;
+        uint32_t parent = get_parent(entry);
+        if (parent != NO_PAGE)
+            m_entries[parent].m_child_count--;
+        m_unsubmitted_releases.push_back({entry.m_physical, index, 0});
+        entry.m_physical = NO_PAGE;
+
+        m_statistics.m_evictions++;
+        m_statistics.m_resident_pages--;
+    }
+
+    void
+    VirtualTexture::cancel(
+        uint32_t index) noexcept
+    {
+        Entry &entry = m_entries[index];
+        entry.m_state = State::eEmpty;
+        m_free_pages.push_back(entry.m_physical);
+        entry.m_physical = NO_PAGE;
+        uint32_t parent = get_parent(entry);
+        if (parent != NO_PAGE)
+            m_entries[parent].m_child_count--;
+        m_unsubmitted.erase(std::remove(m_unsubmitted.begin(), m_unsubmitted.end(), index), m_unsubmitted.end());
+
+        m_statistics.m_loads--;
+        m_statistics.m_resident_pages--;
+        m_statistics.m_deferred++;
+    }
+
+    void
+    VirtualTexture::cancel_unsubmitted() noexcept
+    {
+        while (!m_unsubmitted.empty())
+            cancel(m_unsubmitted.back());
+    }
+
+    void
+    VirtualTexture::set_min_level(
+        const Entry &entry,
+        uint32_t level) noexcept
+    {
+        // 第level级的一页覆盖2^level×2^level个第0级页
+        if (m_levels.empty())
+            return;
+        uint32_t columns = m_levels[0].m_columns, rows = m_levels[0].m_rows;
+        uint32_t x_begin = std::min(entry.m_x << entry.m_level, columns), x_end = std::min((entry.m_x + 1) << entry.m_level, columns);
+        uint32_t y_begin = std::min(entry.m_y << entry.m_level, rows), y_end = std::min((entry.m_y + 1) << entry.m_level, rows);
+        for (uint32_t y = y_begin; y < y_end; y++)
+            std::fill(
+                m_min_levels.begin() + static_cast<size_t>(y) * columns + x_begin,
+                m_min_levels.begin() + static_cast<size_t>(y) * columns + x_end,
+                static_cast<uint8_t>(level));
+        m_is_map_dirty = true;
+    }
+
+    vk::Rect2D
+    VirtualTexture::get_region(
+        const Entry &entry) const noexcept
+    {
+        const Level &item = m_levels[entry.m_level];
+        uint32_t x = entry.m_x * m_config.m_page_width, y = entry.m_y * m_config.m_page_height;
+        return vk::Rect2D(
+            vk::Offset2D(static_cast<int32_t>(x), static_cast<int32_t>(y)),
+            vk::Extent2D(std::min(m_config.m_page_width, item.m_width - x), std::min(m_config.m_page_height, item.m_height - y)));
+    }
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,412 @@
+#ifndef __VL_VIRTUALTEXTURE_HPP__
+#define __VL_VIRTUALTEXTURE_HPP__
+
+#include <vector>
+#include <deque>
+#include <optional>
+#include <functional>
+#include "Vulkan.hpp"
+#include <ntl/NTL.hpp>
+#include "StagingRing.hpp"
+#include "MappedBuffer.hpp"
+#include "Ktx2File.hpp"
+
+namespace vl
+{
+    /// @brief 稀疏驻留的虚拟纹理：创建很大的稀疏图像，按反馈在稀疏绑定队列上把物理页绑定到需要的区域
+    /// @details 尾部级别（mip tail）始终绑定，其余每一级按页划分，页表记录每页的状态和物理页。
+    /// 着色器把采样的页写入反馈缓冲，渲染线程每帧调用update决定加载和淘汰，
+    /// 用record把新页的内容从暂存环复制到图像，用bind在稀疏队列上绑定内存，
+    /// 复制所在的提交需要等待bind发出的信号量。
+    /// 一页加载时它更粗的父页必须已驻留，只淘汰没有驻留子页的页，
+    /// 因此最小级别图中的级别总是连续可用，着色器用它限制采样的LOD即可避免读到未绑定的页。
+    /// 被淘汰的物理页在之前的提交都完成后才重新使用。图像始终处于General布局，上传不需要切换整级的布局。
+    /// 页表和调度只依赖CPU上的状态，可以不创建Vulkan对象单独模拟
+    class VirtualTexture : public ntl::Object
+    {
+    public:
+        using SelfType = VirtualTexture;
+        using ParentType = ntl::Object;
+
+        /// @brief 没有页，也用于反馈缓冲中未写入的项
+        static constexpr uint32_t NO_PAGE = UINT32_MAX;
+
+        /// @brief 生成一个区域的内容
+        /// @details 参数依次为级别、区域在该级中的纹素坐标x和y、宽、高和目标，目标按格式紧密排列
+        using PageSource = std::function<bool(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint8_t *)>;
+
+        /// @brief 配置
+        struct Config
+        {
+            vk::Format m_format = vk::Format::eR8G8B8A8Unorm;
+            uint32_t m_width = 16384;
+            uint32_t m_height = 16384;
+
+            /// @brief 页的纹素尺寸，在设备上创建时使用稀疏图像的粒度
+            uint32_t m_page_width = 128;
+            uint32_t m_page_height = 128;
+
+            /// @brief 物理页数
+            uint32_t m_physical_page_count = 256;
+
+            /// @brief 每次update最多加载的页数，也是淘汰后保留的空闲页数
+            uint32_t m_max_loads = 16;
+
+            /// @brief 反馈缓冲的项数，只在设备上创建时使用
+            uint32_t m_feedback_count = 16384;
+        };
+
+        /// @brief 页的坐标
+        struct Page
+        {
+            uint32_t m_level = 0;
+            uint32_t m_x = 0;
+            uint32_t m_y = 0;
+        };
+
+        /// @brief 统计信息
+        struct Statistics
+        {
+            /// @brief 反馈中有效的项
+            uint64_t m_requests = 0;
+
+            uint64_t m_loads = 0;
+            uint64_t m_evictions = 0;
+
+            /// @brief 因为没有空闲物理页或暂存环已满推迟的加载
+            uint64_t m_deferred = 0;
+
+            /// @brief 绑定和解除绑定的页
+            uint64_t m_binds = 0;
+            uint64_t m_unbinds = 0;
+
+            /// @brief vkQueueBindSparse的调用次数
+            uint64_t m_bind_calls = 0;
+
+            uint64_t m_uploaded_bytes = 0;
+
+            /// @brief 驻留或正在加载的页
+            uint32_t m_resident_pages = 0;
+            uint32_t m_peak_resident_pages = 0;
+        };
+
+    protected:
+        /// @brief 页的状态
+        enum class State
+        {
+            eEmpty,
+            /// @brief 已分配物理页，等待复制完成
+            eLoading,
+            eResident,
+        };
+
+        /// @brief 页表的一项
+        struct Entry
+        {
+            uint32_t m_level = 0;
+            uint32_t m_x = 0;
+            uint32_t m_y = 0;
+
+            State m_state = State::eEmpty;
+            uint32_t m_physical = NO_PAGE;
+
+            /// @brief 驻留或正在加载的子页数
+            uint32_t m_child_count = 0;
+
+            /// @brief 最近一次请求的帧
+            std::optional<uint64_t> m_last_used;
+
+            uint64_t m_submit_value = 0;
+        };
+
+        /// @brief 尾部以上的一级
+        struct Level
+        {
+            uint32_t m_width = 0;
+            uint32_t m_height = 0;
+            uint32_t m_columns = 0;
+            uint32_t m_rows = 0;
+
+            /// @brief 第一页在页表中的位置
+            uint32_t m_first = 0;
+        };
+
+        /// @brief 等待回收的物理页
+        struct Release
+        {
+            uint32_t m_physical = NO_PAGE;
+
+            /// @brief 原来所在的页
+            uint32_t m_entry = NO_PAGE;
+
+            /// @brief 值不超过它的提交完成后才能回收
+            uint64_t m_value = 0;
+        };
+
+        /// @brief 暂存环回收的位置
+        struct Mark
+        {
+            vk::DeviceSize m_mark = 0;
+            uint64_t m_value = 0;
+        };
+
+    protected:
+        Config m_config;
+        Ktx2File::FormatInfo m_format_info;
+        StagingRing *m_ring = nullptr;
+
+        uint32_t m_level_count = 0;
+
+        /// @brief 尾部的第一级，它和更小的级别始终驻留
+        uint32_t m_tail_level = 0;
+
+        std::vector<Level> m_levels;
+        std::vector<Entry> m_entries;
+        std::vector<uint32_t> m_free_pages;
+
+        /// @brief 本帧请求的页和请求所在的帧
+        std::vector<uint32_t> m_requested;
+        uint64_t m_request_frame = 0;
+
+        /// @brief update计划、等待submitted的加载
+        std::vector<uint32_t> m_unsubmitted;
+
+        /// @brief 已提交、等待retire的加载
+        std::vector<uint32_t> m_in_flight;
+
+        /// @brief 尚未提交和已提交的淘汰
+        std::vector<Release> m_unsubmitted_releases;
+        std::deque<Release> m_releases;
+
+        /// @brief 物理页已回收、下次bind解除绑定的页
+        std::vector<uint32_t> m_unbinds;
+
+        /// @brief 每个第0级页上可以采样的最精细级别
+        std::vector<uint8_t> m_min_levels;
+        bool m_is_map_dirty = true;
+
+        std::optional<vk::DeviceSize> m_unsubmitted_mark;
+        std::deque<Mark> m_marks;
+        uint64_t m_last_submitted = 0;
+
+        /// @brief 设备上的对象，只在CPU上模拟时为空
+        vk::Image m_image;
+        vk::ImageView m_view;
+        vk::DeviceMemory m_memory;
+        vk::DeviceMemory m_tail_memory;
+        vk::DeviceSize m_page_size = 0;
+        vk::DeviceSize m_tail_offset = 0;
+        vk::DeviceSize m_tail_size = 0;
+        MappedBuffer m_feedback;
+
+        /// @brief 尾部是否已绑定、是否已记录初始布局和尾部内容
+        bool m_is_tail_bound = false;
+        bool m_is_initialized = false;
+
+        Statistics m_statistics;
+
+    public:
+        VirtualTexture() = default;
+        ~VirtualTexture() override = default;
+
+        VirtualTexture(const SelfType &) = delete;
+        SelfType &operator=(const SelfType &) = delete;
+
+    public:
+        /// @brief 只在CPU上创建页表，用于模拟
+        /// @param config 配置
+        /// @return 是否成功
+        bool create(const Config &config);
+
+        /// @brief 创建稀疏图像、物理页、尾部内存和反馈缓冲
+        /// @details 设备需要启用sparseBinding和sparseResidencyImage2D，页的尺寸和尾部由设备决定
+        /// @param device 逻辑设备
+        /// @param physical_device 物理设备
+        /// @param config 配置
+        /// @param ring 上传使用的暂存环，容量至少为尾部的字节数
+        /// @return 结果
+        vk::Result create(
+            const vk::Device &device,
+            const vk::PhysicalDevice &physical_device,
+            const Config &config,
+            StagingRing &ring);
+
+        /// @brief 销毁，调用前需要保证设备已不再使用图像
+        /// @param device 逻辑设备，只在CPU上模拟时可以为空
+        void destroy(const vk::Device &device);
+
+        /// @brief 请求一页，它更粗的各级父页也一并被使用
+        /// @param level 级别，不小于尾部时忽略
+        /// @param x 页的列
+        /// @param y 页的行
+        /// @param frame 帧序号，单调增加
+        void request(uint32_t level, uint32_t x, uint32_t y, uint64_t frame) noexcept;
+
+        /// @brief 报告反馈，每项为pack_page的结果
+        /// @param pages 反馈，NO_PAGE的项被忽略
+        /// @param count 项数
+        /// @param frame 反馈所属的帧
+        void submit_feedback(const uint32_t *pages, uint32_t count, uint64_t frame) noexcept;
+
+        /// @brief 读取反馈缓冲并报告，反馈所在的提交需要已完成
+        /// @param device 逻辑设备
+        /// @param frame 反馈所属的帧
+        /// @return 结果
+        vk::Result read_feedback(const vk::Device &device, uint64_t frame);
+
+        /// @brief 记录清空反馈缓冲，之后着色器可以写入
+        /// @param command_buffer 命令缓冲
+        void record_feedback_clear(const vk::CommandBuffer &command_buffer) const;
+
+        /// @brief 决定本帧的加载和淘汰，每帧在渲染线程调用一次
+        /// @details 最久未使用的叶子页被淘汰，直到空闲和等待回收的物理页不少于每次的加载数；
+        /// 加载按级别从粗到细，父页未驻留时先加载父页，没有空闲物理页时留到以后
+        /// @param frame 帧序号，与request一致
+        /// @return 本次加载的页
+        std::vector<Page> update(uint64_t frame);
+
+        /// @brief 把加载的页写入暂存环并记录复制，第一次调用时还记录初始布局和尾部的上传
+        /// @details 暂存环空间不足的加载被取消，下次update重新决定；尾部无法暂存或刷新失败时取消所有计划的加载
+        /// @param device 逻辑设备，用于刷新暂存环
+        /// @param command_buffer 命令缓冲，提交时需要等待bind发出的信号量
+        /// @param source 内容
+        /// @return 结果
+        vk::Result record(
+            const vk::Device &device,
+            const vk::CommandBuffer &command_buffer,
+            const PageSource &source);
+
+        /// @brief 在稀疏绑定队列上绑定加载的页、解除已回收的页，第一次调用时还绑定尾部
+        /// @param queue 支持稀疏绑定的队列
+        /// @param signal 绑定完成时发出的信号量，可以为空
+        /// @param fence 绑定完成时发出的栅栏，可以为空
+        /// @return 结果
+        vk::Result bind(const vk::Queue &queue, const vk::Semaphore &signal, const vk::Fence &fence);
+
+        /// @brief 告知update计划的加载和淘汰已随一次提交发出
+        /// @param value 该次提交的值，单调增加
+        void submitted(uint64_t value);
+
+        /// @brief 值不超过completed的提交已完成，完成加载并回收物理页
+        /// @param completed 已完成的提交的值
+        void retire(uint64_t completed);
+
+        /// @brief 页是否可以采样
+        /// @param level 级别
+        /// @param x 页的列
+        /// @param y 页的行
+        /// @return 是否驻留，尾部总是驻留
+        bool is_resident(uint32_t level, uint32_t x, uint32_t y) const noexcept;
+
+        /// @brief 获取最小级别图，每个第0级页一个字节，行优先
+        /// @return 最小级别图
+        const std::vector<uint8_t> &get_min_level_map() const noexcept;
+
+        /// @brief 取走最小级别图是否变化，变化时需要重新上传
+        /// @return 是否变化
+        bool take_map_dirty() noexcept;
+
+        /// @brief 获取一级的页数
+        /// @param level 级别
+        /// @return 列数和行数，尾部为1
+        vk::Extent2D get_page_count(uint32_t level) const noexcept;
+
+        /// @brief 获取页的宽度
+        /// @return 纹素数
+        uint32_t get_page_width() const noexcept;
+
+        /// @brief 获取页的高度
+        /// @return 纹素数
+        uint32_t get_page_height() const noexcept;
+
+        /// @brief 获取级数
+        /// @return 级数
+        uint32_t get_level_count() const noexcept;
+
+        /// @brief 获取尾部的第一级
+        /// @return 级别
+        uint32_t get_tail_level() const noexcept;
+
+        /// @brief 获取空闲的物理页数
+        /// @return 页数
+        uint32_t get_free_page_count() const noexcept;
+
+        /// @brief 获取稀疏图像
+        /// @return 图像，只在CPU上模拟时为空
+        const vk::Image &get_image() const noexcept;
+
+        /// @brief 获取包含所有级别的视图
+        /// @return 视图
+        const vk::ImageView &get_view() const noexcept;
+
+        /// @brief 获取反馈缓冲，着色器把采样的页用atomicExchange或直接写入任意一项
+        /// @return 缓冲
+        const vk::Buffer &get_feedback_buffer() const noexcept;
+
+        /// @brief 获取统计信息
+        /// @return 统计信息
+        const Statistics &get_statistics() const noexcept;
+
+        /// @brief 格式化统计信息
+        /// @return 格式化后的结果
+        ntl::String format() const;
+
+    public:
+        /// @brief 把页的坐标打包为反馈的一项：级别4位，行和列各14位
+        /// @param level 级别
+        /// @param x 页的列
+        /// @param y 页的行
+        /// @return 打包的结果
+        static uint32_t pack_page(uint32_t level, uint32_t x, uint32_t y) noexcept;
+
+        /// @brief 解包反馈的一项
+        /// @param packed 打包的结果
+        /// @return 页的坐标
+        static Page unpack_page(uint32_t packed) noexcept;
+
+        /// @brief 查询格式作为二维稀疏驻留图像时的页尺寸
+        /// @param physical_device 物理设备
+        /// @param format 格式
+        /// @return 页尺寸，不支持时为空
+        static std::optional<vk::Extent3D> query_page_extent(const vk::PhysicalDevice &physical_device, vk::Format format);
+
+    protected:
+        /// @brief 建立各级和页表
+        /// @param config 配置，页尺寸已确定
+        /// @param tail_level 尾部的第一级，为空时取第一个小于页尺寸的级别
+        /// @return 是否成功
+        bool build(const Config &config, std::optional<uint32_t> tail_level);
+
+        /// @brief 获取页在页表中的位置
+        /// @return 位置，超出范围或在尾部时为NO_PAGE
+        uint32_t get_entry(uint32_t level, uint32_t x, uint32_t y) const noexcept;
+
+        /// @brief 获取父页在页表中的位置
+        /// @return 位置，父页在尾部时为NO_PAGE
+        uint32_t get_parent(const Entry &entry) const noexcept;
+
+        /// @brief 计划加载一页
+        /// @return 是否有空闲的物理页
+        bool load(uint32_t index);
+
+        /// @brief 淘汰一页，物理页在之后的提交完成后回收
+        void evict(uint32_t index);
+
+        /// @brief 取消一个已计划的加载
+        void cancel(uint32_t index) noexcept;
+
+        /// @brief 取消所有已计划、尚未提交的加载，子页先于父页
+        void cancel_unsubmitted() noexcept;
+
+        /// @brief 更新页覆盖的区域的最小级别
+        /// @param entry 页
+        /// @param level 新的最小级别
+        void set_min_level(const Entry &entry, uint32_t level) noexcept;
+
+        /// @brief 获取一页在它的级别中的纹素区域
+        /// @return 偏移和尺寸
+        vk::Rect2D get_region(const Entry &entry) const noexcept;
+    };
+} // namespace vl
+
+#endif
\ No newline at end of file
@@ -0,0 +1,386 @@
+#ifndef MESHCONVERTER_CPP
+#define MESHCONVERTER_CPP
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/MeshUtils.hpp"
+#include "../src/MeshUtils.cpp"
+#include "../src/MeshletUtils.hpp"
+#include "../src/MeshletUtils.cpp"
+#include "../src/LodUtils.hpp"
+#include "../src/LodUtils.cpp"
+#include "../src/VertexLayout.hpp"
+#include "../src/VertexLayout.cpp"
+#include "../src/StagingRing.hpp"
+#include "../src/StagingRing.cpp"
+#include "../src/MappedFile.hpp"
+#include "../src/MappedFile.cpp"
+#include "../src/MeshFile.hpp"
+#include "../src/MeshFile.cpp"
+
+/// @brief 转换选项
+struct MeshConvertOptions
+{
+    /// @brief 是否量化顶点
+    bool m_is_quantized = true;
+
+    /// @brief 顶点缓存优化的目标大小
+    uint32_t m_cache_size = vl::MeshUtils::DEFAULT_CACHE_SIZE;
+
+    /// @brief 是否生成簇，生成时索引按簇的顺序存放
+    bool m_has_meshlets = true;
+
+    /// @brief 簇的顶点数和三角形数上限
+    uint32_t m_max_meshlet_vertices = vl::MeshletUtils::DEFAULT_MAX_VERTICES;
+    uint32_t m_max_meshlet_triangles = vl::MeshletUtils::DEFAULT_MAX_TRIANGLES;
+
+    /// @brief LOD级数，包括原网格，为1时不生成LOD
+    uint32_t m_lod_count = vl::LodUtils::MAX_LOD_COUNT;
+
+    /// @brief LOD的误差上限，相对包围球半径
+    float m_max_lod_error = 0.05f;
+};
+
+/// @brief 解析OBJ为三角形列表，每个顶点为位置、法线、纹理坐标共8个float
+/// @details 支持v、vt、vn和任意边数的f，负索引相对于当前已读的数量；没有法线的面使用面法线
+bool parse_obj(const std::string &text, std::vector<float> &soup)
+{
+    std::vector<float> positions, uvs, normals;
+    std::vector<long> face;
+    std::istringstream lines(text);
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(lines, line))
+    {
+        line_number++;
+        const char *cursor = line.c_str();
+        while (*cursor == ' ' || *cursor == '\t')
+            cursor++;
+
+        auto read_floats = [&](size_t count, std::vector<float> &out)
+        {
+            char *end = nullptr;
+            for (size_t i = 0; i < count; i++)
+            {
+                out.push_back(std::strtof(cursor, &end));
+                cursor = end;
+            }
+        };
+
+        if (cursor[0] == 'v' && cursor[1] == ' ')
+        {
+            cursor += 2;
+            read_floats(3, positions);
+        }
+        else if (cursor[0] == 'v' && cursor[1] == 't' && cursor[2] == ' ')
+        {
+            cursor += 3;
+            read_floats(2, uvs);
+        }
+        else if (cursor[0] == 'v' && cursor[1] == 'n' && cursor[2] == ' ')
+        {
+            cursor += 3;
+            read_floats(3, normals);
+        }
+        else if (cursor[0] == 'f' && cursor[1] == ' ')
+        {
+            // 每个角为位置/纹理坐标/法线三个索引，0表示没有
+            cursor += 2;
+            face.clear();
+            while (true)
+            {
+                while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')
+                    cursor++;
+                if (*cursor == '\0')
+                    break;
+
+                long corner[3] = {0, 0, 0};
+                const long counts[3] = {static_cast<long>(positions.size() / 3), static_cast<long>(uvs.size() / 2), static_cast<long>(normals.size() / 3)};
+                for (size_t k = 0; k < 3; k++)
+                {
+                    char *end = nullptr;
+                    long index = std::strtol(cursor, &end, 10);
+                    if (end != cursor)
+                        corner[k] = index < 0 ? counts[k] + index + 1 : index;
+                    cursor = end;
+                    if (corner[k] < 0 || corner[k] > counts[k] || (k == 0 && corner[k] == 0))
+                    {
+                        std::cout << "invalid face at line " << line_number << std::endl;
+                        return false;
+                    }
+                    if (*cursor != '/')
+                        break;
+                    cursor++;
+                }
+                face.insert(face.end(), corner, corner + 3);
+            }
+
+            // 没有法线时用Newell方法计算面法线
+            float face_normal[3] = {0.0f, 0.0f, 0.0f};
+            size_t corner_count = face.size() / 3;
+            for (size_t i = 0; i < corner_count; i++)
+            {
+                const float *a = &positions[(face[i * 3] - 1) * 3];
+                const float *b = &positions[(face[(i + 1) % corner_count * 3] - 1) * 3];
+                face_normal[0] += (a[1] - b[1]) * (a[2] + b[2]);
+                face_normal[1] += (a[2] - b[2]) * (a[0] + b[0]);
+                face_normal[2] += (a[0] - b[0]) * (a[1] + b[1]);
+            }
+            float length = std::sqrt(face_normal[0] * face_normal[0] + face_normal[1] * face_normal[1] + face_normal[2] * face_normal[2]);
+            for (size_t k = 0; k < 3; k++)
+                face_normal[k] = length > 0.0f ? face_normal[k] / length : (k == 2 ? 1.0f : 0.0f);
+
+            // 多边形按扇形拆成三角形
+            auto emit = [&](size_t i)
+            {
+                const long *corner = &face[i * 3];
+                soup.insert(soup.end(), &positions[(corner[0] - 1) * 3], &positions[(corner[0] - 1) * 3] + 3);
+                if (corner[2] > 0)
+                    soup.insert(soup.end(), &normals[(corner[2] - 1) * 3], &normals[(corner[2] - 1) * 3] + 3);
+                else
+                    soup.insert(soup.end(), face_normal, face_normal + 3);
+                if (corner[1] > 0)
+                    soup.insert(soup.end(), &uvs[(corner[1] - 1) * 2], &uvs[(corner[1] - 1) * 2] + 2);
+                else
+                    soup.insert(soup.end(), {0.0f, 0.0f});
+            };
+            for (size_t i = 1; i + 1 < corner_count; i++)
+            {
+                emit(0);
+                emit(i);
+                emit(i + 1);
+            }
+        }
+    }
+
+    return true;
+}
+
+/// @brief 把三角形列表合并、优化并写为网格文件
+/// @param soup parse_obj的结果
+/// @param output 输出路径
+/// @param options 选项
+/// @return 是否成功
+bool write_mesh_file(const std::vector<float> &soup, const std::string &output, const MeshConvertOptions &options)
+{
+    const size_t floats_per_vertex = 8;
+    const size_t soup_count = soup.size() / floats_per_vertex;
+    if (soup_count == 0)
+    {
+        std::cout << "no triangles" << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> welded;
+    std::vector<uint32_t> indices;
+    size_t vertex_count = vl::MeshUtils::weld(soup.data(), soup_count, sizeof(float) * floats_per_vertex, welded, indices);
+    vl::MeshUtils::CacheStatistics before = vl::MeshUtils::analyze_vertex_cache(indices.data(), indices.size(), vertex_count, options.m_cache_size);
+
+    std::vector<uint32_t> clusters;
+    vl::MeshUtils::optimize_vertex_cache(indices, vertex_count, options.m_cache_size, &clusters);
+    vl::MeshUtils::optimize_overdraw(indices, reinterpret_cast<const float *>(welded.data()), sizeof(float) * floats_per_vertex, vertex_count, clusters);
+    vertex_count = vl::MeshUtils::optimize_vertex_fetch(indices, welded.data(), vertex_count, sizeof(float) * floats_per_vertex);
+
+    // 簇从重排后的顺序开始生长，索引改为按簇展开，每个簇是一段连续的索引
+    std::vector<vl::MeshletUtils::Meshlet> meshlets;
+    std::vector<uint32_t> meshlet_vertices;
+    std::vector<uint8_t> meshlet_triangles;
+    std::vector<vl::MeshletUtils::Bounds> meshlet_bounds;
+    if (options.m_has_meshlets)
+    {
+        vl::MeshletUtils::build(
+            indices.data(),
+            indices.size(),
+            reinterpret_cast<const float *>(welded.data()),
+            sizeof(float) * floats_per_vertex,
+            vertex_count,
+            meshlets,
+            meshlet_vertices,
+            meshlet_triangles,
+            options.m_max_meshlet_vertices,
+            options.m_max_meshlet_triangles);
+        if (meshlets.empty())
+        {
+            std::cout << "failed to build meshlets" << std::endl;
+            return false;
+        }
+        for (const vl::MeshletUtils::Meshlet &meshlet : meshlets)
+            meshlet_bounds.push_back(vl::MeshletUtils::compute_bounds(
+                meshlet,
+                meshlet_vertices.data(),
+                meshlet_triangles.data(),
+                reinterpret_cast<const float *>(welded.data()),
+                sizeof(float) * floats_per_vertex));
+        vl::MeshletUtils::unpack_indices(meshlets, meshlet_vertices, meshlet_triangles, indices);
+    }
+    vl::MeshUtils::CacheStatistics after = vl::MeshUtils::analyze_vertex_cache(indices.data(), indices.size(), vertex_count, options.m_cache_size);
+
+    // 拆回分开的数组再按布局打包
+    const float *vertices = reinterpret_cast<const float *>(welded.data());
+    std::vector<float> positions(vertex_count * 3), normals(vertex_count * 3), uvs(vertex_count * 2);
+    for (size_t v = 0; v < vertex_count; v++)
+    {
+        std::copy(vertices + v * 8, vertices + v * 8 + 3, &positions[v * 3]);
+        std::copy(vertices + v * 8 + 3, vertices + v * 8 + 6, &normals[v * 3]);
+        std::copy(vertices + v * 8 + 6, vertices + v * 8 + 8, &uvs[v * 2]);
+    }
+
+    vl::VertexLayout::Encoding encoding = options.m_is_quantized ? vl::VertexLayout::ENCODING_QUANTIZED : vl::VertexLayout::ENCODING_FLOAT;
+    vl::VertexLayout layout;
+    layout.add(vl::VertexLayout::ATTRIBUTE_POSITION, encoding, 0)
+        .add(vl::VertexLayout::ATTRIBUTE_NORMAL, encoding, 1)
+        .add(vl::VertexLayout::ATTRIBUTE_UV, encoding, 2);
+
+    vl::VertexLayout::Source source;
+    source.m_positions = positions.data();
+    source.m_normals = normals.data();
+    source.m_uvs = uvs.data();
+    source.m_vertex_count = vertex_count;
+
+    vl::MeshFile::Header header;
+    header.m_quantization = vl::VertexLayout::compute_quantization(source);
+    vl::MeshFile::set_layout(layout, header);
+    vl::MeshFile::compute_bounds(positions.data(), vertex_count, header);
+
+    // 各级LOD追加在原网格的索引后面，簇只覆盖第0级
+    const size_t triangle_count = indices.size() / 3;
+    std::vector<vl::LodUtils::Lod> lods;
+    if (options.m_lod_count > 1)
+        vl::LodUtils::build_chain(
+            indices,
+            positions.data(),
+            sizeof(float) * 3,
+            vertex_count,
+            lods,
+            options.m_lod_count,
+            vl::LodUtils::DEFAULT_LOD_RATIO,
+            options.m_max_lod_error * header.m_sphere[3],
+            options.m_cache_size);
+
+    header.m_vertex_count = static_cast<uint32_t>(vertex_count);
+    header.m_index_count = static_cast<uint32_t>(indices.size());
+    header.m_index_size = vertex_count <= 65536 ? 2 : 4;
+
+    std::vector<uint8_t> packed(vertex_count * layout.get_stride(0));
+    layout.pack(source, header.m_quantization, 0, packed.data());
+
+    std::vector<uint16_t> short_indices;
+    const void *index_data = indices.data();
+    if (header.m_index_size == 2)
+    {
+        short_indices.assign(indices.begin(), indices.end());
+        index_data = short_indices.data();
+    }
+
+    std::vector<vl::MeshFile::ChunkSource> chunks(2);
+    chunks[0].m_type = vl::MeshFile::CHUNK_VERTICES;
+    chunks[0].m_count = header.m_vertex_count;
+    chunks[0].m_data = packed.data();
+    chunks[0].m_size = packed.size();
+    chunks[1].m_type = vl::MeshFile::CHUNK_INDICES;
+    chunks[1].m_count = header.m_index_count;
+    chunks[1].m_data = index_data;
+    chunks[1].m_size = static_cast<uint64_t>(indices.size()) * header.m_index_size;
+    if (options.m_has_meshlets)
+    {
+        const vl::MeshFile::ChunkSource meshlet_chunks[] = {
+            {vl::MeshFile::CHUNK_MESHLETS, static_cast<uint32_t>(meshlets.size()), meshlets.data(), meshlets.size() * sizeof(vl::MeshletUtils::Meshlet)},
+            {vl::MeshFile::CHUNK_MESHLET_BOUNDS, static_cast<uint32_t>(meshlet_bounds.size()), meshlet_bounds.data(), meshlet_bounds.size() * sizeof(vl::MeshletUtils::Bounds)},
+            {vl::MeshFile::CHUNK_MESHLET_VERTICES, static_cast<uint32_t>(meshlet_vertices.size()), meshlet_vertices.data(), meshlet_vertices.size() * sizeof(uint32_t)},
+            {vl::MeshFile::CHUNK_MESHLET_TRIANGLES, static_cast<uint32_t>(meshlet_triangles.size() / 3), meshlet_triangles.data(), meshlet_triangles.size()},
+        };
+        chunks.insert(chunks.end(), std::begin(meshlet_chunks), std::end(meshlet_chunks));
+    }
+    if (lods.size() > 1)
+        chunks.push_back({vl::MeshFile::CHUNK_LODS, static_cast<uint32_t>(lods.size()), lods.data(), lods.size() * sizeof(vl::LodUtils::Lod)});
+    if (!vl::MeshFile::write(output, header, chunks))
+    {
+        std::cout << "failed to write " << output << std::endl;
+        return false;
+    }
+
+    std::cout << output << ": " << triangle_count << " triangles, "
+              << soup_count << " -> " << vertex_count << " vertices, "
+              << layout.get_stride(0) << " bytes/vertex, "
+              << header.m_index_size << " bytes/index, ACMR "
+              << before.m_acmr << " -> " << after.m_acmr << ", "
+              << meshlets.size() << " meshlets, "
+              << std::max<size_t>(lods.size(), 1) << " lods";
+    if (lods.size() > 1)
+        std::cout << " down to " << lods.back().m_index_count / 3 << " triangles, error " << lods.back().m_error;
+    std::cout << std::endl;
+    return true;
+}
+
+/// @brief 转换网格文件
+/// @param input 输入路径，.obj
+/// @param output 输出路径
+/// @param options 选项
+/// @return 是否成功
+bool convert_mesh(const std::string &input, const std::string &output, const MeshConvertOptions &options)
+{
+    std::string extension = input.substr(input.find_last_of('.') + 1);
+    for (char &c : extension)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (extension == "gltf" || extension == "glb")
+    {
+        // 需要JSON解析器，目前没有依赖可用
+        std::cout << "glTF input is not supported, export the mesh as OBJ" << std::endl;
+        return false;
+    }
+
+    std::ifstream fin(input, std::ios::binary);
+    if (!fin)
+    {
+        std::cout << "failed to open " << input << std::endl;
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+    std::vector<float> soup;
+    if (!parse_obj(text, soup))
+        return false;
+    return write_mesh_file(soup, output, options);
+}
+
+/// @brief mesh子命令：tools mesh <input.obj> <output.vlm> [--float] [--cache n] [--no-meshlets] [--meshlet v t] [--lod n] [--lod-error e]
+int run_mesh_converter(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: tools mesh <input.obj> <output.vlm> [--float] [--cache n] [--no-meshlets] [--meshlet v t] [--lod n] [--lod-error e]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    MeshConvertOptions options;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "--float")
+            options.m_is_quantized = false;
+        else if (option == "--cache" && i + 1 < argc)
+            options.m_cache_size = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (option == "--no-meshlets")
+            options.m_has_meshlets = false;
+        else if (option == "--meshlet" && i + 2 < argc)
+        {
+            options.m_max_meshlet_vertices = static_cast<uint32_t>(std::atoi(argv[++i]));
+            options.m_max_meshlet_triangles = static_cast<uint32_t>(std::atoi(argv[++i]));
+        }
+        else if (option == "--lod" && i + 1 < argc)
+            options.m_lod_count = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (option == "--lod-error" && i + 1 < argc)
+            options.m_max_lod_error = static_cast<float>(std::atof(argv[++i]));
+    }
+
+    return convert_mesh(argv[0], argv[1], options) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,260 @@
+#ifndef TEXTURECONVERTER_CPP
+#define TEXTURECONVERTER_CPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../src/ThreadPool.hpp"
+#include "../src/ThreadPool.cpp"
+#include "../src/StagingRing.hpp"
+#include "../src/StagingRing.cpp"
+#include "../src/MappedFile.hpp"
+#include "../src/MappedFile.cpp"
+#include "../src/TextureFile.hpp"
+#include "../src/TextureFile.cpp"
+#include "../src/DeviceUtils.hpp"
+#include "../src/DeviceUtils.cpp"
+#include "../src/MappedBuffer.hpp"
+#include "../src/MappedBuffer.cpp"
+#include "../src/MipGenerator.hpp"
+#include "../src/MipGenerator.cpp"
+#include "../src/TextureCompressor.hpp"
+#include "../src/TextureCompressor.cpp"
+#include "../src/Deflate.hpp"
+#include "../src/Deflate.cpp"
+#include "../src/Ktx2File.hpp"
+#include "../src/Ktx2File.cpp"
+
+/// @brief 转换选项
+struct TextureConvertOptions
+{
+    /// @brief 内容
+    vl::TextureCompressor::Usage m_usage = vl::TextureCompressor::Usage::eColor;
+
+    /// @brief 格式，为空时取内容的第一个候选格式
+    std::optional<vl::TextureCompressor::Format> m_format;
+
+    /// @brief 是否不压缩，保存RGBA8，只用于KTX2
+    bool m_is_uncompressed = false;
+
+    /// @brief 是否用zlib超压缩每一级，只用于KTX2
+    bool m_is_supercompressed = false;
+
+    /// @brief 是否生成mip链
+    bool m_has_mips = false;
+
+    /// @brief 线程数，为0时使用硬件线程数
+    size_t m_thread_count = 0;
+};
+
+/// @brief 获取DDS的DX10扩展头中的DXGI格式，ETC2和EAC没有对应的格式
+uint32_t get_dxgi_format(vl::TextureCompressor::Format format)
+{
+    switch (format)
+    {
+    case vl::TextureCompressor::Format::eBC1:
+        return 71;
+    case vl::TextureCompressor::Format::eBC3:
+        return 77;
+    case vl::TextureCompressor::Format::eBC4:
+        return 80;
+    case vl::TextureCompressor::Format::eBC5:
+        return 83;
+    case vl::TextureCompressor::Format::eBC7:
+        return 98;
+    default:
+        return 0;
+    }
+}
+
+/// @brief 写入带DX10扩展头的DDS文件，各级紧接在文件头之后
+bool write_dds(
+    const std::string &path,
+    vl::TextureCompressor::Format format,
+    uint32_t width,
+    uint32_t height,
+    const std::vector<std::vector<uint8_t>> &levels)
+{
+    std::vector<uint32_t> header(1 + 31 + 5, 0);
+    header[0] = 0x20534444; // "DDS "
+    header[1] = 124;
+    header[2] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x80000 | (levels.size() > 1 ? 0x20000 : 0);
+    header[3] = height;
+    header[4] = width;
+    header[5] = static_cast<uint32_t>(levels.at(0).size());
+    header[7] = static_cast<uint32_t>(levels.size());
+    // 像素格式：只有FourCC为"DX10"
+    header[19] = 32;
+    header[20] = 0x4;
+    header[21] = 0x30315844;
+    header[27] = 0x1000 | (levels.size() > 1 ? 0x8 | 0x400000 : 0);
+    // DX10扩展头：格式、二维纹理、数组大小1
+    header[32] = get_dxgi_format(format);
+    header[33] = 3;
+    header[35] = 1;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    file.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size() * sizeof(uint32_t)));
+    for (const std::vector<uint8_t> &level : levels)
+        file.write(reinterpret_cast<const char *>(level.data()), static_cast<std::streamsize>(level.size()));
+    return static_cast<bool>(file);
+}
+
+/// @brief 转换一个纹理，输出路径以.ktx2结尾时写KTX2，否则写DDS
+bool convert_texture(const std::string &input_path, const std::string &output_path, const TextureConvertOptions &options)
+{
+    vl::TextureCompressor::Format format = options.m_format.value_or(vl::TextureCompressor::get_candidates(options.m_usage).front());
+    const char *format_name = options.m_is_uncompressed ? "RGBA8" : vl::TextureCompressor::get_name(format);
+    bool is_ktx2 = output_path.size() >= 5 && output_path.compare(output_path.size() - 5, 5, ".ktx2") == 0;
+    if (!is_ktx2 && (options.m_is_uncompressed || options.m_is_supercompressed || get_dxgi_format(format) == 0))
+    {
+        std::cout << format_name << (options.m_is_supercompressed ? " with zlib" : "") << " cannot be stored in dds" << std::endl;
+        return false;
+    }
+
+    vl::TextureFile texture;
+    if (!texture.open(input_path))
+    {
+        std::cout << "failed to open " << input_path << std::endl;
+        return false;
+    }
+    uint32_t width = texture.get_width(), height = texture.get_height();
+    std::vector<uint8_t> pixels(static_cast<size_t>(texture.get_decoded_size()));
+    if (!texture.decode(pixels.data(), static_cast<size_t>(width) * 4))
+    {
+        std::cout << "failed to decode " << input_path << std::endl;
+        return false;
+    }
+    texture.close();
+
+    // PPM没有透明度，灰度取亮度放在R，法线只保留RG
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+        if (options.m_usage == vl::TextureCompressor::Usage::eGray)
+            pixels[i] = static_cast<uint8_t>((pixels[i] * 77 + pixels[i + 1] * 150 + pixels[i + 2] * 29) >> 8);
+        if (options.m_usage == vl::TextureCompressor::Usage::eNormal)
+            pixels[i + 2] = 0;
+    }
+
+    uint32_t level_count = options.m_has_mips ? vl::MipGenerator::get_level_count(width, height) : 1;
+    std::vector<std::vector<uint8_t>> sources;
+    if (level_count > 1)
+        vl::MipGenerator::generate(pixels.data(), width, height, level_count, sources);
+    sources.insert(sources.begin(), std::move(pixels));
+
+    vl::ThreadPool pool(options.m_thread_count);
+    std::vector<std::vector<uint8_t>> levels(level_count);
+    double total_ms = 0.0;
+    size_t total_pixels = 0;
+    for (uint32_t level = 0; level < level_count && options.m_is_uncompressed; level++)
+        levels.at(level) = std::move(sources.at(level));
+    for (uint32_t level = 0; level < level_count && !options.m_is_uncompressed; level++)
+    {
+        uint32_t level_width = std::max(width >> level, 1u), level_height = std::max(height >> level, 1u);
+        levels.at(level).resize(vl::TextureCompressor::get_compressed_size(format, level_width, level_height));
+        auto begin = std::chrono::steady_clock::now();
+        vl::TextureCompressor::compress(format, sources.at(level).data(), level_width, level_height, levels.at(level).data(), &pool);
+        total_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        total_pixels += static_cast<size_t>(level_width) * level_height;
+    }
+
+    std::cout << input_path << " -> " << output_path << ": " << width << "x" << height
+              << ", " << format_name << (options.m_is_supercompressed ? " + zlib" : "") << ", " << level_count << " levels" << std::endl;
+    if (!options.m_is_uncompressed)
+    {
+        // 只对第0级计算误差
+        std::vector<uint8_t> decoded(sources.at(0).size());
+        vl::TextureCompressor::decompress(format, levels.at(0).data(), width, height, decoded.data(), &pool);
+        double psnr = vl::TextureCompressor::compute_psnr(format, sources.at(0).data(), decoded.data(), width, height);
+        std::cout << "  psnr " << psnr << " dB, " << total_pixels / 1e6 / (total_ms / 1000.0) << " Mpix/s on "
+                  << pool.get_thread_count() << " threads" << std::endl;
+    }
+
+    bool is_written = false;
+    if (is_ktx2)
+        is_written = vl::Ktx2File::write(
+            output_path,
+            options.m_is_uncompressed ? vk::Format::eR8G8B8A8Unorm : vl::TextureCompressor::get_vk_format(format),
+            width,
+            height,
+            levels,
+            options.m_is_supercompressed ? vl::Ktx2File::SUPERCOMPRESSION_ZLIB : vl::Ktx2File::SUPERCOMPRESSION_NONE);
+    else
+        is_written = write_dds(output_path, format, width, height, levels);
+    if (!is_written)
+    {
+        std::cout << "failed to write " << output_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int run_texture_converter(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: tools texture <input.ppm> <output.dds|output.ktx2> [--usage color|alpha|gray|normal] [--mips] [--threads t]" << std::endl
+                  << "                     [--format bc1|bc3|bc4|bc5|bc7|etc2|etc2a|eacr|eacrg|rgba8] [--zlib]" << std::endl
+                  << "  etc2, eac, rgba8 and --zlib need ktx2" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    TextureConvertOptions options;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "--usage" && i + 1 < argc)
+        {
+            std::string usage = argv[++i];
+            if (usage == "alpha")
+                options.m_usage = vl::TextureCompressor::Usage::eColorAlpha;
+            else if (usage == "gray")
+                options.m_usage = vl::TextureCompressor::Usage::eGray;
+            else if (usage == "normal")
+                options.m_usage = vl::TextureCompressor::Usage::eNormal;
+            else
+                options.m_usage = vl::TextureCompressor::Usage::eColor;
+        }
+        else if (option == "--format" && i + 1 < argc)
+        {
+            std::string format = argv[++i];
+            if (format == "bc1")
+                options.m_format = vl::TextureCompressor::Format::eBC1;
+            else if (format == "bc3")
+                options.m_format = vl::TextureCompressor::Format::eBC3;
+            else if (format == "bc4")
+                options.m_format = vl::TextureCompressor::Format::eBC4;
+            else if (format == "bc5")
+                options.m_format = vl::TextureCompressor::Format::eBC5;
+            else if (format == "bc7")
+                options.m_format = vl::TextureCompressor::Format::eBC7;
+            else if (format == "etc2")
+                options.m_format = vl::TextureCompressor::Format::eETC2;
+            else if (format == "etc2a")
+                options.m_format = vl::TextureCompressor::Format::eETC2A;
+            else if (format == "eacr")
+                options.m_format = vl::TextureCompressor::Format::eEACR;
+            else if (format == "eacrg")
+                options.m_format = vl::TextureCompressor::Format::eEACRG;
+            else if (format == "rgba8")
+                options.m_is_uncompressed = true;
+        }
+        else if (option == "--mips")
+            options.m_has_mips = true;
+        else if (option == "--zlib")
+            options.m_is_supercompressed = true;
+        else if (option == "--threads" && i + 1 < argc)
+            options.m_thread_count = static_cast<size_t>(std::atoi(argv[++i]));
+    }
+
+    return convert_texture(argv[0], argv[1], options) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
\ No newline at end of file
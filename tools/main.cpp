@@ -0,0 +1,26 @@
+#include <iostream>
+#include <string>
+#include <ntl/NTL.cpp>
+#include "MeshConverter.cpp"
+#include "TextureConverter.cpp"
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: main <tool> [arguments]" << std::endl
+                  << "  mesh <input.obj> <output.vlm> [--float] [--cache n] [--no-meshlets] [--meshlet v t] [--lod n] [--lod-error e]" << std::endl
+                  << "  texture <input.ppm> <output.dds|output.ktx2> [--usage color|alpha|gray|normal] [--mips] [--threads t]" << std::endl
+                  << "          [--format bc1|bc3|bc4|bc5|bc7|etc2|etc2a|eacr|eacrg|rgba8] [--zlib]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string name = argv[1];
+    if (name == "mesh")
+        return run_mesh_converter(argc - 2, argv + 2);
+    if (name == "texture")
+        return run_texture_converter(argc - 2, argv + 2);
+
+    std::cout << "unknown tool: " << name << std::endl;
+    return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+set filename=main
+g++ -std=c++17 -O2 -march=native -finput-charset=UTF-8 -fexec-charset=gbk ^
+    "%filename%.cpp" -o "%filename%.exe" ^
+    -lvulkan-1 ^
+    -I E:/C++/Project_Neutron/.release/
\ No newline at end of file